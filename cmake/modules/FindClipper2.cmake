@@ -0,0 +1,15 @@
+find_path(CLIPPER2_INCLUDE_DIR clipper2/clipper.h)
+find_library(CLIPPER2_LIBRARY NAMES Clipper2 libClipper2)
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Clipper2 DEFAULT_MSG
+    CLIPPER2_LIBRARY
+    CLIPPER2_INCLUDE_DIR
+)
+
+if(Clipper2_FOUND AND NOT TARGET Clipper2::Clipper2)
+    add_library(Clipper2::Clipper2 STATIC IMPORTED)
+    set_target_properties(Clipper2::Clipper2 PROPERTIES
+        IMPORTED_LOCATION "${CLIPPER2_LIBRARY}"
+        INTERFACE_INCLUDE_DIRECTORIES "${CLIPPER2_INCLUDE_DIR}"
+    )
+endif()
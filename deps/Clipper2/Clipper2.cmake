@@ -0,0 +1,12 @@
+# Used by libslic3r when configured with SLIC3R_CLIPPER2, built with DEP_CLIPPER2.
+elegooslicer_add_cmake_project(Clipper2
+    GIT_REPOSITORY      https://github.com/AngusJohnson/Clipper2.git
+    GIT_TAG             Clipper2_1.4.0
+    SOURCE_SUBDIR       CPP
+    CMAKE_ARGS
+        -DCLIPPER2_UTILS:BOOL=OFF
+        -DCLIPPER2_EXAMPLES:BOOL=OFF
+        -DCLIPPER2_TESTS:BOOL=OFF
+        -DCLIPPER2_USINGZ:STRING=OFF
+        -DBUILD_SHARED_LIBS:BOOL=OFF
+)
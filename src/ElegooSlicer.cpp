@@ -54,7 +54,9 @@ using namespace nlohmann;
 #include "libslic3r/Platform.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/SliceCache.hpp"
 #include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
 #include "libslic3r/Format/AMF.hpp"
 #include "libslic3r/Format/3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
@@ -4745,6 +4747,23 @@ int CLI::run(int argc, char **argv)
             // modified by the centering and such.
             Model model_copy;
             bool  make_copy = &opt_key != &m_actions.back();
+            // Persistent cache of the object slicing results, shared by all the plates.
+            std::shared_ptr<SliceCache> slice_cache;
+            if (std::string slice_cache_dir = m_config.opt_string("slice_cache_dir", true); ! slice_cache_dir.empty()) {
+                int slice_cache_size = m_config.option<ConfigOptionInt>("slice_cache_size", true)->value;
+                slice_cache = std::make_shared<SliceCache>(slice_cache_dir, size_t(std::max(slice_cache_size, 1)) * 1024 * 1024);
+                BOOST_LOG_TRIVIAL(info) << boost::format("Using slice cache %1%, size limit %2% MB")%slice_cache_dir %slice_cache_size;
+            }
+            if (std::string slicing_backend = m_config.opt_string("slicing_backend", true); slicing_backend == "cpu_batched") {
+                set_gpu_slicing_callback(slice_mesh_cpu_batched);
+                BOOST_LOG_TRIVIAL(info) << "Using batched CPU slicing backend";
+            } else if (! slicing_backend.empty() && slicing_backend != "default")
+                BOOST_LOG_TRIVIAL(warning) << "Unknown slicing backend " << slicing_backend << ", using the default one";
+            size_t      tree_support_cache_limit = size_t(std::max(m_config.option<ConfigOptionInt>("tree_support_cache_limit", true)->value, 0)) * 1024 * 1024;
+            int         extruder_order_max_extruders = std::max(m_config.option<ConfigOptionInt>("extruder_order_max_extruders", true)->value, 0);
+            size_t      extruder_order_max_states = size_t(std::max(m_config.option<ConfigOptionInt>("extruder_order_max_states", true)->value, 0)) * 1000 * 1000;
+            bool        print_step_stats = m_config.option<ConfigOptionBool>("step_stats", true)->value;
+            std::string step_stats_trace = m_config.opt_string("step_stats_trace", true);
             for (Model &model_in : m_models) {
                 if (make_copy)
                     model_copy = model_in;
@@ -4783,6 +4802,12 @@ int CLI::run(int argc, char **argv)
                         part_plate->get_print(&print, &gcode_result, &print_index);
 
                         print_fff = dynamic_cast<Print *>(print);
+                        if (print_fff) {
+                            print_fff->set_slice_cache(slice_cache);
+                            print_fff->set_tree_support_cache_limit(tree_support_cache_limit);
+                            print_fff->set_extruder_order_max_extruders(extruder_order_max_extruders);
+                            print_fff->set_extruder_order_max_states(extruder_order_max_states);
+                        }
                         /*if (outfile_config.empty())
                         {
                             outfile = "plate_" + std::to_string(index + 1) + ".gcode";
@@ -5090,6 +5115,20 @@ int CLI::run(int argc, char **argv)
                                 //run_post_process_scripts(outfile, print->full_print_config());
                                 BOOST_LOG_TRIVIAL(info) << "Slicing result exported to " << outfile << std::endl;
                                 part_plate->update_slice_result_valid_state(true);
+                                if (print_step_stats || ! step_stats_trace.empty()) {
+                                    std::vector<PrintStepStats> step_stats = print->step_stats();
+                                    if (print_step_stats)
+                                        boost::nowide::cout << "Plate " << index+1 << " slicing steps:" << std::endl << format_step_stats(step_stats);
+                                    if (! step_stats_trace.empty()) {
+                                        std::string trace_path = step_stats_trace;
+                                        if (plate_to_slice == 0 && partplate_list.get_plate_count() > 1) {
+                                            fs::path path(step_stats_trace);
+                                            trace_path = (path.parent_path() / (path.stem().string() + "_plate_" + std::to_string(index+1) + path.extension().string())).string();
+                                        }
+                                        if (! export_step_stats_chrome_trace(step_stats, trace_path))
+                                            BOOST_LOG_TRIVIAL(error) << "plate "<< index+1<< ": failed to export step statistics to " << trace_path;
+                                    }
+                                }
 #if defined(__linux__) || defined(__LINUX__)
                                 if (g_cli_callback_mgr.is_started()) {
                                     PrintBase::SlicingStatus slicing_status{100, "Slicing finished"};
@@ -26,9 +26,7 @@
 #include <boost/uuid/uuid_io.hpp>
 
 #ifdef WIN32
-//FIXME replace the two following includes with <boost/md5.hpp> after it becomes mainstream.
-#include <boost/uuid/detail/md5.hpp>
-#include <boost/algorithm/hex.hpp>
+#include "MD5Hasher.hpp"
 #include <Windows.h>
 #endif
 
@@ -465,20 +463,10 @@ void AppConfig::set_defaults()
 #ifdef WIN32
 static std::string appconfig_md5_hash_line(const std::string_view data)
 {
-    //FIXME replace the two following includes with <boost/md5.hpp> after it becomes mainstream.
-    // return boost::md5(data).hex_str_value();
-    // boost::uuids::detail::md5 is an internal namespace thus it may change in the future.
-    // Also this implementation is not the fastest, it was designed for short blocks of text.
-    using boost::uuids::detail::md5;
-    md5              md5_hash;
-    // unsigned int[4], 128 bits
-    md5::digest_type md5_digest{};
-    std::string      md5_digest_str;
-    md5_hash.process_bytes(data.data(), data.size());
-    md5_hash.get_digest(md5_digest);
-    boost::algorithm::hex(md5_digest, md5_digest + std::size(md5_digest), std::back_inserter(md5_digest_str));
-    // MD5 hash is 32 HEX digits long.
-    assert(md5_digest_str.size() == 32);
+    // The MD5 implementation is not the fastest, it was designed for short blocks of text.
+    MD5Hasher md5_hash;
+    md5_hash.bytes(data.data(), data.size());
+    std::string md5_digest_str = md5_hash.hex_digest();
     // This line will be emited at the end of the file.
     return "# MD5 checksum " + md5_digest_str + "\n";
 }
@@ -15,6 +15,7 @@
 #include "utils/PolylineStitcher.hpp"
 #include "SVG.hpp"
 #include "Utils.hpp"
+#include "MD5Hasher.hpp"
 
 #include <boost/log/trivial.hpp>
 
@@ -59,8 +60,141 @@ WallToolPathsParams make_paths_params(const int layer_id, const PrintObjectConfi
     return input_params;
 }
 
+Point WallToolPathsCache::make_key(const Polygons &outline, const coord_t bead_width_0, const coord_t bead_width_x, const size_t inset_count,
+                                   const coord_t wall_0_inset, const coordf_t layer_height, const WallToolPathsParams &params, Key &key)
+{
+    const Point shift = outline.empty() ? Point::Zero() : get_extents(outline).min;
+    MD5Hasher hasher;
+    hasher.value(bead_width_0);
+    hasher.value(bead_width_x);
+    hasher.value(inset_count);
+    hasher.value(wall_0_inset);
+    hasher.value(layer_height);
+    hasher.value(params.min_bead_width);
+    hasher.value(params.min_feature_size);
+    hasher.value(params.min_length_factor);
+    hasher.value(params.wall_transition_length);
+    hasher.value(params.wall_transition_angle);
+    hasher.value(params.wall_transition_filter_deviation);
+    hasher.value(params.wall_distribution_count);
+    hasher.value(params.is_top_or_bottom_layer);
+    hasher.value(outline.size());
+    for (const Polygon &polygon : outline) {
+        hasher.value(polygon.size());
+        for (const Point &pt : polygon) {
+            const Point p = pt - shift;
+            hasher.value(p.x());
+            hasher.value(p.y());
+        }
+    }
+    key = hasher.digest();
+    return shift;
+}
+
+static void translate_toolpaths(std::vector<VariableWidthLines> &toolpaths, Polygons &inner_contour, const Point &shift)
+{
+    if (shift == Point::Zero())
+        return;
+    for (VariableWidthLines &lines : toolpaths)
+        for (ExtrusionLine &line : lines)
+            for (ExtrusionJunction &junction : line.junctions)
+                junction.p += shift;
+    for (Polygon &polygon : inner_contour)
+        polygon.translate(shift);
+}
+
+static size_t toolpaths_memsize(const std::vector<VariableWidthLines> &toolpaths, const Polygons &inner_contour)
+{
+    size_t memsize = SLIC3R_STDVEC_MEMSIZE(toolpaths, VariableWidthLines) + SLIC3R_STDVEC_MEMSIZE(inner_contour, Polygon);
+    for (const VariableWidthLines &lines : toolpaths) {
+        memsize += SLIC3R_STDVEC_MEMSIZE(lines, ExtrusionLine);
+        for (const ExtrusionLine &line : lines)
+            memsize += SLIC3R_STDVEC_MEMSIZE(line.junctions, ExtrusionJunction);
+    }
+    for (const Polygon &polygon : inner_contour)
+        memsize += SLIC3R_STDVEC_MEMSIZE(polygon.points, Point);
+    return memsize;
+}
+
+bool WallToolPathsCache::find(const Key &key, const Point &shift, std::vector<VariableWidthLines> &toolpaths, Polygons &inner_contour)
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        auto it = m_map.find(key);
+        if (it == m_map.end()) {
+            ++ m_misses;
+            return false;
+        }
+        ++ m_hits;
+        // Mark as the most recently used entry.
+        m_entries.splice(m_entries.end(), m_entries, it->second);
+        toolpaths     = it->second->toolpaths;
+        inner_contour = it->second->inner_contour;
+    }
+    translate_toolpaths(toolpaths, inner_contour, shift);
+    return true;
+}
+
+void WallToolPathsCache::insert(const Key &key, const std::vector<VariableWidthLines> &toolpaths, const Polygons &inner_contour)
+{
+    Entry entry { key, toolpaths, inner_contour, toolpaths_memsize(toolpaths, inner_contour) };
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    // Another thread may have generated the same toolpaths in the meantime.
+    if (m_map.find(key) != m_map.end())
+        return;
+    m_memsize += entry.memsize;
+    m_entries.emplace_back(std::move(entry));
+    m_map.emplace(key, std::prev(m_entries.end()));
+    this->evict();
+}
+
+void WallToolPathsCache::evict()
+{
+    // Always keep the most recently used entry.
+    while (m_entries.size() > 1 && m_memsize > m_max_memsize) {
+        m_memsize -= m_entries.front().memsize;
+        m_map.erase(m_entries.front().key);
+        m_entries.pop_front();
+    }
+}
+
+void WallToolPathsCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_map.clear();
+    m_entries.clear();
+    m_memsize = 0;
+    m_hits    = 0;
+    m_misses  = 0;
+}
+
+size_t WallToolPathsCache::size() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t WallToolPathsCache::memsize() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_memsize;
+}
+
+size_t WallToolPathsCache::hits() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+size_t WallToolPathsCache::misses() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
 WallToolPaths::WallToolPaths(const Polygons& outline, const coord_t bead_width_0, const coord_t bead_width_x,
-                             const size_t inset_count, const coord_t wall_0_inset, const coordf_t layer_height, const WallToolPathsParams &params)
+                             const size_t inset_count, const coord_t wall_0_inset, const coordf_t layer_height, const WallToolPathsParams &params,
+                             WallToolPathsCache *cache)
     : outline(outline)
     , bead_width_0(bead_width_0)
     , bead_width_x(bead_width_x)
@@ -74,6 +208,7 @@ WallToolPaths::WallToolPaths(const Polygons& outline, const coord_t bead_width_0
     , wall_transition_filter_deviation(scaled<coord_t>(params.wall_transition_filter_deviation))
     , toolpaths_generated(false)
     , m_params(params)
+    , m_cache(cache)
 {
 }
 
@@ -473,6 +608,33 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
     if (this->inset_count < 1)
         return toolpaths;
 
+    if (m_cache == nullptr) {
+        generateToolPaths(outline);
+        return toolpaths;
+    }
+
+    WallToolPathsCache::Key key;
+    const Point shift = WallToolPathsCache::make_key(outline, bead_width_0, bead_width_x, inset_count, wall_0_inset, layer_height, m_params, key);
+    if (m_cache->find(key, shift, toolpaths, inner_contour)) {
+        toolpaths_generated = true;
+        return toolpaths;
+    }
+    // The Voronoi construction rounds in absolute coordinates. Generate from the outline translated to the origin and translate
+    // the result back, the same way as a cache hit does, so that the result does not depend on which of the identical outlines
+    // was generated first, or whether it was cached at all.
+    Polygons outline_at_origin = outline;
+    for (Polygon &polygon : outline_at_origin)
+        polygon.translate(- shift);
+    generateToolPaths(outline_at_origin);
+    // Outlines degenerating to nothing are not worth caching, they do not reach the skeletal trapezoidation.
+    if (toolpaths_generated)
+        m_cache->insert(key, toolpaths, inner_contour);
+    translate_toolpaths(toolpaths, inner_contour, shift);
+    return toolpaths;
+}
+
+void WallToolPaths::generateToolPaths(const Polygons &input_outline)
+{
     const coord_t smallest_segment = Slic3r::Arachne::meshfix_maximum_resolution();
     const coord_t allowed_distance = Slic3r::Arachne::meshfix_maximum_deviation();
     const coord_t epsilon_offset = (allowed_distance / 2) - 1;
@@ -481,7 +643,7 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
 
     // Simplify outline for boost::voronoi consumption. Absolutely no self intersections or near-self intersections allowed:
     // TODO: Open question: Does this indeed fix all (or all-but-one-in-a-million) cases for manifold but otherwise possibly complex polygons?
-    Polygons prepared_outline = offset(offset(offset(outline, -epsilon_offset), epsilon_offset * 2), -epsilon_offset);
+    Polygons prepared_outline = offset(offset(offset(input_outline, -epsilon_offset), epsilon_offset * 2), -epsilon_offset);
     simplify(prepared_outline, smallest_segment, allowed_distance);
     fixSelfIntersections(epsilon_offset, prepared_outline);
     removeDegenerateVerts(prepared_outline);
@@ -499,7 +661,7 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
 
     if (area(prepared_outline) <= 0) {
         assert(toolpaths.empty());
-        return toolpaths;
+        return;
     }
 
     const float external_perimeter_extrusion_width = Flow::rounded_rectangle_extrusion_width_from_spacing(unscale<float>(bead_width_0), float(this->layer_height));
@@ -556,7 +718,6 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
                               return l.front().inset_idx < r.front().inset_idx;
                           }) && "WallToolPaths should be sorted from the outer 0th to inner_walls");
     toolpaths_generated = true;
-    return toolpaths;
 }
 
 void WallToolPaths::stitchToolPaths(std::vector<VariableWidthLines> &toolpaths, const coord_t bead_width_x)
@@ -4,7 +4,10 @@
 #ifndef CURAENGINE_WALLTOOLPATHS_H
 #define CURAENGINE_WALLTOOLPATHS_H
 
+#include <array>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <ankerl/unordered_dense.h>
 
 #include "BeadingStrategy/BeadingStrategyFactory.hpp"
@@ -35,6 +38,69 @@ public:
 
 WallToolPathsParams make_paths_params(const int layer_id, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
 
+/*!
+ * Cache of the toolpaths generated by WallToolPaths, shared by all layers of a PrintObject.
+ *
+ * The skeletal trapezoidation is by far the most expensive part of Arachne, while prismatic objects and arrayed features
+ * produce the very same outline over and over again. The outline is keyed translated by the minimum corner of its bounding
+ * box, thus the cache hits for identical outlines at a different XY position as well. The toolpaths are generated from the translated
+ * outline and translated back both on a miss and on a hit, so the result does not depend on the order in which the layers were processed.
+ * The entries are keyed by a MD5 hash of the translated outline and of all the parameters, the outline itself is not stored.
+ * The least recently used entries are evicted once the cached toolpaths occupy more than max_memsize bytes,
+ * the most recently used entry is kept even if it is larger.
+ * The cache is thread safe.
+ */
+class WallToolPathsCache
+{
+public:
+    explicit WallToolPathsCache(size_t max_memsize = 64 * 1024 * 1024) : m_max_memsize(max_memsize) {}
+
+    using Key = std::array<unsigned int, 4>;
+
+    // Hash the outline translated to the origin and the parameters into the key. Returns the translation to be applied to the cached toolpaths.
+    static Point make_key(const Polygons &outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count, coord_t wall_0_inset,
+                          coordf_t layer_height, const WallToolPathsParams &params, Key &key);
+
+    // Returns true and the toolpaths and inner contour translated by shift on a cache hit.
+    bool find(const Key &key, const Point &shift, std::vector<VariableWidthLines> &toolpaths, Polygons &inner_contour);
+    // Store the toolpaths and inner contour generated from the translated outline of the key.
+    void insert(const Key &key, const std::vector<VariableWidthLines> &toolpaths, const Polygons &inner_contour);
+
+    void   clear();
+    // Number of the cached entries and the memory occupied by their toolpaths.
+    size_t size() const;
+    size_t memsize() const;
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const { return (size_t(key[0]) << 32) ^ key[1]; }
+    };
+
+    struct Entry
+    {
+        Key                             key;
+        std::vector<VariableWidthLines> toolpaths;
+        Polygons                        inner_contour;
+        size_t                          memsize;
+    };
+    // The most recently used entry is at the back.
+    using Entries = std::list<Entry>;
+
+    // Drop the least recently used entries over the memory limit. Called with m_mutex locked.
+    void evict();
+
+    mutable std::mutex                                          m_mutex;
+    Entries                                                     m_entries;
+    ankerl::unordered_dense::map<Key, Entries::iterator, KeyHash> m_map;
+    size_t                                                      m_max_memsize;
+    size_t                                                      m_memsize { 0 };
+    size_t                                                      m_hits    { 0 };
+    size_t                                                      m_misses  { 0 };
+};
+
 class WallToolPaths
 {
 public:
@@ -45,8 +111,10 @@ public:
      * \param bead_width_x The bead width of the inner walls used in the generation of the toolpaths
      * \param inset_count The maximum number of parallel extrusion lines that make up the wall
      * \param wall_0_inset How far to inset the outer wall, to make it adhere better to other walls.
+     * \param cache Optional cache of the toolpaths generated for identical outlines and parameters before.
      */
-    WallToolPaths(const Polygons& outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count, coord_t wall_0_inset, coordf_t layer_height, const WallToolPathsParams &params);
+    WallToolPaths(const Polygons& outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count, coord_t wall_0_inset, coordf_t layer_height, const WallToolPathsParams &params,
+                  WallToolPathsCache *cache = nullptr);
 
     /*!
      * Generates the Toolpaths
@@ -122,6 +190,9 @@ protected:
     static void simplifyToolPaths(std::vector<VariableWidthLines>  &toolpaths);
 
 private:
+    // Generate the toolpaths of the outline without looking into the cache.
+    void generateToolPaths(const Polygons &input_outline);
+
     const Polygons& outline; //<! A reference to the outline polygon that is the designated area
     coord_t bead_width_0; //<! The nominal or first extrusion line width with which libArachne generates its walls
     coord_t bead_width_x; //<! The subsequently extrusion line width with which libArachne generates its walls if WallToolPaths was called with the nominal_bead_width Constructor this is the same as bead_width_0
@@ -137,6 +208,7 @@ private:
     std::vector<VariableWidthLines> toolpaths; //<! The generated toolpaths
     Polygons inner_contour;  //<! The inner contour of the generated toolpaths
     const WallToolPathsParams m_params;
+    WallToolPathsCache *m_cache; //<! Optional cache of the toolpaths shared by the layers of a PrintObject
 };
 
 } // namespace Slic3r::Arachne
@@ -0,0 +1,205 @@
+#include "Clipper2Utils.hpp"
+
+#include <algorithm>
+
+namespace Slic3r {
+
+namespace Clipper2Utils {
+
+static Polygon to_polygon(const Path64 &path)
+{
+    Polygon out;
+    out.points.reserve(path.size());
+    for (const Clipper2Lib::Point64 &pt : path)
+        out.points.emplace_back(coord_t(pt.x), coord_t(pt.y));
+    return out;
+}
+
+Polygons to_polygons(const Paths64 &paths)
+{
+    Polygons out;
+    out.reserve(paths.size());
+    for (const Path64 &path : paths)
+        out.emplace_back(to_polygon(path));
+    return out;
+}
+
+Polylines to_polylines(const Paths64 &paths)
+{
+    Polylines out;
+    out.reserve(paths.size());
+    for (const Path64 &path : paths) {
+        out.emplace_back();
+        out.back().points = std::move(to_polygon(path).points);
+    }
+    return out;
+}
+
+// Outer contours of the PolyTree64 become ExPolygon contours, their children the holes,
+// outer contours nested inside the holes are emitted as separate ExPolygons.
+static void polytree_to_expolygons_recursive(const Clipper2Lib::PolyPath64 &outer, ExPolygons &out)
+{
+    ExPolygon expoly;
+    expoly.contour = to_polygon(outer.Polygon());
+    expoly.holes.reserve(outer.Count());
+    for (size_t i = 0; i < outer.Count(); ++ i)
+        expoly.holes.emplace_back(to_polygon(outer[i]->Polygon()));
+    out.emplace_back(std::move(expoly));
+    for (size_t i = 0; i < outer.Count(); ++ i) {
+        const Clipper2Lib::PolyPath64 &hole = *outer[i];
+        for (size_t j = 0; j < hole.Count(); ++ j)
+            polytree_to_expolygons_recursive(*hole[j], out);
+    }
+}
+
+static ExPolygons to_expolygons(const Clipper2Lib::PolyTree64 &polytree)
+{
+    ExPolygons out;
+    out.reserve(polytree.Count());
+    for (size_t i = 0; i < polytree.Count(); ++ i)
+        polytree_to_expolygons_recursive(*polytree[i], out);
+    return out;
+}
+
+Clipper2Lib::ClipType to_clip_type(ClipperLib::ClipType clip_type)
+{
+    switch (clip_type) {
+    case ClipperLib::ctIntersection: return Clipper2Lib::ClipType::Intersection;
+    case ClipperLib::ctUnion:        return Clipper2Lib::ClipType::Union;
+    case ClipperLib::ctDifference:   return Clipper2Lib::ClipType::Difference;
+    case ClipperLib::ctXor:          return Clipper2Lib::ClipType::Xor;
+    }
+    assert(false);
+    return Clipper2Lib::ClipType::Union;
+}
+
+Clipper2Lib::FillRule to_fill_rule(ClipperLib::PolyFillType fill_type)
+{
+    switch (fill_type) {
+    case ClipperLib::pftEvenOdd:  return Clipper2Lib::FillRule::EvenOdd;
+    case ClipperLib::pftNonZero:  return Clipper2Lib::FillRule::NonZero;
+    case ClipperLib::pftPositive: return Clipper2Lib::FillRule::Positive;
+    case ClipperLib::pftNegative: return Clipper2Lib::FillRule::Negative;
+    }
+    assert(false);
+    return Clipper2Lib::FillRule::NonZero;
+}
+
+Clipper2Lib::JoinType to_join_type(ClipperLib::JoinType join_type)
+{
+    switch (join_type) {
+    case ClipperLib::jtSquare: return Clipper2Lib::JoinType::Square;
+    case ClipperLib::jtRound:  return Clipper2Lib::JoinType::Round;
+    case ClipperLib::jtMiter:  return Clipper2Lib::JoinType::Miter;
+    }
+    assert(false);
+    return Clipper2Lib::JoinType::Miter;
+}
+
+Clipper2Lib::EndType to_end_type(ClipperLib::EndType end_type)
+{
+    switch (end_type) {
+    case ClipperLib::etClosedPolygon: return Clipper2Lib::EndType::Polygon;
+    case ClipperLib::etClosedLine:    return Clipper2Lib::EndType::Joined;
+    case ClipperLib::etOpenButt:      return Clipper2Lib::EndType::Butt;
+    case ClipperLib::etOpenSquare:    return Clipper2Lib::EndType::Square;
+    case ClipperLib::etOpenRound:     return Clipper2Lib::EndType::Round;
+    }
+    assert(false);
+    return Clipper2Lib::EndType::Polygon;
+}
+
+Paths64 clip(ClipperLib::ClipType clip_type, const Paths64 &subject, const Paths64 &clip, ClipperLib::PolyFillType fill_type)
+{
+    Clipper2Lib::Clipper64 clipper;
+    // ClipperLib removes collinear vertices as well.
+    clipper.PreserveCollinear(false);
+    clipper.AddSubject(subject);
+    if (! clip.empty())
+        clipper.AddClip(clip);
+    Paths64 out;
+    clipper.Execute(to_clip_type(clip_type), to_fill_rule(fill_type), out);
+    return out;
+}
+
+ExPolygons clip_ex(ClipperLib::ClipType clip_type, const Paths64 &subject, const Paths64 &clip, ClipperLib::PolyFillType fill_type)
+{
+    Clipper2Lib::Clipper64 clipper;
+    clipper.PreserveCollinear(false);
+    clipper.AddSubject(subject);
+    if (! clip.empty())
+        clipper.AddClip(clip);
+    // Unlike ClipperLib, Clipper2 builds the PolyTree efficiently even for overlapping edges,
+    // thus there is no need for the two pass workaround of clipper_do_polytree().
+    Clipper2Lib::PolyTree64 polytree;
+    clipper.Execute(to_clip_type(clip_type), to_fill_rule(fill_type), polytree);
+    return to_expolygons(polytree);
+}
+
+Polylines clip_open(ClipperLib::ClipType clip_type, const Paths64 &subject, const Paths64 &clip)
+{
+    Clipper2Lib::Clipper64 clipper;
+    clipper.PreserveCollinear(false);
+    clipper.AddOpenSubject(subject);
+    clipper.AddClip(clip);
+    Paths64 closed, open;
+    clipper.Execute(to_clip_type(clip_type), Clipper2Lib::FillRule::NonZero, closed, open);
+    return to_polylines(open);
+}
+
+Paths64 raw_offset(const Paths64 &paths, float delta, ClipperLib::JoinType join_type, double miter_limit, ClipperLib::EndType end_type)
+{
+    Clipper2Lib::ClipperOffset co;
+    if (join_type == ClipperLib::jtRound)
+        co.ArcTolerance(miter_limit);
+    else
+        co.MiterLimit(miter_limit);
+    const Clipper2Lib::JoinType jt     = to_join_type(join_type);
+    const Clipper2Lib::EndType  et     = to_end_type(end_type);
+    const bool                  closed = end_type == ClipperLib::etClosedPolygon;
+
+    Paths64 out;
+    out.reserve(paths.size());
+    Paths64 out_this;
+    for (const Path64 &path : paths) {
+        co.Clear();
+        out_this.clear();
+        // Feed the offsetter with CCW contours only and reverse the offset of CW contours (holes),
+        // so that the holes are offsetted the other way than the contours, and reverse the result back.
+        bool ccw = closed ? Clipper2Lib::IsPositive(path) : true;
+        if (ccw)
+            co.AddPath(path, jt, et);
+        else
+            co.AddPath(Path64(path.rbegin(), path.rend()), jt, et);
+        co.Execute(ccw ? delta : - delta, out_this);
+        for (Path64 &path_out : out_this) {
+            if (! ccw)
+                std::reverse(path_out.begin(), path_out.end());
+            out.emplace_back(std::move(path_out));
+        }
+    }
+    return out;
+}
+
+// Contours expanded by a positive offset are united with the non-zero rule,
+// shrunk contours with the positive rule, which removes the holes grown over their outer contours.
+static ClipperLib::PolyFillType offset_union_fill_type(float delta, ClipperLib::EndType end_type)
+{
+    return delta > 0 || end_type != ClipperLib::etClosedPolygon ? ClipperLib::pftNonZero : ClipperLib::pftPositive;
+}
+
+Paths64 offset(const Paths64 &paths, float delta, ClipperLib::JoinType join_type, double miter_limit, ClipperLib::EndType end_type)
+{
+    Paths64 raw = raw_offset(paths, delta, join_type, miter_limit, end_type);
+    return raw.empty() ? raw : clip(ClipperLib::ctUnion, raw, Paths64(), offset_union_fill_type(delta, end_type));
+}
+
+ExPolygons offset_ex(const Paths64 &paths, float delta, ClipperLib::JoinType join_type, double miter_limit)
+{
+    Paths64 raw = raw_offset(paths, delta, join_type, miter_limit);
+    return raw.empty() ? ExPolygons() : clip_ex(ClipperLib::ctUnion, raw, Paths64(), offset_union_fill_type(delta, ClipperLib::etClosedPolygon));
+}
+
+} // namespace Clipper2Utils
+
+} // namespace Slic3r
@@ -0,0 +1,68 @@
+#ifndef slic3r_Clipper2Utils_hpp_
+#define slic3r_Clipper2Utils_hpp_
+
+// Boolean operations and offsets implemented with the Clipper2 library.
+// Only compiled in with the SLIC3R_CLIPPER2 CMake option, which defines SLIC3R_USE_CLIPPER2.
+// ClipperUtils.cpp then routes the boolean operations and offsets through these functions,
+// while the public ClipperUtils API keeps using the ClipperLib enums.
+
+#include <clipper2/clipper.h>
+
+#include "libslic3r.h"
+#include "clipper.hpp"
+#include "ExPolygon.hpp"
+#include "Polygon.hpp"
+#include "Polyline.hpp"
+
+namespace Slic3r {
+
+namespace Clipper2Utils {
+
+using Path64  = Clipper2Lib::Path64;
+using Paths64 = Clipper2Lib::Paths64;
+
+// Convert a ClipperUtils paths provider (or ClipperLib::Paths) to Clipper2 paths.
+template<typename PathsProvider>
+inline Paths64 to_paths64(PathsProvider &&paths)
+{
+    Paths64 out;
+    out.reserve(paths.size());
+    for (const auto &path : paths) {
+        out.emplace_back();
+        Path64 &dst = out.back();
+        dst.reserve(path.size());
+        for (const auto &pt : path)
+            dst.emplace_back(int64_t(pt.x()), int64_t(pt.y()));
+    }
+    return out;
+}
+
+Polygons    to_polygons(const Paths64 &paths);
+Polylines   to_polylines(const Paths64 &paths);
+
+Clipper2Lib::ClipType   to_clip_type(ClipperLib::ClipType clip_type);
+Clipper2Lib::FillRule   to_fill_rule(ClipperLib::PolyFillType fill_type);
+Clipper2Lib::JoinType   to_join_type(ClipperLib::JoinType join_type);
+Clipper2Lib::EndType    to_end_type(ClipperLib::EndType end_type);
+
+// Boolean operation on closed paths.
+Paths64     clip(ClipperLib::ClipType clip_type, const Paths64 &subject, const Paths64 &clip, ClipperLib::PolyFillType fill_type);
+// Boolean operation on closed paths, the result is ordered into ExPolygons.
+ExPolygons  clip_ex(ClipperLib::ClipType clip_type, const Paths64 &subject, const Paths64 &clip, ClipperLib::PolyFillType fill_type);
+// Clip open polylines with closed paths using the non-zero fill rule.
+Polylines   clip_open(ClipperLib::ClipType clip_type, const Paths64 &subject, const Paths64 &clip);
+
+// Offset CCW contours outside, CW contours (holes) inside, each path separately, the same way ClipperUtils raw_offset() does.
+// Don't calculate union of the output paths. miter_limit is the arc tolerance for jtRound.
+// ClipperLib::ClipperOffset::ShortestEdgeLength has no Clipper2 counterpart, thus short edges are not skipped.
+Paths64     raw_offset(const Paths64 &paths, float delta, ClipperLib::JoinType join_type, double miter_limit, ClipperLib::EndType end_type = ClipperLib::etClosedPolygon);
+// Offset of contours with holes, the offsetted paths are united with the non-zero rule when expanding
+// and with the positive rule when shrinking, thus holes expanded over their contours are removed.
+Paths64     offset(const Paths64 &paths, float delta, ClipperLib::JoinType join_type, double miter_limit, ClipperLib::EndType end_type = ClipperLib::etClosedPolygon);
+ExPolygons  offset_ex(const Paths64 &paths, float delta, ClipperLib::JoinType join_type, double miter_limit);
+
+} // namespace Clipper2Utils
+
+} // namespace Slic3r
+
+#endif // slic3r_Clipper2Utils_hpp_
@@ -2,6 +2,12 @@
 #include "Geometry.hpp"
 #include "ShortestPath.hpp"
 
+#include <numeric>
+
+#ifdef SLIC3R_USE_CLIPPER2
+#include "Clipper2Utils.hpp"
+#endif /* SLIC3R_USE_CLIPPER2 */
+
 // #define CLIPPER_UTILS_DEBUG
 
 #ifdef CLIPPER_UTILS_DEBUG
@@ -401,6 +407,27 @@ static TResult offset_paths(PathsProvider &&paths, float offset, ClipperLib::Joi
         shrink_paths<TResult>(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit);
 }
 
+#ifdef SLIC3R_USE_CLIPPER2
+Slic3r::Polygons offset(const Slic3r::Polygon &polygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::to_polygons(Clipper2Utils::raw_offset(Clipper2Utils::to_paths64(ClipperUtils::SinglePathProvider(polygon.points)), delta, joinType, miterLimit)); }
+
+Slic3r::Polygons offset(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::PolygonsProvider(polygons)), delta, joinType, miterLimit)); }
+Slic3r::ExPolygons offset_ex(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::offset_ex(Clipper2Utils::to_paths64(ClipperUtils::PolygonsProvider(polygons)), delta, joinType, miterLimit); }
+
+Slic3r::Polygons offset(const Slic3r::Polyline &polyline, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType end_type)
+    { assert(delta > 0); return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::SinglePathProvider(polyline.points)), delta, joinType, miterLimit, end_type)); }
+Slic3r::Polygons offset(const Slic3r::Polylines &polylines, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType end_type)
+    { assert(delta > 0); return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::PolylinesProvider(polylines)), delta, joinType, miterLimit, end_type)); }
+
+Polygons contour_to_polygons(const Polygon &polygon, const float line_width, ClipperLib::JoinType join_type, double miter_limit){
+    assert(line_width > 1.f); return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::to_paths64(ClipperUtils::SinglePathProvider(polygon.points)), line_width/2, join_type, miter_limit, ClipperLib::etClosedLine));}
+Polygons contour_to_polygons(const Polygons &polygons, const float line_width, ClipperLib::JoinType join_type, double miter_limit){
+    assert(line_width > 1.f); return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::to_paths64(ClipperUtils::PolygonsProvider(polygons)), line_width/2, join_type, miter_limit, ClipperLib::etClosedLine));}
+#else /* SLIC3R_USE_CLIPPER2 */
 Slic3r::Polygons offset(const Slic3r::Polygon &polygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
     { return to_polygons(raw_offset(ClipperUtils::SinglePathProvider(polygon.points), delta, joinType, miterLimit)); }
 
@@ -420,6 +447,50 @@ Polygons contour_to_polygons(const Polygon &polygon, const float line_width, Cli
 Polygons contour_to_polygons(const Polygons &polygons, const float line_width, ClipperLib::JoinType join_type, double miter_limit){
     assert(line_width > 1.f); return to_polygons(clipper_union<ClipperLib::Paths>(
         raw_offset(ClipperUtils::PolygonsProvider(polygons), line_width/2, join_type, miter_limit, ClipperLib::etClosedLine)));}
+#endif /* SLIC3R_USE_CLIPPER2 */
+
+// Subtract the offsetted holes from the offsetted outer contour of a single ExPolygon.
+// returns number of expolygons collected (0 or 1).
+static int offset_expolygon_subtract_holes(ClipperLib::Paths &&contours, ClipperLib::Paths &&holes, const float delta, ClipperLib::Paths &out)
+{
+    if (contours.empty())
+        return 0;
+
+    if (holes.empty()) {
+        // No hole remaining after an offset or no holes at all. Just copy the outer contour.
+        append(out, std::move(contours));
+    } else if (delta < 0) {
+        // Negative offset. There is a chance, that the offsetted hole intersects the outer contour. 
+        // Subtract the offsetted holes from the offsetted contours.            
+        if (auto output = clipper_do<ClipperLib::Paths>(ClipperLib::ctDifference, contours, holes, ClipperLib::pftNonZero); ! output.empty()) {
+            append(out, std::move(output));
+        } else {
+            // The offsetted holes have eaten up the offsetted outer contour.
+            return 0;
+        }
+    } else {
+        // Positive offset. As long as the Clipper offset does what one expects it to do, the offsetted hole will have a smaller
+        // area than the original hole or even disappear, therefore there will be no new intersections.
+        // Just collect the reversed holes.
+        out.reserve(contours.size() + holes.size());
+        append(out, std::move(contours));
+        // Reverse the holes in place.
+        for (size_t i = 0; i < holes.size(); ++ i)
+            std::reverse(holes[i].begin(), holes[i].end());
+        append(out, std::move(holes));
+    }
+
+    return 1;
+}
+
+static void init_clipper_offset(ClipperLib::ClipperOffset &co, double shortest_edge_length, ClipperLib::JoinType joinType, double miterLimit)
+{
+    if (joinType == jtRound)
+        co.ArcTolerance = miterLimit;
+    else
+        co.MiterLimit = miterLimit;
+    co.ShortestEdgeLength = shortest_edge_length;
+}
 
 // returns number of expolygons collected (0 or 1).
 static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
@@ -428,11 +499,7 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
     ClipperLib::Paths contours;
     {
         ClipperLib::ClipperOffset co;
-        if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
-        else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+        init_clipper_offset(co, std::abs(delta * ClipperOffsetShortestEdgeFactor), joinType, miterLimit);
         co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
         co.Execute(contours, delta);
     }
@@ -440,57 +507,70 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // No need to try to offset the holes.
         return 0;
 
-    if (expoly.holes.empty()) {
-        // No need to subtract holes from the offsetted expolygon, we are done.
-        append(out, std::move(contours));
-    } else {
-        // 2) Offset the holes one by one, collect the offsetted holes.
-        ClipperLib::Paths holes;
-        {
-            for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-                co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
-                ClipperLib::Paths out2;
-                // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
-                // contours will be CCW oriented even though the input paths are CW oriented.
-                // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-                co.Execute(out2, - delta);
-                append(holes, std::move(out2));
-            }
+    // 2) Offset the holes one by one, collect the offsetted holes.
+    ClipperLib::Paths holes;
+    for (const Polygon &hole : expoly.holes) {
+        ClipperLib::ClipperOffset co;
+        init_clipper_offset(co, std::abs(delta * ClipperOffsetShortestEdgeFactor), joinType, miterLimit);
+        co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
+        ClipperLib::Paths out2;
+        // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
+        // contours will be CCW oriented even though the input paths are CW oriented.
+        // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
+        co.Execute(out2, - delta);
+        append(holes, std::move(out2));
+    }
+
+    // 3) Subtract holes from the contours.
+    return offset_expolygon_subtract_holes(std::move(contours), std::move(holes), delta, out);
+}
+
+// Batched offset_expolygon_inner(): The deltas are processed in the order of their absolute values, the contour and each hole
+// are added to a single ClipperOffset once per distinct absolute value of the delta and offsetted by all the deltas of that value.
+// ClipperOffset::AddPath() removes the edges shorter than ShortestEdgeLength, which is derived from the delta the same way
+// offset_expolygon_inner() does, thus the results are the same as of offset_expolygon_inner() called for each delta.
+// ClipperOffset::Execute() may be called repeatedly, it only reorients the contours on the first call.
+static void offset_expolygon_inner_batch(const Slic3r::ExPolygon &expoly, const std::vector<float> &deltas,
+    ClipperLib::JoinType joinType, double miterLimit, std::vector<std::pair<ClipperLib::Paths, size_t>> &out)
+{
+    std::vector<size_t> order(deltas.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&deltas](size_t i, size_t j) { return std::abs(deltas[i]) < std::abs(deltas[j]); });
+    ClipperLib::ClipperOffset co;
+    // Absolute value of the delta the path in co was added for.
+    float added_delta = -1.f;
+    auto add_path = [&co, &added_delta, joinType, miterLimit](const Points &path, float delta) {
+        if (std::abs(delta) != added_delta) {
+            co.Clear();
+            init_clipper_offset(co, std::abs(delta * ClipperOffsetShortestEdgeFactor), joinType, miterLimit);
+            co.AddPath(path, joinType, ClipperLib::etClosedPolygon);
+            added_delta = std::abs(delta);
         }
+    };
 
-        // 3) Subtract holes from the contours.
-        if (holes.empty()) {
-            // No hole remaining after an offset. Just copy the outer contour.
-            append(out, std::move(contours));
-        } else if (delta < 0) {
-            // Negative offset. There is a chance, that the offsetted hole intersects the outer contour. 
-            // Subtract the offsetted holes from the offsetted contours.            
-            if (auto output = clipper_do<ClipperLib::Paths>(ClipperLib::ctDifference, contours, holes, ClipperLib::pftNonZero); ! output.empty()) {
-                append(out, std::move(output));
-            } else {
-                // The offsetted holes have eaten up the offsetted outer contour.
-                return 0;
+    std::vector<ClipperLib::Paths> contours(deltas.size());
+    std::vector<ClipperLib::Paths> holes(deltas.size());
+    bool any_contour = false;
+    for (size_t i : order) {
+        add_path(expoly.contour.points, deltas[i]);
+        co.Execute(contours[i], deltas[i]);
+        any_contour |= ! contours[i].empty();
+    }
+    if (! any_contour)
+        return;
+    ClipperLib::Paths out2;
+    for (const Polygon &hole : expoly.holes) {
+        added_delta = -1.f;
+        for (size_t i : order)
+            if (! contours[i].empty()) {
+                add_path(hole.points, deltas[i]);
+                // The signum of the offset is reversed for the holes, see offset_expolygon_inner().
+                co.Execute(out2, - deltas[i]);
+                append(holes[i], std::move(out2));
             }
-        } else {
-            // Positive offset. As long as the Clipper offset does what one expects it to do, the offsetted hole will have a smaller
-            // area than the original hole or even disappear, therefore there will be no new intersections.
-            // Just collect the reversed holes.
-            out.reserve(contours.size() + holes.size());
-            append(out, std::move(contours));
-            // Reverse the holes in place.
-            for (size_t i = 0; i < holes.size(); ++ i)
-                std::reverse(holes[i].begin(), holes[i].end());
-            append(out, std::move(holes));
-        }
     }
-
-    return 1;
+    for (size_t i = 0; i < deltas.size(); ++ i)
+        out[i].second += offset_expolygon_subtract_holes(std::move(contours[i]), std::move(holes[i]), deltas[i], out[i].first);
 }
 
 static int offset_expolygon_inner(const Slic3r::Surface &surface, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
@@ -544,6 +624,86 @@ static ClipperLib::PolyTree expolygons_offset_pt(const ExPolygonVector &expolygo
     return clipper_union<ClipperLib::PolyTree>(output);
 }
 
+#ifdef SLIC3R_USE_CLIPPER2
+Slic3r::Polygons offset(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonProvider(expolygon)), delta, joinType, miterLimit)); }
+Slic3r::Polygons offset(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta, joinType, miterLimit)); }
+Slic3r::Polygons offset(const Slic3r::Surfaces &surfaces, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::SurfacesProvider(surfaces)), delta, joinType, miterLimit)); }
+Slic3r::Polygons offset(const Slic3r::SurfacesPtr &surfaces, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::to_polygons(Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::SurfacesPtrProvider(surfaces)), delta, joinType, miterLimit)); }
+Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::offset_ex(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonProvider(expolygon)), delta, joinType, miterLimit); }
+Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::offset_ex(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta, joinType, miterLimit); }
+Slic3r::ExPolygons offset_ex(const Slic3r::Surfaces &surfaces, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::offset_ex(Clipper2Utils::to_paths64(ClipperUtils::SurfacesProvider(surfaces)), delta, joinType, miterLimit); }
+Slic3r::ExPolygons offset_ex(const Slic3r::SurfacesPtr &surfaces, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Clipper2Utils::offset_ex(Clipper2Utils::to_paths64(ClipperUtils::SurfacesPtrProvider(surfaces)), delta, joinType, miterLimit); }
+
+Polygons offset2(const ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+}
+ExPolygons offset2_ex(const ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return Clipper2Utils::offset_ex(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta1, joinType, miterLimit), delta2, joinType, miterLimit);
+}
+ExPolygons offset2_ex(const Surfaces &surfaces, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return Clipper2Utils::offset_ex(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::SurfacesProvider(surfaces)), delta1, joinType, miterLimit), delta2, joinType, miterLimit);
+}
+
+// Offset outside, then inside produces morphological closing. All deltas should be positive.
+Slic3r::Polygons closing(const Slic3r::Polygons &polygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    assert(delta1 > 0);
+    assert(delta2 > 0);
+    return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::PolygonsProvider(polygons)), delta1, joinType, miterLimit), - delta2, joinType, miterLimit));
+}
+Slic3r::ExPolygons closing_ex(const Slic3r::Polygons &polygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    assert(delta1 > 0);
+    assert(delta2 > 0);
+    return Clipper2Utils::offset_ex(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::PolygonsProvider(polygons)), delta1, joinType, miterLimit), - delta2, joinType, miterLimit);
+}
+Slic3r::ExPolygons closing_ex(const Slic3r::Surfaces &surfaces, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    assert(delta1 > 0);
+    assert(delta2 > 0);
+    return Clipper2Utils::offset_ex(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::SurfacesProvider(surfaces)), delta1, joinType, miterLimit), - delta2, joinType, miterLimit);
+}
+
+// Offset inside, then outside produces morphological opening. All deltas should be positive.
+Slic3r::Polygons opening(const Slic3r::Polygons &polygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    assert(delta1 > 0);
+    assert(delta2 > 0);
+    return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::PolygonsProvider(polygons)), - delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+}
+Slic3r::Polygons opening(const Slic3r::ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    assert(delta1 > 0);
+    assert(delta2 > 0);
+    return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::ExPolygonsProvider(expolygons)), - delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+}
+Slic3r::Polygons opening(const Slic3r::Surfaces &surfaces, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    assert(delta1 > 0);
+    assert(delta2 > 0);
+    return Clipper2Utils::to_polygons(Clipper2Utils::offset(
+        Clipper2Utils::offset(Clipper2Utils::to_paths64(ClipperUtils::SurfacesProvider(surfaces)), - delta1, joinType, miterLimit), delta2, joinType, miterLimit));
+}
+#else /* SLIC3R_USE_CLIPPER2 */
 Slic3r::Polygons offset(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit)
     { return to_polygons(expolygon_offset(expolygon, delta, joinType, miterLimit)); }
 Slic3r::Polygons offset(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
@@ -617,6 +777,54 @@ Slic3r::Polygons opening(const Slic3r::Surfaces &surfaces, const float delta1, c
     //FIXME it may be more efficient to offset to_expolygons(surfaces) instead of to_polygons(surfaces).
     return to_polygons(expand_paths<ClipperLib::Paths>(shrink_paths<ClipperLib::Paths>(ClipperUtils::SurfacesProvider(surfaces), delta1, joinType, miterLimit), delta2, joinType, miterLimit));
 }
+#endif /* SLIC3R_USE_CLIPPER2 */
+
+#ifdef SLIC3R_USE_CLIPPER2
+std::vector<Slic3r::ExPolygons> offset2_ex_batch(const Slic3r::ExPolygons &expolygons, const std::vector<std::pair<float, float>> &deltas, ClipperLib::JoinType joinType, double miterLimit)
+{
+    std::vector<ExPolygons> out;
+    out.reserve(deltas.size());
+    for (const std::pair<float, float> &delta : deltas)
+        out.emplace_back(offset2_ex(expolygons, delta.first, delta.second, joinType, miterLimit));
+    return out;
+}
+#else /* SLIC3R_USE_CLIPPER2 */
+// Batched expolygons_offset_raw(), one pair of the offsetted paths and the number of the collected expolygons per delta.
+static std::vector<std::pair<ClipperLib::Paths, size_t>> expolygons_offset_raw_batch(const ExPolygons &expolygons, const std::vector<float> &deltas, ClipperLib::JoinType joinType, double miterLimit)
+{
+    std::vector<std::pair<ClipperLib::Paths, size_t>> out(deltas.size(), { ClipperLib::Paths(), 0 });
+    if (deltas.empty())
+        return out;
+    for (std::pair<ClipperLib::Paths, size_t> &o : out)
+        o.first.reserve(expolygons.size());
+    for (const ExPolygon &expoly : expolygons)
+        offset_expolygon_inner_batch(expoly, deltas, joinType, miterLimit, out);
+    return out;
+}
+
+std::vector<Slic3r::ExPolygons> offset2_ex_batch(const Slic3r::ExPolygons &expolygons, const std::vector<std::pair<float, float>> &deltas, ClipperLib::JoinType joinType, double miterLimit)
+{
+    // Calculate the first offset once for each distinct delta1.
+    std::vector<float>  deltas1;
+    std::vector<size_t> idx1;
+    idx1.reserve(deltas.size());
+    for (const std::pair<float, float> &delta : deltas) {
+        auto it = std::find(deltas1.begin(), deltas1.end(), delta.first);
+        idx1.emplace_back(it - deltas1.begin());
+        if (it == deltas1.end())
+            deltas1.emplace_back(delta.first);
+    }
+    std::vector<std::pair<ClipperLib::Paths, size_t>> raw = expolygons_offset_raw_batch(expolygons, deltas1, joinType, miterLimit);
+    for (size_t i = 0; i < deltas1.size(); ++ i)
+        if (raw[i].second > 1 && deltas1[i] > 0)
+            raw[i].first = clipper_union<ClipperLib::Paths>(raw[i].first);
+    std::vector<ExPolygons> out;
+    out.reserve(deltas.size());
+    for (size_t i = 0; i < deltas.size(); ++ i)
+        out.emplace_back(PolyTreeToExPolygons(offset_paths<ClipperLib::PolyTree>(raw[idx1[i]].first, deltas[i].second, joinType, miterLimit)));
+    return out;
+}
+#endif /* SLIC3R_USE_CLIPPER2 */
 
 // Fix of #117: A large fractal pyramid takes ages to slice
 // The Clipper library has difficulties processing overlapping polygons.
@@ -654,10 +862,27 @@ inline ClipperLib::PolyTree clipper_do_polytree(
         clipper_do_polytree(clipType, std::forward<PathProvider1>(subject), std::forward<PathProvider2>(clip), fillType);
 }
 
+#ifdef SLIC3R_USE_CLIPPER2
+// Clipping paths converted to Clipper2, offsetted outside by ClipperSafetyOffset if requested.
+template<class TClip>
+static Clipper2Utils::Paths64 clipper2_clip_paths(TClip &&clip, ApplySafetyOffset do_safety_offset)
+{
+    Clipper2Utils::Paths64 out = Clipper2Utils::to_paths64(std::forward<TClip>(clip));
+    return do_safety_offset == ApplySafetyOffset::Yes ? Clipper2Utils::raw_offset(out, ClipperSafetyOffset, DefaultJoinType, DefaultMiterLimit) : out;
+}
+#endif /* SLIC3R_USE_CLIPPER2 */
+
 template<class TSubj, class TClip>
-static inline Polygons _clipper(ClipperLib::ClipType clipType, TSubj &&subject, TClip &&clip, ApplySafetyOffset do_safety_offset)
+static inline Polygons _clipper(ClipperLib::ClipType clipType, TSubj &&subject, TClip &&clip, ApplySafetyOffset do_safety_offset, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero)
 {
-    return to_polygons(clipper_do<ClipperLib::Paths>(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), ClipperLib::pftNonZero, do_safety_offset));
+    // Safety offset only allowed on intersection and difference.
+    assert(do_safety_offset == ApplySafetyOffset::No || clipType != ClipperLib::ctUnion);
+#ifdef SLIC3R_USE_CLIPPER2
+    return Clipper2Utils::to_polygons(Clipper2Utils::clip(clipType,
+        Clipper2Utils::to_paths64(std::forward<TSubj>(subject)), clipper2_clip_paths(std::forward<TClip>(clip), do_safety_offset), fill_type));
+#else /* SLIC3R_USE_CLIPPER2 */
+    return to_polygons(clipper_do<ClipperLib::Paths>(clipType, std::forward<TSubj>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset));
+#endif /* SLIC3R_USE_CLIPPER2 */
 }
 
 Slic3r::Polygons diff(const Slic3r::Polygon &subject, const Slic3r::Polygon &clip, ApplySafetyOffset do_safety_offset)
@@ -711,7 +936,7 @@ Slic3r::Polygons union_(const Slic3r::Polygons &subject)
 Slic3r::Polygons union_(const Slic3r::ExPolygons &subject)
     { return _clipper(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
 Slic3r::Polygons union_(const Slic3r::Polygons &subject, const ClipperLib::PolyFillType fillType)
-    { return to_polygons(clipper_do<ClipperLib::Paths>(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), fillType, ApplySafetyOffset::No)); }
+    { return _clipper(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No, fillType); }
 Slic3r::Polygons union_(const Slic3r::Polygons &subject, const Slic3r::Polygons &subject2)
     {
         // BBS
@@ -723,7 +948,15 @@ Slic3r::Polygons union_(const Slic3r::Polygons &subject, const Slic3r::Polygons
 
 template <typename TSubject, typename TClip>
 static ExPolygons _clipper_ex(ClipperLib::ClipType clipType, TSubject &&subject,  TClip &&clip, ApplySafetyOffset do_safety_offset, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero)
-    { return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset)); }
+{
+#ifdef SLIC3R_USE_CLIPPER2
+    assert(do_safety_offset == ApplySafetyOffset::No || clipType != ClipperLib::ctUnion);
+    return Clipper2Utils::clip_ex(clipType,
+        Clipper2Utils::to_paths64(std::forward<TSubject>(subject)), clipper2_clip_paths(std::forward<TClip>(clip), do_safety_offset), fill_type);
+#else /* SLIC3R_USE_CLIPPER2 */
+    return PolyTreeToExPolygons(clipper_do_polytree(clipType, std::forward<TSubject>(subject), std::forward<TClip>(clip), fill_type, do_safety_offset));
+#endif /* SLIC3R_USE_CLIPPER2 */
+}
 
 Slic3r::ExPolygons diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
     { return _clipper_ex(ClipperLib::ctDifference, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
@@ -800,11 +1033,11 @@ Slic3r::ExPolygons intersection_ex(const Slic3r::SurfacesPtr &subject, const Sli
 Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, ClipperLib::PolyFillType fill_type)
     { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No, fill_type); }
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero)); }
+    { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject, const Slic3r::Polygons &subject2)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(subject2), ClipperLib::pftNonZero)); }
+    { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(subject2), ApplySafetyOffset::No); }
 Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject)
-    { return PolyTreeToExPolygons(clipper_do_polytree(ClipperLib::ctUnion, ClipperUtils::SurfacesProvider(subject), ClipperUtils::EmptyPathsProvider(), ClipperLib::pftNonZero)); }
+    { return _clipper_ex(ClipperLib::ctUnion, ClipperUtils::SurfacesProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
 // BBS
 Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons& poly1, const Slic3r::ExPolygons& poly2, bool safety_offset_)
     {
@@ -824,12 +1057,16 @@ Slic3r::ExPolygons xor_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPol
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
+#ifdef SLIC3R_USE_CLIPPER2
+    return Clipper2Utils::clip_open(clipType, Clipper2Utils::to_paths64(std::forward<PathsProvider1>(subject)), Clipper2Utils::to_paths64(std::forward<PathsProvider2>(clip)));
+#else /* SLIC3R_USE_CLIPPER2 */
     ClipperLib::Clipper clipper;
     clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
     clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
     ClipperLib::PolyTree retval;
     clipper.Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     return PolyTreeToPolylines(std::move(retval));
+#endif /* SLIC3R_USE_CLIPPER2 */
 }
 
 // If the split_at_first_point() call above happens to split the polygon inside the clipping area
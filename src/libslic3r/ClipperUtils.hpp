@@ -391,6 +391,10 @@ Slic3r::Polygons   offset2(const Slic3r::ExPolygons &expolygons, const float del
 Slic3r::ExPolygons offset2_ex(const Slic3r::ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
 Slic3r::ExPolygons offset2_ex(const Slic3r::Surfaces &surfaces, const float delta1, const float delta2, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
 
+// Batched offset2_ex(): the expolygons are offsetted by each of the pairs of deltas, one result per pair, in the order of the pairs.
+// Same results as calling offset2_ex() for each pair. The first offset and its union are calculated only once per distinct delta1.
+std::vector<Slic3r::ExPolygons> offset2_ex_batch(const Slic3r::ExPolygons &expolygons, const std::vector<std::pair<float, float>> &deltas, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
+
 // BBS
 Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
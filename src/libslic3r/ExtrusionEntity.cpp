@@ -5,7 +5,9 @@
 #include "Extruder.hpp"
 #include "Flow.hpp"
 #include <cmath>
+#include <cstddef>
 #include <limits>
+#include <new>
 #include <sstream>
 #include "Utils.hpp"
 
@@ -15,6 +17,109 @@ namespace Slic3r {
     
 static const double slope_inner_outer_wall_gap = 0.4;
 
+// Precedes each ExtrusionEntity, the arena it was allocated from or nullptr if it was allocated from the heap.
+struct alignas(std::max_align_t) ExtrusionEntityAllocationHeader
+{
+    ExtrusionEntityArena *arena;
+};
+
+// The chunks grow from 4 kB up to 64 kB, so that the layers with a few entities do not hold large chunks.
+static constexpr size_t extrusion_entity_arena_max_chunk_size = 65536;
+
+static thread_local ExtrusionEntityArena *s_extrusion_entity_arena = nullptr;
+static std::atomic<bool>                  s_extrusion_entity_arena_enabled { true };
+static std::atomic<size_t>                s_extrusion_entity_arenas { 0 };
+static std::atomic<size_t>                s_extrusion_entity_arena_chunks { 0 };
+static std::atomic<size_t>                s_extrusion_entity_heap_allocations { 0 };
+
+ExtrusionEntityArena::Scope::Scope() :
+    m_arena(ExtrusionEntityArena::enabled() ? new ExtrusionEntityArena() : nullptr), m_previous(s_extrusion_entity_arena)
+{
+    if (m_arena) {
+        s_extrusion_entity_arena = m_arena;
+        s_extrusion_entity_arenas.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+ExtrusionEntityArena::Scope::~Scope()
+{
+    if (m_arena) {
+        s_extrusion_entity_arena = m_previous;
+        m_arena->release();
+    }
+}
+
+ExtrusionEntityArena::~ExtrusionEntityArena()
+{
+    for (char *chunk : m_chunks)
+        ::operator delete(chunk);
+}
+
+void* ExtrusionEntityArena::allocate_from_chunks(size_t size)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    if (size_t(m_end - m_top) < size) {
+        size_t chunk_size = std::max(m_next_chunk_size, size);
+        m_next_chunk_size = std::min(2 * m_next_chunk_size, extrusion_entity_arena_max_chunk_size);
+        m_top = m_chunks.emplace_back(static_cast<char*>(::operator new(chunk_size)));
+        m_end = m_top + chunk_size;
+        s_extrusion_entity_arena_chunks.fetch_add(1, std::memory_order_relaxed);
+    }
+    void *out = m_top;
+    m_top += size;
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+    return out;
+}
+
+void* ExtrusionEntityArena::allocate(size_t size)
+{
+    using Header = ExtrusionEntityAllocationHeader;
+    // Keep the entities aligned.
+    size = sizeof(Header) + (size + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+    ExtrusionEntityArena *arena = s_extrusion_entity_arena;
+    void                 *ptr;
+    if (arena)
+        ptr = arena->allocate_from_chunks(size);
+    else {
+        ptr = ::operator new(size);
+        s_extrusion_entity_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    new (ptr) Header { arena };
+    return static_cast<char*>(ptr) + sizeof(Header);
+}
+
+void ExtrusionEntityArena::deallocate(void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+    using Header = ExtrusionEntityAllocationHeader;
+    Header *header = reinterpret_cast<Header*>(static_cast<char*>(ptr) - sizeof(Header));
+    if (ExtrusionEntityArena *arena = header->arena; arena)
+        // The memory is released with the chunks of the arena.
+        arena->release();
+    else
+        ::operator delete(header);
+}
+
+void ExtrusionEntityArena::set_enabled(bool enabled)
+{
+    s_extrusion_entity_arena_enabled = enabled;
+}
+
+bool ExtrusionEntityArena::enabled()
+{
+    return s_extrusion_entity_arena_enabled.load(std::memory_order_relaxed);
+}
+
+ExtrusionEntityArena::Stats ExtrusionEntityArena::stats()
+{
+    Stats out;
+    out.arenas = s_extrusion_entity_arenas.load();
+    out.chunks = s_extrusion_entity_arena_chunks.load();
+    out.heap_allocations = s_extrusion_entity_heap_allocations.load();
+    return out;
+}
+
 void ExtrusionPath::intersect_expolygons(const ExPolygons &collection, ExtrusionEntityCollection* retval) const
 {
     this->_inflate_collection(intersection_pl(Polylines{ polyline }, collection), retval);
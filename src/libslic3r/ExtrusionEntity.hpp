@@ -6,6 +6,8 @@
 #include "Polyline.hpp"
 
 #include <assert.h>
+#include <atomic>
+#include <mutex>
 #include <string_view>
 #include <numeric>
 
@@ -102,6 +104,63 @@ inline bool is_bridge(ExtrusionRole role) {
         || role == erOverhangPerimeter;
 }
 
+// Monotonic arena the ExtrusionEntities are allocated from while an ExtrusionEntityArena::Scope is open on the current thread.
+// The layer processing steps open a scope per layer, thus the entities produced for a layer by a single step share a few chunks
+// of memory instead of being allocated one by one. The entities are still owned and deleted one by one by their collections,
+// deleting an entity allocated from an arena only runs its destructor. The chunks of an arena are released at once after its scope
+// was closed and the last entity allocated from it was deleted, for example when the step is invalidated or the layer is destroyed.
+// As each scope opens a new arena, repeated invalidation of a step does not grow the memory held by the arenas.
+class ExtrusionEntityArena
+{
+public:
+    class Scope
+    {
+    public:
+        // Opens a new arena if the arenas are enabled, otherwise the entities are allocated one by one.
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ExtrusionEntityArena *m_arena;
+        ExtrusionEntityArena *m_previous;
+    };
+
+    // Allocates from the arena of the innermost scope open on the current thread or from the heap.
+    static void*    allocate(size_t size);
+    static void     deallocate(void *ptr);
+
+    // Enabled by default. To be changed while no scope is open, for example to compare the allocation counts.
+    static void     set_enabled(bool enabled);
+    static bool     enabled();
+
+    struct Stats {
+        // Arenas opened and memory chunks allocated by them.
+        size_t arenas { 0 };
+        size_t chunks { 0 };
+        // Entities allocated one by one from the heap.
+        size_t heap_allocations { 0 };
+    };
+    static Stats    stats();
+
+private:
+    ExtrusionEntityArena() = default;
+    ~ExtrusionEntityArena();
+
+    void*           allocate_from_chunks(size_t size);
+    // Drops a reference held by the scope or by a live entity, the last one deletes the arena.
+    void            release() { if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this; }
+
+    std::mutex          m_mutex;
+    std::vector<char*>  m_chunks;
+    char               *m_top { nullptr };
+    char               *m_end { nullptr };
+    size_t              m_next_chunk_size { 4096 };
+    // The scope and the live entities.
+    std::atomic<size_t> m_refs { 1 };
+};
+
 class ExtrusionEntity
 {
 public:
@@ -115,6 +174,10 @@ public:
     // Create a new object, initialize it with this object using the move semantics.
     virtual ExtrusionEntity* clone_move() = 0;
     virtual ~ExtrusionEntity() {}
+    // Extrusion entities are allocated in large numbers by the parallel perimeter, infill and support steps,
+    // they are taken from the arena of the layer being processed, see ExtrusionEntityArena.
+    static void* operator new(size_t size) { return ExtrusionEntityArena::allocate(size); }
+    static void operator delete(void *ptr) { ExtrusionEntityArena::deallocate(ptr); }
     virtual void reverse() = 0;
     virtual const Point& first_point() const = 0;
     virtual const Point& last_point() const = 0;
@@ -5,6 +5,7 @@
 #include "../Layer.hpp"
 #include "../Print.hpp"
 #include "../ShortestPath.hpp"
+#include "../MD5Hasher.hpp"
 
 #include "FillAdaptive.hpp"
 
@@ -260,6 +261,8 @@ struct Octree
     // perfect for building up our octree.
     boost::object_pool<Cube>    pool;
     Cube*                       root_cube { nullptr };
+    // Number of Cubes allocated from the pool.
+    size_t                      num_cubes { 1 };
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
 
@@ -267,6 +270,8 @@ struct Octree
         : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
 
     void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+
+    size_t memsize() const { return sizeof(*this) + this->num_cubes * sizeof(Cube) + SLIC3R_STDVEC_MEMSIZE(this->cubes_properties, CubeProperties); }
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -1513,6 +1518,107 @@ OctreePtr build_octree(
     return octree;
 }
 
+OctreeCache::Key OctreeCache::make_key(const indexed_triangle_set &triangle_mesh, const std::vector<Vec3d> &overhang_triangles,
+                                       coordf_t line_spacing, bool support_overhangs_only)
+{
+    MD5Hasher hasher;
+    hasher.mesh(triangle_mesh);
+    hasher.values(overhang_triangles);
+    hasher.value(line_spacing);
+    hasher.value(support_overhangs_only);
+    return hasher.digest();
+}
+
+OctreeSharedPtr OctreeCache::get_or_build(const indexed_triangle_set &triangle_mesh, const std::vector<Vec3d> &overhang_triangles,
+                                          coordf_t line_spacing, bool support_overhangs_only)
+{
+    const Key                           key = make_key(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only);
+    std::promise<OctreeSharedPtr>       promise;
+    std::shared_future<OctreeSharedPtr> octree;
+    bool                                hit = false;
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        if (auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const Entry &entry) { return entry.key == key; }); it != m_entries.end()) {
+            ++ m_hits;
+            hit    = true;
+            octree = it->octree;
+            std::rotate(it, it + 1, m_entries.end());
+        } else {
+            ++ m_misses;
+            octree = promise.get_future().share();
+            m_entries.push_back({ key, octree, 0 });
+            this->evict();
+        }
+    }
+    if (hit)
+        // Wait outside of the lock, the octree may still be being built by another thread.
+        return octree.get();
+
+    try {
+        OctreeSharedPtr built = build_octree(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only);
+        {
+            // Account for the octree if it was not evicted or cleared while being built.
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            if (auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const Entry &entry) { return entry.key == key; }); it != m_entries.end()) {
+                it->memsize = built->memsize();
+                m_memsize  += it->memsize;
+                this->evict();
+            }
+        }
+        promise.set_value(std::move(built));
+    } catch (...) {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&key](const Entry &entry) { return entry.key == key; }), m_entries.end());
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    return octree.get();
+}
+
+void OctreeCache::evict()
+{
+    // Always keep the most recently used octree, it is likely being used.
+    while (m_entries.size() > 1 && (m_entries.size() > m_max_entries || m_memsize > m_max_memsize)) {
+        m_memsize -= m_entries.front().memsize;
+        m_entries.erase(m_entries.begin());
+    }
+}
+
+void OctreeCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_memsize = 0;
+    m_hits    = 0;
+    m_misses  = 0;
+}
+
+size_t OctreeCache::size() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t OctreeCache::memsize() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_memsize;
+}
+
+size_t OctreeCache::hits() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+size_t OctreeCache::misses() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
 void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
 {
     assert(current_cube);
@@ -1541,8 +1647,10 @@ void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cub
         //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
         // dist2_to_triangle and r2_cube are commented out too.
         if (triangle_AABB_intersects(a, b, c, bbox)) {
-            if (! current_cube->children[i])
+            if (! current_cube->children[i]) {
                 current_cube->children[i] = this->pool.construct(child_center);
+                ++ this->num_cubes;
+            }
             if (depth > 0)
                 this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
         }
@@ -13,6 +13,10 @@
 
 #include "FillBase.hpp"
 
+#include <array>
+#include <future>
+#include <mutex>
+
 struct indexed_triangle_set;
 
 namespace Slic3r {
@@ -26,6 +30,8 @@ struct Octree;
 // To keep the definition of Octree opaque, we have to define a custom deleter.
 struct OctreeDeleter { void operator()(Octree *p); };
 using  OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
+// Octree shared by the PrintObjects with the same geometry through OctreeCache.
+using  OctreeSharedPtr = std::shared_ptr<Octree>;
 
 // Calculate line spacing for
 // 1) adaptive cubic infill
@@ -48,6 +54,56 @@ FillAdaptive::OctreePtr         build_octree(
     // If true, octree is densified below internal overhangs only.
     bool                         support_overhangs_only);
 
+// Cache of the octrees built by build_octree(), owned by Print and shared by its PrintObjects.
+// The octrees are keyed by a MD5 hash of all the inputs of build_octree(), thus an octree is reused by PrintObjects
+// with the same mesh and transformation (for example copies of an object) and by PrintObjects re-processed after a change
+// of a parameter, which does not affect the mesh, the internal bridges or the line spacing. An octree is never modified
+// after it was built, thus it may be queried by multiple PrintObjects concurrently.
+// Only the last max_entries octrees occupying at most max_memsize bytes are kept alive by the cache, the most recently used
+// octree is kept even if it is larger. The octrees in use are kept alive by their PrintObjects.
+// All methods are thread safe.
+class OctreeCache
+{
+public:
+    explicit OctreeCache(size_t max_entries = 8, size_t max_memsize = 256 * 1024 * 1024) :
+        m_max_entries(max_entries), m_max_memsize(max_memsize) {}
+
+    // Returns the cached octree or builds a new one. If another thread is building an octree with the same key,
+    // waits for it instead of building the octree twice.
+    OctreeSharedPtr get_or_build(const indexed_triangle_set &triangle_mesh, const std::vector<Vec3d> &overhang_triangles,
+                                 coordf_t line_spacing, bool support_overhangs_only);
+
+    void            clear();
+    // Number of the cached octrees and the memory occupied by the octrees already built.
+    size_t          size() const;
+    size_t          memsize() const;
+    size_t          hits() const;
+    size_t          misses() const;
+
+private:
+    using Key = std::array<unsigned int, 4>;
+    static Key      make_key(const indexed_triangle_set &triangle_mesh, const std::vector<Vec3d> &overhang_triangles,
+                             coordf_t line_spacing, bool support_overhangs_only);
+    // Drop the least recently used entries over the limits. Called with m_mutex locked.
+    void            evict();
+
+    struct Entry {
+        Key                                 key;
+        std::shared_future<OctreeSharedPtr> octree;
+        // Zero until the octree is built.
+        size_t                              memsize;
+    };
+
+    mutable std::mutex  m_mutex;
+    // The most recently used entry is at the back.
+    std::vector<Entry>  m_entries;
+    size_t              m_max_entries;
+    size_t              m_max_memsize;
+    size_t              m_memsize { 0 };
+    size_t              m_hits    { 0 };
+    size_t              m_misses  { 0 };
+};
+
 //
 // Some of the algorithms used by class FillAdaptive were inspired by
 // Cura Engine's class SubDivCube
@@ -17,6 +17,7 @@ namespace Slic3r::FillLightning
 {
 
 class Node;
+class DistanceField;
 using NodeSPtr = std::shared_ptr<Node>;
 using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
 
@@ -48,6 +49,22 @@ public:
         const std::function<void()> &throw_on_cancel_callback
     );
 
+    /*!
+     * Same as above with the distance field of \p current_overhang constructed in advance,
+     * the distance field does not depend on the trees, thus it may be constructed for multiple layers in parallel.
+     * The distance field is updated while the new trees are generated.
+     */
+    void generateNewTrees
+    (
+        DistanceField& distance_field,
+        const Polygons& current_outlines,
+        const BoundingBox& current_outlines_bbox,
+        const EdgeGrid::Grid& outline_locator,
+        coord_t supporting_radius,
+        coord_t wall_supporting_radius,
+        const std::function<void()> &throw_on_cancel_callback
+    );
+
     /*! Determine & connect to connection point in tree/outline.
      * \param min_dist_from_boundary_for_tree If the unsupported point is closer to the boundary than this then don't consider connecting it to a tree
      */
@@ -1526,6 +1526,8 @@ void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* resu
         throw;
     }
     file.close();
+    if (m_processor.post_process_in_place())
+        m_processor.result().lines_ends = file.extract_lines_ends();
 
     check_placeholder_parser_failed();
 
@@ -1968,9 +1970,9 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
         // Write information on the generator.
         file.write_format("; generated by %s on %s\n", Slic3r::header_slic3r_generated().c_str(), Slic3r::Utils::local_timestamp().c_str());
         if (is_bbl_printers)
-            file.write_format(";%s\n", GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder).c_str());
+            file.write_reserved(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder) + "\n");
         //BBS: total layer number
-        file.write_format(";%s\n", GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Total_Layer_Number_Placeholder).c_str());
+        file.write_reserved(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Total_Layer_Number_Placeholder) + "\n");
         //Orca: extra check for bbl printer
         if (is_bbl_printers) {
             if (print.calib_params().mode == CalibMode::Calib_None) { // Don't support skipping in cali mode
@@ -2025,9 +2027,9 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
                 file.write(";CURA_COMPATIBLE_HEADER_BLOCK_START\n");
                 file.write(";Add the Cura tag to the Gcode file so that some printers think it is Gcode generated by Cura\n");
                 file.write_format(";Cura_SteamEngine %s\n", Slic3r::header_slic3r_generated().c_str());
-                file.write_format(";CURA_TIME_PLACEHOLDER\n");
-                file.write_format(";CURA_FILAMENT_USED_PLACEHOLDER\n");
-                file.write_format(";CURA_FILAMENT_WEIGHT_PLACEHOLDER\n");
+                file.write_reserved(";CURA_TIME_PLACEHOLDER\n");
+                file.write_reserved(";CURA_FILAMENT_USED_PLACEHOLDER\n");
+                file.write_reserved(";CURA_FILAMENT_WEIGHT_PLACEHOLDER\n");
                 file.write_format(";Layer height: %.2f\n", m_config.layer_height.value);
                 file.write_format(";LAYER_COUNT:%d\n", m_layer_count);
                 file.write_format(";MAXZ:%.2f\n", max_height_z);
@@ -2091,8 +2093,9 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
     if( m_enable_exclude_object)
         file.write(set_object_info(&print));
 
-    // adds tags for time estimators
-    file.write_format(";%s\n", GCodeProcessor::reserved_tag(GCodeProcessor::ETags::First_Line_M73_Placeholder).c_str());
+    // adds tags for time estimators, replaced by nothing if the M73 lines are disabled
+    if (! m_config.disable_m73)
+        file.write_reserved(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::First_Line_M73_Placeholder) + "\n");
 
     // Prepare the helper object for replacing placeholders in custom G-code and output filename.
     m_placeholder_parser_integration.parser = print.placeholder_parser();
@@ -2741,13 +2744,14 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
         file.write(m_writer.set_exhaust_fan(complete_print_exhaust_fan_speed, true));
     }
     // adds tags for time estimators
-    file.write_format(";%s\n", GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Last_Line_M73_Placeholder).c_str());
+    if (! m_config.disable_m73)
+        file.write_reserved(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Last_Line_M73_Placeholder) + "\n");
     file.write_format("; EXECUTABLE_BLOCK_END\n\n");
 
     print.throw_if_canceled();
 
     // Get filament stats.
-    file.write(DoExport::update_print_stats_and_format_filament_stats(
+    file.write_reserved(DoExport::update_print_stats_and_format_filament_stats(
     	// Const inputs
         has_wipe_tower, print.wipe_tower_data(),
         m_writer.extruders(),
@@ -2755,19 +2759,13 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
         print.m_print_statistics));
     print.m_print_statistics.initial_tool = initial_extruder_id;
     if (!is_bbl_printers) {
-        file.write_format("; total filament used [g] = %.2lf\n",
-            print.m_print_statistics.total_weight);
-        file.write_format("; total filament cost = %.2lf\n",
-            print.m_print_statistics.total_cost);
+        file.write_reserved("; total filament used [g] = " + float_to_string_decimal_point(print.m_print_statistics.total_weight, 2) + "\n");
+        file.write_reserved("; total filament cost = " + float_to_string_decimal_point(print.m_print_statistics.total_cost, 2) + "\n");
         if (print.m_print_statistics.total_toolchanges > 0)
             file.write_format("; total filament change = %i\n",
                 print.m_print_statistics.total_toolchanges);
         file.write_format("; total layers count = %i\n", m_layer_count);
-        file.write_format(
-            ";%s\n",
-            GCodeProcessor::reserved_tag(
-                GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder)
-            .c_str());
+        file.write_reserved(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder) + "\n");
       file.write("\n");
       file.write("; CONFIG_BLOCK_START\n");
       std::string full_config;
@@ -2806,105 +2804,84 @@ void GCode::check_placeholder_parser_failed()
     }
 }
 
+// Time spent by the parallel and the serial stages of the G-code export pipeline, logged to measure
+// how much of the per-layer work overlaps with the serial G-code generator.
+struct ProcessLayersTimes
+{
+    std::atomic<int64_t> parallel_us { 0 };
+    std::atomic<int64_t> serial_us { 0 };
+    // Splitting the layer G-code into lines and parsing the moves, see GCodeLayerLines.
+    std::atomic<int64_t> parse_us { 0 };
+    // Pressure equalizer, cooling buffer, fan mover and adaptive PA filters.
+    std::atomic<int64_t> post_filters_us { 0 };
+
+    template<typename Fn> static auto measure(std::atomic<int64_t> &total_us, Fn &&fn) {
+        const auto start = std::chrono::steady_clock::now();
+        auto out = fn();
+        total_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        return out;
+    }
+
+    void log(size_t num_layers, std::chrono::steady_clock::time_point start) const {
+        BOOST_LOG_TRIVIAL(info) << boost::format("G-code export of %1% layers took %2% ms: preparation of the layers %3% ms in parallel, generator %4% ms serially, "
+                                                 "parsing the lines %5% ms in parallel, pressure equalizer, cooling, fan mover and adaptive PA filters %6% ms serially")
+            % num_layers % std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()
+            % (parallel_us.load() / 1000) % (serial_us.load() / 1000) % (parse_us.load() / 1000) % (post_filters_us.load() / 1000);
+    }
+};
+
+// Does any region of the layer print with the overhang speed, thus it needs the boundaries of the previous layer?
+static bool layer_has_overhang_speed(const Layer &layer)
+{
+    return std::any_of(layer.regions().begin(), layer.regions().end(), [](const LayerRegion *r) {
+        return r->has_extrusions() && r->region().config().enable_overhang_speed;
+    });
+}
+
+// The travel boundaries of the layers are prepared in parallel in batches of this many layers to print.
+static constexpr size_t avoid_crossing_perimeters_batch = 16;
+
+// The layer passed to AvoidCrossingPerimeters::init_layer() by process_layer().
+static void append_layers(const GCode::LayerToPrint &layer_to_print, std::vector<const Layer*> &out)
+{
+    if (const Layer *layer = layer_to_print.layer(); layer != nullptr)
+        out.emplace_back(layer);
+}
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
 void GCode::process_layers(
     const Print                                                         &print,
-    const ToolOrdering                                                  &tool_ordering,
+    ToolOrdering                                                        &tool_ordering,
     const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
     const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
     GCodeOutputStream                                                   &output_stream)
 {
-    // The pipeline is variable: The vase mode filter is optional.
-    size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
-            } else {
-                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
-                const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
-                if (m_wipe_tower && layer_tools.has_wipe_tower)
-                    m_wipe_tower->next_layer();
-                //BBS
-                check_placeholder_parser_failed();
-                print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+    // The extruder overrides of the wiping extrusions are resolved upfront, the layers prepared in parallel only read them.
+    for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer : layers_to_print)
+        prepare_extruder_overrides(print, layer.second, tool_ordering.tools_for_layer(layer.first));
+    const ToolOrdering &tools = tool_ordering;
+    this->process_layers_pipeline(print, layers_to_print.size(),
+        [this, &print, &tools, &layers_to_print](size_t layer_idx) {
+            const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[layer_idx];
+            return this->prepare_layer(print, layer.second, tools.tools_for_layer(layer.first));
+        },
+        [this, &print, &tools, &print_object_instances_ordering, &layers_to_print](size_t layer_idx, LayerPreparation &&prepared) {
+            if (print.config().reduce_crossing_wall && layer_idx % avoid_crossing_perimeters_batch == 0) {
+                std::vector<const Layer*> layers;
+                for (size_t idx = layer_idx; idx < std::min(layer_idx + avoid_crossing_perimeters_batch, layers_to_print.size()); ++ idx)
+                    for (const LayerToPrint &layer_to_print : layers_to_print[idx].second)
+                        append_layers(layer_to_print, layers);
+                m_avoid_crossing_perimeters.prepare_layers(layers);
             }
-        });
-    if (m_spiral_vase) {
-        float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
-        float max_xy_smoothing = m_config.get_abs_value("spiral_mode_max_xy_smoothing", nozzle_diameter);
-        this->m_spiral_vase->set_max_xy_smoothing(max_xy_smoothing);
-    }
-    const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in) -> LayerResult {
-        	if (in.nop_layer_result)
-                return in;
-                
-            spiral_mode.enable(in.spiral_vase_enable);
-            bool last_layer = in.layer_id == layers_to_print.size() - 1;
-            return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush};
-        });
-    const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
-            return pressure_equalizer->process_layer(std::move(in));
-        });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> std::string {
-        	if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
-        });
-    const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-            [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
-                return pa_processor.process_layer(std::move(in));
-            }
-        );
-    
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
-    );
-
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-            [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
-
-        CNumericLocalesSetter locales_setter;
-
-        if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
-            if (fan_mover.get() == nullptr)
-                fan_mover.reset(new Slic3r::FanMover(
-                    writer,
-                    std::abs((float)config.fan_speedup_time.value),
-                    config.fan_speedup_time.value > 0,
-                    config.use_relative_e_distances.value,
-                    config.fan_speedup_overhangs.value,
-                    (float)config.fan_kickstart.value));
-            //flush as it's a whole layer
-            return fan_mover->process_gcode(in, true);
-        }
-        return in;
-    });
-
-    // The pipeline elements are joined using const references, thus no copying is performed.
-    if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
-    else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
-    else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
-    else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+            const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[layer_idx];
+            const LayerTools &layer_tools = tools.tools_for_layer(layer.first);
+            if (m_wipe_tower && layer_tools.has_wipe_tower)
+                m_wipe_tower->next_layer();
+            return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1), false, std::move(prepared));
+        },
+        output_stream);
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
@@ -2912,34 +2889,81 @@ void GCode::process_layers(
 // and export G-code into file.
 void GCode::process_layers(
     const Print                             &print,
-    const ToolOrdering                      &tool_ordering,
+    ToolOrdering                            &tool_ordering,
     std::vector<LayerToPrint>                layers_to_print,
     const size_t                             single_object_idx,
     GCodeOutputStream                       &output_stream,
     // BBS
     const bool                               prime_extruder)
+{
+    for (const LayerToPrint &layer : layers_to_print)
+        prepare_extruder_overrides(print, { layer }, tool_ordering.tools_for_layer(layer.print_z()));
+    const ToolOrdering &tools = tool_ordering;
+    this->process_layers_pipeline(print, layers_to_print.size(),
+        [this, &print, &tools, &layers_to_print](size_t layer_idx) {
+            const LayerToPrint &layer = layers_to_print[layer_idx];
+            return this->prepare_layer(print, { layer }, tools.tools_for_layer(layer.print_z()));
+        },
+        [this, &print, &tools, &layers_to_print, single_object_idx, prime_extruder](size_t layer_idx, LayerPreparation &&prepared) {
+            if (print.config().reduce_crossing_wall && layer_idx % avoid_crossing_perimeters_batch == 0) {
+                std::vector<const Layer*> layers;
+                for (size_t idx = layer_idx; idx < std::min(layer_idx + avoid_crossing_perimeters_batch, layers_to_print.size()); ++ idx)
+                    append_layers(layers_to_print[idx], layers);
+                m_avoid_crossing_perimeters.prepare_layers(layers);
+            }
+            LayerToPrint &layer = layers_to_print[layer_idx];
+            return this->process_layer(print, { std::move(layer) }, tools.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder, std::move(prepared));
+        },
+        output_stream);
+}
+
+void GCode::process_layers_pipeline(
+    const Print                                                         &print,
+    size_t                                                               num_layers,
+    const std::function<LayerPreparation(size_t)>                       &prepare_layer,
+    const std::function<LayerResult(size_t, LayerPreparation&&)>        &generate_layer,
+    GCodeOutputStream                                                   &output_stream)
 {
     // The pipeline is variable: The vase mode filter is optional.
+    // The layers are prepared in parallel ahead of process_layer(), which has to run serially as it carries the state
+    // of the G-code generator (position, extruder, retraction, wipe, Z) from layer to layer.
+    struct LayerToProcess {
+        // num_layers for the NOP layer.
+        size_t              layer_idx { 0 };
+        LayerPreparation    prepared;
+    };
+    const auto         start_time = std::chrono::steady_clock::now();
+    ProcessLayersTimes times;
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
+    const auto layer_source = tbb::make_filter<void, LayerToProcess>(slic3r_tbb_filtermode::serial_in_order,
+        [this, num_layers, &layer_to_print_idx](tbb::flow_control& fc) -> LayerToProcess {
+            if (layer_to_print_idx == num_layers + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return {};
+            }
+            return { layer_to_print_idx ++, {} };
+        });
+    const auto prepare = tbb::make_filter<LayerToProcess, LayerToProcess>(slic3r_tbb_filtermode::parallel,
+        [num_layers, &prepare_layer, &times](LayerToProcess in) -> LayerToProcess {
+            if (in.layer_idx < num_layers)
+                return ProcessLayersTimes::measure(times.parallel_us, [&]() {
+                    in.prepared = prepare_layer(in.layer_idx);
+                    return std::move(in);
+                });
+            return in;
+        });
+    const auto generator = tbb::make_filter<LayerToProcess, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, num_layers, &generate_layer, &times](LayerToProcess in) -> LayerResult {
+            if (in.layer_idx >= num_layers) {
+                // Pressure equalizer need insert empty input. Because it returns one layer back.
+                // Insert NOP (no operation) layer;
+                return LayerResult::make_nop_layer_result();
             } else {
-                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.layer_idx + 1)));
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
+                return ProcessLayersTimes::measure(times.serial_us, [&]() { return generate_layer(in.layer_idx, std::move(in.prepared)); });
             }
         });
     if (m_spiral_vase) {
@@ -2947,36 +2971,51 @@ void GCode::process_layers(
         float max_xy_smoothing = m_config.get_abs_value("spiral_mode_max_xy_smoothing", nozzle_diameter);
         this->m_spiral_vase->set_max_xy_smoothing(max_xy_smoothing);
     }
-    const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
-            if (in.nop_layer_result)
+    // The layer G-code is split into lines and its moves are parsed once, in parallel. The spiral vase, the pressure equalizer,
+    // the cooling buffer, the fan mover and the adaptive PA filter pass the parsed lines along, only the lines they emit or edit
+    // are parsed again.
+    const auto parse = tbb::make_filter<LayerResult, LayerLines>(slic3r_tbb_filtermode::parallel,
+        [&times](LayerResult in) -> LayerLines {
+            return ProcessLayersTimes::measure(times.parse_us, [&]() {
+                return LayerLines{ GCodeLayerLines(std::move(in.gcode)), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush, in.nop_layer_result };
+            });
+        });
+    const auto spiral_mode = tbb::make_filter<LayerLines, LayerLines>(slic3r_tbb_filtermode::serial_in_order,
+        [&spiral_mode = *this->m_spiral_vase.get(), num_layers](LayerLines in) -> LayerLines {
+        	if (in.nop_layer_result)
                 return in;
+                
             spiral_mode.enable(in.spiral_vase_enable);
-            bool last_layer = in.layer_id == layers_to_print.size() - 1;
-            return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
+            bool last_layer = in.layer_id == num_layers - 1;
+            in.gcode = spiral_mode.process_layer(std::move(in.gcode), last_layer);
+            return in;
         });
-    const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
-             return pressure_equalizer->process_layer(std::move(in));
+    const auto pressure_equalizer = tbb::make_filter<LayerLines, LayerLines>(slic3r_tbb_filtermode::serial_in_order,
+        [pressure_equalizer = this->m_pressure_equalizer.get(), &times](LayerLines in) -> LayerLines {
+            return ProcessLayersTimes::measure(times.post_filters_us, [&]() { return pressure_equalizer->process_layer(std::move(in)); });
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->std::string {
-            if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    const auto cooling = tbb::make_filter<LayerLines, GCodeLayerLines>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get(), &times](LayerLines in) -> GCodeLayerLines {
+        	if (in.nop_layer_result)
+                return std::move(in.gcode);
+            return ProcessLayersTimes::measure(times.post_filters_us, [&]() {
+                return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+            });
         });
-    const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
-            return pa_processor.process_layer(std::move(in));
-        }
-    );
+    const auto pa_processor_filter = tbb::make_filter<GCodeLayerLines, GCodeLayerLines>(slic3r_tbb_filtermode::serial_in_order,
+            [&pa_processor = *this->m_pa_processor, &times](GCodeLayerLines in) -> GCodeLayerLines {
+                return ProcessLayersTimes::measure(times.post_filters_us, [&]() { return pa_processor.process_layer(std::move(in)); });
+            }
+        );
     
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+    const auto output = tbb::make_filter<GCodeLayerLines, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream](GCodeLayerLines in) { output_stream.write(in.text()); }
     );
 
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
+    const auto fan_mover = tbb::make_filter<GCodeLayerLines, GCodeLayerLines>(slic3r_tbb_filtermode::serial_in_order,
+            [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer, &times](GCodeLayerLines in)->GCodeLayerLines {
+
+        CNumericLocalesSetter locales_setter;
 
         if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
             if (fan_mover.get() == nullptr)
@@ -2988,20 +3027,21 @@ void GCode::process_layers(
                     config.fan_speedup_overhangs.value,
                     (float)config.fan_kickstart.value));
             //flush as it's a whole layer
-            return fan_mover->process_gcode(in, true);
+            return ProcessLayersTimes::measure(times.post_filters_us, [&]() { return fan_mover->process_layer(std::move(in), true); });
         }
         return in;
     });
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
+        tbb::parallel_pipeline(12, layer_source & prepare & generator & parse & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
     else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
+    	tbb::parallel_pipeline(12, layer_source & prepare & generator & parse & spiral_mode & cooling & fan_mover & output);
     else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
+        tbb::parallel_pipeline(12, layer_source & prepare & generator & parse & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
     else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+    	tbb::parallel_pipeline(12, layer_source & prepare & generator & parse & cooling & fan_mover & pa_processor_filter & output);
+    times.log(num_layers, start_time);
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
@@ -3632,19 +3672,268 @@ std::string GCode::generate_skirt(const Print &print,
                 break;
             }
         }
-        m_avoid_crossing_perimeters.use_external_mp(false);
-        // Allow a straight travel move to the first object point if this is the first layer (but don't in next layers).
-        if (first_layer && loops.first == 0)
-            m_avoid_crossing_perimeters.disable_once();
-    }
-    return gcode;
+        m_avoid_crossing_perimeters.use_external_mp(false);
+        // Allow a straight travel move to the first object point if this is the first layer (but don't in next layers).
+        if (first_layer && loops.first == 0)
+            m_avoid_crossing_perimeters.disable_once();
+    }
+    return gcode;
+}
+
+// In sequential mode, process_layer is called once per each object and its copy,
+// therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
+// In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
+// For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
+// and performing the extruder specific extrusions together.
+// Extruder printing the extrusions of a region if they are not overridden by the wiping extrusions.
+static int extrusions_extruder_id(const LayerTools &layer_tools, const ExtrusionEntityCollection &extrusions, const PrintRegion &region)
+{
+    int extruder_id = layer_tools.extruder(extrusions, region);
+    if (! layer_tools.has_extruder(extruder_id))
+        // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
+        // by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
+        extruder_id = layer_tools.extruders.back();
+    return extruder_id;
+}
+
+void GCode::prepare_extruder_overrides(const Print &print, const std::vector<LayerToPrint> &layers, LayerTools &layer_tools)
+{
+    WipingExtrusions &wiping_extrusions = layer_tools.wiping_extrusions();
+    if (layer_tools.extruders.empty() || ! wiping_extrusions.is_anything_overridden())
+        return;
+    for (const LayerToPrint &layer_to_print : layers) {
+        if (layer_to_print.object_layer == nullptr)
+            continue;
+        for (const LayerRegion *layerm : layer_to_print.object_layer->regions()) {
+            if (layerm == nullptr)
+                continue;
+            const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
+            for (const ExtrusionEntitiesPtr *entities : { &layerm->fills.entities, &layerm->perimeters.entities })
+                for (const ExtrusionEntity *ee : *entities) {
+                    const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+                    if (! extrusions->entities.empty())
+                        wiping_extrusions.prepare_extruder_overrides(extrusions, layer_to_print.original_object,
+                            extrusions_extruder_id(layer_tools, *extrusions, region), layer_to_print.object()->instances().size());
+                }
+        }
+    }
+}
+
+GCode::LayerPreparation GCode::prepare_layer(const Print &print, const std::vector<LayerToPrint> &layers, const LayerTools &layer_tools)
+{
+    LayerPreparation out;
+    out.by_extruder = group_extrusions_by_extruder(print, layers, layer_tools);
+    for (const LayerToPrint &layer_to_print : layers)
+        if (layer_to_print.object_layer != nullptr && layer_has_overhang_speed(*layer_to_print.object_layer))
+            out.overhang_boundaries.emplace_back(ExtrusionQualityEstimator::layer_boundaries(*layer_to_print.object_layer));
+    return out;
+}
+
+GCode::ObjectsByExtruder GCode::group_extrusions_by_extruder(const Print &print, const std::vector<LayerToPrint> &layers, const LayerTools &layer_tools)
+{
+    ObjectsByExtruder by_extruder;
+    if (layer_tools.extruders.empty())
+        return by_extruder;
+    unsigned int first_extruder_id = layer_tools.extruders.front();
+    bool is_anything_overridden = layer_tools.wiping_extrusions().is_anything_overridden();
+    for (const LayerToPrint &layer_to_print : layers) {
+        if (layer_to_print.support_layer != nullptr) {
+            const SupportLayer &support_layer = *layer_to_print.support_layer;
+            const PrintObject& object = *layer_to_print.original_object;
+            if (! support_layer.support_fills.entities.empty()) {
+                ExtrusionRole   role               = support_layer.support_fills.role();
+                bool            has_support        = role == erMixed || role == erSupportMaterial || role == erSupportTransition;
+                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
+                // Extruder ID of the support base. -1 if "don't care".
+                unsigned int    support_extruder   = object.config().support_filament.value - 1;
+                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            support_dontcare   = object.config().support_filament.value == 0;
+                // Extruder ID of the support interface. -1 if "don't care".
+                unsigned int    interface_extruder = object.config().support_interface_filament.value - 1;
+                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            interface_dontcare = object.config().support_interface_filament.value == 0;
+
+                // BBS: apply wiping overridden extruders
+                const WipingExtrusions& wiping_extrusions = layer_tools.wiping_extrusions();
+                if (support_dontcare) {
+                    int extruder_override = wiping_extrusions.get_support_extruder_overrides(&object);
+                    if (extruder_override >= 0) {
+                        support_extruder = extruder_override;
+                        support_dontcare = false;
+                    }
+                }
+
+                if (interface_dontcare) {
+                    int extruder_override = wiping_extrusions.get_support_interface_extruder_overrides(&object);
+                    if (extruder_override >= 0) {
+                        interface_extruder = extruder_override;
+                        interface_dontcare = false;
+                    }
+                }
+
+                // BBS: try to print support base with a filament other than interface filament
+                if (support_dontcare && !interface_dontcare) {
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    for (unsigned int extruder_id : layer_tools.extruders) {
+                        if (print.config().filament_soluble.get_at(extruder_id))
+                            continue;
+
+                        //BBS: now we don't consider interface filament used in other object
+                        if (extruder_id == interface_extruder)
+                            continue;
+
+                        dontcare_extruder = extruder_id;
+                        break;
+                    }
+                #if 0
+                    //BBS: not found a suitable extruder in current layer ,dontcare_extruider==first_extruder_id==interface_extruder
+                    if (dontcare_extruder == interface_extruder && (object.config().support_interface_not_for_body && object.config().support_interface_filament.value!=0)) {
+                        // BBS : get a suitable extruder from other layer
+                        auto all_extruders = print.extruders();
+                        dontcare_extruder = get_next_extruder(dontcare_extruder, all_extruders);
+                    }
+                #endif
+
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                }
+                else if (support_dontcare || interface_dontcare) {
+                    // Some support will be printed with "don't care" material, preferably non-soluble.
+                    // Is the current extruder assigned a soluble filament?
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
+                        // The last extruder printed on the previous layer extrudes soluble filament.
+                        // Try to find a non-soluble extruder on the same layer.
+                        for (unsigned int extruder_id : layer_tools.extruders)
+                            if (! print.config().filament_soluble.get_at(extruder_id)) {
+                                dontcare_extruder = extruder_id;
+                                break;
+                            }
+                    }
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                    if (interface_dontcare)
+                        interface_extruder = dontcare_extruder;
+                }
+                // Both the support and the support interface are printed with the same extruder, therefore
+                // the interface may be interleaved with the support base.
+                bool single_extruder = ! has_support || support_extruder == interface_extruder;
+                // Assign an extruder to the base.
+                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
+                obj.support = &support_layer.support_fills;
+                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
+                if (! single_extruder && has_interface) {
+                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
+                    obj_interface.support = &support_layer.support_fills;
+                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
+                }
+            }
+        }
+
+        if (layer_to_print.object_layer != nullptr) {
+            const Layer &layer = *layer_to_print.object_layer;
+            // We now define a strategy for building perimeters and fills. The separation
+            // between regions doesn't matter in terms of printing order, as we follow
+            // another logic instead:
+            // - we group all extrusions by extruder so that we minimize toolchanges
+            // - we start from the last used extruder
+            // - for each extruder, we group extrusions by island
+            // - for each island, we extrude perimeters first, unless user set the infill_first
+            //   option
+            // (Still, we have to keep track of regions because we need to apply their config)
+            size_t n_slices = layer.lslices.size();
+            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
+            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
+            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
+            std::vector<size_t> slices_test_order;
+            slices_test_order.reserve(n_slices);
+            for (size_t i = 0; i < n_slices; ++ i)
+                slices_test_order.emplace_back(i);
+            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
+                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
+                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
+                return s1.x() * s1.y() < s2.x() * s2.y();
+            });
+            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
+                const BoundingBox &bbox = layer_surface_bboxes[i];
+                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
+                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
+                       layer.lslices[i].contour.contains(point);
+            };
+
+            for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
+                const LayerRegion *layerm = layer.regions()[region_id];
+                if (layerm == nullptr)
+                    continue;
+                // PrintObjects own the PrintRegions, thus the pointer to PrintRegion would be unique to a PrintObject, they would not
+                // identify the content of PrintRegion accross the whole print uniquely. Translate to a Print specific PrintRegion.
+                const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
+
+                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
+                // It is also necessary to save which extrusions are part of MM wiping and which are not.
+                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
+                std::vector<unsigned int> printing_extruders;
+                for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
+                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
+                        // extrusions represents infill or perimeter extrusions of a single island.
+                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
+                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+                        if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
+                            continue;
+
+                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
+                        int correct_extruder_id = extrusions_extruder_id(layer_tools, *extrusions, region);
+
+                        // Let's recover vector of extruder overrides, prepared by prepare_extruder_overrides():
+                        const WipingExtrusions::ExtruderPerCopy *entity_overrides = nullptr;
+                        printing_extruders.clear();
+                        if (is_anything_overridden) {
+                            entity_overrides = layer_tools.wiping_extrusions().get_extruder_overrides(extrusions, layer_to_print.original_object);
+                            if (entity_overrides == nullptr) {
+                                printing_extruders.emplace_back(correct_extruder_id);
+                            } else {
+                                printing_extruders.reserve(entity_overrides->size());
+                                for (int extruder : *entity_overrides)
+                                    printing_extruders.emplace_back(extruder >= 0 ?
+                                        // at least one copy is overridden to use this extruder
+                                        extruder :
+                                        // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
+                                        static_cast<unsigned int>(- extruder - 1));
+                                Slic3r::sort_remove_duplicates(printing_extruders);
+                            }
+                        } else
+                            printing_extruders.emplace_back(correct_extruder_id);
+
+                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
+                        for (unsigned int extruder : printing_extruders)
+                        {
+                            std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
+                                by_extruder,
+                                extruder,
+                                &layer_to_print - layers.data(),
+                                layers.size(), n_slices+1);
+                            for (size_t i = 0; i <= n_slices; ++ i) {
+                                bool   last = i == n_slices;
+                                size_t island_idx = last ? n_slices : slices_test_order[i];
+                                if (// extrusions->first_point does not fit inside any slice
+                                    last ||
+                                    // extrusions->first_point fits inside ith slice
+                                    point_inside_surface(island_idx, extrusions->first_point())) {
+                                    if (islands[island_idx].by_region.empty())
+                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
+                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            } // for regions
+        }
+    } // for objects
+    return by_extruder;
 }
 
-// In sequential mode, process_layer is called once per each object and its copy,
-// therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
-// In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
-// For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
-// and performing the extruder specific extrusions together.
 LayerResult GCode::process_layer(
     const Print                    			&print,
     // Set of object & print layers of the same PrintObject and with the same print_z.
@@ -3657,7 +3946,8 @@ LayerResult GCode::process_layer(
     // Otherwise print a single copy of a single object.
     const size_t                     		 single_object_instance_idx,
     // BBS
-    const bool                               prime_extruder)
+    const bool                               prime_extruder,
+    LayerPreparation                       &&prepared)
 {
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
@@ -3982,222 +4272,17 @@ LayerResult GCode::process_layer(
         return next_extruder;
     };
     
-    for (const auto &layer_to_print : layers) {
-        if (layer_to_print.object_layer) {
-            const auto& regions = layer_to_print.object_layer->regions();
-            const bool  enable_overhang_speed = std::any_of(regions.begin(), regions.end(), [](const LayerRegion* r) {
-                return r->has_extrusions() && r->region().config().enable_overhang_speed;
-            });
-            if (enable_overhang_speed) {
-                m_extrusion_quality_estimator.prepare_for_new_layer(layer_to_print.original_object,
-                                                                    layer_to_print.object_layer);
-            }
-        }
-    }
-
-    // Group extrusions by an extruder, then by an object, an island and a region.
-    std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
-    bool is_anything_overridden = const_cast<LayerTools&>(layer_tools).wiping_extrusions().is_anything_overridden();
-    for (const LayerToPrint &layer_to_print : layers) {
-        if (layer_to_print.support_layer != nullptr) {
-            const SupportLayer &support_layer = *layer_to_print.support_layer;
-            const PrintObject& object = *layer_to_print.original_object;
-            if (! support_layer.support_fills.entities.empty()) {
-                ExtrusionRole   role               = support_layer.support_fills.role();
-                bool            has_support        = role == erMixed || role == erSupportMaterial || role == erSupportTransition;
-                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
-                // Extruder ID of the support base. -1 if "don't care".
-                unsigned int    support_extruder   = object.config().support_filament.value - 1;
-                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            support_dontcare   = object.config().support_filament.value == 0;
-                // Extruder ID of the support interface. -1 if "don't care".
-                unsigned int    interface_extruder = object.config().support_interface_filament.value - 1;
-                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            interface_dontcare = object.config().support_interface_filament.value == 0;
-
-                // BBS: apply wiping overridden extruders
-                WipingExtrusions& wiping_extrusions = const_cast<LayerTools&>(layer_tools).wiping_extrusions();
-                if (support_dontcare) {
-                    int extruder_override = wiping_extrusions.get_support_extruder_overrides(&object);
-                    if (extruder_override >= 0) {
-                        support_extruder = extruder_override;
-                        support_dontcare = false;
-                    }
-                }
-
-                if (interface_dontcare) {
-                    int extruder_override = wiping_extrusions.get_support_interface_extruder_overrides(&object);
-                    if (extruder_override >= 0) {
-                        interface_extruder = extruder_override;
-                        interface_dontcare = false;
-                    }
-                }
-
-                // BBS: try to print support base with a filament other than interface filament
-                if (support_dontcare && !interface_dontcare) {
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    for (unsigned int extruder_id : layer_tools.extruders) {
-                        if (print.config().filament_soluble.get_at(extruder_id))
-                            continue;
-
-                        //BBS: now we don't consider interface filament used in other object
-                        if (extruder_id == interface_extruder)
-                            continue;
-
-                        dontcare_extruder = extruder_id;
-                        break;
-                    }
-                #if 0
-                    //BBS: not found a suitable extruder in current layer ,dontcare_extruider==first_extruder_id==interface_extruder
-                    if (dontcare_extruder == interface_extruder && (object.config().support_interface_not_for_body && object.config().support_interface_filament.value!=0)) {
-                        // BBS : get a suitable extruder from other layer
-                        auto all_extruders = print.extruders();
-                        dontcare_extruder = get_next_extruder(dontcare_extruder, all_extruders);
-                    }
-                #endif
-
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                }
-                else if (support_dontcare || interface_dontcare) {
-                    // Some support will be printed with "don't care" material, preferably non-soluble.
-                    // Is the current extruder assigned a soluble filament?
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
-                        // The last extruder printed on the previous layer extrudes soluble filament.
-                        // Try to find a non-soluble extruder on the same layer.
-                        for (unsigned int extruder_id : layer_tools.extruders)
-                            if (! print.config().filament_soluble.get_at(extruder_id)) {
-                                dontcare_extruder = extruder_id;
-                                break;
-                            }
-                    }
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                    if (interface_dontcare)
-                        interface_extruder = dontcare_extruder;
-                }
-                // Both the support and the support interface are printed with the same extruder, therefore
-                // the interface may be interleaved with the support base.
-                bool single_extruder = ! has_support || support_extruder == interface_extruder;
-                // Assign an extruder to the base.
-                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
-                obj.support = &support_layer.support_fills;
-                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
-                if (! single_extruder && has_interface) {
-                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
-                    obj_interface.support = &support_layer.support_fills;
-                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
-                }
-            }
+    // The boundaries of the layers with the overhang speed enabled were calculated by prepare_layer().
+    auto overhang_boundaries = prepared.overhang_boundaries.begin();
+    for (const auto &layer_to_print : layers)
+        if (layer_to_print.object_layer && layer_has_overhang_speed(*layer_to_print.object_layer)) {
+            assert(overhang_boundaries != prepared.overhang_boundaries.end());
+            m_extrusion_quality_estimator.prepare_for_new_layer(layer_to_print.original_object, std::move(*overhang_boundaries ++));
         }
 
-        if (layer_to_print.object_layer != nullptr) {
-            const Layer &layer = *layer_to_print.object_layer;
-            // We now define a strategy for building perimeters and fills. The separation
-            // between regions doesn't matter in terms of printing order, as we follow
-            // another logic instead:
-            // - we group all extrusions by extruder so that we minimize toolchanges
-            // - we start from the last used extruder
-            // - for each extruder, we group extrusions by island
-            // - for each island, we extrude perimeters first, unless user set the infill_first
-            //   option
-            // (Still, we have to keep track of regions because we need to apply their config)
-            size_t n_slices = layer.lslices.size();
-            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
-            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
-            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
-            std::vector<size_t> slices_test_order;
-            slices_test_order.reserve(n_slices);
-            for (size_t i = 0; i < n_slices; ++ i)
-                slices_test_order.emplace_back(i);
-            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
-                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
-                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
-                return s1.x() * s1.y() < s2.x() * s2.y();
-            });
-            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
-                const BoundingBox &bbox = layer_surface_bboxes[i];
-                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
-                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
-                       layer.lslices[i].contour.contains(point);
-            };
-
-            for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
-                const LayerRegion *layerm = layer.regions()[region_id];
-                if (layerm == nullptr)
-                    continue;
-                // PrintObjects own the PrintRegions, thus the pointer to PrintRegion would be unique to a PrintObject, they would not
-                // identify the content of PrintRegion accross the whole print uniquely. Translate to a Print specific PrintRegion.
-                const PrintRegion &region = print.get_print_region(layerm->region().print_region_id());
-
-                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
-                // It is also necessary to save which extrusions are part of MM wiping and which are not.
-                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
-                std::vector<unsigned int> printing_extruders;
-                for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
-                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
-                        // extrusions represents infill or perimeter extrusions of a single island.
-                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
-                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
-                        if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
-                            continue;
-
-                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
-                        int correct_extruder_id = layer_tools.extruder(*extrusions, region);
-
-                        // Let's recover vector of extruder overrides:
-                        const WipingExtrusions::ExtruderPerCopy *entity_overrides = nullptr;
-                        if (! layer_tools.has_extruder(correct_extruder_id)) {
-                            // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
-                            // by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
-                            correct_extruder_id = layer_tools.extruders.back();
-                        }
-                        printing_extruders.clear();
-                        if (is_anything_overridden) {
-                            entity_overrides = const_cast<LayerTools&>(layer_tools).wiping_extrusions().get_extruder_overrides(extrusions, layer_to_print.original_object, correct_extruder_id, layer_to_print.object()->instances().size());
-                            if (entity_overrides == nullptr) {
-                                printing_extruders.emplace_back(correct_extruder_id);
-                            } else {
-                                printing_extruders.reserve(entity_overrides->size());
-                                for (int extruder : *entity_overrides)
-                                    printing_extruders.emplace_back(extruder >= 0 ?
-                                        // at least one copy is overridden to use this extruder
-                                        extruder :
-                                        // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
-                                        static_cast<unsigned int>(- extruder - 1));
-                                Slic3r::sort_remove_duplicates(printing_extruders);
-                            }
-                        } else
-                            printing_extruders.emplace_back(correct_extruder_id);
-
-                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
-                        for (unsigned int extruder : printing_extruders)
-                        {
-                            std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
-                                by_extruder,
-                                extruder,
-                                &layer_to_print - layers.data(),
-                                layers.size(), n_slices+1);
-                            for (size_t i = 0; i <= n_slices; ++ i) {
-                                bool   last = i == n_slices;
-                                size_t island_idx = last ? n_slices : slices_test_order[i];
-                                if (// extrusions->first_point does not fit inside any slice
-                                    last ||
-                                    // extrusions->first_point fits inside ith slice
-                                    point_inside_surface(island_idx, extrusions->first_point())) {
-                                    if (islands[island_idx].by_region.empty())
-                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
-                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            } // for regions
-        }
-    } // for objects
+    // Extrusions grouped by an extruder, then by an object, an island and a region by prepare_layer().
+    ObjectsByExtruder by_extruder = std::move(prepared.by_extruder);
+    bool is_anything_overridden = layer_tools.wiping_extrusions().is_anything_overridden();
 
     if (m_wipe_tower)
         m_wipe_tower->set_is_first_print(true);
@@ -4403,7 +4488,7 @@ LayerResult GCode::process_layer(
                     ExtrusionEntityCollection support_eec;
 
                     // BBS
-                    WipingExtrusions& wiping_extrusions = const_cast<LayerTools&>(layer_tools).wiping_extrusions();
+                    const WipingExtrusions& wiping_extrusions = layer_tools.wiping_extrusions();
                     bool support_overridden = wiping_extrusions.is_support_overridden(layer_to_print.original_object);
                     bool support_intf_overridden = wiping_extrusions.is_support_interface_overridden(layer_to_print.original_object);
 
@@ -4898,7 +4983,7 @@ std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, dou
     
     if (!enable_seam_slope) {
         for (ExtrusionPaths::iterator path = paths.begin(); path != paths.end(); ++path) {
-            gcode += this->_extrude(*path, description, speed_for_path(*path));
+            this->_extrude(gcode, *path, description, speed_for_path(*path));
             // Orca: Adaptive PA - dont adapt PA after the first pultipath extrusion is completed
             // as we have already set the PA value to the average flow over the totality of the path
             // in the first extrude move
@@ -4934,7 +5019,7 @@ std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, dou
 
         // Then extrude it
         for (const auto& p : new_loop.get_all_paths()) {
-            gcode += this->_extrude(*p, description, speed_for_path(*p));
+            this->_extrude(gcode, *p, description, speed_for_path(*p));
             // Orca: Adaptive PA - dont adapt PA after the first pultipath extrusion is completed
             // as we have already set the PA value to the average flow over the totality of the path
             // in the first extrude move
@@ -5029,7 +5114,7 @@ std::string GCode::extrude_multi_path(ExtrusionMultiPath multipath, std::string
     // Orca: end of multipath average mm3_per_mm value calculation
     
     for (ExtrusionPath path : multipath.paths){
-        gcode += this->_extrude(path, description, speed);
+        this->_extrude(gcode, path, description, speed);
         // Orca: Adaptive PA - dont adapt PA after the first pultipath extrusion is completed
         // as we have already set the PA value to the average flow over the totality of the path
         // in the first extrude move.
@@ -5072,7 +5157,8 @@ std::string GCode::extrude_path(ExtrusionPath path, std::string description, dou
     m_multi_flow_segment_path_pa_set = false;
     m_multi_flow_segment_path_average_mm3_per_mm = 0;
     //    description += ExtrusionEntity::role_to_string(path.role());
-    std::string gcode = this->_extrude(path, description, speed);
+    std::string gcode;
+    this->_extrude(gcode, path, description, speed);
     if (m_wipe.enable) {
         m_wipe.path = std::move(path.polyline);
         m_wipe.path.reverse();
@@ -5186,32 +5272,153 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
     return gcode;
 }
 
+// Size of the chunk handed over to the writer thread.
+static constexpr size_t GCODE_OUTPUT_CHUNK_SIZE = 4 * 1024 * 1024;
+// Maximum number of chunks waiting for the writer thread before the G-code generation is blocked.
+static constexpr size_t GCODE_OUTPUT_MAX_PENDING_CHUNKS = 4;
+
 bool GCode::GCodeOutputStream::is_error() const
 {
-    return ::ferror(this->f);
+    return m_write_error || ::ferror(this->f);
 }
 
 void GCode::GCodeOutputStream::flush()
 {
+    if (! this->f)
+        return;
+    if (! m_chunk.empty())
+        this->enqueue_chunk();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_chunks_to_write.empty() && ! m_writing; });
+    }
     ::fflush(this->f);
 }
 
 void GCode::GCodeOutputStream::close()
 {
     if (this->f) {
+        this->flush();
+        if (m_writer_thread.joinable()) {
+            {
+                std::scoped_lock<std::mutex> lock(m_mutex);
+                m_writer_exit = true;
+            }
+            m_condition.notify_all();
+            m_writer_thread.join();
+        }
         ::fclose(this->f);
         this->f = nullptr;
     }
 }
 
+void GCode::GCodeOutputStream::write(const std::string &what)
+{
+    this->write(what.c_str(), what.size());
+}
+
 void GCode::GCodeOutputStream::write(const char *what)
 {
-    if (what != nullptr) {
-        const char* gcode = what;
-        // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), this->f);
-        //FIXME don't allocate a string, maybe process a batch of lines?
-        m_processor.process_buffer(std::string(gcode));
+    if (what != nullptr)
+        this->write(what, strlen(what));
+}
+
+void GCode::GCodeOutputStream::write(const char *what, size_t size)
+{
+    if (size > 0) {
+        if (m_chunk.capacity() < GCODE_OUTPUT_CHUNK_SIZE)
+            m_chunk.reserve(GCODE_OUTPUT_CHUNK_SIZE);
+        m_chunk.append(what, size);
+        m_file_pos += size;
+        if (m_chunk.size() >= GCODE_OUTPUT_CHUNK_SIZE)
+            this->enqueue_chunk();
+        m_processor.process_buffer(what, what + size);
+        // Reserve the lines for the M73 lines if due, between the complete lines.
+        if (what[size - 1] == '\n') {
+            if (const auto [num_lines, line_width] = m_processor.reserved_lines_M73(); num_lines > 0) {
+                std::string reserved;
+                reserved.reserve(num_lines * line_width);
+                for (size_t i = 0; i < num_lines; ++ i)
+                    reserved.append(1, ';').append(line_width - 2, ' ') += '\n';
+                m_processor.reserve_lines_M73(m_file_pos, num_lines, line_width);
+                this->write(reserved.data(), reserved.size());
+            }
+        }
+    }
+}
+
+void GCode::GCodeOutputStream::write_reserved(const std::string &what)
+{
+    for (size_t begin = 0; begin < what.size();) {
+        size_t end = what.find('\n', begin);
+        if (end == std::string::npos) {
+            this->write(what.substr(begin));
+            break;
+        }
+        ++ end;
+        const std::string line = what.substr(begin, end - begin);
+        const auto [num_lines, line_width] = m_processor.reserved_lines(std::string_view(line).substr(0, line.size() - 1));
+        if (num_lines == 0 || line.size() > line_width)
+            this->write(line);
+        else {
+            // The first line is the padded line to be replaced, the others are padded empty comments.
+            std::string reserved;
+            reserved.reserve(num_lines * line_width);
+            reserved.append(line, 0, line.size() - 1).append(line_width - line.size(), ' ') += '\n';
+            for (size_t i = 1; i < num_lines; ++ i)
+                reserved.append(1, ';').append(line_width - 2, ' ') += '\n';
+            m_processor.reserve_lines(line, m_file_pos, num_lines, line_width);
+            this->write(reserved);
+        }
+        begin = end;
+    }
+}
+
+void GCode::GCodeOutputStream::enqueue_chunk()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (! m_writer_thread.joinable()) {
+        // The GCodeProcessor is configured before the first chunk is written.
+        m_collect_lines_ends = m_processor.post_process_in_place();
+        m_writer_thread = std::thread([this]() { this->writer_thread(); });
+    }
+    m_condition.wait(lock, [this]() { return m_chunks_to_write.size() < GCODE_OUTPUT_MAX_PENDING_CHUNKS; });
+    m_chunks_to_write.emplace_back(std::move(m_chunk));
+    if (m_chunks_pool.empty())
+        m_chunk = std::string();
+    else {
+        m_chunk = std::move(m_chunks_pool.back());
+        m_chunks_pool.pop_back();
+    }
+    lock.unlock();
+    m_condition.notify_all();
+}
+
+void GCode::GCodeOutputStream::writer_thread()
+{
+    size_t file_pos = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_condition.wait(lock, [this]() { return m_writer_exit || ! m_chunks_to_write.empty(); });
+        if (m_chunks_to_write.empty())
+            // m_writer_exit is set and all chunks were written.
+            break;
+        std::string chunk = std::move(m_chunks_to_write.front());
+        m_chunks_to_write.pop_front();
+        m_writing = true;
+        lock.unlock();
+        if (::fwrite(chunk.data(), 1, chunk.size(), this->f) != chunk.size())
+            m_write_error = true;
+        if (m_collect_lines_ends)
+            for (size_t i = 0; i < chunk.size(); ++ i)
+                if (chunk[i] == '\n')
+                    m_lines_ends.emplace_back(file_pos + i + 1);
+        file_pos += chunk.size();
+        chunk.clear();
+        lock.lock();
+        m_writing = false;
+        m_chunks_pool.emplace_back(std::move(chunk));
+        m_condition.notify_all();
     }
 }
 
@@ -5245,7 +5452,7 @@ void GCode::GCodeOutputStream::write_format(const char* format, ...)
     char *bufptr = buffer_dynamic ? (char*)malloc(buflen) : buffer;
     int res = ::vsnprintf(bufptr, buflen, format, args);
     if (res > 0)
-        this->write(bufptr);
+        this->write(bufptr, size_t(res));
 
     if (buffer_dynamic)
         free(bufptr);
@@ -5272,10 +5479,8 @@ bool GCode::_needSAFC(const ExtrusionPath &path)
     });
 }
 
-std::string GCode::_extrude(const ExtrusionPath &path, std::string description, double speed)
+void GCode::_extrude(std::string &gcode, const ExtrusionPath &path, std::string description, double speed)
 {
-    std::string gcode;
-
     if (is_bridge(path.role()))
         description += " (bridge)";
 
@@ -5817,7 +6022,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             // ORCA: End of adaptive PA code segment
         }
         
-        gcode += m_writer.set_speed(F, "", comment);
+        m_writer.set_speed(gcode, F, "", comment);
         {
             if (m_enable_cooling_markers) {
                 if (enable_overhang_bridge_fan) {
@@ -5838,8 +6043,9 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             if (!m_config.enable_arc_fitting || path.polyline.fitting_result.empty() || m_config.spiral_mode || sloped != nullptr) {
                 double path_length = 0.;
                 double total_length = sloped == nullptr ? 0. : path.polyline.length() * SCALING_FACTOR;
+                std::string tempDescription;
                 for (const Line& line : path.polyline.lines()) {
-                    std::string tempDescription = description;
+                    tempDescription = description;
                     const double line_length = line.length() * SCALING_FACTOR;
                     if (line_length < EPSILON)
                         continue;
@@ -5855,26 +6061,27 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                     }
                     if (sloped == nullptr) {
                         // Normal extrusion
-                        gcode += m_writer.extrude_to_xy(
+                        m_writer.extrude_to_xy(gcode,
                             this->point_to_gcode(line.b),
                             dE,
-                            GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                            GCodeWriter::full_gcode_comment ? std::string_view(tempDescription) : std::string_view(), path.is_force_no_extrusion());
                     } else {
                         // Sloped extrusion
                         const auto [z_ratio, e_ratio] = sloped->interpolate(path_length / total_length);
                         Vec2d dest2d = this->point_to_gcode(line.b);
                         Vec3d dest3d(dest2d(0), dest2d(1), get_sloped_z(z_ratio));
-                        gcode += m_writer.extrude_to_xyz(
+                        m_writer.extrude_to_xyz(gcode,
                             dest3d,
                             dE * e_ratio,
-                            GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                            GCodeWriter::full_gcode_comment ? std::string_view(tempDescription) : std::string_view(), path.is_force_no_extrusion());
                     }
                 }
             } else {
                 // BBS: start to generate gcode from arc fitting data which includes line and arc
                 const std::vector<PathFittingData>& fitting_result = path.polyline.fitting_result;
+                std::string tempDescription;
                 for (size_t fitting_index = 0; fitting_index < fitting_result.size(); fitting_index++) {
-                    std::string tempDescription = description;
+                    tempDescription = description;
                     switch (fitting_result[fitting_index].path_type) {
                     case EMovePathType::Linear_move: {
                         size_t start_index = fitting_result[fitting_index].start_point_index;
@@ -5894,10 +6101,10 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                                     tempDescription += Slic3r::format(" | Old Flow Value: %0.5f Length: %0.5f",oldE, line_length);
                                 }
                             }
-                            gcode += m_writer.extrude_to_xy(
+                            m_writer.extrude_to_xy(gcode,
                                 this->point_to_gcode(line.b),
                                 dE,
-                                GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                                GCodeWriter::full_gcode_comment ? std::string_view(tempDescription) : std::string_view(), path.is_force_no_extrusion());
                         }
                         break;
                     }
@@ -5917,12 +6124,12 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                                 tempDescription += Slic3r::format(" | Old Flow Value: %0.5f Length: %0.5f",oldE, arc_length);
                             }
                         }
-                        gcode += m_writer.extrude_arc_to_xy(
+                        m_writer.extrude_arc_to_xy(gcode,
                             this->point_to_gcode(arc.end_point),
                             center_offset,
                             dE,
                             arc.direction == ArcDirection::Arc_Dir_CCW,
-                            GCodeWriter::full_gcode_comment ? tempDescription : "", path.is_force_no_extrusion());
+                            GCodeWriter::full_gcode_comment ? std::string_view(tempDescription) : std::string_view(), path.is_force_no_extrusion());
                         break;
                     }
                     default:
@@ -5945,7 +6152,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             Polyline l(p);
             total_length = l.length() * SCALING_FACTOR;
         }
-        gcode += m_writer.set_speed(last_set_speed, "", comment);
+        m_writer.set_speed(gcode, last_set_speed, "", comment);
         Vec2d prev = this->point_to_gcode_quantized(new_points[0].p);
         bool pre_fan_enabled = false;
         bool cur_fan_enabled = false;
@@ -5956,8 +6163,10 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             pre_fan_enabled = true;
 
         double path_length = 0.;
+        // Reused by the moves, thus its buffer is allocated once per path.
+        std::string tempDescription;
         for (size_t i = 1; i < new_points.size(); i++) {
-            std::string tempDescription = description;
+            tempDescription = description;
             const ProcessedPoint &processed_point = new_points[i];
             const ProcessedPoint &pre_processed_point = new_points[i-1];
             Vec2d p = this->point_to_gcode_quantized(processed_point.p);
@@ -6027,10 +6236,10 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             // Ignore small speed variations - emit speed change if the delta between current and new is greater than 60mm/min / 1mm/sec
             // Reset speed to F if delta to F is less than 1mm/sec
             if ((std::abs(last_set_speed - new_speed) > 60)) {
-                gcode += m_writer.set_speed(new_speed, "", comment);
+                m_writer.set_speed(gcode, new_speed, "", comment);
                 last_set_speed = new_speed;
             } else if ((std::abs(F - new_speed) <= 60)) {
-                gcode += m_writer.set_speed(F, "", comment);
+                m_writer.set_speed(gcode, F, "", comment);
                 last_set_speed = F;
             }
             auto dE = e_per_mm * line_length;
@@ -6044,12 +6253,12 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             }
             if (sloped == nullptr) {
                 // Normal extrusion
-                gcode += m_writer.extrude_to_xy(p, dE, GCodeWriter::full_gcode_comment ? tempDescription : "");
+                m_writer.extrude_to_xy(gcode, p, dE, GCodeWriter::full_gcode_comment ? std::string_view(tempDescription) : std::string_view());
             } else {
                 // Sloped extrusion
                 const auto [z_ratio, e_ratio] = sloped->interpolate(path_length / total_length);
                 Vec3d dest3d(p(0), p(1), get_sloped_z(z_ratio));
-                gcode += m_writer.extrude_to_xyz(dest3d, dE * e_ratio, GCodeWriter::full_gcode_comment ? tempDescription : "");
+                m_writer.extrude_to_xyz(gcode, dest3d, dE * e_ratio, GCodeWriter::full_gcode_comment ? std::string_view(tempDescription) : std::string_view());
             }
 
             prev = p;
@@ -6065,7 +6274,6 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
     }
 
     this->set_last_pos(path.last_point());
-    return gcode;
 }
 
 //Orca: get string name of extrusion role. used for change_extruder_role_gcode
@@ -6229,14 +6437,14 @@ std::string GCode::travel_to(const Point& point, ExtrusionRole role, std::string
         if (false/*m_spiral_vase*/) {
             // No lazy z lift for spiral vase mode
             for (size_t i = 1; i < travel.size(); ++i) {
-                gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), comment);
+                m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), comment);
             }
         } else {
             if (travel.size() == 2) {
                 // No extra movements emitted by avoid_crossing_perimeters, simply move to the end point with z change
                 const auto& dest2d = this->point_to_gcode(travel.points.back());
                 Vec3d dest3d(dest2d(0), dest2d(1), z == DBL_MAX ? m_nominal_z : z);
-                gcode += m_writer.travel_to_xyz(dest3d, comment, m_need_change_layer_lift_z);
+                m_writer.travel_to_xyz(gcode, dest3d, comment, m_need_change_layer_lift_z);
                 m_need_change_layer_lift_z = false;
             } else {
                 // Extra movements emitted by avoid_crossing_perimeters, lift the z to normal height at the beginning, then apply the z
@@ -6246,16 +6454,16 @@ std::string GCode::travel_to(const Point& point, ExtrusionRole role, std::string
                         // Lift to normal z at beginning
                         Vec2d dest2d = this->point_to_gcode(travel.points[i]);
                         Vec3d dest3d(dest2d(0), dest2d(1), m_nominal_z);
-                        gcode += m_writer.travel_to_xyz(dest3d, comment, m_need_change_layer_lift_z);
+                        m_writer.travel_to_xyz(gcode, dest3d, comment, m_need_change_layer_lift_z);
                         m_need_change_layer_lift_z = false;
                     } else if (z != DBL_MAX && i == travel.size() - 1) {
                         // Apply z_ratio for the very last point
                         Vec2d dest2d = this->point_to_gcode(travel.points[i]);
                         Vec3d dest3d(dest2d(0), dest2d(1), z);
-                        gcode += m_writer.travel_to_xyz(dest3d, comment);
+                        m_writer.travel_to_xyz(gcode, dest3d, comment);
                     } else {
                         // For all points in between, no z change
-                        gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), comment);
+                        m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), comment);
                     }
                 }
             }
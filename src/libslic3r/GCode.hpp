@@ -27,10 +27,16 @@
 // ORCA: post processor below used for Dynamic Pressure advance
 #include "GCode/AdaptivePAProcessor.hpp"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <deque>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <cfloat>
 
 namespace Slic3r {
@@ -277,6 +283,8 @@ public:
     };
 
 private:
+    // The G-code is collected into large chunks, which are written into the file by a background thread,
+    // so that the G-code generation does not wait for the disk. The chunks are recycled once written.
     class GCodeOutputStream {
     public:
         GCodeOutputStream(FILE *f, GCodeProcessor &processor) : f(f), m_processor(processor) {}
@@ -285,13 +293,18 @@ private:
         bool is_open() const { return f; }
         bool is_error() const;
 
+        // Waits for the pending chunks to be written and flushes the file.
         void flush();
         void close();
 
         // Write a string into a file.
-        void write(const std::string& what) { this->write(what.c_str()); }
+        void write(const std::string& what);
         void write(const char* what);
 
+        // Write lines to be replaced by the post-processing of the GCodeProcessor. If it post processes in place,
+        // each line is padded with spaces into the lines it reserves for the final values.
+        void write_reserved(const std::string& what);
+
         // Write a string into a file.
         // Add a newline, if the string does not end with a newline already.
         // Used to export a custom G-code section processed by the PlaceholderParser.
@@ -300,9 +313,37 @@ private:
         // Formats and write into a file the given data.
         void write_format(const char* format, ...);
 
+        // Ends of the lines written, collected by the writer thread if the GCodeProcessor post processes in place.
+        std::vector<size_t>&& extract_lines_ends() { return std::move(m_lines_ends); }
+
     private:
+        // Write a null terminated string of the given length into a file.
+        void write(const char* what, size_t size);
+        // Hands m_chunk over to the writer thread, blocks if too many chunks are waiting to be written.
+        void enqueue_chunk();
+        void writer_thread();
+
         FILE *f = nullptr;
         GCodeProcessor &m_processor;
+
+        // Chunk being filled.
+        std::string              m_chunk;
+        // Size of the G-code written so far, including m_chunk.
+        size_t                   m_file_pos { 0 };
+        // Accessed by the writer thread only until it is joined.
+        bool                     m_collect_lines_ends { false };
+        std::vector<size_t>      m_lines_ends;
+        // Chunks waiting for the writer thread, in the order of the G-code.
+        std::deque<std::string>  m_chunks_to_write;
+        // Written chunks, to be reused.
+        std::vector<std::string> m_chunks_pool;
+        // Writer thread is writing a chunk.
+        bool                     m_writing { false };
+        bool                     m_writer_exit { false };
+        std::atomic<bool>        m_write_error { false };
+        std::mutex               m_mutex;
+        std::condition_variable  m_condition;
+        std::thread              m_writer_thread;
     };
     void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
 
@@ -317,6 +358,27 @@ private:
         const Layer& layer,
         unsigned int extruder_id);
 
+    struct ObjectByExtruder;
+    using ObjectsByExtruder = std::map<unsigned int, std::vector<ObjectByExtruder>>;
+    // Group extrusions of a layer by an extruder, then by an object, an island and a region.
+    // Independent of the state of the G-code generator, thus the extrusions of the next layers are grouped in parallel
+    // with process_layer() generating the current one.
+    // The overrides of the wiping extrusions shall be prepared by prepare_extruder_overrides() before.
+    static ObjectsByExtruder group_extrusions_by_extruder(const Print &print, const std::vector<LayerToPrint> &layers, const LayerTools &layer_tools);
+    // Resolves the extruders of the extrusions not overridden by the wiping extrusions of a layer. Called serially for all layers
+    // before they are grouped by group_extrusions_by_extruder() in parallel, which then only reads the overrides.
+    static void prepare_extruder_overrides(const Print &print, const std::vector<LayerToPrint> &layers, LayerTools &layer_tools);
+
+    // Data of the layers at a single print_z, which do not depend on the state of the G-code generator.
+    // Calculated by prepare_layer() for the layers ahead in parallel with process_layer() generating the current one.
+    struct LayerPreparation {
+        // Output of group_extrusions_by_extruder().
+        ObjectsByExtruder                                       by_extruder;
+        // Boundaries of the object layers with the overhang speed enabled, in the order of the layers.
+        std::vector<ExtrusionQualityEstimator::LayerBoundaries> overhang_boundaries;
+    };
+    LayerPreparation prepare_layer(const Print &print, const std::vector<LayerToPrint> &layers, const LayerTools &layer_tools);
+
     LayerResult process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
@@ -327,15 +389,17 @@ private:
 		const std::vector<const PrintInstance*> *ordering,
         // If set to size_t(-1), then print all copies of all objects.
         // Otherwise print a single copy of a single object.
-        const size_t                     single_object_idx = size_t(-1),
+        const size_t                     single_object_idx,
         // BBS
-        const bool                       prime_extruder = false);
+        const bool                       prime_extruder,
+        // Output of prepare_layer() for these layers, it is moved from.
+        LayerPreparation               &&prepared);
     // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
     void process_layers(
         const Print                                                         &print,
-        const ToolOrdering                                                  &tool_ordering,
+        ToolOrdering                                                        &tool_ordering,
         const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
         const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
         GCodeOutputStream                                                   &output_stream);
@@ -344,12 +408,20 @@ private:
     // and export G-code into file.
     void process_layers(
         const Print                             &print,
-        const ToolOrdering                      &tool_ordering,
+        ToolOrdering                            &tool_ordering,
         std::vector<LayerToPrint>                layers_to_print,
         const size_t                             single_object_idx,
         GCodeOutputStream                       &output_stream,
         // BBS
         const bool                               prime_extruder = false);
+    // The pipeline shared by both process_layers(): prepare_layer(layer_idx) runs in parallel for the layers ahead,
+    // generate_layer(layer_idx, prepared) runs serially in the order of the layers, followed by the filters and the output.
+    void process_layers_pipeline(
+        const Print                                                         &print,
+        size_t                                                               num_layers,
+        const std::function<LayerPreparation(size_t)>                       &prepare_layer,
+        const std::function<LayerResult(size_t, LayerPreparation&&)>        &generate_layer,
+        GCodeOutputStream                                                   &output_stream);
 
     //BBS
     void check_placeholder_parser_failed();
@@ -602,7 +674,8 @@ private:
     // BBS
     int get_bed_temperature(const int extruder_id, const bool is_first_layer, const BedType bed_type) const;
 
-    std::string _extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
+    // Append the G-code of the path to the G-code of the extrusion entity being exported.
+    void _extrude(std::string &gcode, const ExtrusionPath &path, std::string description = "", double speed = -1);
     bool _needSAFC(const ExtrusionPath &path);
     void print_machine_envelope(GCodeOutputStream &file, Print &print);
     void _print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
@@ -13,6 +13,7 @@
 #include <map>
 #include <vector>
 #include "AdaptivePAInterpolator.hpp"
+#include "GCodeLayerLines.hpp"
 
 namespace Slic3r {
 
@@ -41,10 +42,10 @@ public:
      * This method processes the G-code for a single layer, identifying the appropriate
      * pressure advance settings and applying them based on the current state and configurations.
      *
-     * @param gcode A string containing the G-code for the layer.
-     * @return A string containing the processed G-code with adaptive pressure advance applied.
+     * @param gcode The G-code lines of the layer.
+     * @return The processed G-code lines with adaptive pressure advance applied, each line terminated with a new line.
      */
-    std::string process_layer(std::string &&gcode);
+    GCodeLayerLines process_layer(GCodeLayerLines &&gcode);
     
     /**
      * @brief Manually sets adaptive PA internal value.
@@ -66,7 +67,7 @@ private:
 
     std::regex m_pa_change_pattern; ///< Regular expression to detect PA_CHANGE pattern.
     std::regex m_g1_f_pattern; ///< Regular expression to detect G1 F pattern.
-    std::smatch m_match; ///< Match results for regular expressions.
+    std::cmatch m_match; ///< Match results for regular expressions.
 
     /**
      * @brief Get the PA interpolator attached to the specified tool ID.
@@ -7,12 +7,17 @@
 #include "../Geometry.hpp"
 #include "../ClipperUtils.hpp"
 #include "../SVG.hpp"
+#include "../AStar.hpp"
+#include "../KDTreeIndirect.hpp"
 #include "AvoidCrossingPerimeters.hpp"
 
 #include <numeric>
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 struct TravelPoint
@@ -546,9 +551,88 @@ static float get_external_perimeter_width(const Layer &layer)
     return perimeter_width;
 }
 
-static size_t avoid_perimeters_inner(
-    const AvoidCrossingPerimeters::Boundary &boundary, const Point &start_point, const Point &end_point, const Layer &layer, std::vector<TravelPoint> &result_out)
+// The navigation graph extended by the entry and exit points of a travel, searched by route_over_graph().
+struct NavigationGraphTracer
+{
+    using Node = size_t;
+    const AvoidCrossingPerimeters::NavigationGraph &graph;
+    const EdgeGrid::Grid                           &grid;
+    // Entry and exit points, they are the two extra nodes of the graph.
+    Point                                           from, to;
+    // Nodes at the ends of the boundary lines containing the entry and exit points.
+    std::pair<size_t, size_t>                       from_nodes, to_nodes;
+
+    size_t       source() const { return graph.nodes.size(); }
+    size_t       goal()   const { return graph.nodes.size() + 1; }
+    const Point& point(size_t node) const { return node == this->source() ? from : node == this->goal() ? to : graph.nodes[node]; }
+
+    template<typename Fn> void foreach_reachable(size_t node, Fn &&fn) const {
+        if (node == this->source()) {
+            FirstIntersectionVisitor visitor(grid);
+            visitor.pt_current = &from;
+            visitor.pt_next    = &to;
+            grid.visit_cells_intersecting_line(from, to, visitor);
+            if ((! visitor.intersect && fn(this->goal())) || fn(from_nodes.first))
+                return;
+            fn(from_nodes.second);
+        } else if (node < graph.nodes.size()) {
+            if ((node == to_nodes.first || node == to_nodes.second) && fn(this->goal()))
+                return;
+            for (size_t idx = graph.adjacency_first[node]; idx < graph.adjacency_first[node + 1]; ++ idx)
+                if (fn(graph.adjacency[idx]))
+                    return;
+        }
+    }
+    float  distance(size_t a, size_t b) const { return float((this->point(b) - this->point(a)).cast<double>().norm()); }
+    float  goal_heuristic(size_t node) const { return node == this->goal() ? -1.f : this->distance(node, this->goal()); }
+    size_t unique_id(size_t node) const { return node; }
+};
+
+// Searches for the shortest route over the navigation graph from the entry point into the area of the travels at the first intersection
+// to the exit point at the last intersection. Returns false if there is no such route.
+static bool route_over_graph(const AvoidCrossingPerimeters::Boundary        &boundary,
+                             const AvoidCrossingPerimeters::NavigationGraph &graph,
+                             const Intersection                             &intersection_first,
+                             const Intersection                             &intersection_last,
+                             std::vector<TravelPoint>                       &result_out)
+{
+    const Polygons &boundaries = boundary.boundaries;
+    assert(graph.polygon_area.size() == boundaries.size());
+    if (graph.polygon_area[intersection_first.border_idx] != graph.polygon_area[intersection_last.border_idx])
+        return false;
+
+    auto edge_nodes = [&graph, &boundaries](const Intersection &intersection) {
+        const size_t first_node = graph.polygon_first_node[intersection.border_idx];
+        return std::make_pair(first_node + intersection.line_idx, first_node + next_idx_modulo(intersection.line_idx, boundaries[intersection.border_idx].points));
+    };
+    auto middle_point_offset = [&boundaries](const Intersection &intersection) {
+        const Polygon &polygon = boundaries[intersection.border_idx];
+        return get_middle_point_offset(polygon, intersection.line_idx, next_idx_modulo(intersection.line_idx, polygon.points), intersection.point, coord_t(SCALED_EPSILON));
+    };
+
+    NavigationGraphTracer tracer { graph, boundary.grid, middle_point_offset(intersection_first), middle_point_offset(intersection_last),
+                                   edge_nodes(intersection_first), edge_nodes(intersection_last) };
+
+    // The route from the goal back to the source, the source is not included.
+    std::vector<size_t> route;
+    if (! astar::search_route(tracer, tracer.source(), std::back_inserter(route)))
+        return false;
+    assert(! route.empty() && route.front() == tracer.goal());
+    result_out.push_back({tracer.from, int(intersection_first.border_idx), intersection_first.do_not_remove});
+    for (auto it = route.rbegin(); it + 1 != route.rend(); ++ it)
+        result_out.push_back({graph.nodes[*it], int(graph.polygon_idx(*it))});
+    result_out.push_back({tracer.to, int(intersection_last.border_idx), intersection_last.do_not_remove});
+    return true;
+}
+
+static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary        &boundary,
+                                     const AvoidCrossingPerimeters::NavigationGraph &graph,
+                                     const Point                                    &start_point,
+                                     const Point                                    &end_point,
+                                     const Layer                                    &layer,
+                                     std::vector<TravelPoint>                       &result_out)
 {
+
     const Polygons       &boundaries = boundary.boundaries;
     const EdgeGrid::Grid &edge_grid  = boundary.grid;
     Point                 start = start_point, end = end_point;
@@ -607,7 +691,10 @@ static size_t avoid_perimeters_inner(
     };
 #endif
 
-    for (auto it_first = intersections.begin(); it_first != intersections.end(); ++it_first) {
+    // Route over the navigation graph if the travel enters and leaves the same area, otherwise walk along the boundary polygons
+    // between the entry and exit intersections of each of them.
+    const bool routed = ! graph.empty() && intersections.size() > 1 && route_over_graph(boundary, graph, intersections.front(), intersections.back(), result);
+    for (auto it_first = intersections.begin(); ! routed && it_first != intersections.end(); ++it_first) {
         // The entry point to the boundary polygon
         const Intersection &intersection_first = *it_first;
         //        if(!crossing_boundary_from_inside(start, intersection_first))
@@ -688,15 +775,16 @@ static size_t avoid_perimeters_inner(
 }
 
 // Called by AvoidCrossingPerimeters::travel_to()
-static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary &boundary,
-                               const Point                             &start,
-                               const Point                             &end,
-                               const Layer                             &layer,
-                               Polyline                                &result_out)
+static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary        &boundary,
+                               const AvoidCrossingPerimeters::NavigationGraph &graph,
+                               const Point                                    &start,
+                               const Point                                    &end,
+                               const Layer                                    &layer,
+                               Polyline                                       &result_out)
 {
     // Travel line is completely or partially inside the bounding box.
     std::vector<TravelPoint> path;
-    size_t num_intersections = avoid_perimeters_inner(boundary, start, end, layer, path);
+    size_t num_intersections = avoid_perimeters_inner(boundary, graph, start, end, layer, path);
     result_out = to_polyline(path);
 
 
@@ -1229,6 +1317,183 @@ static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons
     init_boundary_distances(boundary);
 }
 
+void AvoidCrossingPerimeters::NavigationGraph::build(const Polygons &boundaries, std::vector<size_t> &&polygon_area)
+{
+    assert(polygon_area.size() == boundaries.size());
+    this->polygon_area = std::move(polygon_area);
+    this->nodes.clear();
+    this->polygon_first_node.assign(1, 0);
+    // Reflex vertices of the area of the travels, the shortest routes bend around them.
+    std::vector<size_t> reflex;
+    for (const Polygon &polygon : boundaries) {
+        for (size_t point_idx = 0; point_idx < polygon.size(); ++ point_idx) {
+            if (polygon.size() < 3) {
+                this->nodes.emplace_back(polygon.points[point_idx]);
+                continue;
+            }
+            const Point &middle = polygon.points[point_idx];
+            const Point &left   = find_first_different_vertex<false>(polygon, prev_idx_modulo(point_idx, polygon.points), middle);
+            const Point &right  = find_first_different_vertex<true>(polygon, next_idx_modulo(point_idx, polygon.points), middle);
+            // The area of the travels is on the left side of the boundary, thus its reflex vertices turn right.
+            if (cross2((middle - left).cast<double>(), (right - middle).cast<double>()) < 0.)
+                reflex.emplace_back(this->nodes.size());
+            this->nodes.emplace_back(get_polygon_vertex_offset(polygon, point_idx, coord_t(SCALED_EPSILON)));
+        }
+        this->polygon_first_node.emplace_back(this->nodes.size());
+    }
+
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t poly_idx = 0; poly_idx < boundaries.size(); ++ poly_idx) {
+        const size_t first = this->polygon_first_node[poly_idx];
+        const size_t last  = this->polygon_first_node[poly_idx + 1];
+        if (last - first > 1)
+            for (size_t node_idx = first; node_idx < last; ++ node_idx) {
+                const size_t next_idx = node_idx + 1 == last ? first : node_idx + 1;
+                edges.emplace_back(node_idx, next_idx);
+                edges.emplace_back(next_idx, node_idx);
+            }
+    }
+
+    // Shortcuts between the nearby reflex vertices of the same area, which see each other.
+    if (reflex.size() > 1) {
+        BoundingBox bbox(get_extents(boundaries));
+        bbox.merge(get_extents(this->nodes));
+        bbox.offset(SCALED_EPSILON);
+        EdgeGrid::Grid grid;
+        grid.set_bbox(bbox);
+        grid.create(boundaries, coord_t(scale_(1.)));
+        FirstIntersectionVisitor visitor(grid);
+        auto coordinate_fn = [this, &reflex](size_t idx, size_t dimension) { return double(this->nodes[reflex[idx]][dimension]); };
+        KDTreeIndirect<2, double, decltype(coordinate_fn)> tree(coordinate_fn, reflex.size());
+        for (size_t reflex_idx = 0; reflex_idx < reflex.size(); ++ reflex_idx) {
+            const size_t node_idx = reflex[reflex_idx];
+            const size_t area     = this->polygon_area[this->polygon_idx(node_idx)];
+            for (size_t other_reflex_idx : find_closest_points<8>(tree, this->nodes[node_idx].cast<double>(), [this, &reflex, reflex_idx, area](size_t idx) {
+                     return idx != reflex_idx && this->polygon_area[this->polygon_idx(reflex[idx])] == area; })) {
+                if (other_reflex_idx == decltype(tree)::npos)
+                    break;
+                const size_t other_node_idx = reflex[other_reflex_idx];
+                visitor.pt_current = &this->nodes[node_idx];
+                visitor.pt_next    = &this->nodes[other_node_idx];
+                visitor.intersect  = false;
+                grid.visit_cells_intersecting_line(*visitor.pt_current, *visitor.pt_next, visitor);
+                if (! visitor.intersect) {
+                    edges.emplace_back(node_idx, other_node_idx);
+                    edges.emplace_back(other_node_idx, node_idx);
+                }
+            }
+        }
+    }
+    sort_remove_duplicates(edges);
+
+    this->adjacency_first.assign(this->nodes.size() + 1, 0);
+    this->adjacency.clear();
+    this->adjacency.reserve(edges.size());
+    for (const std::pair<size_t, size_t> &edge : edges) {
+        ++ this->adjacency_first[edge.first + 1];
+        this->adjacency.emplace_back(edge.second);
+    }
+    std::partial_sum(this->adjacency_first.begin(), this->adjacency_first.end(), this->adjacency_first.begin());
+}
+
+size_t AvoidCrossingPerimeters::NavigationGraph::polygon_idx(size_t node_idx) const
+{
+    assert(node_idx < this->nodes.size());
+    return std::upper_bound(this->polygon_first_node.begin(), this->polygon_first_node.end(), node_idx) - this->polygon_first_node.begin() - 1;
+}
+
+void AvoidCrossingPerimeters::ExternalBoundaries::calculate(const Layer &layer) const
+{
+    if (! m_calculated) {
+        m_polygons = get_boundary_external(layer);
+        // All the boundaries outside of the objects delimit a single area.
+        m_graph.build(m_polygons, std::vector<size_t>(m_polygons.size(), 0));
+        m_calculated = true;
+    }
+}
+
+// Travel independent data of a layer. The external boundaries are passed in if already shared with another layer at the same print_z.
+static AvoidCrossingPerimeters::LayerDataPtr make_layer_data(const Layer &layer, std::shared_ptr<const AvoidCrossingPerimeters::ExternalBoundaries> external_boundaries)
+{
+    auto data = std::make_shared<AvoidCrossingPerimeters::LayerData>();
+    for (auto coeff : {0.6f, 0.5f, 0.45f}) {
+        data->lslices_offset = offset_ex(layer.lslices, -get_external_perimeter_width(layer) * coeff);
+        if (!data->lslices_offset.empty()) break;
+    }
+    data->lslices_offset_bboxes.reserve(data->lslices_offset.size());
+    for (const auto &ex_polygon : data->lslices_offset) data->lslices_offset_bboxes.emplace_back(get_extents(ex_polygon));
+
+    BoundingBox bbox_slice(get_extents(layer.lslices));
+    bbox_slice.offset(SCALED_EPSILON);
+
+    data->grid_lslice.set_bbox(bbox_slice);
+    //FIXME 1mm grid?
+    data->grid_lslice.create(data->lslices_offset, coord_t(scale_(1.)));
+
+    ExPolygons internal_boundaries = get_boundary(layer, get_perimeter_spacing(layer));
+    std::vector<size_t> polygon_area;
+    for (size_t area = 0; area < internal_boundaries.size(); ++ area)
+        polygon_area.insert(polygon_area.end(), internal_boundaries[area].holes.size() + 1, area);
+    data->internal_boundaries = to_polygons(std::move(internal_boundaries));
+    data->internal_graph.build(data->internal_boundaries, std::move(polygon_area));
+    data->external_boundaries = external_boundaries ? std::move(external_boundaries) : std::make_shared<const AvoidCrossingPerimeters::ExternalBoundaries>();
+    return data;
+}
+
+void AvoidCrossingPerimeters::prepare_layers(const std::vector<const Layer*> &layers)
+{
+    if (layers.empty())
+        return;
+    if (layers.front()->print_z < m_print_z - EPSILON) {
+        // The next object is printed in sequential mode, the layers prepared for the previous object are not needed anymore.
+        m_prepared.clear();
+        m_print_z = -1.;
+    }
+    // The external boundaries only depend on print_z and on whether the layer is a support layer,
+    // they are shared by the layers of the batch at the same print_z.
+    std::vector<size_t> sorted(layers.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    auto is_support = [&layers](size_t layer_idx) { return dynamic_cast<const SupportLayer*>(layers[layer_idx]) != nullptr; };
+    std::sort(sorted.begin(), sorted.end(), [&layers, &is_support](size_t l, size_t r) {
+        return is_support(l) < is_support(r) || (is_support(l) == is_support(r) && layers[l]->print_z < layers[r]->print_z);
+    });
+    std::vector<std::shared_ptr<const ExternalBoundaries>> external_boundaries(layers.size());
+    for (size_t i = 0; i < sorted.size(); ++ i) {
+        const size_t layer_idx = sorted[i];
+        const size_t prev_idx  = i == 0 ? layer_idx : sorted[i - 1];
+        external_boundaries[layer_idx] = i > 0 && is_support(layer_idx) == is_support(prev_idx) && layers[layer_idx]->print_z < layers[prev_idx]->print_z + EPSILON ?
+            external_boundaries[prev_idx] : std::make_shared<const ExternalBoundaries>();
+    }
+    std::vector<LayerDataPtr> data(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &external_boundaries, &data](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+            data[layer_idx] = make_layer_data(*layers[layer_idx], external_boundaries[layer_idx]);
+    });
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx)
+        m_prepared.emplace(layers[layer_idx], std::move(data[layer_idx]));
+}
+
+AvoidCrossingPerimeters::LayerDataPtr AvoidCrossingPerimeters::layer_data(const Layer &layer)
+{
+    if (auto it = m_prepared.find(&layer); it != m_prepared.end())
+        return it->second;
+    // Not prepared by prepare_layers().
+    return m_prepared.emplace(&layer, make_layer_data(layer, nullptr)).first->second;
+}
+
+size_t AvoidCrossingPerimeters::plan_travel(const Boundary &boundary, const NavigationGraph &graph, const Layer *boundary_layer, bool external,
+                                            const Point &start, const Point &end, const Layer &layer, Polyline &result_out)
+{
+    PlannedTravelKey key { boundary_layer, &layer, external, start, end };
+    if (auto it = m_planned_travels.find(key); it != m_planned_travels.end()) {
+        result_out = it->second.polyline;
+        return it->second.intersection_count;
+    }
+    size_t intersection_count = avoid_perimeters(boundary, graph, start, end, layer, result_out);
+    m_planned_travels.emplace(key, PlannedTravel{ result_out, intersection_count });
+    return intersection_count;
+}
+
 // Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
 Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &point, bool *could_be_wipe_disabled)
 {
@@ -1244,38 +1509,46 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d startf = start.cast<double>();
     Vec2d endf   = end  .cast<double>();
 
-    const ExPolygons               &lslices          = gcodegen.layer()->lslices;
-    const std::vector<BoundingBox> &lslices_bboxes   = gcodegen.layer()->lslices_bboxes;
+    static const LayerData          no_layer_data {};
+    const LayerData                &layer_data       = m_layer_data ? *m_layer_data : no_layer_data;
     bool                            is_support_layer = (dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr);
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslice, travel)))) {
+    if (!use_external && (is_support_layer || (!layer_data.lslices_offset.empty() && !any_expolygon_contains(layer_data.lslices_offset, layer_data.lslices_offset_bboxes, layer_data.grid_lslice, travel)))) {
         // Initialize m_internal only when it is necessary.
         if (m_internal.boundaries.empty()) {
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
+            m_internal_data = this->layer_data(*gcodegen.layer());
+            init_boundary(&m_internal, Polygons(m_internal_data->internal_boundaries), {start, end});
+            m_internal_layer = gcodegen.layer();
         } else if (!(m_internal.bbox.contains(startf) && m_internal.bbox.contains(endf))) {
             // check if start and end are in bbox, if not, merge start and end points to bbox
             m_internal.clear();
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
+            m_internal_data = this->layer_data(*gcodegen.layer());
+            init_boundary(&m_internal, Polygons(m_internal_data->internal_boundaries), {start, end});
+            m_internal_layer = gcodegen.layer();
         }
 
         if (!m_internal.boundaries.empty()) {
-            travel_intersection_count = avoid_perimeters(m_internal, start, end, *gcodegen.layer(), result_pl);
+            travel_intersection_count = this->plan_travel(m_internal, m_internal_data->internal_graph, m_internal_layer, false, start, end, *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
     } else if (use_external) {
         // Initialize m_external only when exist any external travel for the current layer.
         if (m_external.boundaries.empty()) {
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()), {start, end});
+            m_external_boundaries = this->layer_data(*gcodegen.layer())->external_boundaries;
+            init_boundary(&m_external, Polygons(m_external_boundaries->polygons(*gcodegen.layer())), {start, end});
+            m_external_layer = gcodegen.layer();
         } else if (!(m_external.bbox.contains(startf) && m_external.bbox.contains(endf))) {
             // check if start and end are in bbox
             m_external.clear();
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()), {start, end});
+            m_external_boundaries = this->layer_data(*gcodegen.layer())->external_boundaries;
+            init_boundary(&m_external, Polygons(m_external_boundaries->polygons(*gcodegen.layer())), {start, end});
+            m_external_layer = gcodegen.layer();
         }
         
         // Trim the travel line by the bounding box.
         if (!m_external.boundaries.empty()) 
         {
-            travel_intersection_count = avoid_perimeters(m_external, start, end, *gcodegen.layer(), result_pl);
+            travel_intersection_count = this->plan_travel(m_external, m_external_boundaries->graph(*gcodegen.layer()), m_external_layer, true, start, end, *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
             
@@ -1308,7 +1581,7 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslice, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, layer_data.lslices_offset, layer_data.lslices_offset_bboxes, layer_data.grid_lslice, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
@@ -1319,22 +1592,26 @@ void AvoidCrossingPerimeters::init_layer(const Layer &layer)
 {
     m_internal.clear();
     m_external.clear();
-
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
-    for (auto coeff : {0.6f, 0.5f, 0.45f}) {
-        m_lslices_offset = offset_ex(layer.lslices, -get_external_perimeter_width(layer) * coeff);
-        if (!m_lslices_offset.empty()) break;
-    }    
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const auto &ex_polygon : m_lslices_offset) m_lslices_offset_bboxes.emplace_back(get_extents(ex_polygon));
-
-    BoundingBox bbox_slice(get_extents(layer.lslices));
-    bbox_slice.offset(SCALED_EPSILON);
-
-    m_grid_lslice.set_bbox(bbox_slice);
-    //FIXME 1mm grid?
-    m_grid_lslice.create(m_lslices_offset, coord_t(scale_(1.)));
+    m_internal_layer = nullptr;
+    m_external_layer = nullptr;
+    m_internal_data.reset();
+    m_external_boundaries.reset();
+
+    if (layer.print_z < m_print_z - EPSILON) {
+        // The next object is printed in sequential mode.
+        m_prepared.clear();
+        m_planned_travels.clear();
+    } else if (layer.print_z > m_print_z + EPSILON) {
+        m_planned_travels.clear();
+        // Release the data of the layers printed already.
+        for (auto it = m_prepared.begin(); it != m_prepared.end();)
+            if (it->first->print_z < layer.print_z - EPSILON)
+                it = m_prepared.erase(it);
+            else
+                ++ it;
+    }
+    m_print_z    = layer.print_z;
+    m_layer_data = this->layer_data(layer);
 }
 
 #if 0
@@ -5,6 +5,10 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -12,6 +16,10 @@ class GCode;
 class Layer;
 class Point;
 
+// Plans the travels around the perimeters: A travel crossing the boundaries is routed by A* over a navigation graph
+// of the boundary vertices, see travel_to(). The travel independent layer data including the graphs is prepared in parallel
+// for a batch of layers by prepare_layers(), the boundaries outside of the objects are calculated on demand
+// and the travels are memoized per print_z.
 class AvoidCrossingPerimeters
 {
 public:
@@ -24,6 +32,55 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
+    // Vertices of the boundary polygons moved slightly into the area the travels pass through, connected along the polygons
+    // and by shortcuts between the nearby reflex vertices, which see each other. The shortest routes around the boundaries
+    // only bend at the reflex vertices, the routes found over the graph are straightened by simplify_travel().
+    struct NavigationGraph {
+        // Vertices of the boundary polygons in the order of the polygons and their points.
+        Points              nodes;
+        // Index of the first node of each boundary polygon, the last item is the number of the nodes.
+        std::vector<size_t> polygon_first_node;
+        // Connected area of the travels delimited by each boundary polygon. Routes between two areas are not searched for.
+        std::vector<size_t> polygon_area;
+        // Neighbours of the i-th node are adjacency[adjacency_first[i]] to adjacency[adjacency_first[i + 1] - 1].
+        std::vector<size_t> adjacency_first;
+        std::vector<size_t> adjacency;
+
+        void   build(const Polygons &boundaries, std::vector<size_t> &&polygon_area);
+        bool   empty() const { return nodes.empty(); }
+        size_t polygon_idx(size_t node_idx) const;
+    };
+
+    // Boundaries of the travels outside of the objects and their navigation graph. They are collected over all the objects,
+    // while most layers have no travel outside of the objects, thus they are calculated by the first travel needing them.
+    class ExternalBoundaries {
+    public:
+        const Polygons&        polygons(const Layer &layer) const { this->calculate(layer); return m_polygons; }
+        const NavigationGraph& graph(const Layer &layer) const { this->calculate(layer); return m_graph; }
+    private:
+        void                    calculate(const Layer &layer) const;
+        mutable bool            m_calculated { false };
+        mutable Polygons        m_polygons;
+        mutable NavigationGraph m_graph;
+    };
+
+    // Travel independent data of a layer: The shrunk lslices used to decide whether a travel leaves the object
+    // and the boundaries of the travels inside and outside the objects.
+    struct LayerData {
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        EdgeGrid::Grid           grid_lslice;
+        Polygons                 internal_boundaries;
+        NavigationGraph          internal_graph;
+        // Shared by the layers at the same print_z.
+        std::shared_ptr<const ExternalBoundaries> external_boundaries;
+    };
+    using LayerDataPtr = std::shared_ptr<const LayerData>;
+
+    // Prepare the data of a batch of layers ahead of init_layer() in parallel. Called by the G-code generator
+    // when it reaches the first layer of the batch.
+    void        prepare_layers(const std::vector<const Layer*> &layers);
+
     void        init_layer(const Layer &layer);
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
@@ -52,6 +109,10 @@ public:
     };
 
 private:
+    LayerDataPtr   layer_data(const Layer &layer);
+    size_t         plan_travel(const Boundary &boundary, const NavigationGraph &graph, const Layer *boundary_layer, bool external,
+                               const Point &start, const Point &end, const Layer &layer, Polyline &result_out);
+
     bool           m_use_external_mp { false };
     // just for the next travel move
     bool           m_use_external_mp_once { false };
@@ -59,15 +120,48 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid m_grid_lslice;
+    // Data of the layers prepared by prepare_layers(), released when the G-code generator moves to a higher layer.
+    // Cleared when print_z goes down, that is when the next object is printed in sequential mode.
+    std::map<const Layer*, LayerDataPtr>        m_prepared;
+    // print_z of the layer passed to init_layer().
+    double         m_print_z { -1. };
+    // Data of the layer passed to init_layer(): Lslices offseted by half an external perimeter width and their grid,
+    // used for detection if line or polyline is inside of any polygon.
+    LayerDataPtr   m_layer_data;
     // Store all needed data for travels inside object
     Boundary m_internal;
+    const Layer   *m_internal_layer { nullptr };
+    // Data of m_internal_layer holding the navigation graph of m_internal.
+    LayerDataPtr   m_internal_data;
     // Store all needed data for travels outside object
     Boundary m_external;
+    const Layer   *m_external_layer { nullptr };
+    // Holds the navigation graph of m_external.
+    std::shared_ptr<const ExternalBoundaries> m_external_boundaries;
+
+    // The travels planned around the boundaries of the layers at the same print_z, thus the same hops repeated
+    // by the instances of an object (which plan the internal travels in the coordinates of the object) are planned once.
+    struct PlannedTravelKey {
+        // Layer the boundary was built for and the layer of the travel.
+        const Layer *boundary_layer;
+        const Layer *layer;
+        bool         external;
+        Point        start;
+        Point        end;
+        bool operator==(const PlannedTravelKey &rhs) const {
+            return boundary_layer == rhs.boundary_layer && layer == rhs.layer && external == rhs.external && start == rhs.start && end == rhs.end;
+        }
+    };
+    struct PlannedTravelKeyHash {
+        size_t operator()(const PlannedTravelKey &key) const noexcept {
+            return PointHash{}(key.start) ^ (PointHash{}(key.end) * 31) ^ std::hash<const Layer*>{}(key.layer) ^ size_t(key.external);
+        }
+    };
+    struct PlannedTravel {
+        Polyline polyline;
+        size_t   intersection_count;
+    };
+    std::unordered_map<PlannedTravelKey, PlannedTravel, PlannedTravelKeyHash> m_planned_travels;
 };
 
 } // namespace Slic3r
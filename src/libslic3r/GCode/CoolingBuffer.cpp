@@ -311,15 +311,15 @@ finished:
 	return new_feedrate;
 }
 
-std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
+GCodeLayerLines CoolingBuffer::process_layer(GCodeLayerLines &&gcode, size_t layer_id, bool flush)
 {
     // Cache the input G-code.
     if (m_gcode.empty())
         m_gcode = std::move(gcode);
     else
-        m_gcode += gcode;
+        m_gcode.append(gcode);
 
-    std::string out;
+    GCodeLayerLines out;
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
@@ -333,7 +333,7 @@ std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, b
 
 // Parse the layer G-code for the moves, which could be adjusted.
 // Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const GCodeLayerLines &gcode, std::vector<float> &current_pos) const
 {
     std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
     std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
@@ -351,8 +351,6 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
 
     unsigned int      current_extruder  = m_current_extruder;
     PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
-    const char       *line_start = gcode.c_str();
-    const char       *line_end   = line_start;
     // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
     // for a sequence of extrusion moves.
     size_t            active_speed_modifier = size_t(-1);
@@ -361,67 +359,50 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
     // Time of any other movements before the first extrusion will be excluded from the layer time.
     bool layer_had_extrusion = false;
 
-    for (; *line_start != 0; line_start = line_end) 
-    {
-        while (*line_end != '\n' && *line_end != 0)
-            ++ line_end;
+    assert(is_decimal_separator_point()); // for the parsing of the numbers in GCodeLayerLines
+    for (size_t line_idx = 0; line_idx < gcode.size(); ++ line_idx) {
+        const GCodeLayerLines::Line &gline = gcode[line_idx];
         // sline will not contain the trailing '\n'.
-        std::string sline(line_start, line_end);
+        const std::string_view       sline = gcode.line(line_idx);
+        auto contains = [&sline](const char *marker) { return sline.find(marker) != std::string_view::npos; };
         // CoolingLine will contain the trailing '\n'.
-        if (*line_end == '\n')
-            ++ line_end;
-        CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
-        if (boost::starts_with(sline, "G0 "))
-            line.type = CoolingLine::TYPE_G0;
-        else if (boost::starts_with(sline, "G1 "))
-            line.type = CoolingLine::TYPE_G1;
-        else if (boost::starts_with(sline, "G92 "))
-            line.type = CoolingLine::TYPE_G92;
-        else if (boost::starts_with(sline, "G2 "))
-            line.type = CoolingLine::TYPE_G2;
-        else if (boost::starts_with(sline, "G3 "))
-            line.type = CoolingLine::TYPE_G3;
+        CoolingLine line(0, gline.begin, gline.end);
+        switch (gline.command) {
+        case GCodeLayerLines::Command::G0:  line.type = CoolingLine::TYPE_G0; break;
+        case GCodeLayerLines::Command::G1:  line.type = CoolingLine::TYPE_G1; break;
+        case GCodeLayerLines::Command::G92: line.type = CoolingLine::TYPE_G92; break;
+        case GCodeLayerLines::Command::G2:  line.type = CoolingLine::TYPE_G2; break;
+        case GCodeLayerLines::Command::G3:  line.type = CoolingLine::TYPE_G3; break;
+        default: break;
+        }
         if (line.type) {
             // G0, G1 or G92
-            // Parse the G-code line.
+            // The axes were parsed by GCodeLayerLines.
             std::vector<float> new_pos(current_pos);
-            const char *c = sline.data() + 3;
-            for (;;) {
-                // Skip whitespaces.
-                for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
-                    break;
-
-                assert(is_decimal_separator_point()); // for atof
-                //BBS: Parse the axis.
-                size_t axis = (*c >= 'X' && *c <= 'Z') ? (*c - 'X') :
-                              (*c == 'E') ? 3 : (*c == 'F') ? 4 :
-                              (*c == 'I') ? 5 : (*c == 'J') ? 6 : size_t(-1);
-                if (axis != size_t(-1)) {
-                    new_pos[axis] = float(atof(++c));
-                    if (axis == 4) {
-                        // Convert mm/min to mm/sec.
-                        new_pos[4] /= 60.f;
-                        if ((line.type & CoolingLine::TYPE_G92) == 0)
-                            // This is G0 or G1 line and it sets the feedrate. This mark is used for reducing the duplicate F calls.
-                            line.type |= CoolingLine::TYPE_HAS_F;
-                    } else if (axis == 5 || axis == 6) {
-                        // BBS: get position of arc center
-                        new_pos[axis] += current_pos[axis - 5];
-                    }
-                }
-                // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
+            for (size_t axis = 0; axis < GCodeLayerLines::NumAxes; ++ axis)
+                if (gline.has(GCodeLayerLines::Axis(axis)))
+                    new_pos[axis] = gline.value(GCodeLayerLines::Axis(axis));
+            if (gline.has(GCodeLayerLines::F)) {
+                // Convert mm/min to mm/sec.
+                new_pos[4] /= 60.f;
+                if ((line.type & CoolingLine::TYPE_G92) == 0)
+                    // This is G0 or G1 line and it sets the feedrate. This mark is used for reducing the duplicate F calls.
+                    line.type |= CoolingLine::TYPE_HAS_F;
             }
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
+            // BBS: get position of arc center
+            if (gline.has(GCodeLayerLines::I))
+                new_pos[5] += current_pos[0];
+            if (gline.has(GCodeLayerLines::J))
+                new_pos[6] += current_pos[1];
+            bool external_perimeter = contains(";_EXTERNAL_PERIMETER");
+            bool wipe               = contains(";_WIPE");
             if (external_perimeter)
                 line.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
             if (wipe)
                 line.type |= CoolingLine::TYPE_WIPE;
 
             // Orca: only slow down movements since the first extrusion
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED"))
+            if (contains(";_EXTRUDE_SET_SPEED"))
                 layer_had_extrusion = true;
             
             // ORCA: Dont slowdown external perimeters for layer time feature
@@ -431,7 +412,7 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
             
             // ORCA: Dont slowdown external perimeters for layer time works by not marking the external perimeter as adjustable, 
             // hence the slowdown algorithm ignores it.
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe && adjust_external) {
+            if (contains(";_EXTRUDE_SET_SPEED") && ! wipe && adjust_external) {
                 line.type |= CoolingLine::TYPE_ADJUSTABLE;
                 active_speed_modifier = adjustment->lines.size();
             }
@@ -532,12 +513,10 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
         } else if (boost::starts_with(sline, "G4 ")) {
             // Parse the wait time.
             line.type = CoolingLine::TYPE_G4;
+            // Only the S word is taken into account, a line without it waits zero time.
             size_t pos_S = sline.find('S', 3);
-            size_t pos_P = sline.find('P', 3);
-            assert(is_decimal_separator_point()); // for atof
-            line.time = line.time_max = float(
-                (pos_S > 0) ? atof(sline.c_str() + pos_S + 1) :
-                (pos_P > 0) ? atof(sline.c_str() + pos_P + 1) * 0.001 : 0.);
+            line.time = line.time_max = pos_S == std::string_view::npos ? 0.f :
+                GCodeLayerLines::parse_number(sline.data() + pos_S + 1, sline.data() + sline.size());
         } else if (boost::starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
             line.type = CoolingLine::TYPE_FORCE_RESUME_FAN;
         }
@@ -692,9 +671,9 @@ float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments
 
 // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
 // Returns the adjusted G-code.
-std::string CoolingBuffer::apply_layer_cooldown(
+GCodeLayerLines CoolingBuffer::apply_layer_cooldown(
     // Source G-code for the current layer.
-    const std::string                      &gcode,
+    const GCodeLayerLines                  &gcode,
     // ID of the current layer, used to disable fan for the first n layers.
     size_t                                  layer_id, 
     // Total time of this layer after slow down, used to control the fan.
@@ -715,8 +694,9 @@ std::string CoolingBuffer::apply_layer_cooldown(
         std::sort(lines.begin(), lines.end(), [](const CoolingLine *ln1, const CoolingLine *ln2) { return ln1->line_start < ln2->line_start; } );
     }
     // Second generate the adjusted G-code.
-    std::string new_gcode;
-    new_gcode.reserve(gcode.size() * 2);
+    // Lines not modified are copied together with their parsed data.
+    GCodeLayerLines new_gcode;
+    new_gcode.reserve(gcode.text().size() * 2, gcode.size() + lines.size());
     bool overhang_fan_control= false;
     int  overhang_fan_speed   = 0;
     bool internal_bridge_fan_control= false; // ORCA: Add support for separate internal bridge fan speed control
@@ -804,17 +784,17 @@ std::string CoolingBuffer::apply_layer_cooldown(
             m_fan_speed = fan_speed_new;
             m_current_fan_speed = fan_speed_new;
             if (immediately_apply)
-                new_gcode  += GCodeWriter::set_fan(m_config.gcode_flavor, m_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, m_fan_speed));
         }
         //BBS
         if (additional_fan_speed_new != m_additional_fan_speed) {
             m_additional_fan_speed = additional_fan_speed_new;
             if (immediately_apply && m_config.auxiliary_fan.value)
-                new_gcode += GCodeWriter::set_additional_fan(m_additional_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_additional_fan(m_additional_fan_speed));
         }
     };
 
-    const char         *pos               = gcode.c_str();
+    size_t              pos               = 0;
     int                 current_feedrate  = 0;
     change_extruder_set_fan(true);
 
@@ -826,12 +806,14 @@ std::string CoolingBuffer::apply_layer_cooldown(
                                                                {CoolingLine::TYPE_IRONING_FAN_START, false}, // ORCA: Add support for ironing fan speed control
                                                                {CoolingLine::TYPE_FORCE_RESUME_FAN, false}};
     bool need_set_fan = false;
+    // G-code line being modified.
+    std::string line_gcode;
 
     for (const CoolingLine *line : lines) {
-        const char *line_start  = gcode.c_str() + line->line_start;
-        const char *line_end    = gcode.c_str() + line->line_end;
-        if (line_start > pos)
-            new_gcode.append(pos, line_start - pos);
+        const char *line_start  = gcode.text().c_str() + line->line_start;
+        const char *line_end    = gcode.text().c_str() + line->line_end;
+        if (line->line_start > pos)
+            new_gcode.append_lines(gcode, pos, line->line_start);
         if (line->type & CoolingLine::TYPE_SET_TOOL) {
             unsigned int new_extruder = 0;
             auto ret = std::from_chars(line_start + m_toolchange_prefix.size(), line_end, new_extruder);
@@ -841,7 +823,7 @@ std::string CoolingBuffer::apply_layer_cooldown(
                     change_extruder_set_fan(true);
                 }
             }
-            new_gcode.append(line_start, line_end - line_start);
+            new_gcode.append_lines(gcode, line->line_start, line->line_end);
         } else if (line->type & CoolingLine::TYPE_OVERHANG_FAN_START) {
             if (overhang_fan_control && !fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START]) {
                 need_set_fan = true;
@@ -889,11 +871,12 @@ std::string CoolingBuffer::apply_layer_cooldown(
                 need_set_fan = true;
             }
             if (m_additional_fan_speed != -1 && m_config.auxiliary_fan.value)
-                new_gcode += GCodeWriter::set_additional_fan(m_additional_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_additional_fan(m_additional_fan_speed));
         }
         else if (line->type & CoolingLine::TYPE_EXTRUDE_END) {
             // Just remove this comment.
         } else if (line->type & (CoolingLine::TYPE_ADJUSTABLE | CoolingLine::TYPE_EXTERNAL_PERIMETER | CoolingLine::TYPE_WIPE | CoolingLine::TYPE_HAS_F)) {
+            line_gcode.clear();
             // Find the start of a comment, or roll to the end of line.
             const char *end = line_start;
             for (; end < line_end && *end != ';'; ++ end);
@@ -920,17 +903,17 @@ std::string CoolingBuffer::apply_layer_cooldown(
             } else {
                 // The F value is different from current_feedrate, but not slowed down, thus the G-code line will not be modified.
                 // Emit the line without the comment.
-                new_gcode.append(line_start, end - line_start);
+                line_gcode.append(line_start, end - line_start);
                 current_feedrate = new_feedrate;
             }
             if (modify || remove) {
                 if (modify) {
                     // Replace the feedrate.
-                    new_gcode.append(line_start, fpos - line_start);
+                    line_gcode.append(line_start, fpos - line_start);
                     current_feedrate = new_feedrate;
                     char buf[64];
                     sprintf(buf, "%d", int(current_feedrate));
-                    new_gcode += buf;
+                    line_gcode += buf;
                 } else {
                     // Remove the feedrate word.
                     const char *f = fpos;
@@ -941,7 +924,7 @@ std::string CoolingBuffer::apply_layer_cooldown(
                         // BBS: only remain "G1" or "G0" of this line after remove 'F' part, don't save
                     } else {
                         // Append up to the F word, without the trailing whitespace.
-                        new_gcode.append(line_start, f - line_start + 1);
+                        line_gcode.append(line_start, f - line_start + 1);
                     }
                 }
                 // Skip the non-whitespaces of the F parameter up the comment or end of line.
@@ -949,10 +932,10 @@ std::string CoolingBuffer::apply_layer_cooldown(
                 // Append the rest of the line without the comment.
                 if (fpos < end)
                     // The G-code line is not empty yet. Emit the rest of it.
-                    new_gcode.append(fpos, end - fpos);
-                else if (remove && new_gcode == "G1") {
+                    line_gcode.append(fpos, end - fpos);
+                else if (remove && new_gcode.empty() && line_gcode == "G1") {
                     // The G-code line only contained the F word, now it is empty. Remove it completely including the comments.
-                    new_gcode.resize(new_gcode.size() - 2);
+                    line_gcode.clear();
                     end = line_end;
                 }
             }
@@ -966,45 +949,45 @@ std::string CoolingBuffer::apply_layer_cooldown(
                         boost::replace_all(comment, ";_EXTERNAL_PERIMETER", "");
                     if (line->type & CoolingLine::TYPE_WIPE)
                         boost::replace_all(comment, ";_WIPE", "");
-                    new_gcode += comment;
+                    line_gcode += comment;
                 } else {
                     // Just attach the rest of the source line.
-                    new_gcode.append(end, line_end - end);
+                    line_gcode.append(end, line_end - end);
                 }
             }
+            new_gcode.append_text(line_gcode);
         } else {
-            new_gcode.append(line_start, line_end - line_start);
+            new_gcode.append_lines(gcode, line->line_start, line->line_end);
         }
 
         if (need_set_fan) {
             if (fan_speed_change_requests[CoolingLine::TYPE_OVERHANG_FAN_START]){
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, overhang_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, overhang_fan_speed));
                 m_current_fan_speed = overhang_fan_speed;
             } else if (fan_speed_change_requests[CoolingLine::TYPE_INTERNAL_BRIDGE_FAN_START]){ // ORCA: Add support for separate internal bridge fan speed control
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, internal_bridge_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, internal_bridge_fan_speed));
                 m_current_fan_speed = internal_bridge_fan_speed;
             }
             else if (fan_speed_change_requests[CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START]){
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, supp_interface_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, supp_interface_fan_speed));
                 m_current_fan_speed = supp_interface_fan_speed;
             }
             else if (fan_speed_change_requests[CoolingLine::TYPE_IRONING_FAN_START]){
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, ironing_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, ironing_fan_speed));
                 m_current_fan_speed = ironing_fan_speed;
             }
             else if(fan_speed_change_requests[CoolingLine::TYPE_FORCE_RESUME_FAN] && m_current_fan_speed != -1){
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_current_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, m_current_fan_speed));
                 fan_speed_change_requests[CoolingLine::TYPE_FORCE_RESUME_FAN] = false;
             }
             else
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_fan_speed);
+                new_gcode.append_text(GCodeWriter::set_fan(m_config.gcode_flavor, m_fan_speed));
             need_set_fan = false;
         }
-        pos = line_end;
+        pos = line->line_end;
     }
-    const char *gcode_end = gcode.c_str() + gcode.size();
-    if (pos < gcode_end)
-        new_gcode.append(pos, gcode_end - pos);
+    if (pos < gcode.text().size())
+        new_gcode.append_lines(gcode, pos, gcode.text().size());
 
     return new_gcode;
 }
@@ -297,16 +297,33 @@ class ExtrusionQualityEstimator
     const PrintObject                                                            *current_object;
 
 public:
+    // Boundaries of a layer queried when printing the next layer of the same object. They depend on the layer only,
+    // thus GCode calculates them for the layers ahead in parallel.
+    struct LayerBoundaries
+    {
+        AABBTreeLines::LinesDistancer<Linef>      boundaries;
+        AABBTreeLines::LinesDistancer<CurledLine> curled_extrusions;
+    };
+
+    static LayerBoundaries layer_boundaries(const Layer &layer)
+    {
+        return { AABBTreeLines::LinesDistancer<Linef>{to_unscaled_linesf(layer.lslices)}, AABBTreeLines::LinesDistancer<CurledLine>{layer.curled_lines} };
+    }
+
     void set_current_object(const PrintObject *object) { current_object = object; }
 
+    void prepare_for_new_layer(const PrintObject *object, LayerBoundaries &&layer)
+    {
+        prev_layer_boundaries[object]  = std::move(next_layer_boundaries[object]);
+        next_layer_boundaries[object]  = std::move(layer.boundaries);
+        prev_curled_extrusions[object] = std::move(next_curled_extrusions[object]);
+        next_curled_extrusions[object] = std::move(layer.curled_extrusions);
+    }
+
     void prepare_for_new_layer(const PrintObject * obj, const Layer *layer)
     {
         if (layer == nullptr) return;
-        const PrintObject *object = obj;
-        prev_layer_boundaries[object] = next_layer_boundaries[object];
-        next_layer_boundaries[object] = AABBTreeLines::LinesDistancer<Linef>{to_unscaled_linesf(layer->lslices)};
-        prev_curled_extrusions[object] = next_curled_extrusions[object];
-        next_curled_extrusions[object] = AABBTreeLines::LinesDistancer<CurledLine>{layer->curled_lines};
+        this->prepare_for_new_layer(obj, layer_boundaries(*layer));
     }
 
     std::vector<ProcessedPoint> estimate_extrusion_quality(const ExtrusionPath                &path,
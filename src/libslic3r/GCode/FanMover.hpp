@@ -9,6 +9,7 @@
 #include "../Point.hpp"
 #include "../GCodeReader.hpp"
 #include "../GCodeWriter.hpp"
+#include "GCodeLayerLines.hpp"
 #include <regex>
 
 namespace Slic3r {
@@ -19,6 +20,8 @@ public:
     float time;
     int16_t fan_speed;
     bool is_kickstart;
+    // Line of FanMover::process_layer() input the raw text was read from, -1 if none.
+    int line_idx = -1;
     float x = 0, y = 0, z = 0, e = 0;
     float dx = 0, dy = 0, dz = 0, de = 0;
     BufferData(std::string line, float time = 0, int16_t fan_speed = 0, float is_kickstart = false) : raw(line), time(time), fan_speed(fan_speed), is_kickstart(is_kickstart){
@@ -56,8 +59,11 @@ private:
     std::list<BufferData> m_buffer;
     double m_buffer_time_size = 0;
 
-    // The output of process_layer()
-    std::string m_process_output;
+    // The output of process_gcode() / process_layer()
+    GCodeLayerLines m_process_output;
+    // Input of process_layer() while it runs, its lines written out unchanged keep their parsed data.
+    const GCodeLayerLines *m_process_input = nullptr;
+    int m_process_line_idx = -1;
 
 public:
     FanMover(const GCodeWriter& writer, const float nb_seconds_delay, const bool with_D_option, const bool relative_e,
@@ -71,6 +77,9 @@ public:
 
     // Adds the gcode contained in the given string to the analysis and returns it after removing the workcodes
     const std::string& process_gcode(const std::string& gcode, bool flush);
+    // Same as process_gcode() for the lines passed between the G-code post filters. The moves are read from the parsed lines,
+    // the lines written out unchanged are copied with their parsed data, only the moved and split lines are parsed.
+    GCodeLayerLines process_layer(GCodeLayerLines &&gcode, bool flush);
 
 private:
     BufferData& put_in_buffer(BufferData&& data) {
@@ -89,6 +98,10 @@ private:
     void _print_in_middle_G1(BufferData& line_to_split, float nb_sec, const std::string& line_to_write);
     void _remove_slow_fan(int16_t min_speed, float past_sec);
     std::string _set_fan(int16_t speed);
+    // Writes a buffered line followed by a new line.
+    void _write(const BufferData& data);
+    // Writes G-code, adds a new line if missing.
+    void _write(const std::string& gcode);
 };
 
 } // namespace Slic3r
@@ -0,0 +1,148 @@
+#include "GCodeLayerLines.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <fast_float/fast_float.h>
+
+namespace Slic3r {
+
+std::string_view GCodeLayerLines::line(size_t idx) const
+{
+    const Line &l   = m_lines[idx];
+    size_t      end = l.end;
+    if (end > l.begin && m_text[end - 1] == '\n')
+        -- end;
+    return std::string_view(m_text.data() + l.begin, end - l.begin);
+}
+
+float GCodeLayerLines::parse_number(const char *begin, const char *line_end, const char **number_end)
+{
+    assert(begin <= line_end);
+    const char *c = begin;
+    for (; c != line_end && (*c == ' ' || *c == '\t'); ++ c);
+    // fast_float does not accept the plus sign atof() does.
+    if (c != line_end && *c == '+' && (c + 1 == line_end || *(c + 1) != '-'))
+        ++ c;
+    float out = 0.f;
+    auto [end, ec] = fast_float::from_chars(c, line_end, out);
+    if (ec == std::errc::invalid_argument) {
+        out = 0.f;
+        end = begin;
+    }
+    if (number_end)
+        *number_end = end;
+    return out;
+}
+
+// Is the number parsed by parse_number() between begin and end a plain decimal number, ending with the word?
+// GCodeReader parses the same value from such a word.
+static bool plain_number(const char *begin, const char *end, const char *line_end)
+{
+    if (begin == end || *begin == '+' || (end != line_end && *end != ' ' && *end != '\t'))
+        return false;
+    for (const char *c = begin; c != end; ++ c)
+        if (! ((*c >= '0' && *c <= '9') || *c == '.' || *c == '-' || *c == '+' || *c == 'e' || *c == 'E'))
+            return false;
+    return true;
+}
+
+void GCodeLayerLines::parse_from(size_t offset)
+{
+    const char *text = m_text.data();
+    const char *text_end = text + m_text.size();
+    for (const char *line_start = text + offset; line_start != text_end;) {
+        const char *nl       = static_cast<const char*>(memchr(line_start, '\n', size_t(text_end - line_start)));
+        const char *line_end = nl ? nl : text_end;
+        Line        line;
+        line.begin = size_t(line_start - text);
+        line.end   = nl ? size_t(nl + 1 - text) : m_text.size();
+        const std::string_view sline(line_start, size_t(line_end - line_start));
+        auto starts_with = [&sline](const char *prefix) { return sline.compare(0, strlen(prefix), prefix) == 0; };
+        if (starts_with("G0 "))
+            line.command = Command::G0;
+        else if (starts_with("G1 "))
+            line.command = Command::G1;
+        else if (starts_with("G2 "))
+            line.command = Command::G2;
+        else if (starts_with("G3 "))
+            line.command = Command::G3;
+        else if (starts_with("G4 "))
+            line.command = Command::G4;
+        else if (starts_with("G92 "))
+            line.command = Command::G92;
+        if (line.command != Command::Other && line.command != Command::G4) {
+            line.canonical = memchr(line_start, '\r', size_t(line_end - line_start)) == nullptr;
+            // Words starting with an axis letter, the parameters end with a comment.
+            for (const char *c = line_start + 3; c < line_end;) {
+                // Skip whitespaces.
+                for (; c < line_end && (*c == ' ' || *c == '\t'); ++ c);
+                if (c == line_end || *c == ';')
+                    break;
+                int axis = -1;
+                switch (*c) {
+                case 'X': axis = X; break;
+                case 'Y': axis = Y; break;
+                case 'Z': axis = Z; break;
+                case 'E': axis = E; break;
+                case 'F': axis = F; break;
+                case 'I': axis = I; break;
+                case 'J': axis = J; break;
+                default: break;
+                }
+                if (axis != -1) {
+                    const char *number_end = nullptr;
+                    line.axes[axis]  = parse_number(++ c, line_end, &number_end);
+                    line.axis_mask  |= uint8_t(1 << axis);
+                    line.canonical  &= plain_number(c, number_end, line_end);
+                } else
+                    line.canonical   = false;
+                // Skip this word.
+                for (; c < line_end && *c != ' ' && *c != '\t'; ++ c);
+            }
+        }
+        m_lines.emplace_back(line);
+        line_start = line_end == text_end ? text_end : line_end + 1;
+    }
+}
+
+void GCodeLayerLines::append_text(std::string_view gcode)
+{
+    if (gcode.empty())
+        return;
+    size_t offset = m_text.size();
+    if (! m_lines.empty() && m_text.back() != '\n') {
+        // Finish the last line, parse it again.
+        offset = m_lines.back().begin;
+        m_lines.pop_back();
+    }
+    m_text.append(gcode.data(), gcode.size());
+    this->parse_from(offset);
+}
+
+void GCodeLayerLines::append_lines(const GCodeLayerLines &src, size_t offset_begin, size_t offset_end)
+{
+    assert(offset_begin <= offset_end && offset_end <= src.text().size());
+    if (offset_begin == offset_end)
+        return;
+    auto it = std::lower_bound(src.m_lines.begin(), src.m_lines.end(), offset_begin, [](const Line &l, size_t offset) { return l.begin < offset; });
+    if ((! m_text.empty() && m_text.back() != '\n') || it == src.m_lines.end() || it->begin != offset_begin) {
+        this->append_text(std::string_view(src.m_text.data() + offset_begin, offset_end - offset_begin));
+        return;
+    }
+    const size_t base = m_text.size();
+    m_text.append(src.m_text, offset_begin, offset_end - offset_begin);
+    size_t parsed_end = base;
+    for (; it != src.m_lines.end() && it->end <= offset_end; ++ it) {
+        Line &l   = m_lines.emplace_back(*it);
+        l.begin   = l.begin - offset_begin + base;
+        l.end     = l.end - offset_begin + base;
+        parsed_end = l.end;
+    }
+    if (parsed_end < m_text.size())
+        // The range ends inside a line of src.
+        this->parse_from(parsed_end);
+}
+
+} // namespace Slic3r
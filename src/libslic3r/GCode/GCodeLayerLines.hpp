@@ -0,0 +1,107 @@
+#ifndef slic3r_GCodeLayerLines_hpp_
+#define slic3r_GCodeLayerLines_hpp_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Slic3r {
+
+// G-code of a layer split into lines, the commands and the axes of the moves parsed.
+// The G-code post filters of GCode::process_layers() (spiral vase, pressure equalizer, cooling buffer, fan mover, adaptive PA) pass it from one to another,
+// thus a filter reads the parsed moves instead of splitting and parsing the text again. Lines copied by a filter
+// unchanged keep their parsed data, only the lines emitted or edited by a filter are parsed. The text is written out as is.
+// The text is still the G-code: the filters match its comments and markers and edit it, the parsed data is an index into it.
+class GCodeLayerLines
+{
+public:
+    enum class Command : uint8_t {
+        Other,
+        G0,
+        G1,
+        G2,
+        G3,
+        G4,
+        G92,
+    };
+
+    enum Axis : uint8_t {
+        X, Y, Z, E, F, I, J,
+        NumAxes
+    };
+
+    struct Line
+    {
+        // Range of the line in text(), including the trailing '\n' if present.
+        size_t      begin { 0 };
+        size_t      end   { 0 };
+        // Recognized by the "G0 ", "G1 ", "G2 ", "G3 ", "G4 " and "G92 " prefixes.
+        Command     command   { Command::Other };
+        // A G0, G1, G2, G3 or G92 move, all of its words are axes followed by plain numbers. GCodeReader parses
+        // the same axes and values from such a line, thus GCodeReader::parse_lines() does not tokenize it again.
+        bool        canonical { false };
+        // Axes parsed from the G0, G1, G2, G3 and G92 moves, the value of the last word wins.
+        uint8_t     axis_mask { 0 };
+        float       axes[NumAxes] {};
+
+        bool        has(Axis axis) const { return (axis_mask & (1 << axis)) != 0; }
+        float       value(Axis axis) const { return axes[axis]; }
+        bool        is_move() const { return command == Command::G0 || command == Command::G1 || command == Command::G2 || command == Command::G3; }
+    };
+
+    GCodeLayerLines() = default;
+    explicit GCodeLayerLines(std::string &&gcode) : m_text(std::move(gcode)) { this->parse_from(0); }
+
+    const std::string&  text() const { return m_text; }
+    bool                empty() const { return m_text.empty(); }
+    size_t              size() const { return m_lines.size(); }
+    const Line&         operator[](size_t idx) const { return m_lines[idx]; }
+    // Text of a line without the trailing '\n'.
+    std::string_view    line(size_t idx) const;
+
+    void                reserve(size_t text_size, size_t num_lines) { m_text.reserve(text_size); m_lines.reserve(num_lines); }
+    void                clear() { m_text.clear(); m_lines.clear(); }
+    // Remove the last line with its text.
+    void                pop_back() { m_text.resize(m_lines.back().begin); m_lines.pop_back(); }
+    // Move the text out, the lines are cleared.
+    std::string         release_text() { m_lines.clear(); return std::move(m_text); }
+
+    // Append G-code text, which is parsed.
+    void                append_text(std::string_view gcode);
+    // Append the text of src between the offsets, reusing the parsed lines of src. Text not aligned with the lines of src,
+    // or appended to an unfinished line, is parsed.
+    void                append_lines(const GCodeLayerLines &src, size_t offset_begin, size_t offset_end);
+    void                append_line(const GCodeLayerLines &src, size_t line_idx) { this->append_lines(src, src[line_idx].begin, src[line_idx].end); }
+    void                append(const GCodeLayerLines &src) { this->append_lines(src, 0, src.text().size()); }
+
+    // Parse the rest of the line starting at begin, which ends at line_end, as atof() would, though straight to float with fast_float
+    // as PressureEqualizer parses its lines: Leading whitespaces are skipped, the longest valid prefix is parsed,
+    // zero is returned if there is none. Hexadecimal numbers are not parsed.
+    static float        parse_number(const char *begin, const char *line_end) { return parse_number(begin, line_end, nullptr); }
+    // Same as above, number_end is set to the end of the parsed prefix, to begin if there is none.
+    static float        parse_number(const char *begin, const char *line_end, const char **number_end);
+
+private:
+    // Parse the text starting with a beginning of a line at offset.
+    void                parse_from(size_t offset);
+
+    std::string         m_text;
+    // The lines cover m_text without gaps.
+    std::vector<Line>   m_lines;
+};
+
+// Layer of G-code passed between the G-code post filters of GCode::process_layers(), the parsed counterpart of LayerResult.
+struct LayerLines
+{
+    GCodeLayerLines gcode;
+    size_t          layer_id;
+    bool            spiral_vase_enable;
+    bool            cooling_buffer_flush;
+    // Inserted after the last layer to flush the pressure equalizer, which returns the layers one layer back.
+    bool            nop_layer_result;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_GCodeLayerLines_hpp_
@@ -0,0 +1,236 @@
+#include "GCodeMovesColumns.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <boost/container_hash/hash.hpp>
+
+namespace Slic3r {
+
+bool GCodeMovesColumns::Attributes::operator==(const Attributes &rhs) const
+{
+    return type == rhs.type && extrusion_role == rhs.extrusion_role && extruder_id == rhs.extruder_id && cp_color_id == rhs.cp_color_id &&
+           move_path_type == rhs.move_path_type && height == rhs.height && fan_speed == rhs.fan_speed && temperature == rhs.temperature && layer_duration == rhs.layer_duration;
+}
+
+size_t GCodeMovesColumns::AttributesHash::operator()(const Attributes &attr) const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, int(attr.type));
+    boost::hash_combine(seed, int(attr.extrusion_role));
+    boost::hash_combine(seed, attr.extruder_id);
+    boost::hash_combine(seed, attr.cp_color_id);
+    boost::hash_combine(seed, int(attr.move_path_type));
+    boost::hash_combine(seed, attr.height);
+    boost::hash_combine(seed, attr.fan_speed);
+    boost::hash_combine(seed, attr.temperature);
+    boost::hash_combine(seed, attr.layer_duration);
+    return seed;
+}
+
+void GCodeMovesColumns::assign(const std::vector<MoveVertex> &moves)
+{
+    this->clear();
+    m_gcode_ids.reserve(moves.size());
+    m_positions.reserve(moves.size());
+    m_delta_extruders.reserve(moves.size());
+    m_travel_dists.reserve(moves.size());
+    m_times.reserve(moves.size());
+    m_feedrates.reserve(moves.size());
+    m_widths.reserve(moves.size());
+    m_mm3_per_mms.reserve(moves.size());
+    m_attributes.reserve(moves.size());
+    for (const MoveVertex &move : moves)
+        this->append(move);
+    this->shrink_to_fit();
+}
+
+void GCodeMovesColumns::append(const MoveVertex &move)
+{
+    m_gcode_ids.emplace_back(move.gcode_id);
+    m_positions.emplace_back(move.position);
+    m_delta_extruders.emplace_back(move.delta_extruder);
+    m_travel_dists.emplace_back(move.travel_dist);
+    m_times.emplace_back(move.time);
+    m_feedrates.emplace_back(move.feedrate);
+    m_widths.emplace_back(move.width);
+    m_mm3_per_mms.emplace_back(move.mm3_per_mm);
+
+    Attributes attr = vertex_to_attributes(move);
+    if (m_palette_map.empty() && ! m_palette.empty()) {
+        // The lookup table was released by shrink_to_fit(), rebuild it.
+        for (uint32_t i = 0; i < uint32_t(m_palette.size()); ++ i)
+            m_palette_map.emplace(m_palette[i], i);
+    }
+    auto [it, inserted] = m_palette_map.emplace(attr, uint32_t(m_palette.size()));
+    if (inserted)
+        m_palette.emplace_back(attr);
+    m_attributes.emplace_back(it->second);
+
+    if (move.is_arc_move()) {
+        if (m_arc_points_offsets.empty())
+            m_arc_points_offsets.emplace_back(0);
+        m_arc_moves.emplace_back(uint32_t(m_gcode_ids.size() - 1));
+        m_arc_centers.emplace_back(move.arc_center_position);
+        m_arc_points.insert(m_arc_points.end(), move.interpolation_points.begin(), move.interpolation_points.end());
+        m_arc_points_offsets.emplace_back(uint32_t(m_arc_points.size()));
+    }
+}
+
+void GCodeMovesColumns::erase(size_t idx)
+{
+    assert(idx < this->size());
+    m_gcode_ids.erase(m_gcode_ids.begin() + idx);
+    m_positions.erase(m_positions.begin() + idx);
+    m_delta_extruders.erase(m_delta_extruders.begin() + idx);
+    m_travel_dists.erase(m_travel_dists.begin() + idx);
+    m_times.erase(m_times.begin() + idx);
+    m_feedrates.erase(m_feedrates.begin() + idx);
+    m_widths.erase(m_widths.begin() + idx);
+    m_mm3_per_mms.erase(m_mm3_per_mms.begin() + idx);
+    m_attributes.erase(m_attributes.begin() + idx);
+    // Shift the indices of the arc moves following the erased move, remove the arc data of the erased move.
+    auto it = std::lower_bound(m_arc_moves.begin(), m_arc_moves.end(), uint32_t(idx));
+    size_t arc_idx = it - m_arc_moves.begin();
+    if (it != m_arc_moves.end() && *it == uint32_t(idx)) {
+        uint32_t points_begin = m_arc_points_offsets[arc_idx];
+        uint32_t points_end   = m_arc_points_offsets[arc_idx + 1];
+        m_arc_points.erase(m_arc_points.begin() + points_begin, m_arc_points.begin() + points_end);
+        m_arc_points_offsets.erase(m_arc_points_offsets.begin() + arc_idx + 1);
+        for (size_t i = arc_idx + 1; i < m_arc_points_offsets.size(); ++ i)
+            m_arc_points_offsets[i] -= points_end - points_begin;
+        m_arc_moves.erase(it);
+        m_arc_centers.erase(m_arc_centers.begin() + arc_idx);
+        if (m_arc_moves.empty())
+            m_arc_points_offsets.clear();
+    }
+    for (size_t i = arc_idx; i < m_arc_moves.size(); ++ i)
+        -- m_arc_moves[i];
+}
+
+void GCodeMovesColumns::clear()
+{
+    m_gcode_ids.clear();
+    m_positions.clear();
+    m_delta_extruders.clear();
+    m_travel_dists.clear();
+    m_times.clear();
+    m_feedrates.clear();
+    m_widths.clear();
+    m_mm3_per_mms.clear();
+    m_attributes.clear();
+    m_palette.clear();
+    m_palette_map.clear();
+    m_arc_moves.clear();
+    m_arc_centers.clear();
+    m_arc_points_offsets.clear();
+    m_arc_points.clear();
+}
+
+void GCodeMovesColumns::shrink_to_fit()
+{
+    m_gcode_ids.shrink_to_fit();
+    m_positions.shrink_to_fit();
+    m_delta_extruders.shrink_to_fit();
+    m_travel_dists.shrink_to_fit();
+    m_times.shrink_to_fit();
+    m_feedrates.shrink_to_fit();
+    m_widths.shrink_to_fit();
+    m_mm3_per_mms.shrink_to_fit();
+    m_attributes.shrink_to_fit();
+    m_palette.shrink_to_fit();
+    m_palette_map = {};
+    m_arc_moves.shrink_to_fit();
+    m_arc_centers.shrink_to_fit();
+    m_arc_points_offsets.shrink_to_fit();
+    m_arc_points.shrink_to_fit();
+}
+
+size_t GCodeMovesColumns::memory_size() const
+{
+    return SLIC3R_STDVEC_MEMSIZE(m_gcode_ids, unsigned int) + SLIC3R_STDVEC_MEMSIZE(m_positions, Vec3f) +
+           SLIC3R_STDVEC_MEMSIZE(m_delta_extruders, float) + SLIC3R_STDVEC_MEMSIZE(m_travel_dists, float) +
+           SLIC3R_STDVEC_MEMSIZE(m_times, float) + SLIC3R_STDVEC_MEMSIZE(m_feedrates, float) +
+           SLIC3R_STDVEC_MEMSIZE(m_widths, float) + SLIC3R_STDVEC_MEMSIZE(m_mm3_per_mms, float) + SLIC3R_STDVEC_MEMSIZE(m_attributes, uint32_t) +
+           SLIC3R_STDVEC_MEMSIZE(m_palette, Attributes) + SLIC3R_STDVEC_MEMSIZE(m_arc_moves, uint32_t) +
+           SLIC3R_STDVEC_MEMSIZE(m_arc_centers, Vec3f) + SLIC3R_STDVEC_MEMSIZE(m_arc_points_offsets, uint32_t) +
+           SLIC3R_STDVEC_MEMSIZE(m_arc_points, Vec3f) +
+           // Rough estimate of the lookup table, one node per palette entry.
+           m_palette_map.size() * (sizeof(Attributes) + sizeof(uint32_t) + 2 * sizeof(void*)) + m_palette_map.bucket_count() * sizeof(void*);
+}
+
+int GCodeMovesColumns::arc_index(size_t idx) const
+{
+    if (! this->is_arc_move(idx))
+        return -1;
+    auto it = std::lower_bound(m_arc_moves.begin(), m_arc_moves.end(), uint32_t(idx));
+    return it != m_arc_moves.end() && *it == uint32_t(idx) ? int(it - m_arc_moves.begin()) : -1;
+}
+
+Vec3f GCodeMovesColumns::arc_center_position(size_t idx) const
+{
+    int arc_idx = this->arc_index(idx);
+    return arc_idx == -1 ? Vec3f::Zero() : m_arc_centers[arc_idx];
+}
+
+std::pair<const Vec3f*, const Vec3f*> GCodeMovesColumns::interpolation_points(size_t idx) const
+{
+    int arc_idx = this->arc_index(idx);
+    if (arc_idx == -1)
+        return { nullptr, nullptr };
+    const Vec3f *begin = m_arc_points.data();
+    return { begin + m_arc_points_offsets[arc_idx], begin + m_arc_points_offsets[arc_idx + 1] };
+}
+
+GCodeMovesColumns::MoveVertex GCodeMovesColumns::attributes_to_vertex(const Attributes &attr)
+{
+    MoveVertex move;
+    move.type           = attr.type;
+    move.extrusion_role = attr.extrusion_role;
+    move.extruder_id    = attr.extruder_id;
+    move.cp_color_id    = attr.cp_color_id;
+    move.move_path_type = attr.move_path_type;
+    move.height         = attr.height;
+    move.fan_speed      = attr.fan_speed;
+    move.temperature    = attr.temperature;
+    move.layer_duration = attr.layer_duration;
+    return move;
+}
+
+GCodeMovesColumns::Attributes GCodeMovesColumns::vertex_to_attributes(const MoveVertex &move)
+{
+    Attributes attr;
+    attr.type           = move.type;
+    attr.extrusion_role = move.extrusion_role;
+    attr.extruder_id    = move.extruder_id;
+    attr.cp_color_id    = move.cp_color_id;
+    attr.move_path_type = move.move_path_type;
+    attr.height         = move.height;
+    attr.fan_speed      = move.fan_speed;
+    attr.temperature    = move.temperature;
+    attr.layer_duration = move.layer_duration;
+    return attr;
+}
+
+GCodeMovesColumns::MoveVertex GCodeMovesColumns::vertex(size_t idx) const
+{
+    MoveVertex move = attributes_to_vertex(this->attributes(idx));
+    move.gcode_id            = m_gcode_ids[idx];
+    move.position            = m_positions[idx];
+    move.delta_extruder      = m_delta_extruders[idx];
+    move.travel_dist         = m_travel_dists[idx];
+    move.time                = m_times[idx];
+    move.feedrate            = m_feedrates[idx];
+    move.width               = m_widths[idx];
+    move.mm3_per_mm          = m_mm3_per_mms[idx];
+    int arc_idx = this->arc_index(idx);
+    if (arc_idx != -1) {
+        move.arc_center_position = m_arc_centers[arc_idx];
+        move.interpolation_points.assign(m_arc_points.begin() + m_arc_points_offsets[arc_idx], m_arc_points.begin() + m_arc_points_offsets[arc_idx + 1]);
+    }
+    return move;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,268 @@
+#ifndef slic3r_GCodeMovesColumns_hpp_
+#define slic3r_GCodeMovesColumns_hpp_
+
+#include "libslic3r/Point.hpp"
+#include "libslic3r/ExtrusionEntity.hpp"
+#include "libslic3r/ArcFitter.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace Slic3r {
+
+    enum class EMoveType : unsigned char
+    {
+        Noop,
+        Retract,
+        Unretract,
+        Seam,
+        Tool_change,
+        Color_change,
+        Pause_Print,
+        Custom_GCode,
+        Travel,
+        Wipe,
+        Extrude,
+        Count
+    };
+
+    // A single move of GCodeProcessorResult::moves, see GCodeProcessorResult::MoveVertex.
+    struct GCodeMoveVertex
+    {
+        unsigned int gcode_id{ 0 };
+        EMoveType type{ EMoveType::Noop };
+        ExtrusionRole extrusion_role{ erNone };
+        unsigned char extruder_id{ 0 };
+        unsigned char cp_color_id{ 0 };
+        Vec3f position{ Vec3f::Zero() }; // mm
+        float delta_extruder{ 0.0f }; // mm
+        float feedrate{ 0.0f }; // mm/s
+        float width{ 0.0f }; // mm
+        float height{ 0.0f }; // mm
+        float mm3_per_mm{ 0.0f };
+        float travel_dist{ 0.0f }; // mm
+        float fan_speed{ 0.0f }; // percentage
+        float temperature{ 0.0f }; // Celsius degrees
+        float time{ 0.0f }; // s
+        float layer_duration{ 0.0f }; // s (layer id before finalize)
+
+
+        //BBS: arc move related data
+        EMovePathType move_path_type{ EMovePathType::Noop_move };
+        Vec3f arc_center_position{ Vec3f::Zero() };      // mm
+        std::vector<Vec3f> interpolation_points;     // interpolation points of arc for drawing
+
+        float volumetric_rate() const { return feedrate * mm3_per_mm; }
+        //BBS: new function to support arc move
+        bool is_arc_move_with_interpolation_points() const {
+            return (move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw) && interpolation_points.size();
+        }
+        bool is_arc_move() const {
+            return move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw;
+        }
+    };
+
+// Compact struct-of-arrays storage of GCodeProcessorResult::moves.
+// The attributes repeated over long runs of moves (move type, extrusion role, extruder, color, height, fan speed, temperature
+// and layer duration) are stored once in a palette and referenced by a 32 bit index, the arc data is stored only for the arc moves.
+// Feedrate, width and flow change with the speed and flow modifiers (overhangs, bridges, small perimeters, variable width
+// Arachne walls) nearly from move to move, they are stored per move to keep the palette small.
+// A move takes 44 bytes plus its arc data, compared to sizeof(MoveVertex) plus the heap allocated interpolation points
+// of the MoveVertex layout.
+// The positions and times are stored as floats. Positions quantized to a fixed grid would need 32 bits per axis to cover
+// the build volume at the float precision, and the times delta encoded against the previous move would turn the random access
+// of the viewer (move ranges of the layers and of the horizontal slider) into prefix sums, thus both were left out.
+// The accessors read a single attribute of a move without materializing the MoveVertex, so do operator[] and the iterators
+// through a MoveView. Only vertex() materializes a MoveVertex for the code, which needs to own a copy of the move.
+class GCodeMovesColumns
+{
+public:
+    using MoveVertex = GCodeMoveVertex;
+
+    // Lightweight view of a single move, reading the attributes of the move from the columns on demand.
+    // Valid until the columns are modified.
+    class MoveView
+    {
+    public:
+        MoveView(const GCodeMovesColumns &columns, size_t idx) : m_columns(&columns), m_idx(idx) {}
+
+        size_t              index() const { return m_idx; }
+        unsigned int        gcode_id() const { return m_columns->gcode_id(m_idx); }
+        EMoveType           type() const { return m_columns->type(m_idx); }
+        ExtrusionRole       extrusion_role() const { return m_columns->extrusion_role(m_idx); }
+        unsigned char       extruder_id() const { return m_columns->extruder_id(m_idx); }
+        unsigned char       cp_color_id() const { return m_columns->cp_color_id(m_idx); }
+        const Vec3f&        position() const { return m_columns->position(m_idx); }
+        float               delta_extruder() const { return m_columns->delta_extruder(m_idx); }
+        float               feedrate() const { return m_columns->feedrate(m_idx); }
+        float               width() const { return m_columns->width(m_idx); }
+        float               height() const { return m_columns->height(m_idx); }
+        float               mm3_per_mm() const { return m_columns->mm3_per_mm(m_idx); }
+        float               travel_dist() const { return m_columns->travel_dist(m_idx); }
+        float               fan_speed() const { return m_columns->fan_speed(m_idx); }
+        float               temperature() const { return m_columns->temperature(m_idx); }
+        float               time() const { return m_columns->time(m_idx); }
+        float               layer_duration() const { return m_columns->layer_duration(m_idx); }
+        float               volumetric_rate() const { return m_columns->volumetric_rate(m_idx); }
+        EMovePathType       move_path_type() const { return m_columns->move_path_type(m_idx); }
+        bool                is_arc_move() const { return m_columns->is_arc_move(m_idx); }
+        bool                is_arc_move_with_interpolation_points() const { return m_columns->is_arc_move_with_interpolation_points(m_idx); }
+        Vec3f               arc_center_position() const { return m_columns->arc_center_position(m_idx); }
+        std::pair<const Vec3f*, const Vec3f*> interpolation_points() const { return m_columns->interpolation_points(m_idx); }
+        // Materializes the move.
+        MoveVertex          vertex() const { return m_columns->vertex(m_idx); }
+
+    private:
+        const GCodeMovesColumns *m_columns;
+        size_t                   m_idx;
+    };
+
+    // Iterates over the views of the moves.
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = MoveView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = MoveView;
+
+        const_iterator(const GCodeMovesColumns &columns, size_t idx) : m_columns(&columns), m_idx(idx) {}
+
+        MoveView            operator*() const { return { *m_columns, m_idx }; }
+        const_iterator&     operator++() { ++ m_idx; return *this; }
+        const_iterator      operator++(int) { const_iterator out = *this; ++ m_idx; return out; }
+        bool                operator==(const const_iterator &rhs) const { return m_idx == rhs.m_idx; }
+        bool                operator!=(const const_iterator &rhs) const { return m_idx != rhs.m_idx; }
+        size_t              index() const { return m_idx; }
+
+    private:
+        const GCodeMovesColumns *m_columns;
+        size_t                   m_idx;
+    };
+
+    GCodeMovesColumns() = default;
+    explicit GCodeMovesColumns(const std::vector<MoveVertex> &moves) { this->assign(moves); }
+
+    void                assign(const std::vector<MoveVertex> &moves);
+    void                append(const MoveVertex &move);
+    void                push_back(const MoveVertex &move) { this->append(move); }
+    // Removes a single move, linear in the number of moves.
+    void                erase(size_t idx);
+    void                clear();
+    // Releases the palette lookup table used by append() and the unused capacity of the columns.
+    void                shrink_to_fit();
+
+    // Calls fn(MoveVertex&) for each palette entry with the palette attributes filled in and stores the modified attributes back,
+    // thus fn modifies the attributes of all the moves sharing the palette entry. fn shall only read and modify the palette attributes:
+    // type, extrusion role, extruder, color, path type, height, fan speed, temperature and layer duration.
+    template<typename Fn> void transform_attributes(Fn &&fn) {
+        for (Attributes &attr : m_palette) {
+            MoveVertex move = attributes_to_vertex(attr);
+            fn(move);
+            attr = vertex_to_attributes(move);
+        }
+        // Some entries may be equal now, rebuild the lookup table by the next append().
+        m_palette_map = {};
+    }
+    void                set_gcode_id(size_t idx, unsigned int gcode_id) { m_gcode_ids[idx] = gcode_id; }
+    void                set_width(size_t idx, float width) { m_widths[idx] = width; }
+
+    const_iterator      begin() const { return { *this, 0 }; }
+    const_iterator      end() const { return { *this, this->size() }; }
+    MoveView            operator[](size_t idx) const { return { *this, idx }; }
+    MoveView            back() const { return { *this, this->size() - 1 }; }
+
+    size_t              size() const { return m_gcode_ids.size(); }
+    bool                empty() const { return m_gcode_ids.empty(); }
+    size_t              palette_size() const { return m_palette.size(); }
+    // Memory allocated by the columns, the palette and the arc data in bytes.
+    size_t              memory_size() const;
+
+    unsigned int        gcode_id(size_t idx) const { return m_gcode_ids[idx]; }
+    const Vec3f&        position(size_t idx) const { return m_positions[idx]; }
+    float               delta_extruder(size_t idx) const { return m_delta_extruders[idx]; }
+    float               travel_dist(size_t idx) const { return m_travel_dists[idx]; }
+    float               time(size_t idx) const { return m_times[idx]; }
+
+    EMoveType           type(size_t idx) const { return this->attributes(idx).type; }
+    ExtrusionRole       extrusion_role(size_t idx) const { return this->attributes(idx).extrusion_role; }
+    unsigned char       extruder_id(size_t idx) const { return this->attributes(idx).extruder_id; }
+    unsigned char       cp_color_id(size_t idx) const { return this->attributes(idx).cp_color_id; }
+    EMovePathType       move_path_type(size_t idx) const { return this->attributes(idx).move_path_type; }
+    float               feedrate(size_t idx) const { return m_feedrates[idx]; }
+    float               width(size_t idx) const { return m_widths[idx]; }
+    float               height(size_t idx) const { return this->attributes(idx).height; }
+    float               mm3_per_mm(size_t idx) const { return m_mm3_per_mms[idx]; }
+    float               fan_speed(size_t idx) const { return this->attributes(idx).fan_speed; }
+    float               temperature(size_t idx) const { return this->attributes(idx).temperature; }
+    float               layer_duration(size_t idx) const { return this->attributes(idx).layer_duration; }
+    float               volumetric_rate(size_t idx) const { return m_feedrates[idx] * m_mm3_per_mms[idx]; }
+
+    bool                is_arc_move(size_t idx) const
+        { EMovePathType t = this->move_path_type(idx); return t == EMovePathType::Arc_move_cw || t == EMovePathType::Arc_move_ccw; }
+    // Zero for the moves, which are not arc moves.
+    Vec3f               arc_center_position(size_t idx) const;
+    // Interpolation points of an arc move as a range of pointers, empty for the other moves.
+    std::pair<const Vec3f*, const Vec3f*> interpolation_points(size_t idx) const;
+    size_t              interpolation_points_count(size_t idx) const
+        { auto [begin, end] = this->interpolation_points(idx); return size_t(end - begin); }
+    const Vec3f&        interpolation_point(size_t idx, size_t point_idx) const { return this->interpolation_points(idx).first[point_idx]; }
+    bool                is_arc_move_with_interpolation_points(size_t idx) const { return this->interpolation_points_count(idx) > 0; }
+
+    // Materializes a single MoveVertex. The arc center of moves other than the arc moves is not stored and it is returned zeroed.
+    MoveVertex          vertex(size_t idx) const;
+
+private:
+    struct Attributes
+    {
+        EMoveType     type{ EMoveType::Noop };
+        ExtrusionRole extrusion_role{ erNone };
+        unsigned char extruder_id{ 0 };
+        unsigned char cp_color_id{ 0 };
+        EMovePathType move_path_type{ EMovePathType::Noop_move };
+        float         height{ 0.0f };
+        float         fan_speed{ 0.0f };
+        float         temperature{ 0.0f };
+        float         layer_duration{ 0.0f };
+
+        bool operator==(const Attributes &rhs) const;
+    };
+    struct AttributesHash
+    {
+        size_t operator()(const Attributes &attr) const;
+    };
+
+    static MoveVertex   attributes_to_vertex(const Attributes &attr);
+    static Attributes   vertex_to_attributes(const MoveVertex &move);
+    const Attributes&   attributes(size_t idx) const { return m_palette[m_attributes[idx]]; }
+    // Index of the arc move in m_arc_moves or -1.
+    int                 arc_index(size_t idx) const;
+
+    std::vector<unsigned int>   m_gcode_ids;
+    std::vector<Vec3f>          m_positions;
+    std::vector<float>          m_delta_extruders;
+    std::vector<float>          m_travel_dists;
+    std::vector<float>          m_times;
+    std::vector<float>          m_feedrates;
+    std::vector<float>          m_widths;
+    std::vector<float>          m_mm3_per_mms;
+    // Indices into m_palette.
+    std::vector<uint32_t>       m_attributes;
+    std::vector<Attributes>     m_palette;
+    // Lookup of m_palette entries, only needed while appending.
+    std::unordered_map<Attributes, uint32_t, AttributesHash> m_palette_map;
+
+    // Sorted indices of the arc moves, their centers and ranges of their interpolation points.
+    std::vector<uint32_t>       m_arc_moves;
+    std::vector<Vec3f>          m_arc_centers;
+    // m_arc_moves.size() + 1 offsets into m_arc_points.
+    std::vector<uint32_t>       m_arc_points_offsets;
+    std::vector<Vec3f>          m_arc_points;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_GCodeMovesColumns_hpp_
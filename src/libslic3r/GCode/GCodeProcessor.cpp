@@ -50,6 +50,13 @@ static const float DEFAULT_FILAMENT_COST = 29.99f;
 static const int   DEFAULT_FILAMENT_VITRIFICATION_TEMPERATURE = 0;
 static const Slic3r::Vec3f DEFAULT_EXTRUDER_OFFSET = Slic3r::Vec3f::Zero();
 
+// Width of a line reserved for the post-processing, enough for the printing time estimates.
+static constexpr size_t RESERVED_LINE_WIDTH = 128;
+// Width of a line reserved for a M73 line, enough for "M73 P100 R99999".
+static constexpr size_t RESERVED_LINE_M73_WIDTH = 24;
+// Printing time between the reserved M73 lines, in seconds.
+static constexpr float  RESERVED_LINES_M73_INTERVAL = 20.0f;
+
 namespace Slic3r {
 
 const std::vector<std::string> GCodeProcessor::Reserved_Tags = {
@@ -556,7 +563,7 @@ void GCodeProcessorResult::reset() {
     //BBS: add mutex for protection of gcode result
     lock();
 
-    moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    moves = GCodeMovesColumns();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -1175,6 +1182,7 @@ void GCodeProcessor::reset()
     m_processing_start_custom_gcode = false;
     m_g1_line_id = 0;
     m_layer_id = 0;
+    m_next_M73_time = RESERVED_LINES_M73_INTERVAL;
     m_cp_color.reset();
 
     m_producer = EProducer::Unknown;
@@ -1194,6 +1202,7 @@ void GCodeProcessor::reset()
     m_seams_count = 0;
     m_preheat_time = 0.f;
     m_preheat_steps = 1;
+    m_reserved_lines.clear();
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     m_mm3_per_mm_compare.reset();
@@ -1265,9 +1274,9 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    auto   parse_line_callback      = [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
@@ -1275,7 +1284,13 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
                 cancel_callback();
         }
         this->process_gcode_line(line, true);
-    }, m_result.lines_ends);
+    };
+    // The layers are tokenized in parallel, but processed in order on this thread, each layer starting from the machine state
+    // left by the previous one, thus the moves and the time estimates are the same as if the file was parsed sequentially.
+    if (m_parse_chunk_size == 0)
+        m_parser.parse_file(filename, parse_line_callback, m_result.lines_ends);
+    else
+        m_parser.parse_file_parallel(filename, parse_line_callback, m_result.lines_ends, m_parse_chunk_size);
 
     // Don't post-process the G-code to update time stamps.
     this->finalize(false);
@@ -1293,7 +1308,7 @@ void GCodeProcessor::initialize(const std::string& filename)
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
 }
 
 void GCodeProcessor::process_buffer(const std::string &buffer)
@@ -1304,15 +1319,54 @@ void GCodeProcessor::process_buffer(const std::string &buffer)
     });
 }
 
+void GCodeProcessor::process_buffer(const char *begin, const char *end)
+{
+    m_parser.parse_buffer(begin, end, [this](GCodeReader&, const GCodeReader::GCodeLine& line) {
+        this->process_gcode_line(line, false);
+    });
+}
+
+std::pair<size_t, size_t> GCodeProcessor::reserved_lines(std::string_view line) const
+{
+    if (! this->post_process_in_place())
+        return { 0, 0 };
+    const size_t num_modes = this->is_stealth_time_estimator_enabled() ? 2 : 1;
+    size_t num_lines = 1;
+    if (line.size() > 1 && line.substr(1) == reserved_tag(ETags::Estimated_Printing_Time_Placeholder))
+        // The printing time and the first layer printing time of the normal and of the silent mode.
+        num_lines = 2 * num_modes;
+    else if (line.size() > 1 && line.substr(1) == reserved_tag(ETags::First_Line_M73_Placeholder))
+        // The progress and the remaining time to the next printer stop of the normal and of the silent mode.
+        num_lines = 2 * num_modes;
+    else if (line.size() > 1 && line.substr(1) == reserved_tag(ETags::Last_Line_M73_Placeholder))
+        num_lines = num_modes;
+    // The filament statistics are rewritten with the values of the time estimator, which may format longer.
+    return { num_lines, std::max(RESERVED_LINE_WIDTH, 2 * line.size() + 1) };
+}
+
+std::pair<size_t, size_t> GCodeProcessor::reserved_lines_M73()
+{
+    if (m_disable_m73 || ! this->post_process_in_place())
+        return { 0, 0 };
+    // The time of the blocks still waiting in the planner queue is not known yet, the reserved lines lag a little behind.
+    const float time = m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].time;
+    if (time < m_next_M73_time)
+        return { 0, 0 };
+    m_next_M73_time = time + RESERVED_LINES_M73_INTERVAL;
+    // The progress and the remaining time to the next printer stop of the normal and of the silent mode.
+    return { this->is_stealth_time_estimator_enabled() ? 4 : 2, RESERVED_LINE_M73_WIDTH };
+}
+
 void GCodeProcessor::finalize(bool post_process)
 {
-    // update width/height of wipe moves
-    for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
+    // update width/height of wipe moves, the width is stored per move, the height in the palette of the moves
+    for (size_t i = 0; i < m_result.moves.size(); ++i)
+        if (m_result.moves.type(i) == EMoveType::Wipe)
+            m_result.moves.set_width(i, Wipe_Width);
+    m_result.moves.transform_attributes([](GCodeProcessorResult::MoveVertex& move) {
+        if (move.type == EMoveType::Wipe)
             move.height = Wipe_Height;
-        }
-    }
+    });
 
     // process the time blocks
     for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
@@ -1332,15 +1386,18 @@ void GCodeProcessor::finalize(bool post_process)
     auto prepare_time = (it != time_mode.roles_times.end()) ? it->second : 0.0f;
 
     //update times for results
-    for (size_t i = 0; i < m_result.moves.size(); i++) {
+    //layer_duration is stored in the palette of the moves, thus it is updated once per palette entry.
+    const std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
+    m_result.moves.transform_attributes([&layer_times, prepare_time](GCodeProcessorResult::MoveVertex& move) {
         //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
-        std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
+        size_t layer_id = size_t(move.layer_duration);
         if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
+            move.layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
         else
-            m_result.moves[i].layer_duration = 0;
-    }
+            move.layer_duration = 0;
+    });
+    // Release the palette lookup table, the moves are final except for their G-code line ids.
+    m_result.moves.shrink_to_fit();
     
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     std::cout << "\n";
@@ -2977,8 +3034,8 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
     if (m_seams_detector.is_active()) {
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
-            //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            //BBS: m_result.moves.position(m_result.moves.size() - 1) has plate offset, must minus plate offset before calculate the real seam position
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             if (!m_seams_detector.has_first_vertex()) {
                 m_seams_detector.set_first_vertex(new_pos);
             } else if (m_detect_layer_based_on_tag) {
@@ -2996,8 +3053,8 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
             };
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            //BBS: m_result.moves.position(m_result.moves.size() - 1) has plate offset, must minus plate offset before calculate the real seam position
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3012,7 +3069,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     if (m_detect_layer_based_on_tag && !m_result.spiral_vase_layers.empty()) {
@@ -3413,7 +3470,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         //BBS: check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             if (!m_seams_detector.has_first_vertex()) {
                 m_seams_detector.set_first_vertex(new_pos);
             } else if (m_detect_layer_based_on_tag) {
@@ -3430,7 +3487,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
                 m_end_position[X] = pos.x(); m_end_position[Y] = pos.y(); m_end_position[Z] = pos.z();
             };
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             //BBS: the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3445,7 +3502,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     // Elegoo: we now use spiral_vase_layers for proper layer detect when scarf joint is enabled,
@@ -4119,16 +4176,6 @@ static void update_lines_ends_and_out_file_pos(const std::string& out_string, st
 
 void GCodeProcessor::run_post_process()
 {
-    FilePtr in{ boost::nowide::fopen(m_result.filename.c_str(), "rb") };
-    if (in.f == nullptr)
-        throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for reading.\n"));
-
-    // temporary file to contain modified gcode
-    std::string out_path = m_result.filename + ".postprocess";
-    FilePtr out{ boost::nowide::fopen(out_path.c_str(), "wb") };
-    if (out.f == nullptr)
-        throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for writing.\n"));
-
     std::vector<double> filament_mm(m_result.extruders_count, 0.0);
     std::vector<double> filament_cm3(m_result.extruders_count, 0.0);
     std::vector<double> filament_g(m_result.extruders_count, 0.0);
@@ -4162,33 +4209,31 @@ void GCodeProcessor::run_post_process()
         return time_in_seconds / 60.0f;
     };
 
-    auto format_line_M73_main = [this](const std::string& mask, int percent, int time) {
+    // The masks are formatted with string arguments only, a line not fitting into the buffer is dropped.
+    auto format_line_M73 = [](const std::string& mask, const std::string& value1, const std::string& value2 = std::string()) {
+        char line_M73[64];
+        const int len = snprintf(line_M73, sizeof(line_M73), mask.c_str(), value1.c_str(), value2.c_str());
+        return len > 0 && size_t(len) < sizeof(line_M73) ? std::string(line_M73, size_t(len)) : std::string();
+    };
+
+    auto format_line_M73_main = [this, format_line_M73](const std::string& mask, int percent, int time) {
         if(this->m_disable_m73)
             return std::string("");
-
-        char line_M73[64];
-        sprintf(line_M73, mask.c_str(),
-            std::to_string(percent).c_str(),
-            std::to_string(time).c_str());
-        return std::string(line_M73);
+        return format_line_M73(mask, std::to_string(percent), std::to_string(time));
     };
 
-    auto format_line_M73_stop_int = [this](const std::string& mask, int time) {
+    auto format_line_M73_stop_int = [this, format_line_M73](const std::string& mask, int time) {
         if (this->m_disable_m73)
             return std::string("");
-        char line_M73[64];
-        sprintf(line_M73, mask.c_str(), std::to_string(time).c_str());
-        return std::string(line_M73);
+        return format_line_M73(mask, std::to_string(time));
     };
 
     auto format_time_float = [](float time) {
         return Slic3r::float_to_string_decimal_point(time, 2);
     };
 
-    auto format_line_M73_stop_float = [format_time_float](const std::string& mask, float time) {
-        char line_M73[64];
-        sprintf(line_M73, mask.c_str(), format_time_float(time).c_str());
-        return std::string(line_M73);
+    auto format_line_M73_stop_float = [format_line_M73, format_time_float](const std::string& mask, float time) {
+        return format_line_M73(mask, format_time_float(time));
     };
 
     std::string gcode_line;
@@ -4468,12 +4513,13 @@ void GCodeProcessor::run_post_process()
 
         void synchronize_moves(GCodeProcessorResult& result) const {
             auto it = m_gcode_lines_map.begin();
-            for (GCodeProcessorResult::MoveVertex& move : result.moves) {
-                while (it != m_gcode_lines_map.end() && it->first < move.gcode_id) {
+            for (size_t i = 0; i < result.moves.size(); ++i) {
+                const unsigned int gcode_id = result.moves.gcode_id(i);
+                while (it != m_gcode_lines_map.end() && it->first < gcode_id) {
                     ++it;
                 }
-                if (it != m_gcode_lines_map.end() && it->first == move.gcode_id)
-                    move.gcode_id = it->second;
+                if (it != m_gcode_lines_map.end() && it->first == gcode_id)
+                    result.moves.set_gcode_id(i, it->second);
             }
         }
 
@@ -4499,11 +4545,13 @@ void GCodeProcessor::run_post_process()
 
     // replace placeholder lines with the proper final value
     // gcode_line is in/out parameter, to reduce expensive memory allocation
-    auto process_placeholders = [&](std::string& gcode_line) {
+    // the final lines are passed to append_line
+    auto process_placeholders = [&](std::string& gcode_line, auto &&append_line) {
         bool processed = false;
 
-        // remove trailing '\n'
+        // remove trailing '\n' and the padding of the reserved lines
         auto line = std::string_view(gcode_line).substr(0, gcode_line.length() - 1);
+        line = line.substr(0, line.find_last_not_of(' ') + 1);
 
         if (line.length() > 1) {
             line = line.substr(1);
@@ -4513,7 +4561,7 @@ void GCodeProcessor::run_post_process()
                     const TimeMachine& machine = m_time_processor.machines[i];
                     if (machine.enabled) {
                         // export pair <percent, remaining time>
-                        export_lines.append_line(format_line_M73_main(machine.line_m73_main_mask.c_str(),
+                        append_line(format_line_M73_main(machine.line_m73_main_mask.c_str(),
                             (line == reserved_tag(ETags::First_Line_M73_Placeholder)) ? 0 : 100,
                             (line == reserved_tag(ETags::First_Line_M73_Placeholder)) ? time_in_minutes(machine.time) : 0));
                         processed = true;
@@ -4521,7 +4569,7 @@ void GCodeProcessor::run_post_process()
                         // export remaining time to next printer stop
                         if (line == reserved_tag(ETags::First_Line_M73_Placeholder) && !machine.stop_times.empty()) {
                             const int to_export_stop = time_in_minutes(machine.stop_times.front().elapsed_time);
-                            export_lines.append_line(format_line_M73_stop_int(machine.line_m73_stop_mask.c_str(), to_export_stop));
+                            append_line(format_line_M73_stop_int(machine.line_m73_stop_mask.c_str(), to_export_stop));
                             last_exported_stop[i] = to_export_stop;
                         }
                     }
@@ -4531,37 +4579,30 @@ void GCodeProcessor::run_post_process()
                     const TimeMachine&                  machine = m_time_processor.machines[i];
                     PrintEstimatedStatistics::ETimeMode mode    = static_cast<PrintEstimatedStatistics::ETimeMode>(i);
                     if (mode == PrintEstimatedStatistics::ETimeMode::Normal || machine.enabled) {
-                        char buf[128];
                         if (!s_IsBBLPrinter)
                             // Orca: compatibility with klipper_estimator
-                            sprintf(buf, "; estimated printing time (%s mode) = %s\n",
-                                    (mode == PrintEstimatedStatistics::ETimeMode::Normal) ? "normal" : "silent",
-                                    get_time_dhms(machine.time).c_str());
-                        else {
-                            sprintf(buf, "; model printing time: %s; total estimated time: %s\n",
-                                    get_time_dhms(machine.time - machine.prepare_time).c_str(), get_time_dhms(machine.time).c_str());
-                        }
-                        export_lines.append_line(buf);
+                            append_line(std::string("; estimated printing time (") +
+                                        ((mode == PrintEstimatedStatistics::ETimeMode::Normal) ? "normal" : "silent") + " mode) = " +
+                                        get_time_dhms(machine.time) + "\n");
+                        else
+                            append_line("; model printing time: " + get_time_dhms(machine.time - machine.prepare_time) +
+                                        "; total estimated time: " + get_time_dhms(machine.time) + "\n");
                     }
                 }
                 for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
                     const TimeMachine&                  machine = m_time_processor.machines[i];
                     PrintEstimatedStatistics::ETimeMode mode    = static_cast<PrintEstimatedStatistics::ETimeMode>(i);
                     if (mode == PrintEstimatedStatistics::ETimeMode::Normal || machine.enabled) {
-                        char buf[128];
-                        sprintf(buf, "; estimated first layer printing time (%s mode) = %s\n",
-                                (mode == PrintEstimatedStatistics::ETimeMode::Normal) ? "normal" : "silent",
-                                get_time_dhms(machine.prepare_time).c_str());
-                        export_lines.append_line(buf);
+                        append_line(std::string("; estimated first layer printing time (") +
+                                    ((mode == PrintEstimatedStatistics::ETimeMode::Normal) ? "normal" : "silent") + " mode) = " +
+                                    get_time_dhms(machine.prepare_time) + "\n");
                         processed = true;
                     }
                 }
             }
             // Orca: write total layer number, this is used by Bambu printers only as of now
             else if (line == reserved_tag(ETags::Total_Layer_Number_Placeholder)) {
-                char buf[128];
-                sprintf(buf, "; total layer number: %u\n", m_layer_id);
-                export_lines.append_line(buf);
+                append_line("; total layer number: " + std::to_string(m_layer_id) + "\n");
                 processed = true;
             }
         }
@@ -4578,11 +4619,8 @@ void GCodeProcessor::run_post_process()
         auto process_tag = [](std::string& gcode_line, const std::string_view tag, const std::vector<double>& values) {
             if (boost::algorithm::starts_with(gcode_line, tag)) {
                 gcode_line = tag;
-                char buf[1024];
-                for (size_t i = 0; i < values.size(); ++i) {
-                    sprintf(buf, i == values.size() - 1 ? " %.2lf\n" : " %.2lf,", values[i]);
-                    gcode_line += buf;
-                }
+                for (size_t i = 0; i < values.size(); ++i)
+                    gcode_line.append(1, ' ').append(float_to_string_decimal_point(values[i], 2)) += (i == values.size() - 1 ? '\n' : ',');
                 return true;
             }
             return false;
@@ -4602,20 +4640,18 @@ void GCodeProcessor::run_post_process()
         // Prefilter for parsing speed.
         if (gcode_line.size() < 8 || gcode_line[0] != ';' || gcode_line[1] != 'C')
             return false;
-        auto process_tag = [](std::string& gcode_line, const std::string_view tag, const char* newTag, const double& value) {
+        auto process_tag = [](std::string& gcode_line, const std::string_view tag, const char* prefix, const double value, const int precision, const char* suffix) {
             if (boost::algorithm::starts_with(gcode_line, tag)) {
-                char buf[1024];
-                sprintf(buf, newTag, value);
-                gcode_line = buf;
+                gcode_line = prefix + float_to_string_decimal_point(value, precision) + suffix;
                 return true;
             }
             return false;
         };
 
         bool ret = false;
-        ret |= process_tag(gcode_line, ";CURA_TIME_PLACEHOLDER", ";TIME:%.0f\n", print_time);
-        ret |= process_tag(gcode_line, ";CURA_FILAMENT_USED_PLACEHOLDER", ";Filament used: %.5fm\n", filament_total_mm/1000);
-        ret |= process_tag(gcode_line, ";CURA_FILAMENT_WEIGHT_PLACEHOLDER",";Filament weight = .%.2f.\n", filament_total_g);
+        ret |= process_tag(gcode_line, ";CURA_TIME_PLACEHOLDER", ";TIME:", print_time, 0, "\n");
+        ret |= process_tag(gcode_line, ";CURA_FILAMENT_USED_PLACEHOLDER", ";Filament used: ", filament_total_mm/1000, 5, "m\n");
+        ret |= process_tag(gcode_line, ";CURA_FILAMENT_WEIGHT_PLACEHOLDER",";Filament weight = .", filament_total_g, 2, ".\n");
         return ret;
     };
 
@@ -4633,6 +4669,12 @@ void GCodeProcessor::run_post_process()
         return false;
     };
 
+    // check for the empty comments padded into the lines reserved for the M73 lines
+    auto is_reserved_M73 = [](const std::string_view gcode_line) {
+        return gcode_line.size() == RESERVED_LINE_M73_WIDTH && gcode_line.front() == ';' && gcode_line.back() == '\n' &&
+            gcode_line.find_first_not_of(' ', 1) == gcode_line.size() - 1;
+    };
+
     // Iterators for the normal and silent cached time estimate entry recently processed, used by process_line_G1.
     auto g1_times_cache_it = Slic3r::reserve_vector<std::vector<TimeMachine::G1LinesCacheItem>::const_iterator>(m_time_processor.machines.size());
     for (const auto& machine : m_time_processor.machines)
@@ -4707,6 +4749,43 @@ void GCodeProcessor::run_post_process()
         }
     };
 
+    // M73 lines for the lines reserved after the given G1 line when post processing in place
+    auto process_reserved_M73 = [this,
+        time_in_minutes, format_line_M73_main, format_line_M73_stop_int, format_line_M73_stop_float, time_in_last_minute,
+        &last_exported_main, &last_exported_stop]
+        (const unsigned int g1_line_id, auto &&append_line) {
+        for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
+            const TimeMachine& machine = m_time_processor.machines[i];
+            if (! machine.enabled)
+                continue;
+            // The last move processed before the lines were reserved.
+            auto it = std::upper_bound(machine.g1_times_cache.begin(), machine.g1_times_cache.end(), g1_line_id,
+                [](unsigned int value, const TimeMachine::G1LinesCacheItem& item) { return value < item.id; });
+            if (it == machine.g1_times_cache.begin())
+                continue;
+            -- it;
+            // export pair <percent, remaining time>
+            std::pair<int, int> to_export_main = { int(100.0f * it->elapsed_time / machine.time),
+                                                    time_in_minutes(machine.time - it->elapsed_time) };
+            if (last_exported_main[i] != to_export_main) {
+                append_line(format_line_M73_main(machine.line_m73_main_mask.c_str(), to_export_main.first, to_export_main.second));
+                last_exported_main[i] = to_export_main;
+            }
+            // export remaining time to next printer stop, within the last minute with the precision of the reserved lines
+            auto it_stop = std::upper_bound(machine.stop_times.begin(), machine.stop_times.end(), it->elapsed_time,
+                [](float value, const TimeMachine::StopTime& t) { return value < t.elapsed_time; });
+            if (it_stop != machine.stop_times.end()) {
+                int to_export_stop = time_in_minutes(it_stop->elapsed_time - it->elapsed_time);
+                if (last_exported_stop[i] != to_export_stop) {
+                    append_line(to_export_stop > 0 ?
+                        format_line_M73_stop_int(machine.line_m73_stop_mask.c_str(), to_export_stop) :
+                        format_line_M73_stop_float(machine.line_m73_stop_mask.c_str(), time_in_last_minute(it_stop->elapsed_time - it->elapsed_time)));
+                    last_exported_stop[i] = to_export_stop;
+                }
+            }
+        }
+    };
+
     // add lines M104 to exported gcode
     auto process_line_T = [this, &export_lines](const std::string& gcode_line, const size_t g1_lines_counter, const ExportLines::Backtrace& backtrace) {
         const std::string cmd = GCodeReader::GCodeLine::extract_cmd(gcode_line);
@@ -4784,6 +4863,67 @@ void GCodeProcessor::run_post_process()
         }
     };
 
+    // The lines to be replaced were reserved when exporting the G-code and the ends of the lines were collected then,
+    // overwrite the reserved lines in place. The file is only modified after all the final lines were checked to fit.
+    if (this->post_process_in_place() && ! m_result.lines_ends.empty()) {
+        std::vector<std::string> patches;
+        patches.reserve(m_reserved_lines.size());
+        std::vector<std::string> final_lines;
+        for (const ReservedLines &reserved : m_reserved_lines) {
+            gcode_line = reserved.line;
+            final_lines.clear();
+            auto append_line = [&final_lines](const std::string &line) { if (! line.empty()) final_lines.emplace_back(line); };
+            if (reserved.line.empty())
+                process_reserved_M73(reserved.g1_line_id, append_line);
+            else if (! process_placeholders(gcode_line, append_line)) {
+                if (! process_used_filament(gcode_line))
+                    process_cura_tag(gcode_line);
+                final_lines.emplace_back(gcode_line);
+            }
+            if (final_lines.size() > reserved.num_lines)
+                break;
+            std::string patch;
+            for (size_t i = 0; i < reserved.num_lines; ++ i) {
+                const std::string &line = i < final_lines.size() ? final_lines[i] : std::string(";\n");
+                assert(! line.empty() && line.back() == '\n');
+                if (line.size() > reserved.line_width)
+                    break;
+                patch.append(line, 0, line.size() - 1).append(reserved.line_width - line.size(), ' ') += '\n';
+            }
+            if (patch.size() != reserved.num_lines * reserved.line_width)
+                break;
+            patches.emplace_back(std::move(patch));
+        }
+        gcode_line.clear();
+        if (patches.size() == m_reserved_lines.size()) {
+            FilePtr file{ boost::nowide::fopen(m_result.filename.c_str(), "r+b") };
+            if (file.f == nullptr)
+                throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for writing.\n"));
+            for (size_t i = 0; i < patches.size(); ++ i) {
+#ifdef _WIN32
+                bool seek_failed = ::_fseeki64(file.f, __int64(m_reserved_lines[i].file_pos), SEEK_SET) != 0;
+#else
+                bool seek_failed = ::fseeko(file.f, off_t(m_reserved_lines[i].file_pos), SEEK_SET) != 0;
+#endif
+                if (seek_failed || ::fwrite(patches[i].data(), 1, patches[i].size(), file.f) != patches[i].size())
+                    throw Slic3r::RuntimeError("GCode processor post process export failed.\nIs the disk full?");
+            }
+            return;
+        }
+        // Some of the final lines do not fit, copy the file. The padding of the reserved lines is dropped.
+        BOOST_LOG_TRIVIAL(info) << "GCode processor: the post processed lines do not fit into the reserved lines, copying the G-code.";
+    }
+
+    FilePtr in{ boost::nowide::fopen(m_result.filename.c_str(), "rb") };
+    if (in.f == nullptr)
+        throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for reading.\n"));
+
+    // temporary file to contain modified gcode
+    std::string out_path = m_result.filename + ".postprocess";
+    FilePtr out{ boost::nowide::fopen(out_path.c_str(), "wb") };
+    if (out.f == nullptr)
+        throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for writing.\n"));
+
     m_result.lines_ends.clear();
     // m_result.lines_ends.emplace_back(std::vector<size_t>());
 
@@ -4793,6 +4933,8 @@ void GCodeProcessor::run_post_process()
     // In case there are multiple sources of backtracing, keeps track of the longest backtrack time needed
     // to flush the backtrace cache accordingly
     float max_backtrace_time = 120.0f;
+    // Number of the following lines reserved for the placeholder just processed.
+    size_t skip_reserved_lines = 0;
 
     {
         // Read the input stream 64kB at a time, extract lines and process them.
@@ -4827,10 +4969,24 @@ void GCodeProcessor::run_post_process()
                 if (eol) {
                     ++line_id;
                     const unsigned int internal_g1_lines_counter = export_lines.update(gcode_line, line_id, g1_lines_counter);
+                    if (skip_reserved_lines > 0 || is_reserved_M73(gcode_line)) {
+                        // drop the rest of the lines reserved for a placeholder and the lines reserved for the M73 lines,
+                        // these are inserted after the G1 lines
+                        if (skip_reserved_lines > 0)
+                            -- skip_reserved_lines;
+                        gcode_line.clear();
+                        continue;
+                    }
                     // replace placeholder lines
-                    bool processed = process_placeholders(gcode_line);
-                    if (processed)
+                    bool processed = process_placeholders(gcode_line, [&export_lines](const std::string &line) { export_lines.append_line(line); });
+                    if (processed) {
+                        if (gcode_line.size() > 1 && gcode_line[gcode_line.size() - 2] == ' ') {
+                            // the placeholder was padded into the reserved lines
+                            const size_t num_lines = this->reserved_lines(std::string_view(gcode_line).substr(0, gcode_line.find_last_not_of(" \n") + 1)).first;
+                            skip_reserved_lines = std::max<size_t>(num_lines, 1) - 1;
+                        }
                         gcode_line.clear();
+                    }
                     if (!processed)
                         processed = process_used_filament(gcode_line);
                     if (!processed)
@@ -2,6 +2,7 @@
 #define slic3r_GCodeProcessor_hpp_
 
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/GCodeMovesColumns.hpp"
 #include "libslic3r/Point.hpp"
 #include "libslic3r/ExtrusionEntity.hpp"
 #include "libslic3r/PrintConfig.hpp"
@@ -26,22 +27,6 @@ class Print;
 #define NOT_GENERATE_TIMELAPSE                                      "not_generate_timelapse"
 #define LONG_RETRACTION_WHEN_CUT                                    "activate_long_retraction_when_cut"
 
-    enum class EMoveType : unsigned char
-    {
-        Noop,
-        Retract,
-        Unretract,
-        Seam,
-        Tool_change,
-        Color_change,
-        Pause_Print,
-        Custom_GCode,
-        Travel,
-        Wipe,
-        Extrude,
-        Count
-    };
-
     struct PrintEstimatedStatistics
     {
         enum class ETimeMode : unsigned char
@@ -149,40 +134,7 @@ class Print;
             }
         };
 
-        struct MoveVertex
-        {
-            unsigned int gcode_id{ 0 };
-            EMoveType type{ EMoveType::Noop };
-            ExtrusionRole extrusion_role{ erNone };
-            unsigned char extruder_id{ 0 };
-            unsigned char cp_color_id{ 0 };
-            Vec3f position{ Vec3f::Zero() }; // mm
-            float delta_extruder{ 0.0f }; // mm
-            float feedrate{ 0.0f }; // mm/s
-            float width{ 0.0f }; // mm
-            float height{ 0.0f }; // mm
-            float mm3_per_mm{ 0.0f };
-            float travel_dist{ 0.0f }; // mm
-            float fan_speed{ 0.0f }; // percentage
-            float temperature{ 0.0f }; // Celsius degrees
-            float time{ 0.0f }; // s
-            float layer_duration{ 0.0f }; // s (layer id before finalize)
-
-
-            //BBS: arc move related data
-            EMovePathType move_path_type{ EMovePathType::Noop_move };
-            Vec3f arc_center_position{ Vec3f::Zero() };      // mm
-            std::vector<Vec3f> interpolation_points;     // interpolation points of arc for drawing
-
-            float volumetric_rate() const { return feedrate * mm3_per_mm; }
-            //BBS: new function to support arc move
-            bool is_arc_move_with_interpolation_points() const {
-                return (move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw) && interpolation_points.size();
-            }
-            bool is_arc_move() const {
-                return move_path_type == EMovePathType::Arc_move_ccw || move_path_type == EMovePathType::Arc_move_cw;
-            }
-        };
+        using MoveVertex = GCodeMoveVertex;
 
         struct SliceWarning {
             int         level;                  // 0: normal tips, 1: warning; 2: error
@@ -193,7 +145,7 @@ class Print;
 
         std::string filename;
         unsigned int id;
-        std::vector<MoveVertex> moves;
+        GCodeMovesColumns moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         std::vector<size_t> lines_ends;
         Pointfs printable_area;
@@ -587,12 +539,13 @@ class Print;
                 if (!m_move_id.has_value() || !m_custom_gcode_per_print_z_id.has_value())
                     return;
 
-                const Vec3f position = m_result.moves.back().position;
+                const Vec3f position = m_result.moves.position(m_result.moves.size() - 1);
 
-                GCodeProcessorResult::MoveVertex& move = m_result.moves.emplace_back(m_result.moves[*m_move_id]);
+                GCodeProcessorResult::MoveVertex move = m_result.moves.vertex(*m_move_id);
                 move.position = position;
                 move.height = height;
-                m_result.moves.erase(m_result.moves.begin() + *m_move_id);
+                m_result.moves.push_back(move);
+                m_result.moves.erase(*m_move_id);
                 m_result.custom_gcode_per_print_z[*m_custom_gcode_per_print_z_id].print_z = position.z();
                 reset();
             }
@@ -728,11 +681,26 @@ class Print;
         OptionsZCorrector m_options_z_corrector;
         size_t m_last_default_color_id;
         bool m_detect_layer_based_on_tag {false};
+        // Size of the chunks of the G-code file tokenized in parallel by process_file(), zero to parse the file sequentially.
+        size_t m_parse_chunk_size { 4 * 1024 * 1024 };
         int m_seams_count;
         bool m_single_extruder_multi_material;
         float m_preheat_time;
         int m_preheat_steps;
         bool m_disable_m73;
+        struct ReservedLines
+        {
+            std::string line;
+            size_t      file_pos;
+            size_t      num_lines;
+            size_t      line_width;
+            // Lines reserved for the M73 lines (empty line) are filled with the times at this G1 line.
+            unsigned int g1_line_id { 0 };
+        };
+        // Lines to be replaced by the post-processing in place, in the order of the G-code.
+        std::vector<ReservedLines> m_reserved_lines;
+        // Estimated printing time (normal mode) of the G-code processed so far at which the next M73 lines are reserved.
+        float m_next_M73_time;
 #if ENABLE_GCODE_VIEWER_STATISTICS
         std::chrono::time_point<std::chrono::high_resolution_clock> m_start_time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -791,8 +759,27 @@ class Print;
         // Streaming interface, for processing G-codes just generated by PrusaSlicer in a pipelined fashion.
         void initialize(const std::string& filename);
         void process_buffer(const std::string& buffer);
+        // Same as above for a null terminated buffer [begin, end).
+        void process_buffer(const char *begin, const char *end);
         void finalize(bool post_process);
 
+        // The post-processing overwrites the lines it replaces in the exported file, instead of copying the whole file.
+        // Only possible if no lines are inserted into the G-code, thus with the preheating M104 lines disabled.
+        // The M73 lines are written into lines reserved in regular intervals of the printing time.
+        bool post_process_in_place() const { return ! m_result.backtrace_enabled; }
+        // Number of lines and their width including the new line to reserve in the exported G-code for the given line
+        // (without the new line), which is replaced by the post-processing. Returns zero lines if not post processing in place.
+        std::pair<size_t, size_t> reserved_lines(std::string_view line) const;
+        // The line (with the new line) was written padded into the reserved lines at file_pos of the exported G-code.
+        void reserve_lines(const std::string &line, size_t file_pos, size_t num_lines, size_t line_width)
+            { m_reserved_lines.push_back({ line, file_pos, num_lines, line_width }); }
+        // Number of lines and their width including the new line to reserve for the M73 lines after the G-code processed so far.
+        // Returns zero lines if the next M73 lines are not due yet or if not post processing in place.
+        std::pair<size_t, size_t> reserved_lines_M73();
+        // The lines for the M73 lines were reserved at file_pos of the exported G-code.
+        void reserve_lines_M73(size_t file_pos, size_t num_lines, size_t line_width)
+            { m_reserved_lines.push_back({ std::string(), file_pos, num_lines, line_width, m_g1_line_id }); }
+
         float get_time(PrintEstimatedStatistics::ETimeMode mode) const;
         float get_prepare_time(PrintEstimatedStatistics::ETimeMode mode) const;
         std::string get_time_dhm(PrintEstimatedStatistics::ETimeMode mode) const;
@@ -809,6 +796,9 @@ class Print;
         // otherwise when we got a lift of z during extrusion, a new layer will be added
         void detect_layer_based_on_tag(bool enabled) { m_detect_layer_based_on_tag = enabled; }
 
+        // See GCodeReader::parse_file_parallel(), zero parses the file sequentially with GCodeReader::parse_file().
+        void set_parse_chunk_size(size_t chunk_size) { m_parse_chunk_size = chunk_size; }
+
     private:
         void apply_config(const DynamicPrintConfig& config);
         void apply_config_simplify3d(const std::string& filename);
@@ -950,6 +940,7 @@ class Print;
         // post process the file with the given filename to:
         // 1) add remaining time lines M73 and update moves' gcode ids accordingly
         // 2) update used filament data
+        // The file is only copied if the lines to be replaced were not reserved in place or the final lines do not fit.
         void run_post_process();
 
         //BBS: different path_type is only used for arc move
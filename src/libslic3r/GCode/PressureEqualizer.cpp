@@ -33,11 +33,6 @@ static constexpr long max_ignored_gap_between_extruding_segments = 3;
 
 PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig &config) : m_use_relative_e_distances(config.use_relative_e_distances.value)
 {
-    // Preallocate some data, so that output_buffer.data() will return an empty string.
-    output_buffer.assign(32, 0);
-    output_buffer_length      = 0;
-    output_buffer_prev_length = 0;
-
     m_current_extruder = 0;
     // Zero the position of the XYZE axes + the current feed
     memset(m_current_pos, 0, sizeof(float) * 5);
@@ -87,24 +82,15 @@ PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig &config) : m_use_
 #endif
 }
 
-void PressureEqualizer::process_layer(const std::string &gcode)
+void PressureEqualizer::process_layer(const GCodeLayerLines &gcode)
 {
     if (!gcode.empty()) {
-        const char *gcode_begin = gcode.c_str();
-        while (*gcode_begin != 0) {
-            // Find end of the line.
-            const char *gcode_end = gcode_begin;
-            // Slic3r always generates end of lines in a Unix style.
-            for (; *gcode_end != 0 && *gcode_end != '\n'; ++gcode_end);
-
+        for (size_t src_line = 0; src_line < gcode.size(); ++ src_line) {
             m_gcode_lines.emplace_back();
-            if (!this->process_line(gcode_begin, gcode_end, m_gcode_lines.back())) {
+            if (!this->process_line(gcode, src_line, m_gcode_lines.back())) {
                 // The line has to be forgotten. It contains comment marks, which shall be filtered out of the target g-code.
                 m_gcode_lines.pop_back();
             }
-            gcode_begin = gcode_end;
-            if (*gcode_begin == '\n')
-                ++gcode_begin;
         }
         assert(!this->opened_extrude_set_speed_block);
     }
@@ -116,7 +102,7 @@ void PressureEqualizer::process_layer(const std::string &gcode)
     while (idx_end_current_extrusion < m_gcode_lines.size()) {
         // find beginning of next extrusion segment from current pos
         const long idx_begin_current_extrusion   = find_if(m_gcode_lines.begin() + idx_end_current_extrusion, m_gcode_lines.end(),
-                                                          [](GCodeLine line) { return line.extruding(); }) - m_gcode_lines.begin();
+                                                          [](const GCodeLine &line) { return line.extruding(); }) - m_gcode_lines.begin();
         // (extrusion begin idx = extrusion end idx) here because we start with extrusion length of zero
         idx_end_current_extrusion = idx_begin_current_extrusion;
 
@@ -124,7 +110,7 @@ void PressureEqualizer::process_layer(const std::string &gcode)
         while (idx_end_current_extrusion < m_gcode_lines.size()) {
             // find end of the current extrusion segment
             const auto just_after_end_extrusion = find_if(m_gcode_lines.begin() + idx_end_current_extrusion, m_gcode_lines.end(),
-                                                          [](GCodeLine line) { return !line.extruding(); });
+                                                          [](const GCodeLine &line) { return !line.extruding(); });
             idx_end_current_extrusion = std::max<long>(0,(just_after_end_extrusion - m_gcode_lines.begin()) - 1);
             const long idx_begin_segment_continuation = advance_segment_beyond_small_gap(idx_end_current_extrusion);
             if (idx_begin_segment_continuation > idx_end_current_extrusion) {
@@ -171,37 +157,33 @@ long PressureEqualizer::advance_segment_beyond_small_gap(const long idx_orig)
      return idx_orig;
 }
 
-LayerResult PressureEqualizer::process_layer(LayerResult &&input)
+LayerLines PressureEqualizer::process_layer(LayerLines &&input)
 {
-    const bool   is_first_layer       = m_layer_results.empty();
+    const bool   is_first_layer       = m_layers.empty();
     const size_t next_layer_first_idx = m_gcode_lines.size();
 
     if (!input.nop_layer_result) {
         this->process_layer(input.gcode);
-        input.gcode.clear(); // GCode is already processed, so it isn't needed to store it.
-        m_layer_results.emplace(new LayerResult(input));
+        // The G-code is kept till the layer is exported, the lines not modified are copied from it.
+        m_layers.emplace(std::move(input));
     }
 
     if (is_first_layer) // Buffer previous input result and output NOP.
-        return LayerResult::make_nop_layer_result();
+        return { GCodeLayerLines(), std::numeric_limits<size_t>::max(), false, false, true };
 
     // Export previous layer.
-    LayerResult *prev_layer_result = m_layer_results.front();
-    m_layer_results.pop();
+    LayerLines prev_layer = std::move(m_layers.front());
+    m_layers.pop();
 
-    output_buffer_length      = 0;
-    output_buffer_prev_length = 0;
+    GCodeLayerLines out;
+    out.reserve(prev_layer.gcode.text().size(), prev_layer.gcode.size());
     for (size_t line_idx = 0; line_idx < next_layer_first_idx; ++line_idx)
-        output_gcode_line(line_idx);
+        output_gcode_line(line_idx, prev_layer.gcode, out);
     m_gcode_lines.erase(m_gcode_lines.begin(), m_gcode_lines.begin() + int(next_layer_first_idx));
 
-    if (output_buffer_length > 0)
-        prev_layer_result->gcode = std::string(output_buffer.data());
-
-    assert(!input.nop_layer_result || m_layer_results.empty());
-    LayerResult out = *prev_layer_result;
-    delete prev_layer_result;
-    return out;
+    assert(!input.nop_layer_result || m_layers.empty());
+    prev_layer.gcode = std::move(out);
+    return prev_layer;
 }
 
 // Is a white space?
@@ -251,9 +233,12 @@ static inline float parse_float(const char *&line, const size_t line_length)
     return result;
 }
 
-bool PressureEqualizer::process_line(const char *line, const char *line_end, GCodeLine &buf)
+bool PressureEqualizer::process_line(const GCodeLayerLines &gcode, const size_t src_line, GCodeLine &buf)
 {
-    const size_t len = line_end - line;
+    // The line is followed by '\n' or by the terminating zero of the G-code text, both are ends of line.
+    const std::string_view str_line = gcode.line(src_line);
+    const char            *line     = str_line.data();
+    const char            *line_end = line + str_line.size();
     if (strncmp(line, EXTRUSION_ROLE_TAG.data(), EXTRUSION_ROLE_TAG.length()) == 0) {
         line += EXTRUSION_ROLE_TAG.length();
         int role = atoi(line);
@@ -264,15 +249,10 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
         return false;
     }
 
-    // Set the type, copy the line to the buffer.
+    // Set the type, refer to the line of the G-code.
     buf.type = GCODELINETYPE_OTHER;
     buf.modified = false;
-    if (buf.raw.size() < len + 1)
-        buf.raw.assign(line, line + len + 1);
-    else
-        memcpy(buf.raw.data(), line, len);
-    buf.raw[len] = 0;
-    buf.raw_length = len;
+    buf.src_line = src_line;
 
     memcpy(buf.pos_start, m_current_pos, sizeof(float)*5);
     memcpy(buf.pos_end, m_current_pos, sizeof(float)*5);
@@ -285,9 +265,8 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     buf.max_volumetric_extrusion_rate_slope_negative = 0.f;
 	buf.extrusion_role = m_current_extrusion_role;
 
-    std::string str_line(line, line_end);
-    const bool found_extrude_set_speed_tag = boost::contains(str_line, EXTRUDE_SET_SPEED_TAG);
-    const bool found_extrude_end_tag = boost::contains(str_line, EXTRUDE_END_TAG);
+    const bool found_extrude_set_speed_tag = str_line.find(EXTRUDE_SET_SPEED_TAG) != std::string_view::npos;
+    const bool found_extrude_end_tag = str_line.find(EXTRUDE_END_TAG) != std::string_view::npos;
     assert(!found_extrude_set_speed_tag || !found_extrude_end_tag);
 
     if (found_extrude_set_speed_tag)
@@ -295,169 +274,154 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     else if (found_extrude_end_tag)
         this->opened_extrude_set_speed_block = false;
 
-    // Parse the G-code line, store the result into the buf.
-    switch (toupper(*line ++)) {
-    case 'G': {
-        int gcode = -1;
-        try {
-            gcode = parse_int(line);
-        } catch (Slic3r::InvalidArgument &) {
-            // Ignore invalid GCodes.
-            eatws(line);
-            break;
-        }
-
-        assert(gcode != -1);
-        eatws(line);
-        switch (gcode) {
-        case 0:
-        case 1:
-        {
-            // G0, G1: A FFF 3D printer does not make a difference between the two.
-            buf.adjustable_flow = this->opened_extrude_set_speed_block;
-            buf.extrude_set_speed_tag = found_extrude_set_speed_tag;
-            buf.extrude_end_tag = found_extrude_end_tag;
-            float new_pos[5];
-            memcpy(new_pos, m_current_pos, sizeof(float)*5);
-            bool  changed[5] = { false, false, false, false, false };
-            while (!is_eol(*line)) {
-                const char axis = toupper(*line++);
-                int  i = -1;
-                switch (axis) {
-                case 'X':
-                case 'Y':
-                case 'Z':
-                    i = axis - 'X';
-                    break;
-                case 'E':
-                    i = 3;
-                    break;
-                case 'F':
-                    i = 4;
-                    break;
-                default:
-                    break;
-                }
-                if (i != -1) {
-                    buf.pos_provided[i] = true;
-                    new_pos[i] = parse_float(line, line_end - line);
-                    if (i == 3 && m_use_relative_e_distances)
-                        new_pos[i] += m_current_pos[i];
-                    changed[i] = new_pos[i] != m_current_pos[i];
-                    eatws(line);
-                }
+    const GCodeLayerLines::Line &parsed = gcode[src_line];
+    if (parsed.canonical && (parsed.command == GCodeLayerLines::Command::G0 || parsed.command == GCodeLayerLines::Command::G1)) {
+        // The axes of the move were parsed by GCodeLayerLines, X, Y, Z, E, F share the indices with m_current_pos.
+        buf.adjustable_flow = this->opened_extrude_set_speed_block;
+        buf.extrude_set_speed_tag = found_extrude_set_speed_tag;
+        buf.extrude_end_tag = found_extrude_end_tag;
+        float new_pos[5];
+        memcpy(new_pos, m_current_pos, sizeof(float)*5);
+        bool  changed[5] = { false, false, false, false, false };
+        for (int i = 0; i < 5; ++ i)
+            if (parsed.has(GCodeLayerLines::Axis(i))) {
+                buf.pos_provided[i] = true;
+                new_pos[i] = parsed.value(GCodeLayerLines::Axis(i));
+                if (i == 3 && m_use_relative_e_distances)
+                    new_pos[i] += m_current_pos[i];
+                changed[i] = new_pos[i] != m_current_pos[i];
+            }
+        this->process_move(buf, new_pos, changed);
+    } else if (parsed.canonical && parsed.command == GCodeLayerLines::Command::G92) {
+        // G92 : Set Position of the axes parsed by GCodeLayerLines.
+        for (int i = 0; i < 4; ++ i)
+            if (parsed.has(GCodeLayerLines::Axis(i)))
+                m_current_pos[i] = parsed.value(GCodeLayerLines::Axis(i));
+    } else {
+        // Parse the G-code line, store the result into the buf.
+        switch (toupper(*line ++)) {
+        case 'G': {
+            int gcode = -1;
+            try {
+                gcode = parse_int(line);
+            } catch (Slic3r::InvalidArgument &) {
+                // Ignore invalid GCodes.
+                eatws(line);
+                break;
             }
-            if (changed[3]) {
-                // Extrusion, retract or unretract.
-                float diff = new_pos[3] - m_current_pos[3];
-                if (diff < 0) {
-                    buf.type = GCODELINETYPE_RETRACT;
-                    m_retracted = true;
-                } else if (! changed[0] && ! changed[1] && ! changed[2]) {
-                    // assert(m_retracted);
-                    buf.type = GCODELINETYPE_UNRETRACT;
-                    m_retracted = false;
-                } else {
-                    assert(changed[0] || changed[1]);
-                    // Moving in XY plane.
-                    buf.type = GCODELINETYPE_EXTRUDE;
-                    // Calculate the volumetric extrusion rate.
-                    float diff[4];
-                    for (size_t i = 0; i < 4; ++ i)
-                        diff[i] = new_pos[i] - m_current_pos[i];
-                    // volumetric extrusion rate = A_filament * F_xyz * L_e / L_xyz [mm^3/min]
-                    float len2 = diff[0]*diff[0]+diff[1]*diff[1]+diff[2]*diff[2];
-                    float rate = m_filament_crossections[m_current_extruder] * new_pos[4] * sqrt((diff[3]*diff[3])/len2);
-                    buf.volumetric_extrusion_rate       = rate;
-                    buf.volumetric_extrusion_rate_start = rate;
-                    buf.volumetric_extrusion_rate_end   = rate;
 
-#ifdef PRESSURE_EQUALIZER_STATISTIC
-                    m_stat.update(rate, sqrt(len2));
-#endif
-#ifdef PRESSURE_EQUALIZER_DEBUG
-                    if (rate < 40.f) {
-                        printf("Extremely low flow rate: %f. Line %d, Length: %f, extrusion: %f Old position: (%f, %f, %f), new position: (%f, %f, %f)\n",
-                               rate, int(line_idx), sqrt(len2), sqrt((diff[3] * diff[3]) / len2), m_current_pos[0], m_current_pos[1], m_current_pos[2],
-                               new_pos[0], new_pos[1], new_pos[2]);
+            assert(gcode != -1);
+            eatws(line);
+            switch (gcode) {
+            case 0:
+            case 1:
+            {
+                // G0, G1: A FFF 3D printer does not make a difference between the two.
+                buf.adjustable_flow = this->opened_extrude_set_speed_block;
+                buf.extrude_set_speed_tag = found_extrude_set_speed_tag;
+                buf.extrude_end_tag = found_extrude_end_tag;
+                float new_pos[5];
+                memcpy(new_pos, m_current_pos, sizeof(float)*5);
+                bool  changed[5] = { false, false, false, false, false };
+                while (!is_eol(*line)) {
+                    const char axis = toupper(*line++);
+                    int  i = -1;
+                    switch (axis) {
+                    case 'X':
+                    case 'Y':
+                    case 'Z':
+                        i = axis - 'X';
+                        break;
+                    case 'E':
+                        i = 3;
+                        break;
+                    case 'F':
+                        i = 4;
+                        break;
+                    default:
+                        break;
+                    }
+                    if (i != -1) {
+                        buf.pos_provided[i] = true;
+                        new_pos[i] = parse_float(line, line_end - line);
+                        if (i == 3 && m_use_relative_e_distances)
+                            new_pos[i] += m_current_pos[i];
+                        changed[i] = new_pos[i] != m_current_pos[i];
+                        eatws(line);
                     }
-#endif
                 }
-            } else if (changed[0] || changed[1] || changed[2]) {
-                // Moving without extrusion.
-                buf.type = GCODELINETYPE_MOVE;
+                this->process_move(buf, new_pos, changed);
+                break;
             }
-            memcpy(m_current_pos, new_pos, sizeof(float) * 5);
-            break;
-        }
-        case 92: 
-        {
-            // G92 : Set Position
-            // Set a logical coordinate position to a new value without actually moving the machine motors.
-            // Which axes to set?
-            while (!is_eol(*line)) {
-                const char axis = toupper(*line++);
-                switch (axis) {
-                case 'X':
-                case 'Y':
-                case 'Z':
-                    m_current_pos[axis - 'X'] = (!is_ws_or_eol(*line)) ? parse_float(line, line_end - line) : 0.f;
-                    break;
-                case 'E':
-                    m_current_pos[3] = (!is_ws_or_eol(*line)) ? parse_float(line, line_end - line) : 0.f;
-                    break;
-                default:
-                    break;
+            case 92: 
+            {
+                // G92 : Set Position
+                // Set a logical coordinate position to a new value without actually moving the machine motors.
+                // Which axes to set?
+                while (!is_eol(*line)) {
+                    const char axis = toupper(*line++);
+                    switch (axis) {
+                    case 'X':
+                    case 'Y':
+                    case 'Z':
+                        m_current_pos[axis - 'X'] = (!is_ws_or_eol(*line)) ? parse_float(line, line_end - line) : 0.f;
+                        break;
+                    case 'E':
+                        m_current_pos[3] = (!is_ws_or_eol(*line)) ? parse_float(line, line_end - line) : 0.f;
+                        break;
+                    default:
+                        break;
+                    }
+                    eatws(line);
                 }
-                eatws(line);
+                break;
             }
+            case 10:
+            case 22:
+                // Firmware retract.
+                buf.type = GCODELINETYPE_RETRACT;
+                m_retracted = true;
+                break;
+            case 11:
+            case 23:
+                // Firmware unretract.
+                buf.type = GCODELINETYPE_UNRETRACT;
+                m_retracted = false;
+                break;
+            default:
+                // Ignore the rest.
             break;
-        }
-        case 10:
-        case 22:
-            // Firmware retract.
-            buf.type = GCODELINETYPE_RETRACT;
-            m_retracted = true;
-            break;
-        case 11:
-        case 23:
-            // Firmware unretract.
-            buf.type = GCODELINETYPE_UNRETRACT;
-            m_retracted = false;
+            }
             break;
-        default:
-            // Ignore the rest.
-        break;
         }
-        break;
-    }
-    case 'M': {
-        eatws(line);
-        // Ignore the rest of the M-codes.
-        break;
-    }
-    case 'T':
-    {
-        // Activate an extruder head.
-        int new_extruder = -1;
-        try {
-            new_extruder = parse_int(line);
-        } catch (Slic3r::InvalidArgument &) {
-            // Ignore invalid GCodes starting with T.
+        case 'M': {
             eatws(line);
+            // Ignore the rest of the M-codes.
             break;
         }
-        assert(new_extruder != -1);
+        case 'T':
+        {
+            // Activate an extruder head.
+            int new_extruder = -1;
+            try {
+                new_extruder = parse_int(line);
+            } catch (Slic3r::InvalidArgument &) {
+                // Ignore invalid GCodes starting with T.
+                eatws(line);
+                break;
+            }
+            assert(new_extruder != -1);
 
-        if (new_extruder != int(m_current_extruder)) {
-            m_current_extruder = new_extruder;
-            m_retracted = true;
-            buf.type = GCODELINETYPE_TOOL_CHANGE;
-        } else {
-            buf.type = GCODELINETYPE_NOOP;
+            if (new_extruder != int(m_current_extruder)) {
+                m_current_extruder = new_extruder;
+                m_retracted = true;
+                buf.type = GCODELINETYPE_TOOL_CHANGE;
+            } else {
+                buf.type = GCODELINETYPE_NOOP;
+            }
+            break;
+        }
         }
-        break;
-    }
     }
 
     buf.extruder_id = m_current_extruder;
@@ -468,20 +432,69 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     return true;
 }
 
-void PressureEqualizer::output_gcode_line(const size_t line_idx)
+void PressureEqualizer::process_move(GCodeLine &buf, const float (&new_pos)[5], const bool (&changed)[5])
+{
+    if (changed[3]) {
+        // Extrusion, retract or unretract.
+        float diff = new_pos[3] - m_current_pos[3];
+        if (diff < 0) {
+            buf.type = GCODELINETYPE_RETRACT;
+            m_retracted = true;
+        } else if (! changed[0] && ! changed[1] && ! changed[2]) {
+            // assert(m_retracted);
+            buf.type = GCODELINETYPE_UNRETRACT;
+            m_retracted = false;
+        } else {
+            assert(changed[0] || changed[1]);
+            // Moving in XY plane.
+            buf.type = GCODELINETYPE_EXTRUDE;
+            // Calculate the volumetric extrusion rate.
+            float diff[4];
+            for (size_t i = 0; i < 4; ++ i)
+                diff[i] = new_pos[i] - m_current_pos[i];
+            // volumetric extrusion rate = A_filament * F_xyz * L_e / L_xyz [mm^3/min]
+            float len2 = diff[0]*diff[0]+diff[1]*diff[1]+diff[2]*diff[2];
+            float rate = m_filament_crossections[m_current_extruder] * new_pos[4] * sqrt((diff[3]*diff[3])/len2);
+            buf.volumetric_extrusion_rate       = rate;
+            buf.volumetric_extrusion_rate_start = rate;
+            buf.volumetric_extrusion_rate_end   = rate;
+
+#ifdef PRESSURE_EQUALIZER_STATISTIC
+            m_stat.update(rate, sqrt(len2));
+#endif
+#ifdef PRESSURE_EQUALIZER_DEBUG
+            if (rate < 40.f) {
+                printf("Extremely low flow rate: %f. Line %d, Length: %f, extrusion: %f Old position: (%f, %f, %f), new position: (%f, %f, %f)\n",
+                       rate, int(line_idx), sqrt(len2), sqrt((diff[3] * diff[3]) / len2), m_current_pos[0], m_current_pos[1], m_current_pos[2],
+                       new_pos[0], new_pos[1], new_pos[2]);
+            }
+#endif
+        }
+    } else if (changed[0] || changed[1] || changed[2]) {
+        // Moving without extrusion.
+        buf.type = GCODELINETYPE_MOVE;
+    }
+    memcpy(m_current_pos, new_pos, sizeof(float) * 5);
+}
+
+void PressureEqualizer::output_gcode_line(const size_t line_idx, const GCodeLayerLines &src, GCodeLayerLines &out)
 {
     GCodeLine &line = m_gcode_lines[line_idx];
     if (!line.modified) {
-        push_to_output(line.raw.data(), line.raw_length, true);
+        // Copy the line with its parsed data, terminate the last line of the layer.
+        out.append_line(src, line.src_line);
+        if (out.text().back() != '\n')
+            out.append_text("\n");
         return;
     }
 
     // The line was modified.
     // Find the comment.
-    const char *comment = line.raw.data();
-    while (*comment != ';' && *comment != 0) ++comment;
-    if (*comment != ';')
-        comment = nullptr;
+    std::string_view comment = src.line(line.src_line);
+    if (size_t pos = comment.find(';'); pos == std::string_view::npos)
+        comment = std::string_view();
+    else
+        comment.remove_prefix(pos);
 
     // get the gcode line length
     float l = line.dist_xyz();
@@ -499,7 +512,7 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
     // Or if the line size is equal in length with the smallest segment.
     // If so, then emit the line as a single extrusion, i.e. dont split into segments.
     if ( nSegments == 1 || delta_volumetric_rate < 10) {
-        push_line_to_output(line_idx, line.feedrate() * line.volumetric_correction_avg(), comment);
+        push_line_to_output(line_idx, line.feedrate() * line.volumetric_correction_avg(), comment, out);
     } else // The line needs to be split the line into segments and apply extrusion rate smoothing
     {
         bool accelerating = line.volumetric_extrusion_rate_start < line.volumetric_extrusion_rate_end;
@@ -550,8 +563,8 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
                     line.pos_end[i] = pos_start[i] + (pos_end[i] - pos_start[i]) * t;
                     line.pos_provided[i] = true;
                 }
-                push_line_to_output(line_idx, pos_start[4], comment);
-                comment = nullptr;
+                push_line_to_output(line_idx, pos_start[4], comment, out);
+                comment = std::string_view();
 
                 float new_pos_start_feedrate = pos_start[4];
 
@@ -570,8 +583,8 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
                 line.pos_provided[j] = true;
             } 
             // Interpolate the feed rate at the center of the segment.
-            push_line_to_output(line_idx, pos_start[4] + (pos_end[4] - pos_start[4]) * (float(i) - 0.5f) / float(nSegments), comment);
-            comment = nullptr;
+            push_line_to_output(line_idx, pos_start[4] + (pos_end[4] - pos_start[4]) * (float(i) - 0.5f) / float(nSegments), comment, out);
+            comment = std::string_view();
             memcpy(line.pos_start, line.pos_end, sizeof(float)*5);
         }
 		if (l_steady > 0.f && accelerating) {
@@ -579,13 +592,13 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
                 line.pos_end[i] = pos_end2[i];
                 line.pos_provided[i] = true;
             }
-            push_line_to_output(line_idx, pos_end[4], comment);
+            push_line_to_output(line_idx, pos_end[4], comment, out);
         } else {
             for (int i = 0; i < 4; ++ i) {
                 line.pos_end[i] = pos_end[i];
                 line.pos_provided[i] = true;
             }
-            push_line_to_output(line_idx, pos_end[4], comment);
+            push_line_to_output(line_idx, pos_end[4], comment, out);
         }
     }
 }
@@ -722,69 +735,27 @@ void PressureEqualizer::adjust_volumetric_rate(const size_t fist_line_idx, const
     }
 }
 
-inline void PressureEqualizer::push_to_output(GCodeG1Formatter &formatter)
-{
-    return this->push_to_output(formatter.string(), false);
-}
-
-inline void PressureEqualizer::push_to_output(const std::string &text, bool add_eol)
-{
-    return this->push_to_output(text.data(), text.size(), add_eol);
-}
-
-inline void PressureEqualizer::push_to_output(const char *text, const size_t len, bool add_eol)
-{
-    // New length of the output buffer content.
-    size_t len_new = output_buffer_length + len + 1;
-    if (add_eol)
-        ++len_new;
-
-    // Resize the output buffer to a power of 2 higher than the required memory.
-    if (output_buffer.size() < len_new) {
-        size_t v = len_new;
-        // Compute the next highest power of 2 of 32-bit v
-        // http://graphics.stanford.edu/~seander/bithacks.html
-        v--;
-        v |= v >> 1;
-        v |= v >> 2;
-        v |= v >> 4;
-        v |= v >> 8;
-        v |= v >> 16;
-        v++;
-        output_buffer.resize(v);
-    }
-
-    // Copy the text to the output.
-    if (len != 0) {
-        memcpy(output_buffer.data() + output_buffer_length, text, len);
-        this->output_buffer_prev_length = this->output_buffer_length;
-        output_buffer_length += len;
-    }
-    if (add_eol)
-        output_buffer[output_buffer_length++] = '\n';
-    output_buffer[output_buffer_length] = 0;
-}
-
-inline bool is_just_line_with_extrude_set_speed_tag(const std::string &line)
+// Is it a line emitted by push_line_to_output() just to set the feed rate, such as "G1 F1200 ;_EXTRUDE_SET_SPEED"?
+static bool is_just_line_with_extrude_set_speed_tag(std::string_view line)
 {
-    if (line.empty() && !boost::starts_with(line, "G1 ") && !boost::ends_with(line, EXTRUDE_SET_SPEED_TAG))
+    if (line.substr(0, 4) != "G1 F")
+        return false;
+    const char *p_line   = line.data() + 4;
+    const char *line_end = line.data() + line.size();
+    size_t      number_len = 0;
+    string_to_float_decimal_point(p_line, line_end - p_line, &number_len);
+    if (number_len == 0)
+        return false;
+    p_line += number_len;
+    if (p_line == line_end || !is_ws(*p_line))
         return false;
-
-    const char       *p_line   = line.data() + 3;
-    const char *const line_end = line.data() + line.length() - 1;
-    while (!is_eol(*p_line)) {
-        if (toupper(*p_line++) == 'F')
-            break;
-        else
-            return false;
-    }
-    parse_float(p_line, line_end - p_line);
     eatws(p_line);
-    p_line += EXTRUDE_SET_SPEED_TAG.length();
-    return p_line <= line_end && is_eol(*p_line);
+    line.remove_prefix(p_line - line.data());
+    return line.substr(0, EXTRUDE_SET_SPEED_TAG.size()) == EXTRUDE_SET_SPEED_TAG &&
+        (line.size() == EXTRUDE_SET_SPEED_TAG.size() || is_eol(line[EXTRUDE_SET_SPEED_TAG.size()]));
 }
 
-void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_feedrate, const char *comment)
+void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_feedrate, std::string_view comment, GCodeLayerLines &out)
 {
     // Orca: sanity check, 1 mm/s is the minimum feedrate.
     if (new_feedrate < 60)
@@ -792,22 +763,20 @@ void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_fee
     // Quantize speed changes to a minimum of 1mm/sec, to reduce gcode volume for trivial speed changes.
     new_feedrate = std::round(new_feedrate / 60.0) * 60.0;
     const GCodeLine &line = m_gcode_lines[line_idx];
-    if (line_idx > 0 && output_buffer_length > 0) {
-        const std::string prev_line_str = std::string(output_buffer.begin() + int(this->output_buffer_prev_length),
-                                                      output_buffer.begin() + int(this->output_buffer_length) + 1);
-        if (is_just_line_with_extrude_set_speed_tag(prev_line_str))
-            this->output_buffer_length = this->output_buffer_prev_length; // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
+    if (line_idx > 0 && !out.empty()) {
+        if (is_just_line_with_extrude_set_speed_tag(out.line(out.size() - 1)))
+            out.pop_back(); // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
         else
-            push_to_output(EXTRUDE_END_TAG.data(), EXTRUDE_END_TAG.length(), true);
+            out.append_text(EXTRUDE_END_TAG + "\n");
     } else
-        push_to_output(EXTRUDE_END_TAG.data(), EXTRUDE_END_TAG.length(), true);
+        out.append_text(EXTRUDE_END_TAG + "\n");
 
     GCodeG1Formatter feedrate_formatter;
     feedrate_formatter.emit_f(new_feedrate);
     feedrate_formatter.emit_string(std::string(EXTRUDE_SET_SPEED_TAG.data(), EXTRUDE_SET_SPEED_TAG.length()));
     if (line.extrusion_role == ExtrusionRole::erExternalPerimeter)
         feedrate_formatter.emit_string(std::string(EXTERNAL_PERIMETER_TAG.data(), EXTERNAL_PERIMETER_TAG.length()));
-    push_to_output(feedrate_formatter);
+    out.append_text(feedrate_formatter.string());
 
     GCodeG1Formatter extrusion_formatter;
     for (size_t axis_idx = 0; axis_idx < 3; ++axis_idx)
@@ -815,10 +784,10 @@ void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_fee
             extrusion_formatter.emit_axis(char('X' + axis_idx), line.pos_end[axis_idx], GCodeFormatter::XYZF_EXPORT_DIGITS);
     extrusion_formatter.emit_axis('E', m_use_relative_e_distances ? (line.pos_end[3] - line.pos_start[3]) : line.pos_end[3], GCodeFormatter::E_EXPORT_DIGITS);
 
-    if (comment != nullptr)
-        extrusion_formatter.emit_string(std::string(comment));
+    if (!comment.empty())
+        extrusion_formatter.emit_string(comment);
 
-    push_to_output(extrusion_formatter);
+    out.append_text(extrusion_formatter.string());
 }
 
 } // namespace Slic3r
@@ -3,15 +3,13 @@
 
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
+#include "GCodeLayerLines.hpp"
 
 #include <queue>
+#include <string_view>
 
 namespace Slic3r {
 
-struct LayerResult;
-
-class GCodeG1Formatter;
-
 //#define PRESSURE_EQUALIZER_STATISTIC
 //#define PRESSURE_EQUALIZER_DEBUG
 
@@ -25,12 +23,13 @@ public:
     ~PressureEqualizer() = default;
 
     // Process a next batch of G-code lines.
-    // The last LayerResult must be LayerResult::make_nop_layer_result() because it always returns GCode for the previous layer.
-    // When process_layer is called for the first layer, then LayerResult::make_nop_layer_result() is returned.
-    LayerResult process_layer(LayerResult &&input);
+    // The last LayerLines must be a NOP layer because it always returns GCode for the previous layer.
+    // When process_layer is called for the first layer, then a NOP layer is returned.
+    // The lines of the input are read as parsed by GCodeLayerLines, the lines not modified are copied to the output with their parsed data.
+    LayerLines process_layer(LayerLines &&input);
 private:
 
-    void process_layer(const std::string &gcode);
+    void process_layer(const GCodeLayerLines &gcode);
 
 #ifdef PRESSURE_EQUALIZER_STATISTIC
     struct Statistics
@@ -106,7 +105,7 @@ private:
     {
         GCodeLine() : 
             type(GCODELINETYPE_INVALID),
-            raw_length(0),
+            src_line(0),
             modified(false),
             extruder_id(0), 
             volumetric_extrusion_rate(0.f), 
@@ -140,9 +139,8 @@ private:
 
         GCodeLineType type;
 
-        // We try to keep the string buffer once it has been allocated, so it will not be reallocated over and over.
-        std::vector<char>   raw;
-        size_t              raw_length;
+        // Index of the line in the G-code of its layer.
+        size_t              src_line;
         // If modified, the raw text has to be adapted by the new extrusion rate,
         // or maybe the line needs to be split into multiple lines.
         bool                modified;
@@ -176,33 +174,27 @@ private:
         bool        extrude_end_tag       = false;
     };
 
-    // Output buffer will only grow. It will not be reallocated over and over.
-    std::vector<char>               output_buffer;
-    size_t                          output_buffer_length;
-    size_t                          output_buffer_prev_length;
-
 #ifdef PRESSURE_EQUALIZER_DEBUG
     // For debugging purposes. Index of the G-code line processed.
     size_t                          line_idx;
 #endif
 
-    bool process_line(const char *line, const char *line_end, GCodeLine &buf);
+    bool process_line(const GCodeLayerLines &gcode, size_t src_line, GCodeLine &buf);
+    // Update the current position and the type of a G0 / G1 line by the new position.
+    void process_move(GCodeLine &buf, const float (&new_pos)[5], const bool (&changed)[5]);
     long advance_segment_beyond_small_gap(long idx_cur_pos);
-    void output_gcode_line(size_t line_idx);
+    void output_gcode_line(size_t line_idx, const GCodeLayerLines &src, GCodeLayerLines &out);
 
     // Go back from the current circular_buffer_pos and lower the feedtrate to decrease the slope of the extrusion rate changes.
     // Then go forward and adjust the feedrate to decrease the slope of the extrusion rate changes.
     void adjust_volumetric_rate(size_t first_line_idx, size_t last_line_idx);
 
-    // Push the text to the end of the output_buffer.
-    inline void push_to_output(GCodeG1Formatter &formatter);
-    inline void push_to_output(const std::string &text, bool add_eol);
-    inline void push_to_output(const char *text, size_t len, bool add_eol = true);
     // Push a G-code line to the output.
-    void push_line_to_output(size_t line_idx, float new_feedrate, const char *comment);
+    void push_line_to_output(size_t line_idx, float new_feedrate, std::string_view comment, GCodeLayerLines &out);
 
 public:
-    std::queue<LayerResult*> m_layer_results;
+    // Layers processed, but not returned yet.
+    std::queue<LayerLines> m_layers;
 
     std::vector<GCodeLine> m_gcode_lines;
 };
@@ -23,6 +23,7 @@
 #include "libslic3r/TriangleSetSampling.hpp"
 
 #include "libslic3r/Utils.hpp"
+#include "libslic3r/MD5Hasher.hpp"
 
 //#define DEBUG_FILES
 
@@ -290,13 +291,37 @@ struct CoordinateFunctor {
   }
 };
 
-// structure to store global information about the model - occlusion hits, enforcers, blockers
-struct GlobalModelInfo {
+// Visibility of the samples of the object mesh calculated by raycasting, shared through SeamVisibilityCache.
+// Depends on the meshes of the object and on the seam position only.
+struct MeshVisibility {
   TriangleSetSamples mesh_samples;
   std::vector<float> mesh_samples_visibility;
-  CoordinateFunctor mesh_samples_coordinate_functor;
-  KDTreeIndirect<3, float, CoordinateFunctor> mesh_samples_tree { CoordinateFunctor { } };
   float mesh_samples_radius;
+};
+
+// Values of a seam candidate calculated by SeamPlacer::calculate_candidates_visibility()
+// and by SeamPlacer::calculate_overhangs_and_layer_embedding().
+struct CandidateValues {
+  float visibility;
+  float overhang;
+  float unsupported_dist;
+  float embedded_distance;
+};
+
+// Candidate values of the layers of an object, shared through SeamVisibilityCache.
+struct ObjectCandidateValues {
+  struct Layer {
+    // Hash of the inputs of the values of the layer not covered by the key of the object, see layer_candidates_key().
+    SeamVisibilityCache::Key key;
+    std::vector<CandidateValues> values;
+  };
+  std::vector<Layer> layers;
+};
+
+// structure to store global information about the model - occlusion hits, enforcers, blockers
+struct GlobalModelInfo {
+  std::shared_ptr<const MeshVisibility> mesh_visibility;
+  KDTreeIndirect<3, float, CoordinateFunctor> mesh_samples_tree { CoordinateFunctor { } };
 
   indexed_triangle_set enforcers;
   indexed_triangle_set blockers;
@@ -321,7 +346,14 @@ struct GlobalModelInfo {
                                                        blockers_tree, position, radius_sqr);
   }
 
+  void set_mesh_visibility(std::shared_ptr<const MeshVisibility> visibility) {
+    mesh_visibility = std::move(visibility);
+    mesh_samples_tree = KDTreeIndirect<3, float, CoordinateFunctor>(CoordinateFunctor(&mesh_visibility->mesh_samples.positions),
+                                                                    mesh_visibility->mesh_samples.positions.size());
+  }
+
   float calculate_point_visibility(const Vec3f &position) const {
+    const float mesh_samples_radius = mesh_visibility->mesh_samples_radius;
     std::vector<size_t> points = find_nearby_points(mesh_samples_tree, position, mesh_samples_radius);
     if (points.empty()) {
       return 1.0f;
@@ -337,12 +369,12 @@ struct GlobalModelInfo {
     for (size_t i = 0; i < points.size(); ++i) {
       size_t sample_idx = points[i];
 
-      Vec3f sample_point = this->mesh_samples.positions[sample_idx];
-      Vec3f sample_normal = this->mesh_samples.normals[sample_idx];
+      Vec3f sample_point = mesh_visibility->mesh_samples.positions[sample_idx];
+      Vec3f sample_normal = mesh_visibility->mesh_samples.normals[sample_idx];
 
       float weight = mesh_samples_radius - compute_dist_to_plane(position, sample_point, sample_normal);
       weight += (mesh_samples_radius - (position - sample_point).norm());
-      total_visibility += weight * mesh_samples_visibility[sample_idx];
+      total_visibility += weight * mesh_visibility->mesh_samples_visibility[sample_idx];
       total_weight += weight;
     }
 
@@ -387,8 +419,9 @@ struct GlobalModelInfo {
         return;
       }
 
+      const TriangleSetSamples &mesh_samples = mesh_visibility->mesh_samples;
       for (size_t i = 0; i < mesh_samples.positions.size(); ++i) {
-        float visibility = mesh_samples_visibility[i];
+        float visibility = mesh_visibility->mesh_samples_visibility[i];
         Vec3f color = value_to_rgbf(0.0f, 1.0f, visibility);
         fprintf(fp, "v %f %f %f  %f %f %f\n",
                 mesh_samples.positions[i](0), mesh_samples.positions[i](1), mesh_samples.positions[i](2),
@@ -621,10 +654,59 @@ std::pair<size_t, size_t> find_previous_and_next_perimeter_point(const std::vect
   return {size_t(prev),size_t(next)};
 }
 
-// Computes all global model info - transforms object, performs raycasting
-void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
-                              std::function<void(void)> throw_if_canceled,
-                              SeamPosition seam_position = spAligned) {
+// Hash of the inputs of compute_mesh_visibility(): the meshes of the model parts and negative volumes,
+// their transformations and the seam position.
+SeamVisibilityCache::Key mesh_visibility_key(const PrintObject *po, SeamPosition seam_position) {
+  MD5Hasher hasher;
+  for (const ModelVolume *model_volume : po->model_object()->volumes) {
+    if (model_volume->type() == ModelVolumeType::MODEL_PART
+        || model_volume->type() == ModelVolumeType::NEGATIVE_VOLUME) {
+      hasher.value(model_volume->type() == ModelVolumeType::NEGATIVE_VOLUME);
+      hasher.mesh(model_volume->mesh().its);
+      hasher.transform(model_volume->get_matrix());
+    }
+  }
+  hasher.transform(po->trafo_centered());
+  // Only the back variant of the aligned seam changes the visibility.
+  hasher.value(seam_position == spAlignedBack);
+  return hasher.digest();
+}
+
+// The layer embedding is only calculated for the layers with perimeters of multiple regions.
+bool layer_has_multiple_perimeter_regions(const Layer *layer) {
+  size_t regions_with_perimeter = 0;
+  for (const LayerRegion *region : layer->regions()) {
+    if (region->perimeters.entities.size() > 0) {
+      regions_with_perimeter++;
+    }
+  }
+  return regions_with_perimeter > 1;
+}
+
+// Hash of the inputs of the candidate values of a layer, which are not covered by mesh_visibility_key():
+// the seam candidates with their perimeter widths, the layer height and the slices of the layer and of the layer below.
+SeamVisibilityCache::Key layer_candidates_key(const PrintObject *po, size_t layer_idx,
+                                              const std::vector<SeamCandidate> &points, bool visibility) {
+  MD5Hasher hasher;
+  const Layer *layer = po->get_layer(int(layer_idx));
+  hasher.value(visibility);
+  hasher.value(layer_has_multiple_perimeter_regions(layer));
+  hasher.value(layer->height);
+  hasher.value(points.size());
+  for (const SeamCandidate &point : points) {
+    hasher.bytes(point.position.data(), sizeof(float) * 3);
+    hasher.value(point.perimeter.flow_width);
+  }
+  hasher.expolygons(layer->lslices);
+  if (layer_idx > 0)
+    hasher.expolygons(po->get_layer(int(layer_idx) - 1)->lslices);
+  return hasher.digest();
+}
+
+// Computes the visibility of the object mesh - transforms object, performs raycasting
+std::shared_ptr<MeshVisibility> compute_mesh_visibility(const PrintObject *po,
+                                                        std::function<void(void)> throw_if_canceled,
+                                                        SeamPosition seam_position = spAligned) {
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: gather occlusion meshes: start";
   auto obj_transform = po->trafo_centered();
@@ -663,11 +745,9 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: Compute visibility sample points: start";
 
-  result.mesh_samples = sample_its_uniform_parallel(SeamPlacer::raycasting_visibility_samples_count,
-                                                    triangle_set);
-  result.mesh_samples_coordinate_functor = CoordinateFunctor(&result.mesh_samples.positions);
-  result.mesh_samples_tree = KDTreeIndirect<3, float, CoordinateFunctor>(result.mesh_samples_coordinate_functor,
-                                                                         result.mesh_samples.positions.size());
+  auto result = std::make_shared<MeshVisibility>();
+  result->mesh_samples = sample_its_uniform_parallel(SeamPlacer::raycasting_visibility_samples_count,
+                                                     triangle_set);
 
   // The following code determines search area for random visibility samples on the mesh when calculating visibility of each perimeter point
   // number of random samples in the given radius (area) is approximately poisson distribution
@@ -675,20 +755,20 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
   // parameters of exponential distribution to compute area that will have with probability="probability" more than given number of samples="samples"
   float probability = 0.9f;
   float samples = 4;
-  float density = SeamPlacer::raycasting_visibility_samples_count / result.mesh_samples.total_area;
+  float density = SeamPlacer::raycasting_visibility_samples_count / result->mesh_samples.total_area;
   // exponential probability distrubtion function is : f(x) = P(X > x) = e^(l*x) where l is the rate parameter (computed as 1/u where u is mean value)
   // probability that sampled area A with S samples contains more than samples count:
   //  P(S > samples in A) = e^-(samples/(density*A));   express A:
   float search_area = samples / (-logf(probability) * density);
   float search_radius = sqrt(search_area / PI);
-  result.mesh_samples_radius = search_radius;
+  result->mesh_samples_radius = search_radius;
 
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: Compute visiblity sample points: end";
   throw_if_canceled();
 
   BOOST_LOG_TRIVIAL(debug)
-      << "SeamPlacer: Mesh sample raidus: " << result.mesh_samples_radius;
+      << "SeamPlacer: Mesh sample raidus: " << result->mesh_samples_radius;
 
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: build AABB tree: start";
@@ -698,12 +778,15 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
   throw_if_canceled();
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: build AABB tree: end";
-  result.mesh_samples_visibility = raycast_visibility(raycasting_tree, triangle_set, result.mesh_samples,
-                                                      negative_volumes_start_index, seam_position);
+  result->mesh_samples_visibility = raycast_visibility(raycasting_tree, triangle_set, result->mesh_samples,
+                                                       negative_volumes_start_index, seam_position);
   throw_if_canceled();
 #ifdef DEBUG_FILES
-  result.debug_export(triangle_set);
+  GlobalModelInfo debug_model_info;
+  debug_model_info.set_mesh_visibility(result);
+  debug_model_info.debug_export(triangle_set);
 #endif
+  return result;
 }
 
 void gather_enforcers_blockers(GlobalModelInfo &result, const PrintObject *po) {
@@ -1036,13 +1119,16 @@ void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerI
 }
 
 void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
-                                                 const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
+                                                 const SeamPlacerImpl::GlobalModelInfo &global_model_info,
+                                                 const std::vector<bool> &layers_to_calculate) {
   using namespace SeamPlacerImpl;
 
   std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
   tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                    [&layers, &global_model_info](tbb::blocked_range<size_t> r) {
+                    [&layers, &global_model_info, &layers_to_calculate](tbb::blocked_range<size_t> r) {
                       for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
+                        if (! layers_to_calculate[layer_idx])
+                          continue;
                         for (auto &perimeter_point : layers[layer_idx].points) {
                           perimeter_point.visibility = global_model_info.calculate_point_visibility(
                               perimeter_point.position);
@@ -1051,26 +1137,23 @@ void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
                     });
 }
 
-void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po) {
+void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po, const std::vector<bool> &layers_to_calculate) {
   using namespace SeamPlacerImpl;
   using PerimeterDistancer = AABBTreeLines::LinesDistancer<Linef>;
 
   std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
   tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                    [po, &layers](tbb::blocked_range<size_t> r) {
+                    [po, &layers, &layers_to_calculate](tbb::blocked_range<size_t> r) {
                       std::unique_ptr<PerimeterDistancer> prev_layer_distancer;
-                      if (r.begin() > 0) { // previous layer exists
-                        prev_layer_distancer = std::make_unique<PerimeterDistancer>(to_unscaled_linesf(po->layers()[r.begin() - 1]->lslices));
-                      }
-
                       for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                        size_t regions_with_perimeter = 0;
-                        for (const LayerRegion *region : po->layers()[layer_idx]->regions()) {
-                          if (region->perimeters.entities.size() > 0) {
-                            regions_with_perimeter++;
-                          }
-                        };
-                        bool should_compute_layer_embedding = regions_with_perimeter > 1;
+                        if (! layers_to_calculate[layer_idx]) {
+                          prev_layer_distancer.reset();
+                          continue;
+                        }
+                        if (layer_idx > 0 && prev_layer_distancer.get() == nullptr) { // previous layer exists
+                          prev_layer_distancer = std::make_unique<PerimeterDistancer>(to_unscaled_linesf(po->layers()[layer_idx - 1]->lslices));
+                        }
+                        bool should_compute_layer_embedding = layer_has_multiple_perimeter_regions(po->layers()[layer_idx]);
                         std::unique_ptr<PerimeterDistancer> current_layer_distancer        = std::make_unique<PerimeterDistancer>(
                             to_unscaled_linesf(po->layers()[layer_idx]->lslices));
 
@@ -1420,44 +1503,228 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 
 }
 
+std::shared_ptr<const SeamPlacerImpl::MeshVisibility> SeamVisibilityCache::find(const Key &key)
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const auto &entry) { return entry.first == key; });
+  if (it == m_entries.end()) {
+    ++ m_misses;
+    return {};
+  }
+  ++ m_hits;
+  std::rotate(it, it + 1, m_entries.end());
+  return m_entries.back().second;
+}
+
+void SeamVisibilityCache::insert(const Key &key, std::shared_ptr<const SeamPlacerImpl::MeshVisibility> visibility)
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&key](const auto &entry) { return entry.first == key; }), m_entries.end());
+  m_entries.emplace_back(key, std::move(visibility));
+  if (m_entries.size() > m_max_entries)
+    m_entries.erase(m_entries.begin());
+}
+
+std::shared_ptr<const SeamPlacerImpl::ObjectCandidateValues> SeamVisibilityCache::find_candidates(const Key &key)
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  auto it = std::find_if(m_candidate_entries.begin(), m_candidate_entries.end(), [&key](const auto &entry) { return entry.first == key; });
+  if (it == m_candidate_entries.end())
+    return {};
+  std::rotate(it, it + 1, m_candidate_entries.end());
+  return m_candidate_entries.back().second;
+}
+
+void SeamVisibilityCache::insert_candidates(const Key &key, std::shared_ptr<const SeamPlacerImpl::ObjectCandidateValues> values)
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  m_candidate_entries.erase(std::remove_if(m_candidate_entries.begin(), m_candidate_entries.end(), [&key](const auto &entry) { return entry.first == key; }),
+                            m_candidate_entries.end());
+  m_candidate_entries.emplace_back(key, std::move(values));
+  if (m_candidate_entries.size() > m_max_entries)
+    m_candidate_entries.erase(m_candidate_entries.begin());
+}
+
+void SeamVisibilityCache::add_candidate_layers(size_t reused, size_t calculated)
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  m_reused_candidate_layers     += reused;
+  m_calculated_candidate_layers += calculated;
+}
+
+void SeamVisibilityCache::clear()
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_candidate_entries.clear();
+  m_hits   = 0;
+  m_misses = 0;
+  m_reused_candidate_layers     = 0;
+  m_calculated_candidate_layers = 0;
+}
+
+size_t SeamVisibilityCache::hits() const
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  return m_hits;
+}
+
+size_t SeamVisibilityCache::misses() const
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  return m_misses;
+}
+
+size_t SeamVisibilityCache::reused_candidate_layers() const
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  return m_reused_candidate_layers;
+}
+
+size_t SeamVisibilityCache::calculated_candidate_layers() const
+{
+  std::scoped_lock<std::mutex> lock(m_mutex);
+  return m_calculated_candidate_layers;
+}
+
 void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_canceled_func) {
   using namespace SeamPlacerImpl;
   m_seam_per_object.clear();
 
-  for (const PrintObject *po : print.objects()) {
+  auto uses_visibility = [](SeamPosition seam_position) {
+    return seam_position == spAligned || seam_position == spNearest || seam_position == spAlignedBack;
+  };
+
+  // The visibility of the objects is calculated upfront: The objects are raycasted in parallel, the objects sharing
+  // their geometry (copies) are raycasted once, and the objects with the geometry unchanged since the last export
+  // reuse the visibility cached by Print.
+  std::vector<const PrintObject*> objects(print.objects().begin(), print.objects().end());
+  std::vector<std::shared_ptr<const MeshVisibility>> objects_visibility(objects.size());
+  // The candidate values are cached under the key of the mesh visibility, thus the key is calculated for all the objects.
+  std::vector<SeamVisibilityCache::Key> keys(objects.size());
+  SeamVisibilityCache *cache = print.seam_visibility_cache();
+  {
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: mesh visibility: start";
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objects.size()), [&objects, &keys](tbb::blocked_range<size_t> r) {
+      for (size_t object_idx = r.begin(); object_idx < r.end(); ++object_idx)
+        keys[object_idx] = mesh_visibility_key(objects[object_idx], objects[object_idx]->config().seam_position.value);
+    });
+    // Index of the object, which computes the visibility of the other objects with the same key.
+    std::vector<size_t> source_object(objects.size(), size_t(-1));
+    std::vector<size_t> objects_to_compute;
+    for (size_t object_idx = 0; object_idx < objects.size(); ++object_idx) {
+      if (! uses_visibility(objects[object_idx]->config().seam_position.value))
+        continue;
+      if (auto it = std::find_if(objects_to_compute.begin(), objects_to_compute.end(), [&keys, object_idx](size_t idx) { return keys[idx] == keys[object_idx]; });
+          it != objects_to_compute.end())
+        source_object[object_idx] = *it;
+      else if (cache == nullptr || ! (objects_visibility[object_idx] = cache->find(keys[object_idx])))
+        objects_to_compute.emplace_back(object_idx);
+    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_to_compute.size()),
+                      [&objects, &objects_to_compute, &objects_visibility, &throw_if_canceled_func](tbb::blocked_range<size_t> r) {
+      for (size_t i = r.begin(); i < r.end(); ++i) {
+        const PrintObject *po = objects[objects_to_compute[i]];
+        objects_visibility[objects_to_compute[i]] = compute_mesh_visibility(po, throw_if_canceled_func, po->config().seam_position.value);
+      }
+    });
+    for (size_t object_idx : objects_to_compute)
+      if (cache != nullptr)
+        cache->insert(keys[object_idx], objects_visibility[object_idx]);
+    for (size_t object_idx = 0; object_idx < objects.size(); ++object_idx)
+      if (source_object[object_idx] != size_t(-1))
+        objects_visibility[object_idx] = objects_visibility[source_object[object_idx]];
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: mesh visibility: end, " << objects_to_compute.size() << " of " << objects.size() << " objects raycasted";
+  }
+
+  for (size_t object_idx = 0; object_idx < objects.size(); ++object_idx) {
+    const PrintObject *po = objects[object_idx];
     throw_if_canceled_func();
     SeamPosition configured_seam_preference = po->config().seam_position.value;
     SeamComparator comparator { configured_seam_preference };
+    const bool visibility = uses_visibility(configured_seam_preference);
 
+    // Candidate values of the layers of this export, the layers with unchanged seam candidates and slices
+    // take their values from the previous export.
+    auto candidate_values = std::make_shared<ObjectCandidateValues>();
+    std::vector<bool> layers_to_calculate;
     {
       GlobalModelInfo global_model_info { };
       gather_enforcers_blockers(global_model_info, po);
       throw_if_canceled_func();
-      if (configured_seam_preference == spAligned || configured_seam_preference == spNearest || configured_seam_preference == spAlignedBack) {
-        compute_global_occlusion(global_model_info, po, throw_if_canceled_func, configured_seam_preference);
-      }
-      throw_if_canceled_func();
       BOOST_LOG_TRIVIAL(debug)
           << "SeamPlacer: gather_seam_candidates: start";
       gather_seam_candidates(po, global_model_info);
       BOOST_LOG_TRIVIAL(debug)
           << "SeamPlacer: gather_seam_candidates: end";
       throw_if_canceled_func();
-      if (configured_seam_preference == spAligned || configured_seam_preference == spNearest || configured_seam_preference == spAlignedBack) {
+
+      std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+      candidate_values->layers.resize(layers.size());
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
+                        [po, &layers, &candidate_values, visibility](tbb::blocked_range<size_t> r) {
+                          for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx)
+                            candidate_values->layers[layer_idx].key = layer_candidates_key(po, layer_idx, layers[layer_idx].points, visibility);
+                        });
+      std::shared_ptr<const ObjectCandidateValues> cached_values = cache == nullptr ? nullptr : cache->find_candidates(keys[object_idx]);
+      layers_to_calculate.assign(layers.size(), true);
+      size_t num_reused_layers = 0;
+      for (size_t layer_idx = 0; cached_values && layer_idx < std::min(layers.size(), cached_values->layers.size()); ++layer_idx) {
+        const ObjectCandidateValues::Layer &cached_layer = cached_values->layers[layer_idx];
+        if (cached_layer.key != candidate_values->layers[layer_idx].key)
+          continue;
+        std::vector<SeamCandidate> &points = layers[layer_idx].points;
+        for (size_t point_idx = 0; point_idx < points.size(); ++point_idx) {
+          const CandidateValues &values       = cached_layer.values[point_idx];
+          points[point_idx].visibility        = values.visibility;
+          points[point_idx].overhang          = values.overhang;
+          points[point_idx].unsupported_dist  = values.unsupported_dist;
+          points[point_idx].embedded_distance = values.embedded_distance;
+        }
+        candidate_values->layers[layer_idx].values = cached_layer.values;
+        layers_to_calculate[layer_idx] = false;
+        ++num_reused_layers;
+      }
+      if (cache != nullptr)
+        cache->add_candidate_layers(num_reused_layers, layers.size() - num_reused_layers);
+      BOOST_LOG_TRIVIAL(debug)
+          << "SeamPlacer: " << num_reused_layers << " of " << layers.size() << " layers of seam candidates reused";
+
+      if (visibility && num_reused_layers < layers.size()) {
+        global_model_info.set_mesh_visibility(std::move(objects_visibility[object_idx]));
+        throw_if_canceled_func();
         BOOST_LOG_TRIVIAL(debug)
             << "SeamPlacer: calculate_candidates_visibility : start";
-        calculate_candidates_visibility(po, global_model_info);
+        calculate_candidates_visibility(po, global_model_info, layers_to_calculate);
         BOOST_LOG_TRIVIAL(debug)
             << "SeamPlacer: calculate_candidates_visibility : end";
       }
     } // destruction of global_model_info (large structure, no longer needed)
+    objects_visibility[object_idx].reset();
     throw_if_canceled_func();
     BOOST_LOG_TRIVIAL(debug)
         << "SeamPlacer: calculate_overhangs and layer embdedding : start";
-    calculate_overhangs_and_layer_embedding(po);
+    calculate_overhangs_and_layer_embedding(po, layers_to_calculate);
     BOOST_LOG_TRIVIAL(debug)
         << "SeamPlacer: calculate_overhangs and layer embdedding: end";
     throw_if_canceled_func();
+    if (cache != nullptr) {
+      const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
+                        [&layers, &candidate_values, &layers_to_calculate](tbb::blocked_range<size_t> r) {
+                          for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
+                            if (! layers_to_calculate[layer_idx])
+                              continue;
+                            std::vector<CandidateValues> &values = candidate_values->layers[layer_idx].values;
+                            values.reserve(layers[layer_idx].points.size());
+                            for (const SeamCandidate &point : layers[layer_idx].points)
+                              values.push_back({ point.visibility, point.overhang, point.unsupported_dist, point.embedded_distance });
+                          }
+                        });
+      cache->insert_candidates(keys[object_idx], std::move(candidate_values));
+    }
     if (configured_seam_preference != spNearest) { // For spNearest, the seam is picked in the place_seam method with actual nozzle position information
       BOOST_LOG_TRIVIAL(debug)
           << "SeamPlacer: pick_seam_point : start";
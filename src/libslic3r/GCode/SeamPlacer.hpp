@@ -1,10 +1,12 @@
 #ifndef libslic3r_SeamPlacer_hpp_
 #define libslic3r_SeamPlacer_hpp_
 
+#include <array>
 #include <limits>
 #include <optional>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <atomic>
 
 #include "libslic3r/libslic3r.h"
@@ -30,6 +32,8 @@ namespace SeamPlacerImpl {
 
 
 struct GlobalModelInfo;
+struct MeshVisibility;
+struct ObjectCandidateValues;
 struct SeamComparator;
 
 enum class EnforcedBlockedSeamPoint {
@@ -108,6 +112,46 @@ struct PrintObjectSeamData
   }
 };
 
+// Cache of the visibility of the object meshes, which is calculated by raycasting and which is the most expensive part
+// of SeamPlacer::init(). Owned by Print, thus kept over G-code exports. The visibility is keyed by a MD5 hash of the meshes,
+// of their transformations and of the seam position, thus a PrintObject keeps its visibility until its geometry changes
+// and copies of an object share it. Only the last max_entries results are kept. All methods are thread safe.
+// Under the same key, the cache keeps the visibility, overhang and embedding of the seam candidates of each layer.
+// These depend on the perimeters too, thus each layer is stored with a hash of its candidates and slices,
+// and the layers with changed perimeters are recalculated.
+class SeamVisibilityCache
+{
+public:
+  using Key = std::array<unsigned int, 4>;
+
+  explicit SeamVisibilityCache(size_t max_entries = 16) : m_max_entries(max_entries) {}
+
+  std::shared_ptr<const SeamPlacerImpl::MeshVisibility> find(const Key &key);
+  void insert(const Key &key, std::shared_ptr<const SeamPlacerImpl::MeshVisibility> visibility);
+
+  std::shared_ptr<const SeamPlacerImpl::ObjectCandidateValues> find_candidates(const Key &key);
+  void insert_candidates(const Key &key, std::shared_ptr<const SeamPlacerImpl::ObjectCandidateValues> values);
+  // Statistics of the layers of seam candidates, which were reused or calculated by SeamPlacer::init().
+  void add_candidate_layers(size_t reused, size_t calculated);
+
+  void clear();
+  size_t hits() const;
+  size_t misses() const;
+  size_t reused_candidate_layers() const;
+  size_t calculated_candidate_layers() const;
+
+private:
+  mutable std::mutex m_mutex;
+  // The most recently used entry is at the back.
+  std::vector<std::pair<Key, std::shared_ptr<const SeamPlacerImpl::MeshVisibility>>> m_entries;
+  std::vector<std::pair<Key, std::shared_ptr<const SeamPlacerImpl::ObjectCandidateValues>>> m_candidate_entries;
+  size_t m_max_entries;
+  size_t m_hits { 0 };
+  size_t m_misses { 0 };
+  size_t m_reused_candidate_layers { 0 };
+  size_t m_calculated_candidate_layers { 0 };
+};
+
 class SeamPlacer {
 public:
   // Number of samples generated on the mesh. There are sqr_rays_per_sample_point*sqr_rays_per_sample_point rays casted from each samples
@@ -146,9 +190,11 @@ public:
   void place_seam(const Layer *layer, ExtrusionLoop &loop, const Point &last_pos, float& overhang) const;
 private:
   void gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info);
+  // Only the layers with layers_to_calculate[layer_idx] set are calculated, the other layers were restored from SeamVisibilityCache.
   void calculate_candidates_visibility(const PrintObject *po,
-                                       const SeamPlacerImpl::GlobalModelInfo &global_model_info);
-  void calculate_overhangs_and_layer_embedding(const PrintObject *po);
+                                       const SeamPlacerImpl::GlobalModelInfo &global_model_info,
+                                       const std::vector<bool> &layers_to_calculate);
+  void calculate_overhangs_and_layer_embedding(const PrintObject *po, const std::vector<bool> &layers_to_calculate);
   void align_seam_points(const PrintObject *po, const SeamPlacerImpl::SeamComparator &comparator);
   std::vector<std::pair<size_t, size_t>> find_seam_string(const PrintObject *po,
                                                           std::pair<size_t, size_t> start_seam,
@@ -63,7 +63,7 @@ SpiralVase::SpiralPoint nearest_point_on_lines(SpiralVase::SpiralPoint
 }
 } // namespace SpiralVase
 
-std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
+GCodeLayerLines SpiralVase::process_layer(GCodeLayerLines &&gcode, bool last_layer)
 {
     /*  This post-processor relies on several assumptions:
         - all layers are processed through it, including those that are not supposed
@@ -76,8 +76,8 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     // If we're not going to modify G-code, just feed it to the reader
     // in order to update positions.
     if (! m_enabled) {
-        m_reader.parse_buffer(gcode);
-        return gcode;
+        m_reader.parse_lines(gcode, [](GCodeReader&, const GCodeReader::GCodeLine&) {});
+        return std::move(gcode);
     }
     
     // Get total XY length for this layer by summing all extrusion moves.
@@ -89,7 +89,7 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
         //FIXME Performance warning: This copies the GCodeConfig of the reader.
         GCodeReader r = m_reader;  // clone
         bool set_z = false;
-        r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
+        r.parse_lines(gcode, [&total_layer_length, &layer_height, &z, &set_z]
             (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
             if (line.cmd_is("G1")) {
                 if (line.extruding(reader)) {
@@ -127,7 +127,7 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
 
     float len = 0.f;
     SpiralVase::SpiralPoint last_point = previous_layer != NULL && previous_layer->size() >0? previous_layer->at(previous_layer->size()-1): SpiralVase::SpiralPoint(0,0);
-    m_reader.parse_buffer(gcode, [&new_gcode, &z, total_layer_length, layer_height, transition_in, &len, &current_layer, &previous_layer, &transition_gcode, transition_out, smooth_spiral, &max_xy_dist_for_smoothing, &last_point, starting_flowrate, finishing_flowrate]
+    m_reader.parse_lines(gcode, [&new_gcode, &z, total_layer_length, layer_height, transition_in, &len, &current_layer, &previous_layer, &transition_gcode, transition_out, smooth_spiral, &max_xy_dist_for_smoothing, &last_point, starting_flowrate, finishing_flowrate]
         (GCodeReader &reader, GCodeReader::GCodeLine line) {
         if (line.cmd_is("G1")) {
             // Orca: Filter out retractions at layer change
@@ -211,7 +211,7 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     delete m_previous_layer;
     m_previous_layer = current_layer;
     
-    return new_gcode + transition_gcode;
+    return GCodeLayerLines(new_gcode + transition_gcode);
 }
 
 }
@@ -3,6 +3,7 @@
 
 #include "../libslic3r.h"
 #include "../GCodeReader.hpp"
+#include "GCodeLayerLines.hpp"
 
 namespace Slic3r {
 
@@ -30,7 +31,8 @@ public:
     	m_enabled 		   = en;
     }
 
-    std::string process_layer(const std::string &gcode, bool last_layer);
+    // The moves are read from the parsed lines, the G-code written out is parsed.
+    GCodeLayerLines process_layer(GCodeLayerLines &&gcode, bool last_layer);
     void set_max_xy_smoothing(float max) {
         m_max_xy_smoothing = max;
     }
@@ -17,6 +17,14 @@
 #include <cassert>
 #include <limits>
 #include <algorithm>
+#include <chrono>
+#include <unordered_map>
+
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #include <libslic3r.h>
 
@@ -25,8 +33,15 @@ namespace Slic3r {
 const static bool g_wipe_into_objects = false;
 
 
-// Shortest hamilton path problem
-static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vector<float>>& wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id) 
+struct ExtruderOrderToEnd
+{
+    float                     cost;
+    std::vector<unsigned int> path;
+};
+
+// Shortest hamilton path problem, solved for each extruder the path may end with.
+// The paths are returned in the order of their last extruders in all_extruders, with the start extruder moved to the front.
+static std::vector<ExtruderOrderToEnd> solve_extruder_orders_to_each_end(const std::vector<std::vector<float>>& wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id)
 {
     bool add_start_extruder_flag = false;
 
@@ -65,30 +80,100 @@ static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vec
     }
 
     //get res
-    float cost = std::numeric_limits<float>::max();
-    int final_dst =0;
-    for (unsigned int dst = 0; dst < all_extruders.size(); ++dst) {
-        if (all_extruders[dst] != start_extruder_id && cost > cache[final_state][dst]) {
-            cost = cache[final_state][dst];
-            final_dst = dst;
-        }
-    }
+    auto get_path = [&](int final_dst) {
+        std::vector<unsigned int>path;
+        unsigned int curr_state = final_state;
+        int curr_point = final_dst;
+        while (curr_point != -1) {
+            path.emplace_back(all_extruders[curr_point]);
+            auto mid_point = prev[curr_state][curr_point];
+            curr_state -= (1 << curr_point);
+            curr_point = mid_point;
+        };
+
+        if (add_start_extruder_flag)
+            path.pop_back();
+
+        std::reverse(path.begin(), path.end());
+        return path;
+    };
+
+    std::vector<ExtruderOrderToEnd> out;
+    for (unsigned int dst = 0; dst < all_extruders.size(); ++dst)
+        if (all_extruders[dst] != start_extruder_id)
+            out.push_back({ cache[final_state][dst], get_path(dst) });
+    if (out.empty())
+        // Single extruder, which is the start extruder.
+        out.push_back({ cache[final_state][0], get_path(0) });
+    return out;
+}
 
-    std::vector<unsigned int>path;
-    unsigned int curr_state = final_state;
-    int curr_point = final_dst;
-    while (curr_point != -1) {
-        path.emplace_back(all_extruders[curr_point]);
-        auto mid_point = prev[curr_state][curr_point];
-        curr_state -= (1 << curr_point);
-        curr_point = mid_point;
+// Beam search of the orders ending with each extruder, for the layers with too many extruders for solve_extruder_orders_to_each_end().
+// At each step, only the beam_width cheapest partial orders ending with each extruder are extended.
+// Starts and ends the orders the same way as solve_extruder_orders_to_each_end().
+static std::vector<ExtruderOrderToEnd> beam_search_extruder_orders_to_each_end(const std::vector<std::vector<float>>& wipe_volumes, const std::vector<unsigned int> &all_extruders, std::optional<unsigned int> start_extruder_id, size_t beam_width)
+{
+    struct PartialOrder {
+        float                     cost;
+        // Bit mask of the indices of all_extruders in the path.
+        uint32_t                  used;
+        std::vector<unsigned int> path;
     };
+    const unsigned int first_extruder_id = start_extruder_id ? *start_extruder_id : all_extruders.front();
+    std::vector<PartialOrder> beam;
+    if (auto it = std::find(all_extruders.begin(), all_extruders.end(), first_extruder_id); it != all_extruders.end())
+        beam.push_back({ 0.f, uint32_t(1) << (it - all_extruders.begin()), { first_extruder_id } });
+    else
+        beam.push_back({ 0.f, 0, {} });
+
+    std::vector<PartialOrder> next;
+    while (beam.front().path.size() < all_extruders.size()) {
+        next.clear();
+        for (const PartialOrder &order : beam) {
+            const unsigned int last_extruder_id = order.path.empty() ? first_extruder_id : order.path.back();
+            for (size_t i = 0; i < all_extruders.size(); ++ i)
+                if (! (order.used >> i & 1)) {
+                    next.push_back({ order.cost + wipe_volumes[last_extruder_id][all_extruders[i]], order.used | (uint32_t(1) << i), order.path });
+                    next.back().path.emplace_back(all_extruders[i]);
+                }
+        }
+        // Ties are broken by the paths, thus the result does not depend on the sorting algorithm.
+        std::sort(next.begin(), next.end(), [](const PartialOrder &l, const PartialOrder &r) {
+            return l.path.back() < r.path.back() || (l.path.back() == r.path.back() && (l.cost < r.cost || (l.cost == r.cost && l.path < r.path)));
+        });
+        beam.clear();
+        for (size_t begin = 0; begin < next.size();) {
+            size_t end = begin;
+            for (; end < next.size() && next[end].path.back() == next[begin].path.back(); ++ end) ;
+            const size_t group_begin = beam.size();
+            for (size_t i = begin; i < end && beam.size() - group_begin < beam_width; ++ i)
+                // The same extruders in another order ending with the same extruder cannot be continued for less.
+                if (std::none_of(beam.begin() + group_begin, beam.end(), [&next, i](const PartialOrder &order) { return order.used == next[i].used; }))
+                    beam.emplace_back(std::move(next[i]));
+            begin = end;
+        }
+    }
 
-    if (add_start_extruder_flag)
-        path.pop_back();
+    // The cheapest order ending with each extruder is the first one of its group.
+    std::vector<ExtruderOrderToEnd> out;
+    for (size_t i = 0; i < beam.size(); ++ i)
+        if ((i == 0 || beam[i].path.back() != beam[i - 1].path.back()) && beam[i].path.back() != first_extruder_id)
+            out.push_back({ beam[i].cost, std::move(beam[i].path) });
+    if (out.empty())
+        // Single extruder, which is the start extruder.
+        out.push_back({ beam.front().cost, std::move(beam.front().path) });
+    return out;
+}
 
-    std::reverse(path.begin(), path.end());
-    return path;
+// Shortest hamilton path problem
+static std::vector<unsigned int> solve_extruder_order(const std::vector<std::vector<float>>& wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int> start_extruder_id) 
+{
+    std::vector<ExtruderOrderToEnd> orders = solve_extruder_orders_to_each_end(wipe_volumes, std::move(all_extruders), start_extruder_id);
+    size_t best = 0;
+    for (size_t i = 1; i < orders.size(); ++ i)
+        if (orders[best].cost > orders[i].cost)
+            best = i;
+    return std::move(orders[best].path);
 }
 
 std::vector<unsigned int> get_extruders_order(const std::vector<std::vector<float>> &wipe_volumes, std::vector<unsigned int> all_extruders, std::optional<unsigned int>start_extruder_id)
@@ -208,6 +293,8 @@ ToolOrdering::ToolOrdering(const PrintObject &object, unsigned int first_extrude
     m_is_BBL_printer = object.print()->is_BBL_printer();
     m_print_full_config = &object.print()->full_print_config();
     m_print_object_ptr = &object;
+    m_extruder_order_max_extruders = object.print()->extruder_order_max_extruders();
+    m_extruder_order_max_states = object.print()->extruder_order_max_states();
     if (object.layers().empty())
         return;
 
@@ -253,6 +340,8 @@ ToolOrdering::ToolOrdering(const Print &print, unsigned int first_extruder, bool
     m_is_BBL_printer = print.is_BBL_printer();
     m_print_full_config = &print.full_print_config();
     m_print_config_ptr = &print.config();
+    m_extruder_order_max_extruders = print.extruder_order_max_extruders();
+    m_extruder_order_max_states = print.extruder_order_max_states();
 
     // Initialize the print layers for all objects and all layers.
     coordf_t object_bottom_z = 0.;
@@ -884,11 +973,14 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
         return false;
     };
 
+    // Layers, which keep their order: The first layer and the layers with a custom sequence.
+    std::vector<bool> fixed_order(m_layer_tools.size(), false);
     std::optional<unsigned int>current_extruder_id;
     for (int i = 0; i < m_layer_tools.size(); ++i) {
         LayerTools& lt = m_layer_tools[i];
         if (lt.extruders.empty())
             continue;
+        fixed_order[i] = i == 0;
 
         std::vector<int> custom_extruder_seq;
         if (get_custom_seq(i, custom_extruder_seq) && !custom_extruder_seq.empty()) {
@@ -903,6 +995,7 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
             assert(lt.extruders.size() == unsign_custom_extruder_seq.size());
             lt.extruders = unsign_custom_extruder_seq;
             current_extruder_id = lt.extruders.back();
+            fixed_order[i] = true;
             continue;
         }
 
@@ -928,6 +1021,175 @@ void ToolOrdering::reorder_extruders_for_minimum_flush_volume()
         }
         current_extruder_id = lt.extruders.back();
     }
+
+    this->optimize_extruder_order_over_layers(wipe_volumes, fixed_order);
+}
+
+// Flush volume of printing the extruders in sequence after start_extruder_id.
+static float extruder_sequence_flush_volume(const std::vector<std::vector<float>> &wipe_volumes, std::optional<unsigned int> start_extruder_id, const std::vector<unsigned int> &extruders)
+{
+    float volume = 0.f;
+    for (unsigned int extruder : extruders) {
+        if (start_extruder_id && *start_extruder_id != extruder)
+            volume += wipe_volumes[*start_extruder_id][extruder];
+        start_extruder_id = extruder;
+    }
+    return volume;
+}
+
+// Width of the beam search of the orders of the layers, which are not solved exactly.
+static constexpr size_t EXTRUDER_ORDER_BEAM_WIDTH = 8;
+
+// The layer by layer ordering picks the cheapest order of a layer given the extruder the previous layer ended with,
+// though a more expensive order of a layer may end with an extruder, which is cheaper to continue with.
+// Dynamic programming over the layers with the last extruder as the state finds the order with the minimum total flush volume:
+// The cost of a layer only depends on the extruder it starts with and on the extruder it ends with.
+void ToolOrdering::optimize_extruder_order_over_layers(const std::vector<std::vector<float>> &wipe_volumes, const std::vector<bool> &fixed_order)
+{
+    if (m_extruder_order_max_extruders <= 0)
+        return;
+    const size_t number_of_extruders = wipe_volumes.size();
+    std::vector<size_t> layers;
+    for (size_t i = 0; i < m_layer_tools.size(); ++ i)
+        if (const std::vector<unsigned int> &extruders = m_layer_tools[i].extruders; ! extruders.empty()) {
+            if (std::any_of(extruders.begin(), extruders.end(), [number_of_extruders](unsigned int extruder) { return extruder >= number_of_extruders || extruder >= 32; }))
+                return;
+            layers.emplace_back(i);
+        }
+    if (layers.empty())
+        return;
+
+    auto keeps_order = [&fixed_order](size_t i) { return bool(fixed_order[i]); };
+
+    FlushVolumeStats stats;
+    {
+        std::optional<unsigned int> last_extruder_id;
+        for (size_t i : layers) {
+            stats.greedy_flush_volume += extruder_sequence_flush_volume(wipe_volumes, last_extruder_id, m_layer_tools[i].extruders);
+            last_extruder_id = m_layer_tools[i].extruders.back();
+        }
+    }
+    stats.optimized_flush_volume = stats.greedy_flush_volume;
+
+    // The orders of a layer only depend on its extruders and on the extruder it starts with, thus they are shared by the layers
+    // printing the same extruders. A layer may start with any extruder the previous layer may end with.
+    auto order_key = [](const std::vector<unsigned int> &extruders, std::optional<unsigned int> start_extruder_id) {
+        uint64_t key = start_extruder_id ? uint64_t(*start_extruder_id + 1) << 32 : 0;
+        for (unsigned int extruder : extruders)
+            key |= uint64_t(1) << extruder;
+        return key;
+    };
+    std::unordered_map<uint64_t, size_t>                                          order_key_to_idx;
+    std::vector<std::pair<const std::vector<unsigned int>*, std::optional<unsigned int>>> order_inputs;
+    {
+        std::vector<std::optional<unsigned int>> start_extruders { std::nullopt };
+        for (size_t i : layers) {
+            const std::vector<unsigned int> &extruders = m_layer_tools[i].extruders;
+            if (keeps_order(i)) {
+                start_extruders = { extruders.back() };
+                continue;
+            }
+            for (std::optional<unsigned int> start_extruder_id : start_extruders)
+                if (order_key_to_idx.emplace(order_key(extruders, start_extruder_id), order_inputs.size()).second)
+                    order_inputs.emplace_back(&extruders, start_extruder_id);
+            start_extruders.assign(extruders.begin(), extruders.end());
+        }
+    }
+
+    // The Held-Karp algorithm evaluates n^2 * 2^n states of a layer with n extruders. The layers are solved exactly in their order
+    // while the budget of the evaluated states lasts and up to the maximum number of extruders, the others by a beam search
+    // of polynomial time. The budget bounds the time of the optimization independently of the speed of the computer
+    // and of the number of threads, thus the result only depends on the print.
+    std::vector<bool> solve_exactly(order_inputs.size(), false);
+    {
+        size_t states_left = m_extruder_order_max_states;
+        for (size_t idx = 0; idx < order_inputs.size(); ++ idx) {
+            const std::vector<unsigned int> &extruders = *order_inputs[idx].first;
+            const std::optional<unsigned int> start_extruder_id = order_inputs[idx].second;
+            const size_t n = extruders.size() + (start_extruder_id && std::find(extruders.begin(), extruders.end(), *start_extruder_id) == extruders.end() ? 1 : 0);
+            const size_t states = n <= std::min(size_t(m_extruder_order_max_extruders), size_t(24)) ? (size_t(1) << n) * n * n : std::numeric_limits<size_t>::max();
+            if (states <= states_left) {
+                solve_exactly[idx] = true;
+                states_left -= states;
+                ++ stats.exact_orders;
+            } else
+                ++ stats.beam_search_orders;
+        }
+    }
+
+    // Calculate the orders on all cores. As the layer by layer order is one of the candidates of each layer solved exactly
+    // and the layer by layer order is kept unless improved, the result is never worse than ordering layer by layer.
+    const auto                                   t_start = std::chrono::steady_clock::now();
+    std::vector<std::vector<ExtruderOrderToEnd>> orders(order_inputs.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, order_inputs.size(), 1), [&wipe_volumes, &order_inputs, &solve_exactly, &orders](const tbb::blocked_range<size_t> &range) {
+        for (size_t idx = range.begin(); idx < range.end(); ++ idx)
+            orders[idx] = solve_exactly[idx] ?
+                solve_extruder_orders_to_each_end(wipe_volumes, *order_inputs[idx].first, order_inputs[idx].second) :
+                beam_search_extruder_orders_to_each_end(wipe_volumes, *order_inputs[idx].first, order_inputs[idx].second, EXTRUDER_ORDER_BEAM_WIDTH);
+    });
+
+    struct State {
+        float                            cost  { std::numeric_limits<float>::max() };
+        // Last extruder of the previous layer, -1 for none.
+        int                              prev  { -1 };
+        const std::vector<unsigned int> *order { nullptr };
+    };
+    std::vector<std::vector<State>> states(layers.size(), std::vector<State>(number_of_extruders));
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx) {
+        const std::vector<unsigned int> &extruders = m_layer_tools[layers[layer_idx]].extruders;
+        std::vector<State>              &out       = states[layer_idx];
+        auto relax = [&out](float cost, int prev, const std::vector<unsigned int> &order) {
+            State &state = out[order.back()];
+            if (state.cost > cost)
+                state = { cost, prev, &order };
+        };
+        auto extend = [&](std::optional<unsigned int> start_extruder_id, float cost) {
+            int prev = start_extruder_id ? int(*start_extruder_id) : -1;
+            const std::vector<ExtruderOrderToEnd> *layer_orders = keeps_order(layers[layer_idx]) ? nullptr :
+                &orders[order_key_to_idx.at(order_key(extruders, start_extruder_id))];
+            if (layer_orders == nullptr || layer_orders->empty())
+                // Fixed order.
+                relax(cost + extruder_sequence_flush_volume(wipe_volumes, start_extruder_id, extruders), prev, extruders);
+            else
+                for (const ExtruderOrderToEnd &order : *layer_orders)
+                    relax(cost + order.cost, prev, order.path);
+        };
+        if (layer_idx == 0)
+            extend(std::nullopt, 0.f);
+        else
+            for (unsigned int extruder = 0; extruder < number_of_extruders; ++ extruder)
+                if (const State &state = states[layer_idx - 1][extruder]; state.order != nullptr)
+                    extend(extruder, state.cost);
+    }
+
+    const std::vector<State> &last = states.back();
+    int best = int(std::min_element(last.begin(), last.end(), [](const State &l, const State &r) { return l.cost < r.cost; }) - last.begin());
+    std::vector<std::vector<unsigned int>> optimized(layers.size());
+    for (size_t layer_idx = layers.size(); layer_idx > 0; -- layer_idx) {
+        const State &state = states[layer_idx - 1][best];
+        optimized[layer_idx - 1] = *state.order;
+        best = state.prev;
+    }
+
+    float                       optimized_flush_volume = 0.f;
+    std::optional<unsigned int> last_extruder_id;
+    for (const std::vector<unsigned int> &extruders : optimized) {
+        optimized_flush_volume += extruder_sequence_flush_volume(wipe_volumes, last_extruder_id, extruders);
+        last_extruder_id = extruders.back();
+    }
+    // Keep the layer by layer order unless it is improved, the costs are summed up in a different order.
+    if (optimized_flush_volume < stats.greedy_flush_volume - EPSILON) {
+        for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx)
+            m_layer_tools[layers[layer_idx]].extruders = std::move(optimized[layer_idx]);
+        stats.optimized_flush_volume = optimized_flush_volume;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << boost::format("Extruder order over %1% layers: flush volume %2% layer by layer, %3% optimized in %4% ms, "
+                                             "%5% orders solved exactly, %6% orders by beam search")
+        % layers.size() % stats.greedy_flush_volume % stats.optimized_flush_volume
+        % std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_start).count()
+        % stats.exact_orders % stats.beam_search_orders;
+    m_flush_volume_stats = stats;
 }
 
 // Layers are marked for infinite skirt aka draft shield. Not all the layers have to be printed.
@@ -1348,27 +1610,32 @@ void WipingExtrusions::ensure_perimeters_infills_order(const Print& print)
     }
 }
 
-// Following function is called from GCode::process_layer and returns pointer to vector with information about which extruders should be used for given copy of this entity.
-// If this extrusion does not have any override, nullptr is returned.
-// Otherwise it modifies the vector in place and changes all -1 to correct_extruder_id (at the time the overrides were created, correct extruders were not known,
-// so -1 was used as "print as usual").
+// Following function is called from GCode::prepare_extruder_overrides for each extrusion of a layer before the layer is grouped by extruders.
+// If this extrusion has any override, it modifies the vector of overrides in place and changes all -1 to correct_extruder_id (at the time the overrides
+// were created, correct extruders were not known, so -1 was used as "print as usual").
 // The resulting vector therefore keeps track of which extrusions are the ones that were overridden and which were not. If the extruder used is overridden,
 // its number is saved as is (zero-based index). Regular extrusions are saved as -number-1 (unfortunately there is no negative zero).
-const WipingExtrusions::ExtruderPerCopy* WipingExtrusions::get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies)
+void WipingExtrusions::prepare_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies)
 {
-	ExtruderPerCopy *overrides = nullptr;
     auto entity_map_it = entity_map.find(std::make_tuple(entity, object));
     if (entity_map_it != entity_map.end()) {
-        overrides = &entity_map_it->second;
-    	overrides->resize(num_of_copies, -1);
+        ExtruderPerCopy &overrides = entity_map_it->second;
+    	overrides.resize(num_of_copies, -1);
 	    // Each -1 now means "print as usual" - we will replace it with actual extruder id (shifted it so we don't lose that information):
-	    std::replace(overrides->begin(), overrides->end(), -1, -correct_extruder_id-1);
+	    std::replace(overrides.begin(), overrides.end(), -1, -correct_extruder_id-1);
 	}
-    return overrides;
+}
+
+// Returns pointer to vector with information about which extruders should be used for given copy of this entity,
+// as prepared by prepare_extruder_overrides(). If this extrusion does not have any override, nullptr is returned.
+const WipingExtrusions::ExtruderPerCopy* WipingExtrusions::get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object) const
+{
+    auto entity_map_it = entity_map.find(std::make_tuple(entity, object));
+    return entity_map_it == entity_map.end() ? nullptr : &entity_map_it->second;
 }
 
 // BBS
-int WipingExtrusions::get_support_extruder_overrides(const PrintObject* object)
+int WipingExtrusions::get_support_extruder_overrides(const PrintObject* object) const
 {
     auto iter = support_map.find(object);
     if (iter != support_map.end())
@@ -1377,7 +1644,7 @@ int WipingExtrusions::get_support_extruder_overrides(const PrintObject* object)
     return -1;
 }
 
-int WipingExtrusions::get_support_interface_extruder_overrides(const PrintObject* object)
+int WipingExtrusions::get_support_interface_extruder_overrides(const PrintObject* object) const
 {
     auto iter = support_intf_map.find(object);
     if (iter != support_intf_map.end())
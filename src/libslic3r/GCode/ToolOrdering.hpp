@@ -5,6 +5,7 @@
 
 #include "../libslic3r.h"
 
+#include <optional>
 #include <utility>
 
 #include <boost/container/small_vector.hpp>
@@ -30,10 +31,12 @@ public:
     // When allocating extruder overrides of an object's ExtrusionEntity, overrides for maximum 3 copies are allocated in place.
     typedef boost::container::small_vector<int32_t, 3> ExtruderPerCopy;
 
-    // This is called from GCode::process_layer - see implementation for further comments:
-    const ExtruderPerCopy* get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies);
-    int get_support_extruder_overrides(const PrintObject* object);
-    int get_support_interface_extruder_overrides(const PrintObject* object);
+    // This is called serially from GCode::prepare_extruder_overrides() before the layers are grouped by extruders - see implementation for further comments:
+    void prepare_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object, int correct_extruder_id, size_t num_of_copies);
+    // Returns the overrides prepared by prepare_extruder_overrides(). Thread safe, called by GCode::group_extrusions_by_extruder() for several layers in parallel.
+    const ExtruderPerCopy* get_extruder_overrides(const ExtrusionEntity* entity, const PrintObject* object) const;
+    int get_support_extruder_overrides(const PrintObject* object) const;
+    int get_support_interface_extruder_overrides(const PrintObject* object) const;
 
     // This function goes through all infill entities, decides which ones will be used for wiping and
     // marks them by the extruder id. Returns volume that remains to be wiped on the wipe tower:
@@ -137,6 +140,7 @@ public:
         m_wiping_extrusions.set_layer_tools_ptr(this);
         return m_wiping_extrusions;
     }
+    const WipingExtrusions& wiping_extrusions() const { return m_wiping_extrusions; }
 
 private:
     // This object holds list of extrusion that will be used for extruder wiping
@@ -187,6 +191,26 @@ public:
     std::vector<LayerTools>& layer_tools() { return m_layer_tools; }
     bool 				has_wipe_tower() const { return ! m_layer_tools.empty() && m_first_printing_extruder != (unsigned int)-1 && m_layer_tools.front().has_wipe_tower; }
 
+    // Total flush volume of the extruders ordered layer by layer and of the extruders ordered over all the layers.
+    struct FlushVolumeStats {
+        float greedy_flush_volume    { 0.f };
+        float optimized_flush_volume { 0.f };
+        // Number of the orders of the layers solved exactly and by the beam search, which is used for the layers printing
+        // more extruders than Print::extruder_order_max_extruders() and when the budget Print::extruder_order_max_states() runs out.
+        size_t exact_orders          { 0 };
+        size_t beam_search_orders    { 0 };
+    };
+    // Set if the extruder order was optimized over all the layers, see Print::extruder_order_max_extruders().
+    const std::optional<FlushVolumeStats>& flush_volume_stats() const { return m_flush_volume_stats; }
+
+    void                set_extruder_order_max_extruders(int max_extruders) { m_extruder_order_max_extruders = max_extruders; }
+    void                set_extruder_order_max_states(size_t max_states) { m_extruder_order_max_states = max_states; }
+    // Reorder the extruders of the layer_tools() ordered layer by layer for the least flush volume over all the layers,
+    // keeping the order of the fixed_order layers. The orders of the layers printing up to the maximum number of extruders
+    // are solved exactly while the budget of the evaluated states lasts, the others by a beam search.
+    // Does nothing if the maximum number of extruders is zero.
+    void                optimize_extruder_order_over_layers(const std::vector<std::vector<float>> &wipe_volumes, const std::vector<bool> &fixed_order);
+
 private:
     void				initialize_layers(std::vector<coordf_t> &zs);
     void 				collect_extruders(const PrintObject &object, const std::vector<std::pair<double, unsigned int>> &per_layer_extruder_switches);
@@ -214,6 +238,11 @@ private:
     const PrintConfig*         m_print_config_ptr = nullptr;
     const PrintObject*         m_print_object_ptr = nullptr;
     bool                       m_is_BBL_printer = false;
+    // Maximum number of extruders of a layer solved exactly by optimize_extruder_order_over_layers(), zero to order the extruders layer by layer only.
+    int                        m_extruder_order_max_extruders = 0;
+    // Budget of the states evaluated by optimize_extruder_order_over_layers() solving the orders exactly.
+    size_t                     m_extruder_order_max_states = 0;
+    std::optional<FlushVolumeStats> m_flush_volume_stats;
 };
 
 } // namespace SLic3r
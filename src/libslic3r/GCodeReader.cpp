@@ -1,12 +1,16 @@
 #include "GCodeReader.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/format.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <thread>
 #include "Utils.hpp"
 
 #include "LocalesUtils.hpp"
@@ -14,6 +18,18 @@
 #include <Shiny/Shiny.h>
 #include <fast_float/fast_float.h>
 
+// See the comment in GCode.cpp on the TBB versions.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 void GCodeReader::apply_config(const GCodeConfig &config)
@@ -27,6 +43,19 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
 }
 
 const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+{
+    const char *c = tokenize_line(ptr, end, gline, command);
+
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
+
+    if (m_verbose)
+        std::cout << gline.m_raw << std::endl;
+
+    return c;
+}
+
+const char* GCodeReader::tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
     PROFILE_FUNC();
 
@@ -82,9 +111,6 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
@@ -101,9 +127,6 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 	if (*c == '\n')
 		++ c;
 
-    if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
-
     return c;
 }
 
@@ -178,6 +201,14 @@ bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLine
     return true;
 }
 
+const char* GCodeReader::skip_line_number(const char *begin)
+{
+    begin = skip_whitespaces(begin);
+    if (std::toupper(*begin) == 'N')
+        begin = skip_word(begin);
+    return skip_whitespaces(begin);
+}
+
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
@@ -185,13 +216,7 @@ bool GCodeReader::parse_file_internal(const std::string &filename, ParseLineCall
     return this->parse_file_raw_internal(filename, 
         [this, &gline, parse_line_callback](const char *begin, const char *end) {
             gline.reset();
-
-            const char* begin_new = begin;
-            begin_new = skip_whitespaces(begin_new);
-            if (std::toupper(*begin_new) == 'N')
-                begin_new = skip_word(begin_new);
-            begin_new = skip_whitespaces(begin_new);
-            this->parse_line(begin_new, end, gline, parse_line_callback);
+            this->parse_line(skip_line_number(begin), end, gline, parse_line_callback);
         }, 
         line_end_callback);
 }
@@ -215,6 +240,143 @@ bool GCodeReader::parse_file(const std::string &file, callback_t callback, std::
     return ret;
 }
 
+// Is the line [begin, end) without its line end a layer change comment or a G0 / G1 move with a Z word?
+static bool is_layer_change(const char *begin, const char *end)
+{
+    auto skip_whitespaces = [end](const char *c) { for (; c != end && (*c == ' ' || *c == '\t'); ++ c); return c; };
+    auto skip_word        = [end](const char *c) { for (; c != end && *c != ' ' && *c != '\t' && *c != ';'; ++ c); return c; };
+    const char *c = skip_whitespaces(begin);
+    if (c != end && std::toupper(*c) == 'N')
+        // Skip the line number.
+        c = skip_whitespaces(skip_word(c));
+    if (c == end)
+        return false;
+    if (*c == ';') {
+        // ";LAYER_CHANGE" or "; CHANGE_LAYER", see GCodeProcessor::reserved_tag(ETags::Layer_Change).
+        const char            *comment = skip_whitespaces(c + 1);
+        const std::string_view tag(comment, std::min<size_t>(end - comment, 12));
+        return tag == "LAYER_CHANGE" || tag == "CHANGE_LAYER";
+    }
+    const char *cmd_end = skip_word(c);
+    if (cmd_end - c != 2 || std::toupper(c[0]) != 'G' || (c[1] != '0' && c[1] != '1'))
+        return false;
+    for (c = skip_whitespaces(cmd_end); c != end && *c != ';'; c = skip_whitespaces(skip_word(c)))
+        if (std::toupper(*c) == 'Z')
+            return true;
+    return false;
+}
+
+bool GCodeReader::parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends, size_t chunk_size)
+{
+    boost::iostreams::mapped_file_source mapped_file;
+    try {
+        mapped_file.open(file);
+    } catch (const std::exception &err) {
+        // Empty files cannot be memory mapped.
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": failed to map %1%, reason = %2%, parsing it sequentially") % file % err.what();
+        return this->parse_file(file, callback, lines_ends);
+    }
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file %1%") % file.c_str();
+    lines_ends.clear();
+
+    // Lines of a chunk of the G-code, tokenized in parallel with the other chunks.
+    struct Chunk {
+        std::vector<GCodeLine> lines;
+        // Positions of the line ends in the file.
+        std::vector<size_t>    lines_ends;
+    };
+    chunk_size = std::max<size_t>(chunk_size, 1);
+
+    const char *file_begin = mapped_file.data();
+    const char *file_end   = file_begin + mapped_file.size();
+    const char *chunk_end  = file_begin;
+    m_parsing = true;
+    // m_parsing is only accessed by the serial process_chunk filter, which signals cut_chunk running on another thread to stop.
+    std::atomic<bool> stop { false };
+
+    const auto cut_chunk = tbb::make_filter<void, std::pair<const char*, const char*>>(slic3r_tbb_filtermode::serial_in_order,
+        [&stop, &chunk_end, file_end, chunk_size](tbb::flow_control &fc) -> std::pair<const char*, const char*> {
+            if (chunk_end == file_end || stop) {
+                fc.stop();
+                return {};
+            }
+            const char *begin = chunk_end;
+            const char *end   = begin + std::min(chunk_size, size_t(file_end - begin));
+            // Extend the chunk up to the end of the line containing its requested end.
+            end = std::find(end, file_end, '\n');
+            end = end == file_end ? end : end + 1;
+            // Extend the chunk further up to the next layer change, which starts the next chunk.
+            while (end != file_end) {
+                const char *line_end = std::find(end, file_end, '\n');
+                const char *eol      = line_end;
+                for (; eol != end && *(eol - 1) == '\r'; -- eol);
+                if (is_layer_change(end, eol))
+                    break;
+                end = line_end == file_end ? line_end : line_end + 1;
+            }
+            chunk_end = end;
+            return { begin, chunk_end };
+        });
+    const auto tokenize_chunk = tbb::make_filter<std::pair<const char*, const char*>, Chunk>(slic3r_tbb_filtermode::parallel,
+        [file_begin, file_end](std::pair<const char*, const char*> range) -> Chunk {
+            Chunk       chunk;
+            std::string last_line;
+            for (const char *it = range.first; it != range.second;) {
+                const char *it_end = it;
+                for (; it_end != range.second && *it_end != '\r' && *it_end != '\n'; ++ it_end);
+                const char *begin = it;
+                const char *end   = it_end;
+                if (it_end == file_end) {
+                    // The last line of the file is not terminated, copy it to have it zero terminated.
+                    last_line.assign(it, it_end);
+                    begin = last_line.c_str();
+                    end   = begin + last_line.size();
+                }
+                GCodeLine                           &gline = chunk.lines.emplace_back();
+                std::pair<const char*, const char*>  command;
+                tokenize_line(skip_line_number(begin), end, gline, command);
+                // Skip EOL.
+                it = it_end;
+                if (it != range.second && *it == '\r')
+                    ++ it;
+                if (it != range.second && *it == '\n')
+                    chunk.lines_ends.emplace_back(size_t(++ it - file_begin));
+            }
+            return chunk;
+        });
+    // The chunks are processed in the order of the file, each of them starting from the reader state (position, relative E)
+    // and the state of the callback carried in from the previous chunk.
+    const auto process_chunk = tbb::make_filter<Chunk, void>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &callback, &lines_ends, &stop](Chunk chunk) {
+            if (! m_parsing)
+                return;
+            lines_ends.insert(lines_ends.end(), chunk.lines_ends.begin(), chunk.lines_ends.end());
+            for (GCodeLine &gline : chunk.lines) {
+                std::pair<const char*, const char*> command;
+                command.first  = skip_whitespaces(gline.m_raw.c_str());
+                command.second = skip_word(command.first);
+                if (gline.has(E) && m_config.use_relative_e_distances)
+                    m_position[E] = 0;
+                if (m_verbose)
+                    std::cout << gline.m_raw << std::endl;
+                callback(*this, gline);
+                update_coordinates(gline, command);
+                if (! m_parsing) {
+                    // The callback wishes to exit.
+                    stop = true;
+                    break;
+                }
+            }
+        });
+
+    // Limit the number of chunks in flight to limit the memory held by the tokenized lines.
+    tbb::parallel_pipeline(2 * std::max<size_t>(1, std::thread::hardware_concurrency()), cut_chunk & tokenize_chunk & process_chunk);
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  finished parse_file %1%") % file.c_str();
+    return true;
+}
+
 bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_t line_callback)
 {
     return this->parse_file_raw_internal(filename,
@@ -8,6 +8,7 @@
 #include <string>
 #include <string_view>
 #include "PrintConfig.hpp"
+#include "GCode/GCodeLayerLines.hpp"
 
 namespace Slic3r {
 
@@ -107,9 +108,13 @@ public:
 
     template<typename Callback>
     void parse_buffer(const std::string &buffer, Callback callback)
+        { this->parse_buffer(buffer.c_str(), buffer.c_str() + buffer.size(), callback); }
+
+    // Same as above for a null terminated buffer [ptr, end).
+    template<typename Callback>
+    void parse_buffer(const char *ptr, const char *end, Callback callback)
     {
-        const char *ptr = buffer.c_str();
-        const char *end = ptr + buffer.size();
+        assert(*end == 0);
         GCodeLine gline;
         m_parsing = true;
         while (m_parsing && *ptr != 0) {
@@ -121,6 +126,47 @@ public:
     void parse_buffer(const std::string &buffer)
         { this->parse_buffer(buffer, [](GCodeReader&, const GCodeReader::GCodeLine&){}); }
 
+    // Same as parse_buffer(lines.text(), callback), the canonical moves are taken over from GCodeLayerLines without tokenizing them again.
+    template<typename Callback>
+    void parse_lines(const GCodeLayerLines &lines, Callback callback)
+        { this->parse_lines(lines, 0, lines.size(), callback); }
+
+    // Same as above for the lines [first_line, last_line).
+    template<typename Callback>
+    void parse_lines(const GCodeLayerLines &lines, size_t first_line, size_t last_line, Callback &callback)
+    {
+        static constexpr Axis axes[GCodeLayerLines::NumAxes] { X, Y, Z, E, F, I, J };
+        const char *end = lines.text().c_str() + lines.text().size();
+        GCodeLine gline;
+        m_parsing = true;
+        for (size_t line_idx = first_line; m_parsing && line_idx < last_line; ++ line_idx) {
+            const GCodeLayerLines::Line &line = lines[line_idx];
+            if (line.canonical) {
+                gline.reset();
+                const std::string_view raw = lines.line(line_idx);
+                gline.m_raw.assign(raw.data(), raw.size());
+                for (size_t axis = 0; axis < GCodeLayerLines::NumAxes; ++ axis)
+                    if (line.has(GCodeLayerLines::Axis(axis))) {
+                        gline.m_axis[axes[axis]] = line.value(GCodeLayerLines::Axis(axis));
+                        gline.m_mask |= 1 << int(axes[axis]);
+                    }
+                if (gline.has(E) && m_config.use_relative_e_distances)
+                    m_position[E] = 0;
+                callback(*this, gline);
+                // All canonical moves update the position, see update_coordinates().
+                for (Axis axis : axes)
+                    if (gline.has(axis))
+                        m_position[axis] = gline.value(axis);
+            } else {
+                // Tokenize the other lines, a line of GCodeLayerLines may hold multiple lines separated by '\r'.
+                for (const char *ptr = lines.text().c_str() + line.begin, *line_end = lines.text().c_str() + line.end; m_parsing && ptr < line_end && *ptr != 0;) {
+                    gline.reset();
+                    ptr = this->parse_line(ptr, end, gline, callback);
+                }
+            }
+        }
+    }
+
     template<typename Callback>
     const char* parse_line(const char *ptr, const char *end, GCodeLine &gline, Callback &callback)
     {
@@ -140,6 +186,13 @@ public:
     // Collect positions of line ends in the binary G-code to be used by the G-code viewer when memory mapping and displaying section of G-code
     // as an overlay in the 3D scene.
     bool parse_file(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
+    // Same as parse_file(file, callback, lines_ends), but the file is memory mapped and cut into chunks at layer changes
+    // (";LAYER_CHANGE" / "; CHANGE_LAYER" comments or G0 / G1 moves with a Z word), which are tokenized in parallel.
+    // The chunks are processed serially in the order of the file, each starting from the reader state (position, relative E)
+    // carried in from the previous chunk, thus the callback sees exactly what it sees with parse_file().
+    // Falls back to parse_file() if the file could not be memory mapped.
+    // chunk_size is the size of a chunk before it is extended up to the next layer change.
+    bool parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends, size_t chunk_size = 4 * 1024 * 1024);
     // Just read the G-code file line by line, calls callback (const char *begin, const char *end). Returns false if reading the file failed.
     bool parse_file_raw(const std::string &file, raw_line_callback_t callback);
 
@@ -169,6 +222,9 @@ private:
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
     const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Fills in the axes and the raw string of gline, does not touch the reader state, thus it may be called from multiple threads.
+    static const char* tokenize_line(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    static const char* skip_line_number(const char *begin);
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
 
     static bool         is_whitespace(char c)           { return c == ' ' || c == '\t'; }
@@ -113,27 +113,30 @@ std::string GCodeWriter::set_temperature(unsigned int temperature, GCodeFlavor f
             comment = "set nozzle temperature";
     }
 
-    std::ostringstream gcode;
-    gcode << code << " ";
+    // The comment may be of any length, thus the line is concatenated instead of using GCodeFormatter.
+    std::string gcode = code;
     if (flavor == gcfMach3 || flavor == gcfMachinekit) {
-        gcode << "P";
+        gcode += " P";
     } else {
-        gcode << "S";
+        gcode += " S";
     }
-    gcode << temperature;
+    gcode += std::to_string(temperature);
     if (tool != -1) {
         if (flavor == gcfRepRapFirmware) {
-            gcode << " P" << tool;
+            gcode += " P";
         } else {
-            gcode << " T" << tool;
+            gcode += " T";
         }
+        gcode += std::to_string(tool);
     }
-    gcode << " ; " << comment << "\n";
+    gcode += " ; ";
+    gcode += comment;
+    gcode += "\n";
 
     if ((flavor == gcfTeacup || flavor == gcfRepRapFirmware) && wait)
-        gcode << "M116 ; wait for temperature to be reached\n";
+        gcode += "M116 ; wait for temperature to be reached\n";
 
-    return gcode.str();
+    return gcode;
 }
 
 std::string GCodeWriter::set_temperature(unsigned int temperature, bool wait, int tool) const
@@ -153,43 +156,28 @@ std::string GCodeWriter::set_bed_temperature(int temperature, bool wait)
     m_last_bed_temperature = temperature;
     m_last_bed_temperature_reached = wait;
 
-    std::string code, comment;
-    std::ostringstream gcode;
-
-    if (wait) {
-        code = "M190";
-        comment = "set bed temperature and wait for it to be reached";
-    }
-    else {
-        code = "M140";
-        comment = "set bed temperature";
-    }
-
-    gcode << code << " S" << temperature << " ; " << comment << "\n";
-    return gcode.str();
+    GCodeFormatter w;
+    w.emit_string(wait ? "M190 S" : "M140 S");
+    w.emit_int(temperature);
+    w.emit_string(wait ? " ; set bed temperature and wait for it to be reached" : " ; set bed temperature");
+    return w.string();
 }
 
 std::string GCodeWriter::set_chamber_temperature(int temperature, bool wait)
 {
-    std::string code, comment;
-    std::ostringstream gcode;
-
+    std::string gcode;
     if (wait)
     {
         // Orca: should we let the M191 command to turn on the auxiliary fan?
         if (config.auxiliary_fan)
-            gcode << "M106 P2 S255 \n";
-        gcode << "M191 S" << std::to_string(temperature) << " ;"
-              << "set chamber_temperature and wait for it to be reached\n";
+            gcode += "M106 P2 S255 \n";
+        gcode += "M191 S" + std::to_string(temperature) + " ;set chamber_temperature and wait for it to be reached\n";
         if (config.auxiliary_fan)
-            gcode << "M106 P2 S0 \n";
-    }
-    else {
-        code = "M141";
-        comment = "set chamber_temperature";
-        gcode << code << " S" << temperature << ";" << comment << "\n";
+            gcode += "M106 P2 S0 \n";
     }
-    return gcode.str();
+    else
+        gcode = "M141 S" + std::to_string(temperature) + ";set chamber_temperature\n";
+    return gcode;
 }
 
 // copied from PrusaSlicer
@@ -210,26 +198,32 @@ std::string GCodeWriter::set_acceleration_internal(Acceleration type, unsigned i
     
     last_value = acceleration;
     
-    std::ostringstream gcode;
-    if (FLAVOR_IS(gcfRepetier))
-        gcode << (separate_travel ? "M202 X" : "M201 X") << acceleration << " Y" << acceleration;
-    else if (FLAVOR_IS(gcfRepRapFirmware) || FLAVOR_IS(gcfMarlinFirmware))
-        gcode << (separate_travel ? "M204 T" : "M204 P") << acceleration;
-    else if (FLAVOR_IS(gcfKlipper)) {
-        gcode << "SET_VELOCITY_LIMIT ACCEL=" << acceleration;
+    GCodeFormatter w;
+    if (FLAVOR_IS(gcfRepetier)) {
+        w.emit_string(separate_travel ? "M202 X" : "M201 X");
+        w.emit_int(acceleration);
+        w.emit_string(" Y");
+        w.emit_int(acceleration);
+    } else if (FLAVOR_IS(gcfRepRapFirmware) || FLAVOR_IS(gcfMarlinFirmware)) {
+        w.emit_string(separate_travel ? "M204 T" : "M204 P");
+        w.emit_int(acceleration);
+    } else if (FLAVOR_IS(gcfKlipper)) {
+        w.emit_string("SET_VELOCITY_LIMIT ACCEL=");
+        w.emit_int(acceleration);
         if (this->config.accel_to_decel_enable) {
-            gcode << " ACCEL_TO_DECEL=" << acceleration * this->config.accel_to_decel_factor / 100;
+            w.emit_string(" ACCEL_TO_DECEL=");
+            w.emit_double(acceleration * this->config.accel_to_decel_factor / 100);
             if (GCodeWriter::full_gcode_comment)
-                gcode << " ; adjust ACCEL_TO_DECEL";
+                w.emit_string(" ; adjust ACCEL_TO_DECEL");
         }
+    } else {
+        w.emit_string("M204 S");
+        w.emit_int(acceleration);
     }
-    else
-        gcode << "M204 S" << acceleration;
 
-    if (GCodeWriter::full_gcode_comment) gcode << " ; adjust acceleration";
-    gcode << "\n";
+    if (GCodeWriter::full_gcode_comment) w.emit_string(" ; adjust acceleration");
     
-    return gcode.str();
+    return w.string();
 }
 
 std::string GCodeWriter::set_jerk_xy(double jerk)
@@ -239,7 +233,7 @@ std::string GCodeWriter::set_jerk_xy(double jerk)
     
     m_last_jerk = jerk;
 
-    std::ostringstream gcode;
+    GCodeFormatter w;
     if (FLAVOR_IS(gcfKlipper)) {
         // Clamp the jerk to the allowed maximum.
         if (m_max_jerk_x > 0 && jerk > m_max_jerk_x)
@@ -247,7 +241,8 @@ std::string GCodeWriter::set_jerk_xy(double jerk)
         if (m_max_jerk_y > 0 && jerk > m_max_jerk_y)
             jerk = m_max_jerk_y;
         
-        gcode << "SET_VELOCITY_LIMIT SQUARE_CORNER_VELOCITY=" << jerk;
+        w.emit_string("SET_VELOCITY_LIMIT SQUARE_CORNER_VELOCITY=");
+        w.emit_double(jerk);
     } else {
         double jerk_x = jerk;
         double jerk_y = jerk;
@@ -257,16 +252,22 @@ std::string GCodeWriter::set_jerk_xy(double jerk)
         if (m_max_jerk_y > 0 && jerk > m_max_jerk_y)
             jerk_y = m_max_jerk_y;
         
-        gcode << "M205 X" << jerk_x << " Y" << jerk_y;
+        w.emit_string("M205 X");
+        w.emit_double(jerk_x);
+        w.emit_string(" Y");
+        w.emit_double(jerk_y);
     }
       
-    if (m_is_bbl_printers)
-        gcode << std::setprecision(2) << " Z" << m_max_jerk_z << " E" << m_max_jerk_e;
+    if (m_is_bbl_printers) {
+        w.emit_string(" Z");
+        w.emit_double(m_max_jerk_z, 2);
+        w.emit_string(" E");
+        w.emit_double(m_max_jerk_e, 2);
+    }
 
-    if (GCodeWriter::full_gcode_comment) gcode << " ; adjust jerk";
-    gcode << "\n";
+    if (GCodeWriter::full_gcode_comment) w.emit_string(" ; adjust jerk");
 
-    return gcode.str();
+    return w.string();
 
 }
 
@@ -281,12 +282,14 @@ std::string GCodeWriter::set_accel_and_jerk(unsigned int acceleration, double je
         acceleration = m_max_acceleration;
     
     bool is_empty = true;
-    std::ostringstream gcode;
-    gcode << "SET_VELOCITY_LIMIT";
+    GCodeFormatter w;
+    w.emit_string("SET_VELOCITY_LIMIT");
     if (acceleration != 0 && acceleration != m_last_acceleration) {
-        gcode << " ACCEL=" << acceleration;
+        w.emit_string(" ACCEL=");
+        w.emit_int(acceleration);
         if (this->config.accel_to_decel_enable) {
-            gcode << " ACCEL_TO_DECEL=" << acceleration * this->config.accel_to_decel_factor / 100;
+            w.emit_string(" ACCEL_TO_DECEL=");
+            w.emit_double(acceleration * this->config.accel_to_decel_factor / 100);
         }
         m_last_acceleration = acceleration;
         is_empty = false;
@@ -298,7 +301,8 @@ std::string GCodeWriter::set_accel_and_jerk(unsigned int acceleration, double je
         jerk = m_max_jerk_y;
 
     if (jerk > 0.01 && !is_approx(jerk, m_last_jerk)) {
-        gcode << " SQUARE_CORNER_VELOCITY=" << jerk;
+        w.emit_string(" SQUARE_CORNER_VELOCITY=");
+        w.emit_double(jerk);
         m_last_jerk = jerk;
         is_empty = false;
     }
@@ -307,49 +311,48 @@ std::string GCodeWriter::set_accel_and_jerk(unsigned int acceleration, double je
         return std::string();
 
     if (GCodeWriter::full_gcode_comment)
-        gcode << " ; adjust VELOCITY_LIMIT(accel/jerk)";
-    gcode << "\n";
+        w.emit_string(" ; adjust VELOCITY_LIMIT(accel/jerk)");
 
-    return gcode.str();
+    return w.string();
 
 }
 
 std::string GCodeWriter::set_junction_deviation(double junction_deviation){
-    std::ostringstream gcode;
     if (FLAVOR_IS(gcfMarlinFirmware) && junction_deviation > 0 && m_max_junction_deviation > 0) {
+        GCodeFormatter w;
         // Clamp the junction deviation to the allowed maximum.
-        gcode << "M205 J";
-        if (junction_deviation <= m_max_junction_deviation) {
-            gcode << std::fixed << std::setprecision(3) << junction_deviation;
-        } else {
-            gcode << std::fixed << std::setprecision(3) << m_max_junction_deviation;
-        }
+        w.emit_string("M205 J");
+        w.emit_double(std::min(junction_deviation, m_max_junction_deviation), 3, true);
         if (GCodeWriter::full_gcode_comment) {
-            gcode << " ; Junction Deviation";
+            w.emit_string(" ; Junction Deviation");
         }
-        gcode << "\n";
+        return w.string();
     }
-    return gcode.str();
+    return std::string();
 }
 
 std::string GCodeWriter::set_pressure_advance(double pa) const
 {
-    std::ostringstream gcode;
     if (pa < 0)
-        return gcode.str();
+        return std::string();
+    GCodeFormatter w;
     if(m_is_bbl_printers){
         //SoftFever: set L1000 to use linear model
-        gcode << "M900 K" <<std::setprecision(4)<< pa << " L1000 M10 ; Override pressure advance value\n";
+        w.emit_string("M900 K");
+        w.emit_double(pa, 4);
+        w.emit_string(" L1000 M10 ; Override pressure advance value");
     }
     else{
         if (FLAVOR_IS(gcfKlipper))
-            gcode << "SET_PRESSURE_ADVANCE ADVANCE=" << std::setprecision(4) << pa << "; Override pressure advance value\n";
+            w.emit_string("SET_PRESSURE_ADVANCE ADVANCE=");
         else if(FLAVOR_IS(gcfRepRapFirmware))
-            gcode << ("M572 D0 S") << std::setprecision(4) << pa << "; Override pressure advance value\n";
+            w.emit_string("M572 D0 S");
         else
-            gcode << "M900 K" <<std::setprecision(4)<< pa << "; Override pressure advance value\n";
+            w.emit_string("M900 K");
+        w.emit_double(pa, 4);
+        w.emit_string("; Override pressure advance value");
     }
-    return gcode.str();
+    return w.string();
 }
 
 std::string GCodeWriter::set_input_shaping(char axis, float damp, float freq) const
@@ -414,12 +417,8 @@ std::string GCodeWriter::reset_e(bool force)
     }
 
     if (! this->config.use_relative_e_distances) {
-        std::ostringstream gcode;
-        gcode << "G92 E0";
         //BBS
-        if (GCodeWriter::full_gcode_comment) gcode << " ; reset extrusion distance";
-        gcode << "\n";
-        return gcode.str();
+        return GCodeWriter::full_gcode_comment ? "G92 E0 ; reset extrusion distance\n" : "G92 E0\n";
     } else {
         return "";
     }
@@ -437,12 +436,12 @@ std::string GCodeWriter::update_progress(unsigned int num, unsigned int tot, boo
     unsigned int percent = (unsigned int)floor(100.0 * num / tot + 0.5);
     if (!allow_100) percent = std::min(percent, (unsigned int)99);
     
-    std::ostringstream gcode;
-    gcode << "M73 P" << percent;
+    GCodeFormatter w;
+    w.emit_string("M73 P");
+    w.emit_int(percent);
     //BBS
-    if (GCodeWriter::full_gcode_comment) gcode << " ; update progress";
-    gcode << "\n";
-    return gcode.str();
+    if (GCodeWriter::full_gcode_comment) w.emit_string(" ; update progress");
+    return w.string();
 }
 
 std::string GCodeWriter::toolchange_prefix() const
@@ -461,20 +460,22 @@ std::string GCodeWriter::toolchange(unsigned int extruder_id)
 
     // return the toolchange command
     // if we are running a single-extruder setup, just set the extruder and return nothing
-    std::ostringstream gcode;
+    std::string gcode;
     if ((this->multiple_extruders || (this->config.filament_diameter.values.size() > 1 && !is_bbl_printers()))  &&
         config.auto_toolchange_command) {
-        gcode << this->toolchange_prefix() << extruder_id;
+        GCodeFormatter w;
+        w.emit_string(this->toolchange_prefix());
+        w.emit_int(extruder_id);
         //BBS
         if (GCodeWriter::full_gcode_comment)
-            gcode << " ; change extruder";
-        gcode << "\n";
-        gcode << this->reset_e(true);
+            w.emit_string(" ; change extruder");
+        w.append_to(gcode);
+        gcode += this->reset_e(true);
     }
-    return gcode.str();
+    return gcode;
 }
 
-std::string GCodeWriter::set_speed(double F, const std::string &comment, const std::string &cooling_marker)
+void GCodeWriter::set_speed(std::string &out, double F, std::string_view comment, std::string_view cooling_marker)
 {
     assert(F > 0.);
     assert(F < 100000.);
@@ -485,10 +486,10 @@ std::string GCodeWriter::set_speed(double F, const std::string &comment, const s
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
     w.emit_string(cooling_marker);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &comment)
+void GCodeWriter::travel_to_xy(std::string &out, const Vec2d &point, std::string_view comment)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -504,10 +505,10 @@ std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &com
     w.emit_f(speed * 60.0);
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &comment, bool force_z)
+void GCodeWriter::travel_to_xyz(std::string &out, const Vec3d &point, std::string_view comment, bool force_z)
 {
     // FIXME: This function was not being used when travel_speed_z was separated (bd6badf).
     // Calculation of feedrate was not updated accordingly. If you want to use
@@ -535,7 +536,6 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
         }
         m_to_lift = 0.;
 
-        std::string slop_move;
         //BBS: minus plate offset
         Vec3d source = { m_pos(0) - m_x_offset, m_pos(1) - m_y_offset, m_pos(2) };
         Vec3d target = { dest_point(0) - m_x_offset, dest_point(1) - m_y_offset, dest_point(2) };
@@ -550,7 +550,7 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
                 double radius = delta(2) / (2 * PI * atan(this->extruder()->travel_slope()));
                 Vec2d ij_offset = radius * delta_no_z.normalized();
                 ij_offset = { -ij_offset(1), ij_offset(0) };
-                slop_move = this->_spiral_travel_to_z(target(2), ij_offset, "spiral lift Z");
+                this->_spiral_travel_to_z(out, target(2), ij_offset, "spiral lift Z");
             }
             //BBS: LazyLift
             else if (m_to_lift_type == LiftType::LazyLift &&
@@ -566,32 +566,32 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
                 w0.emit_f(travel_speed * 60.0);
                 //BBS
                 w0.emit_comment(GCodeWriter::full_gcode_comment, comment);
-                slop_move = w0.string();
+                w0.append_to(out);
             }
             else if (m_to_lift_type == LiftType::NormalLift) {
-                slop_move = _travel_to_z(target.z(), "normal lift Z");
+                this->_travel_to_z(out, target.z(), "normal lift Z");
             }
         }
 
-        std::string xy_z_move;
         {
             GCodeG1Formatter w0;
             if (this->is_current_position_clear()) {
                 w0.emit_xyz(target);
                 w0.emit_f(travel_speed * 60.0);
                 w0.emit_comment(GCodeWriter::full_gcode_comment, comment);
-                xy_z_move = w0.string();
+                w0.append_to(out);
             }
             else {
                 w0.emit_xy(Vec2d(target.x(), target.y()));
                 w0.emit_f(travel_speed * 60.0);
                 w0.emit_comment(GCodeWriter::full_gcode_comment, comment);
-                xy_z_move = w0.string() + _travel_to_z(target.z(), comment);
+                w0.append_to(out);
+                this->_travel_to_z(out, target.z(), comment);
             }
         }
         m_pos = dest_point;
         this->set_current_position_clear(true);
-        return slop_move + xy_z_move;
+        return;
     }
     else if (!force_z && !this->will_move_z(point(2))) {
         double nominal_z = m_pos(2) - m_lifted;
@@ -602,7 +602,8 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
             m_lifted = 0.;
         //BBS
         this->set_current_position_clear(true);
-        return this->travel_to_xy(to_2d(point));
+        this->travel_to_xy(out, to_2d(point));
+        return;
     }
     else {
         /*  In all the other cases, we perform an actual XYZ move and cancel
@@ -612,7 +613,6 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
     
     //BBS: take plate offset into consider
     Vec3d point_on_plate = { dest_point(0) - m_x_offset, dest_point(1) - m_y_offset, dest_point(2) };
-    std::string out_string;
     GCodeG1Formatter w;
     if (!this->is_current_position_clear())
     {
@@ -620,18 +620,17 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
         w.emit_xy(Vec2d(point_on_plate.x(), point_on_plate.y()));
         w.emit_f(this->config.travel_speed.value * 60.0);
         w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-        out_string = w.string() + _travel_to_z(point_on_plate.z(), comment);
+        w.append_to(out);
+        this->_travel_to_z(out, point_on_plate.z(), comment);
     } else {
-        GCodeG1Formatter w;
         w.emit_xyz(point_on_plate);
         w.emit_f(this->config.travel_speed.value * 60.0);
         w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-        out_string = w.string();
+        w.append_to(out);
     }
 
     m_pos = dest_point;
     this->set_current_position_clear(true);
-    return out_string;
 }
 
 std::string GCodeWriter::travel_to_z(double z, const std::string &comment, bool force)
@@ -653,7 +652,7 @@ std::string GCodeWriter::travel_to_z(double z, const std::string &comment, bool
     return this->_travel_to_z(z, comment);
 }
 
-std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
+void GCodeWriter::_travel_to_z(std::string &out, double z, std::string_view comment)
 {
     m_pos(2) = z;
 
@@ -668,10 +667,10 @@ std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
     w.emit_f(speed * 60.0);
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::_spiral_travel_to_z(double z, const Vec2d &ij_offset, const std::string &comment)
+void GCodeWriter::_spiral_travel_to_z(std::string &out, double z, const Vec2d &ij_offset, std::string_view comment)
 {
     m_pos(2) = z;
 
@@ -681,7 +680,7 @@ std::string GCodeWriter::_spiral_travel_to_z(double z, const Vec2d &ij_offset, c
                                  : this->config.travel_speed.value;
     }
     
-    std::string output = ";G17\n";  // G17 is not supported
+    out += ";G17\n";  // G17 is not supported
     GCodeG2G3Formatter w(true);
     w.emit_z(z);
     w.emit_ij(ij_offset);
@@ -689,7 +688,7 @@ std::string GCodeWriter::_spiral_travel_to_z(double z, const Vec2d &ij_offset, c
     w.emit_string(" ");     // P1 is not supported
     w.emit_f(speed * 60.0);
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return output + w.string();
+    w.append_to(out);
 }
 
 bool GCodeWriter::will_move_z(double z) const
@@ -709,7 +708,7 @@ bool GCodeWriter::will_move_z(double z) const
     return true;
 }
 
-std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std::string &comment, bool force_no_extrusion)
+void GCodeWriter::extrude_to_xy(std::string &out, const Vec2d &point, double dE, std::string_view comment, bool force_no_extrusion)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -728,13 +727,13 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
         w.emit_e(m_extruder->E());
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 //BBS: generate G2 or G3 extrude which moves by arc
 //point is end point which means X and Y axis
 //center_offset is I and J axis
-std::string GCodeWriter::extrude_arc_to_xy(const Vec2d& point, const Vec2d& center_offset, double dE, const bool is_ccw, const std::string& comment, bool force_no_extrusion)
+void GCodeWriter::extrude_arc_to_xy(std::string &out, const Vec2d& point, const Vec2d& center_offset, double dE, const bool is_ccw, std::string_view comment, bool force_no_extrusion)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -750,10 +749,10 @@ std::string GCodeWriter::extrude_arc_to_xy(const Vec2d& point, const Vec2d& cent
         w.emit_e(m_extruder->E());
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment, bool force_no_extrusion)
+void GCodeWriter::extrude_to_xyz(std::string &out, const Vec3d &point, double dE, std::string_view comment, bool force_no_extrusion)
 {
     m_pos = point;
     m_lifted = 0;
@@ -769,7 +768,7 @@ std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std
         w.emit_e(m_extruder->E());
     //BBS
     w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 std::string GCodeWriter::retract(bool before_wipe, double retract_length)
@@ -814,7 +813,7 @@ std::string GCodeWriter::_retract(double length, double restart_extra, const std
             w.emit_f(m_extruder->retract_speed() * 60.);
             // BBS
             w.emit_comment(GCodeWriter::full_gcode_comment, comment);
-            gcode = w.string();
+            w.append_to(gcode);
         }
     }
     
@@ -844,7 +843,7 @@ std::string GCodeWriter::unretract()
             w.emit_f(m_extruder->deretract_speed() * 60.);
             //BBS
             w.emit_comment(GCodeWriter::full_gcode_comment, " ; unretract");
-            gcode += w.string();
+            w.append_to(gcode);
         }
     }
     
@@ -891,36 +890,36 @@ std::string GCodeWriter::unlift()
 
 std::string GCodeWriter::set_fan(const GCodeFlavor gcode_flavor, unsigned int speed)
 {
-    std::ostringstream gcode;
+    GCodeFormatter w;
     if (speed == 0) {
         switch (gcode_flavor) {
         case gcfTeacup:
-            gcode << "M106 S0"; break;
+            w.emit_string("M106 S0"); break;
         case gcfMakerWare:
         case gcfSailfish:
-            gcode << "M127";    break;
+            w.emit_string("M127");    break;
         default:
-            gcode << "M106 S0";    break;
+            w.emit_string("M106 S0");    break;
         }
         if (GCodeWriter::full_gcode_comment)
-            gcode << " ; disable fan";
-        gcode << "\n";
+            w.emit_string(" ; disable fan");
     } else {
         switch (gcode_flavor) {
         case gcfMakerWare:
         case gcfSailfish:
-            gcode << "M126";    break;
+            w.emit_string("M126");    break;
         case gcfMach3:
         case gcfMachinekit:
-            gcode << "M106 P" << static_cast<unsigned int>(255.5 * speed / 100.0); break;
+            w.emit_string("M106 P");
+            w.emit_int(static_cast<unsigned int>(255.5 * speed / 100.0)); break;
         default:
-            gcode << "M106 S" << static_cast<unsigned int>(255.5 * speed / 100.0); break;
+            w.emit_string("M106 S");
+            w.emit_int(static_cast<unsigned int>(255.5 * speed / 100.0)); break;
         }
         if (GCodeWriter::full_gcode_comment) 
-            gcode << " ; enable fan";
-        gcode << "\n";
+            w.emit_string(" ; enable fan");
     }
-    return gcode.str();
+    return w.string();
 }
 
 std::string GCodeWriter::set_fan(unsigned int speed) const
@@ -932,27 +931,25 @@ std::string GCodeWriter::set_fan(unsigned int speed) const
 //BBS: set additional fan speed for BBS machine only
 std::string GCodeWriter::set_additional_fan(unsigned int speed)
 {
-    std::ostringstream gcode;
-
-    gcode << "M106 " << "P2 " << "S" << (int)(255.0 * speed / 100.0);
+    GCodeFormatter w;
+    w.emit_string("M106 P2 S");
+    w.emit_int((int)(255.0 * speed / 100.0));
     if (GCodeWriter::full_gcode_comment) {
         if (speed == 0)
-            gcode << " ; disable additional fan ";
+            w.emit_string(" ; disable additional fan ");
         else
-            gcode << " ; enable additional fan ";
+            w.emit_string(" ; enable additional fan ");
     }
-    gcode << "\n";
-    return gcode.str();
+    return w.string();
 }
 
 std::string GCodeWriter::set_exhaust_fan( int speed,bool add_eol)
 {
-    std::ostringstream gcode;
-    gcode << "M106" << " P3" << " S" << (int)(speed / 100.0 * 255);
+    std::string gcode = "M106 P3 S" + std::to_string((int)(speed / 100.0 * 255));
 
     if(add_eol)
-        gcode << "\n";
-    return gcode.str();
+        gcode += "\n";
+    return gcode;
 }
 
 void GCodeWriter::add_object_start_labels(std::string& gcode)
@@ -982,6 +979,33 @@ void GCodeWriter::add_object_change_labels(std::string& gcode)
     add_object_start_labels(gcode);
 }
 
+void GCodeFormatter::emit_int(int64_t v)
+{
+#ifdef __APPLE__
+    boost::spirit::karma::generate(this->ptr_err.ptr, boost::spirit::karma::int_generator<int64_t>(), v);
+#else
+    this->ptr_err = std::to_chars(this->ptr_err.ptr, this->buf_end, v);
+#endif
+}
+
+void GCodeFormatter::emit_double(double v, int precision, bool fixed)
+{
+    // std::ostream formats floating point numbers the way printf() does with the "%.*g" or "%.*f" format, std::to_chars() does the same,
+    // however independently of the C locale, which may use a decimal comma.
+#ifdef __APPLE__
+    // Older stdlib on macOS doesn't support std::to_chars for floating point numbers.
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    if (fixed)
+        ss << std::fixed;
+    ss << std::setprecision(precision) << v;
+    this->emit_string(ss.str());
+#else
+    this->ptr_err = std::to_chars(this->ptr_err.ptr, this->buf_end, v, fixed ? std::chars_format::fixed : std::chars_format::general, precision);
+    assert(this->ptr_err.ec == std::errc());
+#endif
+}
+
 void GCodeFormatter::emit_axis(const char axis, const double v, size_t digits) {
     assert(digits <= 9);
     static constexpr const std::array<int, 10> pow_10{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <string>
+#include <string_view>
 #include <charconv>
 #include "Extruder.hpp"
 #include "Point.hpp"
@@ -67,17 +68,31 @@ public:
     // printed with the same extruder.
     std::string toolchange_prefix() const;
     std::string toolchange(unsigned int extruder_id);
-    std::string set_speed(double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string());
+    std::string set_speed(double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string())
+        { std::string out; this->set_speed(out, F, comment, cooling_marker); return out; }
     // SoftFever NOTE: the returned speed is mm/minute
     double      get_current_speed() const { return m_current_speed;}
-    std::string travel_to_xy(const Vec2d &point, const std::string &comment = std::string());
-    std::string travel_to_xyz(const Vec3d &point, const std::string &comment = std::string(), bool force_z = false);
+    std::string travel_to_xy(const Vec2d &point, const std::string &comment = std::string())
+        { std::string out; this->travel_to_xy(out, point, comment); return out; }
+    std::string travel_to_xyz(const Vec3d &point, const std::string &comment = std::string(), bool force_z = false)
+        { std::string out; this->travel_to_xyz(out, point, comment, force_z); return out; }
     std::string travel_to_z(double z, const std::string &comment = std::string(), bool force = false);
     bool        will_move_z(double z) const;
-    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false)
+        { std::string out; this->extrude_to_xy(out, point, dE, comment, force_no_extrusion); return out; }
     //BBS: generate G2 or G3 extrude which moves by arc
-    std::string extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, const std::string &comment = std::string(), bool force_no_extrusion = false);
-    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    std::string extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, const std::string &comment = std::string(), bool force_no_extrusion = false)
+        { std::string out; this->extrude_arc_to_xy(out, point, center_offset, dE, is_ccw, comment, force_no_extrusion); return out; }
+    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false)
+        { std::string out; this->extrude_to_xyz(out, point, dE, comment, force_no_extrusion); return out; }
+    // The same moves appended to out, which the caller reuses for the G-code of a whole layer,
+    // thus no temporary string is allocated per move.
+    void        set_speed(std::string &out, double F, std::string_view comment = {}, std::string_view cooling_marker = {});
+    void        travel_to_xy(std::string &out, const Vec2d &point, std::string_view comment = {});
+    void        travel_to_xyz(std::string &out, const Vec3d &point, std::string_view comment = {}, bool force_z = false);
+    void        extrude_to_xy(std::string &out, const Vec2d &point, double dE, std::string_view comment = {}, bool force_no_extrusion = false);
+    void        extrude_arc_to_xy(std::string &out, const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, std::string_view comment = {}, bool force_no_extrusion = false);
+    void        extrude_to_xyz(std::string &out, const Vec3d &point, double dE, std::string_view comment = {}, bool force_no_extrusion = false);
     std::string retract(bool before_wipe = false, double retract_length = 0);
     std::string retract_for_toolchange(bool before_wipe = false, double retract_length = 0);
     std::string unretract();
@@ -175,8 +190,9 @@ public:
         Print
     };
 
-    std::string _travel_to_z(double z, const std::string &comment);
-    std::string _spiral_travel_to_z(double z, const Vec2d &ij_offset, const std::string &comment);
+    std::string _travel_to_z(double z, const std::string &comment) { std::string out; this->_travel_to_z(out, z, comment); return out; }
+    void        _travel_to_z(std::string &out, double z, std::string_view comment);
+    void        _spiral_travel_to_z(std::string &out, double z, const Vec2d &ij_offset, std::string_view comment);
     std::string _retract(double length, double restart_extra, const std::string &comment);
     std::string set_acceleration_internal(Acceleration type, unsigned int acceleration);
 
@@ -246,23 +262,34 @@ public:
         this->emit_axis('J', point.y(), XYZF_EXPORT_DIGITS);
     }
 
-    void emit_string(const std::string &s) {
-        strncpy(ptr_err.ptr, s.c_str(), s.size());
+    void emit_string(std::string_view s) {
+        memcpy(ptr_err.ptr, s.data(), s.size());
         ptr_err.ptr += s.size();
     }
 
-    void emit_comment(bool allow_comments, const std::string &comment) {
+    void emit_comment(bool allow_comments, std::string_view comment) {
         if (allow_comments && ! comment.empty()) {
             *ptr_err.ptr ++ = ' '; *ptr_err.ptr ++ = ';'; *ptr_err.ptr ++ = ' ';
             this->emit_string(comment);
         }
     }
 
+    // Parameters of the commands other than the moves, formatted the same way as std::ostream formats them.
+    void emit_int(int64_t v);
+    // "%g" style, "%f" style if fixed, with the precision of std::ostream.
+    void emit_double(double v, int precision = 6, bool fixed = false);
+
     std::string string() {
         *ptr_err.ptr ++ = '\n';
         return std::string(this->buf, ptr_err.ptr - buf);
     }
 
+    // Terminate the line and append it to out.
+    void append_to(std::string &out) {
+        *ptr_err.ptr ++ = '\n';
+        out.append(this->buf, ptr_err.ptr - buf);
+    }
+
 protected:
     static constexpr const size_t   buflen = 256;
     char                            buf[buflen];
@@ -0,0 +1,85 @@
+#include "MD5Hasher.hpp"
+#include "Config.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include <admesh/stl.h>
+
+#include <boost/algorithm/hex.hpp>
+//FIXME replace the following include with <boost/md5.hpp> after it becomes mainstream.
+// boost::uuids::detail::md5 is an internal namespace thus it may change in the future.
+#include <boost/uuid/detail/md5.hpp>
+
+namespace Slic3r {
+
+struct MD5Hasher::Impl
+{
+    boost::uuids::detail::md5 md5;
+};
+
+MD5Hasher::MD5Hasher() : m_impl(std::make_unique<Impl>()) {}
+MD5Hasher::~MD5Hasher() = default;
+
+void MD5Hasher::bytes(const void *data, size_t size)
+{
+    m_impl->md5.process_bytes(data, size);
+}
+
+void MD5Hasher::values(const std::vector<bool> &v)
+{
+    this->value(v.size());
+    for (bool b : v)
+        this->value(b);
+}
+
+void MD5Hasher::polygons(const Polygons &polygons)
+{
+    this->value(polygons.size());
+    for (const Polygon &polygon : polygons)
+        this->polygon(polygon);
+}
+
+void MD5Hasher::expolygons(const ExPolygons &expolygons)
+{
+    this->value(expolygons.size());
+    for (const ExPolygon &expolygon : expolygons) {
+        this->polygon(expolygon.contour);
+        this->polygons(expolygon.holes);
+    }
+}
+
+void MD5Hasher::mesh(const indexed_triangle_set &its)
+{
+    this->values(its.vertices);
+    this->values(its.indices);
+}
+
+void MD5Hasher::option(const ConfigBase &config, const std::string &opt_key)
+{
+    this->string(opt_key);
+    this->string(config.opt_serialize(opt_key));
+}
+
+MD5Hasher::Digest MD5Hasher::digest()
+{
+    boost::uuids::detail::md5::digest_type md5_digest{};
+    m_impl->md5.get_digest(md5_digest);
+    static_assert(sizeof(md5_digest) == sizeof(Digest));
+    Digest out;
+    std::memcpy(out.data(), &md5_digest, sizeof(Digest));
+    return out;
+}
+
+std::string MD5Hasher::hex_digest()
+{
+    const Digest digest = this->digest();
+    std::string  out;
+    boost::algorithm::hex(digest.begin(), digest.end(), std::back_inserter(out));
+    // MD5 hash is 32 HEX digits long.
+    assert(out.size() == 32);
+    return out;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,64 @@
+#ifndef slic3r_MD5Hasher_hpp_
+#define slic3r_MD5Hasher_hpp_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Point.hpp"
+#include "ExPolygon.hpp"
+
+struct indexed_triangle_set;
+
+namespace Slic3r {
+
+class ConfigBase;
+
+// Incremental MD5 hash of the inputs of a cached computation: meshes, polygons, transformations, configuration options.
+// The containers are hashed together with their sizes, so that the concatenation of different containers does not collide.
+// Shared by the caches of the slicing results (SliceCache, Arachne wall toolpaths, adaptive infill octrees, seam visibility)
+// and by the checksum of AppConfig.
+class MD5Hasher
+{
+public:
+    using Digest = std::array<unsigned int, 4>;
+
+    MD5Hasher();
+    ~MD5Hasher();
+
+    void bytes(const void *data, size_t size);
+    template<typename T> void value(const T &v) { static_assert(std::is_trivially_copyable_v<T>); this->bytes(&v, sizeof(T)); }
+    // Vectors of trivially copyable types or of Eigen vectors, which are not trivially copyable formally.
+    template<typename T, typename Alloc> void values(const std::vector<T, Alloc> &v) {
+        this->value(v.size());
+        if (! v.empty())
+            this->bytes(v.data(), v.size() * sizeof(T));
+    }
+    void values(const std::vector<bool> &v);
+    void string(std::string_view s) { this->value(s.size()); this->bytes(s.data(), s.size()); }
+
+    void polygon(const Polygon &polygon) { this->values(polygon.points); }
+    void polygons(const Polygons &polygons);
+    void expolygons(const ExPolygons &expolygons);
+    void mesh(const indexed_triangle_set &its);
+    void transform(const Transform3d &trafo) { this->bytes(trafo.matrix().data(), sizeof(double) * 16); }
+    // Key and the serialized value of a configuration option.
+    void option(const ConfigBase &config, const std::string &opt_key);
+
+    // Finishes the hash, no data may be added afterwards.
+    Digest      digest();
+    // 32 hexadecimal digits of the digest.
+    std::string hex_digest();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_MD5Hasher_hpp_
@@ -11,6 +11,7 @@
 #include <utility>
 #include <unordered_set>
 
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <tbb/parallel_for.h>
 #include <mutex>
@@ -1141,18 +1142,22 @@ static void remove_multiple_edges_in_vertex(const VD::vertex_type &vertex) {
     }
 }
 
+// Only the layers with layers_to_update[layer_idx] set are cut.
 static void cut_segmented_layers(const std::vector<ExPolygons>        &input_expolygons,
                                  std::vector<std::vector<ExPolygons>> &segmented_regions,
                                  const float                           cut_width,
                                  const float                           interlocking_depth,
+                                 const std::vector<bool>              &layers_to_update,
                                  const std::function<void()>          &throw_on_cancel_callback)
 {
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - cutting segmented layers in parallel - begin";
     const float interlocking_cut_width = interlocking_depth > 0.f ? std::max(cut_width - interlocking_depth, 0.f) : 0.f;
     tbb::parallel_for(tbb::blocked_range<size_t>(0, segmented_regions.size()),
-    [&segmented_regions, &input_expolygons, &cut_width, &interlocking_depth, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    [&segmented_regions, &input_expolygons, &cut_width, &interlocking_depth, &layers_to_update, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
+            if (! layers_to_update[layer_idx])
+                continue;
             const float  region_cut_width       = ((layer_idx % 2 == 0) && (interlocking_depth != 0.f)) ? interlocking_depth : cut_width;
             const size_t num_extruders_plus_one = segmented_regions[layer_idx].size();
             if (region_cut_width > 0.f) {
@@ -1175,13 +1180,32 @@ static bool is_volume_sinking(const indexed_triangle_set &its, const Transform3d
     return false;
 }
 
+// Volumes, whose painting is segmented. The other volumes only affect the segmentation through the slices.
+static bool is_segmented_volume(const ModelVolume &mv)
+{
+    return mv.is_model_part();
+}
+
+// Marks the layers up to reach layers away from the marked layers.
+static std::vector<bool> dilate_layers(const std::vector<bool> &layers, size_t reach)
+{
+    std::vector<bool> out(layers.size(), false);
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx)
+        if (layers[layer_idx])
+            for (size_t i = layer_idx > reach ? layer_idx - reach : 0; i < std::min(layer_idx + reach + 1, layers.size()); ++ i)
+                out[i] = true;
+    return out;
+}
+
 //#define MMU_SEGMENTATION_DEBUG_TOP_BOTTOM
 
 // Returns segmentation of top and bottom layers based on painting in segmentation gizmos.
+// Only the layers with layers_to_update[layer_idx] set are returned, the other layers are left empty.
 static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_layers(const PrintObject                                               &print_object,
                                                                                       const std::vector<ExPolygons>                                   &input_expolygons,
                                                                                       const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
                                                                                       const size_t                                                     num_facets_states,
+                                                                                      const std::vector<bool>                                         &layers_to_update,
                                                                                       const std::function<void()>                                     &throw_on_cancel_callback)
 {
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Segmentation of top and bottom layers in parallel - Begin";
@@ -1198,6 +1222,9 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
         max_bottom_layers = std::max(max_bottom_layers, config.bottom_shell_layers.value);
         granularity       = std::max(granularity, std::max(config.top_shell_layers.value, config.bottom_shell_layers.value) - 1);
     }
+    // The top shells of a layer reach max_top_layers below it, the bottom shells reach max_bottom_layers above it,
+    // thus the layers to update collect the shells of the layers up to this distance.
+    const std::vector<bool> source_layers = dilate_layers(layers_to_update, size_t(std::max(max_top_layers, max_bottom_layers)));
 
     // Project upwards pointing painted triangles over top surfaces,
     // project downards pointing painted triangles over bottom surfaces.
@@ -1211,7 +1238,7 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
 
     if (max_top_layers > 0 || max_bottom_layers > 0) {
         for (const ModelVolume *mv : print_object.model_object()->volumes)
-            if (mv->is_model_part()) {
+            if (is_segmented_volume(*mv)) {
                 const Transform3d volume_trafo = object_trafo * mv->get_matrix();
                 for (size_t extruder_idx = 0; extruder_idx < num_facets_states; ++extruder_idx) {
                     const indexed_triangle_set painted = extract_facets_info(*mv).facets_annotation.get_facets_strict(*mv, EnforcerBlockerType(extruder_idx));
@@ -1263,11 +1290,11 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
             }
     }
 
-    auto filter_out_small_polygons = [&num_facets_states, &num_layers](std::vector<std::vector<Polygons>> &raw_surfaces, double min_area) -> void {
+    auto filter_out_small_polygons = [&num_facets_states, &num_layers, &source_layers](std::vector<std::vector<Polygons>> &raw_surfaces, double min_area) -> void {
         for (size_t extruder_idx = 0; extruder_idx < num_facets_states; ++extruder_idx)
             if (!raw_surfaces[extruder_idx].empty())
                 for (size_t layer_idx = 0; layer_idx < num_layers; ++layer_idx)
-                    if (!raw_surfaces[extruder_idx][layer_idx].empty())
+                    if (source_layers[layer_idx] && !raw_surfaces[extruder_idx][layer_idx].empty())
                         remove_small(raw_surfaces[extruder_idx][layer_idx], min_area);
     };
 
@@ -1303,6 +1330,8 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
     {
         for (size_t extruder_idx = 0; extruder_idx < num_facets_states; ++extruder_idx) {
             for (size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
+                if (! source_layers[layer_idx])
+                    continue;
                 if (!top_raw[extruder_idx].empty() && !top_raw[extruder_idx][layer_idx].empty() && layer_idx + 1 < layers.size()) {
                     top_raw[extruder_idx][layer_idx] = diff(top_raw[extruder_idx][layer_idx], input_expolygons[layer_idx + 1]);
                 }
@@ -1369,10 +1398,12 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers, granularity), [&granularity, &num_layers, &num_facets_states, &layer_color_stat, &top_raw, &triangles_by_color_top,
                                                                                &throw_on_cancel_callback, &input_expolygons, &bottom_raw, &triangles_by_color_bottom,
-                                                                               &shell_triangles_by_color_top, &shell_triangles_by_color_bottom](const tbb::blocked_range<size_t> &range) {
+                                                                               &shell_triangles_by_color_top, &shell_triangles_by_color_bottom, &source_layers](const tbb::blocked_range<size_t> &range) {
         size_t group_idx   = range.begin() / granularity;
         size_t layer_idx_offset = (group_idx & 1) * num_layers;
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            if (! source_layers[layer_idx])
+                continue;
             for (size_t color_idx = 0; color_idx < num_facets_states; ++color_idx) {
                 throw_on_cancel_callback();
                 LayerColorStat stat = layer_color_stat(layer_idx, color_idx);
@@ -1423,9 +1454,11 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
     std::vector<std::vector<ExPolygons>> triangles_by_color_merged(num_facets_states);
     triangles_by_color_merged.assign(num_facets_states, std::vector<ExPolygons>(num_layers));
     tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&triangles_by_color_merged, &triangles_by_color_bottom, &triangles_by_color_top, &num_layers, &throw_on_cancel_callback,
-                                                                  &shell_triangles_by_color_top, &shell_triangles_by_color_bottom](const tbb::blocked_range<size_t> &range) {
+                                                                  &shell_triangles_by_color_top, &shell_triangles_by_color_bottom, &layers_to_update](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
             throw_on_cancel_callback();
+            if (! layers_to_update[layer_idx])
+                continue;
             ExPolygons painted_exploys;
             for (size_t color_idx = 0; color_idx < triangles_by_color_merged.size(); ++color_idx) {
                 auto &self = triangles_by_color_merged[color_idx][layer_idx];
@@ -1822,9 +1855,11 @@ static void remove_multiple_edges_in_vertices(MMU_Graph &graph, const std::vecto
     }
 }
 
+// Only the layers with layers_to_update[layer_idx] set are merged, the other layers are left empty.
 static std::vector<std::vector<ExPolygons>> merge_segmented_layers(const std::vector<std::vector<ExPolygons>> &segmented_regions,
                                                                    std::vector<std::vector<ExPolygons>>      &&top_and_bottom_layers,
                                                                    const size_t                                num_facets_states,
+                                                                   const std::vector<bool>                    &layers_to_update,
                                                                    const std::function<void()>                &throw_on_cancel_callback)
 {
     const size_t                         num_layers = segmented_regions.size();
@@ -1833,8 +1868,10 @@ static std::vector<std::vector<ExPolygons>> merge_segmented_layers(const std::ve
     assert(!top_and_bottom_layers.size() || num_facets_states == top_and_bottom_layers.size());
 
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Merging segmented layers in parallel - Begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&segmented_regions, &top_and_bottom_layers, &segmented_regions_merged, &num_facets_states, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&segmented_regions, &top_and_bottom_layers, &segmented_regions_merged, &num_facets_states, &layers_to_update, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            if (! layers_to_update[layer_idx])
+                continue;
             assert(segmented_regions[layer_idx].size() == num_facets_states);
             // Zero is skipped because it is the default color of the volume
             for (size_t extruder_id = 1; extruder_id < num_facets_states; ++extruder_id) {
@@ -1952,6 +1989,250 @@ static bool has_layer_only_one_color(const std::vector<ColoredLines> &colored_po
     return true;
 }
 
+// Inputs of the per layer segmentation of one PrintObject and the per layer segmentation itself.
+struct SegmentationCache::Entry
+{
+    // Volume, whose painting is segmented, see is_segmented_volume().
+    struct Volume
+    {
+        ObjectID                                id;
+        // Held to ensure the mesh is not replaced by another mesh allocated at the same address.
+        std::shared_ptr<const TriangleMesh>     mesh;
+        Transform3d                             matrix;
+        TriangleSelector::TriangleSplittingData painting;
+    };
+
+    ObjectID                             model_object_id;
+    Kind                                 kind;
+    Transform3d                          trafo;
+    Point                                center_offset;
+    size_t                               num_facets_states;
+    std::vector<Volume>                  volumes;
+    // Per layer inputs of the segmentation.
+    std::vector<coordf_t>                slice_zs;
+    std::vector<size_t>                  input_hashes;
+    std::vector<BoundingBox>             layer_bboxes;
+    // Per layer segmentation before cut_segmented_layers() and merge_segmented_layers().
+    std::vector<std::vector<ExPolygons>> segmented;
+    // Hash of the parameters of cut_segmented_layers(), segmentation_top_and_bottom_layers() and merge_segmented_layers().
+    size_t                               merge_parameters_hash { 0 };
+    // Per layer segmentation returned by segmentation_by_painting().
+    std::vector<std::vector<ExPolygons>> merged;
+};
+
+SegmentationCache::SegmentationCache(size_t max_entries) : m_max_entries(max_entries) {}
+SegmentationCache::~SegmentationCache() = default;
+
+std::unique_ptr<SegmentationCache::Entry> SegmentationCache::take(ObjectID model_object_id, Kind kind, const Transform3d &trafo)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [model_object_id, kind, &trafo](const std::unique_ptr<Entry> &entry) {
+        return entry->model_object_id == model_object_id && entry->kind == kind && entry->trafo.isApprox(trafo, EPSILON);
+    });
+    if (it == m_entries.end())
+        return {};
+    std::unique_ptr<Entry> out = std::move(*it);
+    m_entries.erase(it);
+    return out;
+}
+
+void SegmentationCache::put(std::unique_ptr<Entry> entry, size_t layers_segmented, size_t layers_reused, size_t layers_merged)
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_layers_segmented += layers_segmented;
+    m_layers_reused    += layers_reused;
+    m_layers_merged    += layers_merged;
+    // Another PrintObject of the same ModelObject with the same transformation may have been segmented in the meantime.
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&entry](const std::unique_ptr<Entry> &other) {
+        return other->model_object_id == entry->model_object_id && other->kind == entry->kind && other->trafo.isApprox(entry->trafo, EPSILON);
+    }), m_entries.end());
+    m_entries.emplace_back(std::move(entry));
+    if (m_entries.size() > m_max_entries)
+        m_entries.erase(m_entries.begin(), m_entries.begin() + (m_entries.size() - m_max_entries));
+}
+
+void SegmentationCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+size_t SegmentationCache::layers_segmented() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_layers_segmented;
+}
+
+size_t SegmentationCache::layers_reused() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_layers_reused;
+}
+
+size_t SegmentationCache::layers_merged() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_layers_merged;
+}
+
+static size_t hash_expolygons(const ExPolygons &expolygons)
+{
+    size_t seed = expolygons.size();
+    auto hash_polygon = [&seed](const Polygon &polygon) {
+        boost::hash_combine(seed, polygon.size());
+        for (const Point &pt : polygon.points) {
+            boost::hash_combine(seed, pt.x());
+            boost::hash_combine(seed, pt.y());
+        }
+    };
+    for (const ExPolygon &expolygon : expolygons) {
+        hash_polygon(expolygon.contour);
+        boost::hash_combine(seed, expolygon.holes.size());
+        for (const Polygon &hole : expolygon.holes)
+            hash_polygon(hole);
+    }
+    return seed;
+}
+
+// Indices of the source triangles, whose painting differs. TriangleSelector::serialize() stores the triangles sorted by their index.
+static std::vector<int> repainted_triangles(const TriangleSelector::TriangleSplittingData &old_painting, const TriangleSelector::TriangleSplittingData &new_painting)
+{
+    std::vector<int> out;
+    if (old_painting.triangles_to_split == new_painting.triangles_to_split && old_painting.bitstream == new_painting.bitstream)
+        return out;
+
+    auto bits = [](const TriangleSelector::TriangleSplittingData &painting, size_t idx) -> std::pair<size_t, size_t> {
+        const size_t begin = size_t(painting.triangles_to_split[idx].bitstream_start_idx);
+        const size_t end   = idx + 1 < painting.triangles_to_split.size() ? size_t(painting.triangles_to_split[idx + 1].bitstream_start_idx) : painting.bitstream.size();
+        return { begin, end };
+    };
+
+    const std::vector<TriangleSelector::TriangleBitStreamMapping> &old_triangles = old_painting.triangles_to_split;
+    const std::vector<TriangleSelector::TriangleBitStreamMapping> &new_triangles = new_painting.triangles_to_split;
+    size_t old_idx = 0;
+    size_t new_idx = 0;
+    while (old_idx < old_triangles.size() || new_idx < new_triangles.size()) {
+        if (new_idx == new_triangles.size() || (old_idx < old_triangles.size() && old_triangles[old_idx].triangle_idx < new_triangles[new_idx].triangle_idx)) {
+            out.emplace_back(old_triangles[old_idx ++].triangle_idx);
+        } else if (old_idx == old_triangles.size() || new_triangles[new_idx].triangle_idx < old_triangles[old_idx].triangle_idx) {
+            out.emplace_back(new_triangles[new_idx ++].triangle_idx);
+        } else {
+            auto [old_begin, old_end] = bits(old_painting, old_idx);
+            auto [new_begin, new_end] = bits(new_painting, new_idx);
+            if (old_end - old_begin != new_end - new_begin ||
+                ! std::equal(old_painting.bitstream.begin() + old_begin, old_painting.bitstream.begin() + old_end, new_painting.bitstream.begin() + new_begin))
+                out.emplace_back(new_triangles[new_idx].triangle_idx);
+            ++ old_idx;
+            ++ new_idx;
+        }
+    }
+    return out;
+}
+
+// Returns the inputs of the segmentation of print_object to be compared against the next run.
+static std::unique_ptr<SegmentationCache::Entry> make_segmentation_cache_entry(const PrintObject                                               &print_object,
+                                                                               const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
+                                                                               const size_t                                                     num_facets_states,
+                                                                               const SegmentationCache::Kind                                    kind,
+                                                                               std::vector<size_t>                                            &&input_hashes,
+                                                                               const std::vector<BoundingBox>                                  &layer_bboxes)
+{
+    auto entry = std::make_unique<SegmentationCache::Entry>();
+    entry->model_object_id   = print_object.model_object()->id();
+    entry->kind              = kind;
+    entry->trafo             = print_object.trafo();
+    entry->center_offset     = print_object.center_offset();
+    entry->num_facets_states = num_facets_states;
+    for (const ModelVolume *mv : print_object.model_object()->volumes)
+        if (is_segmented_volume(*mv))
+            entry->volumes.push_back({ mv->id(), mv->mesh_ptr(), mv->get_matrix(), extract_facets_info(*mv).facets_annotation.get_data() });
+    entry->slice_zs.reserve(print_object.layers().size());
+    for (const Layer *layer : print_object.layers())
+        entry->slice_zs.emplace_back(layer->slice_z);
+    entry->input_hashes = std::move(input_hashes);
+    entry->layer_bboxes = layer_bboxes;
+    return entry;
+}
+
+// Marks the layers, whose segmentation differs from the cached one: The layers with modified slices, their neighbors
+// (the EdgeGrid of a layer is sized by the neighbor layers), and the layers crossed by the repainted triangles.
+// The other volumes (modifiers, negative volumes, ...) only affect the segmentation through the slices.
+// Returns all layers if the cached segmentation was calculated from a different set of volumes or with a different layering.
+static std::vector<bool> layers_to_segment(const PrintObject &print_object, const SegmentationCache::Entry &current, const SegmentationCache::Entry *cached)
+{
+    const size_t num_layers = current.slice_zs.size();
+    if (cached == nullptr || cached->num_facets_states != current.num_facets_states || cached->center_offset != current.center_offset ||
+        cached->slice_zs != current.slice_zs || cached->volumes.size() != current.volumes.size())
+        return std::vector<bool>(num_layers, true);
+    for (size_t volume_idx = 0; volume_idx < current.volumes.size(); ++ volume_idx) {
+        const SegmentationCache::Entry::Volume &v1 = cached->volumes[volume_idx];
+        const SegmentationCache::Entry::Volume &v2 = current.volumes[volume_idx];
+        if (v1.id != v2.id || v1.mesh != v2.mesh || ! v1.matrix.isApprox(v2.matrix, EPSILON))
+            return std::vector<bool>(num_layers, true);
+    }
+
+    std::vector<bool> out(num_layers, false);
+    for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx)
+        if (const BoundingBox &bbox1 = cached->layer_bboxes[layer_idx], &bbox2 = current.layer_bboxes[layer_idx];
+            cached->input_hashes[layer_idx] != current.input_hashes[layer_idx] || bbox1.min != bbox2.min || bbox1.max != bbox2.max)
+            for (size_t i = layer_idx > 0 ? layer_idx - 1 : 0; i < std::min(layer_idx + 2, num_layers); ++ i)
+                out[i] = true;
+
+    for (size_t volume_idx = 0; volume_idx < current.volumes.size(); ++ volume_idx) {
+        const SegmentationCache::Entry::Volume &volume    = current.volumes[volume_idx];
+        const std::vector<int>                  repainted = repainted_triangles(cached->volumes[volume_idx].painting, volume.painting);
+        if (repainted.empty())
+            continue;
+        const indexed_triangle_set &its = volume.mesh->its;
+        const Transform3f           tr  = print_object.trafo().cast<float>() * volume.matrix.cast<float>();
+        for (int triangle_idx : repainted) {
+            if (triangle_idx < 0 || size_t(triangle_idx) >= its.indices.size())
+                return std::vector<bool>(num_layers, true);
+            float min_z = std::numeric_limits<float>::max();
+            float max_z = std::numeric_limits<float>::lowest();
+            for (int p_idx = 0; p_idx < 3; ++ p_idx) {
+                const float z = (tr * its.vertices[its.indices[triangle_idx](p_idx)]).z();
+                min_z = std::min(min_z, z);
+                max_z = std::max(max_z, z);
+            }
+            // The same layers as the projection of the painted triangles in segmentation_by_painting() visits, one more layer
+            // on each side to be safe against rounding.
+            size_t first = std::upper_bound(current.slice_zs.begin(), current.slice_zs.end(), float(min_z - EPSILON),
+                                            [](float z, coordf_t slice_z) { return z < slice_z; }) - current.slice_zs.begin();
+            size_t last  = std::upper_bound(current.slice_zs.begin(), current.slice_zs.end(), float(max_z + EPSILON),
+                                            [](float z, coordf_t slice_z) { return z < slice_z; }) - current.slice_zs.begin();
+            for (size_t i = first > 0 ? first - 1 : 0; i < std::min(last + 1, num_layers); ++ i)
+                out[i] = true;
+        }
+    }
+    return out;
+}
+
+// Hash of the parameters of cut_segmented_layers(), segmentation_top_and_bottom_layers() and merge_segmented_layers(),
+// which are not covered by the segmentation cache entry: the cut widths, the region configs and the layer heights.
+static size_t hash_merge_parameters(const PrintObject &print_object, const float segmentation_max_width, const float segmentation_interlocking_depth,
+                                    const bool segmentation_interlocking_beam, const IncludeTopAndBottomLayers include_top_and_bottom_layers)
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, segmentation_max_width);
+    boost::hash_combine(seed, segmentation_interlocking_depth);
+    boost::hash_combine(seed, segmentation_interlocking_beam);
+    boost::hash_combine(seed, include_top_and_bottom_layers == IncludeTopAndBottomLayers::Yes);
+    const double nozzle_diameter = print_object.print()->config().nozzle_diameter.get_at(0);
+    boost::hash_combine(seed, nozzle_diameter);
+    for (size_t i = 0; i < print_object.num_printing_regions(); ++ i) {
+        const PrintRegionConfig &config = print_object.printing_region(i).config();
+        boost::hash_combine(seed, config.top_shell_layers.value);
+        boost::hash_combine(seed, config.bottom_shell_layers.value);
+        boost::hash_combine(seed, config.wall_filament.value);
+        boost::hash_combine(seed, config.get_abs_value("outer_wall_line_width", nozzle_diameter));
+        boost::hash_combine(seed, config.gap_infill_speed.value > 0);
+    }
+    for (const Layer *layer : print_object.layers())
+        boost::hash_combine(seed, layer->height);
+    return seed;
+}
+
 std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject                                               &print_object,
                                                               const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
                                                               const size_t                                                     num_facets_states,
@@ -1959,7 +2240,8 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                                                               const float                                                      segmentation_interlocking_depth,
                                                               const bool                                                       segmentation_interlocking_beam,
                                                               const IncludeTopAndBottomLayers                                  include_top_and_bottom_layers,
-                                                              const std::function<void()>                                     &throw_on_cancel_callback)
+                                                              const std::function<void()>                                     &throw_on_cancel_callback,
+                                                              const SegmentationCache::Kind                                    cache_kind)
 {
     const size_t                          num_layers    = print_object.layers().size();
     std::vector<std::vector<ExPolygons>>  segmented_regions(num_layers);
@@ -1969,6 +2251,7 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
     std::vector<EdgeGrid::Grid>           edge_grids(num_layers);
     const ConstLayerPtrsAdaptor           layers = print_object.layers();
     std::vector<ExPolygons>               input_expolygons(num_layers);
+    std::vector<size_t>                   input_hashes(num_layers);
 
     throw_on_cancel_callback();
 
@@ -1978,7 +2261,7 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
 
     // Merge all regions and remove small holes
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Slices preprocessing in parallel - Begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&layers, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&layers, &input_expolygons, &input_hashes, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
             ExPolygons ex_polygons;
@@ -1998,6 +2281,7 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
             // This consequently leads to issues with the extraction of colored segments by function extract_colored_segments.
             // Calling expolygons_simplify fixed these issues.
             input_expolygons[layer_idx] = remove_duplicates(expolygons_simplify(offset_ex(ex_polygons, -10.f * float(SCALED_EPSILON)), 5 * SCALED_EPSILON), scaled<coord_t>(0.01), PI/6);
+            input_hashes[layer_idx]     = hash_expolygons(input_expolygons[layer_idx]);
 
 #ifdef MM_SEGMENTATION_DEBUG_INPUT
             export_processed_input_expolygons_to_svg(debug_out_path("mm-input-%d-%d.svg", layer_idx, iRun), layers[layer_idx]->regions(), input_expolygons[layer_idx]);
@@ -2013,8 +2297,19 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
         layer_bboxes[layer_idx].merge(get_extents(input_expolygons[layer_idx]));
     }
 
+    // Only the layers affected by a change of the painting or of the slices since the segmentation cached by the last run are segmented.
+    SegmentationCache                        *cache   = cache_kind == SegmentationCache::Kind::Uncached ? nullptr : print_object.print()->segmentation_cache();
+    std::unique_ptr<SegmentationCache::Entry> cached  = cache ? cache->take(print_object.model_object()->id(), cache_kind, print_object.trafo()) : nullptr;
+    std::unique_ptr<SegmentationCache::Entry> current = cache ?
+        make_segmentation_cache_entry(print_object, extract_facets_info, num_facets_states, cache_kind, std::move(input_hashes), layer_bboxes) : nullptr;
+    const std::vector<bool> segment_layer = current ? layers_to_segment(print_object, *current, cached.get()) : std::vector<bool>(num_layers, true);
+    const size_t            num_layers_to_segment = std::count(segment_layer.begin(), segment_layer.end(), true);
+    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers to segment: " << num_layers_to_segment << " of " << num_layers;
+
     for (size_t layer_idx = 0; layer_idx < num_layers; ++layer_idx) {
         throw_on_cancel_callback();
+        if (! segment_layer[layer_idx])
+            continue;
         BoundingBox bbox = layer_bboxes[layer_idx];
         // Projected triangles could, in rare cases (as in GH issue #7299), belongs to polygons printed in the previous or the next layer.
         // Let's merge the bounding box of the current layer with bounding boxes of the previous and the next layer to ensure that
@@ -2029,16 +2324,18 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
 
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Projection of painted triangles - Begin";
     for (const ModelVolume *mv : print_object.model_object()->volumes) {
+        if (num_layers_to_segment == 0)
+            break;
         const ModelVolumeFacetsInfo facets_info = extract_facets_info(*mv);
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_facets_states), [&mv, &print_object, &facets_info, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_facets_states), [&mv, &print_object, &facets_info, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &segment_layer, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
             for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
                 throw_on_cancel_callback();
                 const indexed_triangle_set custom_facets = facets_info.facets_annotation.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
+                if (!is_segmented_volume(*mv) || custom_facets.indices.empty())
                     continue;
 
                 const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_lines_mutex, &extruder_idx](const tbb::blocked_range<size_t> &range) {
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_lines_mutex, &segment_layer, &extruder_idx](const tbb::blocked_range<size_t> &range) {
                     for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++facet_idx) {
                         float min_z = std::numeric_limits<float>::max();
                         float max_z = std::numeric_limits<float>::lowest();
@@ -2066,7 +2363,7 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                         for (auto layer_it = first_layer; layer_it != (last_layer + 1); ++layer_it) {
                             const Layer *layer     = *layer_it;
                             size_t       layer_idx = layer_it - layers.begin();
-                            if (input_expolygons[layer_idx].empty() || is_less(layer->slice_z, facet[0].z()) || is_less(facet[2].z(), layer->slice_z))
+                            if (! segment_layer[layer_idx] || input_expolygons[layer_idx].empty() || is_less(layer->slice_z, facet[0].z()) || is_less(facet[2].z(), layer->slice_z))
                                 continue;
 
                             // https://kandepet.com/3d-printing-slicing-3d-objects/
@@ -2124,10 +2421,12 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
 
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_facets_states, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_facets_states, &segment_layer, &cached, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
-            if (!painted_lines[layer_idx].empty()) {
+            if (! segment_layer[layer_idx]) {
+                segmented_regions[layer_idx] = cached->segmented[layer_idx];
+            } else if (!painted_lines[layer_idx].empty()) {
 #ifdef MM_SEGMENTATION_DEBUG_PAINTED_LINES
                 export_painted_lines_to_svg(debug_out_path("0-mm-painted-lines-%d-%d.svg", layer_idx, iRun), {painted_lines[layer_idx]}, input_expolygons[layer_idx]);
 #endif // MM_SEGMENTATION_DEBUG_PAINTED_LINES
@@ -2166,21 +2465,53 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers segmentation in parallel - end";
     throw_on_cancel_callback();
 
+    // The segmentation is stored before it is modified by cut_segmented_layers().
+    if (current)
+        current->segmented = segmented_regions;
+
+    // The cut and the merge with the top and bottom layers only change at the segmented layers and at the layers the top
+    // and bottom shells of the segmented layers reach, unless their parameters changed. The other layers are copied from the cache.
+    std::vector<bool> merge_layer(num_layers, true);
+    if (current) {
+        current->merge_parameters_hash = hash_merge_parameters(print_object, segmentation_max_width, segmentation_interlocking_depth,
+                                                              segmentation_interlocking_beam, include_top_and_bottom_layers);
+        if (num_layers_to_segment < num_layers && cached->merge_parameters_hash == current->merge_parameters_hash) {
+            size_t shell_reach = 0;
+            if (include_top_and_bottom_layers == IncludeTopAndBottomLayers::Yes)
+                for (size_t i = 0; i < print_object.num_printing_regions(); ++ i) {
+                    const PrintRegionConfig &config = print_object.printing_region(i).config();
+                    shell_reach = std::max(shell_reach, size_t(std::max(config.top_shell_layers.value, config.bottom_shell_layers.value)));
+                }
+            // One more layer for the top and bottom surfaces, which are trimmed by the slices of the neighbor layers.
+            merge_layer = dilate_layers(segment_layer, shell_reach + 1);
+        }
+    }
+    const size_t num_layers_to_merge = std::count(merge_layer.begin(), merge_layer.end(), true);
+    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers to merge: " << num_layers_to_merge << " of " << num_layers;
+
     if ((segmentation_max_width > 0.f || segmentation_interlocking_depth > 0.f) && !segmentation_interlocking_beam) {
-        cut_segmented_layers(input_expolygons, segmented_regions, float(scale_(segmentation_max_width)), float(scale_(segmentation_interlocking_depth)), throw_on_cancel_callback);
+        cut_segmented_layers(input_expolygons, segmented_regions, float(scale_(segmentation_max_width)), float(scale_(segmentation_interlocking_depth)), merge_layer, throw_on_cancel_callback);
         throw_on_cancel_callback();
     }
 
     // The first index is extruder number (includes default extruder), and the second one is layer number
     std::vector<std::vector<ExPolygons>> top_and_bottom_layers;
     if (include_top_and_bottom_layers == IncludeTopAndBottomLayers::Yes) {
-        top_and_bottom_layers = segmentation_top_and_bottom_layers(print_object, input_expolygons, extract_facets_info, num_facets_states, throw_on_cancel_callback);
+        top_and_bottom_layers = segmentation_top_and_bottom_layers(print_object, input_expolygons, extract_facets_info, num_facets_states, merge_layer, throw_on_cancel_callback);
         throw_on_cancel_callback();
     }
 
-    std::vector<std::vector<ExPolygons>> segmented_regions_merged = merge_segmented_layers(segmented_regions, std::move(top_and_bottom_layers), num_facets_states, throw_on_cancel_callback);
+    std::vector<std::vector<ExPolygons>> segmented_regions_merged = merge_segmented_layers(segmented_regions, std::move(top_and_bottom_layers), num_facets_states, merge_layer, throw_on_cancel_callback);
     throw_on_cancel_callback();
 
+    if (current) {
+        for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx)
+            if (! merge_layer[layer_idx])
+                segmented_regions_merged[layer_idx] = cached->merged[layer_idx];
+        current->merged = segmented_regions_merged;
+        cache->put(std::move(current), num_layers_to_segment, num_layers - num_layers_to_segment, num_layers_to_merge);
+    }
+
 #ifdef MM_SEGMENTATION_DEBUG_REGIONS
     for (size_t layer_idx = 0; layer_idx < print_object.layers().size(); ++layer_idx)
         export_regions_to_svg(debug_out_path("4-mm-regions-merged-%d-%d.svg", layer_idx, iRun), segmented_regions_merged[layer_idx], input_expolygons[layer_idx]);
@@ -2204,7 +2535,8 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
         return {mv.mmu_segmentation_facets, mv.is_mm_painted(), false};
     };
 
-    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_width, interlocking_depth, interlocking_beam, IncludeTopAndBottomLayers::Yes, throw_on_cancel_callback);
+    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_width, interlocking_depth, interlocking_beam, IncludeTopAndBottomLayers::Yes, throw_on_cancel_callback,
+                                    SegmentationCache::Kind::MultiMaterial);
 }
 
 // Returns fuzzy skin segmentation based on painting in fuzzy skin segmentation gizmo
@@ -2223,7 +2555,8 @@ std::vector<std::vector<ExPolygons>> fuzzy_skin_segmentation_by_painting(const P
         max_external_perimeter_width = std::max<float>(max_external_perimeter_width, region.flow(print_object, frExternalPerimeter, print_object.config().layer_height).width());
     }
 
-    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_external_perimeter_width, 0.f, false, IncludeTopAndBottomLayers::No, throw_on_cancel_callback);
+    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_external_perimeter_width, 0.f, false, IncludeTopAndBottomLayers::No, throw_on_cancel_callback,
+                                    SegmentationCache::Kind::FuzzySkin);
 }
 
 } // namespace Slic3r
@@ -1,9 +1,14 @@
 #ifndef slic3r_MultiMaterialSegmentation_hpp_
 #define slic3r_MultiMaterialSegmentation_hpp_
 
+#include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
+#include "ObjectID.hpp"
+#include "Point.hpp"
+
 namespace Slic3r {
 
 class ExPolygon;
@@ -36,7 +41,54 @@ struct ModelVolumeFacetsInfo {
     const bool              replace_default_extruder;
 };
 
+// Per layer segmentation of the painted PrintObjects kept by Print over re-slicing.
+// Repainting an object invalidates its slicing, thus segmentation_by_painting() runs again from scratch. The segmentation
+// of a layer depends just on the slices of the layer and on the painted triangles crossing it, thus segmentation_by_painting()
+// compares the painting and the slices against the previous run and only segments the layers crossed by the repainted
+// triangles or with modified slices, the other layers are copied from the cache. The segmentation is cached both before and after
+// it is cut by the maximum width / interlocking depth and merged with the top / bottom layers. The cut and the merge are only
+// repeated for the segmented layers and for the layers their top / bottom shells reach.
+// Only the last max_entries segmentations are kept. All methods are thread safe.
+class SegmentationCache
+{
+public:
+    // Painting the segmentation is calculated from, the same PrintObject may be segmented by both.
+    enum class Kind {
+        Uncached,
+        MultiMaterial,
+        FuzzySkin
+    };
+
+    struct Entry;
+
+    explicit SegmentationCache(size_t max_entries = 8);
+    ~SegmentationCache();
+
+    // Removes the segmentation of a ModelObject sliced with the given transformation from the cache and returns it,
+    // thus the caller has an exclusive access to it until put back with put(). Returns null if not cached.
+    std::unique_ptr<Entry>  take(ObjectID model_object_id, Kind kind, const Transform3d &trafo);
+    void                    put(std::unique_ptr<Entry> entry, size_t layers_segmented, size_t layers_reused, size_t layers_merged);
+
+    void                    clear();
+    // Statistics of the layers segmented, of the layers reused and of the layers cut and merged with the top / bottom layers
+    // since the cache was created.
+    size_t                  layers_segmented() const;
+    size_t                  layers_reused() const;
+    size_t                  layers_merged() const;
+
+private:
+    mutable std::mutex                  m_mutex;
+    // The most recently used entry is at the back.
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    size_t                              m_max_entries;
+    size_t                              m_layers_segmented { 0 };
+    size_t                              m_layers_reused    { 0 };
+    size_t                              m_layers_merged    { 0 };
+};
+
 // Returns segmentation based on painting in segmentation gizmos.
+// With cache_kind other than Uncached, the segmentation of the previous run stored in Print::segmentation_cache() is reused
+// for the layers not affected by a change of the painting or of the slices.
 std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject                                               &print_object,
                                                               const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
                                                               size_t                                                           num_facets_states,
@@ -44,7 +96,8 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                                                               float                                                            segmentation_interlocking_depth,
                                                               bool                                                             segmentation_interlocking_beam,
                                                               IncludeTopAndBottomLayers                                        include_top_and_bottom_layers,
-                                                              const std::function<void()>                                     &throw_on_cancel_callback);
+                                                              const std::function<void()>                                     &throw_on_cancel_callback,
+                                                              SegmentationCache::Kind                                          cache_kind = SegmentationCache::Kind::Uncached);
 
 // Returns multi-material segmentation based on painting in multi-material segmentation gizmo
 std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
@@ -1630,10 +1630,17 @@ void PerimeterGenerator::process_classic()
         // collapse too narrow infill areas
         coord_t min_perimeter_infill_spacing = coord_t(solid_infill_spacing * (1. - INSET_OVERLAP_TOLERANCE));
 
-        ExPolygons infill_exp = offset2_ex(
-            not_filled_exp,
-            float(-inset - min_perimeter_infill_spacing / 2.),
-            float(min_perimeter_infill_spacing / 2.));
+        // The infill area and the infill area without the overlap share the inwards offset.
+        const bool has_no_overlap_offset2 = min_perimeter_infill_spacing / 2 > infill_peri_overlap;
+        std::vector<ExPolygons> infill_offsets = has_no_overlap_offset2 ?
+            offset2_ex_batch(not_filled_exp, {
+                { float(-inset - min_perimeter_infill_spacing / 2.), float(min_perimeter_infill_spacing / 2.) },
+                { float(-inset - min_perimeter_infill_spacing / 2.), float(min_perimeter_infill_spacing / 2 - infill_peri_overlap) } }) :
+            std::vector<ExPolygons>{ offset2_ex(
+                not_filled_exp,
+                float(-inset - min_perimeter_infill_spacing / 2.),
+                float(min_perimeter_infill_spacing / 2.)) };
+        ExPolygons infill_exp = std::move(infill_offsets.front());
         // append infill areas to fill_surfaces
         //if any top_fills, grow them by ext_perimeter_spacing/2 to have the real un-anchored fill
         ExPolygons top_infill_exp = intersection_ex(fill_clip, offset_ex(top_fills, double(ext_perimeter_spacing / 2)));
@@ -1647,11 +1654,8 @@ void PerimeterGenerator::process_classic()
         // BBS: get the no-overlap infill expolygons
         {
             ExPolygons polyWithoutOverlap;
-            if (min_perimeter_infill_spacing / 2 > infill_peri_overlap)
-                polyWithoutOverlap = offset2_ex(
-                    not_filled_exp,
-                    float(-inset - min_perimeter_infill_spacing / 2.),
-                    float(min_perimeter_infill_spacing / 2 - infill_peri_overlap));
+            if (has_no_overlap_offset2)
+                polyWithoutOverlap = std::move(infill_offsets.back());
             else
                 polyWithoutOverlap = offset_ex(
                     not_filled_exp,
@@ -1692,9 +1696,13 @@ void PerimeterGenerator::add_infill_contour_for_arachne( ExPolygons        infil
     for (ExPolygon &ex : infill_contour)
         ex.simplify_p(m_scaled_resolution, &inner_pp);
 
-    this->fill_surfaces->append(offset2_ex(union_ex(inner_pp), float(-min_perimeter_infill_spacing / 2.), float(insert + min_perimeter_infill_spacing / 2.)), stInternal);
+    // Both the infill area and the infill area without the overlap are offsetted inwards by the same distance first.
+    std::vector<ExPolygons> infill_offsets = offset2_ex_batch(union_ex(inner_pp), {
+        { float(-min_perimeter_infill_spacing / 2.), float(insert + min_perimeter_infill_spacing / 2.) },
+        { float(-min_perimeter_infill_spacing / 2.), float(+min_perimeter_infill_spacing / 2.) } });
+    this->fill_surfaces->append(std::move(infill_offsets.front()), stInternal);
 
-    append(*this->fill_no_overlap, offset2_ex(union_ex(inner_pp), float(-min_perimeter_infill_spacing / 2.), float(+min_perimeter_infill_spacing / 2.)));
+    append(*this->fill_no_overlap, std::move(infill_offsets.back()));
 }
 
 // Orca: sacrificial bridge layer algorithm ported from SuperSlicer
@@ -2151,7 +2159,7 @@ void PerimeterGenerator::process_arachne()
         
         Polygons   last_p = to_polygons(last);
         Arachne::WallToolPaths wallToolPaths(last_p, bead_width_0, perimeter_spacing, coord_t(loop_number + 1),
-                                               wall_0_inset, layer_height, input_params_tmp);
+                                               wall_0_inset, layer_height, input_params_tmp, this->wall_toolpaths_cache);
         std::vector<Arachne::VariableWidthLines>   perimeters = wallToolPaths.getToolPaths();
         ExPolygons  infill_contour = union_ex(wallToolPaths.getInnerContour());
 
@@ -2202,7 +2210,7 @@ void PerimeterGenerator::process_arachne()
                 top_expolygons = intersection_ex(top_expolygons, infill_contour);
 
                 const Polygons not_top_polygons = to_polygons(offset_ex(not_top_expolygons,wall_0_inset));
-                Arachne::WallToolPaths inner_wall_tool_paths(not_top_polygons, perimeter_spacing, perimeter_spacing, coord_t(inner_loop_number + 1), 0, layer_height, input_params_tmp);
+                Arachne::WallToolPaths inner_wall_tool_paths(not_top_polygons, perimeter_spacing, perimeter_spacing, coord_t(inner_loop_number + 1), 0, layer_height, input_params_tmp, this->wall_toolpaths_cache);
                 std::vector<Arachne::VariableWidthLines> inner_perimeters = inner_wall_tool_paths.getToolPaths();
 
                 // Recalculate indexes of inner perimeters before merging them.
@@ -2220,7 +2228,7 @@ void PerimeterGenerator::process_arachne()
             } else {
                 // There is no top surface ExPolygon, so we call Arachne again with parameters
                 // like when the single perimeter feature is disabled.
-                Arachne::WallToolPaths no_single_perimeter_tool_paths(last_p, bead_width_0, perimeter_spacing, coord_t(inner_loop_number + 2), wall_0_inset, layer_height, input_params_tmp);
+                Arachne::WallToolPaths no_single_perimeter_tool_paths(last_p, bead_width_0, perimeter_spacing, coord_t(inner_loop_number + 2), wall_0_inset, layer_height, input_params_tmp, this->wall_toolpaths_cache);
                 perimeters     = no_single_perimeter_tool_paths.getToolPaths();
                 infill_contour = union_ex(no_single_perimeter_tool_paths.getInnerContour());
             }
@@ -59,6 +59,10 @@ template<> struct hash<Slic3r::FuzzySkinConfig>
 
 namespace Slic3r {
 
+namespace Arachne {
+    class WallToolPathsCache;
+}
+
 class PerimeterGenerator {
 public:
     // Inputs:
@@ -77,6 +81,8 @@ public:
     const PrintRegionConfig     *config;
     const PrintObjectConfig     *object_config;
     const PrintConfig           *print_config;
+    // Optional cache of the Arachne toolpaths shared by the layers of a PrintObject.
+    Arachne::WallToolPathsCache *wall_toolpaths_cache { nullptr };
     // Outputs:
     ExtrusionEntityCollection   *loops;
     ExtrusionEntityCollection   *gap_fill;
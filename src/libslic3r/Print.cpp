@@ -18,6 +18,9 @@
 #include "PrintConfig.hpp"
 #include "Model.hpp"
 #include "format.hpp"
+#include "SliceCache.hpp"
+#include "Fill/FillAdaptive.hpp"
+#include "MultiMaterialSegmentation.hpp"
 #include <float.h>
 
 #include <algorithm>
@@ -66,6 +69,240 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    this->clear_adaptive_fill_octree_cache();
+}
+
+void Print::clear_adaptive_fill_octree_cache()
+{
+    if (m_adaptive_fill_octree_cache)
+        m_adaptive_fill_octree_cache->clear();
+}
+
+// Cache the plenty of parameters, which influence the G-code generator only,
+// or they are only notes not influencing the generated G-code.
+static const std::unordered_set<std::string> print_config_keys_gcode = {
+    //BBS
+    "additional_cooling_fan_speed",
+    "reduce_crossing_wall",
+    "max_travel_detour_distance",
+    "printable_area",
+    //BBS: add bed_exclude_area
+    "bed_exclude_area",
+    "thumbnail_size",
+    "before_layer_change_gcode",
+    "enable_pressure_advance",
+    "pressure_advance",
+    "enable_overhang_bridge_fan",
+    "overhang_fan_speed",
+    "overhang_fan_threshold",
+    "slow_down_for_layer_cooling",
+    "default_acceleration",
+    "deretraction_speed",
+    "close_fan_the_first_x_layers",
+    "machine_end_gcode",
+    "printing_by_object_gcode",
+    "filament_end_gcode",
+    "post_process",
+    "extruder_clearance_height_to_rod",
+    "extruder_clearance_height_to_lid",
+    "extruder_clearance_radius",
+    "nozzle_height",
+    "extruder_colour",
+    "extruder_offset",
+    "filament_flow_ratio",
+    "reduce_fan_stop_start_freq",
+    "dont_slow_down_outer_wall",
+    "fan_cooling_layer_time",
+    "full_fan_speed_layer",
+    "fan_kickstart",
+    "fan_speedup_overhangs",
+    "fan_speedup_time",
+    "filament_colour",
+    "default_filament_colour",
+    "filament_diameter",
+    "filament_density",
+    "filament_cost",
+    "filament_notes",
+    "outer_wall_acceleration",
+    "inner_wall_acceleration",
+    "initial_layer_acceleration",
+    "top_surface_acceleration",
+    "bridge_acceleration",
+    "travel_acceleration",
+    "sparse_infill_acceleration",
+    "internal_solid_infill_acceleration",
+    // BBS
+    "supertack_plate_temp_initial_layer",
+    "cool_plate_temp_initial_layer",
+    "textured_cool_plate_temp_initial_layer",
+    "eng_plate_temp_initial_layer",
+    "hot_plate_temp_initial_layer",
+    "textured_plate_temp_initial_layer",
+    "gcode_add_line_number",
+    "layer_change_gcode",
+    "time_lapse_gcode",
+    "fan_min_speed",
+    "fan_max_speed",
+    "printable_height",
+    "slow_down_min_speed",
+    "max_volumetric_extrusion_rate_slope",
+    "max_volumetric_extrusion_rate_slope_segment_length",
+    "extrusion_rate_smoothing_external_perimeter_only",
+    "reduce_infill_retraction",
+    "filename_format",
+    "retraction_minimum_travel",
+    "retract_before_wipe",
+    "retract_when_changing_layer",
+    "retraction_length",
+    "retract_length_toolchange",
+    "z_hop",
+    "travel_slope",
+    "retract_lift_above",
+    "retract_lift_below", 
+    "retract_lift_enforce",
+    "retract_restart_extra",
+    "retract_restart_extra_toolchange",
+    "retraction_speed",
+    "use_firmware_retraction",
+    "slow_down_layer_time",
+    "standby_temperature_delta",
+    "preheat_time",
+    "preheat_steps",
+    "machine_start_gcode",
+    "filament_start_gcode",
+    "change_filament_gcode",
+    "wipe",
+    // BBS
+    "wipe_distance",
+    "curr_bed_type",
+    "nozzle_volume",
+    "nozzle_hrc",
+    "required_nozzle_HRC",
+    "upward_compatible_machine",
+    "is_infill_first",
+    // Orca
+    "chamber_temperature",
+    "thumbnails",
+    "thumbnails_format",
+    "seam_gap",
+    "role_based_wipe_speed",
+    "wipe_speed",
+    "use_relative_e_distances",
+    "accel_to_decel_enable",
+    "accel_to_decel_factor",
+    "wipe_on_loops",
+    "gcode_comments",
+    "gcode_label_objects", 
+    "exclude_object",
+    "support_material_interface_fan_speed",
+    "internal_bridge_fan_speed", // ORCA: Add support for separate internal bridge fan speed control
+    "ironing_fan_speed",
+    "single_extruder_multi_material_priming",
+    "activate_air_filtration",
+    "during_print_exhaust_fan_speed",
+    "complete_print_exhaust_fan_speed",
+    "activate_chamber_temp_control",
+    "manual_filament_change",
+    "auto_toolchange_command",
+    "disable_m73",
+    "use_firmware_retraction",
+    "enable_long_retraction_when_cut",
+    "long_retractions_when_cut",
+    "retraction_distances_when_cut",
+    "filament_long_retractions_when_cut",
+    "filament_retraction_distances_when_cut"
+};
+
+// Parameters, which influence the skirt and brim only.
+static const std::unordered_set<std::string> print_config_keys_skirt_brim = {
+    "skirt_type",
+    "skirt_loops",
+    "skirt_speed",
+    "skirt_height",
+    "min_skirt_length",
+    "single_loop_draft_shield",
+    "draft_shield",
+    "skirt_distance",
+    "skirt_start_angle",
+    "ooze_prevention",
+    "wipe_tower_x",
+    "wipe_tower_y",
+    "wipe_tower_rotation_angle"
+};
+
+// Parameters, which influence the wipe tower and the skirt and brim, which is placed around the wipe tower too.
+static const std::unordered_set<std::string> print_config_keys_wipe_tower = {
+    "print_sequence",
+    "filament_type",
+    "chamber_temperature",
+    "nozzle_temperature_initial_layer",
+    "filament_minimal_purge_on_wipe_tower",
+    "filament_max_volumetric_speed",
+    "filament_loading_speed",
+    "filament_loading_speed_start",
+    "filament_unloading_speed",
+    "filament_unloading_speed_start",
+    "filament_toolchange_delay",
+    "filament_cooling_moves",
+    "filament_stamping_loading_speed",
+    "filament_stamping_distance",
+    "filament_cooling_initial_speed",
+    "filament_cooling_final_speed",
+    "filament_ramming_parameters",
+    "filament_multitool_ramming",
+    "filament_multitool_ramming_volume",
+    "filament_multitool_ramming_flow",
+    "filament_max_volumetric_speed",
+    "gcode_flavor",
+    "single_extruder_multi_material",
+    "nozzle_temperature",
+    // BBS
+    "supertack_plate_temp",
+    "cool_plate_temp",
+    "textured_cool_plate_temp",
+    "eng_plate_temp",
+    "hot_plate_temp",
+    "textured_plate_temp",
+    "enable_prime_tower",
+    "prime_tower_width",
+    "prime_tower_brim_width",
+    "first_layer_print_sequence",
+    "other_layers_print_sequence",
+    "other_layers_print_sequence_nums",
+    "wipe_tower_bridging",
+    "wipe_tower_extra_flow",
+    "wipe_tower_no_sparse_layers",
+    "flush_volumes_matrix",
+    "prime_volume",
+    "flush_into_infill",
+    "flush_into_support",
+    "initial_layer_infill_speed",
+    "travel_speed",
+    "travel_speed_z",
+    "initial_layer_speed",
+    "initial_layer_travel_speed",
+    "slow_down_layers",
+    "idle_temperature",
+    "wipe_tower_cone_angle",
+    "wipe_tower_extra_spacing",
+    "wipe_tower_max_purge_speed",
+    "wipe_tower_wall_type",
+    "wipe_tower_extra_rib_length",
+    "wipe_tower_rib_width",
+    "wipe_tower_fillet_wall",
+    "wipe_tower_filament",
+    "wiping_volumes_extruders",
+    "enable_filament_ramming",
+    "purge_in_prime_tower",
+    "z_offset",
+    "support_multi_bed_types"
+};
+
+bool Print::is_config_option_of_print_steps_only(const t_config_option_key &opt_key)
+{
+    return print_config_keys_gcode.find(opt_key) != print_config_keys_gcode.end()
+        || print_config_keys_skirt_brim.find(opt_key) != print_config_keys_skirt_brim.end()
+        || print_config_keys_wipe_tower.find(opt_key) != print_config_keys_wipe_tower.end();
 }
 
 // Called by Print::apply().
@@ -75,141 +312,6 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
     if (opt_keys.empty())
         return false;
 
-    // Cache the plenty of parameters, which influence the G-code generator only,
-    // or they are only notes not influencing the generated G-code.
-    static std::unordered_set<std::string> steps_gcode = {
-        //BBS
-        "additional_cooling_fan_speed",
-        "reduce_crossing_wall",
-        "max_travel_detour_distance",
-        "printable_area",
-        //BBS: add bed_exclude_area
-        "bed_exclude_area",
-        "thumbnail_size",
-        "before_layer_change_gcode",
-        "enable_pressure_advance",
-        "pressure_advance",
-        "enable_overhang_bridge_fan",
-        "overhang_fan_speed",
-        "overhang_fan_threshold",
-        "slow_down_for_layer_cooling",
-        "default_acceleration",
-        "deretraction_speed",
-        "close_fan_the_first_x_layers",
-        "machine_end_gcode",
-        "printing_by_object_gcode",
-        "filament_end_gcode",
-        "post_process",
-        "extruder_clearance_height_to_rod",
-        "extruder_clearance_height_to_lid",
-        "extruder_clearance_radius",
-        "nozzle_height",
-        "extruder_colour",
-        "extruder_offset",
-        "filament_flow_ratio",
-        "reduce_fan_stop_start_freq",
-        "dont_slow_down_outer_wall",
-        "fan_cooling_layer_time",
-        "full_fan_speed_layer",
-        "fan_kickstart",
-        "fan_speedup_overhangs",
-        "fan_speedup_time",
-        "filament_colour",
-        "default_filament_colour",
-        "filament_diameter",
-        "filament_density",
-        "filament_cost",
-        "filament_notes",
-        "outer_wall_acceleration",
-        "inner_wall_acceleration",
-        "initial_layer_acceleration",
-        "top_surface_acceleration",
-        "bridge_acceleration",
-        "travel_acceleration",
-        "sparse_infill_acceleration",
-        "internal_solid_infill_acceleration",
-        // BBS
-        "supertack_plate_temp_initial_layer",
-        "cool_plate_temp_initial_layer",
-        "textured_cool_plate_temp_initial_layer",
-        "eng_plate_temp_initial_layer",
-        "hot_plate_temp_initial_layer",
-        "textured_plate_temp_initial_layer",
-        "gcode_add_line_number",
-        "layer_change_gcode",
-        "time_lapse_gcode",
-        "fan_min_speed",
-        "fan_max_speed",
-        "printable_height",
-        "slow_down_min_speed",
-        "max_volumetric_extrusion_rate_slope",
-        "max_volumetric_extrusion_rate_slope_segment_length",
-        "extrusion_rate_smoothing_external_perimeter_only",
-        "reduce_infill_retraction",
-        "filename_format",
-        "retraction_minimum_travel",
-        "retract_before_wipe",
-        "retract_when_changing_layer",
-        "retraction_length",
-        "retract_length_toolchange",
-        "z_hop",
-        "travel_slope",
-        "retract_lift_above",
-        "retract_lift_below", 
-        "retract_lift_enforce",
-        "retract_restart_extra",
-        "retract_restart_extra_toolchange",
-        "retraction_speed",
-        "use_firmware_retraction",
-        "slow_down_layer_time",
-        "standby_temperature_delta",
-        "preheat_time",
-        "preheat_steps",
-        "machine_start_gcode",
-        "filament_start_gcode",
-        "change_filament_gcode",
-        "wipe",
-        // BBS
-        "wipe_distance",
-        "curr_bed_type",
-        "nozzle_volume",
-        "nozzle_hrc",
-        "required_nozzle_HRC",
-        "upward_compatible_machine",
-        "is_infill_first",
-        // Orca
-        "chamber_temperature",
-        "thumbnails",
-        "thumbnails_format",
-        "seam_gap",
-        "role_based_wipe_speed",
-        "wipe_speed",
-        "use_relative_e_distances",
-        "accel_to_decel_enable",
-        "accel_to_decel_factor",
-        "wipe_on_loops",
-        "gcode_comments",
-        "gcode_label_objects", 
-        "exclude_object",
-        "support_material_interface_fan_speed",
-        "internal_bridge_fan_speed", // ORCA: Add support for separate internal bridge fan speed control
-        "ironing_fan_speed",
-        "single_extruder_multi_material_priming",
-        "activate_air_filtration",
-        "during_print_exhaust_fan_speed",
-        "complete_print_exhaust_fan_speed",
-        "activate_chamber_temp_control",
-        "manual_filament_change",
-        "auto_toolchange_command",
-        "disable_m73",
-        "use_firmware_retraction",
-        "enable_long_retraction_when_cut",
-        "long_retractions_when_cut",
-        "retraction_distances_when_cut",
-        "filament_long_retractions_when_cut",
-        "filament_retraction_distances_when_cut"
-    };
-
     static std::unordered_set<std::string> steps_ignore;
 
     std::vector<PrintStep> steps;
@@ -217,26 +319,13 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
     bool invalidated = false;
 
     for (const t_config_option_key &opt_key : opt_keys) {
-        if (steps_gcode.find(opt_key) != steps_gcode.end()) {
+        if (print_config_keys_gcode.find(opt_key) != print_config_keys_gcode.end()) {
             // These options only affect G-code export or they are just notes without influence on the generated G-code,
             // so there is nothing to invalidate.
             steps.emplace_back(psGCodeExport);
         } else if (steps_ignore.find(opt_key) != steps_ignore.end()) {
             // These steps have no influence on the G-code whatsoever. Just ignore them.
-        } else if (
-               opt_key == "skirt_type"
-            || opt_key == "skirt_loops"
-            || opt_key == "skirt_speed"
-            || opt_key == "skirt_height"
-            || opt_key == "min_skirt_length"
-            || opt_key == "single_loop_draft_shield"
-            || opt_key == "draft_shield"
-            || opt_key == "skirt_distance"
-            || opt_key == "skirt_start_angle"
-            || opt_key == "ooze_prevention"
-            || opt_key == "wipe_tower_x"
-            || opt_key == "wipe_tower_y"
-            || opt_key == "wipe_tower_rotation_angle") {
+        } else if (print_config_keys_skirt_brim.find(opt_key) != print_config_keys_skirt_brim.end()) {
             steps.emplace_back(psSkirtBrim);
         } else if (
                opt_key == "initial_layer_print_height"
@@ -250,72 +339,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
             // Therefore toggling the Spiral Vase on / off requires complete reslicing.
             || opt_key == "spiral_mode") {
             osteps.emplace_back(posSlice);
-        } else if (
-               opt_key == "print_sequence"
-            || opt_key == "filament_type"
-            || opt_key == "chamber_temperature"
-            || opt_key == "nozzle_temperature_initial_layer"
-            || opt_key == "filament_minimal_purge_on_wipe_tower"
-            || opt_key == "filament_max_volumetric_speed"
-            || opt_key == "filament_loading_speed"
-            || opt_key == "filament_loading_speed_start"
-            || opt_key == "filament_unloading_speed"
-            || opt_key == "filament_unloading_speed_start"
-            || opt_key == "filament_toolchange_delay"
-            || opt_key == "filament_cooling_moves"
-            || opt_key == "filament_stamping_loading_speed"
-            || opt_key == "filament_stamping_distance"
-            || opt_key == "filament_cooling_initial_speed"
-            || opt_key == "filament_cooling_final_speed"
-            || opt_key == "filament_ramming_parameters"
-            || opt_key == "filament_multitool_ramming"
-            || opt_key == "filament_multitool_ramming_volume"
-            || opt_key == "filament_multitool_ramming_flow"
-            || opt_key == "filament_max_volumetric_speed"
-            || opt_key == "gcode_flavor"
-            || opt_key == "single_extruder_multi_material"
-            || opt_key == "nozzle_temperature"
-            // BBS
-            || opt_key == "supertack_plate_temp"
-            || opt_key == "cool_plate_temp"
-            || opt_key == "textured_cool_plate_temp"
-            || opt_key == "eng_plate_temp"
-            || opt_key == "hot_plate_temp"
-            || opt_key == "textured_plate_temp"
-            || opt_key == "enable_prime_tower"
-            || opt_key == "prime_tower_width"
-            || opt_key == "prime_tower_brim_width"
-            || opt_key == "first_layer_print_sequence"
-            || opt_key == "other_layers_print_sequence"
-            || opt_key == "other_layers_print_sequence_nums" 
-            || opt_key == "wipe_tower_bridging"
-            || opt_key == "wipe_tower_extra_flow"
-            || opt_key == "wipe_tower_no_sparse_layers"
-            || opt_key == "flush_volumes_matrix"
-            || opt_key == "prime_volume"
-            || opt_key == "flush_into_infill"
-            || opt_key == "flush_into_support"
-            || opt_key == "initial_layer_infill_speed"
-            || opt_key == "travel_speed"
-            || opt_key == "travel_speed_z"
-            || opt_key == "initial_layer_speed"
-            || opt_key == "initial_layer_travel_speed"
-            || opt_key == "slow_down_layers"
-            || opt_key == "idle_temperature"
-            || opt_key == "wipe_tower_cone_angle"
-            || opt_key == "wipe_tower_extra_spacing"
-            || opt_key == "wipe_tower_max_purge_speed"
-            || opt_key == "wipe_tower_wall_type"
-            || opt_key == "wipe_tower_extra_rib_length"
-            || opt_key == "wipe_tower_rib_width"
-            || opt_key == "wipe_tower_fillet_wall"
-            || opt_key == "wipe_tower_filament"
-            || opt_key == "wiping_volumes_extruders"
-            || opt_key == "enable_filament_ramming"
-            || opt_key == "purge_in_prime_tower"
-            || opt_key == "z_offset"
-            || opt_key == "support_multi_bed_types"
-            ) {
+        } else if (print_config_keys_wipe_tower.find(opt_key) != print_config_keys_wipe_tower.end()) {
             steps.emplace_back(psWipeTower);
             steps.emplace_back(psSkirtBrim);
         } else if (opt_key == "filament_soluble"
@@ -1853,6 +1877,7 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
         *time_cost_with_cache = 0;
 
     name_tbb_thread_pool_threads_set_locale();
+    m_step_stats.clear();
 
     //compute the PrintObject with the same geometries
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, enter, use_cache=%2%, object size=%3%")%this%use_cache%m_objects.size();
@@ -1958,72 +1983,108 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
 
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": total object counts %1% in current print, need to slice %2%")%m_objects.size()%need_slicing_objects.size();
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
+    // Shared by the objects processed in parallel below, thus created upfront.
+    if (! m_adaptive_fill_octree_cache)
+        m_adaptive_fill_octree_cache = std::make_shared<FillAdaptive::OctreeCache>();
+    if (! m_segmentation_cache)
+        m_segmentation_cache = std::make_shared<SegmentationCache>();
+    if (! m_seam_visibility_cache)
+        m_seam_visibility_cache = std::make_shared<SeamVisibilityCache>();
     if (!use_cache) {
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->make_perimeters();
-            }
-            else {
-                if (obj->set_started(posSlice))
-                    obj->set_done(posSlice);
-                if (obj->set_started(posPerimeters))
-                    obj->set_done(posPerimeters);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->estimate_curled_extrusions();
-            }
-            else {
-                if (obj->set_started(posEstimateCurledExtrusions))
-                    obj->set_done(posEstimateCurledExtrusions);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->infill();
-            }
-            else {
-                if (obj->set_started(posPrepareInfill))
-                    obj->set_done(posPrepareInfill);
-                if (obj->set_started(posInfill))
-                    obj->set_done(posInfill);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->ironing();
-            }
-            else {
-                if (obj->set_started(posIroning))
-                    obj->set_done(posIroning);
-            }
-        }
-
-        tbb::parallel_for(tbb::blocked_range<int>(0, int(m_objects.size())),
-            [this, need_slicing_objects](const tbb::blocked_range<int>& range) {
-                for (int i = range.begin(); i < range.end(); i++) {
-                    PrintObject* obj = m_objects[i];
-                    if (need_slicing_objects.count(obj) != 0) {
-                        obj->generate_support_material();
-                    }
-                    else {
-                        if (obj->set_started(posSupportMaterial))
-                            obj->set_done(posSupportMaterial);
-                    }
+        // Each PrintObject runs its own step chain (perimeters -> curled extrusions -> infill -> ironing -> support -> overhangs for lift),
+        // the chains of different objects are independent of each other. Running them as independent tasks lets the objects overlap,
+        // which matters on plates with many small objects, where the per-layer parallel loops inside each step are too short to saturate the cores.
+        // The step state is still tracked by set_started() / set_done() of each object, cancelation is checked between the steps.
+        // The objects sharing the geometry of another object are marked done only after all the chains finished, see below.
+        static constexpr size_t num_object_steps = 6;
+        // Called after each finished step of an object chain, for progress reporting.
+        std::function<void(size_t)> object_steps_done = [](size_t) {};
+        auto process_object_steps = [this, &object_steps_done](PrintObject *obj) {
+            // Only an object to be sliced from scratch is looked up in the slice cache, partially invalidated objects
+            // are cheaper to finish than to reload.
+            std::string cache_key;
+            if (m_slice_cache && ! obj->is_step_done(posSlice)) {
+                cache_key = SliceCache::print_object_key(*obj);
+                // The entry contains the curled extrusions too.
+                if (this->load_object_from_slice_cache(obj, cache_key)) {
+                    object_steps_done(num_object_steps);
+                    return;
                 }
             }
-        );
-
-        for (PrintObject* obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->detect_overhangs_for_lift();
-            }
-            else {
-                if (obj->set_started(posDetectOverhangsForLift))
-                    obj->set_done(posDetectOverhangsForLift);
+            obj->make_perimeters();
+            object_steps_done(1);
+            this->throw_if_canceled();
+            obj->estimate_curled_extrusions();
+            object_steps_done(1);
+            this->throw_if_canceled();
+            obj->infill();
+            object_steps_done(1);
+            this->throw_if_canceled();
+            obj->ironing();
+            object_steps_done(1);
+            this->throw_if_canceled();
+            obj->generate_support_material();
+            object_steps_done(1);
+            this->throw_if_canceled();
+            obj->detect_overhangs_for_lift();
+            object_steps_done(1);
+            if (! cache_key.empty())
+                this->store_object_to_slice_cache(obj, cache_key);
+        };
+
+        std::vector<PrintObject*> objects_to_process;
+        for (PrintObject *obj : m_objects)
+            if (need_slicing_objects.count(obj) != 0)
+                objects_to_process.emplace_back(obj);
+        if (objects_to_process.size() <= 1) {
+            for (PrintObject *obj : objects_to_process)
+                process_object_steps(obj);
+        } else {
+            // The steps report their progress through set_status() with the percentage of a single object. With the objects
+            // running concurrently these percentages would jump back and forth, thus the percentage is replaced by the share
+            // of the finished object steps, reported in an increasing order. Statuses without a percentage (warnings) pass through.
+            std::mutex                 status_mutex;
+            std::atomic<size_t>        num_steps_done { 0 };
+            const size_t               num_steps_total = objects_to_process.size() * num_object_steps;
+            std::string                last_status_text;
+            status_callback_type       status_callback = m_status_callback;
+            auto aggregate_percent = [&num_steps_done, num_steps_total]() {
+                return 5 + int((70 - 5) * std::min(num_steps_done.load(), num_steps_total) / num_steps_total);
+            };
+            ScopeGuard restore_status_callback;
+            if (status_callback) {
+                m_status_callback = [&](const SlicingStatus &status) {
+                    std::lock_guard<std::mutex> lock(status_mutex);
+                    if (status.percent < 0) {
+                        status_callback(status);
+                    } else {
+                        last_status_text = status.text;
+                        SlicingStatus aggregated = status;
+                        aggregated.percent = aggregate_percent();
+                        status_callback(aggregated);
+                    }
+                };
+                restore_status_callback = ScopeGuard([this, &status_callback, &object_steps_done]() {
+                    m_status_callback = status_callback;
+                    object_steps_done = [](size_t) {};
+                });
+                object_steps_done = [&](size_t num_steps) {
+                    num_steps_done += num_steps;
+                    std::lock_guard<std::mutex> lock(status_mutex);
+                    status_callback(SlicingStatus(aggregate_percent(), last_status_text));
+                };
             }
+            BOOST_LOG_TRIVIAL(debug) << "Processing objects in parallel - start";
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_to_process.size(), 1),
+                [&objects_to_process, &process_object_steps](const tbb::blocked_range<size_t>& range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i)
+                        process_object_steps(objects_to_process[i]);
+                });
+            this->throw_if_canceled();
+            BOOST_LOG_TRIVIAL(debug) << "Processing objects in parallel - end";
         }
+        if (m_slice_cache)
+            m_slice_cache->log_statistics();
     }
     else {
         for (PrintObject *obj : m_objects) {
@@ -2057,6 +2118,12 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
     for (PrintObject *obj : m_objects)
     {
         if (need_slicing_objects.count(obj) == 0) {
+            if (! use_cache)
+                // Shared object, its source object finished all its steps above, the layers are copied from it.
+                for (PrintObjectStep step : { posSlice, posPerimeters, posEstimateCurledExtrusions, posPrepareInfill, posInfill, posIroning,
+                                              posSupportMaterial, posDetectOverhangsForLift })
+                    if (obj->set_started(step))
+                        obj->set_done(step);
             obj->copy_layers_from_shared_object();
             obj->copy_layers_overhang_from_shared_object();
         }
@@ -2208,6 +2275,36 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
     }
 
     BOOST_LOG_TRIVIAL(info) << "Slicing process finished." << log_memory_info();
+    BOOST_LOG_TRIVIAL(debug) << "Slicing steps:\n" << format_step_stats(this->step_stats());
+}
+
+void Print::fill_step_stats(int step, PrintStepStats &stats) const
+{
+    switch (PrintStep(step)) {
+    case psWipeTower:
+        stats.step_name = "wipe_tower";
+        stats.layers    = size_t(m_tool_ordering.end() - m_tool_ordering.begin());
+        break;
+    case psSkirtBrim:
+        stats.step_name = "skirt_brim";
+        stats.paths     = m_skirt.items_count();
+        for (const auto &[object_id, brim] : m_brimMap)
+            stats.paths += brim.items_count();
+        for (const auto &[object_id, brim] : m_supportBrimMap)
+            stats.paths += brim.items_count();
+        break;
+    case psGCodeExport:
+        stats.step_name = "gcode_export";
+        for (const PrintObject *object : m_objects)
+            stats.layers += object->layer_count() + object->support_layer_count();
+        break;
+    case psConflictCheck:
+        stats.step_name = "conflict_check";
+        break;
+    default:
+        stats.step_name = "step " + std::to_string(step);
+        break;
+    }
 }
 
 // G-code export process, running at a background thread.
@@ -3862,54 +3959,292 @@ static void from_json(const json& j, groupedVolumeSlices& firstlayer_group)
     }
 }
 
-int Print::export_cached_data(const std::string& directory, bool with_space)
+static void convert_layer_to_json(json& layer_json, const Layer* layer)
 {
-    int ret = 0;
-    boost::filesystem::path directory_path(directory);
+    json slice_polygons_json = json::array(), slice_bboxs_json = json::array(), overhang_polygons_json = json::array(), layer_regions_json = json::array();
+    layer_json[JSON_LAYER_PRINT_Z] = layer->print_z;
+    layer_json[JSON_LAYER_HEIGHT] = layer->height;
+    layer_json[JSON_LAYER_SLICE_Z] = layer->slice_z;
+    layer_json[JSON_LAYER_ID] = layer->id();
+    //layer_json["slicing_errors"] = layer->slicing_errors;
+
+    //sliced_polygons
+    for (const ExPolygon& slice_polygon : layer->lslices) {
+        json slice_polygon_json = slice_polygon;
+        slice_polygons_json.push_back(std::move(slice_polygon_json));
+    }
+    layer_json[JSON_LAYER_SLICED_POLYGONS] = std::move(slice_polygons_json);
+
+    //sliced_bbox
+    for (const BoundingBox& slice_bbox : layer->lslices_bboxes) {
+        json bbox_json = json::array();
+
+        bbox_json = slice_bbox;
+        slice_bboxs_json.push_back(std::move(bbox_json));
+    }
+    layer_json[JSON_LAYER_SLLICED_BBOXES] = std::move(slice_bboxs_json);
+
+    //overhang_polygons
+    for (const ExPolygon& overhang_polygon : layer->loverhangs) {
+        json overhang_polygon_json = overhang_polygon;
+        overhang_polygons_json.push_back(std::move(overhang_polygon_json));
+    }
+    layer_json[JSON_LAYER_OVERHANG_POLYGONS] = std::move(overhang_polygons_json);
+
+    //overhang_box
+    layer_json[JSON_LAYER_OVERHANG_BBOX] = layer->loverhangs_bbox;
+
+    for (const LayerRegion *layer_region : layer->regions()) {
+        json region_json = *layer_region;
+
+        layer_regions_json.push_back(std::move(region_json));
+    }
+    layer_json[JSON_LAYER_REGIONS] = std::move(layer_regions_json);
+
+    return;
+}
+
+// Serialize the layers, the support layers and the first layer groups of a PrintObject into root_json.
+static void print_object_to_json(const PrintObject *obj, json &root_json)
+{
+    json layers_json = json::array(), support_layers_json = json::array(), first_layer_groups = json::array();
 
-    auto convert_layer_to_json = [](json& layer_json, const Layer* layer) {
-        json slice_polygons_json = json::array(), slice_bboxs_json = json::array(), overhang_polygons_json = json::array(), layer_regions_json = json::array();
-        layer_json[JSON_LAYER_PRINT_Z] = layer->print_z;
-        layer_json[JSON_LAYER_HEIGHT] = layer->height;
-        layer_json[JSON_LAYER_SLICE_Z] = layer->slice_z;
-        layer_json[JSON_LAYER_ID] = layer->id();
-        //layer_json["slicing_errors"] = layer->slicing_errors;
-
-        //sliced_polygons
-        for (const ExPolygon& slice_polygon : layer->lslices) {
-            json slice_polygon_json = slice_polygon;
-            slice_polygons_json.push_back(std::move(slice_polygon_json));
+    //export the layers
+    std::vector<json> layers_json_vector(obj->layer_count());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, obj->layer_count()),
+        [&layers_json_vector, obj](const tbb::blocked_range<size_t>& layer_range) {
+            for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
+                const Layer *layer = obj->get_layer(layer_index);
+                json layer_json;
+                convert_layer_to_json(layer_json, layer);
+                layers_json_vector[layer_index] = std::move(layer_json);
+            }
         }
-        layer_json[JSON_LAYER_SLICED_POLYGONS] = std::move(slice_polygons_json);
+    );
+    for (int l_index = 0; l_index < layers_json_vector.size(); l_index++) {
+        layers_json.push_back(std::move(layers_json_vector[l_index]));
+    }
+    layers_json_vector.clear();
 
-        //sliced_bbox
-        for (const BoundingBox& slice_bbox : layer->lslices_bboxes) {
-            json bbox_json = json::array();
+    root_json[JSON_LAYERS] = std::move(layers_json);
+
+    //export the support layers
+    std::vector<json> support_layers_json_vector(obj->support_layer_count());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, obj->support_layer_count()),
+        [&support_layers_json_vector, obj](const tbb::blocked_range<size_t>& support_layer_range) {
+            for (size_t s_layer_index = support_layer_range.begin(); s_layer_index < support_layer_range.end(); ++ s_layer_index) {
+                const SupportLayer *support_layer = obj->support_layers()[s_layer_index];
+                json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
+
+                convert_layer_to_json(support_layer_json, support_layer);
 
-            bbox_json = slice_bbox;
-            slice_bboxs_json.push_back(std::move(bbox_json));
+                support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
+                support_layer_json[JSON_SUPPORT_LAYER_TYPE] = support_layer->support_type;
+
+                //support_islands
+                for (const ExPolygon& support_island : support_layer->support_islands) {
+                    json support_island_json = support_island;
+                    support_islands_json.push_back(std::move(support_island_json));
+                }
+                support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
+
+                //support_fills
+                support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
+                support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
+                for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
+                    json supportfill_entity_json, supportfill_entity_paths_json = json::array();
+                    bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
+                    if (!ret)
+                        continue;
+
+                    supportfills_entities_json.push_back(std::move(supportfill_entity_json));
+                }
+                support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
+                support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
+
+                support_layers_json_vector[s_layer_index] = std::move(support_layer_json);
+            }
         }
-        layer_json[JSON_LAYER_SLLICED_BBOXES] = std::move(slice_bboxs_json);
+    );
+    for (int s_index = 0; s_index < support_layers_json_vector.size(); s_index++) {
+        support_layers_json.push_back(std::move(support_layers_json_vector[s_index]));
+    }
+    support_layers_json_vector.clear();
+    root_json[JSON_SUPPORT_LAYERS] = std::move(support_layers_json);
+
+    const std::vector<groupedVolumeSlices> &first_layer_obj_groups =  obj->firstLayerObjGroups();
+    for (size_t s_group_index = 0; s_group_index < first_layer_obj_groups.size(); ++ s_group_index) {
+        groupedVolumeSlices group = first_layer_obj_groups[s_group_index];
 
-        //overhang_polygons
-        for (const ExPolygon& overhang_polygon : layer->loverhangs) {
-            json overhang_polygon_json = overhang_polygon;
-            overhang_polygons_json.push_back(std::move(overhang_polygon_json));
+        //convert the id
+        for (ObjectID& obj_id : group.volume_ids)
+        {
+            const ModelVolume* currentModelVolumePtr = nullptr;
+            //BBS: support shared object logic
+            const PrintObject* shared_object = obj->get_shared_object();
+            if (!shared_object)
+                shared_object = obj;
+            const ModelVolumePtrs& volumes_ptr = shared_object->model_object()->volumes;
+            size_t volume_count = volumes_ptr.size();
+            for (size_t index = 0; index < volume_count; index ++) {
+                currentModelVolumePtr = volumes_ptr[index];
+                if (currentModelVolumePtr->id() == obj_id) {
+                    obj_id.id = index;
+                    break;
+                }
+            }
         }
-        layer_json[JSON_LAYER_OVERHANG_POLYGONS] = std::move(overhang_polygons_json);
 
-        //overhang_box
-        layer_json[JSON_LAYER_OVERHANG_BBOX] = layer->loverhangs_bbox;
+        json first_layer_group_json;
 
-        for (const LayerRegion *layer_region : layer->regions()) {
-            json region_json = *layer_region;
+        first_layer_group_json = group;
+        first_layer_groups.push_back(std::move(first_layer_group_json));
+    }
+    root_json[JSON_FIRSTLAYER_GROUPS] = std::move(first_layer_groups);
+}
 
-            layer_regions_json.push_back(std::move(region_json));
+static const PrintRegion* find_region(PrintObject* object, size_t config_hash)
+{
+    int regions_count = object->num_printing_regions();
+    for (int index = 0; index < regions_count; index++ )
+    {
+        const PrintRegion&  print_region = object->printing_region(index);
+        if (print_region.config_hash() == config_hash ) {
+            return &print_region;
         }
-        layer_json[JSON_LAYER_REGIONS] = std::move(layer_regions_json);
+    }
+    return NULL;
+}
+
+// Recreate the layers, the support layers and the first layer groups of a PrintObject from root_json.
+// Returns 0 on success, or one of the CLI_* error codes.
+static int print_object_from_json(PrintObject *obj, json &root_json, const std::string &file_name)
+{
+    std::string name = root_json.at(JSON_OBJECT_NAME);
+    int identify_id = root_json.at(JSON_IDENTIFY_ID);
+    int layer_count = 0, support_layer_count = 0, firstlayer_group_count = 0;
+
+    layer_count = root_json[JSON_LAYERS].size();
+    support_layer_count = root_json[JSON_SUPPORT_LAYERS].size();
+    firstlayer_group_count = root_json[JSON_FIRSTLAYER_GROUPS].size();
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(":will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%, firstlayer_group_count %5%")
+        %name %identify_id %layer_count %support_layer_count %firstlayer_group_count;
+
+    Layer* previous_layer = NULL;
+    //create layer and layer regions
+    for (int index = 0; index < layer_count; index++)
+    {
+        json& layer_json = root_json[JSON_LAYERS][index];
+        Layer* new_layer = obj->add_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z], layer_json[JSON_LAYER_SLICE_Z]);
+        if (!new_layer) {
+            BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":create_layer failed, out of memory");
+            return CLI_OUT_OF_MEMORY;
+        }
+        if (previous_layer) {
+            previous_layer->upper_layer = new_layer;
+            new_layer->lower_layer = previous_layer;
+        }
+        previous_layer = new_layer;
+
+        //layer regions
+        int layer_regions_count = layer_json[JSON_LAYER_REGIONS].size();
+        for (int region_index = 0; region_index < layer_regions_count; region_index++)
+        {
+            json& region_json = layer_json[JSON_LAYER_REGIONS][region_index];
+            size_t config_hash = region_json[JSON_LAYER_REGION_CONFIG_HASH];
+            const PrintRegion *print_region = find_region(obj, config_hash);
+
+            if (!print_region){
+                BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":can not find print region of object %1%, layer %2%, print_z %3%, layer_region %4%")
+                    %name % index %new_layer->print_z %region_index;
+                //delete new_layer;
+                return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+            }
+
+            new_layer->add_region(print_region);
+        }
+
+    }
+
+    //load the layer data parallel
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": load the layers in parallel");
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, obj->layer_count()),
+        [&root_json, &obj](const tbb::blocked_range<size_t>& layer_range) {
+            for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
+                const json& layer_json = root_json[JSON_LAYERS][layer_index];
+                Layer* layer = obj->get_layer(layer_index);
+                extract_layer(layer_json, *layer);
+            }
+        }
+    );
+
+    //support layers
+    Layer* previous_support_layer = NULL;
+    //create support_layers
+    for (int index = 0; index < support_layer_count; index++)
+    {
+        json& layer_json = root_json[JSON_SUPPORT_LAYERS][index];
+        SupportLayer* new_support_layer = obj->add_support_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z]);
+        if (!new_support_layer) {
+            BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":add_support_layer failed, out of memory");
+            return CLI_OUT_OF_MEMORY;
+        }
+        if (previous_support_layer) {
+            previous_support_layer->upper_layer = new_support_layer;
+            new_support_layer->lower_layer = previous_support_layer;
+        }
+        previous_support_layer = new_support_layer;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": finished load layers, start to load support_layers.");
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, obj->support_layer_count()),
+        [&root_json, &obj](const tbb::blocked_range<size_t>& support_layer_range) {
+            for (size_t layer_index = support_layer_range.begin(); layer_index < support_layer_range.end(); ++ layer_index) {
+                const json& layer_json = root_json[JSON_SUPPORT_LAYERS][layer_index];
+                SupportLayer* support_layer = obj->get_support_layer(layer_index);
+                extract_support_layer(layer_json, *support_layer);
+            }
+        }
+    );
+
+    //load first group volumes
+    std::vector<groupedVolumeSlices>& firstlayer_objgroups = obj->firstLayerObjGroupsMod();
+    for (int index = 0; index < firstlayer_group_count; index++)
+    {
+        json& firstlayer_group_json = root_json[JSON_FIRSTLAYER_GROUPS][index];
+        groupedVolumeSlices firstlayer_group = firstlayer_group_json;
+        //convert the id
+        for (ObjectID& obj_id : firstlayer_group.volume_ids)
+        {
+            ModelVolume* currentModelVolumePtr = nullptr;
+            ModelVolumePtrs& volumes_ptr = obj->model_object()->volumes;
+            size_t volume_count = volumes_ptr.size();
+            if (obj_id.id < volume_count) {
+                currentModelVolumePtr = volumes_ptr[obj_id.id];
+                obj_id = currentModelVolumePtr->id();
+            }
+            else {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
+                    %obj_id.id %file_name %volume_count;
+                return CLI_IMPORT_CACHE_LOAD_FAILED;
+            }
+        }
+        firstlayer_objgroups.push_back(std::move(firstlayer_group));
+    }
+
+    return 0;
+}
+
+int Print::export_cached_data(const std::string& directory, bool with_space)
+{
+    int ret = 0;
+    boost::filesystem::path directory_path(directory);
 
-        return;
-    };
 
     //firstly clear this directory
     if (fs::exists(directory_path)) {
@@ -3945,154 +4280,13 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
 
         try {
-            json root_json, layers_json = json::array(), support_layers_json = json::array(), first_layer_groups = json::array();
-
+            json root_json;
             root_json[JSON_OBJECT_NAME] = model_obj->name;
             root_json[JSON_IDENTIFY_ID] = identify_id;
-
-            //export the layers
-            std::vector<json> layers_json_vector(obj->layer_count());
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, obj->layer_count()),
-                [&layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& layer_range) {
-                    for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
-                        const Layer *layer = obj->get_layer(layer_index);
-                        json layer_json;
-                        convert_layer_to_json(layer_json, layer);
-                        layers_json_vector[layer_index] = std::move(layer_json);
-                    }
-                }
-            );
-            for (int l_index = 0; l_index < layers_json_vector.size(); l_index++) {
-                layers_json.push_back(std::move(layers_json_vector[l_index]));
-            }
-            layers_json_vector.clear();
-            /*for (const Layer *layer : obj->layers()) {
-                // for each layer
-                json layer_json;
-
-                convert_layer_to_json(layer_json, layer);
-
-                layers_json.push_back(std::move(layer_json));
-            }*/
-
-            root_json[JSON_LAYERS] = std::move(layers_json);
-
-            //export the support layers
-            std::vector<json> support_layers_json_vector(obj->support_layer_count());
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, obj->support_layer_count()),
-                [&support_layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& support_layer_range) {
-                    for (size_t s_layer_index = support_layer_range.begin(); s_layer_index < support_layer_range.end(); ++ s_layer_index) {
-                        const SupportLayer *support_layer = obj->get_support_layer(s_layer_index);
-                        json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
-
-                        convert_layer_to_json(support_layer_json, support_layer);
-
-                        support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
-                        support_layer_json[JSON_SUPPORT_LAYER_TYPE] = support_layer->support_type;
-
-                        //support_islands
-                        for (const ExPolygon& support_island : support_layer->support_islands) {
-                            json support_island_json = support_island;
-                            support_islands_json.push_back(std::move(support_island_json));
-                        }
-                        support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
-
-                        //support_fills
-                        support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
-                        support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
-                        for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
-                            json supportfill_entity_json, supportfill_entity_paths_json = json::array();
-                            bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
-                            if (!ret)
-                                continue;
-
-                            supportfills_entities_json.push_back(std::move(supportfill_entity_json));
-                        }
-                        support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
-                        support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
-
-                        support_layers_json_vector[s_layer_index] = std::move(support_layer_json);
-                    }
-                }
-            );
-            for (int s_index = 0; s_index < support_layers_json_vector.size(); s_index++) {
-                support_layers_json.push_back(std::move(support_layers_json_vector[s_index]));
-            }
-            support_layers_json_vector.clear();
-
-            /*for (const SupportLayer *support_layer : obj->support_layers()) {
-                json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
-
-                convert_layer_to_json(support_layer_json, support_layer);
-
-                support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
-
-                //support_islands
-                for (const ExPolygon& support_island : support_layer->support_islands.expolygons) {
-                    json support_island_json = support_island;
-                    support_islands_json.push_back(std::move(support_island_json));
-                }
-                support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
-
-                //support_fills
-                support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
-                support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
-                for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
-                    json supportfill_entity_json, supportfill_entity_paths_json = json::array();
-                    bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
-                    if (!ret)
-                        continue;
-
-                    supportfills_entities_json.push_back(std::move(supportfill_entity_json));
-                }
-                support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
-                support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
-
-                support_layers_json.push_back(std::move(support_layer_json));
-            } // for each layer*/
-            root_json[JSON_SUPPORT_LAYERS] = std::move(support_layers_json);
-
-            const std::vector<groupedVolumeSlices> &first_layer_obj_groups =  obj->firstLayerObjGroups();
-            for (size_t s_group_index = 0; s_group_index < first_layer_obj_groups.size(); ++ s_group_index) {
-                groupedVolumeSlices group = first_layer_obj_groups[s_group_index];
-
-                //convert the id
-                for (ObjectID& obj_id : group.volume_ids)
-                {
-                    const ModelVolume* currentModelVolumePtr = nullptr;
-                    //BBS: support shared object logic
-                    const PrintObject* shared_object = obj->get_shared_object();
-                    if (!shared_object)
-                        shared_object = obj;
-                    const ModelVolumePtrs& volumes_ptr = shared_object->model_object()->volumes;
-                    size_t volume_count = volumes_ptr.size();
-                    for (size_t index = 0; index < volume_count; index ++) {
-                        currentModelVolumePtr = volumes_ptr[index];
-                        if (currentModelVolumePtr->id() == obj_id) {
-                            obj_id.id = index;
-                            break;
-                        }
-                    }
-                }
-
-                json first_layer_group_json;
-
-                first_layer_group_json = group;
-                first_layer_groups.push_back(std::move(first_layer_group_json));
-            }
-            root_json[JSON_FIRSTLAYER_GROUPS] = std::move(first_layer_groups);
+            print_object_to_json(obj, root_json);
 
             filename_vector.push_back(file_name);
             json_vector.push_back(std::move(root_json));
-            /*boost::nowide::ofstream c;
-            c.open(file_name, std::ios::out | std::ios::trunc);
-            if (with_space)
-                c << std::setw(4) << root_json << std::endl;
-            else
-                c << root_json.dump(0) << std::endl;
-            c.close();*/
             count ++;
             BOOST_LOG_TRIVIAL(info) << boost::format("will dump object %1%'s json to %2%.")%model_obj->name%file_name;
         }
@@ -4140,18 +4334,6 @@ int Print::load_cached_data(const std::string& directory)
         return CLI_IMPORT_CACHE_NOT_FOUND;
     }
 
-    auto find_region = [this](PrintObject* object, size_t config_hash) -> const PrintRegion* {
-        int regions_count = object->num_printing_regions();
-        for (int index = 0; index < regions_count; index++ )
-        {
-            const PrintRegion&  print_region = object->printing_region(index);
-            if (print_region.config_hash() == config_hash ) {
-                return &print_region;
-            }
-        }
-        return NULL;
-    };
-
     int count = 0;
     std::vector<std::pair<std::string, PrintObject*>> object_filenames;
     for (PrintObject *obj : m_objects) {
@@ -4212,120 +4394,8 @@ int Print::load_cached_data(const std::string& directory)
             //boost::nowide::ifstream ifs(file_name);
             //ifs >> root_json;
 
-            std::string name = root_json.at(JSON_OBJECT_NAME);
-            int identify_id = root_json.at(JSON_IDENTIFY_ID);
-            int layer_count = 0, support_layer_count = 0, firstlayer_group_count = 0;
-
-            layer_count = root_json[JSON_LAYERS].size();
-            support_layer_count = root_json[JSON_SUPPORT_LAYERS].size();
-            firstlayer_group_count = root_json[JSON_FIRSTLAYER_GROUPS].size();
-
-            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(":will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%, firstlayer_group_count %5%")
-                %name %identify_id %layer_count %support_layer_count %firstlayer_group_count;
-
-            Layer* previous_layer = NULL;
-            //create layer and layer regions
-            for (int index = 0; index < layer_count; index++)
-            {
-                json& layer_json = root_json[JSON_LAYERS][index];
-                Layer* new_layer = obj->add_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z], layer_json[JSON_LAYER_SLICE_Z]);
-                if (!new_layer) {
-                    BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":create_layer failed, out of memory");
-                    return CLI_OUT_OF_MEMORY;
-                }
-                if (previous_layer) {
-                    previous_layer->upper_layer = new_layer;
-                    new_layer->lower_layer = previous_layer;
-                }
-                previous_layer = new_layer;
-
-                //layer regions
-                int layer_regions_count = layer_json[JSON_LAYER_REGIONS].size();
-                for (int region_index = 0; region_index < layer_regions_count; region_index++)
-                {
-                    json& region_json = layer_json[JSON_LAYER_REGIONS][region_index];
-                    size_t config_hash = region_json[JSON_LAYER_REGION_CONFIG_HASH];
-                    const PrintRegion *print_region = find_region(obj, config_hash);
-
-                    if (!print_region){
-                        BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":can not find print region of object %1%, layer %2%, print_z %3%, layer_region %4%")
-                            %name % index %new_layer->print_z %region_index;
-                        //delete new_layer;
-                        return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
-                    }
-
-                    new_layer->add_region(print_region);
-                }
-
-            }
-
-            //load the layer data parallel
-            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": load the layers in parallel");
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, obj->layer_count()),
-                [&root_json, &obj](const tbb::blocked_range<size_t>& layer_range) {
-                    for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
-                        const json& layer_json = root_json[JSON_LAYERS][layer_index];
-                        Layer* layer = obj->get_layer(layer_index);
-                        extract_layer(layer_json, *layer);
-                    }
-                }
-            );
-
-            //support layers
-            Layer* previous_support_layer = NULL;
-            //create support_layers
-            for (int index = 0; index < support_layer_count; index++)
-            {
-                json& layer_json = root_json[JSON_SUPPORT_LAYERS][index];
-                SupportLayer* new_support_layer = obj->add_support_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z]);
-                if (!new_support_layer) {
-                    BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":add_support_layer failed, out of memory");
-                    return CLI_OUT_OF_MEMORY;
-                }
-                if (previous_support_layer) {
-                    previous_support_layer->upper_layer = new_support_layer;
-                    new_support_layer->lower_layer = previous_support_layer;
-                }
-                previous_support_layer = new_support_layer;
-            }
-
-            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": finished load layers, start to load support_layers.");
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, obj->support_layer_count()),
-                [&root_json, &obj](const tbb::blocked_range<size_t>& support_layer_range) {
-                    for (size_t layer_index = support_layer_range.begin(); layer_index < support_layer_range.end(); ++ layer_index) {
-                        const json& layer_json = root_json[JSON_SUPPORT_LAYERS][layer_index];
-                        SupportLayer* support_layer = obj->get_support_layer(layer_index);
-                        extract_support_layer(layer_json, *support_layer);
-                    }
-                }
-            );
-
-            //load first group volumes
-            std::vector<groupedVolumeSlices>& firstlayer_objgroups = obj->firstLayerObjGroupsMod();
-            for (int index = 0; index < firstlayer_group_count; index++)
-            {
-                json& firstlayer_group_json = root_json[JSON_FIRSTLAYER_GROUPS][index];
-                groupedVolumeSlices firstlayer_group = firstlayer_group_json;
-                //convert the id
-                for (ObjectID& obj_id : firstlayer_group.volume_ids)
-                {
-                    ModelVolume* currentModelVolumePtr = nullptr;
-                    ModelVolumePtrs& volumes_ptr = obj->model_object()->volumes;
-                    size_t volume_count = volumes_ptr.size();
-                    if (obj_id.id < volume_count) {
-                        currentModelVolumePtr = volumes_ptr[obj_id.id];
-                        obj_id = currentModelVolumePtr->id();
-                    }
-                    else {
-                        BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": can not find volume_id %1% from object file %2% in firstlayer groups, volume_count %3%!")
-                            %obj_id.id %object_filenames[obj_index].first %volume_count;
-                        return CLI_IMPORT_CACHE_LOAD_FAILED;
-                    }
-                }
-                firstlayer_objgroups.push_back(std::move(firstlayer_group));
-            }
+            if (int load_ret = print_object_from_json(obj, root_json, object_filenames[obj_index].first); load_ret != 0)
+                return load_ret;
 
             count ++;
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": load object %1% from %2% successfully.")%count%object_filenames[obj_index].first;
@@ -4346,6 +4416,129 @@ int Print::load_cached_data(const std::string& directory)
     return ret;
 }
 
+#define JSON_SLICE_CACHE_WARNINGS       "slice_cache_warnings"
+#define JSON_SLICE_CACHE_CURLED_LINES   "slice_cache_curled_lines"
+
+// Steps, whose results are stored in a slice cache entry, together with their warnings.
+static const PrintObjectStep SLICE_CACHE_STEPS[] = { posSlice, posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportMaterial, posDetectOverhangsForLift };
+
+bool Print::load_object_from_slice_cache(PrintObject *obj, const std::string &key)
+{
+    std::string file_name = m_slice_cache->lookup(key);
+    if (file_name.empty())
+        return false;
+
+    int ret = 0;
+    // Warnings of the cached steps, reported again when the steps are marked done.
+    std::vector<std::pair<PrintObjectStep, PrintStateBase::Warning>> warnings;
+    try {
+        json root_json;
+        boost::nowide::ifstream ifs(file_name);
+        ifs >> root_json;
+        obj->clear_layers();
+        obj->clear_support_layers();
+        obj->firstLayerObjGroupsMod().clear();
+        ret = print_object_from_json(obj, root_json, file_name);
+        if (ret == 0) {
+            // Layer::curled_lines as [a.x, a.y, b.x, b.y, curled_height] per line, produced by PrintObject::estimate_curled_extrusions().
+            const json &curled_json = root_json.at(JSON_SLICE_CACHE_CURLED_LINES);
+            if (curled_json.size() != obj->layer_count())
+                throw Slic3r::RuntimeError("curled lines do not match the layers");
+            for (size_t layer_idx = 0; layer_idx < obj->layer_count(); ++ layer_idx) {
+                CurledLines &curled_lines = obj->get_layer(int(layer_idx))->curled_lines;
+                curled_lines.clear();
+                curled_lines.reserve(curled_json[layer_idx].size());
+                for (const json &line_json : curled_json[layer_idx])
+                    curled_lines.emplace_back(Point(line_json.at(0).get<coord_t>(), line_json.at(1).get<coord_t>()),
+                                              Point(line_json.at(2).get<coord_t>(), line_json.at(3).get<coord_t>()), line_json.at(4).get<float>());
+            }
+        }
+        if (ret == 0 && root_json.contains(JSON_SLICE_CACHE_WARNINGS))
+            for (const json &warning_json : root_json[JSON_SLICE_CACHE_WARNINGS]) {
+                PrintStateBase::Warning warning;
+                warning.level      = warning_json.at("level").get<int>() == int(PrintStateBase::WarningLevel::CRITICAL) ?
+                    PrintStateBase::WarningLevel::CRITICAL : PrintStateBase::WarningLevel::NON_CRITICAL;
+                warning.current    = true;
+                warning.message    = warning_json.at("message").get<std::string>();
+                warning.message_id = warning_json.at("message_id").get<int>();
+                warnings.emplace_back(PrintObjectStep(warning_json.at("step").get<int>()), std::move(warning));
+            }
+    }
+    catch(std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": load from "<<file_name<<" got a generic exception, reason = " << err.what();
+        ret = CLI_IMPORT_CACHE_LOAD_FAILED;
+    }
+    if (ret != 0) {
+        // Corrupted or incompatible entry, slice the object from scratch.
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__<< boost::format(": failed to load %1% from the slice cache, ret=%2%, will reslice it")%obj->model_object()->name %ret;
+        obj->clear_layers();
+        obj->clear_support_layers();
+        obj->firstLayerObjGroupsMod().clear();
+        m_slice_cache->remove(key);
+        return false;
+    }
+    m_slice_cache->loaded(key);
+
+    for (PrintObjectStep step : SLICE_CACHE_STEPS)
+        if (obj->set_started(step)) {
+            for (const auto &[warning_step, warning] : warnings)
+                if (warning_step == step)
+                    obj->active_step_add_warning(warning.level, warning.message, PrintStateBase::SlicingNotificationType(warning.message_id));
+            obj->set_done(step);
+        }
+    // The cached slices are typed by posPrepareInfill, revert them to untyped slices when the perimeters or infill are invalidated.
+    obj->m_typed_slices = true;
+    return true;
+}
+
+void Print::store_object_to_slice_cache(const PrintObject *obj, const std::string &key)
+{
+    // Only the conversion to JSON reads the layers and it runs on the slicing thread,
+    // the JSON is dumped and written to disk by the background thread of the cache.
+    const auto start_time = std::chrono::steady_clock::now();
+    auto root_json = std::make_shared<json>();
+    try {
+        (*root_json)[JSON_OBJECT_NAME] = obj->model_object()->name;
+        (*root_json)[JSON_IDENTIFY_ID] = 0;
+        print_object_to_json(obj, *root_json);
+        json warnings_json = json::array();
+        for (PrintObjectStep step : SLICE_CACHE_STEPS)
+            for (const PrintStateBase::Warning &warning : obj->step_state_with_warnings(step).warnings)
+                warnings_json.push_back({ { "step", int(step) }, { "level", int(warning.level) }, { "message", warning.message }, { "message_id", warning.message_id } });
+        (*root_json)[JSON_SLICE_CACHE_WARNINGS] = std::move(warnings_json);
+        json curled_json = json::array();
+        for (const Layer *layer : obj->layers()) {
+            json layer_json = json::array();
+            for (const CurledLine &line : layer->curled_lines)
+                layer_json.push_back({ line.a.x(), line.a.y(), line.b.x(), line.b.y(), line.curled_height });
+            curled_json.push_back(std::move(layer_json));
+        }
+        (*root_json)[JSON_SLICE_CACHE_CURLED_LINES] = std::move(curled_json);
+    }
+    catch(std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": failed to serialize "<<obj->model_object()->name<<" for the slice cache, reason = " << err.what();
+        return;
+    }
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": serialized %1% for the slice cache in %2% ms")%obj->model_object()->name
+        %std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    m_slice_cache->store_in_background(key, [root_json](const std::string &file_name) {
+        try {
+            boost::nowide::ofstream c;
+            c.open(file_name, std::ios::out | std::ios::trunc);
+            c << root_json->dump(0) << std::endl;
+            c.close();
+            if (c.fail())
+                throw Slic3r::RuntimeError("write failed");
+        }
+        catch(std::exception &err) {
+            BOOST_LOG_TRIVIAL(error) << "store_object_to_slice_cache: save to "<<file_name<<" got a generic exception, reason = " << err.what();
+            return false;
+        }
+        return true;
+    });
+}
+
 BoundingBoxf3 PrintInstance::get_bounding_box() {
     return print_object->model_object()->instance_bounding_box(*model_instance, false);
 }
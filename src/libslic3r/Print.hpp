@@ -22,6 +22,7 @@
 #include <Eigen/Geometry>
 
 #include <functional>
+#include <optional>
 #include <set>
 
 #include "calib.hpp"
@@ -33,6 +34,9 @@ class Layer;
 class ModelObject;
 class Print;
 class PrintObject;
+class SliceCache;
+class SegmentationCache;
+class SeamVisibilityCache;
 class SupportLayer;
 // BBS
 class TreeSupportData;
@@ -64,6 +68,8 @@ namespace FillAdaptive {
     struct Octree;
     struct OctreeDeleter;
     using OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
+    using OctreeSharedPtr = std::shared_ptr<Octree>;
+    class OctreeCache;
 };
 
 namespace FillLightning {
@@ -72,6 +78,10 @@ namespace FillLightning {
     using GeneratorPtr = std::unique_ptr<Generator, GeneratorDeleter>;
 }; // namespace FillLightning
 
+namespace Arachne {
+    class WallToolPathsCache;
+}; // namespace Arachne
+
 // Print step IDs for keeping track of the print state.
 // The Print steps are applied in this order.
 enum PrintStep {
@@ -398,6 +408,8 @@ public:
     SupportLayer* add_tree_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z);
     std::shared_ptr<TreeSupportData> alloc_tree_support_preview_cache();
     void clear_tree_support_preview_cache() { m_tree_support_preview_cache.reset(); }
+    // Shared by the layers while generating Arachne perimeters, nullptr with the classic perimeter generator.
+    Arachne::WallToolPathsCache* wall_toolpaths_cache() const;
 
     size_t          support_layer_count() const { return m_support_layers.size(); }
     void            clear_support_layers();
@@ -483,8 +495,11 @@ public:
     bool                    invalidate_all_steps();
     // Invalidate steps based on a set of parameters changed.
     // It may be called for both the PrintObjectConfig and PrintRegionConfig.
+    // If the PrintRegionConfig of a layer range modifier changed, layer_range is its Z span (in object coordinates)
+    // and only the layers around the span are reprocessed, if the slices stay valid, see dirty_layers().
     bool                    invalidate_state_by_config_options(
-        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
+        const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+        const t_layer_height_range *layer_range = nullptr);
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
@@ -499,6 +514,20 @@ private:
     void estimate_curled_extrusions();
     void simplify_extrusion_path();
 
+    // Spans [first, last) of the layers reprocessed after the steps were invalidated by layer range modifiers only.
+    struct DirtyLayers {
+        // Layers getting new walls.
+        std::pair<size_t, size_t> perimeters;
+        // Layers getting new infill regions, infill and ironing.
+        std::pair<size_t, size_t> infill;
+        // Layers run through prepare_infill(), so that the layers getting new infill regions see the same neighbours
+        // as in a full run. The layers outside of the infill span keep their infill regions.
+        std::pair<size_t, size_t> prepare_infill;
+    };
+    DirtyLayers dirty_layers() const;
+    // Maximum number of top / bottom shell layers over all regions, the shell thickness counted in the thinnest layers.
+    size_t      shell_layers() const;
+
     void slice_volumes();
     //BBS
     ExPolygons _shrink_contour_holes(double contour_delta, double hole_delta, const ExPolygons& polys) const;
@@ -509,18 +538,21 @@ private:
    void _transform_hole_to_polyholes();
 
     // Has any support (not counting the raft).
-    void detect_surfaces_type();
-    void process_external_surfaces();
-    void discover_vertical_shells();
-    void bridge_over_infill();
+    // The steps of prepare_infill() rewrite the layers of layer_range [first, last) only, they read the layers around it.
+    void detect_surfaces_type(std::pair<size_t, size_t> layer_range);
+    void process_external_surfaces(std::pair<size_t, size_t> layer_range);
+    void discover_vertical_shells(std::pair<size_t, size_t> layer_range);
+    void bridge_over_infill(std::pair<size_t, size_t> layer_range);
     void clip_fill_surfaces();
-    void discover_horizontal_shells();
+    void discover_horizontal_shells(std::pair<size_t, size_t> layer_range);
     void combine_infill();
     void _generate_support_material();
-    std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> prepare_adaptive_infill_data(
+    std::pair<FillAdaptive::OctreeSharedPtr, FillAdaptive::OctreeSharedPtr> prepare_adaptive_infill_data(
         const std::vector<std::pair<const Surface*, float>>& surfaces_w_bottom_z) const;
     FillLightning::GeneratorPtr prepare_lightning_infill_data();
 
+    void fill_step_stats(int step, PrintStepStats &stats) const override;
+
     // BBS
     SupportNecessaryType is_support_necessary();
 
@@ -549,9 +581,16 @@ private:
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                    				m_typed_slices = false;
+    // Z span (in object coordinates) of the layers, whose walls, infill regions or infill are stale after posPerimeters, posPrepareInfill
+    // or posInfill were invalidated by layer range modifiers only. The layers away from the span keep their results, see dirty_layers().
+    // std::nullopt means all layers are stale. Only valid while any of these steps is not done.
+    std::optional<t_layer_height_range>     m_dirty_layer_range;
 
-    std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
+    std::pair<FillAdaptive::OctreeSharedPtr, FillAdaptive::OctreeSharedPtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
+    // Arachne toolpaths of the outlines repeating over the layers, valid as long as the slices are valid.
+    // Only deleted by ~PrintObject() in PrintObject.cpp, where WallToolPathsCache is complete.
+    std::unique_ptr<Arachne::WallToolPathsCache> m_wall_toolpaths_cache;
 
     std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
     std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
@@ -863,6 +902,30 @@ public:
     //return 0 means successful
     int                 export_cached_data(const std::string& dir_path, bool with_space=false);
     int                 load_cached_data(const std::string& directory);
+    // Persistent cache of the PrintObject processing results, consulted by process() for each object to be sliced.
+    // Null (the default) disables the cache.
+    void                set_slice_cache(std::shared_ptr<SliceCache> slice_cache) { m_slice_cache = std::move(slice_cache); }
+    const std::shared_ptr<SliceCache>& slice_cache() const { return m_slice_cache; }
+    // Memory limit of the organic tree support collision and avoidance caches in bytes, zero for unlimited.
+    // Over the limit the caches are compressed and the layers already processed are released, trading time for memory.
+    void                set_tree_support_cache_limit(size_t limit) { m_tree_support_cache_limit = limit; }
+    size_t              tree_support_cache_limit() const { return m_tree_support_cache_limit; }
+    // Maximum number of extruders of the layers reordered by the extruder order optimization over all the layers, see ToolOrdering.
+    // Zero (the default) keeps the extruders ordered layer by layer.
+    void                set_extruder_order_max_extruders(int max_extruders) { m_extruder_order_max_extruders = max_extruders; }
+    int                 extruder_order_max_extruders() const { return m_extruder_order_max_extruders; }
+    // Budget of the states evaluated by the extruder order optimization solving the orders of the layers exactly,
+    // the orders of the other layers are found by a beam search.
+    void                set_extruder_order_max_states(size_t max_states) { m_extruder_order_max_states = max_states; }
+    size_t              extruder_order_max_states() const { return m_extruder_order_max_states; }
+    // Octrees of the adaptive cubic and support cubic infill shared by the PrintObjects and kept over re-slicing.
+    FillAdaptive::OctreeCache*  adaptive_fill_octree_cache() const { return m_adaptive_fill_octree_cache.get(); }
+    // Drops the cached octrees, called when objects are removed from the print.
+    void                        clear_adaptive_fill_octree_cache();
+    // Multi-material and fuzzy skin segmentation of the painted objects kept over re-slicing, see segmentation_by_painting().
+    SegmentationCache*          segmentation_cache() const { return m_segmentation_cache.get(); }
+    // Raycasted visibility of the object meshes for the seam placement kept over G-code exports, see SeamPlacer::init().
+    SeamVisibilityCache*        seam_visibility_cache() const { return m_seam_visibility_cache.get(); }
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
@@ -995,6 +1058,8 @@ public:
     // 3. LowTemp+HighTemp+...=HighLowCompatible
     // Unset types are just ignored.
     static int get_compatible_filament_type(const std::set<int>& types);
+    // Is the PrintConfig option influencing the G-code export, the wipe tower or the skirt and brim only, not any PrintObject step?
+    static bool is_config_option_of_print_steps_only(const t_config_option_key &opt_key);
 
     bool is_all_objects_are_short() const {
         return std::all_of(this->objects().begin(), this->objects().end(), [&](PrintObject* obj) { return obj->height() < scale_(this->config().nozzle_height.value); });
@@ -1011,6 +1076,7 @@ public:
 protected:
     // Invalidates the step, and its depending steps in Print.
     bool                invalidate_step(PrintStep step);
+    void                fill_step_stats(int step, PrintStepStats &stats) const override;
 
 private:
     //BBS
@@ -1018,6 +1084,10 @@ private:
 
     bool                invalidate_state_by_config_options(const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
 
+    // Load the processed object from m_slice_cache, returns false if there is no such entry or it could not be loaded.
+    bool                load_object_from_slice_cache(PrintObject *obj, const std::string &key);
+    void                store_object_to_slice_cache(const PrintObject *obj, const std::string &key);
+
     void                _make_skirt();
     void                _make_wipe_tower();
     void                finalize_first_layer_convex_hull();
@@ -1066,6 +1136,15 @@ private:
     //SoftFever: calibration
     Calib_Params m_calib_params;
 
+    std::shared_ptr<SliceCache>             m_slice_cache;
+    size_t                                  m_tree_support_cache_limit { 0 };
+    int                                     m_extruder_order_max_extruders { 0 };
+    size_t                                  m_extruder_order_max_states { 0 };
+    // Created by process().
+    std::shared_ptr<FillAdaptive::OctreeCache> m_adaptive_fill_octree_cache;
+    std::shared_ptr<SegmentationCache>         m_segmentation_cache;
+    std::shared_ptr<SeamVisibilityCache>       m_seam_visibility_cache;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
@@ -700,15 +700,36 @@ void print_region_ref_inc(PrintRegion &r) { ++ r.m_ref_cnt; }
 void print_region_ref_reset(PrintRegion &r) { r.m_ref_cnt = 0; }
 int  print_region_ref_cnt(const PrintRegion &r) { return r.m_ref_cnt; }
 
+// Z span of all layer ranges referencing a region. PrintRegions are shared between layer ranges with the same configuration,
+// thus the span may cover layer ranges in between, which do not reference the region. It is only used to limit the layers
+// to be reprocessed after the region configuration changes, therefore a conservative span is fine.
+static t_layer_height_range print_object_region_z_span(const PrintObjectRegions &print_object_regions, const PrintRegion &region)
+{
+    t_layer_height_range span(DBL_MAX, -DBL_MAX);
+    for (const PrintObjectRegions::LayerRangeRegions &layer_range : print_object_regions.layer_ranges) {
+        bool referenced =
+            std::any_of(layer_range.volume_regions.begin(), layer_range.volume_regions.end(), [&region](const auto &r) { return r.region == &region; }) ||
+            std::any_of(layer_range.painted_regions.begin(), layer_range.painted_regions.end(), [&region](const auto &r) { return r.region == &region; }) ||
+            std::any_of(layer_range.fuzzy_skin_painted_regions.begin(), layer_range.fuzzy_skin_painted_regions.end(), [&region](const auto &r) { return r.region == &region; });
+        if (referenced) {
+            span.first  = std::min(span.first,  layer_range.layer_height_range.first);
+            span.second = std::max(span.second, layer_range.layer_height_range.second);
+        }
+    }
+    assert(span.first <= span.second);
+    return span;
+}
+
 // Verify whether the PrintRegions of a PrintObject are still valid, possibly after updating the region configs.
 // Before region configs are updated, callback_invalidate() is called to possibly stop background processing.
+// callback_invalidate() receives the Z span of the layer ranges referencing the modified region.
 // Returns false if this object needs to be resliced because regions were merged or split.
 bool verify_update_print_object_regions(
     ModelVolumePtrs                     model_volumes,
     const PrintRegionConfig            &default_region_config,
     size_t                              num_extruders,
     PrintObjectRegions                 &print_object_regions,
-    const std::function<void(const PrintRegionConfig&, const PrintRegionConfig&, const t_config_option_keys&)> &callback_invalidate)
+    const std::function<void(const PrintRegionConfig&, const PrintRegionConfig&, const t_config_option_keys&, const t_layer_height_range&)> &callback_invalidate)
 {
     // Sort by ModelVolume ID.
     model_volumes_sort_by_id(model_volumes);
@@ -769,7 +790,7 @@ bool verify_update_print_object_regions(
                         // Region is referenced for the first time. Just change its parameters.
                         // Stop the background process before assigning new configuration to the regions.
                         t_config_option_keys diff = region.region->config().diff(cfg);
-                        callback_invalidate(region.region->config(), cfg, diff);
+                        callback_invalidate(region.region->config(), cfg, diff, print_object_region_z_span(print_object_regions, *region.region));
                         region.region->config_apply_only(cfg, diff, false);
                     } else {
                         // Region is referenced multiple times, thus the region is being split. We need to reslice.
@@ -794,7 +815,7 @@ bool verify_update_print_object_regions(
                     // Region is referenced for the first time. Just change its parameters.
                     // Stop the background process before assigning new configuration to the regions.
                     t_config_option_keys diff = region.region->config().diff(cfg);
-                    callback_invalidate(region.region->config(), cfg, diff);
+                    callback_invalidate(region.region->config(), cfg, diff, print_object_region_z_span(print_object_regions, *region.region));
                     region.region->config_apply_only(cfg, diff, false);
                 } else {
                     // Region is referenced multiple times, thus the region is being split. We need to reslice.
@@ -816,7 +837,7 @@ bool verify_update_print_object_regions(
                     // Region is referenced for the first time. Just change its parameters.
                     // Stop the background process before assigning new configuration to the regions.
                     t_config_option_keys diff = region.region->config().diff(cfg);
-                    callback_invalidate(region.region->config(), cfg, diff);
+                    callback_invalidate(region.region->config(), cfg, diff, print_object_region_z_span(print_object_regions, *region.region));
                     region.region->config_apply_only(cfg, diff, false);
                 } else {
                     // Region is referenced multiple times, thus the region is being split. We need to reslice.
@@ -1198,6 +1219,7 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
 			delete object;
         }
         m_objects.clear();
+        this->clear_adaptive_fill_octree_cache();
         print_regions_reshuffled = true;
         m_model.assign_copy(model);
 		for (const ModelObject *model_object : m_model.objects)
@@ -1283,6 +1305,7 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                 }
                 for (ModelObject *model_object : model_objects_old)
                     delete model_object;
+                this->clear_adaptive_fill_octree_cache();
                 print_regions_reshuffled = true;
             }
         }
@@ -1599,10 +1622,10 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
                     m_default_region_config,
                     num_extruders,
                     *print_object_regions,
-                    [it_print_object, it_print_object_end, &update_apply_status](const PrintRegionConfig &old_config, const PrintRegionConfig &new_config, const t_config_option_keys &diff_keys) {
+                    [it_print_object, it_print_object_end, &update_apply_status](const PrintRegionConfig &old_config, const PrintRegionConfig &new_config, const t_config_option_keys &diff_keys, const t_layer_height_range &z_span) {
                         for (auto it = it_print_object; it != it_print_object_end; ++it)
                             if ((*it)->m_shared_regions != nullptr)
-                                update_apply_status((*it)->invalidate_state_by_config_options(old_config, new_config, diff_keys));
+                                update_apply_status((*it)->invalidate_state_by_config_options(old_config, new_config, diff_keys, &z_span));
                     })) {
                 // Regions are valid, just keep them.
             } else {
@@ -146,6 +146,11 @@ std::function<void()> PrintObjectBase::cancel_callback(PrintBase *print)
 	return print->cancel_callback();
 }
 
+PrintStepStatsCollector& PrintObjectBase::step_stats_collector(PrintBase *print)
+{
+	return print->m_step_stats;
+}
+
 void PrintObjectBase::status_update_warnings(PrintBase *print, int step, PrintStateBase::WarningLevel warning_level,
     const std::string &message, PrintStateBase::SlicingNotificationType message_id)
 {
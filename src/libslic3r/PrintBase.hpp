@@ -2,6 +2,7 @@
 #define slic3r_PrintBase_hpp_
 
 #include "libslic3r.h"
+#include <array>
 #include <set>
 #include <vector>
 #include <string>
@@ -13,6 +14,7 @@
 #include "Model.hpp"
 #include "PlaceholderParser.hpp"
 #include "PrintConfig.hpp"
+#include "PrintStepStats.hpp"
 
 namespace Slic3r {
 
@@ -342,6 +344,9 @@ protected:
     // Declared here to allow access from PrintBase through friendship.
 	static std::mutex&                  state_mutex(PrintBase *print);
 	static std::function<void()>        cancel_callback(PrintBase *print);
+	static PrintStepStatsCollector&     step_stats_collector(PrintBase *print);
+    // Fill in the step name and the item counts of a finished PrintObject step.
+    virtual void                        fill_step_stats(int step, PrintStepStats &stats) const {}
 	// Notify UI about a new warning of a milestone "step" on this PrintObjectBase.
 	// The UI will be notified by calling a status callback registered on print.
 	// If no status callback is registered, the message is printed to console.
@@ -521,6 +526,11 @@ public:
     //SoftFever plate name
     std::string get_plate_name() const { return m_plate_name; }
     void set_plate_name(const std::string& name) { m_plate_name = name; }
+
+    // Wall time, CPU time, memory and item counts of the Print and PrintObject steps finished
+    // since the last start of process(), in the order of their completion.
+    std::vector<PrintStepStats> step_stats() const { return m_step_stats.stats(); }
+
 protected:
 	friend class PrintObjectBase;
     friend class BackgroundSlicingProcess;
@@ -547,6 +557,8 @@ protected:
     std::string            output_filename(const std::string &format, const std::string &default_ext, const std::string &filename_base, const DynamicConfig *config_override = nullptr) const;
     // Update "scale", "input_filename", "input_filename_base" placeholders from the current printable ModelObjects.
     void                   update_object_placeholders(DynamicConfig &config, const std::string &default_ext) const;
+    // Fill in the step name and the item counts of a finished Print step.
+    virtual void           fill_step_stats(int step, PrintStepStats &stats) const {}
 
 	Model                                   m_model;
 	DynamicPrintConfig						m_full_print_config;
@@ -562,6 +574,9 @@ protected:
     // Callback to be evoked regularly to update state of the UI thread.
     status_callback_type                    m_status_callback;
 
+    // To be cleared by process() of the derived class.
+    PrintStepStatsCollector                 m_step_stats;
+
 private:
     std::atomic<CancelStatus>               m_cancel_status;
 
@@ -594,11 +609,24 @@ public:
             this->status_update_warnings(static_cast<int>(active_step.first), warning_level, message, nullptr, message_id);
     }
 protected:
-    bool            set_started(PrintStepEnum step) { return m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintStepEnum step) {
+        bool started = m_state.set_started(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
+        if (started)
+            m_step_start[step] = PrintStepStatsCollector::start();
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintStepEnum step) {
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, this->state_mutex(), [this](){ this->throw_if_canceled(); });
         if (status.second)
             this->status_update_warnings(static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
+        // Steps set done without being started (for example loaded from a cache) are not recorded.
+        if (m_step_start[step].valid) {
+            PrintStepStats stats;
+            stats.step = static_cast<int>(step);
+            this->fill_step_stats(stats.step, stats);
+            m_step_stats.finish(m_step_start[step], std::move(stats));
+            m_step_start[step].valid = false;
+        }
         return status.first;
 	}
     bool            invalidate_step(PrintStepEnum step)
@@ -617,6 +645,8 @@ protected:
 
 private:
     PrintState<PrintStepEnum, COUNT> m_state;
+    // Sampled by set_started(), to be consumed by set_done(). A step is executed by a single thread.
+    std::array<PrintStepStatsCollector::Start, COUNT> m_step_start;
 };
 
 template<typename PrintType, typename PrintObjectStepEnum, const size_t COUNT>
@@ -634,14 +664,37 @@ public:
 protected:
 	PrintObjectBaseWithState(PrintType *print, ModelObject *model_object) : PrintObjectBase(model_object), m_print(print) {}
 
-    bool            set_started(PrintObjectStepEnum step)
-        { return m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); }); }
+    bool            set_started(PrintObjectStepEnum step) {
+        bool started = m_state.set_started(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
+        if (started) {
+            m_step_start[step] = PrintStepStatsCollector::start();
+            m_step_counters[step].reset();
+        }
+        return started;
+    }
 	PrintStateBase::TimeStamp set_done(PrintObjectStepEnum step) {
 		std::pair<PrintStateBase::TimeStamp, bool> status = m_state.set_done(step, PrintObjectBase::state_mutex(m_print), [this](){ this->throw_if_canceled(); });
         if (status.second)
             this->status_update_warnings(m_print, static_cast<int>(step), PrintStateBase::WarningLevel::NON_CRITICAL, std::string());
+        this->finish_step_stats(step);
         return status.first;
 	}
+    // Record the statistics of a step started by set_started(), called by set_done() or by a step which is not set done.
+    // Steps set done without being started (loaded from a cache) are not recorded.
+    void            finish_step_stats(PrintObjectStepEnum step) {
+        if (m_step_start[step].valid) {
+            PrintStepStats stats;
+            stats.object_id   = this->id();
+            stats.object_name = m_model_object->name;
+            stats.step        = static_cast<int>(step);
+            m_step_counters[step].copy_to(stats);
+            this->fill_step_stats(stats.step, stats);
+            PrintObjectBase::step_stats_collector(m_print).finish(m_step_start[step], std::move(stats));
+            m_step_start[step].valid = false;
+        }
+    }
+    // Item counts of a running step, to be added to by the step as it produces the layers.
+    PrintStepCounters& step_counters(PrintObjectStepEnum step) { return m_step_counters[step]; }
 
     bool            invalidate_step(PrintObjectStepEnum step)
         { return m_state.invalidate(step, PrintObjectBase::cancel_callback(m_print)); }
@@ -677,6 +730,10 @@ protected:
 
 private:
     PrintState<PrintObjectStepEnum, COUNT>   m_state;
+    // Sampled by set_started(), to be consumed by set_done(). A step is executed by a single thread.
+    std::array<PrintStepStatsCollector::Start, COUNT> m_step_start;
+    // Reset by set_started(), the worker threads of the step add to them.
+    std::array<PrintStepCounters, COUNT>     m_step_counters;
 };
 
 } // namespace Slic3r
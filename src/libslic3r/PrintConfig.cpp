@@ -8038,6 +8038,71 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "dir";
     def->set_default_value(new ConfigOptionString());
 
+    def = this->add("slice_cache_dir", coString);
+    def->label = L("Slice cache directory");
+    def->tooltip = L("Store the slicing results of the objects at the given directory and reuse them when the same object is sliced again with the same settings.");
+    def->cli_params = "dir";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("slice_cache_size", coInt);
+    def->label = L("Slice cache size");
+    def->tooltip = L("Maximum size of the slice cache directory in MB. The least recently used results are removed once the limit is exceeded.");
+    def->sidetext = L("MB");
+    def->min = 1;
+    def->cli_params = "size";
+    def->set_default_value(new ConfigOptionInt(2048));
+
+    def = this->add("tree_support_cache_limit", coInt);
+    def->label = L("Tree support cache limit");
+    def->tooltip = L("Memory limit of the collision and avoidance caches of organic tree supports in MB, 0 for unlimited. "
+                     "With a limit the avoidances are calculated on demand instead of upfront, "
+                     "over the limit the areas are stored compressed and released once they are not needed anymore, "
+                     "which saves memory on tall objects at the cost of a longer support generation.");
+    def->sidetext = L("MB");
+    def->min = 0;
+    def->cli_params = "size";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("extruder_order_max_extruders", coInt);
+    def->label = L("Extruder order optimization limit");
+    def->tooltip = L("Maximum number of extruders of a layer solved exactly by the extruder order optimization over all the layers "
+                     "of a multi-material print, which minimizes the total flush volume instead of ordering the extruders layer by layer. "
+                     "The time of the exact solution grows exponentially with the number of extruders of a layer, "
+                     "the layers printing more extruders are ordered by a beam search. 0 disables the optimization.");
+    def->min = 0;
+    def->max = 16;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(0));
+
+    def = this->add("extruder_order_max_states", coInt);
+    def->label = L("Extruder order optimization budget");
+    def->tooltip = L("Budget of the states evaluated by the extruder order optimization solving the orders of the layers exactly, "
+                     "in millions. When it runs out, the orders of the remaining layers are found by a beam search. "
+                     "The budget bounds the optimization time, while the result does not depend on the speed of the computer.");
+    def->sidetext = L("million");
+    def->min = 0;
+    def->cli_params = "count";
+    def->set_default_value(new ConfigOptionInt(100));
+
+    def = this->add("step_stats", coBool);
+    def->label = L("Print step statistics");
+    def->tooltip = L("Print wall time, CPU time, memory change and item counts of each slicing step after a plate is sliced.");
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("step_stats_trace", coString);
+    def->label = L("Step statistics trace");
+    def->tooltip = L("Export the slicing steps of each plate in the Chrome trace event format to the given file. "
+                     "The plate index is appended to the file name if more than one plate is sliced.");
+    def->cli_params = "file";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("slicing_backend", coString);
+    def->label = L("Slicing backend");
+    def->tooltip = L("Implementation of the triangle and slicing plane intersections. "
+                     "\"default\" uses the regular CPU slicing, \"cpu_batched\" bins the triangles by their Z span and intersects them in vectorized batches.");
+    def->cli_params = "backend";
+    def->set_default_value(new ConfigOptionString("default"));
+
     def = this->add("debug", coInt);
     def->label = L("Debug level");
     def->tooltip = L("Sets debug logging level. 0:fatal, 1:error, 2:warning, 3:info, 4:debug, 5:trace\n");
@@ -18,6 +18,7 @@
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
 #include "Fill/FillLightning.hpp"
+#include "Arachne/WallToolPaths.hpp"
 #include "Format/STL.hpp"
 #include "format.hpp"
 
@@ -287,6 +288,15 @@ void PrintObject::_transform_hole_to_polyholes()
     }
 }
 
+// Number of the extrusion entities stored in a collection of the regions of a layer.
+static size_t count_region_paths(const Layer &layer, ExtrusionEntityCollection LayerRegion::*collection)
+{
+    size_t cnt = 0;
+    for (const LayerRegion *layerm : layer.regions())
+        cnt += (layerm->*collection).items_count();
+    return cnt;
+}
+
 // 1) Merges typed region slices into stInternal type.
 // 2) Increases an "extra perimeters" counter at region slices where needed.
 // 3) Generates perimeters, gap fills and fill regions (fill regions of type stInternal).
@@ -301,13 +311,17 @@ void PrintObject::make_perimeters()
     m_print->set_status(15, L("Generating walls"));
     BOOST_LOG_TRIVIAL(info) << "Generating walls..." << log_memory_info();
 
+    // Only the layers around the layer range modifiers get new walls if nothing else changed, see dirty_layers().
+    const auto [first_layer, last_layer] = this->dirty_layers().perimeters;
+
     // Revert the typed slices into untyped slices.
     if (m_typed_slices) {
-        for (Layer *layer : m_layers) {
-            layer->restore_untyped_slices();
+        for (size_t layer_idx = first_layer; layer_idx < last_layer; ++ layer_idx) {
+            m_layers[layer_idx]->restore_untyped_slices();
             m_print->throw_if_canceled();
         }
-        m_typed_slices = false;
+        // The other layers keep their typed slices.
+        m_typed_slices = first_layer > 0 || last_layer < m_layers.size();
     }
 
     // compare each layer to the one below, and mark those slices needing
@@ -381,34 +395,147 @@ void PrintObject::make_perimeters()
         BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - end";
     }
 
+    if (first_layer > 0 || last_layer < m_layers.size())
+        BOOST_LOG_TRIVIAL(info) << "Regenerating walls of layers " << first_layer << " to " << last_layer << " out of " << m_layers.size();
+
+    if (m_config.wall_generator.value == PerimeterGeneratorType::Arachne && ! m_wall_toolpaths_cache)
+        m_wall_toolpaths_cache.reset(new Arachne::WallToolPathsCache());
+
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
     tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, m_layers.size()),
+        tbb::blocked_range<size_t>(first_layer, last_layer),
         [this](const tbb::blocked_range<size_t>& range) {
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
+                ExtrusionEntityArena::Scope arena_scope;
                 m_layers[layer_idx]->make_perimeters();
+                this->step_counters(posPerimeters).add_layer(count_region_paths(*m_layers[layer_idx], &LayerRegion::perimeters), 0);
             }
         }
     );
     m_print->throw_if_canceled();
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
+    if (m_wall_toolpaths_cache)
+        BOOST_LOG_TRIVIAL(debug) << "Arachne toolpaths cache: " << m_wall_toolpaths_cache->hits() << " hits, " << m_wall_toolpaths_cache->misses()
+                                 << " misses, " << m_wall_toolpaths_cache->size() << " entries, "
+                                 << m_wall_toolpaths_cache->memsize() / 1024 << " kB";
 
     this->set_done(posPerimeters);
 }
 
+// The steps following posPerimeters are re-run over the layers around the layer range modifiers only, if nothing else changed:
+// The perimeter generator looks at the slices of the adjacent layers. prepare_infill() only reads the untyped slices and fill_expolygons
+// produced by the perimeter generator and rewrites the typed slices and fill_surfaces, thus it may be re-run over a part of the object.
+// The infill regions of a layer depend on the layers around it: detect_surfaces_type() and process_external_surfaces() look at
+// the adjacent layers, discover_vertical_shells() and discover_horizontal_shells() over the top and bottom shells
+// and bridge_over_infill() down to the height of a thick bridge.
+// All layers are reprocessed if the infill is planned over the whole object: lightning and adaptive infill, combined infill,
+// extra solid infill layers counted from the first layer, infill only where needed and spiral vase.
+static coordf_t min_layer_height(const LayerPtrs &layers)
+{
+    return std::max(EPSILON, (*std::min_element(layers.begin(), layers.end(),
+        [](const Layer *l1, const Layer *l2) { return l1->height < l2->height; }))->height);
+}
+
+size_t PrintObject::shell_layers() const
+{
+    if (m_layers.empty())
+        return 0;
+    const coordf_t min_height = min_layer_height(m_layers);
+    auto num_layers = [min_height](coordf_t height) { return size_t(std::ceil(height / min_height)); };
+    size_t out = 0;
+    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
+        const PrintRegionConfig &config = this->printing_region(region_id).config();
+        out = std::max({ out, size_t(std::max(0, config.top_shell_layers.value)), size_t(std::max(0, config.bottom_shell_layers.value)),
+                         num_layers(config.top_shell_thickness.value), num_layers(config.bottom_shell_thickness.value) });
+    }
+    return out;
+}
+
+PrintObject::DirtyLayers PrintObject::dirty_layers() const
+{
+    const std::pair<size_t, size_t> all_layers(0, m_layers.size());
+    const DirtyLayers               all { all_layers, all_layers, all_layers };
+    if (! m_dirty_layer_range || m_layers.empty() || m_print->config().spiral_mode || PrintObject::infill_only_where_needed)
+        return all;
+    if (auto [adaptive_line_spacing, support_line_spacing] = FillAdaptive::adaptive_fill_line_spacing(*this);
+        adaptive_line_spacing != 0. || support_line_spacing != 0.)
+        return all;
+
+    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
+        const PrintRegionConfig &config = this->printing_region(region_id).config();
+        if (config.sparse_infill_pattern == ipLightning || config.infill_combination || ! config.extra_solid_infills.value.empty())
+            return all;
+    }
+    const std::vector<double> &nozzle_diameters = m_print->config().nozzle_diameter.values;
+    const size_t reach = 2 * this->shell_layers() +
+        size_t(std::ceil(*std::max_element(nozzle_diameters.begin(), nozzle_diameters.end()) / min_layer_height(m_layers))) + 2;
+
+    auto extend = [this](std::pair<size_t, size_t> span, size_t margin) {
+        return std::make_pair(span.first > margin ? span.first - margin : 0, std::min(span.second + margin, m_layers.size()));
+    };
+    std::pair<size_t, size_t> dirty(
+        std::lower_bound(m_layers.begin(), m_layers.end(), m_dirty_layer_range->first,
+            [](const Layer *layer, coordf_t z) { return layer->slice_z < z; }) - m_layers.begin(),
+        std::upper_bound(m_layers.begin(), m_layers.end(), m_dirty_layer_range->second,
+            [](coordf_t z, const Layer *layer) { return z < layer->slice_z; }) - m_layers.begin());
+    dirty.second = std::max(dirty.first, dirty.second);
+    DirtyLayers out;
+    out.perimeters     = extend(dirty, 1);
+    out.infill         = extend(out.perimeters, reach);
+    out.prepare_infill = extend(out.infill, reach);
+    return out;
+}
+
+Arachne::WallToolPathsCache* PrintObject::wall_toolpaths_cache() const
+{
+    return m_wall_toolpaths_cache.get();
+}
+
 void PrintObject::prepare_infill()
 {
     if (! this->set_started(posPrepareInfill))
         return;
     m_print->set_status(25, L("Generating infill regions"));
+
+    // Only the layers around the layer range modifiers get new infill regions if nothing else changed, see dirty_layers().
+    // The steps below rewrite the layers of the prepare_infill span, which extends the infill span by the layers it depends on,
+    // and they read the layers around it. The layers of the prepare_infill span outside of the infill span keep their infill regions,
+    // which are put aside and moved back.
+    const DirtyLayers dirty = this->dirty_layers();
+    const std::pair<size_t, size_t> layer_range = dirty.prepare_infill;
+    struct KeptRegion {
+        LayerRegion      *layerm;
+        SurfaceCollection slices;
+        SurfaceCollection fill_surfaces;
+    };
+    std::vector<KeptRegion> kept_regions;
+    for (size_t layer_idx = layer_range.first; layer_idx < layer_range.second; ++ layer_idx)
+        if (layer_idx < dirty.infill.first || layer_idx >= dirty.infill.second)
+            for (LayerRegion *layerm : m_layers[layer_idx]->regions())
+                // The fill surfaces are copied, they are clipped in place by the steps below.
+                kept_regions.push_back({ layerm, std::move(layerm->slices), layerm->fill_surfaces });
+    auto restore_kept_regions = [&kept_regions]() {
+        for (KeptRegion &kept : kept_regions) {
+            kept.layerm->slices        = std::move(kept.slices);
+            kept.layerm->fill_surfaces = std::move(kept.fill_surfaces);
+        }
+        kept_regions.clear();
+    };
+    // Restore the kept regions also if canceled.
+    ScopeGuard restore_kept_regions_guard(restore_kept_regions);
+    if (layer_range.first > 0 || layer_range.second < m_layers.size())
+        BOOST_LOG_TRIVIAL(info) << "Generating infill regions of layers " << dirty.infill.first << " to " << dirty.infill.second << " out of " << m_layers.size();
+
+    // The slices of the kept regions were moved out, they are restored from the untyped slices below.
+    assert(m_typed_slices || kept_regions.empty());
     if (m_typed_slices) {
         // To improve robustness of detect_surfaces_type() when reslicing (working with typed slices), see GH issue #7442.
         // The preceding step (perimeter generator) only modifies extra_perimeters and the extra perimeters are only used by discover_vertical_shells()
         // with more than a single region. If this step does not use Surface::extra_perimeters or Surface::extra_perimeters is always zero, it is safe
         // to reset to the untyped slices before re-runnning detect_surfaces_type().
-        for (Layer* layer : m_layers) {
-            layer->restore_untyped_slices_no_extra_perimeters();
+        for (size_t layer_idx = layer_range.first; layer_idx < layer_range.second; ++ layer_idx) {
+            m_layers[layer_idx]->restore_untyped_slices_no_extra_perimeters();
             m_print->throw_if_canceled();
         }
     }
@@ -417,22 +544,22 @@ void PrintObject::prepare_infill()
     // Then the classifcation of $layerm->slices is transfered onto
     // the $layerm->fill_surfaces by clipping $layerm->fill_surfaces
     // by the cummulative area of the previous $layerm->fill_surfaces.
-    this->detect_surfaces_type();
+    this->detect_surfaces_type(layer_range);
     m_print->throw_if_canceled();
 
     // Decide what surfaces are to be filled.
     // Here the stTop / stBottomBridge / stBottom infill is turned to just stInternal if zero top / bottom infill layers are configured.
     // Also tiny stInternal surfaces are turned to stInternalSolid.
     BOOST_LOG_TRIVIAL(info) << "Preparing fill surfaces..." << log_memory_info();
-    for (auto *layer : m_layers)
-        for (auto *region : layer->m_regions) {
+    for (size_t layer_idx = layer_range.first; layer_idx < layer_range.second; ++ layer_idx)
+        for (auto *region : m_layers[layer_idx]->m_regions) {
             region->prepare_fill_surfaces();
             m_print->throw_if_canceled();
         }
 
 
     // Add solid fills to ensure the shell vertical thickness.
-    this->discover_vertical_shells();
+    this->discover_vertical_shells(layer_range);
     m_print->throw_if_canceled();
 
     // Debugging output.
@@ -455,7 +582,7 @@ void PrintObject::prepare_infill()
     //FIXME Vojtech: Is this a good place to add supporting infills below sloping perimeters?
     // Orca: Brought this function call before the process_external_surfaces, to allow bridges over holes to expand more than
     // one perimeter. Example of this is the bridge over the benchy lettering.
-    this->discover_horizontal_shells();
+    this->discover_horizontal_shells(layer_range);
     m_print->throw_if_canceled();
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
@@ -477,7 +604,7 @@ void PrintObject::prepare_infill()
     // 3) Clip the internal surfaces by the grown top/bottom surfaces.
     // 4) Merge surfaces with the same style. This will mostly get rid of the overlaps.
     //FIXME This does not likely merge surfaces, which are supported by a material with different colors, but same properties.
-    this->process_external_surfaces();
+    this->process_external_surfaces(layer_range);
     m_print->throw_if_canceled();
 
     // Debugging output.
@@ -497,6 +624,7 @@ void PrintObject::prepare_infill()
     //FIXME The surfaces are supported by a sparse infill, but the sparse infill is only as large as the area to support.
     // Likely the sparse infill will not be anchored correctly, so it will not work as intended.
     // Also one wishes the perimeters to be supported by a full infill.
+    // dirty_layers() returns all layers if clip_fill_surfaces() or combine_infill() are active, they process the whole object.
     this->clip_fill_surfaces();
     m_print->throw_if_canceled();
 
@@ -512,7 +640,7 @@ void PrintObject::prepare_infill()
 
     // the following step needs to be done before combination because it may need
     // to remove only half of the combined infill
-    this->bridge_over_infill();
+    this->bridge_over_infill(layer_range);
     m_print->throw_if_canceled();
 
     // combine fill surfaces to honor the "infill every N layers" option
@@ -533,6 +661,15 @@ void PrintObject::prepare_infill()
     } // for each layer
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
 
+    // Count the fill surfaces of the layers getting new infill regions.
+    for (size_t layer_idx = dirty.infill.first; layer_idx < dirty.infill.second; ++ layer_idx) {
+        size_t num_surfaces = 0;
+        for (const LayerRegion *layerm : m_layers[layer_idx]->regions())
+            num_surfaces += layerm->fill_surfaces.size();
+        this->step_counters(posPrepareInfill).add_layer(0, num_surfaces);
+    }
+
+    restore_kept_regions();
     this->set_done(posPrepareInfill);
 }
 
@@ -547,12 +684,15 @@ void PrintObject::infill()
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
 
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
+        const auto [first_layer, last_layer] = this->dirty_layers().infill;
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(first_layer, last_layer),
             [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
+                    ExtrusionEntityArena::Scope arena_scope;
                     m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
+                    this->step_counters(posInfill).add_layer(count_region_paths(*m_layers[layer_idx], &LayerRegion::fills), 0);
                 }
             }
         );
@@ -569,13 +709,17 @@ void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
+        // Ironing is appended to the infill, thus it is generated for the layers getting new infill only.
+        const auto [first_layer, last_layer] = this->dirty_layers().infill;
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(first_layer, last_layer),
             [this](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
+                    ExtrusionEntityArena::Scope arena_scope;
                     m_layers[layer_idx]->make_ironing();
+                    this->step_counters(posIroning).add_layer(count_region_paths(*m_layers[layer_idx], &LayerRegion::fills), 0);
                 }
             }
         );
@@ -621,6 +765,7 @@ void PrintObject::detect_overhangs_for_lift()
                     ExPolygons overhangs = diff_ex(layer.lslices, offset_ex(lower_layer.lslices, scale_(min_overlap)));
                     layer.loverhangs = std::move(offset2_ex(overhangs, -0.1f * scale_(line_width), 0.1f * scale_(line_width)));
                     layer.loverhangs_bbox = get_extents(layer.loverhangs);
+                    this->step_counters(posDetectOverhangsForLift).add_layer(0, layer.loverhangs.size());
                 }
             });
 
@@ -687,10 +832,14 @@ void PrintObject::estimate_curled_extrusions()
                                                  float(this->print()->default_object_config().inner_wall_acceleration.getFloat()),
                                                  this->config().raft_layers.getInt(), this->config().brim_type.value,
                                                  float(this->config().brim_width.getFloat())};
-            SupportSpotsGenerator::estimate_malformations(this->layers(), params);
+            size_t num_curled_lines = SupportSpotsGenerator::estimate_malformations(this->layers(), params);
+            this->step_counters(posEstimateCurledExtrusions).layers = m_layers.size();
+            this->step_counters(posEstimateCurledExtrusions).paths  = num_curled_lines;
             m_print->throw_if_canceled();
         }
         //this->set_done(posEstimateCurledExtrusions);
+        // The step is not set done, thus it is run again by every process(). Record each run.
+        this->finish_step_stats(posEstimateCurledExtrusions);
     }
 }
 
@@ -700,12 +849,14 @@ void PrintObject::simplify_extrusion_path()
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of object in parallel - start";
         //BBS: infill and walls
+        const auto [first_layer, last_layer] = this->dirty_layers().perimeters;
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(first_layer, last_layer),
             [this](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
                     m_layers[layer_idx]->simplify_wall_extrusion_path();
+                    this->step_counters(posSimplifyPath).add_layer(count_region_paths(*m_layers[layer_idx], &LayerRegion::perimeters), 0);
                 }
             }
         );
@@ -718,12 +869,14 @@ void PrintObject::simplify_extrusion_path()
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify infill extrusion path of object in parallel - start";
         //BBS: infills
+        const auto [first_layer, last_layer] = this->dirty_layers().infill;
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(first_layer, last_layer),
             [this](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
                     m_print->throw_if_canceled();
                     m_layers[layer_idx]->simplify_infill_extrusion_path();
+                    this->step_counters(posSimplifyInfill).add_layer(count_region_paths(*m_layers[layer_idx], &LayerRegion::fills), 0);
                 }
             }
         );
@@ -741,6 +894,7 @@ void PrintObject::simplify_extrusion_path()
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
                     m_support_layers[layer_idx]->simplify_support_extrusion_path();
+                    this->step_counters(posSimplifySupportPath).add_layer(m_support_layers[layer_idx]->support_fills.items_count(), 0);
                 }
             }
         );
@@ -750,14 +904,30 @@ void PrintObject::simplify_extrusion_path()
     }
 }
 
-std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare_adaptive_infill_data(
+void PrintObject::fill_step_stats(int step, PrintStepStats &stats) const
+{
+    static const char *step_names[] = {
+        "slice", "perimeters", "estimate_curled_extrusions", "prepare_infill",
+        "infill", "ironing", "support_material", "simplify_wall_path", "simplify_support_path",
+        "detect_overhangs_for_lift",
+        "simplify_wall", "simplify_infill"
+    };
+    static_assert(std::size(step_names) == posCount, "Missing PrintObjectStep name");
+    stats.step_name = step_names[step];
+    // The other steps count the layers, paths and polygons as they produce them, see step_counters().
+    // The support generator does not, its paths are counted by posSimplifySupportPath.
+    if (PrintObjectStep(step) == posSupportMaterial)
+        stats.layers = m_support_layers.size();
+}
+
+std::pair<FillAdaptive::OctreeSharedPtr, FillAdaptive::OctreeSharedPtr> PrintObject::prepare_adaptive_infill_data(
     const std::vector<std::pair<const Surface *, float>> &surfaces_w_bottom_z) const
 {
     using namespace FillAdaptive;
 
     auto [adaptive_line_spacing, support_line_spacing] = adaptive_fill_line_spacing(*this);
     if ((adaptive_line_spacing == 0. && support_line_spacing == 0.) || this->layers().empty())
-        return std::make_pair(OctreePtr(), OctreePtr());
+        return std::make_pair(OctreeSharedPtr(), OctreeSharedPtr());
 
     indexed_triangle_set mesh = this->model_object()->raw_indexed_triangle_set();
     // Rotate mesh and build octree on it with axis-aligned (standart base) cubes.
@@ -783,9 +953,15 @@ std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare
     for (size_t i = 1; i < overhangs.size(); ++ i)
         append(overhangs.front(), std::move(overhangs[i]));
 
-    return std::make_pair(
-        adaptive_line_spacing ? build_octree(mesh, overhangs.front(), adaptive_line_spacing, false) : OctreePtr(),
-        support_line_spacing  ? build_octree(mesh, overhangs.front(), support_line_spacing, true) : OctreePtr());
+    // Objects with the same geometry share the octrees, re-processed objects reuse them if the geometry did not change.
+    OctreeCache *cache = m_print->adaptive_fill_octree_cache();
+    auto get_octree = [cache, &mesh, &overhangs](double line_spacing, bool support_overhangs_only) -> OctreeSharedPtr {
+        if (line_spacing == 0.)
+            return OctreeSharedPtr();
+        return cache ? cache->get_or_build(mesh, overhangs.front(), line_spacing, support_overhangs_only) :
+                       OctreeSharedPtr(build_octree(mesh, overhangs.front(), line_spacing, support_overhangs_only));
+    };
+    return std::make_pair(get_octree(adaptive_line_spacing, false), get_octree(support_line_spacing, true));
 }
 
 FillLightning::GeneratorPtr PrintObject::prepare_lightning_infill_data()
@@ -869,16 +1045,21 @@ SupportLayerPtrs::iterator PrintObject::insert_support_layer(SupportLayerPtrs::i
     return m_support_layers.insert(pos, new SupportLayer(id, interface_id, this, height, print_z, slice_z));
 }
 
+// Steps, which are re-run over the layers around a layer range modifier only, see dirty_layers().
+static constexpr PrintObjectStep layer_range_steps[] { posPerimeters, posPrepareInfill, posInfill, posIroning, posSimplifyPath, posSimplifyInfill };
+
 // Called by Print::apply().
 // This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
 bool PrintObject::invalidate_state_by_config_options(
-    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys)
+    const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys,
+    const t_layer_height_range *layer_range)
 {
     if (opt_keys.empty())
         return false;
 
     std::vector<PrintObjectStep> steps;
     bool invalidated = false;
+    bool all_steps_invalidated = false;
     for (const t_config_option_key &opt_key : opt_keys) {
         if (   opt_key == "brim_width"
             || opt_key == "brim_object_gap"
@@ -1211,12 +1392,29 @@ bool PrintObject::invalidate_state_by_config_options(
             // for legacy, if we can't handle this option let's invalidate all steps
             this->invalidate_all_steps();
             invalidated = true;
+            all_steps_invalidated = true;
         }
     }
 
     sort_remove_duplicates(steps);
+    // The state of the layers before invalidation, see m_dirty_layer_range.
+    const bool                                layers_done        = std::all_of(std::begin(layer_range_steps), std::end(layer_range_steps),
+        [this](PrintObjectStep step) { return this->is_step_done_unguarded(step); });
+    const std::optional<t_layer_height_range> dirty_layer_range  = m_dirty_layer_range;
     for (PrintObjectStep step : steps)
         invalidated |= this->invalidate_step(step);
+
+    if (layer_range != nullptr && ! all_steps_invalidated && ! std::binary_search(steps.begin(), steps.end(), posSlice) &&
+        std::any_of(steps.begin(), steps.end(), [](PrintObjectStep step) {
+            return std::find(std::begin(layer_range_steps), std::end(layer_range_steps), step) != std::end(layer_range_steps); })) {
+        // Walls, infill regions or infill were invalidated by a layer range modifier, while the slices are still valid.
+        // Only the layers around the modifier need to be reprocessed, unless the layers were already stale before.
+        if (layers_done)
+            m_dirty_layer_range = *layer_range;
+        else if (dirty_layer_range)
+            m_dirty_layer_range = t_layer_height_range(std::min(dirty_layer_range->first, layer_range->first),
+                                                       std::max(dirty_layer_range->second, layer_range->second));
+    }
     return invalidated;
 }
 
@@ -1224,6 +1422,10 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
 
+    if (step == posSlice || std::find(std::begin(layer_range_steps), std::end(layer_range_steps), step) != std::end(layer_range_steps))
+        // All layers have to be reprocessed, unless invalidate_state_by_config_options() narrows it down again.
+        m_dirty_layer_range.reset();
+
     // propagate to dependent steps
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning, posSimplifyPath, posSimplifyInfill });
@@ -1237,6 +1439,9 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 		invalidated |= this->invalidate_steps({ posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportMaterial, posSimplifyPath, posSimplifyInfill });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
         m_slicing_params.valid = false;
+        // The cached toolpaths are keyed by the outlines and the Arachne parameters, thus they stay valid when only the perimeters
+        // are invalidated by a change of seam, wall order etc. New slices are unlikely to produce the same outlines.
+        m_wall_toolpaths_cache.reset();
     } else if (step == posSupportMaterial) {
         invalidated |= this->invalidate_steps({ posSimplifySupportPath });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
@@ -1258,6 +1463,7 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+    m_dirty_layer_range.reset();
 	return result;
 }
 
@@ -1270,7 +1476,7 @@ bool PrintObject::invalidate_all_steps()
 // stBottom       - Part of a region, which is not supported by the same region, but it is supported either by another region, or by a soluble interface layer.
 // stInternal     - Part of a region, which is supported by the same region type.
 // If a part of a region is of stBottom and stTop, the stBottom wins.
-void PrintObject::detect_surfaces_type()
+void PrintObject::detect_surfaces_type(std::pair<size_t, size_t> layer_range)
 {
     BOOST_LOG_TRIVIAL(info) << "Detecting solid surfaces..." << log_memory_info();
 
@@ -1297,12 +1503,12 @@ void PrintObject::detect_surfaces_type()
             surfaces_new.assign(num_layers, Surfaces());
 
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0,
+            tbb::blocked_range<size_t>(std::min(layer_range.first, num_layers), std::min(layer_range.second,
             	spiral_mode ?
             		// In spiral vase mode, reserve the last layer for the top surface if more than 1 layer is planned for the vase bottom.
             		((num_layers > 1) ? num_layers - 1 : num_layers) :
             		// In non-spiral vase mode, go over all layers.
-            		m_layers.size()),
+            		m_layers.size())),
             [this, region_id, interface_shells, &surfaces_new](const tbb::blocked_range<size_t>& range) {
                 // If we have soluble support material, don't bridge. The overhang will be squished against a soluble layer separating
                 // the support from the print.
@@ -1473,7 +1679,7 @@ void PrintObject::detect_surfaces_type()
 
         if (interface_shells) {
             // Move surfaces_new to layerm->slices.surfaces
-            for (size_t idx_layer = 0; idx_layer < num_layers; ++ idx_layer)
+            for (size_t idx_layer = layer_range.first; idx_layer < std::min(layer_range.second, num_layers); ++ idx_layer)
                 m_layers[idx_layer]->m_regions[region_id]->slices.surfaces = std::move(surfaces_new[idx_layer]);
         }
 
@@ -1490,10 +1696,12 @@ void PrintObject::detect_surfaces_type()
         // === ORCA: Surface is flagged as a new surface type called stInternalAfterExternalBridge ==================
         // === Algorithm only considers stInternal surfaces for re-classification, leaving stTop unaffected =
         // ==================================================================================================
-        // Only iterate to the second-to-last layer, since we look at layer i+1.
+        // Only iterate to the second-to-last layer, since we look at layer i+1. Layer i+1 is to be inside of layer_range.
         if( (this->config().enable_extra_bridge_layer.value == eblApplyToAll) || (this->config().enable_extra_bridge_layer.value == eblExternalBridgeOnly)){
-            const size_t last = (m_layers.empty() ? 0 : m_layers.size() - 1);
-            tbb::parallel_for( tbb::blocked_range<size_t>(0, last), [this, region_id](const tbb::blocked_range<size_t> &range) {
+            const size_t first = (layer_range.first > 0 ? layer_range.first - 1 : 0);
+            const size_t end   = std::min(layer_range.second, m_layers.size());
+            const size_t last  = (end > first ? end - 1 : first);
+            tbb::parallel_for( tbb::blocked_range<size_t>(first, last), [this, region_id](const tbb::blocked_range<size_t> &range) {
                 for (size_t i = range.begin(); i < range.end(); ++i) {
                     m_print->throw_if_canceled();
                     
@@ -1572,7 +1780,7 @@ void PrintObject::detect_surfaces_type()
             // === two external bridge layers. However, TODO: Implement a new surface type throughout the codebase ==========
             // ==============================================================================================================
             for (size_t region_id = 0; region_id < this->num_printing_regions(); ++region_id) {
-                tbb::parallel_for( tbb::blocked_range<size_t>(0, m_layers.size()), [this, region_id](const tbb::blocked_range<size_t> &range) {
+                tbb::parallel_for( tbb::blocked_range<size_t>(layer_range.first, layer_range.second), [this, region_id](const tbb::blocked_range<size_t> &range) {
                     for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++idx_layer) {
                         Surfaces &surfs = m_layers[idx_layer]->m_regions[region_id]->slices.surfaces;
                         for (Surface &s : surfs) {
@@ -1592,7 +1800,7 @@ void PrintObject::detect_surfaces_type()
         BOOST_LOG_TRIVIAL(debug) << "Detecting solid surfaces for region " << region_id << " - clipping in parallel - start";
         // Fill in layerm->fill_surfaces by trimming the layerm->slices by the cummulative layerm->fill_surfaces.
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(layer_range.first, layer_range.second),
             [this, region_id](const tbb::blocked_range<size_t>& range) {
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
                     m_print->throw_if_canceled();
@@ -1611,7 +1819,7 @@ void PrintObject::detect_surfaces_type()
     m_typed_slices = true;
 }
 
-void PrintObject::process_external_surfaces()
+void PrintObject::process_external_surfaces(std::pair<size_t, size_t> layer_range)
 {
     BOOST_LOG_TRIVIAL(info) << "Processing external surfaces..." << log_memory_info();
 
@@ -1626,9 +1834,12 @@ void PrintObject::process_external_surfaces()
 			break;
 		}
 	if (has_voids && m_layers.size() > 1) {
+	    // Only the layers below layer_range are needed.
+	    const size_t first_covered = std::max<size_t>(layer_range.first, 1) - 1;
+	    const size_t last_covered  = std::max(first_covered, std::min(layer_range.second, m_layers.size() - 1));
 	    // All but stInternal fill surfaces will get expanded and possibly trimmed.
 	    std::vector<unsigned char> layer_expansions_and_voids(m_layers.size(), false);
-	    for (size_t layer_idx = 1; layer_idx < m_layers.size(); ++ layer_idx) {
+	    for (size_t layer_idx = first_covered + 1; layer_idx <= last_covered; ++ layer_idx) {
 	    	const Layer *layer = m_layers[layer_idx];
 	    	bool expansions = false;
 	    	bool voids      = false;
@@ -1650,7 +1861,7 @@ void PrintObject::process_external_surfaces()
 	    surfaces_covered.resize(m_layers.size() - 1, Polygons());
     	auto unsupported_width = - float(scale_(0.3 * EXTERNAL_INFILL_MARGIN));
 	    tbb::parallel_for(
-	        tbb::blocked_range<size_t>(0, m_layers.size() - 1),
+	        tbb::blocked_range<size_t>(first_covered, last_covered),
 	        [this, &surfaces_covered, &layer_expansions_and_voids, unsupported_width](const tbb::blocked_range<size_t>& range) {
 	            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
 	            	if (layer_expansions_and_voids[layer_idx + 1]) {
@@ -1675,7 +1886,7 @@ void PrintObject::process_external_surfaces()
 	for (size_t region_id = 0; region_id < this->num_printing_regions(); ++region_id) {
         BOOST_LOG_TRIVIAL(debug) << "Processing external surfaces for region " << region_id << " in parallel - start";
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(layer_range.first, layer_range.second),
             [this, &surfaces_covered, region_id](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
@@ -1693,7 +1904,7 @@ void PrintObject::process_external_surfaces()
     }
 }
 
-void PrintObject::discover_vertical_shells()
+void PrintObject::discover_vertical_shells(std::pair<size_t, size_t> layer_range)
 {
     PROFILE_FUNC();
 
@@ -1709,6 +1920,12 @@ void PrintObject::discover_vertical_shells()
     bool     spiral_mode      = this->print()->config().spiral_mode.value;
     size_t   num_layers       = spiral_mode ? std::min(size_t(this->printing_region(0).config().bottom_shell_layers), m_layers.size()) : m_layers.size();
     std::vector<DiscoverVerticalShellsCacheEntry> cache_top_botom_regions(num_layers, DiscoverVerticalShellsCacheEntry());
+    // The layers of layer_range look at the top / bottom shells around them, including one layer to anchor the shell.
+    const size_t shell_margin = this->shell_layers() + 1;
+    const size_t first_layer  = std::min(layer_range.first, num_layers);
+    const size_t last_layer   = std::min(layer_range.second, num_layers);
+    const size_t first_cached = first_layer > shell_margin ? first_layer - shell_margin : 0;
+    const size_t last_cached  = std::min(last_layer + shell_margin, num_layers);
     bool top_bottom_surfaces_all_regions = this->num_printing_regions() > 1 && ! m_config.interface_shells.value;
 //    static constexpr const float top_bottom_expansion_coeff = 1.05f;
     // Just a tiny fraction of an infill extrusion width to merge neighbor regions reliably.
@@ -1730,9 +1947,9 @@ void PrintObject::discover_vertical_shells()
             return;
         BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells in parallel - start : cache top / bottom";
         //FIXME Improve the heuristics for a grain size.
-        size_t grain_size = std::max(num_layers / 16, size_t(1));
+        size_t grain_size = std::max((last_cached - first_cached) / 16, size_t(1));
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, num_layers, grain_size),
+            tbb::blocked_range<size_t>(first_cached, last_cached, grain_size),
             [this, &cache_top_botom_regions](const tbb::blocked_range<size_t>& range) {
                 const std::initializer_list<SurfaceType> surfaces_bottom { stBottom, stBottomBridge };
                 const size_t num_regions = this->num_printing_regions();
@@ -1803,14 +2020,14 @@ void PrintObject::discover_vertical_shells()
             continue;
 
         //FIXME Improve the heuristics for a grain size.
-        size_t grain_size = std::max(num_layers / 16, size_t(1));
+        size_t grain_size = std::max((last_cached - first_cached) / 16, size_t(1));
 
         if (! top_bottom_surfaces_all_regions) {
             // This is either a single material print, or a multi-material print and interface_shells are enabled, meaning that the vertical shell thickness
             // is calculated over a single material.
             BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : cache top / bottom";
             tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, num_layers, grain_size),
+                tbb::blocked_range<size_t>(first_cached, last_cached, grain_size),
                 [this, region_id, &cache_top_botom_regions](const tbb::blocked_range<size_t>& range) {
                     const std::initializer_list<SurfaceType> surfaces_bottom { stBottom, stBottomBridge };
                     for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
@@ -1839,7 +2056,7 @@ void PrintObject::discover_vertical_shells()
         BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : ensure vertical wall thickness";
         grain_size = 1;
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, num_layers, grain_size),
+            tbb::blocked_range<size_t>(first_layer, last_layer, grain_size),
             [this, region_id, &cache_top_botom_regions]
             (const tbb::blocked_range<size_t>& range) {
                 // printf("discover_vertical_shells from %d to %d\n", range.begin(), range.end());
@@ -2153,7 +2370,7 @@ template<typename T> void debug_draw(std::string name, const T& a, const T& b, c
 #endif
 
 // This method applies bridge flow to the first internal solid layer above sparse infill.
-void PrintObject::bridge_over_infill()
+void PrintObject::bridge_over_infill(std::pair<size_t, size_t> layer_range)
 {
     BOOST_LOG_TRIVIAL(info) << "Bridge over infill - Start" << log_memory_info();
     struct CandidateSurface
@@ -2190,7 +2407,7 @@ void PrintObject::bridge_over_infill()
     // SECTION to gather and filter surfaces for expanding, and then cluster them by layer
     {
         tbb::concurrent_vector<CandidateSurface> candidate_surfaces;
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, this->layers().size()), [po = static_cast<const PrintObject *>(this), &candidate_surfaces, has_lightning_infill](tbb::blocked_range<size_t> r) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(layer_range.first, layer_range.second), [po = static_cast<const PrintObject *>(this), &candidate_surfaces, has_lightning_infill](tbb::blocked_range<size_t> r) {
             PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
             for (size_t lidx = r.begin(); lidx < r.end(); lidx++) {
                 const Layer *layer = po->get_layer(lidx);
@@ -2939,7 +3156,7 @@ void PrintObject::bridge_over_infill()
 
     BOOST_LOG_TRIVIAL(info) << "Bridge over infill - Directions and expanded surfaces computed" << log_memory_info();
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, this->layers().size()), [po = this, &surfaces_by_layer](tbb::blocked_range<size_t> r) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(layer_range.first, layer_range.second), [po = this, &surfaces_by_layer](tbb::blocked_range<size_t> r) {
         PRINT_OBJECT_TIME_LIMIT_MILLIS(PRINT_OBJECT_TIME_LIMIT_DEFAULT);
         for (size_t lidx = r.begin(); lidx < r.end(); lidx++) {
             if (surfaces_by_layer.find(lidx) == surfaces_by_layer.end() && surfaces_by_layer.find(lidx + 1) == surfaces_by_layer.end())
@@ -3019,8 +3236,10 @@ void PrintObject::bridge_over_infill()
     // === ORCA: Create a second internal bridge layer above the first bridge layer. ========================================================
     // ======================================================================================================================================
     if ( this->m_config.enable_extra_bridge_layer == eblApplyToAll || this->m_config.enable_extra_bridge_layer == eblInternalBridgeOnly) {
-        // Process layers in parallel up to second-to-last
-        tbb::parallel_for( tbb::blocked_range<size_t>(0, this->layers().size() - 1), [this](const tbb::blocked_range<size_t>& r) {
+        // Process layers in parallel up to second-to-last, the layer above is to be inside of layer_range.
+        const size_t first = (layer_range.first > 0 ? layer_range.first - 1 : 0);
+        const size_t end   = std::min(layer_range.second, this->layers().size());
+        tbb::parallel_for( tbb::blocked_range<size_t>(first, end > first ? end - 1 : first), [this](const tbb::blocked_range<size_t>& r) {
             for (size_t lidx = r.begin(); lidx < r.end(); ++lidx)
             {
                 Layer* layer = this->get_layer(lidx);
@@ -3138,7 +3357,7 @@ void PrintObject::bridge_over_infill()
         // === back to an internal bridge. As a starting point, this improves bridging reliability as it extrudes ==========
         // === two external bridge layers. However, TODO: Implement a new surface type throughout the codebase =============
         // =================================================================================================================
-        for (size_t lidx = 0; lidx < this->layers().size(); ++lidx) {
+        for (size_t lidx = layer_range.first; lidx < layer_range.second; ++lidx) {
             Layer* layer = this->get_layer(lidx);
             for (LayerRegion* region : layer->regions()) {
                 for (Surface &surf : region->fill_surfaces.surfaces) {
@@ -3479,12 +3698,15 @@ void PrintObject::clip_fill_surfaces()
     }
 }
 
-void PrintObject::discover_horizontal_shells()
+void PrintObject::discover_horizontal_shells(std::pair<size_t, size_t> layer_range)
 {
     BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
 
+    // The shells are only scattered over the layers of layer_range.
+    const int first_layer = int(layer_range.first);
+    const int last_layer  = int(std::min(layer_range.second, m_layers.size()));
     for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id) {
-        for (size_t i = 0; i < m_layers.size(); ++ i) {
+        for (size_t i = layer_range.first; i < size_t(last_layer); ++ i) {
             m_print->throw_if_canceled();
             Layer 					*layer  = m_layers[i];
             LayerRegion             *layerm = layer->regions()[region_id];
@@ -3538,9 +3760,9 @@ void PrintObject::discover_horizontal_shells()
                 // Scatter top / bottom regions to other layers. Scattering process is inherently serial, it is difficult to parallelize without locking.
                 for (int n = (type == stTop) ? int(i) - 1 : int(i) + 1;
                 	(type == stTop) ?
-                		(n >= 0                   && (int(i) - n < num_solid_layers ||
+                		(n >= first_layer && (int(i) - n < num_solid_layers ||
                 								 	  print_z - m_layers[n]->print_z < region_config.top_shell_thickness.value - EPSILON)) :
-                		(n < int(m_layers.size()) && (n - int(i) < num_solid_layers ||
+                		(n < last_layer   && (n - int(i) < num_solid_layers ||
                 									  m_layers[n]->bottom_z() - bottom_z < region_config.bottom_shell_thickness.value - EPSILON));
                 	(type == stTop) ? -- n : ++ n)
                 {
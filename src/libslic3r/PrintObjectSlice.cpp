@@ -54,13 +54,20 @@ static std::vector<ExPolygons> slice_volume(
 {
     std::vector<ExPolygons> layers;
     if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
+        const TriangleMesh &mesh = volume.mesh();
+        if (mesh.its.indices.size() > 0) {
             MeshSlicingParamsEx params2 { params };
             params2.trafo = params2.trafo * volume.get_matrix();
-            if (params2.trafo.rotation().determinant() < 0.)
+            if (params2.trafo.rotation().determinant() < 0.) {
+                indexed_triangle_set its = mesh.its;
                 its_flip_triangles(its);
-            layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
+                layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
+            } else {
+                // The slicing index is owned by this mesh and kept until the mesh is modified, thus it is reused when the object is sliced again.
+                // It is not shared by the copies of the mesh, a copy builds its own index on first use.
+                params2.index = mesh.slicing_index();
+                layers = slice_mesh_ex(mesh.its, zs, params2, throw_on_cancel_callback);
+            }
             throw_on_cancel_callback();
         }
     }
@@ -833,6 +840,7 @@ void PrintObject::slice()
                 for (const ExPolygon &expoly : layer.lslices)
                 	layer.lslices_bboxes.emplace_back(get_extents(expoly));
                 layer.backup_untyped_slices();
+                this->step_counters(posSlice).add_layer(0, layer.lslices.size());
             }
         });
     if (m_layers.empty())
@@ -0,0 +1,93 @@
+#include "PrintStepStats.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+
+#include <boost/format.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "nlohmann/json.hpp"
+
+namespace Slic3r {
+
+void PrintStepStatsCollector::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_epoch = Clock::now();
+    m_stats.clear();
+    m_threads.clear();
+}
+
+PrintStepStatsCollector::Start PrintStepStatsCollector::start()
+{
+    Start start;
+    start.valid       = true;
+    start.wall        = Clock::now();
+    start.cpu_ms      = process_cpu_time_ms();
+    start.memory      = current_memory_usage();
+    return start;
+}
+
+void PrintStepStatsCollector::finish(const Start &start, PrintStepStats &&stats)
+{
+    Clock::time_point now = Clock::now();
+    stats.wall_ms           = std::chrono::duration<double, std::milli>(now - start.wall).count();
+    stats.cpu_ms            = std::max(0., process_cpu_time_ms() - start.cpu_ms);
+    stats.peak_memory       = peak_memory_usage();
+    stats.memory_delta      = int64_t(current_memory_usage()) - int64_t(start.memory);
+
+    std::thread::id thread_id = std::this_thread::get_id();
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    stats.start_ms = std::chrono::duration<double, std::milli>(start.wall - m_epoch).count();
+    auto it = std::find(m_threads.begin(), m_threads.end(), thread_id);
+    stats.thread = unsigned(it - m_threads.begin());
+    if (it == m_threads.end())
+        m_threads.emplace_back(thread_id);
+    m_stats.emplace_back(std::move(stats));
+}
+
+std::vector<PrintStepStats> PrintStepStatsCollector::stats() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::string format_step_stats(const std::vector<PrintStepStats> &stats)
+{
+    std::string out = (boost::format("%-32s %-24s %10s %10s %12s %8s %10s %10s\n") %
+        "object" % "step" % "wall [ms]" % "cpu [ms]" % "memory [MB]" % "layers" % "paths" % "polygons").str();
+    for (const PrintStepStats &s : stats)
+        out += (boost::format("%-32s %-24s %10.1f %10.1f %12.1f %8d %10d %10d\n") %
+            (s.is_object_step() ? s.object_name : std::string("-")) % s.step_name % s.wall_ms % s.cpu_ms %
+            (double(s.memory_delta) / (1024. * 1024.)) % s.layers % s.paths % s.polygons).str();
+    return out;
+}
+
+bool export_step_stats_chrome_trace(const std::vector<PrintStepStats> &stats, const std::string &path)
+{
+    nlohmann::json events = nlohmann::json::array();
+    for (const PrintStepStats &s : stats)
+        events.push_back({
+            { "name", s.is_object_step() ? s.step_name + " " + s.object_name : s.step_name },
+            { "cat",  s.is_object_step() ? "PrintObject" : "Print" },
+            { "ph",   "X" },
+            // Chrome trace time stamps are in microseconds.
+            { "ts",   int64_t(s.start_ms * 1000.) },
+            { "dur",  int64_t(s.wall_ms * 1000.) },
+            { "pid",  0 },
+            { "tid",  s.thread },
+            { "args", {
+                { "cpu_ms",            s.cpu_ms },
+                { "peak_memory",       s.peak_memory },
+                { "memory_delta",      s.memory_delta },
+                { "layers",            s.layers },
+                { "paths",             s.paths },
+                { "polygons",          s.polygons } } }
+        });
+    boost::nowide::ofstream file(path);
+    file << nlohmann::json{ { "traceEvents", events }, { "displayTimeUnit", "ms" } }.dump();
+    file.close();
+    return ! file.fail();
+}
+
+} // namespace Slic3r
@@ -0,0 +1,104 @@
+#ifndef slic3r_PrintStepStats_hpp_
+#define slic3r_PrintStepStats_hpp_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ObjectID.hpp"
+
+namespace Slic3r {
+
+// Wall time, CPU time, memory and item counts of a single finished Print or PrintObject step.
+// Recorded by PrintBaseWithState / PrintObjectBaseWithState between set_started() and set_done(),
+// thus the statistics are always collected, not only with SLIC3R_PROFILE.
+struct PrintStepStats
+{
+    // ObjectID of the PrintObject, invalid for the Print steps.
+    ObjectID        object_id;
+    // Name of the ModelObject, empty for the Print steps.
+    std::string     object_name;
+    // PrintStep or PrintObjectStep.
+    int             step { -1 };
+    std::string     step_name;
+
+    // Start of the step relative to the last PrintStepStatsCollector::clear() call.
+    double          start_ms { 0. };
+    double          wall_ms { 0. };
+    // CPU time of the whole process including the worker threads. The PrintObject steps of multiple objects
+    // may run concurrently, in that case the CPU time of the concurrently running steps is counted by all of them.
+    double          cpu_ms { 0. };
+    // Peak resident memory of the process at the end of the step.
+    size_t          peak_memory { 0 };
+    // Change of the resident memory of the process during the step, negative if the step released more than it allocated.
+    // Like the CPU time, it includes the memory allocated and released by the concurrently running steps.
+    int64_t         memory_delta { 0 };
+
+    // Number of layers, extrusion paths and polygons produced by the step, zero if not applicable.
+    // Counted by the step while producing the layers, see PrintStepCounters.
+    size_t          layers { 0 };
+    size_t          paths { 0 };
+    size_t          polygons { 0 };
+
+    // Sequential index of the thread the step was executed by.
+    unsigned int    thread { 0 };
+
+    bool            is_object_step() const { return object_id.valid(); }
+};
+
+// Item counts of a running step, the worker threads of the step add the counts of the layers they produced.
+struct PrintStepCounters
+{
+    std::atomic<size_t> layers { 0 };
+    std::atomic<size_t> paths { 0 };
+    std::atomic<size_t> polygons { 0 };
+
+    void reset() { layers = 0; paths = 0; polygons = 0; }
+    void add_layer(size_t num_paths, size_t num_polygons) { ++ layers; paths += num_paths; polygons += num_polygons; }
+    void copy_to(PrintStepStats &stats) const { stats.layers = layers; stats.paths = paths; stats.polygons = polygons; }
+};
+
+// Thread safe collection of PrintStepStats owned by PrintBase.
+class PrintStepStatsCollector
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // State sampled when a step was started.
+    struct Start
+    {
+        bool                valid { false };
+        Clock::time_point   wall;
+        double              cpu_ms { 0. };
+        size_t              memory { 0 };
+    };
+
+    PrintStepStatsCollector() { this->clear(); }
+
+    // Drops the collected statistics and restarts the time line.
+    void                        clear();
+    static Start                start();
+    // Fills in the time and memory fields of stats measured from start, then stores the stats.
+    void                        finish(const Start &start, PrintStepStats &&stats);
+    std::vector<PrintStepStats> stats() const;
+
+private:
+    mutable std::mutex                  m_mutex;
+    Clock::time_point                   m_epoch;
+    std::vector<PrintStepStats>         m_stats;
+    std::vector<std::thread::id>        m_threads;
+};
+
+// Human readable table of the step statistics, one line per step.
+std::string format_step_stats(const std::vector<PrintStepStats> &stats);
+// Export the step statistics in the Chrome trace event format to be viewed by chrome://tracing or Perfetto.
+// Returns false if the file could not be written.
+bool        export_step_stats_chrome_trace(const std::vector<PrintStepStats> &stats, const std::string &path);
+
+} // namespace Slic3r
+
+#endif // slic3r_PrintStepStats_hpp_
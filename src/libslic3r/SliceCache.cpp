@@ -0,0 +1,354 @@
+#include "SliceCache.hpp"
+#include "Print.hpp"
+#include "Model.hpp"
+#include "Utils.hpp"
+#include "MD5Hasher.hpp"
+#include "libslic3r_version.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace Slic3r {
+
+// Extension of the cache entries, they are stored in the format of Print::export_cached_data().
+static const char *SLICE_CACHE_ENTRY_EXTENSION = ".json";
+// Extension of the entries being written.
+static const char *SLICE_CACHE_TEMP_EXTENSION  = ".tmp";
+// Temp entries older than this are left over by a crashed or killed process and they are removed by evict().
+static constexpr std::time_t SLICE_CACHE_STALE_TEMP_AGE = 24 * 60 * 60;
+// Version of the cache entries, hashed into their keys. To be increased whenever the format of the cached data changes
+// or the cached PrintObject steps produce different results, so that the entries of the older versions are not loaded.
+static constexpr int         SLICE_CACHE_FORMAT_VERSION = 1;
+
+namespace {
+
+// Keys of PrintObjectConfig and PrintRegionConfig, which do not change the cached PrintObject steps: the keys, for which
+// PrintObject::invalidate_state_by_config_options() invalidates the G-code export or the wipe tower only, and the speeds
+// it invalidates the supports with to regenerate the brim. All the other keys invalidate some of the cached steps.
+// Some of them are compared by Layer::is_perimeter_compatible() and by the grouping of the infills, thus only
+// the partition of the regions by their values is hashed for these keys, see KeyHasher::region_partition().
+const std::unordered_set<std::string> object_config_keys_not_cached = {
+    // Speeds
+    "outer_wall_speed",
+    "inner_wall_speed",
+    "small_perimeter_speed",
+    "small_perimeter_threshold",
+    "sparse_infill_speed",
+    "internal_solid_infill_speed",
+    "top_surface_speed",
+    "support_speed",
+    "support_interface_speed",
+    "overhang_1_4_speed",
+    "overhang_2_4_speed",
+    "overhang_3_4_speed",
+    "overhang_4_4_speed",
+    "bridge_speed",
+    "internal_bridge_speed",
+    // Seams
+    "seam_position",
+    "seam_slope_type",
+    "seam_slope_conditional",
+    "scarf_angle_threshold",
+    "scarf_overhang_threshold",
+    "scarf_joint_speed",
+    "scarf_joint_flow_ratio",
+    "seam_slope_start_height",
+    "seam_slope_entire_loop",
+    "seam_slope_min_length",
+    "seam_slope_steps",
+    "seam_slope_inner_walls",
+    // Bed mesh
+    "bed_mesh_min",
+    "bed_mesh_max",
+    "adaptive_bed_mesh_margin",
+    "bed_mesh_probe_distance",
+    // Wipe tower
+    "flush_into_infill",
+    "flush_into_objects",
+    "flush_into_support"
+};
+
+// Hashes the configurations of the PrintObject and of its regions, the painted facets.
+class KeyHasher : public MD5Hasher
+{
+public:
+    // Hash the options of config with keys out of the set.
+    void config(const ConfigBase &config, const std::unordered_set<std::string> &keys_not_hashed) {
+        for (const t_config_option_key &opt_key : config.keys())
+            if (keys_not_hashed.find(opt_key) == keys_not_hashed.end())
+                this->option(config, opt_key);
+    }
+    // Hash the options of the print config except those influencing the G-code export, the wipe tower or the skirt and brim only,
+    // thus all options, for which Print::invalidate_state_by_config_options() invalidates any PrintObject step.
+    void print_config(const PrintConfig &config) {
+        for (const t_config_option_key &opt_key : config.keys())
+            if (! Print::is_config_option_of_print_steps_only(opt_key))
+                this->option(config, opt_key);
+    }
+    // For each key of the set, hash which of the configs have equal values, not the values.
+    void region_partition(const std::vector<const ConfigBase*> &configs, const std::unordered_set<std::string> &keys) {
+        if (configs.empty())
+            return;
+        // Iterate over the keys of the config, as the order of the set differs between the standard libraries.
+        for (const t_config_option_key &opt_key : configs.front()->keys()) {
+            if (keys.find(opt_key) == keys.end())
+                continue;
+            this->string(opt_key);
+            std::vector<std::string> values;
+            values.reserve(configs.size());
+            for (const ConfigBase *config : configs) {
+                values.emplace_back(config->opt_serialize(opt_key));
+                // Index of the first config with the same value.
+                this->value(size_t(std::find(values.begin(), values.end(), values.back()) - values.begin()));
+            }
+        }
+    }
+    void facets(const FacetsAnnotation &facets) {
+        const TriangleSelector::TriangleSplittingData &data = facets.get_data();
+        this->value(data.triangles_to_split.size());
+        for (const TriangleSelector::TriangleBitStreamMapping &mapping : data.triangles_to_split) {
+            this->value(mapping.triangle_idx);
+            this->value(mapping.bitstream_start_idx);
+        }
+        this->values(data.bitstream);
+    }
+};
+
+} // namespace
+
+SliceCache::SliceCache(const std::string &directory, size_t max_size_bytes) : m_directory(directory), m_max_size(max_size_bytes)
+{
+    try {
+        fs::create_directories(m_directory);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << "SliceCache: failed to create directory " << m_directory << ": " << err.what();
+    }
+}
+
+SliceCache::~SliceCache()
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_writer_mutex);
+        m_exit = true;
+    }
+    m_writer_condition.notify_all();
+    if (m_writer_thread.joinable())
+        m_writer_thread.join();
+}
+
+std::string SliceCache::print_object_key(const PrintObject &print_object)
+{
+    KeyHasher hasher;
+    // Invalidate the cache entries produced by other versions, the cached data format or the algorithms may have changed.
+    hasher.value(SLICE_CACHE_FORMAT_VERSION);
+    hasher.string(SLIC3R_VERSION);
+
+    // Only the configuration the cached steps depend on is hashed, so that changing speeds, temperatures or G-code templates
+    // or placing the object on another plate hits the cache.
+    hasher.print_config(print_object.print()->config());
+    // Filament options are indexed by the extruders of the regions, the number of the extruders is given by the filament diameters.
+    hasher.option(print_object.print()->config(), "filament_diameter");
+    // Read by the curled extrusions estimation, changing the filament types invalidates the wipe tower only.
+    hasher.option(print_object.print()->config(), "filament_type");
+    // Read by the curled extrusions estimation from the default object configuration.
+    hasher.value(print_object.print()->default_object_config().inner_wall_acceleration.value);
+    hasher.config(print_object.config(), object_config_keys_not_cached);
+    hasher.value(print_object.num_printing_regions());
+    std::vector<const ConfigBase*> region_configs;
+    for (size_t region_id = 0; region_id < print_object.num_printing_regions(); ++ region_id) {
+        const PrintRegionConfig &region_config = print_object.printing_region(region_id).config();
+        hasher.config(region_config, object_config_keys_not_cached);
+        region_configs.emplace_back(&region_config);
+    }
+    // Regions differing in these keys only are not merged into a single perimeter or infill group.
+    hasher.region_partition(region_configs, object_config_keys_not_cached);
+
+    hasher.transform(print_object.trafo());
+    hasher.value(print_object.center_offset().x());
+    hasher.value(print_object.center_offset().y());
+
+    const ModelObject *model_object = print_object.model_object();
+    hasher.values(model_object->layer_height_profile.get());
+    hasher.value(model_object->layer_config_ranges.size());
+    for (const auto &[range, config] : model_object->layer_config_ranges) {
+        hasher.value(range.first);
+        hasher.value(range.second);
+        hasher.config(config.get(), object_config_keys_not_cached);
+    }
+    hasher.config(model_object->config.get(), object_config_keys_not_cached);
+
+    hasher.value(model_object->volumes.size());
+    for (const ModelVolume *volume : model_object->volumes) {
+        hasher.value(volume->type());
+        hasher.transform(volume->get_matrix());
+        hasher.config(volume->config.get(), object_config_keys_not_cached);
+        hasher.mesh(volume->mesh().its);
+        hasher.facets(volume->supported_facets);
+        hasher.facets(volume->seam_facets);
+        hasher.facets(volume->mmu_segmentation_facets);
+        hasher.facets(volume->fuzzy_skin_facets);
+    }
+    return hasher.hex_digest();
+}
+
+std::string SliceCache::entry_path(const std::string &key) const
+{
+    return (fs::path(m_directory) / (key + SLICE_CACHE_ENTRY_EXTENSION)).string();
+}
+
+std::string SliceCache::temp_entry_path(const std::string &key)
+{
+    return (fs::path(m_directory) / (boost::format("%1%%2%.%3%-%4%%5%") % key % SLICE_CACHE_ENTRY_EXTENSION % get_current_pid() % m_temp_counter ++ % SLICE_CACHE_TEMP_EXTENSION).str()).string();
+}
+
+std::string SliceCache::lookup(const std::string &key)
+{
+    std::string path = this->entry_path(key);
+    boost::system::error_code ec;
+    // Don't touch the entry while another thread evicts.
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    if (fs::exists(path, ec)) {
+        // Mark as the most recently used entry.
+        fs::last_write_time(path, std::time(nullptr), ec);
+        return path;
+    }
+    ++ m_misses;
+    BOOST_LOG_TRIVIAL(info) << "SliceCache: miss " << key;
+    return {};
+}
+
+bool SliceCache::store(const std::string &key, const std::string &temp_path)
+{
+    boost::system::error_code ec;
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    fs::rename(temp_path, this->entry_path(key), ec);
+    if (ec) {
+        BOOST_LOG_TRIVIAL(error) << "SliceCache: failed to store " << key << ": " << ec.message();
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    this->evict();
+    return true;
+}
+
+void SliceCache::store_in_background(const std::string &key, std::function<bool(const std::string &temp_path)> write)
+{
+    {
+        std::scoped_lock<std::mutex> lock(m_writer_mutex);
+        m_pending.push_back({ key, std::move(write) });
+        if (! m_writer_thread.joinable())
+            m_writer_thread = std::thread([this]() { this->writer_thread(); });
+    }
+    m_writer_condition.notify_all();
+}
+
+void SliceCache::wait_for_background_stores()
+{
+    std::unique_lock<std::mutex> lock(m_writer_mutex);
+    m_writer_condition.wait(lock, [this]() { return m_pending.empty() && ! m_writing; });
+}
+
+void SliceCache::writer_thread()
+{
+    std::unique_lock<std::mutex> lock(m_writer_mutex);
+    for (;;) {
+        // The pending entries are written before exiting, they were already computed.
+        m_writer_condition.wait(lock, [this]() { return ! m_pending.empty() || m_exit; });
+        if (m_pending.empty())
+            break;
+        PendingEntry entry = std::move(m_pending.front());
+        m_pending.pop_front();
+        m_writing = true;
+        lock.unlock();
+        std::string temp_path = this->temp_entry_path(entry.key);
+        if (entry.write(temp_path))
+            this->store(entry.key, temp_path);
+        else {
+            boost::system::error_code ec;
+            fs::remove(temp_path, ec);
+        }
+        // Release the data captured by the writer before reporting the entry as stored.
+        entry = {};
+        lock.lock();
+        m_writing = false;
+        m_writer_condition.notify_all();
+    }
+}
+
+void SliceCache::loaded(const std::string &key)
+{
+    ++ m_hits;
+    BOOST_LOG_TRIVIAL(info) << "SliceCache: hit " << key;
+}
+
+void SliceCache::remove(const std::string &key)
+{
+    ++ m_misses;
+    BOOST_LOG_TRIVIAL(info) << "SliceCache: failed to load " << key;
+    boost::system::error_code ec;
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    fs::remove(this->entry_path(key), ec);
+}
+
+void SliceCache::evict()
+{
+    struct Entry {
+        fs::path    path;
+        uintmax_t   size;
+        std::time_t time;
+    };
+    std::vector<Entry> entries;
+    std::vector<fs::path> stale_temps;
+    uintmax_t          total_size = 0;
+    const std::time_t  now        = std::time(nullptr);
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(m_directory, ec), end; ! ec && it != end; it.increment(ec)) {
+        if (! fs::is_regular_file(it->status()))
+            continue;
+        boost::system::error_code ec_entry;
+        if (it->path().extension() == SLICE_CACHE_ENTRY_EXTENSION) {
+            Entry entry { it->path(), fs::file_size(it->path(), ec_entry), fs::last_write_time(it->path(), ec_entry) };
+            if (! ec_entry) {
+                total_size += entry.size;
+                entries.emplace_back(std::move(entry));
+            }
+        } else if (it->path().extension() == SLICE_CACHE_TEMP_EXTENSION) {
+            // Temp entries being written by other processes are recent, the old ones will never be committed.
+            std::time_t time = fs::last_write_time(it->path(), ec_entry);
+            if (! ec_entry && now - time > SLICE_CACHE_STALE_TEMP_AGE)
+                stale_temps.emplace_back(it->path());
+        }
+    }
+    for (const fs::path &path : stale_temps)
+        fs::remove(path, ec);
+    if (! stale_temps.empty())
+        BOOST_LOG_TRIVIAL(info) << boost::format("SliceCache: removed %1% stale temp entries") % stale_temps.size();
+    if (total_size <= m_max_size)
+        return;
+    // The least recently used entries first.
+    std::sort(entries.begin(), entries.end(), [](const Entry &l, const Entry &r) { return l.time < r.time; });
+    size_t num_evicted = 0;
+    for (const Entry &entry : entries) {
+        if (total_size <= m_max_size)
+            break;
+        if (fs::remove(entry.path, ec)) {
+            total_size -= entry.size;
+            ++ num_evicted;
+        }
+    }
+    BOOST_LOG_TRIVIAL(info) << boost::format("SliceCache: evicted %1% entries, cache size %2% bytes") % num_evicted % total_size;
+}
+
+void SliceCache::log_statistics() const
+{
+    BOOST_LOG_TRIVIAL(info) << boost::format("SliceCache: %1% hits, %2% misses") % m_hits.load() % m_misses.load();
+}
+
+} // namespace Slic3r
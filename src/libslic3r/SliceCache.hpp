@@ -0,0 +1,89 @@
+#ifndef slic3r_SliceCache_hpp_
+#define slic3r_SliceCache_hpp_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Slic3r {
+
+class PrintObject;
+
+// Content addressed on-disk cache of the PrintObject processing results (slices, perimeters, infill, supports).
+// Each entry is a single file named after the MD5 key of the PrintObject input, see SliceCache::print_object_key().
+// The entries are stored in the format of Print::export_cached_data(), the least recently used entries
+// are evicted once the total size of the cache exceeds the size limit.
+// All methods are thread safe, entries of different PrintObjects are stored and loaded concurrently by Print::process().
+class SliceCache
+{
+public:
+    SliceCache(const std::string &directory, size_t max_size_bytes);
+    // Waits for the entries being stored in the background.
+    ~SliceCache();
+
+    const std::string&  directory() const { return m_directory; }
+    size_t              max_size() const { return m_max_size; }
+
+    // Hash of everything the PrintObject processing steps depend on: the meshes and transformations of the ModelVolumes,
+    // painted facets, layer height profile and ranges, object and region configurations and the print configuration options
+    // invalidating any of the cached steps. Options influencing the G-code export, the wipe tower or the skirt and brim only,
+    // like speeds or G-code templates, are not hashed.
+    static std::string  print_object_key(const PrintObject &print_object);
+
+    // Returns path to the cached entry for the key or an empty string if there is none.
+    // Counts the cache misses, marks the entry as the most recently used one.
+    std::string         lookup(const std::string &key);
+    // Counts a cache hit, to be called after the entry returned by lookup() was loaded.
+    void                loaded(const std::string &key);
+    // Unique path to write a new entry to, so that processes and threads storing the same key do not write the same file.
+    // The file shall be committed by store() after it was written completely.
+    std::string         temp_entry_path(const std::string &key);
+    // Moves the temp entry written at temp_path into the cache, evicts the least recently used entries over the size limit.
+    bool                store(const std::string &key, const std::string &temp_path);
+    // Writes a new entry on the background thread of the cache, so that a cache miss does not slow down the slicing.
+    // The writer receives the temp entry path and returns false if it failed, the entry is then committed by store().
+    void                store_in_background(const std::string &key, std::function<bool(const std::string &temp_path)> write);
+    // Waits until the entries passed to store_in_background() are stored.
+    void                wait_for_background_stores();
+    // Removes an entry, which failed to load, and counts a cache miss.
+    void                remove(const std::string &key);
+
+    size_t              hits() const { return m_hits; }
+    size_t              misses() const { return m_misses; }
+    // Log number of cache hits and misses.
+    void                log_statistics() const;
+
+private:
+    std::string         entry_path(const std::string &key) const;
+    // To be called with m_mutex locked.
+    void                evict();
+    void                writer_thread();
+
+    std::string         m_directory;
+    size_t              m_max_size;
+    std::mutex          m_mutex;
+    std::atomic<size_t> m_hits   { 0 };
+    std::atomic<size_t> m_misses { 0 };
+    std::atomic<size_t> m_temp_counter { 0 };
+
+    // Entries to be written by m_writer_thread, guarded by m_writer_mutex.
+    struct PendingEntry {
+        std::string                                         key;
+        std::function<bool(const std::string &temp_path)>   write;
+    };
+    std::deque<PendingEntry>    m_pending;
+    bool                        m_writing { false };
+    bool                        m_exit { false };
+    std::mutex                  m_writer_mutex;
+    std::condition_variable     m_writer_condition;
+    std::thread                 m_writer_thread;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_SliceCache_hpp_
@@ -138,14 +138,15 @@ float estimate_curled_up_height(
     return curled_up_height;
 }
 
-void estimate_malformations(LayerPtrs &layers, const Params &params)
+size_t estimate_malformations(LayerPtrs &layers, const Params &params)
 {
 #ifdef DEBUG_FILES
     FILE *debug_file = boost::nowide::fopen(debug_out_path("object_malformations.obj").c_str(), "w");
     FILE *full_file  = boost::nowide::fopen(debug_out_path("object_full.obj").c_str(), "w");
 #endif
 
-    LD prev_layer_lines{};
+    LD     prev_layer_lines{};
+    size_t num_curled_lines = 0;
 
     for (Layer *l : layers) {
         l->curled_lines.clear();
@@ -192,6 +193,7 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
                 l->curled_lines.push_back(CurledLine{Point::new_scale(line.a), Point::new_scale(line.b), line.curled_up_height});
             }
         }
+        num_curled_lines += l->curled_lines.size();
 
 #ifdef DEBUG_FILES
         for (const ExtrusionLine &line : current_layer_lines) {
@@ -213,6 +215,7 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
     fclose(debug_file);
     fclose(full_file);
 #endif
+    return num_curled_lines;
 }
 
 /*
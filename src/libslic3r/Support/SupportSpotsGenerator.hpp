@@ -80,7 +80,8 @@ struct Params
     }
 };
 
-void estimate_malformations(std::vector<Layer *> &layers, const Params &params);
+// Returns the number of curled lines stored into the layers.
+size_t estimate_malformations(std::vector<Layer *> &layers, const Params &params);
 
 
 enum class SupportPointCause { 
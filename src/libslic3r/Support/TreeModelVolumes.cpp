@@ -67,6 +67,18 @@ TreeModelVolumes::TreeModelVolumes(
     m_machine_border{ calculateMachineBorderCollision(build_volume.polygon()) }
 {
     m_bed_area = build_volume.polygon();
+    // All the caches are compressed over the memory limit, the inflated copies are dropped by release_layers_from().
+    m_collision_cache                  .set_stats(m_cache_stats.get(), true);
+    m_collision_cache_holefree         .set_stats(m_cache_stats.get(), true);
+    m_avoidance_cache                  .set_stats(m_cache_stats.get(), true);
+    m_avoidance_cache_slow             .set_stats(m_cache_stats.get(), true);
+    m_avoidance_cache_to_model         .set_stats(m_cache_stats.get(), true);
+    m_avoidance_cache_to_model_slow    .set_stats(m_cache_stats.get(), true);
+    m_placeable_areas_cache            .set_stats(m_cache_stats.get(), true);
+    m_avoidance_cache_holefree         .set_stats(m_cache_stats.get(), true);
+    m_avoidance_cache_holefree_to_model.set_stats(m_cache_stats.get(), true);
+    m_wall_restrictions_cache          .set_stats(m_cache_stats.get(), true);
+    m_wall_restrictions_cache_min      .set_stats(m_cache_stats.get(), true);
 #if 0
     std::unordered_map<size_t, size_t> mesh_to_layeroutline_idx;
     for (size_t mesh_idx = 0; mesh_idx < storage.meshes.size(); ++ mesh_idx) {
@@ -239,6 +251,15 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
 
     auto t_coll = std::chrono::high_resolution_clock::now();
 
+    if (m_cache_stats->limit > 0) {
+        // With a memory limit, the avoidances and wall restrictions are calculated on demand for the radii actually requested,
+        // thus the peak memory is not driven by all the relevant radii of all the layers being calculated upfront.
+        m_precalculated = false;
+        BOOST_LOG_TRIVIAL(info) << "Precalculating collision took" << 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_coll - t_start).count() <<
+            " ms. Avoidances are calculated on demand due to the memory limit.";
+        return;
+    }
+
     // Calculate the relevant avoidances in parallel as far as possible
     {
         tbb::task_group task_group;
@@ -291,6 +312,33 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
 #endif
 }
 
+void TreeModelVolumes::release_layers_from(LayerIndex layer_idx)
+{
+    if (m_cache_stats->limit == 0)
+        return;
+    const bool over_limit = m_cache_stats->over_limit();
+    for (RadiusLayerPolygonCache *cache : { &m_avoidance_cache, &m_avoidance_cache_slow, &m_avoidance_cache_to_model, &m_avoidance_cache_to_model_slow,
+                                            &m_avoidance_cache_holefree, &m_avoidance_cache_holefree_to_model, &m_wall_restrictions_cache, &m_wall_restrictions_cache_min }) {
+        if (over_limit)
+            cache->release_layers_from(layer_idx);
+        cache->release_inflated();
+    }
+    // The collisions and the placeable areas are kept for all the layers, as the drawing of the branches and
+    // get_collision_lower_bound_area() read them after the propagation, only their inflated copies are dropped.
+    for (RadiusLayerPolygonCache *cache : { &m_collision_cache, &m_collision_cache_holefree, &m_placeable_areas_cache })
+        cache->release_inflated();
+}
+
+void TreeModelVolumes::log_cache_stats() const
+{
+    const size_t hits     = m_cache_stats->hits;
+    const size_t requests = hits + m_cache_stats->misses;
+    BOOST_LOG_TRIVIAL(info) << "Tree support volume caches: " << hits << " of " << requests << " requests hit (" <<
+        (requests == 0 ? 100. : 100. * double(hits) / double(requests)) << "%), peak memory " <<
+        double(m_cache_stats->peak_bytes) / (1024. * 1024.) << " MB, memory limit " << double(m_cache_stats->limit) / (1024. * 1024.) << " MB, " <<
+        m_cache_stats->compressed << " layers compressed";
+}
+
 const Polygons& TreeModelVolumes::getCollision(const coord_t orig_radius, LayerIndex layer_idx, bool min_xy_dist) const
 {
     const coord_t radius = this->ceilRadius(orig_radius, min_xy_dist);
@@ -869,6 +917,155 @@ void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layer
     }
 }
 
+// Polygons compressed as zigzag varint encoded coordinate deltas, see RadiusLayerPolygonCache::Entry.
+static void append_varint(std::vector<uint8_t> &out, uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        out.emplace_back(uint8_t(v) | 0x80);
+    out.emplace_back(uint8_t(v));
+}
+
+static uint64_t read_varint(const uint8_t *&p)
+{
+    uint64_t v = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t b = *p ++;
+        v |= uint64_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return v;
+    }
+}
+
+static inline uint64_t zigzag(int64_t v)   { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+static inline int64_t  unzigzag(uint64_t v) { return int64_t(v >> 1) ^ - int64_t(v & 1); }
+
+std::vector<uint8_t> compress_polygons(const Polygons &polygons)
+{
+    std::vector<uint8_t> out;
+    // Deltas of neighbor points mostly fit into two bytes.
+    out.reserve(count_points(polygons) * 4 + polygons.size() * 2 + 2);
+    append_varint(out, polygons.size());
+    for (const Polygon &polygon : polygons) {
+        append_varint(out, polygon.size());
+        Point prev = Point::Zero();
+        for (const Point &pt : polygon.points) {
+            append_varint(out, zigzag(int64_t(pt.x()) - int64_t(prev.x())));
+            append_varint(out, zigzag(int64_t(pt.y()) - int64_t(prev.y())));
+            prev = pt;
+        }
+    }
+    out.shrink_to_fit();
+    return out;
+}
+
+Polygons decompress_polygons(const std::vector<uint8_t> &data)
+{
+    const uint8_t *p = data.data();
+    Polygons out(read_varint(p));
+    for (Polygon &polygon : out) {
+        polygon.points.assign(read_varint(p), Point::Zero());
+        Point prev = Point::Zero();
+        for (Point &pt : polygon.points) {
+            pt.x() = coord_t(int64_t(prev.x()) + unzigzag(read_varint(p)));
+            pt.y() = coord_t(int64_t(prev.y()) + unzigzag(read_varint(p)));
+            prev = pt;
+        }
+    }
+    assert(p == data.data() + data.size());
+    return out;
+}
+
+size_t TreeModelVolumes::RadiusLayerPolygonCache::memory(const Entry &entry) const
+{
+    size_t out = entry.compressed.capacity() + entry.polygons.capacity() * sizeof(Polygon);
+    for (const Polygon &polygon : entry.polygons)
+        out += polygon.points.capacity() * sizeof(Point);
+    return out;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::emplace(LayerData &layer, coord_t radius, Polygons &&polygons)
+{
+    auto [it, inserted] = layer.emplace(radius, Entry{ std::move(polygons), {} });
+    if (! inserted || ! m_stats)
+        return;
+    // A new entry is not referenced by anyone yet, thus it may be compressed.
+    if (m_compress_over_limit && m_stats->over_limit() && ! it->second.polygons.empty()) {
+        it->second.compressed = compress_polygons(it->second.polygons);
+        it->second.polygons   = Polygons();
+        ++ m_stats->compressed;
+    }
+    m_stats->add_bytes(this->memory(it->second));
+}
+
+const Polygons& TreeModelVolumes::RadiusLayerPolygonCache::inflate(Entry &entry) const
+{
+    if (! entry.compressed.empty() && entry.polygons.empty()) {
+        // Keep the compressed copy, release_inflated() drops the inflated one.
+        entry.polygons = decompress_polygons(entry.compressed);
+        ++ m_num_inflated;
+        if (m_stats)
+            m_stats->add_bytes(this->memory(entry) - entry.compressed.capacity());
+    }
+    return entry.polygons;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::release_inflated()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto it_layer = m_data.begin(); m_num_inflated > 0 && it_layer != m_data.end(); ++ it_layer)
+        for (auto &radius_entry : *it_layer)
+            if (Entry &entry = radius_entry.second; ! entry.compressed.empty() && ! entry.polygons.empty()) {
+                if (m_stats)
+                    m_stats->remove_bytes(this->memory(entry) - entry.compressed.capacity());
+                entry.polygons = Polygons();
+                -- m_num_inflated;
+            }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_stats)
+        for (const LayerData &layer : m_data)
+            for (const auto &radius_entry : layer)
+                m_stats->remove_bytes(this->memory(radius_entry.second));
+    m_data.clear();
+    m_num_inflated = 0;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (LayerData &l : m_data) {
+        auto begin = l.begin();
+        auto end = l.end();
+        if (begin != end && ++ begin != end) {
+            for (auto it = begin; it != end; ++ it) {
+                if (m_stats)
+                    m_stats->remove_bytes(this->memory(it->second));
+                if (! it->second.compressed.empty() && ! it->second.polygons.empty())
+                    -- m_num_inflated;
+            }
+            l.erase(begin, end);
+        }
+    }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::release_layers_from(LayerIndex layer_idx)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (layer_idx >= LayerIndex(m_data.size()))
+        return;
+    for (auto it = m_data.begin() + std::max(0, layer_idx); it != m_data.end(); ++ it)
+        for (const auto &radius_entry : *it) {
+            if (m_stats)
+                m_stats->remove_bytes(this->memory(radius_entry.second));
+            if (! radius_entry.second.compressed.empty() && ! radius_entry.second.polygons.empty())
+                -- m_num_inflated;
+        }
+    m_data.resize(std::max(0, layer_idx));
+}
+
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
@@ -876,7 +1073,7 @@ std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<
     for (auto &layer : m_data) {
         auto layer_idx = LayerIndex(&layer - m_data.data());
         for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
+            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), this->inflate(radius_polygons.second));
     }
     assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
     return out;
@@ -9,6 +9,7 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -86,6 +87,27 @@ public:
      */
     void precalculate(const PrintObject& print_object, const coord_t max_layer, std::function<void()> throw_on_cancel);
 
+    /*!
+     * \brief Limit the memory used by the caches in bytes. Zero (the default) keeps all the calculated areas uncompressed.
+     *
+     * All the caches are accounted: the collisions, the placeable areas, the avoidances and the wall restrictions.
+     * With a limit, precalculate() leaves the avoidances and wall restrictions to be calculated on demand.
+     * Over the limit, newly calculated areas of all the caches are stored compressed and inflated on access,
+     * and release_layers_from() drops the avoidances and wall restrictions of the layers the propagation
+     * of the influence areas already passed.
+     */
+    void set_memory_limit(size_t limit) { m_cache_stats->limit = limit; }
+    /*!
+     * \brief Drop the avoidances and wall restrictions at layer_idx and above if over the memory limit,
+     * drop the inflated copies of the compressed areas of all the caches.
+     *
+     * Must only be called while no reference to the areas is held. Dropped areas are recalculated on demand.
+     * The collisions and the placeable areas are kept for all the layers.
+     */
+    void release_layers_from(LayerIndex layer_idx);
+    // Log hit rate and peak memory of the caches.
+    void log_cache_stats() const;
+
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer.
      *
@@ -197,43 +219,74 @@ private:
      * \brief Convenience typedef for the keys to the caches
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
+
+    // Memory and hit rate statistics shared by all the caches of a TreeModelVolumes.
+    struct CacheStats {
+        // Memory limit of all the caches in bytes, zero for unlimited.
+        size_t              limit { 0 };
+        std::atomic<size_t> bytes { 0 };
+        std::atomic<size_t> peak_bytes { 0 };
+        std::atomic<size_t> hits { 0 };
+        std::atomic<size_t> misses { 0 };
+        std::atomic<size_t> compressed { 0 };
+
+        bool over_limit() const { return this->limit > 0 && this->bytes > this->limit; }
+        void add_bytes(size_t n) {
+            size_t b    = (this->bytes += n);
+            size_t peak = this->peak_bytes;
+            while (b > peak && ! this->peak_bytes.compare_exchange_weak(peak, b)) ;
+        }
+        void remove_bytes(size_t n) { this->bytes -= n; }
+    };
+
     class RadiusLayerPolygonCache {
+        struct Entry {
+            Polygons             polygons;
+            // Lossless compressed polygons of a cold layer. Polygons are inflated on access next to the compressed copy
+            // and dropped again by release_inflated().
+            std::vector<uint8_t> compressed;
+        };
         // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
+        using LayerData = std::map<coord_t, Entry>;
         // Vector of layers, at each layer map of radius to Polygons.
         // Reference to Polygons returned shall be stable to insertion.
         using Layers = std::vector<LayerData>;
     public:
         RadiusLayerPolygonCache() = default;
-        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
-        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_data = std::move(rhs.m_data); return *this; }
+        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : 
+            m_data(std::move(rhs.m_data)), m_stats(rhs.m_stats), m_compress_over_limit(rhs.m_compress_over_limit), m_num_inflated(rhs.m_num_inflated) {}
+        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { 
+            m_data = std::move(rhs.m_data); m_stats = rhs.m_stats; m_compress_over_limit = rhs.m_compress_over_limit; m_num_inflated = rhs.m_num_inflated; return *this; }
 
         RadiusLayerPolygonCache(const RadiusLayerPolygonCache&) = delete;
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
+        // Account memory and hits to stats. If compress_over_limit, the newly inserted layers are compressed while the caches are over the memory limit.
+        void set_stats(CacheStats *stats, bool compress_over_limit) { m_stats = stats; m_compress_over_limit = compress_over_limit; }
+
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
             std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+                this->emplace(this->get_allocate_layer_data(d.first.second), d.first.first, std::move(d.second));
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
             std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                this->emplace(this->get_allocate_layer_data(d.first), radius, std::move(d.second));
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
             std::lock_guard<std::mutex> guard(m_mutex);
             allocate_layers(first_layer_idx + in.size());
             for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
+                this->emplace(m_data[first_layer_idx ++], radius, std::move(d));
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
             std::lock_guard<std::mutex> guard(m_mutex);
             LayerIndex i = in.begin();
             allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
+                this->emplace(m_data[i ++], radius, std::move(d));
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -242,19 +295,24 @@ private:
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
             std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return std::optional<std::reference_wrapper<const Polygons>>{};
-            const auto &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            return it == layer.end() ? 
-                std::optional<std::reference_wrapper<const Polygons>>{} : std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+            if (key.second < LayerIndex(m_data.size())) {
+                auto &layer = m_data[key.second];
+                if (auto it = layer.find(key.first); it != layer.end()) {
+                    if (m_stats)
+                        ++ m_stats->hits;
+                    return std::optional<std::reference_wrapper<const Polygons>>{ this->inflate(it->second) };
+                }
+            }
+            if (m_stats)
+                ++ m_stats->misses;
+            return std::optional<std::reference_wrapper<const Polygons>>{};
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
             std::lock_guard<std::mutex> guard(m_mutex);
             if (key.second >= LayerIndex(m_data.size()))
                 return {};
-            const auto &layer = m_data[key.second];
+            auto &layer = m_data[key.second];
             if (layer.empty())
                 return {};
             auto it = layer.lower_bound(key.first);
@@ -263,7 +321,7 @@ private:
                     return {};
                 -- it;
             }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(this->inflate(it->second)));
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
@@ -285,15 +343,13 @@ private:
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
-        }
+        void clear();
+        void clear_all_but_radius0();
+        // Drop all layers starting with layer_idx. The caller has to make sure that no reference to the dropped polygons is being held.
+        // As the caches are filled bottom up, getMaxCalculatedLayer() will report the layer below and the dropped layers will be recalculated on demand.
+        void release_layers_from(LayerIndex layer_idx);
+        // Drop the inflated polygons of the compressed entries. The caller has to make sure that no reference to them is being held.
+        void release_inflated();
 
     private:
         LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
@@ -301,11 +357,23 @@ private:
             return m_data[layer_idx];
         }
         void                allocate_layers(size_t num_layers);
-
-        Layers              m_data;
+        // Insert polygons if not cached yet, account memory and compress them if over the memory limit.
+        void                emplace(LayerData &layer, coord_t radius, Polygons &&polygons);
+        // Decompress the entry if it is compressed. Called with m_mutex locked.
+        const Polygons&     inflate(Entry &entry) const;
+        size_t              memory(const Entry &entry) const;
+
+        // Mutable as compressed entries are inflated on access.
+        mutable Layers      m_data;
         mutable std::mutex  m_mutex;
+        CacheStats         *m_stats { nullptr };
+        bool                m_compress_over_limit { false };
+        // Number of compressed entries holding an inflated copy.
+        mutable size_t      m_num_inflated { 0 };
     };
 
+    // Exercises the caches in the unit tests.
+    friend struct TreeModelVolumesTest;
 
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
@@ -545,11 +613,18 @@ private:
     // restriction would be slower.    
     RadiusLayerPolygonCache     m_wall_restrictions_cache_min;
 
+    // Heap allocated to stay at the same address when TreeModelVolumes is moved, as the caches point to it.
+    std::unique_ptr<CacheStats> m_cache_stats { std::make_unique<CacheStats>() };
+
 #ifdef SLIC3R_TREESUPPORTS_PROGRESS
     std::unique_ptr<std::mutex> m_critical_progress { std::make_unique<std::mutex>() };
 #endif // SLIC3R_TREESUPPORTS_PROGRESS
 };
 
+// Lossless compression of polygons into zigzag varint encoded coordinate deltas, used by RadiusLayerPolygonCache.
+std::vector<uint8_t> compress_polygons(const Polygons &polygons);
+Polygons             decompress_polygons(const std::vector<uint8_t> &data);
+
 } // namespace TreeSupport3D
 } // namespace Slic3r
 
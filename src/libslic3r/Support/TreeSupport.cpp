@@ -1460,6 +1460,7 @@ void TreeSupport::generate_toolpaths()
 
                 //m_object->print()->set_status(70, (boost::format(_u8L("Support: generate toolpath at layer %d")) % layer_id).str());
 
+                ExtrusionEntityArena::Scope arena_scope;
                 SupportLayer* ts_layer = m_object->get_support_layer(layer_id);
                 Flow support_flow(support_extrusion_width, ts_layer->height, nozzle_diameter);
                 Flow interface_flow = support_material_interface_flow(m_object, ts_layer->height); // update flow using real support layer height
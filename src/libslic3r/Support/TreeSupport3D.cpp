@@ -27,10 +27,12 @@
 #include <cassert>
 #include <chrono>
 #include <fstream>
+#include <numeric>
 #include <optional>
 #include <stdio.h>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 #include <boost/log/trivial.hpp>
 
@@ -2340,7 +2342,7 @@ static SupportElementMerging* merge_influence_areas_two_sets(
 }
 
 /*!
- * \brief Merges Influence Areas at one layer if possible.
+ * \brief Merges Influence Areas of one cluster at one layer if possible.
  *
  * Branches which do overlap have to be merged. This manages the helper and uses a divide and conquer approach to parallelize this problem. This parallelization can at most accelerate the merging by a factor of 2.
  *
@@ -2351,8 +2353,9 @@ static SupportElementMerging* merge_influence_areas_two_sets(
  * \param influence_areas[in] The Elements of the current Layer without avoidances removed. This is the largest possible influence area for this layer.
  *  Value is the influence area where the center of a circle of support may be placed.
  * \param layer_idx[in] The current layer.
+ * \return Number of influence areas left at the start of influence_areas, the rest were merged and are empty.
  */
-static void merge_influence_areas(
+static size_t merge_influence_areas_cluster(
     const TreeModelVolumes             &volumes,
     const TreeSupportSettings          &config,
     const LayerIndex                    layer_idx,
@@ -2361,7 +2364,7 @@ static void merge_influence_areas(
 {
     const size_t input_size = influence_areas.size();
     if (input_size == 0)
-        return;
+        return 0;
 
     // Merging by divide & conquer.
     // The majority of time is consumed by Clipper polygon operations, intersection is accelerated by bounding boxes.
@@ -2386,13 +2389,14 @@ static void merge_influence_areas(
     size_t num_buckets_initial;
     {
         // How many buckets per first merge iteration?
-        const size_t num_threads     = tbb::this_task_arena::max_concurrency();
-        // 4 buckets per thread if possible,
+        // The bucket size shall not depend on the number of threads, as the order of merging defines the resulting trees.
+        static constexpr const size_t min_buckets_of_4 = 16;
+        // Buckets of 4 influence areas if there are enough of them,
         const size_t num_buckets_min = (input_size + 2) / 4;
-        // 2 buckets per thread otherwise.
+        // buckets of 2 influence areas otherwise.
         const size_t num_buckets_max = input_size / 2;
-        num_buckets_initial          = num_buckets_min >= num_threads ? num_buckets_min : num_buckets_max;
-        const size_t bucket_size     = num_buckets_min >= num_threads ? 4 : 2;
+        num_buckets_initial          = num_buckets_min >= min_buckets_of_4 ? num_buckets_min : num_buckets_max;
+        const size_t bucket_size     = num_buckets_min >= min_buckets_of_4 ? 4 : 2;
         // Fill in the buckets.
         SupportElementMerging *it = influence_areas.data();
         // Reserve one more bucket to keep a single influence area which will not be merged in the first iteration.
@@ -2440,6 +2444,170 @@ static void merge_influence_areas(
             buckets[i] = std::move(buckets[i * 2]);
         buckets.erase(buckets.begin() + new_size, buckets.end());
     }
+    // Number of influence areas left after merging, the areas merged into others were moved past them and emptied.
+    return buckets.front().second - influence_areas.data();
+}
+
+/*!
+ * \brief Splits influence areas into clusters, which may only merge with each other.
+ *
+ * Two influence areas may only merge if the bounding box of one of them expanded by the difference of their radii
+ * intersects the bounding box of the other, see merge_influence_areas_two_elements(). Thus influence areas are clustered
+ * if their bounding boxes expanded by half the maximum radius intersect. Candidate pairs are found through a spatial hash
+ * of the expanded bounding boxes. Influence areas of the same group are always clustered together.
+ *
+ * \return Clusters of indices into influence_areas, sorted by their lowest index, indices sorted in ascending order.
+ */
+static std::vector<std::vector<size_t>> cluster_influence_areas(
+    const TreeSupportSettings                &config,
+    const std::vector<SupportElementMerging> &influence_areas,
+    const std::vector<size_t>                &groups)
+{
+    const size_t num_areas = influence_areas.size();
+    std::vector<size_t> parent(num_areas);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    auto unite = [&parent, &find](size_t i, size_t j) {
+        i = find(i);
+        j = find(j);
+        // Lower index becomes the root, making the result independent of the order of the union operations.
+        if (i < j)
+            parent[j] = i;
+        else if (j < i)
+            parent[i] = j;
+    };
+
+    // Keep the groups together.
+    {
+        std::vector<size_t> group_first(num_areas, std::numeric_limits<size_t>::max());
+        for (size_t i = 0; i < num_areas; ++ i) {
+            size_t &first = group_first[groups[i]];
+            if (first == std::numeric_limits<size_t>::max())
+                first = i;
+            else
+                unite(first, i);
+        }
+    }
+
+    coord_t max_radius = 0;
+    for (const SupportElementMerging &area : influence_areas)
+        max_radius = std::max(max_radius, support_element_radius(config, area.state));
+    const coord_t margin = max_radius / 2 + 1;
+    std::vector<Eigen::AlignedBox<coord_t, 2>> bboxes;
+    bboxes.reserve(num_areas);
+    // Cell size of the spatial hash is the median size of the expanded bounding boxes.
+    std::vector<coord_t> sizes;
+    sizes.reserve(num_areas);
+    for (const SupportElementMerging &area : influence_areas) {
+        Eigen::AlignedBox<coord_t, 2> bbox = area.bbox();
+        bbox.min() -= Point{ margin, margin };
+        bbox.max() += Point{ margin, margin };
+        bboxes.emplace_back(bbox);
+        sizes.emplace_back(bbox.sizes().maxCoeff());
+    }
+    const coord_t max_size = *std::max_element(sizes.begin(), sizes.end());
+    std::nth_element(sizes.begin(), sizes.begin() + num_areas / 2, sizes.end());
+    // Limit the number of cells a single large bounding box is registered with.
+    const coord_t cell_size = std::max({ sizes[num_areas / 2], max_size / 64, scaled<coord_t>(1.) });
+
+    std::unordered_map<uint64_t, std::vector<size_t>> grid;
+    auto cell_key = [](int64_t ix, int64_t iy) { return (uint64_t(uint32_t(ix)) << 32) | uint64_t(uint32_t(iy)); };
+    for (size_t i = 0; i < num_areas; ++ i) {
+        const Eigen::AlignedBox<coord_t, 2> &bbox = bboxes[i];
+        const int64_t ix_min = int64_t(std::floor(double(bbox.min().x()) / cell_size));
+        const int64_t iy_min = int64_t(std::floor(double(bbox.min().y()) / cell_size));
+        const int64_t ix_max = int64_t(std::floor(double(bbox.max().x()) / cell_size));
+        const int64_t iy_max = int64_t(std::floor(double(bbox.max().y()) / cell_size));
+        for (int64_t iy = iy_min; iy <= iy_max; ++ iy)
+            for (int64_t ix = ix_min; ix <= ix_max; ++ ix) {
+                std::vector<size_t> &cell = grid[cell_key(ix, iy)];
+                for (size_t j : cell)
+                    if (find(i) != find(j) && bboxes[i].intersects(bboxes[j]))
+                        unite(i, j);
+                cell.emplace_back(i);
+            }
+    }
+
+    // Roots are the lowest indices of their clusters, thus the clusters come out sorted.
+    std::vector<std::vector<size_t>> clusters;
+    std::vector<size_t>              root_to_cluster(num_areas, std::numeric_limits<size_t>::max());
+    for (size_t i = 0; i < num_areas; ++ i) {
+        size_t &cluster = root_to_cluster[find(i)];
+        if (cluster == std::numeric_limits<size_t>::max()) {
+            cluster = clusters.size();
+            clusters.emplace_back();
+        }
+        clusters[cluster].emplace_back(i);
+    }
+    return clusters;
+}
+
+/*!
+ * \brief Merges Influence Areas at one layer if possible.
+ *
+ * Influence areas are split into clusters by cluster_influence_areas(), which are merged in parallel by merge_influence_areas_cluster().
+ * As merging changes the radii of the branches, the merged influence areas are clustered again until no cluster joins
+ * influence areas of different clusters of the previous round. The result does not depend on the number of threads.
+ */
+static void merge_influence_areas(
+    const TreeModelVolumes             &volumes,
+    const TreeSupportSettings          &config,
+    const LayerIndex                    layer_idx,
+    std::vector<SupportElementMerging> &influence_areas,
+    std::function<void()>               throw_on_cancel)
+{
+    // Cluster of the previous round for each influence area. Initially each influence area is its own cluster.
+    std::vector<size_t> groups(influence_areas.size());
+    std::iota(groups.begin(), groups.end(), 0);
+    // Emptied influence areas, which were merged into others. They are kept at the end of influence_areas as merge_influence_areas_cluster() does.
+    std::vector<SupportElementMerging> merged_away;
+    for (;;) {
+        std::vector<std::vector<size_t>> clusters = cluster_influence_areas(config, influence_areas, groups);
+        // Only clusters joining influence areas of multiple groups may be merged further.
+        std::vector<size_t> dirty;
+        for (size_t icluster = 0; icluster < clusters.size(); ++ icluster) {
+            const std::vector<size_t> &cluster = clusters[icluster];
+            if (std::any_of(cluster.begin() + 1, cluster.end(), [&groups, &cluster](size_t i){ return groups[i] != groups[cluster.front()]; }))
+                dirty.emplace_back(icluster);
+        }
+        if (dirty.empty())
+            break;
+
+        std::vector<std::vector<SupportElementMerging>> merged(clusters.size());
+        std::vector<size_t>                             num_left(clusters.size(), 0);
+        for (size_t icluster : dirty)
+            for (size_t i : clusters[icluster])
+                merged[icluster].emplace_back(std::move(influence_areas[i]));
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, dirty.size(), 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx)
+                num_left[dirty[idx]] = merge_influence_areas_cluster(volumes, config, layer_idx, merged[dirty[idx]], throw_on_cancel);
+        });
+
+        // Collect the clusters in their order.
+        std::vector<SupportElementMerging> out;
+        std::vector<size_t>                out_groups;
+        out.reserve(influence_areas.size());
+        out_groups.reserve(influence_areas.size());
+        for (size_t icluster = 0; icluster < clusters.size(); ++ icluster) {
+            if (std::vector<SupportElementMerging> &cluster = merged[icluster]; cluster.empty()) {
+                for (size_t i : clusters[icluster])
+                    out.emplace_back(std::move(influence_areas[i]));
+            } else {
+                std::move(cluster.begin(), cluster.begin() + num_left[icluster], std::back_inserter(out));
+                std::move(cluster.begin() + num_left[icluster], cluster.end(), std::back_inserter(merged_away));
+            }
+            out_groups.resize(out.size(), icluster);
+        }
+        influence_areas = std::move(out);
+        groups          = std::move(out_groups);
+        throw_on_cancel();
+    }
+    std::move(merged_away.begin(), merged_away.end(), std::back_inserter(influence_areas));
 }
 
 /*!
@@ -2447,7 +2615,7 @@ static void merge_influence_areas(
  *
  * \param move_bounds[in,out] All currently existing influence areas
  */
-static void create_layer_pathing(const TreeModelVolumes &volumes, const TreeSupportSettings &config, std::vector<SupportElements> &move_bounds, std::function<void()> throw_on_cancel)
+static void create_layer_pathing(TreeModelVolumes &volumes, const TreeSupportSettings &config, std::vector<SupportElements> &move_bounds, std::function<void()> throw_on_cancel)
 {
 #ifdef SLIC3R_TREESUPPORTS_PROGRESS
     const double data_size_inverse = 1 / double(move_bounds.size());
@@ -2535,6 +2703,9 @@ static void create_layer_pathing(const TreeModelVolumes &volumes, const TreeSupp
                     this_layer.emplace_back(elem.state, std::move(elem.parents), std::move(new_area));
                 }
 
+            // The avoidances and wall restrictions of the layers above are not needed anymore.
+            volumes.release_layers_from(layer_idx);
+
     #ifdef SLIC3R_TREESUPPORTS_PROGRESS
             progress_total += data_size_inverse * TREE_PROGRESS_AREA_CALC;
             Progress::messageProgress(Progress::Stage::SUPPORT, progress_total * m_progress_multiplier + m_progress_offset, TREE_PROGRESS_TOTAL);
@@ -3383,6 +3554,7 @@ static void generate_support_areas(Print &print, TreeSupport* tree_support, cons
             m_progress_multiplier, m_progress_offset,
 #endif // SLIC3R_TREESUPPORTS_PROGRESS
             /* additional_excluded_areas */{} };
+        volumes.set_memory_limit(print.tree_support_cache_limit());
 
         //FIXME generating overhangs just for the first mesh of the group.
         assert(processing.second.size() == 1);
@@ -3509,6 +3681,8 @@ static void generate_support_areas(Print &print, TreeSupport* tree_support, cons
                 bottom_contacts, top_contacts, interface_placer, intermediate_layers, layer_storage,
                 throw_on_cancel);
 
+            volumes.log_cache_stats();
+
             //tree_support->move_bounds_to_contact_nodes(move_bounds, print_object, config);
 
             remove_undefined_layers();
@@ -30,6 +30,8 @@
 #include <Eigen/Core>
 #include <Eigen/Dense>
 
+#include <tbb/parallel_sort.h>
+
 #include <assert.h>
 
 namespace Slic3r {
@@ -206,6 +208,7 @@ bool TriangleMesh::from_stl(stl_file& stl, bool repair)
 
     stl_generate_shared_vertices(&stl, this->its);
     fill_initial_stats(this->its, this->m_stats);
+    this->invalidate_slicing_index();
     return true;
 }
 
@@ -255,6 +258,7 @@ void TriangleMesh::scale(const Vec3f &versor)
     // Scale volume.
     if (m_stats.volume > 0.0)
         m_stats.volume *= s(0) * s(1) * s(2);
+    this->invalidate_slicing_index();
     if (versor.x() == versor.y() && versor.x() == versor.z()) {
         float s = versor.x();
         for (stl_vertex &v : this->its.vertices)
@@ -275,6 +279,7 @@ void TriangleMesh::translate(const Vec3f &displacement)
             v += displacement;
         m_stats.min += displacement;
         m_stats.max += displacement;
+        this->invalidate_slicing_index();
     }
 }
 
@@ -294,6 +299,7 @@ void TriangleMesh::rotate(float angle, const Axis &axis)
         default: assert(false);                  return;
         }
         update_bounding_box(this->its, this->m_stats);
+        this->invalidate_slicing_index();
     }
 }
 
@@ -305,6 +311,7 @@ void TriangleMesh::rotate(float angle, const Vec3d& axis)
         m.rotate(Eigen::AngleAxisd(angle, axis_norm));
         its_transform(its, m);
         update_bounding_box(this->its, this->m_stats);
+        this->invalidate_slicing_index();
     }
 }
 
@@ -332,6 +339,7 @@ void TriangleMesh::mirror(const Axis axis)
     std::swap(m_stats.min[iaxis], m_stats.max[iaxis]);
     m_stats.min[iaxis] *= -1.0;
     m_stats.max[iaxis] *= -1.0;
+    this->invalidate_slicing_index();
 }
 
 void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
@@ -344,6 +352,7 @@ void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
     }
     m_stats.volume *= det;
     update_bounding_box(this->its, this->m_stats);
+    this->invalidate_slicing_index();
 }
 
 void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
@@ -356,12 +365,14 @@ void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
     }
     m_stats.volume *= det;
     update_bounding_box(this->its, this->m_stats);
+    this->invalidate_slicing_index();
 }
 
 void TriangleMesh::flip_triangles()
 {
     its_flip_triangles(its);
     m_stats.volume = - m_stats.volume;
+    this->invalidate_slicing_index();
 }
 
 void TriangleMesh::align_to_origin()
@@ -376,6 +387,7 @@ void TriangleMesh::rotate(double angle, Point* center)
         this->translate(-c(0), -c(1), 0);
         its_rotate_z(this->its, (float)angle);
         this->translate(c(0), c(1), 0);
+        this->invalidate_slicing_index();
     }
 }
 
@@ -407,6 +419,7 @@ void TriangleMesh::merge(const TriangleMesh &mesh)
 {
     its_merge(this->its, mesh.its);
     m_stats = m_stats.merge(mesh.m_stats);
+    this->invalidate_slicing_index();
 }
 
 // Calculate projection of the mesh into the XY plane, in scaled coordinates.
@@ -508,15 +521,93 @@ std::vector<ExPolygons> TriangleMesh::slice(const std::vector<double> &z) const
 {
     // convert doubles to floats
     std::vector<float> z_f(z.begin(), z.end());
-    return slice_mesh_ex(this->its, z_f, 0.0004f);
+    MeshSlicingParamsEx params;
+    params.closing_radius = 0.0004f;
+    params.index          = this->slicing_index();
+    return slice_mesh_ex(this->its, z_f, params);
 }
 
 size_t TriangleMesh::memsize() const
 {
     size_t memsize = 8 + this->its.memsize() + sizeof(this->m_stats);
+    if (std::shared_ptr<const MeshSlicingIndex> index = std::atomic_load(&m_slicing_index); index)
+        memsize += index->memsize();
     return memsize;
 }
 
+TriangleMesh& TriangleMesh::operator=(const TriangleMesh &rhs)
+{
+    this->its          = rhs.its;
+    this->m_stats      = rhs.m_stats;
+    this->m_init_shift = rhs.m_init_shift;
+    this->invalidate_slicing_index();
+    return *this;
+}
+
+TriangleMesh& TriangleMesh::operator=(TriangleMesh &&rhs) noexcept
+{
+    if (this != &rhs) {
+        this->its          = std::move(rhs.its);
+        this->m_stats      = std::move(rhs.m_stats);
+        this->m_init_shift = rhs.m_init_shift;
+        std::atomic_store(&m_slicing_index, std::atomic_exchange(&rhs.m_slicing_index, std::shared_ptr<const MeshSlicingIndex>()));
+    }
+    return *this;
+}
+
+size_t TriangleMesh::release_optional()
+{
+    std::shared_ptr<const MeshSlicingIndex> index = std::atomic_exchange(&m_slicing_index, std::shared_ptr<const MeshSlicingIndex>());
+    return index ? index->memsize() : 0;
+}
+
+std::shared_ptr<const MeshSlicingIndex> TriangleMesh::slicing_index() const
+{
+    std::shared_ptr<const MeshSlicingIndex> index = std::atomic_load(&m_slicing_index);
+    if (! index) {
+        // Two threads may build the index concurrently, the last one wins. Both indices are equal.
+        index = std::make_shared<const MeshSlicingIndex>(this->its);
+        std::atomic_store(&m_slicing_index, index);
+    }
+    return index;
+}
+
+MeshSlicingIndex::MeshSlicingIndex(const indexed_triangle_set &its) : face_edge_ids(its_face_edge_ids(its)), num_vertices(its.vertices.size())
+{
+    const size_t num_faces = its.indices.size();
+    std::vector<std::pair<float, float>> extents;
+    extents.reserve(num_faces);
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        const float z0 = its.vertices[face(0)].z();
+        const float z1 = its.vertices[face(1)].z();
+        const float z2 = its.vertices[face(2)].z();
+        extents.emplace_back(std::min(z0, std::min(z1, z2)), std::max(z0, std::max(z1, z2)));
+    }
+
+    faces.reserve(num_faces);
+    for (uint32_t face_idx = 0; face_idx < uint32_t(num_faces); ++ face_idx)
+        faces.emplace_back(face_idx);
+    tbb::parallel_sort(faces.begin(), faces.end(), [&extents](const uint32_t l, const uint32_t r) {
+        return extents[l].first < extents[r].first || (extents[l].first == extents[r].first && l < r);
+    });
+
+    min_z.reserve(num_faces);
+    max_z.reserve(num_faces);
+    block_max_z.assign((num_faces + BLOCK_SIZE - 1) / BLOCK_SIZE, -std::numeric_limits<float>::max());
+    for (size_t i = 0; i < num_faces; ++ i) {
+        const std::pair<float, float> &e = extents[faces[i]];
+        min_z.emplace_back(e.first);
+        max_z.emplace_back(e.second);
+        block_max_z[i / BLOCK_SIZE] = std::max(block_max_z[i / BLOCK_SIZE], e.second);
+    }
+}
+
+size_t MeshSlicingIndex::memsize() const
+{
+    return sizeof(*this) + SLIC3R_STDVEC_MEMSIZE(face_edge_ids, Vec3i32) + SLIC3R_STDVEC_MEMSIZE(faces, uint32_t) +
+        SLIC3R_STDVEC_MEMSIZE(min_z, float) + SLIC3R_STDVEC_MEMSIZE(max_z, float) + SLIC3R_STDVEC_MEMSIZE(block_max_z, float);
+}
+
 // Create a mapping from triangle edge into face.
 struct EdgeToFace {
     // Index of the 1st vertex of the triangle edge. vertex_low <= vertex_high.
@@ -4,6 +4,7 @@
 #include "libslic3r.h"
 #include <admesh/stl.h>
 #include <functional>
+#include <memory>
 #include <vector>
 #include "BoundingBox.hpp"
 #include "Line.hpp"
@@ -84,15 +85,65 @@ struct TriangleMeshStats {
     bool repaired() const { return repaired_errors.repaired(); }
 };
 
+// Data of a mesh needed by the slicer, which does not depend on the slicing planes and which is costly to calculate:
+// the edge IDs used for chaining the slice lines and the triangles sorted by their lowest Z.
+// Built on demand by TriangleMesh::slicing_index() and reused by all slice_mesh() / slice_mesh_ex() calls on that mesh.
+struct MeshSlicingIndex
+{
+    explicit MeshSlicingIndex(const indexed_triangle_set &its);
+
+    // Number of consecutive entries of faces summarized by a single entry of block_max_z.
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    // Result of its_face_edge_ids(its).
+    std::vector<Vec3i32>    face_edge_ids;
+    // Triangles sorted by their lowest Z, ties sorted by the triangle index.
+    std::vector<uint32_t>   faces;
+    // Lowest and highest Z of the triangles in the order of faces.
+    std::vector<float>      min_z;
+    std::vector<float>      max_z;
+    // Highest Z of each block of BLOCK_SIZE consecutive entries of faces.
+    std::vector<float>      block_max_z;
+    // Number of vertices of the mesh the index was built from.
+    size_t                  num_vertices;
+
+    // Could the index have been built from its? A cheap sanity check only, the index is kept up to date by TriangleMesh,
+    // which drops it whenever the mesh is modified.
+    bool                    matches(const indexed_triangle_set &its) const
+        { return faces.size() == its.indices.size() && num_vertices == its.vertices.size(); }
+
+    // Number of leading entries of faces with min_z <= z.
+    size_t                  num_faces_below(float z) const
+        { return std::upper_bound(min_z.begin(), min_z.end(), z) - min_z.begin(); }
+    // Call fn(face_idx) for all triangles with [min_z, max_z] overlapping [z_low, z_high], ordered by their lowest Z.
+    template<typename Fn>
+    void                    for_each_face_between(float z_low, float z_high, Fn &&fn) const {
+        const size_t num_faces = this->num_faces_below(z_high);
+        for (size_t block = 0; block * BLOCK_SIZE < num_faces; ++ block)
+            if (block_max_z[block] >= z_low)
+                for (size_t i = block * BLOCK_SIZE; i < std::min(num_faces, (block + 1) * BLOCK_SIZE); ++ i)
+                    if (max_z[i] >= z_low)
+                        fn(faces[i]);
+    }
+
+    size_t                  memsize() const;
+};
+
 class TriangleMesh
 {
 public:
     TriangleMesh() = default;
+    // The copies do not share the slicing index, thus a copy modified through its may not slice with a stale index.
+    TriangleMesh(const TriangleMesh &rhs) : its(rhs.its), m_stats(rhs.m_stats), m_init_shift(rhs.m_init_shift) {}
+    TriangleMesh(TriangleMesh &&rhs) noexcept : its(std::move(rhs.its)), m_stats(std::move(rhs.m_stats)), m_init_shift(rhs.m_init_shift),
+        m_slicing_index(std::atomic_exchange(&rhs.m_slicing_index, std::shared_ptr<const MeshSlicingIndex>())) {}
+    TriangleMesh& operator=(const TriangleMesh &rhs);
+    TriangleMesh& operator=(TriangleMesh &&rhs) noexcept;
     TriangleMesh(const std::vector<Vec3f> &vertices, const std::vector<Vec3i32> &faces);
     TriangleMesh(std::vector<Vec3f> &&vertices, const std::vector<Vec3i32> &&faces);
     explicit TriangleMesh(const indexed_triangle_set &M);
     explicit TriangleMesh(indexed_triangle_set &&M, const RepairedMeshErrors& repaired_errors = RepairedMeshErrors());
-    void clear() { this->its.clear(); this->m_stats.clear(); }
+    void clear() { this->its.clear(); this->m_stats.clear(); this->invalidate_slicing_index(); }
     bool from_stl(stl_file& stl, bool repair = true);
     bool  ReadSTLFile(const char *input_file, bool repair = true, ImportstlProgressFn stlFn = nullptr, int custom_header_length = 80);
     bool write_ascii(const char* output_file);
@@ -143,13 +194,18 @@ public:
     // Estimate of the memory occupied by this structure, important for keeping an eye on the Undo / Redo stack allocation.
     size_t memsize() const;
 
-    // Used by the Undo / Redo stack, legacy interface. As of now there is nothing cached at TriangleMesh,
-    // but we may decide to cache some data in the future (for example normals), thus we keep the interface in place.
+    // Used by the Undo / Redo stack. The only data cached at TriangleMesh is the slicing index, which is rebuilt on demand.
     // Release optional data from the mesh if the object is on the Undo / Redo stack only. Returns the amount of memory released.
-    size_t release_optional() { return 0; }
+    size_t release_optional();
     // Restore optional data possibly released by release_optional().
     void   restore_optional() {}
 
+    // Slicing index of this mesh, built by the first call and kept until the mesh is modified. It is not shared by the copies of this mesh.
+    // Thread safe. The methods of TriangleMesh modifying the mesh drop the index, code modifying this->its directly
+    // shall call invalidate_slicing_index().
+    std::shared_ptr<const MeshSlicingIndex> slicing_index() const;
+    void   invalidate_slicing_index() { std::atomic_store(&m_slicing_index, std::shared_ptr<const MeshSlicingIndex>()); }
+
     const TriangleMeshStats& stats() const { return m_stats; }
 
     void set_init_shift(const Vec3d &offset) { m_init_shift = offset; }
@@ -160,6 +216,8 @@ public:
 private:
     TriangleMeshStats m_stats;
     Vec3d m_init_shift {0.0, 0.0, 0.0};
+    // Accessed with std::atomic_load() / std::atomic_store() only.
+    mutable std::shared_ptr<const MeshSlicingIndex> m_slicing_index;
 };
 
 // Index of face indices incident with a vertex index.
@@ -584,6 +584,78 @@ static inline IntersectionLines slice_make_lines(
     return lines;
 }
 
+// Variant of slice_make_lines() visiting only the triangles of the slicing index, which may intersect the slicing planes,
+// in the order of their lowest Z. mesh_z_low / mesh_z_high bound the slicing planes in the coordinate system of the mesh.
+template<typename TransformVertex, typename ThrowOnCancel>
+static inline std::vector<IntersectionLines> slice_make_lines(
+    const std::vector<stl_vertex>                   &vertices,
+    const TransformVertex                           &transform_vertex_fn,
+    const std::vector<stl_triangle_vertex_indices>  &indices,
+    const MeshSlicingIndex                          &index,
+    const float                                      mesh_z_low,
+    const float                                      mesh_z_high,
+    const std::vector<float>                        &zs,
+    const ThrowOnCancel                              throw_on_cancel_fn)
+{
+    std::vector<IntersectionLines>  lines(zs.size(), IntersectionLines());
+    std::array<std::mutex, 64>      lines_mutex;
+    const size_t                    num_faces  = index.num_faces_below(mesh_z_high);
+    const size_t                    num_blocks = (num_faces + MeshSlicingIndex::BLOCK_SIZE - 1) / MeshSlicingIndex::BLOCK_SIZE;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_blocks),
+        [&vertices, &transform_vertex_fn, &indices, &index, mesh_z_low, num_faces, &zs, &lines, &lines_mutex, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            for (size_t block = range.begin(); block < range.end(); ++ block) {
+                if ((block & 0x03ff) == 0)
+                    throw_on_cancel_fn();
+                if (index.block_max_z[block] < mesh_z_low)
+                    continue;
+                for (size_t i = block * MeshSlicingIndex::BLOCK_SIZE; i < std::min(num_faces, (block + 1) * MeshSlicingIndex::BLOCK_SIZE); ++ i)
+                    if (index.max_z[i] >= mesh_z_low) {
+                        const uint32_t face_idx = index.faces[i];
+                        slice_facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], index.face_edge_ids[face_idx], zs, lines, lines_mutex);
+                    }
+            }
+        }
+    );
+    return lines;
+}
+
+// Single plane variant of slice_make_lines() visiting only the triangles of the slicing index between mesh_z_low and mesh_z_high.
+// The triangles are sliced in the order of their indices to produce the same lines as the single plane slicing without the index.
+template<typename TransformVertex>
+static inline IntersectionLines slice_make_lines(
+    const std::vector<stl_vertex>                   &mesh_vertices,
+    const TransformVertex                           &transform_vertex_fn,
+    const std::vector<stl_triangle_vertex_indices>  &mesh_faces,
+    const MeshSlicingIndex                          &index,
+    const float                                      mesh_z_low,
+    const float                                      mesh_z_high,
+    const float                                      plane_z)
+{
+    std::vector<uint32_t> candidates;
+    index.for_each_face_between(mesh_z_low, mesh_z_high, [&candidates](const uint32_t face_idx) { candidates.emplace_back(face_idx); });
+    std::sort(candidates.begin(), candidates.end());
+
+    IntersectionLines lines;
+    for (const uint32_t face_idx : candidates) {
+        const Vec3i32 &indices = mesh_faces[face_idx];
+        stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
+        const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
+        const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
+        // The candidates are selected conservatively, filter out the triangles not touching the plane.
+        if (min_z > plane_z || max_z < plane_z)
+            continue;
+        int              idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
+        IntersectionLine il;
+        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
+        if (min_z != max_z && slice_facet(plane_z, vertices, indices, index.face_edge_ids[face_idx], idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+            lines.emplace_back(il);
+        }
+    }
+    return lines;
+}
+
 // For projecting triangle sets onto slice slabs.
 struct SlabLines {
     // Intersection lines of a slice with a triangle set, CCW oriented.
@@ -1861,6 +1933,22 @@ static inline bool is_identity(const Transform3d &trafo)
     return trafo.matrix() == Transform3d::Identity().matrix();
 }
 
+// Range of Zs of the mesh coordinate system, which trafo maps to [z_low, z_high], enlarged to cover the rounding
+// of the transformed vertices, so that it could be used to select the triangles from MeshSlicingIndex conservatively.
+// Returns false if trafo tilts or flips the Z axis, thus the Z ordering of MeshSlicingIndex does not apply.
+static inline bool mesh_z_range_for_slicing(const Transform3d &trafo, const float z_low, const float z_high, float &mesh_z_low, float &mesh_z_high)
+{
+    const auto &m = trafo.matrix();
+    if (m(2, 0) != 0. || m(2, 1) != 0. || m(2, 2) <= 0.)
+        return false;
+    const double low  = (double(z_low)  - m(2, 3)) / m(2, 2);
+    const double high = (double(z_high) - m(2, 3)) / m(2, 2);
+    const double eps  = 1e-5 * (std::abs(low) + std::abs(high) + std::abs(m(2, 3)) / m(2, 2) + 1.);
+    mesh_z_low  = float(low - eps);
+    mesh_z_high = float(high + eps);
+    return true;
+}
+
 static std::vector<stl_vertex> transform_mesh_vertices_for_slicing(const indexed_triangle_set &mesh, const Transform3d &trafo)
 {
     // Copy and scale vertices in XY, don't scale in Z.
@@ -1885,6 +1973,201 @@ static std::vector<stl_vertex> transform_mesh_vertices_for_slicing(const indexed
     return out;
 }
 
+// Number of triangles intersected with a slicing plane at once by slice_mesh_cpu_batched().
+static constexpr size_t SLICE_BATCH_SIZE = 8;
+
+static inline GPUIntersectionResult to_gpu_intersection_result(const IntersectionLine &line)
+{
+    GPUIntersectionResult out;
+    out.a         = line.a;
+    out.b         = line.b;
+    out.a_id      = line.a_id;
+    out.b_id      = line.b_id;
+    out.edge_a_id = line.edge_a_id;
+    out.edge_b_id = line.edge_b_id;
+    out.edge_type = int(line.edge_type);
+    return out;
+}
+
+// Intersect up to SLICE_BATCH_SIZE triangles with a single plane. The triangles, which cut the plane at two edges in their interior
+// are intersected by a branch free code over structure of arrays, which the compiler vectorizes. Triangles touching the plane
+// with a vertex or edge are passed to slice_facet(). The result is the same as if slice_facet() was called for all the triangles.
+static void slice_facet_batch(
+    const float                                      slice_z,
+    const std::vector<stl_vertex>                   &vertices,
+    const std::vector<stl_triangle_vertex_indices>  &indices,
+    const std::vector<Vec3i32>                      &face_edge_ids,
+    const uint32_t                                  *faces,
+    const size_t                                     num_faces,
+    GPUIntersectionLines                            &out)
+{
+    assert(num_faces <= SLICE_BATCH_SIZE);
+    // Edge j of a triangle starts at its vertex (idx_vertex_lowest + j) % 3 as in slice_facet(),
+    // the edge end points are sorted by their vertex indices.
+    double ax[3][SLICE_BATCH_SIZE], ay[3][SLICE_BATCH_SIZE], az[3][SLICE_BATCH_SIZE];
+    double bx[3][SLICE_BATCH_SIZE], by[3][SLICE_BATCH_SIZE], bz[3][SLICE_BATCH_SIZE];
+    bool   on_plane[SLICE_BATCH_SIZE];
+    int    idx_vertex_lowest[SLICE_BATCH_SIZE];
+    for (size_t lane = 0; lane < SLICE_BATCH_SIZE; ++ lane) {
+        if (lane < num_faces) {
+            const stl_triangle_vertex_indices &face = indices[faces[lane]];
+            const stl_vertex *v[3] { &vertices[face(0)], &vertices[face(1)], &vertices[face(2)] };
+            const float min_z = fminf(v[0]->z(), fminf(v[1]->z(), v[2]->z()));
+            idx_vertex_lowest[lane] = (v[1]->z() == min_z) ? 1 : ((v[2]->z() == min_z) ? 2 : 0);
+            on_plane[lane] = v[0]->z() == slice_z || v[1]->z() == slice_z || v[2]->z() == slice_z;
+            for (int j = 0; j < 3; ++ j) {
+                int k = (idx_vertex_lowest[lane] + j) % 3;
+                int l = (k + 1) % 3;
+                if (face(k) > face(l))
+                    std::swap(k, l);
+                ax[j][lane] = v[k]->x(); ay[j][lane] = v[k]->y(); az[j][lane] = v[k]->z();
+                bx[j][lane] = v[l]->x(); by[j][lane] = v[l]->y(); bz[j][lane] = v[l]->z();
+            }
+        } else {
+            // Unused lane, the edges do not cross the plane.
+            on_plane[lane] = false;
+            for (int j = 0; j < 3; ++ j)
+                ax[j][lane] = ay[j][lane] = az[j][lane] = bx[j][lane] = by[j][lane] = bz[j][lane] = double(slice_z) + 1.;
+        }
+    }
+
+    // Intersection points of all three edges of all the triangles, valid where crosses is set.
+    double x[3][SLICE_BATCH_SIZE], y[3][SLICE_BATCH_SIZE];
+    bool   crosses[3][SLICE_BATCH_SIZE];
+    bool   snapped[SLICE_BATCH_SIZE];
+    const double z = slice_z;
+    for (size_t lane = 0; lane < SLICE_BATCH_SIZE; ++ lane)
+        snapped[lane] = false;
+    for (int j = 0; j < 3; ++ j)
+        for (size_t lane = 0; lane < SLICE_BATCH_SIZE; ++ lane) {
+            bool   c = (az[j][lane] < z && bz[j][lane] > z) || (bz[j][lane] < z && az[j][lane] > z);
+            double t = (z - bz[j][lane]) / (c ? az[j][lane] - bz[j][lane] : 1.);
+            crosses[j][lane] = c;
+            // slice_facet() snaps the intersection to a vertex at the end of the interval.
+            snapped[lane]    = snapped[lane] || (c && (t <= 0. || t >= 1.));
+            x[j][lane]       = floor(bx[j][lane] + (ax[j][lane] - bx[j][lane]) * t + 0.5);
+            y[j][lane]       = floor(by[j][lane] + (ay[j][lane] - by[j][lane]) * t + 0.5);
+        }
+
+    for (size_t lane = 0; lane < num_faces; ++ lane) {
+        const int                          face_idx = int(faces[lane]);
+        const stl_triangle_vertex_indices &face     = indices[face_idx];
+        const Vec3i32                     &edge_ids = face_edge_ids[face_idx];
+        if (on_plane[lane] || snapped[lane]) {
+            stl_vertex       v[3] { vertices[face(0)], vertices[face(1)], vertices[face(2)] };
+            IntersectionLine il;
+            if (slice_facet(slice_z, v, face, edge_ids, idx_vertex_lowest[lane], false, il) == FacetSliceType::Slicing)
+                out.emplace_back(to_gpu_intersection_result(il));
+            continue;
+        }
+        // General position: exactly two edges cross the plane.
+        int num_points = 0;
+        int points[2];
+        for (int j = 0; j < 3; ++ j)
+            if (crosses[j][lane])
+                points[num_points ++] = j;
+        assert(num_points == 2);
+        if (num_points != 2)
+            continue;
+        GPUIntersectionResult &line = out.emplace_back();
+        line.a         = Point(coord_t(x[points[1]][lane]), coord_t(y[points[1]][lane]));
+        line.b         = Point(coord_t(x[points[0]][lane]), coord_t(y[points[0]][lane]));
+        line.edge_a_id = edge_ids((idx_vertex_lowest[lane] + points[1]) % 3);
+        line.edge_b_id = edge_ids((idx_vertex_lowest[lane] + points[0]) % 3);
+    }
+}
+
+std::vector<GPUIntersectionLines> slice_mesh_cpu_batched(
+    const indexed_triangle_set   &mesh,
+    const std::vector<float>     &zs,
+    const Transform3d            &trafo,
+    const std::vector<Vec3i32>   &face_edge_ids)
+{
+    std::vector<GPUIntersectionLines> lines(zs.size());
+    if (zs.empty() || mesh.indices.empty())
+        return lines;
+    assert(std::is_sorted(zs.begin(), zs.end()));
+
+    // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
+    const std::vector<stl_vertex> vertices  = transform_mesh_vertices_for_slicing(mesh, trafo);
+    const size_t                  num_faces = mesh.indices.size();
+
+    // Z interval index: range of the slices crossing each triangle. Horizontal triangles are ignored as by slice_facet_at_zs().
+    std::vector<std::pair<uint32_t, uint32_t>> face_slices(num_faces);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_faces), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+            const stl_triangle_vertex_indices &face = mesh.indices[face_idx];
+            const float min_z = fminf(vertices[face(0)].z(), fminf(vertices[face(1)].z(), vertices[face(2)].z()));
+            const float max_z = fmaxf(vertices[face(0)].z(), fmaxf(vertices[face(1)].z(), vertices[face(2)].z()));
+            if (min_z == max_z) {
+                face_slices[face_idx] = { 0, 0 };
+            } else {
+                auto first = std::lower_bound(zs.begin(), zs.end(), min_z);
+                auto last  = std::upper_bound(first, zs.end(), max_z);
+                face_slices[face_idx] = { uint32_t(first - zs.begin()), uint32_t(last - zs.begin()) };
+            }
+        }
+    });
+
+    // Bin the triangles into per slice lists of candidates sorted by the triangle index, so that the output is deterministic.
+    // The triangles are split into blocks, each block fills its own part of each slice list in parallel.
+    const size_t num_slices = zs.size();
+    const size_t num_blocks = std::min<size_t>(64, (num_faces + 4095) / 4096);
+    const size_t block_size = (num_faces + num_blocks - 1) / num_blocks;
+    // Number of candidates of each block in each slice, later converted to the write cursors.
+    std::vector<uint32_t> block_offsets(num_blocks * (num_slices + 1), 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks, 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t block = range.begin(); block < range.end(); ++ block) {
+            uint32_t *counts = block_offsets.data() + block * (num_slices + 1);
+            // Difference array, converted to the counts below.
+            for (size_t face_idx = block * block_size; face_idx < std::min(num_faces, (block + 1) * block_size); ++ face_idx) {
+                ++ counts[face_slices[face_idx].first];
+                -- counts[face_slices[face_idx].second];
+            }
+            for (size_t slice_idx = 1; slice_idx < num_slices; ++ slice_idx)
+                counts[slice_idx] += counts[slice_idx - 1];
+        }
+    });
+    std::vector<uint32_t> slice_offsets(num_slices + 1, 0);
+    {
+        uint32_t offset = 0;
+        for (size_t slice_idx = 0; slice_idx < num_slices; ++ slice_idx) {
+            slice_offsets[slice_idx] = offset;
+            for (size_t block = 0; block < num_blocks; ++ block) {
+                uint32_t &cursor = block_offsets[block * (num_slices + 1) + slice_idx];
+                uint32_t  count  = cursor;
+                cursor  = offset;
+                offset += count;
+            }
+        }
+        slice_offsets[num_slices] = offset;
+    }
+    std::vector<uint32_t> candidates(slice_offsets.back());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks, 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t block = range.begin(); block < range.end(); ++ block) {
+            uint32_t *cursors = block_offsets.data() + block * (num_slices + 1);
+            for (size_t face_idx = block * block_size; face_idx < std::min(num_faces, (block + 1) * block_size); ++ face_idx)
+                for (uint32_t slice_idx = face_slices[face_idx].first; slice_idx < face_slices[face_idx].second; ++ slice_idx)
+                    candidates[cursors[slice_idx] ++] = uint32_t(face_idx);
+        }
+    });
+    face_slices = {};
+    block_offsets = {};
+
+    // Intersect the slices in parallel, each slice owns its output, thus no locking is needed.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_slices), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t slice_idx = range.begin(); slice_idx < range.end(); ++ slice_idx) {
+            const uint32_t *begin = candidates.data() + slice_offsets[slice_idx];
+            const uint32_t *end   = candidates.data() + slice_offsets[slice_idx + 1];
+            GPUIntersectionLines &out = lines[slice_idx];
+            out.reserve(end - begin);
+            for (const uint32_t *it = begin; it < end; it += SLICE_BATCH_SIZE)
+                slice_facet_batch(zs[slice_idx], vertices, mesh.indices, face_edge_ids, it, std::min<size_t>(SLICE_BATCH_SIZE, end - it), out);
+        }
+    });
+    return lines;
+}
+
 std::vector<Polygons> slice_mesh(
     const indexed_triangle_set       &mesh,
     // Unscaled Zs
@@ -1901,7 +2184,20 @@ std::vector<Polygons> slice_mesh(
         // Instead of edge identifiers, one shall use a sorted pair of edge vertex indices.
         // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
         // to make sure that no code relies on it.
-        std::vector<Vec3i32> face_edge_ids = its_face_edge_ids(mesh);
+        // The edge IDs are reused from the slicing index of the mesh if available.
+        const MeshSlicingIndex *index = params.index && params.index->matches(mesh) ? params.index.get() : nullptr;
+        std::vector<Vec3i32>    face_edge_ids_local;
+        if (index == nullptr)
+            face_edge_ids_local = its_face_edge_ids(mesh);
+        const std::vector<Vec3i32> &face_edge_ids = index ? index->face_edge_ids : face_edge_ids_local;
+        // Visit just the triangles spanning the slicing planes ordered by Z if the index may be used with the transformation.
+        float mesh_z_low, mesh_z_high;
+        const bool use_z_index = index && ! zs.empty() && mesh_z_range_for_slicing(params.trafo, zs.front(), zs.back(), mesh_z_low, mesh_z_high);
+        auto make_lines = [&](const std::vector<stl_vertex> &vertices, const auto &transform_vertex_fn) {
+            return use_z_index ?
+                slice_make_lines(vertices, transform_vertex_fn, mesh.indices, *index, mesh_z_low, mesh_z_high, zs, throw_on_cancel) :
+                slice_make_lines(vertices, transform_vertex_fn, mesh.indices, face_edge_ids, zs, throw_on_cancel);
+        };
 
         // Try GPU slicing if enabled and callback is set
         bool gpu_slicing_done = false;
@@ -1926,6 +2222,7 @@ std::vector<Polygons> slice_mesh(
                         il.b_id = gpu_line.b_id;
                         il.edge_a_id = gpu_line.edge_a_id;
                         il.edge_b_id = gpu_line.edge_b_id;
+                        il.edge_type = IntersectionLine::FacetEdgeType(gpu_line.edge_type);
                         slice_lines.emplace_back(std::move(il));
                     }
                 }
@@ -1941,19 +2238,15 @@ std::vector<Polygons> slice_mesh(
             if (zs.size() <= 1) {
                 // It likely is not worthwile to copy the vertices. Apply the transformation in place.
                 if (is_identity(params.trafo)) {
-                    lines = slice_make_lines(
-                        mesh.vertices, [](const Vec3f &p) { return Vec3f(scaled<float>(p.x()), scaled<float>(p.y()), p.z()); },
-                        mesh.indices, face_edge_ids, zs, throw_on_cancel);
+                    lines = make_lines(mesh.vertices, [](const Vec3f &p) { return Vec3f(scaled<float>(p.x()), scaled<float>(p.y()), p.z()); });
                 } else {
                     // Transform the vertices, scale up in XY, not in Z.
                     Transform3f tf = make_trafo_for_slicing(params.trafo);
-                    lines = slice_make_lines(mesh.vertices, [tf](const Vec3f &p) { return tf * p; }, mesh.indices, face_edge_ids, zs, throw_on_cancel);
+                    lines = make_lines(mesh.vertices, [tf](const Vec3f &p) { return tf * p; });
                 }
             } else {
                 // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
-                lines = slice_make_lines(
-                    transform_mesh_vertices_for_slicing(mesh, params.trafo),
-                    [](const Vec3f &p) { return p; },  mesh.indices, face_edge_ids, zs, throw_on_cancel);
+                lines = make_lines(transform_mesh_vertices_for_slicing(mesh, params.trafo), [](const Vec3f &p) { return p; });
             }
         }
     }
@@ -2007,7 +2300,19 @@ Polygons slice_mesh(
 {
     std::vector<IntersectionLines> lines;
 
-    {
+    const MeshSlicingIndex *index = params.index && params.index->matches(mesh) ? params.index.get() : nullptr;
+    float                   mesh_z_low, mesh_z_high;
+    if (index && mesh_z_range_for_slicing(params.trafo, plane_z, plane_z, mesh_z_low, mesh_z_high)) {
+        // Pick the triangles touching the slicing plane from the slicing index instead of scanning the whole mesh.
+        if (is_identity(params.trafo)) {
+            lines.emplace_back(slice_make_lines(
+                mesh.vertices, [](const Vec3f &p) { return Vec3f(scaled<float>(p.x()), scaled<float>(p.y()), p.z()); },
+                mesh.indices, *index, mesh_z_low, mesh_z_high, plane_z));
+        } else {
+            Transform3f tf = make_trafo_for_slicing(params.trafo);
+            lines.emplace_back(slice_make_lines(mesh.vertices, [tf](const Vec3f &p) { return tf * p; }, mesh.indices, *index, mesh_z_low, mesh_z_high, plane_z));
+        }
+    } else {
         bool                trafo_identity = is_identity(params.trafo);
         Transform3f         tf;
         std::vector<bool>   face_mask(mesh.indices.size(), false);
@@ -2039,8 +2344,11 @@ Polygons slice_mesh(
             }
         }
 
-        // 3) Calculate face neighbors for just the faces in face_mask.
-        std::vector<Vec3i32> face_edge_ids = its_face_edge_ids(mesh, face_mask);
+        // 3) Calculate face neighbors for just the faces in face_mask, unless they are cached by the slicing index.
+        std::vector<Vec3i32> face_edge_ids_local;
+        if (index == nullptr)
+            face_edge_ids_local = its_face_edge_ids(mesh, face_mask);
+        const std::vector<Vec3i32> &face_edge_ids = index ? index->face_edge_ids : face_edge_ids_local;
 
         // 4) Slice "face_mask" triangles, collect line segments.
         // It likely is not worthwile to copy the vertices. Apply the transformation in place.
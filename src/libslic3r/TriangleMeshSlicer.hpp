@@ -2,6 +2,7 @@
 #define slic3r_TriangleMeshSlicer_hpp_
 
 #include <functional>
+#include <memory>
 #include <vector>
 #include "Polygon.hpp"
 #include "ExPolygon.hpp"
@@ -17,6 +18,7 @@ struct GPUIntersectionResult {
     int b_id { -1 };       // Vertex ID if endpoint is at a mesh vertex, -1 otherwise
     int edge_a_id { -1 };  // Edge ID if endpoint is on edge interior, -1 otherwise
     int edge_b_id { -1 };  // Edge ID if endpoint is on edge interior, -1 otherwise
+    int edge_type { 0 };   // IntersectionLine::FacetEdgeType: 0 general, 1 top edge, 2 bottom edge of a face touching the plane
 };
 using GPUIntersectionLines = std::vector<GPUIntersectionResult>;
 
@@ -40,6 +42,17 @@ bool is_gpu_slicing_enabled();
 // Force enable/disable GPU slicing
 void set_gpu_slicing_enabled(bool enabled);
 
+// CPU implementation of GPUSlicingCallback, which does not need any GPU or GUI context.
+// The triangles are binned by their Z span into per slice candidate lists, then each slice is intersected
+// with batches of 8 triangles laid out as structure of arrays for the compiler to vectorize.
+// Produces the same lines as the default CPU slicing up to rounding of the intersection points,
+// register it with set_gpu_slicing_callback().
+std::vector<GPUIntersectionLines> slice_mesh_cpu_batched(
+    const indexed_triangle_set& mesh,
+    const std::vector<float>& zs,
+    const Transform3d& trafo,
+    const std::vector<Vec3i32>& face_edge_ids);
+
 struct MeshSlicingParams
 {
     enum class SlicingMode : uint32_t {
@@ -65,6 +78,10 @@ struct MeshSlicingParams
     SlicingMode   mode_below { SlicingMode::Regular };
     // Transforming faces during the slicing.
     Transform3d   trafo { Transform3d::Identity() };
+    // Optional slicing index of the mesh being sliced, see TriangleMesh::slicing_index().
+    // Its Z ordering is only used if trafo maps the Z axis of the mesh to the Z axis without tilting it.
+    // Ignored if it obviously was not built from the mesh being sliced, see MeshSlicingIndex::matches().
+    std::shared_ptr<const MeshSlicingIndex> index;
 };
 
 struct MeshSlicingParamsEx : public MeshSlicingParams
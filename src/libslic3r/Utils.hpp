@@ -85,6 +85,12 @@ extern std::string format_memsize_MB(size_t n);
 // The string is non-empty if the loglevel >= info (3) or ignore_loglevel==true.
 // Latter is used to get the memory info from SysInfoDialog.
 extern std::string log_memory_info(bool ignore_loglevel = false);
+// Returns the peak resident memory (peak working set on Windows) of the process in bytes, zero if not available.
+extern size_t peak_memory_usage();
+// Returns the current resident memory (working set on Windows) of the process in bytes, zero if not available.
+extern size_t current_memory_usage();
+// Returns the CPU time (user + kernel) consumed by all threads of the process in milliseconds, zero if not available.
+extern double process_cpu_time_ms();
 extern void disable_multi_threading();
 // Returns the size of physical memory (RAM) in bytes.
 extern size_t total_physical_memory();
@@ -1392,15 +1392,8 @@ std::string log_memory_info(bool ignore_loglevel)
     #endif
         // Now get peak memory usage.
         out += "; Peak memory usage: ";
-        rusage memory_info;
-        if (getrusage(RUSAGE_SELF, &memory_info) == 0)
-        {
-            size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
-            #ifdef __linux__
-                peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
-            #endif
+        if (size_t peak_mem_usage = peak_memory_usage(); peak_mem_usage > 0)
             out += format_memsize_MB(peak_mem_usage);
-        }
         else
             out += "N/A";
 #endif
@@ -1408,6 +1401,65 @@ std::string log_memory_info(bool ignore_loglevel)
     return out;
 }
 
+// Returns the peak resident memory of the process in bytes, zero if not available.
+size_t peak_memory_usage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return (size_t)pmc.PeakWorkingSetSize;
+#elif defined(__linux__) or defined(__APPLE__)
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) == 0) {
+        size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
+        #ifdef __linux__
+            peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
+        #endif
+        return peak_mem_usage;
+    }
+#endif
+    return 0;
+}
+
+// Returns the current resident memory of the process in bytes, zero if not available.
+size_t current_memory_usage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return (size_t)pmc.WorkingSetSize;
+#elif defined(__APPLE__)
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t infoCount = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &infoCount) == KERN_SUCCESS)
+        return (size_t)info.resident_size;
+#elif defined(__linux__)
+    size_t tSize = 0, resident = 0;
+    std::ifstream buffer("/proc/self/statm");
+    if (buffer && (buffer >> tSize >> resident))
+        return resident * (size_t)sysconf(_SC_PAGE_SIZE);
+#endif
+    return 0;
+}
+
+// Returns the CPU time (user + kernel) consumed by all threads of the process in milliseconds, zero if not available.
+double process_cpu_time_ms()
+{
+#ifdef WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        auto to_100ns = [](const FILETIME &t) { return (uint64_t(t.dwHighDateTime) << 32) | uint64_t(t.dwLowDateTime); };
+        return double(to_100ns(kernel_time) + to_100ns(user_time)) * 1e-4;
+    }
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (double(usage.ru_utime.tv_sec) + double(usage.ru_stime.tv_sec)) * 1e3 +
+               (double(usage.ru_utime.tv_usec) + double(usage.ru_stime.tv_usec)) * 1e-3;
+#endif
+    return 0.;
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
@@ -18,6 +18,7 @@
 // Print now includes tbb, and tbb includes Windows. This breaks compilation of wxWidgets if included before wx.
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/SliceCache.hpp"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/GCode/PostProcessor.hpp"
 #include "libslic3r/Format/SL1.hpp"
@@ -196,6 +197,13 @@ void BackgroundSlicingProcess::process_fff()
 {
     assert(m_print == m_fff_print);
     m_fff_print->is_BBL_printer() = wxGetApp().preset_bundle->is_bbl_vendor();
+    if (std::string slice_cache_dir = wxGetApp().app_config->get("slice_cache_dir"); slice_cache_dir.empty())
+        m_slice_cache.reset();
+    else if (! m_slice_cache || m_slice_cache->directory() != slice_cache_dir) {
+        std::string slice_cache_size = wxGetApp().app_config->get("slice_cache_size");
+        m_slice_cache = std::make_shared<SliceCache>(slice_cache_dir, size_t(std::max(slice_cache_size.empty() ? 2048 : std::atoi(slice_cache_size.c_str()), 1)) * 1024 * 1024);
+    }
+    m_fff_print->set_slice_cache(m_slice_cache);
 	//BBS: add the logic to process from an existed gcode file
 	if (m_print->finished()) {
 		BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(" %1%: skip slicing, to process previous gcode file")%__LINE__;
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 
 #include <boost/thread.hpp>
@@ -23,6 +24,7 @@ namespace Slic3r {
 class DynamicPrintConfig;
 class Model;
 class SLAPrint;
+class SliceCache;
 
 class SlicingStatusEvent : public wxEvent
 {
@@ -234,6 +236,8 @@ private:
 	// Non-owned pointers to Print instances.
 	Print 					   *m_fff_print 		 = nullptr;
 	SLAPrint 				   *m_sla_print			 = nullptr;
+	// Persistent cache of the PrintObject slicing results, enabled by the "slice_cache_dir" and "slice_cache_size" (MB) app config keys.
+	std::shared_ptr<SliceCache> m_slice_cache;
 	// Data structure, to which the G-code export writes its annotations.
 	GCodeProcessorResult     *m_gcode_result 		 = nullptr;
 	// Callback function, used to write thumbnails into gcode.
@@ -171,13 +171,14 @@ void GCodeViewer::IBuffer::reset()
     count = 0;
 }
 
-bool GCodeViewer::Path::matches(const GCodeProcessorResult::MoveVertex& move) const
+bool GCodeViewer::Path::matches(const GCodeMovesColumns& moves, size_t move_idx) const
 {
     auto matches_percent = [](float value1, float value2, float max_percent) {
         return std::abs(value2 - value1) / value1 <= max_percent;
     };
 
-    switch (move.type)
+    const EMoveType move_type = moves.type(move_idx);
+    switch (move_type)
     {
     case EMoveType::Tool_change:
     case EMoveType::Color_change:
@@ -188,13 +189,13 @@ bool GCodeViewer::Path::matches(const GCodeProcessorResult::MoveVertex& move) co
     case EMoveType::Seam:
     case EMoveType::Extrude: {
         // use rounding to reduce the number of generated paths
-        return type == move.type && extruder_id == move.extruder_id && cp_color_id == move.cp_color_id && role == move.extrusion_role &&
-            move.position.z() <= sub_paths.front().first.position.z() && feedrate == move.feedrate && fan_speed == move.fan_speed &&
-            height == round_to_bin(move.height) && width == round_to_bin(move.width) &&
-            matches_percent(volumetric_rate, move.volumetric_rate(), 0.05f) && layer_time == move.layer_duration;
+        return type == move_type && extruder_id == moves.extruder_id(move_idx) && cp_color_id == moves.cp_color_id(move_idx) && role == moves.extrusion_role(move_idx) &&
+            moves.position(move_idx).z() <= sub_paths.front().first.position.z() && feedrate == moves.feedrate(move_idx) && fan_speed == moves.fan_speed(move_idx) &&
+            height == round_to_bin(moves.height(move_idx)) && width == round_to_bin(moves.width(move_idx)) &&
+            matches_percent(volumetric_rate, moves.volumetric_rate(move_idx), 0.05f) && layer_time == moves.layer_duration(move_idx);
     }
     case EMoveType::Travel: {
-        return type == move.type && feedrate == move.feedrate && extruder_id == move.extruder_id && cp_color_id == move.cp_color_id;
+        return type == move_type && feedrate == moves.feedrate(move_idx) && extruder_id == moves.extruder_id(move_idx) && cp_color_id == moves.cp_color_id(move_idx);
     }
     default: { return false; }
     }
@@ -218,14 +219,14 @@ void GCodeViewer::TBuffer::reset()
     model.reset();
 }
 
-void GCodeViewer::TBuffer::add_path(const GCodeProcessorResult::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id)
+void GCodeViewer::TBuffer::add_path(const GCodeMovesColumns& moves, size_t move_idx, unsigned int b_id, size_t i_id, size_t s_id)
 {
-    Path::Endpoint endpoint = { b_id, i_id, s_id, move.position };
+    Path::Endpoint endpoint = { b_id, i_id, s_id, moves.position(move_idx) };
     // use rounding to reduce the number of generated paths
-    paths.push_back({ move.type, move.extrusion_role, move.delta_extruder,
-        round_to_bin(move.height), round_to_bin(move.width),
-        move.feedrate, move.fan_speed, move.temperature,
-        move.volumetric_rate(), move.layer_duration, move.extruder_id, move.cp_color_id, { { endpoint, endpoint } } });
+    paths.push_back({ moves.type(move_idx), moves.extrusion_role(move_idx), moves.delta_extruder(move_idx),
+        round_to_bin(moves.height(move_idx)), round_to_bin(moves.width(move_idx)),
+        moves.feedrate(move_idx), moves.fan_speed(move_idx), moves.temperature(move_idx),
+        moves.volumetric_rate(move_idx), moves.layer_duration(move_idx), moves.extruder_id(move_idx), moves.cp_color_id(move_idx), { { endpoint, endpoint } } });
 }
 
 ColorRGBA GCodeViewer::Extrusions::Range::get_color_at(float value) const
@@ -1129,38 +1130,39 @@ void GCodeViewer::refresh(const GCodeProcessorResult& gcode_result, const std::v
 
     // update ranges for coloring / legend
     m_extrusions.reset_ranges();
+    const GCodeMovesColumns& moves = gcode_result.moves;
     for (size_t i = 0; i < m_moves_count; ++i) {
         // skip first vertex
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
-
-        switch (curr.type)
+        const EMoveType type = moves.type(i);
+        switch (type)
         {
         case EMoveType::Extrude:
         {
-            m_extrusions.ranges.height.update_from(round_to_bin(curr.height));
-            m_extrusions.ranges.width.update_from(round_to_bin(curr.width));
-            m_extrusions.ranges.fan_speed.update_from(curr.fan_speed);
-            m_extrusions.ranges.temperature.update_from(curr.temperature);
-            if (curr.delta_extruder > 0.005 && curr.travel_dist > 0.01) {
+            m_extrusions.ranges.height.update_from(round_to_bin(moves.height(i)));
+            m_extrusions.ranges.width.update_from(round_to_bin(moves.width(i)));
+            m_extrusions.ranges.fan_speed.update_from(moves.fan_speed(i));
+            m_extrusions.ranges.temperature.update_from(moves.temperature(i));
+            if (moves.delta_extruder(i) > 0.005 && moves.travel_dist(i) > 0.01) {
                 // Ignore very tiny extrusions from flow rate calculation, because
                 // it could give very imprecise result due to rounding in gcode generation
-                if (curr.extrusion_role != erCustom || is_visible(erCustom))
-                    m_extrusions.ranges.volumetric_rate.update_from(round_to_bin(curr.volumetric_rate()));
+                if (moves.extrusion_role(i) != erCustom || is_visible(erCustom))
+                    m_extrusions.ranges.volumetric_rate.update_from(round_to_bin(moves.volumetric_rate(i)));
             }
 
-            if (curr.layer_duration > 0.f) {
-                m_extrusions.ranges.layer_duration.update_from(curr.layer_duration);
-m_extrusions.ranges.layer_duration_log.update_from(curr.layer_duration);
+            const float layer_duration = moves.layer_duration(i);
+            if (layer_duration > 0.f) {
+                m_extrusions.ranges.layer_duration.update_from(layer_duration);
+m_extrusions.ranges.layer_duration_log.update_from(layer_duration);
             }
             [[fallthrough]];
         }
         case EMoveType::Travel:
         {
-            if (m_buffers[buffer_id(curr.type)].visible)
-                m_extrusions.ranges.feedrate.update_from(curr.feedrate);
+            if (m_buffers[buffer_id(type)].visible)
+                m_extrusions.ranges.feedrate.update_from(moves.feedrate(i));
 
             break;
         }
@@ -1786,14 +1788,15 @@ void GCodeViewer::update_layers_slider_mode()
 
 void GCodeViewer::update_marker_curr_move() {
     if ((int)m_last_result_id != -1) {
-        auto it = std::find_if(m_gcode_result->moves.begin(), m_gcode_result->moves.end(), [this](auto move) {
-                if (m_sequential_view.current.last < m_sequential_view.gcode_ids.size() && m_sequential_view.current.last >= 0) {
-                    return move.gcode_id == static_cast<uint64_t>(m_sequential_view.gcode_ids[m_sequential_view.current.last]);
+        const GCodeMovesColumns& moves = m_gcode_result->moves;
+        if (m_sequential_view.current.last < m_sequential_view.gcode_ids.size() && m_sequential_view.current.last >= 0) {
+            const uint64_t gcode_id = static_cast<uint64_t>(m_sequential_view.gcode_ids[m_sequential_view.current.last]);
+            for (size_t i = 0; i < moves.size(); ++i)
+                if (moves.gcode_id(i) == gcode_id) {
+                    m_sequential_view.marker.update_curr_move(moves.vertex(i));
+                    break;
                 }
-                return false;
-            });
-        if (it != m_gcode_result->moves.end())
-            m_sequential_view.marker.update_curr_move(*it);
+        }
     }
 }
 
@@ -2036,7 +2039,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     };
 
     // format data into the buffers to be rendered as lines
-    auto add_vertices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, VertexBuffer& vertices) {
+    auto add_vertices_as_line = [](const GCodeMovesColumns& moves, size_t prev_idx, size_t curr_idx, VertexBuffer& vertices) {
         auto add_vertex = [&vertices](const Vec3f& position) {
             // add position
             vertices.push_back(position.x());
@@ -2045,10 +2048,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         };
         // x component of the normal to the current segment (the normal is parallel to the XY plane)
         //BBS: Has modified a lot for this function to support arc move
-        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+        const Vec3f* interpolation_points = moves.interpolation_points(curr_idx).first;
+        size_t loop_num = moves.interpolation_points_count(curr_idx);
         for (size_t i = 0; i < loop_num + 1; i++) {
-            const Vec3f &previous = (i == 0? prev.position : curr.interpolation_points[i-1]);
-            const Vec3f &current = (i == loop_num? curr.position : curr.interpolation_points[i]);
+            const Vec3f &previous = (i == 0? moves.position(prev_idx) : interpolation_points[i-1]);
+            const Vec3f &current = (i == loop_num? moves.position(curr_idx) : interpolation_points[i]);
             // add previous vertex
             add_vertex(previous);
             // add current vertex
@@ -2056,16 +2060,16 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
     };
     //BBS: modify a lot to support arc travel
-    auto add_indices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer,
+    auto add_indices_as_line = [](const GCodeMovesColumns& moves, size_t prev_idx, size_t curr_idx, TBuffer& buffer,
         size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
 
-            if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
-                buffer.add_path(curr, ibuffer_id, indices.size(), move_id - 1);
-                buffer.paths.back().sub_paths.front().first.position = prev.position;
+            if (buffer.paths.empty() || moves.type(prev_idx) != moves.type(curr_idx) || !buffer.paths.back().matches(moves, curr_idx)) {
+                buffer.add_path(moves, curr_idx, ibuffer_id, indices.size(), move_id - 1);
+                buffer.paths.back().sub_paths.front().first.position = moves.position(prev_idx);
             }
 
             Path& last_path = buffer.paths.back();
-            size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+            size_t loop_num = moves.interpolation_points_count(curr_idx);
             for (size_t i = 0; i < loop_num + 1; i++) {
                 //BBS: add previous index
                 indices.push_back(static_cast<IBufferType>(indices.size()));
@@ -2073,11 +2077,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 indices.push_back(static_cast<IBufferType>(indices.size()));
                 vbuffer_size += buffer.max_vertices_per_segment();
             }
-            last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, curr.position };
+            last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, moves.position(curr_idx) };
     };
 
     // format data into the buffers to be rendered as solid.
-    auto add_vertices_as_solid = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, TBuffer& buffer, unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id) {
+    auto add_vertices_as_solid = [](const GCodeMovesColumns& moves, size_t prev_idx, size_t curr_idx, TBuffer& buffer, unsigned int vbuffer_id, VertexBuffer& vertices, size_t move_id) {
         auto store_vertex = [](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
             // append position
             vertices.push_back(position.x());
@@ -2089,17 +2093,18 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             vertices.push_back(normal.z());
         };
 
-        if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
-            buffer.add_path(curr, vbuffer_id, vertices.size(), move_id - 1);
-            buffer.paths.back().sub_paths.back().first.position = prev.position;
+        if (buffer.paths.empty() || moves.type(prev_idx) != moves.type(curr_idx) || !buffer.paths.back().matches(moves, curr_idx)) {
+            buffer.add_path(moves, curr_idx, vbuffer_id, vertices.size(), move_id - 1);
+            buffer.paths.back().sub_paths.back().first.position = moves.position(prev_idx);
         }
 
         Path& last_path = buffer.paths.back();
         //BBS: Has modified a lot for this function to support arc move
-        size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+        const Vec3f* interpolation_points = moves.interpolation_points(curr_idx).first;
+        size_t loop_num = moves.interpolation_points_count(curr_idx);
         for (size_t i = 0; i < loop_num + 1; i++) {
-            const Vec3f &prev_position = (i == 0? prev.position : curr.interpolation_points[i-1]);
-            const Vec3f &curr_position = (i == loop_num? curr.position : curr.interpolation_points[i]);
+            const Vec3f &prev_position = (i == 0? moves.position(prev_idx) : interpolation_points[i-1]);
+            const Vec3f &curr_position = (i == loop_num? moves.position(curr_idx) : interpolation_points[i]);
 
             const Vec3f dir = (curr_position - prev_position).normalized();
             const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
@@ -2131,9 +2136,10 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             store_vertex(vertices, curr_pos + d_left, left);
         }
 
-        last_path.sub_paths.back().last = { vbuffer_id, vertices.size(), move_id, curr.position };
+        last_path.sub_paths.back().last = { vbuffer_id, vertices.size(), move_id, moves.position(curr_idx) };
     };
-    auto add_indices_as_solid = [&](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, const GCodeProcessorResult::MoveVertex* next,
+    // next_idx is the index of the move following curr_idx or size_t(-1) for the last move.
+    auto add_indices_as_solid = [&](const GCodeMovesColumns& moves, size_t prev_idx, size_t curr_idx, size_t next_idx,
         TBuffer& buffer, size_t& vbuffer_size, unsigned int ibuffer_id, IndexBuffer& indices, size_t move_id) {
             static Vec3f prev_dir;
             static Vec3f prev_up;
@@ -2179,9 +2185,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 store_triangle(indices, v_offsets[4], v_offsets[5], v_offsets[6]);
             };
 
-            if (buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr)) {
-                buffer.add_path(curr, ibuffer_id, indices.size(), move_id - 1);
-                buffer.paths.back().sub_paths.back().first.position = prev.position;
+            if (buffer.paths.empty() || moves.type(prev_idx) != moves.type(curr_idx) || !buffer.paths.back().matches(moves, curr_idx)) {
+                buffer.add_path(moves, curr_idx, ibuffer_id, indices.size(), move_id - 1);
+                buffer.paths.back().sub_paths.back().first.position = moves.position(prev_idx);
             }
 
             Path& last_path = buffer.paths.back();
@@ -2190,10 +2196,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             std::array<IBufferType, 8> first_seg_v_offsets = convert_vertices_offset(vbuffer_size, { 0, 1, 2, 3, 4, 5, 6, 7 });
             std::array<IBufferType, 8> non_first_seg_v_offsets = convert_vertices_offset(vbuffer_size, { -4, 0, -2, 1, 2, 3, 4, 5 });
 
-            size_t loop_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() : 0;
+            const Vec3f* interpolation_points = moves.interpolation_points(curr_idx).first;
+            size_t loop_num = moves.interpolation_points_count(curr_idx);
             for (size_t i = 0; i < loop_num + 1; i++) {
-                const Vec3f &prev_position = (i == 0? prev.position : curr.interpolation_points[i-1]);
-                const Vec3f &curr_position = (i == loop_num? curr.position : curr.interpolation_points[i]);
+                const Vec3f &prev_position = (i == 0? moves.position(prev_idx) : interpolation_points[i-1]);
+                const Vec3f &curr_position = (i == loop_num? moves.position(curr_idx) : interpolation_points[i]);
 
                 const Vec3f dir = (curr_position - prev_position).normalized();
                 const Vec3f right = Vec3f(dir.y(), -dir.x(), 0.0f).normalized();
@@ -2266,34 +2273,36 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 sq_prev_length = sq_length;
             }
 
-            if (next != nullptr && (curr.type != next->type || !last_path.matches(*next)))
+            if (next_idx != size_t(-1) && (moves.type(curr_idx) != moves.type(next_idx) || !last_path.matches(moves, next_idx)))
                 // ending cap triangles
-                append_ending_cap_triangles(indices, (is_first_segment && !curr.is_arc_move_with_interpolation_points()) ? first_seg_v_offsets : non_first_seg_v_offsets);
+                append_ending_cap_triangles(indices, (is_first_segment && loop_num == 0) ? first_seg_v_offsets : non_first_seg_v_offsets);
 
-            last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, curr.position };
+            last_path.sub_paths.back().last = { ibuffer_id, indices.size() - 1, move_id, moves.position(curr_idx) };
     };
 
     // format data into the buffers to be rendered as instanced model
-    auto add_model_instance = [](const GCodeProcessorResult::MoveVertex& curr, InstanceBuffer& instances, InstanceIdBuffer& instances_ids, size_t move_id) {
+    auto add_model_instance = [](const GCodeMovesColumns& moves, size_t curr_idx, InstanceBuffer& instances, InstanceIdBuffer& instances_ids, size_t move_id) {
         // append position
-        instances.push_back(curr.position.x());
-        instances.push_back(curr.position.y());
-        instances.push_back(curr.position.z());
+        const Vec3f& position = moves.position(curr_idx);
+        instances.push_back(position.x());
+        instances.push_back(position.y());
+        instances.push_back(position.z());
         // append width
-        instances.push_back(curr.width);
+        instances.push_back(moves.width(curr_idx));
         // append height
-        instances.push_back(curr.height);
+        instances.push_back(moves.height(curr_idx));
 
         // append id
         instances_ids.push_back(move_id);
     };
 
     // format data into the buffers to be rendered as batched model
-    auto add_vertices_as_model_batch = [](const GCodeProcessorResult::MoveVertex& curr, const GLModel::Geometry& data, VertexBuffer& vertices, InstanceBuffer& instances, InstanceIdBuffer& instances_ids, size_t move_id) {
-        const double width = static_cast<double>(1.5f * curr.width);
-        const double height = static_cast<double>(1.5f * curr.height);
+    auto add_vertices_as_model_batch = [](const GCodeMovesColumns& moves, size_t curr_idx, const GLModel::Geometry& data, VertexBuffer& vertices, InstanceBuffer& instances, InstanceIdBuffer& instances_ids, size_t move_id) {
+        const Vec3f& curr_position = moves.position(curr_idx);
+        const double width = static_cast<double>(1.5f * moves.width(curr_idx));
+        const double height = static_cast<double>(1.5f * moves.height(curr_idx));
 
-        const Transform3d trafo = Geometry::assemble_transform((curr.position - 0.5f * curr.height * Vec3f::UnitZ()).cast<double>(), Vec3d::Zero(), { width, width, height });
+        const Transform3d trafo = Geometry::assemble_transform((curr_position - 0.5f * moves.height(curr_idx) * Vec3f::UnitZ()).cast<double>(), Vec3d::Zero(), { width, width, height });
         const Eigen::Matrix<double, 3, 3, Eigen::DontAlign> normal_matrix = trafo.matrix().template block<3, 3>(0, 0).inverse().transpose();
 
         // append vertices
@@ -2313,9 +2322,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
 
         // append instance position
-        instances.push_back(curr.position.x());
-        instances.push_back(curr.position.y());
-        instances.push_back(curr.position.z());
+        instances.push_back(curr_position.x());
+        instances.push_back(curr_position.y());
+        instances.push_back(curr_position.z());
         // append instance id
         instances_ids.push_back(move_id);
     };
@@ -2329,7 +2338,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessorResult::MoveVertex);
+    m_statistics.results_size = gcode_result.moves.memory_size();
     m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
@@ -2353,37 +2362,40 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     // extract approximate paths bounding box from result
     //BBS: add only gcode mode
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    const GCodeMovesColumns& moves = gcode_result.moves;
+    for (size_t move_id = 0; move_id < moves.size(); ++move_id) {
         //if (wxGetApp().is_gcode_viewer()) {
         //if (m_only_gcode_in_preview) {
             // for the gcode viewer we need to take in account all moves to correctly size the printbed
-        //    m_paths_bounding_box.merge(move.position.cast<double>());
+        //    m_paths_bounding_box.merge(moves.position(move_id).cast<double>());
         //}
         //else {
-            if (move.type == EMoveType::Extrude && move.extrusion_role != erCustom && move.width != 0.0f && move.height != 0.0f) {
-                m_paths_bounding_box.merge(move.position.cast<double>());
+            if (moves.type(move_id) == EMoveType::Extrude && moves.extrusion_role(move_id) != erCustom && moves.width(move_id) != 0.0f && moves.height(move_id) != 0.0f) {
+                const Vec3f& position = moves.position(move_id);
+                m_paths_bounding_box.merge(position.cast<double>());
                 //BBS: use convex_hull for toolpath outside check
-                pts.emplace_back(Point(scale_(move.position.x()), scale_(move.position.y())));
+                pts.emplace_back(Point(scale_(position.x()), scale_(position.y())));
             }
         //}
     }
 
     // BBS: also merge the point on arc to bounding box
-    for (const GCodeProcessorResult::MoveVertex& move : gcode_result.moves) {
+    for (size_t move_id = 0; move_id < moves.size(); ++move_id) {
         // continue if not arc path
-        if (!move.is_arc_move_with_interpolation_points())
+        auto [points_begin, points_end] = moves.interpolation_points(move_id);
+        if (points_begin == points_end)
             continue;
 
         //if (wxGetApp().is_gcode_viewer())
         //if (m_only_gcode_in_preview)
-        //    for (int i = 0; i < move.interpolation_points.size(); i++)
-        //        m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+        //    for (const Vec3f* point = points_begin; point != points_end; ++point)
+        //        m_paths_bounding_box.merge(point->cast<double>());
         //else {
-            if (move.type == EMoveType::Extrude && move.width != 0.0f && move.height != 0.0f)
-                for (int i = 0; i < move.interpolation_points.size(); i++) {
-                    m_paths_bounding_box.merge(move.interpolation_points[i].cast<double>());
+            if (moves.type(move_id) == EMoveType::Extrude && moves.width(move_id) != 0.0f && moves.height(move_id) != 0.0f)
+                for (const Vec3f* point = points_begin; point != points_end; ++point) {
+                    m_paths_bounding_box.merge(point->cast<double>());
                     //BBS: use convex_hull for toolpath outside check
-                    pts.emplace_back(Point(scale_(move.interpolation_points[i].x()), scale_(move.interpolation_points[i].y())));
+                    pts.emplace_back(Point(scale_(point->x()), scale_(point->y())));
                 }
         //}
     }
@@ -2422,10 +2434,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     }
 
     m_sequential_view.gcode_ids.clear();
-    for (size_t i = 0; i < gcode_result.moves.size(); ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
-        if (move.type != EMoveType::Seam)
-            m_sequential_view.gcode_ids.push_back(move.gcode_id);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (moves.type(i) != EMoveType::Seam)
+            m_sequential_view.gcode_ids.push_back(moves.gcode_id(i));
     }
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(",m_contained_in_bed %1%\n")%m_contained_in_bed;
 
@@ -2441,8 +2452,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     // toolpaths data -> extract vertices from result
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
-        if (curr.type == EMoveType::Seam) {
+        const EMoveType curr_type = moves.type(i);
+        if (curr_type == EMoveType::Seam) {
             ++seams_count;
             biased_seams_ids.push_back(i - biased_seams_ids.size() - 1);
         }
@@ -2453,7 +2464,6 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
 
         // update progress dialog
         ++progress_count;
@@ -2464,7 +2474,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             progress_count = 0;
         }
 
-        const unsigned char id = buffer_id(curr.type);
+        const unsigned char id = buffer_id(curr_type);
         TBuffer& t_buffer = m_buffers[id];
         MultiVertexBuffer& v_multibuffer = vertices[id];
         InstanceBuffer& inst_buffer = instances[id];
@@ -2473,7 +2483,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
         /*if (i%1000 == 1) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":i=%1%, buffer_id %2% render_type %3%, gcode_id %4%\n")
-                %i %(int)id %(int)t_buffer.render_primitive_type %curr.gcode_id;
+                %i %(int)id %(int)t_buffer.render_primitive_type %moves.gcode_id(i);
         }*/
 
         // ensure there is at least one vertex buffer
@@ -2483,14 +2493,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
         // add another vertex buffer
         // BBS: get the point number and then judge whether the remaining buffer is enough
-        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
+        size_t points_num = moves.interpolation_points_count(i) + 1;
         size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : points_num * t_buffer.max_vertices_per_segment_size_bytes();
         if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
             v_multibuffer.push_back(VertexBuffer());
             if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
                 Path& last_path = t_buffer.paths.back();
-                if (prev.type == curr.type && last_path.matches(curr))
-                    last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, move_id - 1);
+                if (moves.type(i - 1) == curr_type && last_path.matches(moves, i))
+                    last_path.add_sub_path(moves.position(i - 1), static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, move_id - 1);
             }
         }
 
@@ -2498,12 +2508,12 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
         switch (t_buffer.render_primitive_type)
         {
-        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id); break; }
+        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(moves, i - 1, i, v_buffer); break; }
+        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(moves, i - 1, i, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id); break; }
         case TBuffer::ERenderPrimitiveType::InstancedModel:
         {
-            add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
-            inst_offsets.push_back(prev.position - curr.position);
+            add_model_instance(moves, i, inst_buffer, inst_id_buffer, move_id);
+            inst_offsets.push_back(moves.position(i - 1) - moves.position(i));
 #if ENABLE_GCODE_VIEWER_STATISTICS
             ++m_statistics.instances_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -2511,8 +2521,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
         case TBuffer::ERenderPrimitiveType::BatchedModel:
         {
-            add_vertices_as_model_batch(curr, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
-            inst_offsets.push_back(prev.position - curr.position);
+            add_vertices_as_model_batch(moves, i, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
+            inst_offsets.push_back(moves.position(i - 1) - moves.position(i));
 #if ENABLE_GCODE_VIEWER_STATISTICS
             ++m_statistics.batched_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
@@ -2521,10 +2531,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
 
         // collect options zs for later use
-        if (curr.type == EMoveType::Pause_Print || curr.type == EMoveType::Custom_GCode) {
+        if (curr_type == EMoveType::Pause_Print || curr_type == EMoveType::Custom_GCode) {
+            const float curr_z = moves.position(i).z();
             const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
-            if (last_z == nullptr || curr.position[2] < *last_z - EPSILON || *last_z + EPSILON < curr.position[2])
-                options_zs.emplace_back(curr.position[2]);
+            if (last_z == nullptr || curr_z < *last_z - EPSILON || *last_z + EPSILON < curr_z)
+                options_zs.emplace_back(curr_z);
         }
     }
 
@@ -2553,7 +2564,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         m_ssid_to_moveid_map.push_back(extract_move_id(i));
 
     //BBS: smooth toolpaths corners for the given TBuffer using triangles
-    auto smooth_triangle_toolpaths_corners = [&gcode_result, this](const TBuffer& t_buffer, MultiVertexBuffer& v_multibuffer) {
+    auto smooth_triangle_toolpaths_corners = [&moves, this](const TBuffer& t_buffer, MultiVertexBuffer& v_multibuffer) {
         auto extract_position_at = [](const VertexBuffer& vertices, size_t offset) {
             return Vec3f(vertices[offset + 0], vertices[offset + 1], vertices[offset + 2]);
         };
@@ -2570,11 +2581,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
                 for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
                     size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
+                    temp_offset += moves.interpolation_points_count(move_id);
                 }
                 if (is_internal_point) {
                     size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
+                    temp_offset += (moves.interpolation_points_count(move_id) - interpolation_point_id);
                 }
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the right vertex of the previous segment
@@ -2612,11 +2623,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 size_t temp_offset = prev_sub_path.last.s_id - curr_s_id;
                 for (size_t i = prev_sub_path.last.s_id; i > curr_s_id; i--) {
                     size_t move_id = m_ssid_to_moveid_map[i];
-                    temp_offset += (gcode_result.moves[move_id].is_arc_move() ? gcode_result.moves[move_id].interpolation_points.size() : 0);
+                    temp_offset += moves.interpolation_points_count(move_id);
                 }
                 if (is_internal_point) {
                     size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                    temp_offset += (gcode_result.moves[move_id].interpolation_points.size() - interpolation_point_id);
+                    temp_offset += (moves.interpolation_points_count(move_id) - interpolation_point_id);
                 }
                 const size_t next_1st_offset = temp_offset * 6 * vertex_size_floats;
                 // offset into the vertex buffer of the left vertex of the previous segment
@@ -2658,14 +2669,13 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             for (size_t j = 1; j < path_vertices_count; ++j) {
                 size_t curr_s_id = path.sub_paths.front().first.s_id + j;
                 size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                int interpolation_points_num = gcode_result.moves[move_id].is_arc_move_with_interpolation_points()?
-                                                    gcode_result.moves[move_id].interpolation_points.size() : 0;
+                int interpolation_points_num = int(moves.interpolation_points_count(move_id));
                 int loop_num = interpolation_points_num;
                 //BBS: select the subpaths which contains the previous/next segments
                 if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
                     ++prev_sub_path_id;
                 if (j == path_vertices_count - 1) {
-                    if (!gcode_result.moves[move_id].is_arc_move_with_interpolation_points())
+                    if (!moves.is_arc_move_with_interpolation_points(move_id))
                         break;   // BBS: the last move has no internal point.
                     loop_num--;  //BBS: don't need to handle the endpoint of the last arc move of path
                     next_sub_path_id = prev_sub_path_id;
@@ -2679,17 +2689,17 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 // BBS: smooth triangle toolpaths corners including arc move which has internal interpolation point
                 for (int k = 0; k <= loop_num; k++) {
                     const Vec3f& prev = k==0?
-                                        gcode_result.moves[move_id - 1].position :
-                                        gcode_result.moves[move_id].interpolation_points[k-1];
+                                        moves.position(move_id - 1) :
+                                        moves.interpolation_point(move_id, k-1);
                     const Vec3f& curr = k==interpolation_points_num?
-                                        gcode_result.moves[move_id].position :
-                                        gcode_result.moves[move_id].interpolation_points[k];
+                                        moves.position(move_id) :
+                                        moves.interpolation_point(move_id, k);
                     const Vec3f& next = k < interpolation_points_num - 1?
-                                        gcode_result.moves[move_id].interpolation_points[k+1]:
-                                        (k == interpolation_points_num - 1? gcode_result.moves[move_id].position :
-                                        (gcode_result.moves[move_id + 1].is_arc_move_with_interpolation_points()?
-                                        gcode_result.moves[move_id + 1].interpolation_points[0] :
-                                        gcode_result.moves[move_id + 1].position));
+                                        moves.interpolation_point(move_id, k+1):
+                                        (k == interpolation_points_num - 1? moves.position(move_id) :
+                                        (moves.is_arc_move_with_interpolation_points(move_id + 1)?
+                                        moves.interpolation_point(move_id + 1, 0) :
+                                        moves.position(move_id + 1)));
 
                     const Vec3f prev_dir = (curr - prev).normalized();
                     const Vec3f prev_right = Vec3f(prev_dir.y(), -prev_dir.x(), 0.0f).normalized();
@@ -2841,8 +2851,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     seams_count = 0;
 
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
-        if (curr.type == EMoveType::Seam)
+        const EMoveType curr_type = moves.type(i);
+        if (curr_type == EMoveType::Seam)
             ++seams_count;
 
         size_t move_id = i - seams_count;
@@ -2851,10 +2861,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i == 0)
             continue;
 
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessorResult::MoveVertex* next = nullptr;
-        if (i < m_moves_count - 1)
-            next = &gcode_result.moves[i + 1];
+        const size_t next_idx = i < m_moves_count - 1 ? i + 1 : size_t(-1);
 
         ++progress_count;
         if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
@@ -2864,7 +2871,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             progress_count = 0;
         }
 
-        const unsigned char id = buffer_id(curr.type);
+        const unsigned char id = buffer_id(curr_type);
         TBuffer& t_buffer = m_buffers[id];
         MultiIndexBuffer& i_multibuffer = indices[id];
         CurrVertexBuffer& curr_vertex_buffer = curr_vertex_buffers[id];
@@ -2880,14 +2887,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         // if adding the indices for the current segment exceeds the threshold size of the current index buffer
         // create another index buffer
         // BBS: get the point number and then judge whether the remaining buffer is enough
-        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
+        size_t points_num = moves.interpolation_points_count(i) + 1;
         size_t indiced_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.indices_size_bytes() : points_num * t_buffer.max_indices_per_segment_size_bytes();
         if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - indiced_size_to_add) {
             i_multibuffer.push_back(IndexBuffer());
             vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
             if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
                 Path& last_path = t_buffer.paths.back();
-                last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
+                last_path.add_sub_path(moves.position(i - 1), static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
             }
         }
 
@@ -2904,7 +2911,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
             if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
                 Path& last_path = t_buffer.paths.back();
-                last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
+                last_path.add_sub_path(moves.position(i - 1), static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
             }
         }
 
@@ -2913,11 +2920,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         switch (t_buffer.render_primitive_type)
         {
         case TBuffer::ERenderPrimitiveType::Line: {
-            add_indices_as_line(prev, curr, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id);
+            add_indices_as_line(moves, i - 1, i, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id);
             break;
         }
         case TBuffer::ERenderPrimitiveType::Triangle: {
-            add_indices_as_solid(prev, curr, next, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id);
+            add_indices_as_solid(moves, i - 1, i, next_idx, t_buffer, curr_vertex_buffer.second, static_cast<unsigned int>(i_multibuffer.size()) - 1, i_buffer, move_id);
             break;
         }
         case TBuffer::ERenderPrimitiveType::BatchedModel: {
@@ -3004,27 +3011,27 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     size_t last_travel_s_id = 0;
     seams_count = 0;
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[i];
-        if (move.type == EMoveType::Seam)
+        const EMoveType type = moves.type(i);
+        if (type == EMoveType::Seam)
             ++seams_count;
 
         size_t move_id = i - seams_count;
 
-        if (move.type == EMoveType::Extrude) {
+        if (type == EMoveType::Extrude) {
             // layers zs
             const double* const last_z = m_layers.empty() ? nullptr : &m_layers.get_zs().back();
-            const double z = static_cast<double>(move.position.z());
+            const double z = static_cast<double>(moves.position(i).z());
             if (last_z == nullptr || z < *last_z - EPSILON || *last_z + EPSILON < z)
                 m_layers.append(z, { last_travel_s_id, move_id });
             else
                 m_layers.get_endpoints().back().last = move_id;
             // extruder ids
-            m_extruder_ids.emplace_back(move.extruder_id);
+            m_extruder_ids.emplace_back(moves.extruder_id(i));
             // roles
             if (i > 0)
-                m_roles.emplace_back(move.extrusion_role);
+                m_roles.emplace_back(moves.extrusion_role(i));
         }
-        else if (move.type == EMoveType::Travel) {
+        else if (type == EMoveType::Travel) {
             if (move_id - last_travel_s_id > 1 && !m_layers.empty())
                 m_layers.get_endpoints().back().last = move_id;
 
@@ -3404,10 +3411,7 @@ m_no_render_path = false;
                             if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line) {
                                 for (size_t i = sub_path.first.s_id + 1; i < m_sequential_view.current.last + 1; i++) {
                                     size_t move_id = m_ssid_to_moveid_map[i];
-                                    const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                                    if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
-                                    }
+                                    offset += m_gcode_result->moves.interpolation_points_count(move_id);
                                 }
                                 offset = 2 * offset - 1;
                             }
@@ -3416,10 +3420,7 @@ m_no_render_path = false;
                                 // BBS: modify to support moves which has internal point
                                 for (size_t i = sub_path.first.s_id + 1; i < m_sequential_view.current.last + 1; i++) {
                                     size_t move_id = m_ssid_to_moveid_map[i];
-                                    const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                                    if (curr.is_arc_move()) {
-                                        offset += curr.interpolation_points.size();
-                                    }
+                                    offset += m_gcode_result->moves.interpolation_points_count(move_id);
                                 }
                                 offset = indices_count * (offset - 1) + (indices_count - 2);
                                 if (sub_path_id == 0)
@@ -3514,10 +3515,7 @@ m_no_render_path = false;
             unsigned int segments_count = max_s_id - min_s_id;
             for (size_t i = min_s_id + 1; i < max_s_id + 1; i++) {
                 size_t move_id = m_ssid_to_moveid_map[i];
-                const GCodeProcessorResult::MoveVertex& curr = m_gcode_result->moves[move_id];
-                if (curr.is_arc_move()) {
-                    segments_count += curr.interpolation_points.size();
-                }
+                segments_count += m_gcode_result->moves.interpolation_points_count(move_id);
             }
             size_in_indices = buffer.indices_per_segment() * segments_count;
             break;
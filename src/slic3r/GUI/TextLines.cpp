@@ -263,6 +263,7 @@ void TextLinesModel::init(const Transform3d      &text_tr,
     for (const ModelVolume *volume : volumes_to_slice) {
         MeshSlicingParams slicing_params;
         slicing_params.trafo = c_trafo_inv * volume->get_matrix();
+        slicing_params.index = volume->mesh().slicing_index();
         for (size_t i = 0; i < count_lines; ++i) {
             const Polygons polys = Slic3r::slice_mesh(volume->mesh().its, line_centers[i], slicing_params);
             if (polys.empty())
@@ -0,0 +1,576 @@
+// Slicing performance benchmarks.
+// Runs the mesh slicer and the complete FFF pipeline (slicing, perimeters, infill, supports, G-code export)
+// over the meshes of tests/data and over a few synthetic heavy inputs, prints the results as JSON,
+// so that the results of two commits could be diffed.
+//
+// For each benchmark the wall time of each phase, the statistics of the Print / PrintObject steps, the number of heap allocations, the number of bytes allocated
+// and the peak resident memory of the process are reported. The allocations are counted by the global
+// operator new replaced below, thus allocations done by the TBB scalable allocator (Points) and by malloc() directly
+// are not counted. The ExtrusionEntities are allocated from the per-layer ExtrusionEntityArena, which takes its memory
+// chunks from the global operator new, thus each arena and each of its chunks counts as a single allocation, while
+// the entities placed into the chunks are not counted one by one. The peak resident memory never decreases over the lifetime
+// of the process, run a single benchmark with --filter to get a meaningful peak memory of that benchmark.
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r_version.h"
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCodeWriter.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCode/SeamPlacer.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/ModelArrange.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Utils.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+#include "libslic3r/Fill/FillLightning.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <tbb/task_arena.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "nlohmann/json.hpp"
+
+static std::atomic<size_t> g_num_allocations { 0 };
+static std::atomic<size_t> g_allocated_bytes { 0 };
+
+static void* counted_malloc(size_t size)
+{
+    g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return counted_malloc(size); }
+void* operator new[](size_t size) { return counted_malloc(size); }
+void  operator delete(void *ptr) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr) noexcept { std::free(ptr); }
+void  operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+using namespace Slic3r;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Wall times of the named phases of a single benchmark run in milliseconds.
+class Phases
+{
+public:
+    // Times the phase, the phases of the same name are accumulated.
+    template<typename Fn> void run(const std::string &name, Fn &&fn) {
+        auto start = Clock::now();
+        fn();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        for (std::pair<std::string, double> &phase : m_phases)
+            if (phase.first == name) {
+                phase.second += ms;
+                return;
+            }
+        m_phases.emplace_back(name, ms);
+    }
+    const std::vector<std::pair<std::string, double>>& phases() const { return m_phases; }
+
+    // Statistics of the Print and PrintObject steps reported by Print::step_stats().
+    std::vector<PrintStepStats> print_steps;
+
+private:
+    std::vector<std::pair<std::string, double>> m_phases;
+};
+
+struct Benchmark
+{
+    std::string                  name;
+    std::function<void(Phases&)> run;
+};
+
+TriangleMesh load_test_mesh(const std::string &name)
+{
+    std::string  path = std::string(TEST_DATA_DIR) + "/" + name + ".obj";
+    TriangleMesh mesh;
+    ObjInfo      obj_info;
+    std::string  message;
+    if (! load_obj(path.c_str(), &mesh, obj_info, message))
+        throw Slic3r::RuntimeError("Failed to load " + path + ": " + message);
+    return mesh;
+}
+
+// Slices the mesh at uniformly spaced planes spanning the whole mesh.
+void bench_slice_mesh(Phases &phases, const indexed_triangle_set &its, size_t num_layers)
+{
+    BoundingBoxf3      bbox = bounding_box(its);
+    std::vector<float> zs;
+    zs.reserve(num_layers);
+    for (size_t i = 0; i < num_layers; ++ i)
+        zs.emplace_back(float(bbox.min.z() + (bbox.max.z() - bbox.min.z()) * (double(i) + 0.5) / double(num_layers)));
+    MeshSlicingParams params;
+    std::vector<Polygons> layers;
+    phases.run("slice_mesh", [&]() { layers = slice_mesh(its, zs, params); });
+}
+
+// Boolean operation performed by ClipperLib directly, the reference of bench_clipper().
+ClipperLib::Paths clipperlib_clip(ClipperLib::ClipType clip_type, const ClipperLib::Paths &subject, const ClipperLib::Paths &clip)
+{
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(clip, ClipperLib::ptClip, true);
+    ClipperLib::Paths out;
+    clipper.Execute(clip_type, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return out;
+}
+
+// Offset performed by ClipperLib directly with the ClipperUtils defaults, the reference of bench_clipper().
+ClipperLib::Paths clipperlib_offset(const ClipperLib::Paths &paths, float delta, ClipperLib::JoinType join_type = DefaultJoinType)
+{
+    ClipperLib::ClipperOffset co;
+    co.MiterLimit         = DefaultMiterLimit;
+    co.ArcTolerance       = scaled(0.005);
+    co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+    co.AddPaths(paths, join_type, ClipperLib::etClosedPolygon);
+    ClipperLib::Paths out;
+    co.Execute(out, delta);
+    return out;
+}
+
+// Boolean operations and offsets over the layers of the mesh sliced at 0.2mm, the same mix of operations
+// the perimeter and infill generators perform: union, differences and intersections of consecutive layers, offsets.
+// The operations are run through ClipperUtils, which runs them on Clipper2 if built with SLIC3R_CLIPPER2,
+// and through ClipperLib directly ("clipperlib_" phases), thus a single run compares the two Clipper backends.
+void bench_clipper(Phases &phases, const indexed_triangle_set &its)
+{
+    BoundingBoxf3      bbox = bounding_box(its);
+    std::vector<float> zs;
+    for (double z = bbox.min.z() + 0.1; z < bbox.max.z(); z += 0.2)
+        zs.emplace_back(float(z));
+    std::vector<ExPolygons> layers;
+    phases.run("slice_mesh", [&]() { layers = slice_mesh_ex(its, zs); });
+
+    const float perimeter = float(scaled(0.45));
+    size_t      num_polygons = 0;
+    phases.run("union", [&]() {
+        for (const ExPolygons &layer : layers)
+            num_polygons += union_ex(layer).size();
+    });
+    phases.run("diff_intersection", [&]() {
+        for (size_t i = 1; i < layers.size(); ++ i) {
+            num_polygons += diff_ex(layers[i], layers[i - 1]).size();
+            num_polygons += intersection_ex(layers[i], layers[i - 1]).size();
+            num_polygons += diff_ex(layers[i], layers[i - 1], ApplySafetyOffset::Yes).size();
+        }
+    });
+    phases.run("offset", [&]() {
+        for (const ExPolygons &layer : layers) {
+            ExPolygons inner = layer;
+            for (int i = 0; i < 3 && ! inner.empty(); ++ i)
+                inner = offset_ex(inner, - perimeter);
+            num_polygons += inner.size();
+            num_polygons += offset2_ex(layer, - perimeter, perimeter).size();
+            num_polygons += offset(layer, perimeter, ClipperLib::jtRound, scaled(0.005)).size();
+        }
+    });
+    // The two infill areas of the perimeter generator, with and without the infill / wall overlap, see PerimeterGenerator::process_classic().
+    phases.run("offset2_ex_pair", [&]() {
+        for (const ExPolygons &layer : layers) {
+            num_polygons += offset2_ex(layer, - perimeter, 0.5f * perimeter).size();
+            num_polygons += offset2_ex(layer, - perimeter, 0.3f * perimeter).size();
+        }
+    });
+    phases.run("offset2_ex_batch", [&]() {
+        for (const ExPolygons &layer : layers)
+            for (const ExPolygons &expolys : offset2_ex_batch(layer, { { - perimeter, 0.5f * perimeter }, { - perimeter, 0.3f * perimeter } }))
+                num_polygons += expolys.size();
+    });
+    std::vector<ClipperLib::Paths> paths;
+    for (const ExPolygons &layer : layers) {
+        ClipperUtils::ExPolygonsProvider provider(layer);
+        paths.emplace_back(provider.begin(), provider.end());
+    }
+    phases.run("clipperlib_union", [&]() {
+        for (const ClipperLib::Paths &layer : paths)
+            num_polygons += clipperlib_clip(ClipperLib::ctUnion, layer, {}).size();
+    });
+    phases.run("clipperlib_diff_intersection", [&]() {
+        for (size_t i = 1; i < paths.size(); ++ i) {
+            num_polygons += clipperlib_clip(ClipperLib::ctDifference, paths[i], paths[i - 1]).size();
+            num_polygons += clipperlib_clip(ClipperLib::ctIntersection, paths[i], paths[i - 1]).size();
+            num_polygons += clipperlib_clip(ClipperLib::ctDifference, paths[i], clipperlib_offset(paths[i - 1], ClipperSafetyOffset)).size();
+        }
+    });
+    phases.run("clipperlib_offset", [&]() {
+        for (const ClipperLib::Paths &layer : paths) {
+            ClipperLib::Paths inner = layer;
+            for (int i = 0; i < 3 && ! inner.empty(); ++ i)
+                inner = clipperlib_offset(inner, - perimeter);
+            num_polygons += inner.size();
+            num_polygons += clipperlib_offset(clipperlib_offset(layer, - perimeter), perimeter).size();
+            num_polygons += clipperlib_offset(layer, perimeter, ClipperLib::jtRound).size();
+        }
+    });
+    // Keep the results alive, so that the operations are not optimized out.
+    if (num_polygons == size_t(-1))
+        std::cerr << num_polygons << std::endl;
+}
+
+// Adds the meshes as separate objects with num_instances instances each and applies the model to the print,
+// the print is set up the same way as Slic3r::Test::init_print() does.
+void apply_print(Phases &phases, Model &model, Print &print, std::vector<TriangleMesh> meshes, std::initializer_list<ConfigBase::SetDeserializeItem> config_items, size_t num_instances)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict(config_items);
+
+    phases.run("apply", [&]() {
+        for (TriangleMesh &mesh : meshes) {
+            ModelObject *object = model.add_object();
+            object->name = "object.stl";
+            object->add_volume(std::move(mesh));
+            for (size_t i = 0; i < num_instances; ++ i)
+                object->add_instance();
+        }
+        arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(min_object_distance(config)) });
+        for (ModelObject *mo : model.objects) {
+            mo->ensure_on_bed();
+            print.auto_assign_extruders(mo);
+        }
+        print.apply(model, config);
+        print.validate();
+        print.set_status_silent();
+    });
+}
+
+// Processes the meshes as separate objects with num_instances instances each and exports G-code.
+void bench_print(Phases &phases, std::vector<TriangleMesh> meshes, std::initializer_list<ConfigBase::SetDeserializeItem> config_items, size_t num_instances = 1)
+{
+    Model model;
+    Print print;
+    apply_print(phases, model, print, std::move(meshes), config_items, num_instances);
+    phases.run("process", [&]() { print.process(); });
+
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    phases.run("export_gcode", [&]() { print.export_gcode(temp.string(), nullptr, nullptr); });
+    boost::nowide::remove(temp.string().c_str());
+    phases.print_steps = print.step_stats();
+}
+
+// Builds the lightning infill trees of the processed object twice, once limited to a single thread,
+// which is the cost of the generator before its layers were processed in parallel, and once with all threads.
+void bench_lightning(Phases &phases, std::vector<TriangleMesh> meshes, std::initializer_list<ConfigBase::SetDeserializeItem> config_items)
+{
+    Model model;
+    Print print;
+    apply_print(phases, model, print, std::move(meshes), config_items, 1);
+    phases.run("process", [&]() { print.process(); });
+
+    const PrintObject &object = *print.objects().front();
+    phases.run("lightning_serial", [&]() {
+        tbb::task_arena arena(1);
+        arena.execute([&object]() { FillLightning::build_generator(object, []() {}); });
+    });
+    phases.run("lightning_parallel", [&]() { FillLightning::build_generator(object, []() {}); });
+}
+
+// Exports the G-code of the processed print twice, once limited to a single thread and once with all threads,
+// thus the parallel stages of the export (preparation of the layers ahead of the generator, parsing of the layer lines,
+// preparation of the travel boundaries) are compared against the serial export.
+void bench_gcode_export(Phases &phases, std::vector<TriangleMesh> meshes, std::initializer_list<ConfigBase::SetDeserializeItem> config_items, size_t num_instances)
+{
+    Model model;
+    Print print;
+    apply_print(phases, model, print, std::move(meshes), config_items, num_instances);
+    phases.run("process", [&]() { print.process(); });
+
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    phases.run("export_gcode_serial", [&]() {
+        tbb::task_arena arena(1);
+        arena.execute([&]() { print.export_gcode(temp.string(), nullptr, nullptr); });
+    });
+    phases.run("export_gcode_parallel", [&]() { print.export_gcode(temp.string(), nullptr, nullptr); });
+    boost::nowide::remove(temp.string().c_str());
+}
+
+// Exports the G-code of the processed print with an empty seam visibility cache, where the objects sharing their geometry
+// are raycasted once, then again with the cache filled by the first export, as when only a speed setting changed,
+// where the mesh visibility and the seam candidates of the unchanged layers are reused.
+void bench_seam_cache(Phases &phases, std::vector<TriangleMesh> meshes, std::initializer_list<ConfigBase::SetDeserializeItem> config_items, size_t num_instances)
+{
+    Model model;
+    Print print;
+    apply_print(phases, model, print, std::move(meshes), config_items, num_instances);
+    phases.run("process", [&]() { print.process(); });
+
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    phases.run("export_gcode_cold_cache", [&]() {
+        print.seam_visibility_cache()->clear();
+        print.export_gcode(temp.string(), nullptr, nullptr);
+    });
+    phases.run("export_gcode_warm_cache", [&]() { print.export_gcode(temp.string(), nullptr, nullptr); });
+    boost::nowide::remove(temp.string().c_str());
+}
+
+// Loads the G-code exported from the processed print. GCodeReader::parse_file() reading the file sequentially is compared
+// against parse_file_parallel() on the memory mapped file, limited to a single thread and with all threads,
+// with a callback as cheap as possible, and GCodeProcessor processing the lines serially in the callback.
+void bench_gcode_load(Phases &phases, std::vector<TriangleMesh> meshes, std::initializer_list<ConfigBase::SetDeserializeItem> config_items, size_t num_instances)
+{
+    Model model;
+    Print print;
+    apply_print(phases, model, print, std::move(meshes), config_items, num_instances);
+    phases.run("process", [&]() { print.process(); });
+
+    boost::filesystem::path temp = boost::filesystem::unique_path();
+    phases.run("export_gcode", [&]() { print.export_gcode(temp.string(), nullptr, nullptr); });
+
+    size_t num_lines = 0;
+    auto   count     = [&num_lines](GCodeReader&, const GCodeReader::GCodeLine&) { ++ num_lines; };
+    std::vector<size_t> lines_ends;
+    phases.run("parse_file", [&]() { GCodeReader().parse_file(temp.string(), count, lines_ends); });
+    phases.run("parse_file_parallel_1_thread", [&]() {
+        tbb::task_arena arena(1);
+        arena.execute([&]() { GCodeReader().parse_file_parallel(temp.string(), count, lines_ends); });
+    });
+    phases.run("parse_file_parallel", [&]() { GCodeReader().parse_file_parallel(temp.string(), count, lines_ends); });
+    phases.run("process_file_1_thread", [&]() {
+        tbb::task_arena arena(1);
+        arena.execute([&]() { GCodeProcessor().process_file(temp.string()); });
+    });
+    phases.run("process_file", [&]() { GCodeProcessor().process_file(temp.string()); });
+    boost::nowide::remove(temp.string().c_str());
+    // Keep the results alive, so that the parsing is not optimized out.
+    if (num_lines == size_t(-1))
+        std::cerr << num_lines << std::endl;
+}
+
+// Emits a million extrusion moves into a buffer reused by the layers, as GCode::_extrude() does,
+// the allocations reported are those of the GCodeWriter per move.
+void bench_gcode_writer(Phases &phases, size_t num_layers, size_t num_moves)
+{
+    GCodeWriter writer;
+    writer.set_extruders({ 0 });
+    writer.set_extruder(0);
+    std::string layer_gcode;
+    size_t      gcode_size = 0;
+    phases.run("emit_moves", [&]() {
+        for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id) {
+            layer_gcode.clear();
+            const double z = 0.2 * double(layer_id + 1);
+            writer.travel_to_xyz(layer_gcode, Vec3d(0., 0., z), "move to next layer");
+            writer.set_speed(layer_gcode, 3000.);
+            for (size_t i = 0; i < num_moves; ++ i) {
+                const double angle = 2. * PI * double(i) / double(num_moves);
+                writer.extrude_to_xy(layer_gcode, Vec2d(100. + 50. * cos(angle), 100. + 50. * sin(angle)), 0.0123, "perimeter");
+            }
+            gcode_size += layer_gcode.size();
+        }
+    });
+    // Keep the results alive, so that the moves are not optimized out.
+    if (gcode_size == size_t(-1))
+        std::cerr << gcode_size << std::endl;
+}
+
+std::vector<Benchmark> benchmarks()
+{
+    static const char *test_meshes[] = {
+        "20mm_cube", "A", "V", "bridge", "cube_with_hole", "extruder_idler", "frog_legs", "ipadstand",
+        "overhang", "pyramid", "sloping_hole", "small_dorito", "two_hollow_squares"
+    };
+
+    std::vector<Benchmark> out;
+    for (const char *name : test_meshes)
+        out.push_back({ std::string("slice_mesh/") + name, [name](Phases &phases) {
+            TriangleMesh mesh = load_test_mesh(name);
+            bench_slice_mesh(phases, mesh.its, 1000);
+        }});
+    // About 2 million triangles sliced at 2000 planes.
+    out.push_back({ "slice_mesh/sphere_2M_triangles_2000_layers", [](Phases &phases) {
+        indexed_triangle_set its = its_make_sphere(50., 2. * PI / 1440.);
+        bench_slice_mesh(phases, its, 2000);
+    }});
+
+    for (const char *name : test_meshes)
+        out.push_back({ std::string("clipper/") + name, [name](Phases &phases) {
+            TriangleMesh mesh = load_test_mesh(name);
+            bench_clipper(phases, mesh.its);
+        }});
+
+    for (const char *name : test_meshes)
+        out.push_back({ std::string("print/") + name, [name](Phases &phases) {
+            bench_print(phases, { load_test_mesh(name) }, { { "layer_height", 0.2 } });
+        }});
+    out.push_back({ "gcode_writer/1M_moves", [](Phases &phases) {
+        bench_gcode_writer(phases, 1000, 1000);
+    }});
+    // A plate of several objects with 1500 layers, with the overhang speed and the avoidance of crossing the walls enabled.
+    out.push_back({ "gcode_export/4_objects_1500_layers", [](Phases &phases) {
+        bench_gcode_export(phases, { make_cylinder(15., 150.), make_cube(20., 20., 150.), make_sphere(75., 2. * PI / 180.), make_cylinder(5., 150.) },
+            { { "layer_height", 0.1 }, { "initial_layer_print_height", 0.1 }, { "reduce_crossing_wall", 1 } }, 2);
+    }});
+    // A plate of four copies of a sculpture of about 130k triangles with the aligned seam, which raycasts the visibility of the mesh.
+    out.push_back({ "seam_cache/4_copies_130k_triangles", [](Phases &phases) {
+        TriangleMesh sculpture = make_sphere(40., 2. * PI / 360.);
+        bench_seam_cache(phases, { sculpture, sculpture, sculpture, sculpture }, { { "layer_height", 0.2 }, { "seam_position", "aligned" } }, 1);
+    }});
+    // Loading the G-code of the same plate.
+    out.push_back({ "gcode_load/4_objects_1500_layers", [](Phases &phases) {
+        bench_gcode_load(phases, { make_cylinder(15., 150.), make_cube(20., 20., 150.), make_sphere(75., 2. * PI / 180.), make_cylinder(5., 150.) },
+            { { "layer_height", 0.1 }, { "initial_layer_print_height", 0.1 } }, 2);
+    }});
+    // The same plate with the extrusion rate smoothing of the pressure equalizer, which runs on the parsed layer lines.
+    out.push_back({ "gcode_export/4_objects_1500_layers_pressure_equalizer", [](Phases &phases) {
+        bench_gcode_export(phases, { make_cylinder(15., 150.), make_cube(20., 20., 150.), make_sphere(75., 2. * PI / 180.), make_cylinder(5., 150.) },
+            { { "layer_height", 0.1 }, { "initial_layer_print_height", 0.1 }, { "max_volumetric_extrusion_rate_slope", 1.8 } }, 2);
+    }});
+    out.push_back({ "print/cylinder_2000_layers", [](Phases &phases) {
+        bench_print(phases, { make_cylinder(20., 200.) },
+            { { "layer_height", 0.1 }, { "initial_layer_print_height", 0.1 } });
+    }});
+    out.push_back({ "print/cube_100_instances", [](Phases &phases) {
+        TriangleMesh cube = make_cube(10., 10., 10.);
+        bench_print(phases, { cube }, { { "layer_height", 0.2 } }, 100);
+    }});
+    out.push_back({ "print/sphere_gyroid", [](Phases &phases) {
+        bench_print(phases, { make_sphere(40., 2. * PI / 180.) },
+            { { "layer_height", 0.2 }, { "sparse_infill_pattern", "gyroid" }, { "sparse_infill_density", "20%" } });
+    }});
+    out.push_back({ "print/overhang_tree_support", [](Phases &phases) {
+        bench_print(phases, { load_test_mesh("overhang") },
+            { { "layer_height", 0.2 }, { "enable_support", 1 }, { "support_type", "tree(auto)" } });
+    }});
+    out.push_back({ "print/overhang_normal_support", [](Phases &phases) {
+        bench_print(phases, { load_test_mesh("overhang") },
+            { { "layer_height", 0.2 }, { "enable_support", 1 }, { "support_type", "normal(auto)" } });
+    }});
+    // Organic tree supports at fine layers, where the propagation of the branches dominates the slicing time.
+    for (const char *name : { "overhang", "bridge", "A_upsidedown", "frog_legs", "ipadstand" })
+        out.push_back({ std::string("tree_support/") + name + "_0.08mm", [name](Phases &phases) {
+            bench_print(phases, { load_test_mesh(name) },
+                { { "layer_height", 0.08 }, { "initial_layer_print_height", 0.08 }, { "enable_support", 1 },
+                  { "support_type", "tree(auto)" }, { "support_style", "organic" } });
+        }});
+    out.push_back({ "lightning/sphere_1000_layers", [](Phases &phases) {
+        bench_lightning(phases, { make_sphere(50., 2. * PI / 180.) },
+            { { "layer_height", 0.1 }, { "initial_layer_print_height", 0.1 }, { "sparse_infill_pattern", "lightning" }, { "sparse_infill_density", "15%" } });
+    }});
+    out.push_back({ "lightning/overhang", [](Phases &phases) {
+        bench_lightning(phases, { load_test_mesh("overhang") },
+            { { "layer_height", 0.2 }, { "sparse_infill_pattern", "lightning" }, { "sparse_infill_density", "15%" } });
+    }});
+    return out;
+}
+
+void print_usage()
+{
+    std::cout << "Usage: slic3r_bench [--filter <substring>] [--repeat <n>] [--output <file.json>] [--list]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string filter;
+    std::string output;
+    size_t      repeat = 1;
+    bool        list   = false;
+    for (int i = 1; i < argc; ++ i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++ i];
+        else if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::max(1, std::atoi(argv[++ i]));
+        else if (arg == "--output" && i + 1 < argc)
+            output = argv[++ i];
+        else if (arg == "--list")
+            list = true;
+        else {
+            print_usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Only report errors, the JSON goes to stdout.
+    set_logging_level(1);
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const Benchmark &benchmark : benchmarks()) {
+        if (! filter.empty() && benchmark.name.find(filter) == std::string::npos)
+            continue;
+        if (list) {
+            std::cout << benchmark.name << std::endl;
+            continue;
+        }
+        std::cerr << "Running " << benchmark.name << std::endl;
+        nlohmann::json runs = nlohmann::json::array();
+        for (size_t i = 0; i < repeat; ++ i) {
+            Phases phases;
+            size_t num_allocations = g_num_allocations.load();
+            size_t allocated_bytes = g_allocated_bytes.load();
+            double total_ms        = 0.;
+            try {
+                auto start = Clock::now();
+                benchmark.run(phases);
+                total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            } catch (const std::exception &ex) {
+                std::cerr << benchmark.name << " failed: " << ex.what() << std::endl;
+                runs.push_back({ { "error", ex.what() } });
+                continue;
+            }
+            nlohmann::json steps = nlohmann::json::object();
+            for (const auto &[name, ms] : phases.phases())
+                steps[name] = ms;
+            nlohmann::json print_steps = nlohmann::json::array();
+            for (const PrintStepStats &step : phases.print_steps)
+                print_steps.push_back({
+                    { "object",            step.object_name },
+                    { "step",              step.step_name },
+                    { "wall_time_ms",      step.wall_ms },
+                    { "cpu_time_ms",       step.cpu_ms },
+                    { "memory_delta",      step.memory_delta },
+                    { "layers",            step.layers },
+                    { "paths",             step.paths },
+                    { "polygons",          step.polygons }
+                });
+            runs.push_back({
+                { "wall_time_ms",    total_ms },
+                { "steps_ms",        steps },
+                { "print_steps",     print_steps },
+                { "allocations",     g_num_allocations.load() - num_allocations },
+                { "allocated_bytes", g_allocated_bytes.load() - allocated_bytes },
+                { "peak_rss_bytes",  peak_memory_usage() }
+            });
+        }
+        results.push_back({ { "name", benchmark.name }, { "runs", runs } });
+    }
+    if (list)
+        return 0;
+
+    nlohmann::json out = {
+        { "version",    SLIC3R_VERSION },
+        { "commit",     GIT_COMMIT_HASH },
+        { "benchmarks", results }
+    };
+    if (output.empty())
+        std::cout << out.dump(2) << std::endl;
+    else {
+        boost::nowide::ofstream file(output);
+        file << out.dump(2) << std::endl;
+        if (! file) {
+            std::cerr << "Failed to write " << output << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
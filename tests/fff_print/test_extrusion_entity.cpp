@@ -83,3 +83,47 @@ SCENARIO("ExtrusionEntityCollection: Polygon flattening", "[ExtrusionEntity]") {
         }
     }
 }
+
+TEST_CASE("ExtrusionEntityArena: entities of a layer share a few chunks", "[ExtrusionEntity]") {
+    srand(0xDEADBEEF);
+    const ExtrusionPaths paths = random_paths(1000);
+
+    auto allocate_layer = [&paths]() {
+        ExtrusionEntityArena::Scope arena_scope;
+        ExtrusionEntityCollection   collection;
+        // Each entity is cloned into the collection, thus allocated through ExtrusionEntity::operator new.
+        collection.append(paths);
+        return collection;
+    };
+
+    const bool enabled = ExtrusionEntityArena::enabled();
+
+    ExtrusionEntityArena::set_enabled(false);
+    ExtrusionEntityArena::Stats before = ExtrusionEntityArena::stats();
+    {
+        ExtrusionEntityCollection collection = allocate_layer();
+        REQUIRE(collection.entities.size() == paths.size());
+    }
+    ExtrusionEntityArena::Stats after = ExtrusionEntityArena::stats();
+    CHECK(after.arenas == before.arenas);
+    CHECK(after.heap_allocations - before.heap_allocations == paths.size());
+
+    ExtrusionEntityArena::set_enabled(true);
+    before = ExtrusionEntityArena::stats();
+    {
+        // The entities outlive the scope, the chunks are released with the last of them.
+        ExtrusionEntityCollection collection = allocate_layer();
+        REQUIRE(collection.entities.size() == paths.size());
+        for (size_t i = 0; i < paths.size(); ++ i)
+            CHECK(collection.entities[i]->first_point() == paths[i].first_point());
+        // A clone made outside of a scope comes from the heap.
+        ExtrusionEntity *clone = collection.entities.front()->clone();
+        CHECK(ExtrusionEntityArena::stats().heap_allocations - before.heap_allocations == 1);
+        delete clone;
+    }
+    after = ExtrusionEntityArena::stats();
+    CHECK(after.arenas - before.arenas == 1);
+    CHECK(after.chunks - before.chunks < paths.size() / 10);
+
+    ExtrusionEntityArena::set_enabled(enabled);
+}
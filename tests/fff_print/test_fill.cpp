@@ -5,6 +5,7 @@
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Print.hpp"
@@ -429,6 +430,45 @@ for my $pattern (qw(rectilinear honeycomb hilbertcurve concentric)) {
 }
 */
 
+TEST_CASE("Fill: Adaptive octree cache", "[Fill]") {
+    indexed_triangle_set     cube = its_make_cube(20., 20., 20.);
+    const std::vector<Vec3d> no_overhangs;
+    FillAdaptive::OctreeCache cache;
+
+    FillAdaptive::OctreeSharedPtr octree = cache.get_or_build(cube, no_overhangs, 2., false);
+    REQUIRE(octree);
+    SECTION("the same mesh and line spacing reuse the octree") {
+        REQUIRE(cache.get_or_build(cube, no_overhangs, 2., false) == octree);
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(cache.misses() == 1);
+    }
+    SECTION("a different line spacing, mode or mesh builds a new octree") {
+        REQUIRE(cache.get_or_build(cube, no_overhangs, 3., false) != octree);
+        REQUIRE(cache.get_or_build(cube, no_overhangs, 2., true) != octree);
+        its_translate(cube, Vec3f(1.f, 0.f, 0.f));
+        REQUIRE(cache.get_or_build(cube, no_overhangs, 2., false) != octree);
+        REQUIRE(cache.hits() == 0);
+        REQUIRE(cache.misses() == 4);
+    }
+    SECTION("the memory of the octrees is accounted and released") {
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.memsize() > 0);
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.memsize() == 0);
+    }
+    SECTION("the octrees over the memory limit are evicted, the most recently used one is kept") {
+        FillAdaptive::OctreeCache small_cache(8, 1);
+        FillAdaptive::OctreeSharedPtr first = small_cache.get_or_build(cube, no_overhangs, 2., false);
+        REQUIRE(small_cache.size() == 1);
+        REQUIRE(small_cache.get_or_build(cube, no_overhangs, 3., false) != first);
+        REQUIRE(small_cache.size() == 1);
+        // The evicted octree is still alive while in use, but it is built again.
+        REQUIRE(small_cache.get_or_build(cube, no_overhangs, 2., false) != first);
+        REQUIRE(small_cache.misses() == 3);
+    }
+}
+
 bool test_if_solid_surface_filled(const ExPolygon& expolygon, double flow_spacing, double angle, double density)
 {
     std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("rectilinear"));
@@ -1,8 +1,24 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <random>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <tbb/task_arena.h>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/GCodeLayerLines.hpp"
+#include "libslic3r/GCode/GCodeMovesColumns.hpp"
+#include "libslic3r/GCode/ToolOrdering.hpp"
+
+#include "test_data.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +36,480 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+SCENARIO("Parallel G-code parsing", "[GCode]") {
+	GIVEN("A G-code file with mixed line ends, line numbers, layer changes and no trailing newline") {
+		std::string gcode = "G21\nG90\r\nM83\n\nN10 G1 X10 Y20 E1.5 F1800 ; comment\n;LAYER_CHANGE\n";
+		for (int i = 0; i < 2000; ++ i) {
+			if (i % 100 == 0)
+				// The three kinds of layer changes the chunks are cut at.
+				gcode += (i / 100) % 3 == 0 ? std::string(";LAYER_CHANGE\n") : (i / 100) % 3 == 1 ? std::string("; CHANGE_LAYER\r\n") :
+				         "N" + std::to_string(i) + " G1 Z" + std::to_string(0.2 * (i / 100 + 1)) + " F600\n";
+			gcode += "G1 X" + std::to_string(i % 100) + " Y" + std::to_string(i % 37) + " E0.1\r\n";
+		}
+		gcode += "G1 Z0.4";
+		boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.gcode");
+		{
+			boost::nowide::ofstream out(path.string(), std::ios::binary);
+			out << gcode;
+		}
+		// chunk_size == 0 parses sequentially, max_lines stops parsing from the callback after that many lines.
+		auto parse = [&path](size_t chunk_size, std::vector<size_t> &lines_ends, size_t max_lines = std::numeric_limits<size_t>::max()) {
+			std::vector<std::string> lines;
+			GCodeReader reader;
+			auto callback = [&lines, max_lines](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+				lines.emplace_back(line.raw() + "|" + std::to_string(reader.x()) + "," + std::to_string(reader.y()) + "," + std::to_string(reader.e()));
+				if (lines.size() == max_lines)
+					reader.quit_parsing();
+			};
+			if (chunk_size > 0)
+				reader.parse_file_parallel(path.string(), callback, lines_ends, chunk_size);
+			else
+				reader.parse_file(path.string(), callback, lines_ends);
+			return lines;
+		};
+		std::vector<size_t> lines_ends;
+		std::vector<std::string> lines = parse(0, lines_ends);
+		REQUIRE(lines.size() == 2027);
+		// The file is about 40 kB with a layer change every 100 lines, so all but the default chunk size split it into many chunks.
+		// The chunks are extended up to the next layer change, thus with the chunk size of 1 and 7 every layer is a chunk,
+		// while the first layer and the layer changes next to "\r\n" line ends and line numbers test the cutting of the chunks.
+		for (size_t chunk_size : { size_t(1), size_t(7), size_t(1000), size_t(4096), size_t(4 * 1024 * 1024) }) {
+			THEN("parse_file_parallel() with chunk size " + std::to_string(chunk_size) + " reports the same lines and reader states as parse_file()") {
+				std::vector<size_t> lines_ends_parallel;
+				REQUIRE(parse(chunk_size, lines_ends_parallel) == lines);
+				REQUIRE(lines_ends_parallel == lines_ends);
+			}
+		}
+		THEN("parse_file_parallel() stops after the callback quits parsing") {
+			std::vector<size_t> lines_ends_parallel;
+			std::vector<std::string> lines_parallel = parse(1000, lines_ends_parallel, 1000);
+			REQUIRE(lines_parallel == std::vector<std::string>(lines.begin(), lines.begin() + 1000));
+		}
+		boost::filesystem::remove(path);
+	}
+}
+
+SCENARIO("Parallel G-code processing", "[GCode]") {
+	GIVEN("The G-code of a 20mm cube with a brim") {
+		Slic3r::Print print;
+		Slic3r::Model model;
+		Slic3r::Test::init_print({ Slic3r::Test::TestMesh::cube_20x20x20 }, print, model, {
+			{ "brim_width", 3 },
+			{ "sparse_infill_density", "15%" }
+		});
+		const std::string gcode = Slic3r::Test::gcode(print);
+		boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.gcode");
+		{
+			boost::nowide::ofstream out(path.string(), std::ios::binary);
+			out << gcode;
+		}
+		// chunk_size == 0 parses sequentially with GCodeReader::parse_file().
+		auto process = [&path](size_t chunk_size) {
+			auto processor = std::make_unique<GCodeProcessor>();
+			processor->set_parse_chunk_size(chunk_size);
+			processor->process_file(path.string());
+			return processor;
+		};
+		std::unique_ptr<GCodeProcessor> serial_processor = process(0);
+		const GCodeProcessorResult     &serial           = serial_processor->get_result();
+		REQUIRE(serial.moves.size() > 1000);
+		// The G-code is a few hundred kB, so the small chunk sizes cut it at every layer change.
+		for (size_t chunk_size : { size_t(1), size_t(64 * 1024), size_t(4 * 1024 * 1024) }) {
+			THEN("process_file() parsing in chunks of " + std::to_string(chunk_size) + " bytes estimates the same times and moves as parsing sequentially") {
+				std::unique_ptr<GCodeProcessor> parallel_processor = process(chunk_size);
+				const GCodeProcessorResult     &parallel           = parallel_processor->get_result();
+				for (size_t mode = 0; mode < size_t(PrintEstimatedStatistics::ETimeMode::Count); ++ mode) {
+					const PrintEstimatedStatistics::Mode &s = serial.print_statistics.modes[mode];
+					const PrintEstimatedStatistics::Mode &p = parallel.print_statistics.modes[mode];
+					REQUIRE(p.time == s.time);
+					REQUIRE(p.prepare_time == s.prepare_time);
+					REQUIRE(p.custom_gcode_times == s.custom_gcode_times);
+					REQUIRE(p.moves_times == s.moves_times);
+					REQUIRE(p.roles_times == s.roles_times);
+					REQUIRE(p.layers_times == s.layers_times);
+				}
+				REQUIRE(parallel.lines_ends == serial.lines_ends);
+				REQUIRE(parallel.moves.size() == serial.moves.size());
+				bool equal = true;
+				for (size_t i = 0; i < serial.moves.size() && equal; ++ i) {
+					const GCodeProcessorResult::MoveVertex m = serial.moves.vertex(i);
+					const GCodeProcessorResult::MoveVertex c = parallel.moves.vertex(i);
+					equal = c.gcode_id == m.gcode_id && c.type == m.type && c.extrusion_role == m.extrusion_role && c.extruder_id == m.extruder_id &&
+					        c.cp_color_id == m.cp_color_id && c.position == m.position && c.delta_extruder == m.delta_extruder &&
+					        c.feedrate == m.feedrate && c.width == m.width && c.height == m.height && c.mm3_per_mm == m.mm3_per_mm &&
+					        c.travel_dist == m.travel_dist && c.fan_speed == m.fan_speed && c.temperature == m.temperature &&
+					        c.time == m.time && c.layer_duration == m.layer_duration && c.move_path_type == m.move_path_type &&
+					        c.arc_center_position == m.arc_center_position && c.interpolation_points == m.interpolation_points;
+				}
+				REQUIRE(equal);
+			}
+		}
+		boost::filesystem::remove(path);
+	}
+}
+
+SCENARIO("Columnar storage of G-code moves", "[GCode]") {
+	GIVEN("Moves of 200 layers with a few extrusion roles, arcs and a feedrate, width and flow varying from move to move") {
+		using MoveVertex = GCodeProcessorResult::MoveVertex;
+		std::vector<MoveVertex> moves;
+		for (int layer = 0; layer < 200; ++ layer)
+			for (int i = 0; i < 500; ++ i) {
+				MoveVertex move;
+				move.gcode_id       = (unsigned int)moves.size() * 2;
+				move.type           = i % 50 == 0 ? EMoveType::Travel : EMoveType::Extrude;
+				move.extrusion_role = i < 200 ? erExternalPerimeter : erSolidInfill;
+				move.position       = Vec3f(float(i % 97) * 0.37f, float(i % 89) * 0.41f, 0.2f * float(layer + 1));
+				move.delta_extruder = 0.01f * float(i % 13);
+				move.feedrate       = (i < 200 ? 60.f : 150.f) - float(i % 17);
+				move.width          = 0.45f + 0.001f * float(i % 31);
+				move.height         = 0.2f;
+				move.mm3_per_mm     = 0.08f + 0.0002f * float(i % 31);
+				move.travel_dist    = 0.5f;
+				move.fan_speed      = 100.f;
+				move.temperature    = 210.f;
+				move.time           = float(moves.size());
+				move.layer_duration = float(layer + 1);
+				if (i % 25 == 10) {
+					move.move_path_type       = EMovePathType::Arc_move_ccw;
+					move.arc_center_position  = move.position + Vec3f(1.f, 0.f, 0.f);
+					move.interpolation_points = { move.position, move.position + Vec3f(0.5f, 0.5f, 0.f) };
+				} else
+					move.move_path_type = EMovePathType::Linear_move;
+				moves.emplace_back(std::move(move));
+			}
+		GCodeMovesColumns columns(moves);
+		THEN("the moves are read back unchanged") {
+			REQUIRE(columns.size() == moves.size());
+			bool equal = true;
+			for (size_t i = 0; i < moves.size() && equal; ++ i) {
+				const MoveVertex &m = moves[i];
+				const MoveVertex  c = columns.vertex(i);
+				equal = c.gcode_id == m.gcode_id && c.type == m.type && c.extrusion_role == m.extrusion_role && c.position == m.position &&
+				        c.delta_extruder == m.delta_extruder && c.feedrate == m.feedrate && c.width == m.width && c.height == m.height &&
+				        c.mm3_per_mm == m.mm3_per_mm && columns.width(i) == m.width && columns.feedrate(i) == m.feedrate &&
+				        c.time == m.time && c.layer_duration == m.layer_duration && c.move_path_type == m.move_path_type &&
+				        (! m.is_arc_move() || c.arc_center_position == m.arc_center_position) && c.interpolation_points == m.interpolation_points &&
+				        columns.volumetric_rate(i) == m.volumetric_rate();
+			}
+			REQUIRE(equal);
+		}
+		THEN("the repeated attributes are shared and the columns take less than half of the memory of the MoveVertex vector") {
+			size_t moves_size = SLIC3R_STDVEC_MEMSIZE(moves, MoveVertex);
+			for (const MoveVertex &move : moves)
+				moves_size += SLIC3R_STDVEC_MEMSIZE(move.interpolation_points, Vec3f);
+			INFO("MoveVertex vector: " << moves_size << " bytes, columns: " << columns.memory_size() << " bytes");
+			// One palette entry per layer, role, move type and path type, the varying feedrate, width and flow do not multiply them.
+			REQUIRE(columns.palette_size() <= 200 * 6);
+			REQUIRE(columns.memory_size() * 2 < moves_size);
+		}
+		THEN("erasing moves keeps the following moves and their arc data") {
+			// An arc move, a linear move and the first move.
+			for (size_t idx : { size_t(510), size_t(511), size_t(0) }) {
+				moves.erase(moves.begin() + idx);
+				columns.erase(idx);
+			}
+			REQUIRE(columns.size() == moves.size());
+			bool equal = true;
+			for (size_t i = 0; i < moves.size() && equal; ++ i) {
+				const MoveVertex               &m = moves[i];
+				const GCodeMovesColumns::MoveView c = columns[i];
+				auto [points_begin, points_end] = c.interpolation_points();
+				equal = c.gcode_id() == m.gcode_id && c.position() == m.position && c.move_path_type() == m.move_path_type &&
+				        (! m.is_arc_move() || c.arc_center_position() == m.arc_center_position) &&
+				        std::vector<Vec3f>(points_begin, points_end) == m.interpolation_points;
+			}
+			REQUIRE(equal);
+		}
+		THEN("the moves are iterated through views") {
+			size_t i = 0;
+			bool   equal = true;
+			for (GCodeMovesColumns::MoveView c : columns) {
+				equal &= c.index() == i && c.gcode_id() == moves[i].gcode_id && c.type() == moves[i].type && c.width() == moves[i].width &&
+				         c.is_arc_move_with_interpolation_points() == moves[i].is_arc_move_with_interpolation_points();
+				++ i;
+			}
+			REQUIRE(i == moves.size());
+			REQUIRE(equal);
+			REQUIRE(columns.back().gcode_id() == moves.back().gcode_id);
+		}
+		THEN("transforming the attributes modifies all the moves sharing them") {
+			columns.transform_attributes([](MoveVertex &move) {
+				if (move.type == EMoveType::Travel)
+					move.height = 0.f;
+				move.layer_duration *= 2.f;
+			});
+			bool equal = true;
+			for (size_t i = 0; i < moves.size() && equal; ++ i)
+				equal = columns.height(i) == (moves[i].type == EMoveType::Travel ? 0.f : moves[i].height) && columns.width(i) == moves[i].width &&
+				        columns.layer_duration(i) == 2.f * moves[i].layer_duration && columns.position(i) == moves[i].position;
+			REQUIRE(equal);
+		}
+	}
+}
+
+SCENARIO("G-code layer lines passed between the G-code post filters", "[GCode]") {
+	GIVEN("A layer G-code with moves, arcs, comments and no trailing newline") {
+		GCodeLayerLines gcode(std::string("G92 E0\nG1 X10.5 Y-2 E0.25 F1800 ;_EXTRUDE_SET_SPEED\nG3 X1 Y2 I-1.5 J0.5 E1\nG4 S2\nM106 S255\nG1 F\nG1 Z0.4"));
+		THEN("the lines are split and the axes parsed") {
+			REQUIRE(gcode.size() == 7);
+			REQUIRE(gcode.line(1) == "G1 X10.5 Y-2 E0.25 F1800 ;_EXTRUDE_SET_SPEED");
+			REQUIRE(gcode.line(6) == "G1 Z0.4");
+			REQUIRE(gcode[0].command == GCodeLayerLines::Command::G92);
+			REQUIRE(gcode[1].command == GCodeLayerLines::Command::G1);
+			REQUIRE(gcode[1].has(GCodeLayerLines::X));
+			REQUIRE(! gcode[1].has(GCodeLayerLines::Z));
+			REQUIRE(gcode[1].value(GCodeLayerLines::X) == 10.5f);
+			REQUIRE(gcode[1].value(GCodeLayerLines::F) == 1800.f);
+			REQUIRE(gcode[2].command == GCodeLayerLines::Command::G3);
+			REQUIRE(gcode[2].value(GCodeLayerLines::I) == -1.5f);
+			REQUIRE(gcode[3].command == GCodeLayerLines::Command::G4);
+			REQUIRE(gcode[4].command == GCodeLayerLines::Command::Other);
+			// The value of a parameter is not parsed from the next line.
+			REQUIRE(gcode[5].has(GCodeLayerLines::F));
+			REQUIRE(gcode[5].value(GCodeLayerLines::F) == 0.f);
+		}
+		THEN("the axes are parsed straight to float, as the pressure equalizer parses them") {
+			// Slightly above the midpoint between 1 and the next float: Parsed to double, the value rounds to the midpoint,
+			// which then rounds to 1 as a float.
+			GCodeLayerLines midpoint(std::string("G1 X1.000000059604644775390626 Y+2 Z 3"));
+			REQUIRE(midpoint[0].value(GCodeLayerLines::X) == std::nextafter(1.f, 2.f));
+			REQUIRE(midpoint[0].value(GCodeLayerLines::Y) == 2.f);
+			REQUIRE(midpoint[0].value(GCodeLayerLines::Z) == 3.f);
+			REQUIRE(! midpoint[0].canonical);
+		}
+		WHEN("the lines are copied in pieces interleaved with new text") {
+			GCodeLayerLines out;
+			out.append_lines(gcode, 0, gcode[2].begin);
+			out.append_text("M107\nG1 X");
+			out.append_text("5 Y6\n");
+			out.append_lines(gcode, gcode[2].begin, gcode[3].begin + 2);
+			out.append_lines(gcode, gcode[3].begin + 2, gcode.text().size());
+			THEN("the lines match the lines parsed from the complete text") {
+				GCodeLayerLines parsed(std::string(out.text()));
+				REQUIRE(out.size() == parsed.size());
+				bool equal = true;
+				for (size_t i = 0; i < out.size(); ++ i)
+					equal &= out[i].begin == parsed[i].begin && out[i].end == parsed[i].end && out[i].command == parsed[i].command &&
+					         out[i].axis_mask == parsed[i].axis_mask && out.line(i) == parsed.line(i);
+				REQUIRE(equal);
+				REQUIRE(out[3].value(GCodeLayerLines::X) == 5.f);
+			}
+		}
+	}
+	GIVEN("Moves GCodeReader tokenizes differently from GCodeLayerLines") {
+		const std::string text = "G1 X1.5 Y-2 E.25 F1800 ; comment\n  G1 X3\nG1 X4;Y5 Z6\nG1 X+1\nG1 X0x10\nG1 X2 A3\nG1 Y3\r\nG1 Y4\rG1 Y5\nG92 E0\nM106 S255\nG1 Z0.4";
+		GCodeLayerLines gcode{ std::string(text) };
+		THEN("only the plain moves are canonical") {
+			REQUIRE(gcode[0].canonical);
+			REQUIRE(gcode[6].canonical == false);
+			REQUIRE(gcode[8].canonical);
+			for (size_t i = 1; i < 6; ++ i)
+				REQUIRE(! gcode[i].canonical);
+		}
+		WHEN("GCodeReader parses the lines and the text") {
+			auto record = [](std::vector<std::string> &out) {
+				return [&out](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+					std::ostringstream ss;
+					ss << line.raw() << "|" << reader.x() << " " << reader.y() << " " << reader.z() << " " << reader.e();
+					for (Axis axis : { X, Y, Z, E, F, I, J })
+						if (line.has(axis))
+							ss << " " << int(axis) << "=" << line.value(axis);
+					out.emplace_back(ss.str());
+				};
+			};
+			std::vector<std::string> from_lines, from_text;
+			GCodeReader reader_lines, reader_text;
+			reader_lines.parse_lines(gcode, record(from_lines));
+			reader_text.parse_buffer(text, record(from_text));
+			THEN("the callbacks see the same lines, axes and positions") {
+				REQUIRE(from_lines == from_text);
+				REQUIRE(reader_lines.z() == reader_text.z());
+			}
+		}
+	}
+}
+
+SCENARIO("Pressure equalizer on the G-code layer lines", "[GCode]") {
+	GIVEN("Two layers with a jump of the feed rate between two extrude set speed blocks") {
+		GCodeConfig config;
+		config.use_relative_e_distances.value                    = false;
+		config.max_volumetric_extrusion_rate_slope.value         = 1.8;
+		config.max_volumetric_extrusion_rate_slope_segment_length.value = 1.;
+		PressureEqualizer equalizer(config);
+		auto layer = [](size_t layer_id, double z) {
+			std::string gcode = "G1 Z" + std::to_string(z) + "\n;_EXTRUSION_ROLE:2\n" +
+				"G1 F600 ;_EXTRUDE_SET_SPEED\nG1 X10 Y0 E0.5\nG1 X20 Y0 E1 ; wall\n;_EXTRUDE_END\n" +
+				"G1 F6000 ;_EXTRUDE_SET_SPEED\nG1 X30 Y0 E1.5\nG1 X40 Y0 E2\n;_EXTRUDE_END\nG92 E0\nM107";
+			return LayerLines{ GCodeLayerLines(std::move(gcode)), layer_id, false, false, false };
+		};
+		WHEN("the layers are processed and flushed by a NOP layer") {
+			LayerLines out0 = equalizer.process_layer(layer(0, 0.2));
+			LayerLines out1 = equalizer.process_layer(layer(1, 0.4));
+			LayerLines out2 = equalizer.process_layer({ GCodeLayerLines(), 0, false, false, true });
+			THEN("the layers are returned one layer back") {
+				REQUIRE(out0.nop_layer_result);
+				REQUIRE(out1.layer_id == 0);
+				REQUIRE(out2.layer_id == 1);
+			}
+			THEN("the role markers are removed, the feed rate change is smoothed, the last line is terminated") {
+				const std::string &text = out2.gcode.text();
+				REQUIRE(text.find(";_EXTRUSION_ROLE") == std::string::npos);
+				// The first of the segments the faster move is split to.
+				REQUIRE(text.find("G1 X21 ") != std::string::npos);
+				REQUIRE(text.find("; wall") != std::string::npos);
+				REQUIRE(text.rfind("G92 E0\nM107\n") == text.size() - 12);
+			}
+			THEN("the parsed lines match the lines parsed from the output text") {
+				for (const LayerLines *out : { &out1, &out2 }) {
+					GCodeLayerLines parsed(std::string(out->gcode.text()));
+					REQUIRE(out->gcode.size() == parsed.size());
+					bool equal = true;
+					for (size_t i = 0; i < parsed.size(); ++ i)
+						equal &= out->gcode[i].begin == parsed[i].begin && out->gcode[i].end == parsed[i].end && out->gcode[i].command == parsed[i].command &&
+						         out->gcode[i].axis_mask == parsed[i].axis_mask && out->gcode.line(i) == parsed.line(i);
+					REQUIRE(equal);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("Extruder order optimized over the layers", "[GCode]") {
+	// Printing extruder 1 before 2 is cheaper on its own, though it ends with extruder 2, which is expensive to continue from.
+	const std::vector<std::vector<float>> wipe_volumes {
+		{  0.f, 10.f, 10.f },
+		{ 50.f,  0.f, 10.f },
+		{ 50.f, 15.f,  0.f }
+	};
+	// The layer by layer orders. The first and the last layer keep their order, the last one as if it had a custom sequence.
+	const std::vector<std::vector<unsigned int>> greedy { { 0 }, { 1, 2 }, { 1 }, { 2, 1 } };
+	const std::vector<bool>                      fixed_order { true, false, false, true };
+	auto tool_ordering = [&greedy](int max_extruders, size_t max_states) {
+		auto out = std::make_unique<ToolOrdering>();
+		for (size_t i = 0; i < greedy.size(); ++ i) {
+			out->layer_tools().emplace_back(0.2 * (i + 1));
+			out->layer_tools().back().extruders = greedy[i];
+		}
+		out->set_extruder_order_max_extruders(max_extruders);
+		out->set_extruder_order_max_states(max_states);
+		return out;
+	};
+	auto orders = [](const ToolOrdering &tool_ordering) {
+		std::vector<std::vector<unsigned int>> out;
+		for (const LayerTools &lt : tool_ordering)
+			out.emplace_back(lt.extruders);
+		return out;
+	};
+	auto require_optimized = [&greedy, &orders](const ToolOrdering &ordering) {
+		REQUIRE(ordering.flush_volume_stats());
+		const ToolOrdering::FlushVolumeStats &stats = *ordering.flush_volume_stats();
+		REQUIRE(stats.greedy_flush_volume == Approx(60.));
+		REQUIRE(stats.optimized_flush_volume == Approx(50.));
+		std::vector<std::vector<unsigned int>> optimized = orders(ordering);
+		REQUIRE(optimized[0] == greedy[0]);
+		REQUIRE(optimized[1] == std::vector<unsigned int>{ 2, 1 });
+		REQUIRE(optimized[2] == greedy[2]);
+		REQUIRE(optimized[3] == greedy[3]);
+	};
+	GIVEN("A limit of extruders per layer above the extruders printed") {
+		std::unique_ptr<ToolOrdering> ordering = tool_ordering(16, 1000000);
+		ordering->optimize_extruder_order_over_layers(wipe_volumes, fixed_order);
+		THEN("The orders are solved exactly, only the orders of the layers not fixed change") {
+			REQUIRE(ordering->flush_volume_stats());
+			REQUIRE(ordering->flush_volume_stats()->beam_search_orders == 0);
+			REQUIRE(ordering->flush_volume_stats()->exact_orders > 0);
+			require_optimized(*ordering);
+		}
+	}
+	GIVEN("A limit of extruders per layer below the extruders printed") {
+		std::unique_ptr<ToolOrdering> ordering = tool_ordering(1, 1000000);
+		ordering->optimize_extruder_order_over_layers(wipe_volumes, fixed_order);
+		THEN("The layers printing more extruders are ordered by the beam search") {
+			REQUIRE(ordering->flush_volume_stats());
+			REQUIRE(ordering->flush_volume_stats()->beam_search_orders > 0);
+			require_optimized(*ordering);
+		}
+	}
+	GIVEN("No budget of the evaluated states") {
+		std::unique_ptr<ToolOrdering> ordering = tool_ordering(16, 0);
+		ordering->optimize_extruder_order_over_layers(wipe_volumes, fixed_order);
+		THEN("All the orders are found by the beam search") {
+			REQUIRE(ordering->flush_volume_stats());
+			REQUIRE(ordering->flush_volume_stats()->exact_orders == 0);
+			REQUIRE(ordering->flush_volume_stats()->beam_search_orders > 0);
+			require_optimized(*ordering);
+		}
+	}
+	GIVEN("No limit") {
+		std::unique_ptr<ToolOrdering> ordering = tool_ordering(0, 1000000);
+		ordering->optimize_extruder_order_over_layers(wipe_volumes, fixed_order);
+		THEN("The layer by layer order is kept") {
+			REQUIRE(! ordering->flush_volume_stats());
+			REQUIRE(orders(*ordering) == greedy);
+		}
+	}
+}
+
+SCENARIO("Extruder order optimization does not depend on the number of threads", "[GCode]") {
+	// Many layers printing random sets of up to 12 extruders, the budget runs out after some of the layers were solved exactly.
+	const size_t number_of_extruders = 12;
+	std::mt19937 rng(1234);
+	std::vector<std::vector<float>> wipe_volumes(number_of_extruders, std::vector<float>(number_of_extruders, 0.f));
+	for (size_t i = 0; i < number_of_extruders; ++ i)
+		for (size_t j = 0; j < number_of_extruders; ++ j)
+			if (i != j)
+				wipe_volumes[i][j] = float(std::uniform_int_distribution<int>(10, 500)(rng));
+	std::vector<std::vector<unsigned int>> greedy;
+	for (size_t i = 0; i < 200; ++ i) {
+		std::vector<unsigned int> extruders;
+		for (unsigned int extruder = 0; extruder < number_of_extruders; ++ extruder)
+			if (std::uniform_int_distribution<int>(0, 2)(rng) == 0)
+				extruders.emplace_back(extruder);
+		if (extruders.empty())
+			extruders.emplace_back(0);
+		std::shuffle(extruders.begin(), extruders.end(), rng);
+		greedy.emplace_back(std::move(extruders));
+	}
+	const std::vector<bool> fixed_order(greedy.size(), false);
+
+	struct Result {
+		std::vector<std::vector<unsigned int>> orders;
+		ToolOrdering::FlushVolumeStats         stats;
+	};
+	auto optimize = [&]() {
+		ToolOrdering ordering;
+		for (size_t i = 0; i < greedy.size(); ++ i) {
+			ordering.layer_tools().emplace_back(0.2 * (i + 1));
+			ordering.layer_tools().back().extruders = greedy[i];
+		}
+		ordering.set_extruder_order_max_extruders(8);
+		ordering.set_extruder_order_max_states(200000);
+		ordering.optimize_extruder_order_over_layers(wipe_volumes, fixed_order);
+		Result out;
+		for (const LayerTools &lt : ordering)
+			out.orders.emplace_back(lt.extruders);
+		REQUIRE(ordering.flush_volume_stats());
+		out.stats = *ordering.flush_volume_stats();
+		return out;
+	};
+
+	Result single_threaded;
+	tbb::task_arena(1).execute([&single_threaded, &optimize]() { single_threaded = optimize(); });
+	const Result multi_threaded = optimize();
+	const Result multi_threaded_again = optimize();
+
+	THEN("Some orders are solved exactly and some by the beam search") {
+		REQUIRE(single_threaded.stats.exact_orders > 0);
+		REQUIRE(single_threaded.stats.beam_search_orders > 0);
+		REQUIRE(single_threaded.stats.optimized_flush_volume <= single_threaded.stats.greedy_flush_volume);
+	}
+	THEN("The orders and the statistics are the same across the runs and the numbers of threads") {
+		for (const Result *result : { &multi_threaded, &multi_threaded_again }) {
+			REQUIRE(result->orders == single_threaded.orders);
+			REQUIRE(result->stats.exact_orders == single_threaded.stats.exact_orders);
+			REQUIRE(result->stats.beam_search_orders == single_threaded.stats.beam_search_orders);
+			REQUIRE(result->stats.optimized_flush_volume == single_threaded.stats.optimized_flush_volume);
+		}
+	}
+}
@@ -1,8 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <clocale>
 #include <memory>
 
 #include "libslic3r/GCodeWriter.hpp"
+#include "libslic3r/Utils.hpp"
 
 using namespace Slic3r;
 
@@ -94,3 +96,117 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("The moves appended to a buffer match the moves returned as strings.", "[GCodeWriter]") {
+
+    GIVEN("Two GCodeWriter instances with a single extruder") {
+        GCodeWriter writer_str, writer_buf;
+        for (GCodeWriter *writer : { &writer_str, &writer_buf }) {
+            writer->set_extruders({ 0 });
+            writer->set_extruder(0);
+        }
+        WHEN("the same moves are emitted by both writers") {
+            std::string expected;
+            std::string gcode = "; layer\n";
+            expected += gcode;
+            expected += writer_str.set_speed(1800.);
+            writer_buf.set_speed(gcode, 1800.);
+            expected += writer_str.travel_to_xyz(Vec3d(10., 10., 0.2), "travel");
+            writer_buf.travel_to_xyz(gcode, Vec3d(10., 10., 0.2), "travel");
+            for (int i = 1; i <= 100; ++ i) {
+                const Vec2d pt(10. + 0.1 * i, 10. + 0.05 * i);
+                expected += writer_str.extrude_to_xy(pt, 0.0123 * i, "perimeter");
+                writer_buf.extrude_to_xy(gcode, pt, 0.0123 * i, "perimeter");
+            }
+            expected += writer_str.extrude_arc_to_xy(Vec2d(30., 30.), Vec2d(5., 0.), 0.5, true);
+            writer_buf.extrude_arc_to_xy(gcode, Vec2d(30., 30.), Vec2d(5., 0.), 0.5, true);
+            expected += writer_str.extrude_to_xyz(Vec3d(31., 30., 0.3), 0.1);
+            writer_buf.extrude_to_xyz(gcode, Vec3d(31., 30., 0.3), 0.1);
+            expected += writer_str.travel_to_xy(Vec2d(0., 0.));
+            writer_buf.travel_to_xy(gcode, Vec2d(0., 0.));
+            THEN("the appended G-code equals the concatenated strings") {
+                REQUIRE_THAT(gcode, Catch::Equals(expected));
+                REQUIRE(writer_buf.get_position() == writer_str.get_position());
+            }
+        }
+    }
+}
+
+SCENARIO("The commands formatted without streams match the stream formatted output.", "[GCodeWriter]") {
+    // The expected strings were produced by the std::ostream based formatting the commands used before.
+    GIVEN("A GCodeWriter instance") {
+        GCodeWriter writer;
+        // May have been reset by a G-code export of another test, restored for the tests running afterwards.
+        const bool full_gcode_comment = GCodeWriter::full_gcode_comment;
+        ScopeGuard restore_full_gcode_comment([full_gcode_comment]() { GCodeWriter::full_gcode_comment = full_gcode_comment; });
+        GCodeWriter::full_gcode_comment = true;
+        WHEN("the fan speed is set") {
+            THEN("the output matches") {
+                REQUIRE_THAT(GCodeWriter::set_fan(gcfMarlinLegacy, 0), Catch::Equals("M106 S0 ; disable fan\n"));
+                REQUIRE_THAT(GCodeWriter::set_fan(gcfMarlinLegacy, 50), Catch::Equals("M106 S127 ; enable fan\n"));
+                REQUIRE_THAT(GCodeWriter::set_fan(gcfMach3, 100), Catch::Equals("M106 P255 ; enable fan\n"));
+                REQUIRE_THAT(GCodeWriter::set_fan(gcfSailfish, 0), Catch::Equals("M127 ; disable fan\n"));
+            }
+        }
+        WHEN("the pressure advance is set") {
+            THEN("the output matches") {
+                writer.config.gcode_flavor.value = gcfMarlinLegacy;
+                REQUIRE_THAT(writer.set_pressure_advance(0.0325), Catch::Equals("M900 K0.0325; Override pressure advance value\n"));
+                REQUIRE_THAT(writer.set_pressure_advance(1e-5), Catch::Equals("M900 K1e-05; Override pressure advance value\n"));
+                writer.config.gcode_flavor.value = gcfKlipper;
+                REQUIRE_THAT(writer.set_pressure_advance(0.04), Catch::Equals("SET_PRESSURE_ADVANCE ADVANCE=0.04; Override pressure advance value\n"));
+                writer.config.gcode_flavor.value = gcfRepRapFirmware;
+                REQUIRE_THAT(writer.set_pressure_advance(0.123456), Catch::Equals("M572 D0 S0.1235; Override pressure advance value\n"));
+                writer.set_is_bbl_machine(true);
+                REQUIRE_THAT(writer.set_pressure_advance(0.02), Catch::Equals("M900 K0.02 L1000 M10 ; Override pressure advance value\n"));
+                REQUIRE(writer.set_pressure_advance(-1.).empty());
+            }
+        }
+        WHEN("the jerk is set") {
+            THEN("the output matches") {
+                writer.config.gcode_flavor.value = gcfMarlinLegacy;
+                REQUIRE_THAT(writer.set_jerk_xy(9.), Catch::Equals("M205 X9 Y9 ; adjust jerk\n"));
+                REQUIRE_THAT(writer.set_jerk_xy(12.3456789), Catch::Equals("M205 X12.3457 Y12.3457 ; adjust jerk\n"));
+                writer.config.gcode_flavor.value = gcfKlipper;
+                REQUIRE_THAT(writer.set_jerk_xy(8.25), Catch::Equals("SET_VELOCITY_LIMIT SQUARE_CORNER_VELOCITY=8.25 ; adjust jerk\n"));
+                REQUIRE(writer.set_jerk_xy(8.25).empty());
+            }
+        }
+        WHEN("the acceleration is set") {
+            THEN("the output matches") {
+                writer.config.gcode_flavor.value = gcfMarlinLegacy;
+                REQUIRE_THAT(writer.set_print_acceleration(1500), Catch::Equals("M204 S1500 ; adjust acceleration\n"));
+                REQUIRE(writer.set_print_acceleration(1500).empty());
+                writer.config.gcode_flavor.value = gcfMarlinFirmware;
+                REQUIRE_THAT(writer.set_print_acceleration(1600), Catch::Equals("M204 P1600 ; adjust acceleration\n"));
+                REQUIRE_THAT(writer.set_travel_acceleration(2500), Catch::Equals("M204 T2500 ; adjust acceleration\n"));
+                writer.config.gcode_flavor.value         = gcfKlipper;
+                writer.config.accel_to_decel_enable.value = true;
+                writer.config.accel_to_decel_factor.value = 50;
+                REQUIRE_THAT(writer.set_print_acceleration(3000),
+                    Catch::Equals("SET_VELOCITY_LIMIT ACCEL=3000 ACCEL_TO_DECEL=1500 ; adjust ACCEL_TO_DECEL ; adjust acceleration\n"));
+                writer.config.accel_to_decel_factor.value = 33;
+                REQUIRE_THAT(writer.set_print_acceleration(3333),
+                    Catch::Equals("SET_VELOCITY_LIMIT ACCEL=3333 ACCEL_TO_DECEL=1099.89 ; adjust ACCEL_TO_DECEL ; adjust acceleration\n"));
+            }
+        }
+        WHEN("the speed is set with a comment and a cooling marker") {
+            THEN("the output matches") {
+                REQUIRE_THAT(writer.set_speed(1800.), Catch::Equals("G1 F1800\n"));
+                REQUIRE_THAT(writer.set_speed(1234.5678, "comment", ";_MARKER"), Catch::Equals("G1 F1234.568 ; comment;_MARKER\n"));
+            }
+        }
+        WHEN("the C locale uses a decimal comma") {
+            const std::string old_locale = std::setlocale(LC_NUMERIC, nullptr);
+            ScopeGuard restore_locale([&old_locale]() { std::setlocale(LC_NUMERIC, old_locale.c_str()); });
+            // Only tested if the locale is installed.
+            if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8") != nullptr || std::setlocale(LC_NUMERIC, "de_DE") != nullptr) {
+                THEN("the numbers are formatted with a decimal point") {
+                    writer.config.gcode_flavor.value = gcfMarlinLegacy;
+                    REQUIRE_THAT(writer.set_jerk_xy(12.3456789), Catch::Equals("M205 X12.3457 Y12.3457 ; adjust jerk\n"));
+                    REQUIRE_THAT(writer.set_pressure_advance(0.0325), Catch::Equals("M900 K0.0325; Override pressure advance value\n"));
+                }
+            }
+        }
+    }
+}
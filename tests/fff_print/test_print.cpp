@@ -3,6 +3,7 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/GCode/SeamPlacer.hpp"
 
 #include "test_data.hpp"
 
@@ -138,3 +139,63 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Step statistics", "[Print]") {
+    GIVEN("20mm cube and default config") {
+        WHEN("the print is processed") {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "layer_height", 0.2 } });
+            const PrintObject &object = *print.objects().front();
+            std::vector<PrintStepStats> stats = print.step_stats();
+            auto find_step = [&stats](const std::string &name) {
+                return std::find_if(stats.begin(), stats.end(), [&name](const PrintStepStats &s) { return s.step_name == name; });
+            };
+            THEN("the slicing step is recorded with its layers and polygons") {
+                auto it = find_step("slice");
+                REQUIRE(it != stats.end());
+                REQUIRE(it->is_object_step());
+                REQUIRE(it->object_id == object.id());
+                REQUIRE(it->layers == object.layer_count());
+                REQUIRE(it->polygons == object.layer_count());
+                REQUIRE(it->wall_ms >= 0.);
+            }
+            THEN("the perimeters step counts the perimeter paths") {
+                auto it = find_step("perimeters");
+                REQUIRE(it != stats.end());
+                REQUIRE(it->layers == object.layer_count());
+                REQUIRE(it->paths > 0);
+            }
+            THEN("the curled extrusions estimate is recorded although the step is never set done") {
+                REQUIRE(find_step("estimate_curled_extrusions") != stats.end());
+            }
+            THEN("the skirt and brim step is recorded as a Print step") {
+                auto it = find_step("skirt_brim");
+                REQUIRE(it != stats.end());
+                REQUIRE(! it->is_object_step());
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Seam visibility is reused by the following G-code exports", "[Print]") {
+    GIVEN("20mm cube with aligned seams") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, { { "seam_position", "aligned" } });
+        Slic3r::Test::gcode(print);
+        REQUIRE(print.seam_visibility_cache() != nullptr);
+        REQUIRE(print.seam_visibility_cache()->misses() == 1);
+        REQUIRE(print.seam_visibility_cache()->reused_candidate_layers() == 0);
+        REQUIRE(print.seam_visibility_cache()->calculated_candidate_layers() == print.objects().front()->layer_count());
+        WHEN("the G-code is exported again") {
+            Slic3r::Test::gcode(print);
+            THEN("the object is not raycasted again") {
+                REQUIRE(print.seam_visibility_cache()->hits() == 1);
+                REQUIRE(print.seam_visibility_cache()->misses() == 1);
+            }
+            THEN("the visibility, overhangs and embedding of the seam candidates are reused") {
+                REQUIRE(print.seam_visibility_cache()->reused_candidate_layers() == print.objects().front()->layer_count());
+                REQUIRE(print.seam_visibility_cache()->calculated_candidate_layers() == print.objects().front()->layer_count());
+            }
+        }
+    }
+}
@@ -1,12 +1,21 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/ModelArrange.hpp"
+#include "libslic3r/GCodeWriter.hpp"
+#include "libslic3r/GCode/FanMover.hpp"
+#include "libslic3r/GCode/GCodeLayerLines.hpp"
 
 #include "test_data.hpp"
 
 #include <algorithm>
+#include <sstream>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/regex.hpp>
+#include <tbb/task_arena.h>
 
 using namespace Slic3r;
 using namespace Slic3r::Test;
@@ -269,3 +278,269 @@ SCENARIO( "PrintGCode basic functionality", "[PrintGCode]") {
         }
     }
 }
+
+// G-code without the header line, which contains the time of export.
+static std::string gcode_without_timestamp(const std::string &gcode)
+{
+    std::istringstream in(gcode);
+    std::string        out;
+    for (std::string line; std::getline(in, line);)
+        if (! boost::starts_with(line, "; generated by "))
+            out += line + '\n';
+    return out;
+}
+
+TEST_CASE("PrintGCode: cached Arachne walls do not depend on the number of threads", "[PrintGCode]") {
+    // The layers of the prisms share the cached wall toolpaths, whichever layer is generated first.
+    auto slice = []() {
+        return gcode_without_timestamp(Slic3r::Test::slice({ TestMesh::two_hollow_squares, TestMesh::cube_with_hole, TestMesh::gt2_teeth }, {
+            { "wall_generator",     "arachne" },
+            { "layer_height",       0.2 },
+            { "first_layer_height", 0.2 }
+            }));
+    };
+    std::string gcode_serial;
+    tbb::task_arena(1).execute([&slice, &gcode_serial]() { gcode_serial = slice(); });
+    std::string gcode_parallel = slice();
+    REQUIRE(! gcode_serial.empty());
+    REQUIRE(gcode_serial == gcode_parallel);
+}
+
+TEST_CASE("PrintGCode: avoiding crossing walls of multiple instances does not depend on the number of threads", "[PrintGCode]") {
+    // The layer data of AvoidCrossingPerimeters is prepared in parallel, the external boundaries are calculated on the first travel
+    // between the instances and the travels inside of an instance are reused by the other instances.
+    auto slice = []() {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "reduce_crossing_wall", true },
+            { "layer_height",         0.2 },
+            { "first_layer_height",   0.2 }
+            });
+        Model model;
+        Print print;
+        Slic3r::Test::init_print({ TestMesh::cube_with_hole, TestMesh::two_hollow_squares }, print, model, config);
+        for (ModelObject *object : model.objects)
+            object->add_instance();
+        arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(min_object_distance(config)) });
+        print.apply(model, config);
+        print.process();
+        std::string first  = gcode_without_timestamp(Slic3r::Test::gcode(print));
+        // Exporting again starts from scratch.
+        std::string second = gcode_without_timestamp(Slic3r::Test::gcode(print));
+        REQUIRE(first == second);
+        return first;
+    };
+    std::string gcode_serial;
+    tbb::task_arena(1).execute([&slice, &gcode_serial]() { gcode_serial = slice(); });
+    std::string gcode_parallel = slice();
+    REQUIRE(! gcode_serial.empty());
+    REQUIRE(gcode_serial == gcode_parallel);
+}
+
+TEST_CASE("PrintGCode: the travels between the objects avoid the holes of their own layer", "[PrintGCode]") {
+    // The layer data of AvoidCrossingPerimeters is prepared for a batch of layers. The hole of the frame starts above the solid
+    // base within the first batch, thus the travels between the cubes on both sides of the frame pass over the base below
+    // and go around the hole above.
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "reduce_crossing_wall", true },
+        { "layer_height",         0.2 },
+        { "first_layer_height",   0.2 },
+        { "z_hop",                0 },
+        { "wipe",                 0 },
+        { "skirt_loops",          0 }
+        });
+    TriangleMesh frame = make_cube(20., 20., 2.);
+    TriangleMesh ring  = Slic3r::Test::mesh(TestMesh::cube_with_hole);
+    ring.translate(0.f, 0.f, 2.f);
+    frame.merge(ring);
+    Model model;
+    Print print;
+    Slic3r::Test::init_print({ frame, make_cube(5., 5., 12.), make_cube(5., 5., 12.) }, print, model, config);
+    model.objects[0]->instances.front()->set_offset(Vec3d(100., 100., model.objects[0]->instances.front()->get_offset(Z)));
+    model.objects[1]->instances.front()->set_offset(Vec3d(80., 100., model.objects[1]->instances.front()->get_offset(Z)));
+    model.objects[2]->instances.front()->set_offset(Vec3d(120., 100., model.objects[2]->instances.front()->get_offset(Z)));
+    print.apply(model, config);
+    print.process();
+
+    const PrintObject &frame_object = *print.objects().front();
+    const Point       &frame_shift  = frame_object.instances().front().shift;
+    size_t num_travels_with_hole = 0;
+    size_t num_crossings        = 0;
+    GCodeReader parser;
+    parser.parse_buffer(Slic3r::Test::gcode(print), [&](Slic3r::GCodeReader &self, const Slic3r::GCodeReader::GCodeLine &line) {
+        if (! line.cmd_is("G1") || line.has(E) || ! (line.has(X) || line.has(Y)))
+            return;
+        const Layer *layer = frame_object.get_layer_at_printz(self.z(), EPSILON);
+        if (layer == nullptr)
+            return;
+        Polygons holes;
+        for (const ExPolygon &island : layer->lslices)
+            for (Polygon hole : island.holes) {
+                hole.make_counter_clockwise();
+                hole.translate(frame_shift);
+                holes.emplace_back(std::move(hole));
+            }
+        if (holes.empty())
+            return;
+        ++ num_travels_with_hole;
+        const Polyline travel { Point::new_scale(self.x(), self.y()), Point::new_scale(line.new_X(self), line.new_Y(self)) };
+        if (! intersection_pl(travel, shrink(holes, float(scale_(0.5)))).empty())
+            ++ num_crossings;
+    });
+    REQUIRE(num_travels_with_hole > 0);
+    REQUIRE(num_crossings == 0);
+}
+
+TEST_CASE("PrintGCode: flushing into infill does not depend on the number of threads", "[PrintGCode]") {
+    // The extrusions of the layers are grouped by extruders in parallel, the infill overridden for flushing shall be
+    // printed by the same extruders as with a single thread.
+    auto slice_moves = []() {
+        std::string gcode = Slic3r::Test::slice({ TestMesh::cube_20x20x20, TestMesh::cube_20x20x20 }, {
+            { "filament_diameter",      "1.75,1.75" },
+            { "nozzle_diameter",        "0.4,0.4" },
+            { "filament_colour",        "#FF0000,#00FF00" },
+            { "wall_filament",          1 },
+            { "sparse_infill_filament", 2 },
+            { "sparse_infill_density",  "20%" },
+            { "enable_prime_tower",     true },
+            { "flush_into_infill",      true },
+            { "layer_height",           0.2 },
+            { "first_layer_height",     0.2 }
+            });
+        // Drop the comments, which contain the time of export.
+        std::istringstream in(gcode);
+        std::string        moves;
+        for (std::string line; std::getline(in, line);)
+            if (! line.empty() && line.front() != ';')
+                moves += line + '\n';
+        return moves;
+    };
+    std::string moves_serial;
+    tbb::task_arena(1).execute([&slice_moves, &moves_serial]() { moves_serial = slice_moves(); });
+    std::string moves_parallel = slice_moves();
+    REQUIRE(! moves_serial.empty());
+    REQUIRE(moves_serial == moves_parallel);
+}
+
+TEST_CASE("PrintGCode: the overhang speeds do not depend on the number of threads", "[PrintGCode]") {
+    // The overhang boundaries of the next layers are built in parallel ahead of the serial G-code generator,
+    // which slows down the overhangs by the boundaries of the previous layer.
+    auto slice = []() {
+        return gcode_without_timestamp(Slic3r::Test::slice({ TestMesh::overhang, TestMesh::step }, {
+            { "enable_overhang_speed", true },
+            { "layer_height",          0.2 },
+            { "first_layer_height",    0.2 }
+            }));
+    };
+    std::string gcode_serial;
+    tbb::task_arena(1).execute([&slice, &gcode_serial]() { gcode_serial = slice(); });
+    std::string gcode_parallel = slice();
+    REQUIRE(! gcode_serial.empty());
+    REQUIRE(gcode_serial == gcode_parallel);
+}
+
+TEST_CASE("PrintGCode: the post filters passing the parsed lines along match the filters run on the text", "[PrintGCode]") {
+    // Cooling with slow down, adaptive pressure advance and the fan mover are all enabled.
+    auto slice = []() {
+        return gcode_without_timestamp(Slic3r::Test::slice({ TestMesh::cube_20x20x20, TestMesh::pyramid }, {
+            { "slow_down_for_layer_cooling",     "1" },
+            { "slow_down_layer_time",            "30" },
+            { "fan_min_speed",                   "20" },
+            { "fan_max_speed",                   "100" },
+            { "fan_cooling_layer_time",          "60" },
+            { "close_fan_the_first_x_layers",    "1" },
+            { "enable_pressure_advance",         "1" },
+            { "pressure_advance",                "0.04" },
+            { "adaptive_pressure_advance",       "1" },
+            { "adaptive_pressure_advance_model", "\"0.04,3.96,3000\\n0.033,3.96,10000\\n0.029,7.91,3000\\n0.026,7.91,10000\"" },
+            { "fan_speedup_time",                "0.5" },
+            { "fan_kickstart",                   "0.2" },
+            { "layer_height",                    0.2 },
+            { "first_layer_height",              0.2 }
+            }));
+    };
+    std::string gcode_serial;
+    tbb::task_arena(1).execute([&slice, &gcode_serial]() { gcode_serial = slice(); });
+    const std::string gcode = slice();
+    REQUIRE(boost::contains(gcode, "M106"));
+    REQUIRE(gcode == gcode_serial);
+
+    // Split the G-code into layers.
+    std::vector<std::string> layers(1);
+    {
+        std::istringstream in(gcode);
+        for (std::string line; std::getline(in, line);) {
+            if (boost::starts_with(line, ";LAYER_CHANGE"))
+                layers.emplace_back();
+            layers.back() += line + '\n';
+        }
+    }
+    REQUIRE(layers.size() > 10);
+
+    // The parsed data carried along with the lines equals the data parsed from the text, thus a filter reading them
+    // sees the same G-code as a filter parsing the text.
+    auto same_as_parsed = [](const GCodeLayerLines &lines) {
+        GCodeLayerLines parsed{ std::string(lines.text()) };
+        if (parsed.size() != lines.size())
+            return false;
+        for (size_t i = 0; i < lines.size(); ++ i) {
+            const GCodeLayerLines::Line &l = lines[i];
+            const GCodeLayerLines::Line &p = parsed[i];
+            if (l.begin != p.begin || l.end != p.end || l.command != p.command || l.canonical != p.canonical || l.axis_mask != p.axis_mask)
+                return false;
+            for (int axis = 0; axis < GCodeLayerLines::NumAxes; ++ axis)
+                if (l.has(GCodeLayerLines::Axis(axis)) && l.value(GCodeLayerLines::Axis(axis)) != p.value(GCodeLayerLines::Axis(axis)))
+                    return false;
+        }
+        return true;
+    };
+
+    // The fan mover fed with the parsed lines of the layers writes the same G-code as the fan mover fed with the text.
+    GCodeWriter writer;
+    FanMover    fan_mover_text(writer, 0.5f, true, writer.config.use_relative_e_distances.value, false, 0.2f);
+    FanMover    fan_mover_lines(writer, 0.5f, true, writer.config.use_relative_e_distances.value, false, 0.2f);
+    bool        same_text   = true;
+    bool        same_parsed = true;
+    for (const std::string &layer : layers) {
+        const std::string     out_text  = fan_mover_text.process_gcode(layer, true);
+        const GCodeLayerLines out_lines = fan_mover_lines.process_layer(GCodeLayerLines(std::string(layer)), true);
+        same_text   = same_text && out_lines.text() == out_text;
+        same_parsed = same_parsed && same_as_parsed(out_lines);
+    }
+    REQUIRE(same_text);
+    REQUIRE(same_parsed);
+}
+
+TEST_CASE("PrintGCode: the M73 lines and the time estimates are patched in place", "[PrintGCode]") {
+    // Nothing is inserted into the G-code, the M73 lines, the time estimates and the filament statistics are written
+    // into the lines reserved for them. Compared without the M73 lines and the padding of the reserved lines.
+    std::vector<int> progress;
+    auto slice = [&progress](bool disable_m73) {
+        std::istringstream in(Slic3r::Test::slice({ TestMesh::cube_20x20x20 }, {
+            { "disable_m73",        disable_m73 },
+            { "layer_height",       0.2 },
+            { "first_layer_height", 0.2 }
+            }));
+        std::string out;
+        for (std::string line; std::getline(in, line);) {
+            line = line.substr(0, line.find_last_not_of(' ') + 1);
+            if (boost::starts_with(line, "M73 P"))
+                progress.emplace_back(std::stoi(line.substr(5)));
+            else if (! boost::starts_with(line, "; generated by ") && ! boost::starts_with(line, "M73 ") && line != ";")
+                out += line + '\n';
+        }
+        return out;
+    };
+    const std::string gcode_without_m73 = slice(true);
+    REQUIRE(progress.empty());
+    const std::string gcode_with_m73    = slice(false);
+    REQUIRE(boost::contains(gcode_without_m73, "; estimated printing time (normal mode) = "));
+    REQUIRE(! boost::contains(gcode_with_m73, "_GP_"));
+    REQUIRE(gcode_without_m73 == gcode_with_m73);
+    // The progress is reported in between the first and the last M73 line.
+    REQUIRE(progress.size() > 2);
+    REQUIRE(progress.front() == 0);
+    REQUIRE(progress.back() == 100);
+    REQUIRE(std::is_sorted(progress.begin(), progress.end()));
+}
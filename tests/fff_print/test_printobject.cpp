@@ -3,6 +3,8 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/MultiMaterialSegmentation.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 
 #include "test_data.hpp"
 
@@ -87,3 +89,230 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+// Paints the triangles of the volume between min_z and max_z (in the coordinates of the volume) with the second filament.
+static void paint_band(ModelVolume &volume, float min_z, float max_z)
+{
+    TriangleSelector selector(volume.mesh());
+    selector.deserialize(volume.mmu_segmentation_facets.get_data());
+    const indexed_triangle_set &its = volume.mesh().its;
+    for (int facet_idx = 0; facet_idx < int(its.indices.size()); ++ facet_idx) {
+        bool inside = true;
+        for (int i = 0; i < 3; ++ i)
+            if (const float z = its.vertices[its.indices[facet_idx](i)].z(); z < min_z || z > max_z)
+                inside = false;
+        if (inside)
+            selector.set_facet(facet_idx, EnforcerBlockerType::Extruder2);
+    }
+    volume.mmu_segmentation_facets.set(selector);
+}
+
+TEST_CASE("PrintObject: repainting re-segments only the repainted layers", "[PrintObject]") {
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "layer_height",       0.2 },
+        { "first_layer_height", 0.2 },
+        { "filament_diameter",  "1.75,1.75" },
+        { "filament_colour",    "#FF0000,#00FF00" },
+        { "enable_prime_tower", false }
+    });
+
+    Model model;
+    Print print;
+    init_print({ make_sphere(10., 2. * PI / 60.) }, print, model, config);
+    ModelVolume &volume = *model.objects.front()->volumes.front();
+    paint_band(volume, -10.f, -6.f);
+    print.apply(model, config);
+    print.process();
+    REQUIRE(print.segmentation_cache() != nullptr);
+    REQUIRE(print.segmentation_cache()->layers_reused() == 0);
+
+    paint_band(volume, 6.f, 10.f);
+    print.apply(model, config);
+    print.process();
+    const size_t num_layers = print.objects().front()->layer_count();
+    THEN("the layers not crossed by the repainted triangles are reused") {
+        REQUIRE(print.segmentation_cache()->layers_reused() > num_layers / 2);
+    }
+    THEN("only the layers within the shell reach of the repainted layers are merged with the top and bottom layers again") {
+        REQUIRE(print.segmentation_cache()->layers_merged() < 2 * num_layers);
+    }
+    THEN("the regions match a segmentation from scratch") {
+        Print print_from_scratch;
+        print_from_scratch.apply(model, config);
+        print_from_scratch.set_status_silent();
+        print_from_scratch.process();
+        const PrintObject &object1 = *print.objects().front();
+        const PrintObject &object2 = *print_from_scratch.objects().front();
+        REQUIRE(object1.layer_count() == object2.layer_count());
+        for (size_t layer_idx = 0; layer_idx < object1.layer_count(); ++ layer_idx) {
+            const Layer &layer1 = *object1.get_layer(int(layer_idx));
+            const Layer &layer2 = *object2.get_layer(int(layer_idx));
+            REQUIRE(layer1.region_count() == layer2.region_count());
+            for (int region_idx = 0; region_idx < layer1.region_count(); ++ region_idx)
+                REQUIRE(area(to_polygons(layer1.get_region(region_idx)->slices.surfaces)) ==
+                        Approx(area(to_polygons(layer2.get_region(region_idx)->slices.surfaces))).epsilon(1e-3).margin(scaled<double>(0.01) * scaled<double>(0.01)));
+        }
+    }
+}
+
+static Points extrusion_points(const ExtrusionEntityCollection &collection)
+{
+    Points pts;
+    for (const ExtrusionEntity *entity : collection.flatten().entities)
+        entity->collect_points(pts);
+    return pts;
+}
+
+TEST_CASE("PrintObject: changing a layer range modifier matches a print from scratch", "[PrintObject]") {
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "layer_height",         0.2 },
+        { "first_layer_height",   0.2 },
+        { "enable_arc_fitting",   true },
+        { "enable_overhang_speed", true }
+    });
+
+    Model model;
+    Print print;
+    init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+    ModelConfig &range_config = model.objects.front()->layer_config_ranges[{ 6., 10. }];
+    range_config.set("layer_height", 0.2);
+    range_config.set("wall_loops", 2);
+    print.apply(model, config);
+    print.process();
+
+    // The layers far enough above the modifier keep their walls and infill in place.
+    auto far_layer = [](const Layer &layer) { return layer.slice_z > 17.; };
+    std::vector<const ExtrusionEntity*> far_entities;
+    for (const Layer *layer : print.objects().front()->layers())
+        if (far_layer(*layer))
+            for (const LayerRegion *layerm : layer->regions()) {
+                REQUIRE(! layerm->perimeters.empty());
+                REQUIRE(! layerm->fills.empty());
+                far_entities.emplace_back(layerm->perimeters.entities.front());
+                far_entities.emplace_back(layerm->fills.entities.front());
+            }
+    REQUIRE(! far_entities.empty());
+
+    range_config.set("wall_loops", 4);
+    print.apply(model, config);
+    print.process();
+
+    Print print_from_scratch;
+    print_from_scratch.apply(model, config);
+    print_from_scratch.set_status_silent();
+    print_from_scratch.process();
+
+    const PrintObject &object1 = *print.objects().front();
+    const PrintObject &object2 = *print_from_scratch.objects().front();
+    REQUIRE(object1.layer_count() == object2.layer_count());
+    size_t far_entity_idx = 0;
+    for (size_t layer_idx = 0; layer_idx < object1.layer_count(); ++ layer_idx) {
+        const Layer &layer1 = *object1.get_layer(int(layer_idx));
+        const Layer &layer2 = *object2.get_layer(int(layer_idx));
+        REQUIRE(layer1.region_count() == layer2.region_count());
+        REQUIRE(layer1.curled_lines.size() == layer2.curled_lines.size());
+        for (int region_idx = 0; region_idx < layer1.region_count(); ++ region_idx) {
+            const LayerRegion &layerm1 = *layer1.get_region(region_idx);
+            const LayerRegion &layerm2 = *layer2.get_region(region_idx);
+            REQUIRE(extrusion_points(layerm1.perimeters) == extrusion_points(layerm2.perimeters));
+            REQUIRE(extrusion_points(layerm1.fills) == extrusion_points(layerm2.fills));
+            if (far_layer(layer1)) {
+                REQUIRE(layerm1.perimeters.entities.front() == far_entities[far_entity_idx ++]);
+                REQUIRE(layerm1.fills.entities.front() == far_entities[far_entity_idx ++]);
+            }
+        }
+    }
+    REQUIRE(far_entity_idx == far_entities.size());
+}
+
+TEST_CASE("PrintObject: changing a layer range modifier next to a bridge, a step or a bridge over infill matches a print from scratch", "[PrintObject]") {
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    // Thin shells, so that the layers getting new infill regions do not cover the whole object.
+    config.set_deserialize_strict({
+        { "layer_height",              0.2 },
+        { "first_layer_height",        0.2 },
+        { "top_shell_layers",          2 },
+        { "bottom_shell_layers",       2 },
+        { "top_shell_thickness",       0 },
+        { "bottom_shell_thickness",    0 },
+        { "enable_extra_bridge_layer", "apply_to_all" }
+    });
+
+    // The print from scratch has to contain the surfaces of surface_type to be reprocessed. An empty layer_height_profile
+    // keeps the layer heights of the layer ranges.
+    auto check = [&config](TestMesh mesh, t_layer_height_range range, SurfaceType surface_type, std::vector<coordf_t> layer_height_profile = {}) {
+        Model model;
+        Print print;
+        init_print({ mesh }, print, model, config);
+        model.objects.front()->layer_height_profile.set(std::move(layer_height_profile));
+        ModelConfig &range_config = model.objects.front()->layer_config_ranges[range];
+        range_config.set("layer_height", 0.2);
+        range_config.set("wall_loops", 2);
+        print.apply(model, config);
+        print.process();
+
+        // The layers far enough below the modifier keep their infill in place.
+        auto far_layer = [](const Layer &layer) { return layer.slice_z < 1.; };
+        std::vector<const ExtrusionEntity*> far_entities;
+        for (const Layer *layer : print.objects().front()->layers())
+            if (far_layer(*layer))
+                for (const LayerRegion *layerm : layer->regions()) {
+                    REQUIRE(! layerm->fills.empty());
+                    far_entities.emplace_back(layerm->fills.entities.front());
+                }
+        REQUIRE(! far_entities.empty());
+
+        range_config.set("wall_loops", 3);
+        print.apply(model, config);
+        print.process();
+
+        Print print_from_scratch;
+        print_from_scratch.apply(model, config);
+        print_from_scratch.set_status_silent();
+        print_from_scratch.process();
+
+        const PrintObject &object1 = *print.objects().front();
+        const PrintObject &object2 = *print_from_scratch.objects().front();
+        REQUIRE(object1.layer_count() == object2.layer_count());
+        size_t far_entity_idx = 0;
+        bool   has_surface_type = false;
+        for (size_t layer_idx = 0; layer_idx < object1.layer_count(); ++ layer_idx) {
+            const Layer &layer1 = *object1.get_layer(int(layer_idx));
+            const Layer &layer2 = *object2.get_layer(int(layer_idx));
+            REQUIRE(layer1.slice_z == layer2.slice_z);
+            REQUIRE(layer1.region_count() == layer2.region_count());
+            for (int region_idx = 0; region_idx < layer1.region_count(); ++ region_idx) {
+                const LayerRegion &layerm1 = *layer1.get_region(region_idx);
+                const LayerRegion &layerm2 = *layer2.get_region(region_idx);
+                for (SurfaceType type : { stTop, stBottom, stBottomBridge, stInternal, stInternalSolid, stInternalBridge })
+                    REQUIRE(area(to_polygons(layerm1.fill_surfaces.filter_by_type(type))) ==
+                            Approx(area(to_polygons(layerm2.fill_surfaces.filter_by_type(type)))));
+                REQUIRE(extrusion_points(layerm1.perimeters) == extrusion_points(layerm2.perimeters));
+                REQUIRE(extrusion_points(layerm1.fills) == extrusion_points(layerm2.fills));
+                if (far_layer(layer1))
+                    REQUIRE(layerm1.fills.entities.front() == far_entities[far_entity_idx ++]);
+                has_surface_type |= layerm2.fill_surfaces.has(surface_type);
+            }
+        }
+        REQUIRE(far_entity_idx == far_entities.size());
+        REQUIRE(has_surface_type);
+    };
+
+    SECTION("modifier above the bridge") {
+        check(TestMesh::bridge, { 6.6, 7.4 }, stBottomBridge);
+    }
+    SECTION("modifier at the step") {
+        check(TestMesh::step, { 4.4, 5.6 }, stTop);
+    }
+    SECTION("modifier below the sparse infill bridged under the top shells") {
+        // The first of the two top shell layers at 19.6 mm is bridged over the sparse infill by bridge_over_infill().
+        check(TestMesh::cube_20x20x20, { 17.6, 18.4 }, stInternalBridge);
+    }
+    SECTION("modifier over variable layer height") {
+        // The layers get from 0.2 mm down to 0.1 mm thin around the modifier and 0.3 mm thick towards the top,
+        // thus the thin layers stretch the reach of the shells and of the bridges in layers.
+        check(TestMesh::cube_20x20x20, { 8.6, 9.4 }, stInternalBridge, { 0., 0.2, 6., 0.1, 12., 0.1, 16., 0.3, 20., 0.3 });
+    }
+}
@@ -0,0 +1,195 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/SliceCache.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+namespace fs = boost::filesystem;
+
+static std::vector<fs::path> cache_entries(const fs::path &directory, const std::string &extension)
+{
+    std::vector<fs::path> out;
+    for (fs::directory_iterator it(directory), end; it != end; ++ it)
+        if (it->path().extension() == extension)
+            out.emplace_back(it->path());
+    return out;
+}
+
+static void write_file(const fs::path &path, const std::string &data)
+{
+    boost::nowide::ofstream f(path.string(), std::ios::out | std::ios::trunc | std::ios::binary);
+    f << data;
+}
+
+static size_t count_perimeters(const PrintObject &object)
+{
+    size_t cnt = 0;
+    for (const Layer *layer : object.layers())
+        for (const LayerRegion *layerm : layer->regions())
+            cnt += layerm->perimeters.items_count();
+    return cnt;
+}
+
+static size_t count_curled_lines(const PrintObject &object)
+{
+    size_t cnt = 0;
+    for (const Layer *layer : object.layers())
+        cnt += layer->curled_lines.size();
+    return cnt;
+}
+
+SCENARIO("SliceCache: PrintObject results are cached on disk", "[SliceCache]") {
+    fs::path directory = fs::temp_directory_path() / fs::unique_path("slice_cache_%%%%-%%%%");
+    auto     cache     = std::make_shared<SliceCache>(directory.string(), 1024 * 1024 * 1024);
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+
+    auto process = [&config, &cache](Print &print, Model &model) {
+        init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        print.set_slice_cache(cache);
+        print.process();
+        // The entries of the cache misses are written in the background.
+        cache->wait_for_background_stores();
+    };
+
+    GIVEN("an empty cache") {
+        Model model;
+        Print print;
+        process(print, model);
+        THEN("the object is a miss and it is stored") {
+            REQUIRE(cache->hits() == 0);
+            REQUIRE(cache->misses() == 1);
+            REQUIRE(cache_entries(directory, ".json").size() == 1);
+            REQUIRE(cache_entries(directory, ".tmp").empty());
+        }
+        WHEN("the same object is processed again") {
+            Model model2;
+            Print print2;
+            process(print2, model2);
+            THEN("it is a hit and the results match") {
+                REQUIRE(cache->hits() == 1);
+                const PrintObject &object1 = *print.objects().front();
+                const PrintObject &object2 = *print2.objects().front();
+                REQUIRE(object1.layer_count() == object2.layer_count());
+                REQUIRE(count_perimeters(object1) == count_perimeters(object2));
+                REQUIRE(count_curled_lines(object1) == count_curled_lines(object2));
+                REQUIRE(Slic3r::Test::gcode(print) == Slic3r::Test::gcode(print2));
+            }
+        }
+        WHEN("the walls of an object loaded from the cache are invalidated") {
+            Model model2;
+            Print print2;
+            process(print2, model2);
+            REQUIRE(cache->hits() == 1);
+            DynamicPrintConfig config2 = config;
+            config2.set_deserialize_strict({ { "wall_loops", 4 } });
+            print2.apply(model2, config2);
+            REQUIRE(print2.objects().front()->is_step_done(posSlice));
+            print2.process();
+            THEN("the walls and the infill match a print from scratch") {
+                Model model3;
+                Print print3;
+                init_print({ TestMesh::cube_20x20x20 }, print3, model3, config2);
+                print3.process();
+                const PrintObject &object2 = *print2.objects().front();
+                const PrintObject &object3 = *print3.objects().front();
+                REQUIRE(object2.layer_count() == object3.layer_count());
+                REQUIRE(count_perimeters(object2) == count_perimeters(object3));
+                REQUIRE(Slic3r::Test::gcode(print2) == Slic3r::Test::gcode(print3));
+            }
+        }
+        WHEN("the entry is corrupted") {
+            write_file(cache_entries(directory, ".json").front(), "{ \"corrupted\": ");
+            Model model2;
+            Print print2;
+            process(print2, model2);
+            THEN("the object is sliced from scratch and the entry is replaced") {
+                REQUIRE(cache->hits() == 0);
+                REQUIRE(cache->misses() == 2);
+                const PrintObject &object1 = *print.objects().front();
+                const PrintObject &object2 = *print2.objects().front();
+                REQUIRE(object1.layer_count() == object2.layer_count());
+                REQUIRE(count_perimeters(object1) == count_perimeters(object2));
+                std::vector<fs::path> entries = cache_entries(directory, ".json");
+                REQUIRE(entries.size() == 1);
+                REQUIRE(fs::file_size(entries.front()) > 100);
+            }
+        }
+    }
+    fs::remove_all(directory);
+}
+
+TEST_CASE("SliceCache: the key only depends on the options of the cached steps", "[SliceCache]") {
+    auto key = [](std::initializer_list<ConfigBase::SetDeserializeItem> items) {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict(items);
+        Model model;
+        Print print;
+        init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        return SliceCache::print_object_key(*print.objects().front());
+    };
+    const std::string base = key({});
+    SECTION("speeds, temperatures and G-code templates are not hashed") {
+        REQUIRE(key({ { "outer_wall_speed", 33 }, { "sparse_infill_speed", 77 }, { "travel_speed", 123 } }) == base);
+        REQUIRE(key({ { "nozzle_temperature", 233 }, { "machine_start_gcode", "G28 ; test" } }) == base);
+    }
+    SECTION("the options of the cached steps are hashed") {
+        REQUIRE(key({ { "wall_loops", 4 } }) != base);
+        REQUIRE(key({ { "layer_height", 0.3 } }) != base);
+        REQUIRE(key({ { "nozzle_diameter", "0.6" } }) != base);
+        REQUIRE(key({ { "filament_type", "PETG" } }) != base);
+    }
+    SECTION("the print options invalidating all the steps are hashed") {
+        REQUIRE(key({ { "spiral_mode_smooth", true } }) != base);
+    }
+    SECTION("the filament diameters are hashed") {
+        REQUIRE(key({ { "filament_diameter", "1.75,1.75" } }) != base);
+        REQUIRE(key({ { "filament_diameter", "2.85" } }) != base);
+    }
+}
+
+TEST_CASE("SliceCache: least recently used entries are evicted", "[SliceCache]") {
+    fs::path   directory = fs::temp_directory_path() / fs::unique_path("slice_cache_%%%%-%%%%");
+    SliceCache cache(directory.string(), 25);
+
+    const std::time_t now = std::time(nullptr);
+    auto add = [&cache, &directory](const std::string &key, std::time_t time) {
+        std::string temp_path = cache.temp_entry_path(key);
+        write_file(temp_path, std::string(10, 'x'));
+        REQUIRE(cache.store(key, temp_path));
+        fs::last_write_time(directory / (key + ".json"), time);
+    };
+    add("a", now - 300);
+    add("b", now - 200);
+    // Mark "a" as the most recently used one.
+    REQUIRE(! cache.lookup("a").empty());
+    add("c", now - 100);
+
+    REQUIRE(fs::exists(directory / "a.json"));
+    REQUIRE(! fs::exists(directory / "b.json"));
+    REQUIRE(fs::exists(directory / "c.json"));
+    REQUIRE(cache.lookup("b").empty());
+
+    SECTION("temp entries of the same key do not collide") {
+        REQUIRE(cache.temp_entry_path("d") != cache.temp_entry_path("d"));
+    }
+    SECTION("stale temp entries are removed") {
+        fs::path stale = directory / "e.json.1-1.tmp";
+        fs::path fresh = directory / "e.json.1-2.tmp";
+        write_file(stale, "x");
+        write_file(fresh, "x");
+        fs::last_write_time(stale, now - 2 * 24 * 60 * 60);
+        add("f", now);
+        REQUIRE(! fs::exists(stale));
+        REQUIRE(fs::exists(fresh));
+    }
+    fs::remove_all(directory);
+}
@@ -1,7 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <sstream>
+
+#include <tbb/task_arena.h>
+
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/TreeModelVolumes.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -119,6 +124,106 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+TEST_CASE("SupportMaterial: organic tree supports do not depend on the number of threads", "[SupportMaterial]")
+{
+    auto slice_moves = []() {
+        std::string gcode = Slic3r::Test::slice({ TestMesh::overhang }, {
+            { "enable_support",      1 },
+            { "support_type",        "tree(auto)" },
+            { "support_style",       "organic" },
+            { "layer_height",        0.1 },
+            { "initial_layer_print_height", 0.1 }
+            });
+        // Drop the comments, which contain the time of export.
+        std::istringstream in(gcode);
+        std::string        moves;
+        for (std::string line; std::getline(in, line);)
+            if (! line.empty() && line.front() != ';')
+                moves += line + '\n';
+        return moves;
+    };
+    std::string moves_serial;
+    tbb::task_arena(1).execute([&slice_moves, &moves_serial]() { moves_serial = slice_moves(); });
+    std::string moves_parallel = slice_moves();
+    REQUIRE(! moves_serial.empty());
+    REQUIRE(moves_serial == moves_parallel);
+}
+
+TEST_CASE("SupportMaterial: tree support cache compression round trips the polygons", "[SupportMaterial]")
+{
+    using namespace Slic3r::TreeSupport3D;
+    const coord_t big = coord_t(1) << 30;
+    Polygons polygons {
+        Polygon { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } },
+        Polygon {},
+        Polygon { { -big, -big }, { big, -big }, { big, big }, { -big, big }, { -1, 0 }, { 0, -1 } },
+        Polygon { { 63, -64 }, { -64, 63 }, { 8191, -8192 } }
+    };
+    REQUIRE(decompress_polygons(compress_polygons(polygons)) == polygons);
+    REQUIRE(decompress_polygons(compress_polygons(Polygons())).empty());
+    // Small deltas take a byte per coordinate.
+    Polygons small { Polygon { { 1, 1 }, { 2, 1 }, { 2, 2 } } };
+    REQUIRE(compress_polygons(small).size() == 2 + 3 * 2);
+}
+
+namespace Slic3r::TreeSupport3D {
+// Gives the tests access to the private caches of TreeModelVolumes.
+struct TreeModelVolumesTest {
+    using CacheStats              = TreeModelVolumes::CacheStats;
+    using RadiusLayerPolygonCache = TreeModelVolumes::RadiusLayerPolygonCache;
+};
+} // namespace Slic3r::TreeSupport3D
+
+TEST_CASE("SupportMaterial: tree support cache releases the layers above", "[SupportMaterial]")
+{
+    using namespace Slic3r::TreeSupport3D;
+    const coord_t radius = 100;
+    auto layer_polygons  = [](LayerIndex layer_idx) { return Polygons { Polygon { { 0, 0 }, { 1000 + layer_idx, 0 }, { 0, 1000 } } }; };
+    auto fill            = [&layer_polygons](TreeModelVolumesTest::RadiusLayerPolygonCache &cache) {
+        std::vector<Polygons> layers;
+        for (LayerIndex layer_idx = 0; layer_idx < 10; ++ layer_idx)
+            layers.emplace_back(layer_polygons(layer_idx));
+        cache.insert(std::move(layers), 0, radius);
+    };
+
+    TreeModelVolumesTest::CacheStats              stats;
+    TreeModelVolumesTest::RadiusLayerPolygonCache cache;
+    cache.set_stats(&stats, true);
+
+    SECTION("below the memory limit") {
+        fill(cache);
+        REQUIRE(stats.compressed == 0);
+        REQUIRE(cache.getMaxCalculatedLayer(radius) == 9);
+        const size_t bytes = stats.bytes;
+        cache.release_layers_from(5);
+        REQUIRE(cache.getMaxCalculatedLayer(radius) == 4);
+        REQUIRE(! cache.getArea({ radius, 5 }));
+        REQUIRE(cache.getArea({ radius, 4 })->get() == layer_polygons(4));
+        REQUIRE(stats.bytes < bytes);
+        REQUIRE(stats.peak_bytes == bytes);
+        cache.release_layers_from(0);
+        REQUIRE(stats.bytes == 0);
+    }
+    SECTION("over the memory limit") {
+        stats.limit = 1;
+        fill(cache);
+        REQUIRE(stats.compressed == 9);
+        const size_t bytes = stats.bytes;
+        REQUIRE(cache.getArea({ radius, 7 })->get() == layer_polygons(7));
+        REQUIRE(stats.bytes > bytes);
+        // The inflated copy is dropped, the compressed one is kept.
+        cache.release_inflated();
+        REQUIRE(stats.bytes == bytes);
+        REQUIRE(cache.getArea({ radius, 7 })->get() == layer_polygons(7));
+        cache.release_layers_from(3);
+        REQUIRE(cache.getMaxCalculatedLayer(radius) == 2);
+        REQUIRE(cache.getArea({ radius, 2 })->get() == layer_polygons(2));
+        cache.release_inflated();
+        cache.release_layers_from(0);
+        REQUIRE(stats.bytes == 0);
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
@@ -177,6 +177,108 @@ SCENARIO( "TriangleMesh: slice behavior.") {
     }
 }
 
+SCENARIO( "TriangleMeshSlicer: batched CPU slicing backend.") {
+    auto compare_with_default = [](const indexed_triangle_set &its, const std::vector<float> &zs, const Transform3d &trafo) {
+        MeshSlicingParams params;
+        params.trafo = trafo;
+        std::vector<Polygons> expected = slice_mesh(its, zs, params);
+        set_gpu_slicing_callback(slice_mesh_cpu_batched);
+        std::vector<Polygons> batched = slice_mesh(its, zs, params);
+        set_gpu_slicing_callback(nullptr);
+        REQUIRE(batched.size() == expected.size());
+        for (size_t i = 0; i < zs.size(); ++ i) {
+            REQUIRE(batched[i].size() == expected[i].size());
+            REQUIRE(std::abs(area(batched[i]) - area(expected[i])) <= 1e-6 * std::abs(area(expected[i])) + 1.);
+        }
+    };
+    GIVEN( "A 20mm cube sliced at the planes of its facets") {
+        THEN( "the slices match the default CPU slicing") {
+            compare_with_default(its_make_cube(20., 20., 20.), { 0.f, 2.f, 4.f, 10.f, 19.9f, 20.f }, Transform3d::Identity());
+        }
+    }
+    GIVEN( "A finely tesselated sphere") {
+        indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 180.);
+        std::vector<float> zs;
+        for (float z = -10.f; z <= 10.f; z += 0.1f)
+            zs.emplace_back(z);
+        THEN( "the slices match the default CPU slicing") {
+            compare_with_default(sphere, zs, Transform3d::Identity());
+        }
+        THEN( "the slices of the transformed sphere match the default CPU slicing") {
+            compare_with_default(sphere, zs, Geometry::assemble_transform(Vec3d(1., 2., 3.), Vec3d(0.3, 0., 0.5)));
+        }
+    }
+}
+
+SCENARIO( "TriangleMeshSlicer: slicing with the mesh slicing index.") {
+    auto compare_with_index = [](const TriangleMesh &mesh, const std::vector<float> &zs, const Transform3d &trafo) {
+        MeshSlicingParams params;
+        params.trafo = trafo;
+        std::vector<Polygons> expected = slice_mesh(mesh.its, zs, params);
+        params.index = mesh.slicing_index();
+        std::vector<Polygons> indexed = slice_mesh(mesh.its, zs, params);
+        REQUIRE(indexed.size() == expected.size());
+        for (size_t i = 0; i < zs.size(); ++ i) {
+            REQUIRE(indexed[i].size() == expected[i].size());
+            REQUIRE(std::abs(area(indexed[i]) - area(expected[i])) <= 1e-6 * std::abs(area(expected[i])) + 1.);
+            // Single plane slicing.
+            Polygons single = slice_mesh(mesh.its, zs[i], params);
+            REQUIRE(single.size() == expected[i].size());
+            REQUIRE(std::abs(area(single) - area(expected[i])) <= 1e-6 * std::abs(area(expected[i])) + 1.);
+        }
+    };
+    GIVEN( "A finely tesselated sphere") {
+        TriangleMesh sphere = make_sphere(10., 2. * PI / 180.);
+        std::vector<float> zs;
+        for (float z = -10.f; z <= 10.f; z += 0.25f)
+            zs.emplace_back(z);
+        THEN( "the index is built once, moved with the mesh and not shared by the copies of the mesh") {
+            std::shared_ptr<const MeshSlicingIndex> index = sphere.slicing_index();
+            REQUIRE(index->faces.size() == sphere.its.indices.size());
+            REQUIRE(std::is_sorted(index->min_z.begin(), index->min_z.end()));
+            REQUIRE(sphere.slicing_index() == index);
+            TriangleMesh copy = sphere;
+            REQUIRE(copy.slicing_index() != index);
+            TriangleMesh moved = std::move(sphere);
+            REQUIRE(moved.slicing_index() == index);
+        }
+        THEN( "the index is dropped by modifying the mesh") {
+            TriangleMesh copy = sphere;
+            std::shared_ptr<const MeshSlicingIndex> index = copy.slicing_index();
+            copy.translate(0.f, 0.f, 1.f);
+            REQUIRE(copy.slicing_index() != index);
+            REQUIRE(copy.slicing_index()->min_z.front() == index->min_z.front() + 1.f);
+        }
+        THEN( "modifying a copy of the mesh in place does not make the index of the mesh stale") {
+            std::shared_ptr<const MeshSlicingIndex> index = sphere.slicing_index();
+            TriangleMesh copy = sphere;
+            for (Vec3f &v : copy.its.vertices)
+                v.z() += 5.f;
+            MeshSlicingParams params;
+            params.index = copy.slicing_index();
+            REQUIRE(params.index != index);
+            REQUIRE(params.index->min_z.front() == index->min_z.front() + 5.f);
+            std::vector<Polygons> indexed  = slice_mesh(copy.its, zs, params);
+            std::vector<Polygons> expected = slice_mesh(copy.its, zs, MeshSlicingParams());
+            REQUIRE(indexed.size() == expected.size());
+            for (size_t i = 0; i < zs.size(); ++ i)
+                REQUIRE(indexed[i].size() == expected[i].size());
+        }
+        THEN( "the slices match the slicing without the index") {
+            compare_with_index(sphere, zs, Transform3d::Identity());
+        }
+        THEN( "the slices of a subrange of the sphere match the slicing without the index") {
+            compare_with_index(sphere, std::vector<float>(zs.begin() + 30, zs.begin() + 40), Transform3d::Identity());
+        }
+        THEN( "the slices of the sphere rotated around Z, scaled and translated match the slicing without the index") {
+            compare_with_index(sphere, zs, Geometry::assemble_transform(Vec3d(1., 2., 3.), Vec3d(0., 0., 0.5), Vec3d(1.5, 1.5, 0.7)));
+        }
+        THEN( "the slices of the tilted sphere match the slicing without the index") {
+            compare_with_index(sphere, zs, Geometry::assemble_transform(Vec3d(1., 2., 3.), Vec3d(0.3, 0., 0.5)));
+        }
+    }
+}
+
 SCENARIO( "make_xxx functions produce meshes.") {
     GIVEN("make_cube() function") {
         WHEN("make_cube() is called with arguments 20,20,20") {
@@ -0,0 +1,149 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Arachne/WallToolPaths.hpp"
+
+using namespace Slic3r;
+
+static Arachne::WallToolPathsParams make_params()
+{
+    Arachne::WallToolPathsParams params;
+    params.min_bead_width                   = 0.34f;
+    params.min_feature_size                 = 0.1f;
+    params.min_length_factor                = 0.5f;
+    params.wall_transition_length           = 0.4f;
+    params.wall_transition_angle            = 10.f;
+    params.wall_transition_filter_deviation = 0.1f;
+    params.wall_distribution_count          = 1;
+    params.is_top_or_bottom_layer           = false;
+    return params;
+}
+
+static std::vector<Arachne::VariableWidthLines> translated(std::vector<Arachne::VariableWidthLines> toolpaths, const Point &shift)
+{
+    for (Arachne::VariableWidthLines &lines : toolpaths)
+        for (Arachne::ExtrusionLine &line : lines)
+            for (Arachne::ExtrusionJunction &junction : line.junctions)
+                junction.p += shift;
+    return toolpaths;
+}
+
+static bool equal(const std::vector<Arachne::VariableWidthLines> &lhs, const std::vector<Arachne::VariableWidthLines> &rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (size_t i = 0; i < lhs.size(); ++ i) {
+        if (lhs[i].size() != rhs[i].size())
+            return false;
+        for (size_t j = 0; j < lhs[i].size(); ++ j) {
+            const Arachne::ExtrusionLine &l = lhs[i][j];
+            const Arachne::ExtrusionLine &r = rhs[i][j];
+            if (l.inset_idx != r.inset_idx || l.is_odd != r.is_odd || l.is_closed != r.is_closed || l.junctions != r.junctions)
+                return false;
+        }
+    }
+    return true;
+}
+
+SCENARIO("Arachne toolpaths cache", "[Arachne]") {
+    GIVEN("Square with a hole and a translated copy of it") {
+        Polygon contour { { 0, 0 }, { scaled<coord_t>(10.), 0 }, { scaled<coord_t>(10.), scaled<coord_t>(10.) }, { 0, scaled<coord_t>(10.) } };
+        Polygon hole    { { scaled<coord_t>(3.), scaled<coord_t>(3.) }, { scaled<coord_t>(3.), scaled<coord_t>(7.) }, { scaled<coord_t>(7.), scaled<coord_t>(7.) }, { scaled<coord_t>(7.), scaled<coord_t>(3.) } };
+        Polygons outline { contour, hole };
+        const Point shift(scaled<coord_t>(23.), scaled<coord_t>(-17.));
+        Polygons outline_shifted = outline;
+        for (Polygon &polygon : outline_shifted)
+            polygon.translate(shift);
+
+        const coord_t                      width  = scaled<coord_t>(0.42);
+        const Arachne::WallToolPathsParams params = make_params();
+        Arachne::WallToolPathsCache        cache;
+
+        Arachne::WallToolPaths wall_tool_paths(outline, width, width, 3, 0, 0.2, params, &cache);
+        const std::vector<Arachne::VariableWidthLines> toolpaths     = wall_tool_paths.getToolPaths();
+        const Polygons                                 inner_contour = wall_tool_paths.getInnerContour();
+        WHEN("The translated outline is processed with the same parameters") {
+            Arachne::WallToolPaths wall_tool_paths_shifted(outline_shifted, width, width, 3, 0, 0.2, params, &cache);
+            const std::vector<Arachne::VariableWidthLines> &toolpaths_shifted = wall_tool_paths_shifted.getToolPaths();
+            THEN("The cache is hit") {
+                REQUIRE(! toolpaths.empty());
+                REQUIRE(cache.size() == 1);
+                REQUIRE(cache.hits() == 1);
+                REQUIRE(cache.misses() == 1);
+            }
+            THEN("The cached toolpaths are translated to the new position") {
+                REQUIRE(equal(toolpaths_shifted, translated(toolpaths, shift)));
+                Polygons inner_contour_expected = inner_contour;
+                for (Polygon &polygon : inner_contour_expected)
+                    polygon.translate(shift);
+                REQUIRE(wall_tool_paths_shifted.getInnerContour() == inner_contour_expected);
+            }
+        }
+        WHEN("The translated outline is processed with an empty cache") {
+            Arachne::WallToolPathsCache cache_empty;
+            Arachne::WallToolPaths      wall_tool_paths_miss(outline_shifted, width, width, 3, 0, 0.2, params, &cache_empty);
+            Arachne::WallToolPaths      wall_tool_paths_hit(outline_shifted, width, width, 3, 0, 0.2, params, &cache);
+            THEN("The cache miss produces the very same toolpaths as the cache hit") {
+                REQUIRE(equal(wall_tool_paths_miss.getToolPaths(), wall_tool_paths_hit.getToolPaths()));
+                REQUIRE(wall_tool_paths_miss.getInnerContour() == wall_tool_paths_hit.getInnerContour());
+                REQUIRE(cache_empty.misses() == 1);
+                REQUIRE(cache.hits() == 1);
+            }
+        }
+        WHEN("The cache is over its memory limit") {
+            Arachne::WallToolPathsCache cache_small(1);
+            Arachne::WallToolPaths      wall_tool_paths_2(outline, width, width, 2, 0, 0.2, params, &cache_small);
+            wall_tool_paths_2.getToolPaths();
+            Arachne::WallToolPaths      wall_tool_paths_3(outline, width, width, 3, 0, 0.2, params, &cache_small);
+            wall_tool_paths_3.getToolPaths();
+            THEN("Only the most recently used entry is kept") {
+                REQUIRE(cache_small.size() == 1);
+                REQUIRE(cache_small.memsize() > 0);
+                Arachne::WallToolPaths wall_tool_paths_3_again(outline_shifted, width, width, 3, 0, 0.2, params, &cache_small);
+                wall_tool_paths_3_again.getToolPaths();
+                Arachne::WallToolPaths wall_tool_paths_2_again(outline_shifted, width, width, 2, 0, 0.2, params, &cache_small);
+                wall_tool_paths_2_again.getToolPaths();
+                REQUIRE(cache_small.hits() == 1);
+                REQUIRE(cache_small.misses() == 3);
+            }
+        }
+        WHEN("The least recently used entry is evicted") {
+            auto process = [&](Arachne::WallToolPathsCache &cache, size_t inset_count) {
+                Arachne::WallToolPaths wall_tool_paths(outline, width, width, inset_count, 0, 0.2, params, &cache);
+                wall_tool_paths.getToolPaths();
+            };
+            auto memsize = [&](size_t inset_count) {
+                Arachne::WallToolPathsCache cache;
+                process(cache, inset_count);
+                return cache.memsize();
+            };
+            const size_t memsize_1 = memsize(1);
+            const size_t memsize_3 = memsize(3);
+            REQUIRE(memsize_1 < memsize_3);
+            // Fits the entries with two and three walls.
+            Arachne::WallToolPathsCache cache_lru(memsize(2) + memsize_3);
+            process(cache_lru, 2);
+            process(cache_lru, 3);
+            // Touch the entry with two walls, the entry with three walls becomes the least recently used one.
+            process(cache_lru, 2);
+            process(cache_lru, 1);
+            THEN("The recently used entries survive") {
+                REQUIRE(cache_lru.size() == 2);
+                const size_t misses = cache_lru.misses();
+                process(cache_lru, 2);
+                process(cache_lru, 1);
+                REQUIRE(cache_lru.misses() == misses);
+                process(cache_lru, 3);
+                REQUIRE(cache_lru.misses() == misses + 1);
+            }
+        }
+        WHEN("The outline is processed with a different number of walls") {
+            Arachne::WallToolPaths wall_tool_paths_other(outline, width, width, 2, 0, 0.2, params, &cache);
+            wall_tool_paths_other.getToolPaths();
+            THEN("The cache is missed") {
+                REQUIRE(cache.size() == 2);
+                REQUIRE(cache.hits() == 0);
+                REQUIRE(cache.misses() == 2);
+            }
+        }
+    }
+}
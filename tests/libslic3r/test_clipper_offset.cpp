@@ -212,3 +212,48 @@ SCENARIO("Constant offset", "[ClipperUtils]") {
 		}
 	}
 }
+
+SCENARIO("Batched offsets", "[ClipperUtils]") {
+	coord_t s = 1000000;
+	GIVEN("20mm box with a 10mm hole and a separate 5mm box") {
+		ExPolygon box_with_hole;
+		box_with_hole.contour.points = { Vec2crd{ 0, 0 }, Vec2crd{ 20 * s, 0 }, Vec2crd{ 20 * s, 20 * s }, Vec2crd{ 0, 20 * s } };
+		box_with_hole.holes.emplace_back(Points{ Vec2crd{ 5 * s, 5 * s }, Vec2crd{ 5 * s, 15 * s }, Vec2crd{ 15 * s, 15 * s }, Vec2crd{ 15 * s, 5 * s } });
+		ExPolygon box5mm;
+		box5mm.contour.points = { Vec2crd{ 25 * s, 0 }, Vec2crd{ 30 * s, 0 }, Vec2crd{ 30 * s, 5 * s }, Vec2crd{ 25 * s, 5 * s } };
+		ExPolygons input { box_with_hole, box5mm };
+		WHEN("offset2_ex_batch()") {
+			// -3mm eats up both boxes, the opening by 1mm and 5mm makes the boxes overlap.
+			std::vector<std::pair<float, float>> deltas2 { { -1.f * s, 0.5f * s }, { -1.f * s, 0.8f * s }, { -3.f * s, 1.f * s }, { -1.f * s, 5.f * s } };
+			std::vector<ExPolygons> batch = offset2_ex_batch(input, deltas2);
+			THEN("The results match offset2_ex() called for each pair of deltas") {
+				REQUIRE(batch.size() == deltas2.size());
+				for (size_t i = 0; i < deltas2.size(); ++ i)
+					REQUIRE(batch[i] == offset2_ex(input, deltas2[i].first, deltas2[i].second));
+				REQUIRE(batch[2].empty());
+				REQUIRE(batch[3].size() == 1);
+			}
+		}
+	}
+	GIVEN("Finely tessellated 10mm circle with a 5mm hole") {
+		// The contour edges alternate between 3 and 13 micrometers, the short ones are removed by the 2mm offsets only,
+		// see ClipperOffsetShortestEdgeFactor.
+		ExPolygon ring;
+		for (size_t i = 0; i < 8000; ++ i) {
+			double angle = 2. * M_PI * double(i) / 8000. + (i % 2 == 0 ? 0. : 0.0005);
+			ring.contour.points.emplace_back(Vec2crd{ coord_t(10. * s * cos(angle)), coord_t(10. * s * sin(angle)) });
+		}
+		ring.holes.emplace_back();
+		for (size_t i = 0; i < 4000; ++ i) {
+			double angle = - 2. * M_PI * double(i) / 4000.;
+			ring.holes.back().points.emplace_back(Vec2crd{ coord_t(5. * s * cos(angle)), coord_t(5. * s * sin(angle)) });
+		}
+		ExPolygons input { ring };
+		THEN("The batched offsets match the offsets called for each pair of deltas") {
+			std::vector<std::pair<float, float>> deltas2 { { -0.4f * s, 0.2f * s }, { -0.4f * s, 0.3f * s }, { -2.f * s, 1.f * s }, { -0.2f * s, 2.f * s } };
+			std::vector<ExPolygons> batch2 = offset2_ex_batch(input, deltas2);
+			for (size_t i = 0; i < deltas2.size(); ++ i)
+				REQUIRE(batch2[i] == offset2_ex(input, deltas2[i].first, deltas2[i].second));
+		}
+	}
+}
@@ -7,6 +7,9 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/ExPolygon.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+#include <test_utils.hpp>
 
 using namespace Slic3r;
 
@@ -299,3 +302,108 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+// Results of the boolean operations and offsets performed by ClipperLib directly, to compare ClipperUtils against.
+// With SLIC3R_USE_CLIPPER2 the ClipperUtils boolean operations and offsets run on Clipper2, thus the Clipper2 backend is compared
+// against ClipperLib, otherwise the comparison guards the ClipperUtils wrappers.
+struct ClipperLibResult
+{
+    ClipperLib::Paths paths;
+    size_t            contours { 0 };
+    size_t            holes    { 0 };
+    double            perimeter { 0. };
+};
+
+static ClipperLibResult clipperlib_result(const ClipperLib::PolyTree &tree)
+{
+    ClipperLibResult out;
+    for (const ClipperLib::PolyNode *node = tree.GetFirst(); node; node = node->GetNext()) {
+        ++ (node->IsHole() ? out.holes : out.contours);
+        out.paths.emplace_back(node->Contour);
+        for (size_t i = 0; i < node->Contour.size(); ++ i)
+            out.perimeter += (node->Contour[i] - node->Contour[(i + 1) % node->Contour.size()]).cast<double>().norm();
+    }
+    return out;
+}
+
+static ClipperLibResult clipperlib_clip(ClipperLib::ClipType clip_type, const Polygons &subject, const Polygons &clip)
+{
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+    ClipperLib::PolyTree tree;
+    clipper.Execute(clip_type, tree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return clipperlib_result(tree);
+}
+
+// Offset of the whole set of contours and holes with the ClipperUtils defaults.
+static ClipperLibResult clipperlib_offset(const Polygons &polygons, float delta)
+{
+    ClipperLib::ClipperOffset co;
+    co.MiterLimit         = DefaultMiterLimit;
+    co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+    co.AddPaths(ClipperUtils::PolygonsProvider(polygons), DefaultJoinType, ClipperLib::etClosedPolygon);
+    ClipperLib::PolyTree tree;
+    co.Execute(tree, delta);
+    return clipperlib_result(tree);
+}
+
+// Area of the symmetric difference of the ExPolygons and the reference, calculated by ClipperLib directly.
+static double symmetric_difference_area(const ExPolygons &expolygons, const ClipperLibResult &reference)
+{
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(ClipperUtils::ExPolygonsProvider(expolygons), ClipperLib::ptSubject, true);
+    clipper.AddPaths(reference.paths, ClipperLib::ptClip, true);
+    ClipperLib::Paths out;
+    clipper.Execute(ClipperLib::ctXor, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return std::accumulate(out.begin(), out.end(), 0., [](double a, const ClipperLib::Path &path) { return a + ClipperLib::Area(path); });
+}
+
+// Same number of contours and holes covering the same area up to a rounding of the vertices.
+static bool same_topology_and_area(const ExPolygons &expolygons, const ClipperLibResult &reference, double relative_tolerance = 0.)
+{
+    size_t holes = 0;
+    double area  = 0.;
+    for (const ExPolygon &expolygon : expolygons) {
+        holes += expolygon.holes.size();
+        area  += expolygon.area();
+    }
+    const double xor_area = symmetric_difference_area(expolygons, reference);
+    INFO("contours " << expolygons.size() << " / " << reference.contours << ", holes " << holes << " / " << reference.holes <<
+         ", symmetric difference " << xor_area << " of area " << area);
+    // Each vertex may be rounded differently by one unit.
+    return expolygons.size() == reference.contours && holes == reference.holes &&
+           xor_area <= 2. * reference.perimeter + relative_tolerance * std::abs(area);
+}
+
+SCENARIO("ClipperUtils booleans and offsets match ClipperLib on sliced layers", "[ClipperUtils][Clipper2]") {
+    for (const char *name : { "20mm_cube.obj", "cube_with_hole.obj", "frog_legs.obj", "extruder_idler.obj", "ipadstand.obj", "two_hollow_squares.obj" }) {
+        GIVEN(name) {
+            TriangleMesh       mesh = load_model(name);
+            BoundingBoxf3      bbox = mesh.bounding_box();
+            std::vector<float> zs;
+            for (double z = bbox.min.z() + 0.1; z < bbox.max.z(); z += 0.3)
+                zs.emplace_back(float(z));
+            std::vector<ExPolygons> layers = slice_mesh_ex(mesh.its, zs);
+            const float             delta  = float(scaled(0.4));
+            THEN("union, difference and intersection of consecutive layers produce the same contours, holes and areas") {
+                for (size_t i = 1; i < layers.size(); ++ i) {
+                    INFO("layer " << i);
+                    Polygons below = to_polygons(layers[i - 1]);
+                    Polygons above = to_polygons(layers[i]);
+                    REQUIRE(same_topology_and_area(union_ex(layers[i]), clipperlib_clip(ClipperLib::ctUnion, above, {})));
+                    REQUIRE(same_topology_and_area(diff_ex(below, above), clipperlib_clip(ClipperLib::ctDifference, below, above)));
+                    REQUIRE(same_topology_and_area(intersection_ex(below, above), clipperlib_clip(ClipperLib::ctIntersection, below, above)));
+                }
+            }
+            THEN("offsets of the layers produce the same contours, holes and areas") {
+                for (size_t i = 0; i < layers.size(); ++ i) {
+                    INFO("layer " << i);
+                    for (float d : { delta, - delta })
+                        // The miter joints may be cut at slightly different places.
+                        REQUIRE(same_topology_and_area(offset_ex(layers[i], d), clipperlib_offset(to_polygons(layers[i]), d), 0.001));
+                }
+            }
+        }
+    }
+}